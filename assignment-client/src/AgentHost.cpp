@@ -0,0 +1,355 @@
+//
+//  AgentHost.cpp
+//  assignment-client/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+
+#include <QtCore/QEventLoop>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkRequest>
+
+#include <AvatarHashMap.h>
+#include <EntityScriptingInterface.h>
+#include <NetworkAccessManager.h>
+#include <NodeList.h>
+#include <PacketHeaders.h>
+#include <ResourceCache.h>
+#include <SoundCache.h>
+
+#include "avatars/ScriptableAvatar.h"
+
+#include "AgentHost.h"
+
+const QString AGENT_HOST_SCRIPT_URL_KEY = "url";
+const QString AGENT_HOST_NUM_INSTANCES_KEY = "num_instances";
+
+const int ENTITY_QUERY_INTERVAL_MSECS = 1000;
+
+static int byteArrayListTypeId = qRegisterMetaType<QList<QByteArray> >();
+
+HostedScriptRunner::HostedScriptRunner(const QString& scriptContents, const QString& scriptName) :
+    _scriptContents(scriptContents),
+    _scriptName(scriptName),
+    _frameTimer(NULL),
+    _avatarPositionSum(0.0f),
+    _numAvatars(0)
+{
+}
+
+bool HostedScriptRunner::getAverageAvatarPosition(glm::vec3& averagePosition) {
+    QMutexLocker locker(&_avatarPositionMutex);
+    if (_numAvatars == 0) {
+        return false;
+    }
+    averagePosition = _avatarPositionSum / (float)_numAvatars;
+    return true;
+}
+
+void HostedScriptRunner::addScripts(int numScripts) {
+    auto avatarHashMap = DependencyManager::get<AvatarHashMap>();
+
+    for (int i = 0; i < numScripts; i++) {
+        HostedScript script;
+        script.engine = new ScriptEngine(_scriptContents, _scriptName);
+        script.engine->setParent(this);
+
+        // each script gets an avatar of its own, under an ID of its own
+        QUuid hostedAvatarID = QUuid::createUuid();
+        script.engine->setHostedAvatarID(hostedAvatarID);
+
+        script.avatar = new ScriptableAvatar(script.engine);
+        script.avatar->setParent(script.engine);
+        script.avatar->setSessionUUID(hostedAvatarID);
+        script.avatar->setForceFaceTrackerConnected(true);
+
+        // call model URL setters with empty URLs so our avatar, if user, will have the default models
+        script.avatar->setFaceModelURL(QUrl());
+        script.avatar->setSkeletonModelURL(QUrl());
+
+        script.engine->setAvatarData(script.avatar, "Avatar");
+        script.engine->setAvatarHashMap(avatarHashMap.data(), "AvatarList");
+
+        script.agent = new HostedAgent(script.engine);
+        script.agent->setParent(script.engine);
+        script.engine->registerGlobalObject("Agent", script.agent);
+
+        script.engine->init();
+        script.engine->registerGlobalObject("SoundCache", DependencyManager::get<SoundCache>().data());
+
+        script.engine->beginRunning();
+        _scripts.push_back(script);
+    }
+
+    if (!_frameTimer) {
+        _frameTimer = new QTimer(this);
+        _frameTimer->setTimerType(Qt::PreciseTimer);
+        connect(_frameTimer, &QTimer::timeout, this, &HostedScriptRunner::runFrame);
+        _frameTimer->start(SCRIPT_DATA_CALLBACK_USECS / USECS_PER_MSEC);
+    }
+}
+
+void HostedScriptRunner::runFrame() {
+    glm::vec3 avatarPositionSum(0.0f);
+    int numAvatars = 0;
+    QList<QByteArray> avatarPackets;
+
+    QVector<HostedScript>::iterator scriptItr = _scripts.begin();
+    while (scriptItr != _scripts.end()) {
+        scriptItr->engine->runFrame();
+        avatarPackets << scriptItr->engine->takeHostedAvatarPackets();
+
+        if (scriptItr->engine->isFinished()) {
+            finishScript(*scriptItr);
+            scriptItr = _scripts.erase(scriptItr);
+            continue;
+        }
+
+        if (scriptItr->engine->isAvatar()) {
+            avatarPositionSum += scriptItr->avatar->getPosition();
+            ++numAvatars;
+        }
+        ++scriptItr;
+    }
+
+    // the host sends them from its own thread, which is the only one using the node socket
+    if (!avatarPackets.isEmpty()) {
+        emit hostedAvatarPacketsReady(avatarPackets);
+    }
+
+    QMutexLocker locker(&_avatarPositionMutex);
+    _avatarPositionSum = avatarPositionSum;
+    _numAvatars = numAvatars;
+}
+
+void HostedScriptRunner::finishScript(HostedScript& script) {
+    script.engine->finishRunning();
+    // the avatar and agent are children of the engine
+    script.engine->deleteLater();
+    emit scriptFinished();
+}
+
+void HostedScriptRunner::stopAllScripts() {
+    for (HostedScript& script : _scripts) {
+        script.engine->stop();
+        finishScript(script);
+    }
+    _scripts.clear();
+
+    if (_frameTimer) {
+        _frameTimer->stop();
+    }
+}
+
+bool AgentHost::isAgentHostPayload(const QByteArray& payload) {
+    QJsonObject hostObject = QJsonDocument::fromJson(payload).object();
+    return hostObject.contains(AGENT_HOST_SCRIPT_URL_KEY) && hostObject.contains(AGENT_HOST_NUM_INSTANCES_KEY);
+}
+
+AgentHost::AgentHost(const QByteArray& packet) :
+    ThreadedAssignment(packet),
+    _entityEditSender(),
+    _numRunningScripts(0),
+    _queryTimer(NULL),
+    _entityEditTimer(NULL)
+{
+    DependencyManager::get<EntityScriptingInterface>()->setPacketSender(&_entityEditSender);
+
+    DependencyManager::set<ResourceCacheSharedItems>();
+    DependencyManager::set<SoundCache>();
+}
+
+void AgentHost::readPendingDatagrams() {
+    QByteArray receivedPacket;
+    HifiSockAddr senderSockAddr;
+    auto nodeList = DependencyManager::get<NodeList>();
+
+    while (readAvailableDatagram(receivedPacket, senderSockAddr)) {
+        if (!nodeList->packetVersionAndHashMatch(receivedPacket)) {
+            continue;
+        }
+        PacketType datagramPacketType = packetTypeForPacket(receivedPacket);
+
+        if (datagramPacketType == PacketTypeJurisdiction) {
+            int headerBytes = numBytesForPacketHeader(receivedPacket);
+            SharedNodePointer matchedNode = nodeList->sendingNodeForPacket(receivedPacket);
+
+            if (matchedNode && receivedPacket[headerBytes] == NodeType::EntityServer) {
+                DependencyManager::get<EntityScriptingInterface>()->getJurisdictionListener()->
+                    queueReceivedPacket(matchedNode, receivedPacket);
+            }
+        } else if (datagramPacketType == PacketTypeOctreeStats
+                   || datagramPacketType == PacketTypeEntityData
+                   || datagramPacketType == PacketTypeEntityErase) {
+            SharedNodePointer sourceNode = nodeList->sendingNodeForPacket(receivedPacket);
+            if (!sourceNode) {
+                continue;
+            }
+            sourceNode->setLastHeardMicrostamp(usecTimestampNow());
+
+            QByteArray mutablePacket = receivedPacket;
+            if (datagramPacketType == PacketTypeOctreeStats) {
+                int statsMessageLength = OctreeHeadlessViewer::parseOctreeStats(mutablePacket, sourceNode);
+                if (mutablePacket.size() <= statsMessageLength) {
+                    continue; // no piggyback data
+                }
+                mutablePacket = mutablePacket.mid(statsMessageLength);
+                datagramPacketType = packetTypeForPacket(mutablePacket);
+            }
+
+            if (datagramPacketType == PacketTypeEntityData || datagramPacketType == PacketTypeEntityErase) {
+                _entityViewer.processDatagram(mutablePacket, sourceNode);
+            }
+        } else if (datagramPacketType == PacketTypeBulkAvatarData
+                   || datagramPacketType == PacketTypeAvatarIdentity
+                   || datagramPacketType == PacketTypeAvatarBillboard
+                   || datagramPacketType == PacketTypeKillAvatar) {
+            // one avatar list for all of our scripts
+            DependencyManager::get<AvatarHashMap>()->processAvatarMixerDatagram(receivedPacket,
+                nodeList->sendingNodeForPacket(receivedPacket));
+
+            // let this continue through to the NodeList so it updates last heard timestamp
+            // for the sending avatar-mixer
+            nodeList->processNodeData(senderSockAddr, receivedPacket);
+        } else {
+            nodeList->processNodeData(senderSockAddr, receivedPacket);
+        }
+    }
+}
+
+const QString AGENT_HOST_LOGGING_NAME = "agent-host";
+
+void AgentHost::run() {
+    ThreadedAssignment::commonInit(AGENT_HOST_LOGGING_NAME, NodeType::Agent);
+
+    auto nodeList = DependencyManager::get<NodeList>();
+    nodeList->addSetOfNodeTypesToNodeInterestSet(NodeSet()
+                                                 << NodeType::AvatarMixer
+                                                 << NodeType::EntityServer);
+
+    QJsonObject hostObject = QJsonDocument::fromJson(_payload).object();
+    QUrl scriptURL = QUrl(hostObject[AGENT_HOST_SCRIPT_URL_KEY].toString());
+    int numInstances = std::max(hostObject[AGENT_HOST_NUM_INSTANCES_KEY].toInt(), 1);
+
+    QNetworkAccessManager& networkAccessManager = NetworkAccessManager::getInstance();
+    QNetworkRequest networkRequest = QNetworkRequest(scriptURL);
+    networkRequest.setHeader(QNetworkRequest::UserAgentHeader, HIGH_FIDELITY_USER_AGENT);
+    QNetworkReply* reply = networkAccessManager.get(networkRequest);
+
+    qDebug() << "Downloading script for" << numInstances << "instances at" << scriptURL.toString();
+
+    QEventLoop loop;
+    QObject::connect(reply, SIGNAL(finished()), &loop, SLOT(quit()));
+    loop.exec();
+
+    QString scriptContents(reply->readAll());
+    delete reply;
+
+    auto entityScriptingInterface = DependencyManager::get<EntityScriptingInterface>();
+    _entityViewer.setJurisdictionListener(entityScriptingInterface->getJurisdictionListener());
+    _entityViewer.init();
+    entityScriptingInterface->setEntityTree(_entityViewer.getTree());
+
+    // a few threads each stepping a share of the scripts, rather than a thread or a process per script
+    int numThreads = std::max(1, std::min(QThread::idealThreadCount(), numInstances));
+    for (int i = 0; i < numThreads; i++) {
+        int numScriptsOnThread = numInstances / numThreads + (i < numInstances % numThreads ? 1 : 0);
+
+        QThread* runnerThread = new QThread(this);
+        HostedScriptRunner* runner = new HostedScriptRunner(scriptContents, scriptURL.toString());
+        runner->moveToThread(runnerThread);
+        connect(runnerThread, &QThread::finished, runner, &QObject::deleteLater);
+        connect(runner, &HostedScriptRunner::scriptFinished, this, &AgentHost::scriptFinished);
+        connect(runner, &HostedScriptRunner::hostedAvatarPacketsReady, this, &AgentHost::sendHostedAvatarPackets);
+        runnerThread->start();
+
+        QMetaObject::invokeMethod(runner, "addScripts", Q_ARG(int, numScriptsOnThread));
+
+        _runnerThreads << runnerThread;
+        _runners << runner;
+    }
+    _numRunningScripts = numInstances;
+
+    // we look at the entities around the middle of our crowd
+    _queryTimer = new QTimer(this);
+    connect(_queryTimer, &QTimer::timeout, this, &AgentHost::queryEntities);
+    _queryTimer->start(ENTITY_QUERY_INTERVAL_MSECS);
+
+    // the scripts queue entity edits from their threads, we release and send them from ours
+    _entityEditTimer = new QTimer(this);
+    _entityEditTimer->setTimerType(Qt::PreciseTimer);
+    connect(_entityEditTimer, &QTimer::timeout, this, &AgentHost::sendEntityEdits);
+    _entityEditTimer->start(SCRIPT_DATA_CALLBACK_USECS / USECS_PER_MSEC);
+}
+
+void AgentHost::sendEntityEdits() {
+    if (_entityEditSender.serversExist()) {
+        _entityEditSender.releaseQueuedMessages();
+        if (!_entityEditSender.isThreaded()) {
+            _entityEditSender.process();
+        }
+    }
+}
+
+void AgentHost::sendHostedAvatarPackets(const QList<QByteArray>& packets) {
+    auto nodeList = DependencyManager::get<NodeList>();
+    for (const QByteArray& packet : packets) {
+        nodeList->broadcastToNodes(packet, NodeSet() << NodeType::AvatarMixer);
+    }
+}
+
+void AgentHost::queryEntities() {
+    glm::vec3 positionSum(0.0f);
+    int numRunnersWithAvatars = 0;
+    for (HostedScriptRunner* runner : _runners) {
+        glm::vec3 averagePosition;
+        if (runner->getAverageAvatarPosition(averagePosition)) {
+            positionSum += averagePosition;
+            ++numRunnersWithAvatars;
+        }
+    }
+    if (numRunnersWithAvatars > 0) {
+        _entityViewer.setPosition(positionSum / (float)numRunnersWithAvatars);
+    }
+    _entityViewer.queryOctree();
+}
+
+void AgentHost::scriptFinished() {
+    // stopping the runners in aboutToFinish finishes their scripts too; those signals may still be queued
+    if (_isFinished) {
+        return;
+    }
+    if (--_numRunningScripts == 0) {
+        setFinished(true);
+    }
+}
+
+void AgentHost::aboutToFinish() {
+    if (_queryTimer) {
+        _queryTimer->stop();
+    }
+    if (_entityEditTimer) {
+        _entityEditTimer->stop();
+    }
+
+    for (int i = 0; i < _runners.size(); i++) {
+        disconnect(_runners[i], &HostedScriptRunner::scriptFinished, this, &AgentHost::scriptFinished);
+        QMetaObject::invokeMethod(_runners[i], "stopAllScripts", Qt::BlockingQueuedConnection);
+        _runnerThreads[i]->quit();
+        _runnerThreads[i]->wait();
+    }
+    _runners.clear();
+
+    // whatever the scripts queued on their way out
+    sendEntityEdits();
+
+    // our entity tree is going to go away so tell that to the EntityScriptingInterface
+    DependencyManager::get<EntityScriptingInterface>()->setEntityTree(NULL);
+}
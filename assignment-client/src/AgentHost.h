@@ -0,0 +1,131 @@
+//
+//  AgentHost.h
+//  assignment-client/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Runs many instances of an agent script in one assignment-client, for crowds of bots.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AgentHost_h
+#define hifi_AgentHost_h
+
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+#include <QtCore/QUrl>
+#include <QtCore/QVector>
+
+#include <EntityEditPacketSender.h>
+#include <EntityTreeHeadlessViewer.h>
+#include <ScriptEngine.h>
+#include <ThreadedAssignment.h>
+
+class ScriptableAvatar;
+
+/// What a hosted script sees as its Agent object. Audio is mixed per node, so hosted agents neither send nor hear it.
+class HostedAgent : public QObject {
+    Q_OBJECT
+
+    Q_PROPERTY(bool isAvatar READ isAvatar WRITE setIsAvatar)
+    Q_PROPERTY(bool isPlayingAvatarSound READ isPlayingAvatarSound)
+    Q_PROPERTY(bool isListeningToAudioStream READ isListeningToAudioStream WRITE setIsListeningToAudioStream)
+    Q_PROPERTY(float lastReceivedAudioLoudness READ getLastReceivedAudioLoudness)
+public:
+    HostedAgent(ScriptEngine* scriptEngine) : _scriptEngine(scriptEngine) { }
+
+    void setIsAvatar(bool isAvatar) { _scriptEngine->setIsAvatar(isAvatar); }
+    bool isAvatar() const { return _scriptEngine->isAvatar(); }
+
+    bool isPlayingAvatarSound() const { return false; }
+
+    bool isListeningToAudioStream() const { return false; }
+    void setIsListeningToAudioStream(bool isListeningToAudioStream) { }
+
+    float getLastReceivedAudioLoudness() const { return 0.0f; }
+
+public slots:
+    void playAvatarSound(Sound* avatarSound) { }
+
+private:
+    ScriptEngine* _scriptEngine;
+};
+
+/// Steps the script engines given to it at the script frame rate, on whatever thread it was moved to.
+class HostedScriptRunner : public QObject {
+    Q_OBJECT
+public:
+    HostedScriptRunner(const QString& scriptContents, const QString& scriptName);
+
+    /// the average position of the avatars of our scripts as of the last frame, false if none of them is an avatar
+    bool getAverageAvatarPosition(glm::vec3& averagePosition);
+
+public slots:
+    void addScripts(int numScripts);
+    void stopAllScripts();
+
+signals:
+    void scriptFinished();
+    void hostedAvatarPacketsReady(const QList<QByteArray>& packets);
+
+private slots:
+    void runFrame();
+
+private:
+    class HostedScript {
+    public:
+        ScriptEngine* engine;
+        ScriptableAvatar* avatar;
+        HostedAgent* agent;
+    };
+
+    void finishScript(HostedScript& script);
+
+    QString _scriptContents;
+    QString _scriptName;
+    QVector<HostedScript> _scripts;
+    QTimer* _frameTimer;
+
+    QMutex _avatarPositionMutex;
+    glm::vec3 _avatarPositionSum;
+    int _numAvatars;
+};
+
+/// An agent assignment that runs a number of instances of one script. All of them share our node, socket, entity
+/// viewer and avatar list, each one has its own avatar.
+class AgentHost : public ThreadedAssignment {
+    Q_OBJECT
+public:
+    /// an agent assignment is hosted when its payload is a JSON object with the script URL and number of instances
+    static bool isAgentHostPayload(const QByteArray& payload);
+
+    AgentHost(const QByteArray& packet);
+
+    virtual void aboutToFinish();
+
+public slots:
+    void run();
+    void readPendingDatagrams();
+
+private slots:
+    void queryEntities();
+    void sendEntityEdits();
+    void sendHostedAvatarPackets(const QList<QByteArray>& packets);
+    void scriptFinished();
+
+private:
+    EntityEditPacketSender _entityEditSender;
+    EntityTreeHeadlessViewer _entityViewer;
+
+    QVector<QThread*> _runnerThreads;
+    QVector<HostedScriptRunner*> _runners;
+    int _numRunningScripts;
+    QTimer* _queryTimer;
+    QTimer* _entityEditTimer;
+};
+
+#endif // hifi_AgentHost_h
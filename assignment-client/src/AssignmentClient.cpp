@@ -169,6 +169,8 @@ void AssignmentClient::sendStatsPacketToACM() {
 
     if (_currentAssignment) {
         statsObject["assignment_type"] = _currentAssignment->getTypeName();
+        statsObject[ASSIGNMENT_LOAD_STATS_KEY] = _currentAssignment->getLastReportedLoad();
+        statsObject[ASSIGNMENT_LOAD_THRESHOLD_STATS_KEY] = _currentAssignment->getLoadThreshold();
     } else {
         statsObject["assignment_type"] = "none";
     }
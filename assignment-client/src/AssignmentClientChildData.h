@@ -13,6 +13,7 @@
 #define hifi_AssignmentClientChildData_h
 
 #include <Assignment.h>
+#include <ThreadedAssignment.h>
 
 
 class AssignmentClientChildData : public NodeData {
@@ -22,11 +23,19 @@ class AssignmentClientChildData : public NodeData {
     QString getChildType() { return _childType; }
     void setChildType(QString childType) { _childType = childType; }
 
+    float getLoad() const { return _load; }
+    void setLoad(float load) { _load = load; }
+
+    float getLoadThreshold() const { return _loadThreshold; }
+    void setLoadThreshold(float loadThreshold) { _loadThreshold = loadThreshold; }
+
     // implement parseData to return 0 so we can be a subclass of NodeData
     int parseData(const QByteArray& packet) { return 0; }
 
  private:
     QString _childType;
+    float _load = 0.0f;
+    float _loadThreshold = NO_LOAD_THRESHOLD;
 };
 
 #endif // hifi_AssignmentClientChildData_h
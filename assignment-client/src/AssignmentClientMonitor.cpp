@@ -14,6 +14,7 @@
 #include <AddressManager.h>
 #include <JSONBreakableMarshal.h>
 #include <LogHandler.h>
+#include <ThreadedAssignment.h>
 
 #include "AssignmentClientMonitor.h"
 #include "AssignmentClientApp.h"
@@ -168,6 +169,7 @@ void AssignmentClientMonitor::checkSpares() {
     QUuid aSpareId = "";
     unsigned int spareCount = 0;
     unsigned int totalCount = 0;
+    unsigned int busyCount = 0;
 
     nodeList->removeSilentNodes();
 
@@ -177,18 +179,24 @@ void AssignmentClientMonitor::checkSpares() {
         if (childData->getChildType() == "none") {
             spareCount ++;
             aSpareId = node->getUUID();
+        } else if (childData->getLoad() > childData->getLoadThreshold()) {
+            // the domain-server is likely to hand out another instance of this child's assignment soon, so keep an
+            // extra spare around to pick it up right away
+            busyCount ++;
         }
     });
 
+    unsigned int wantedSpareCount = busyCount > 0 ? 2 : 1;
+
     // Spawn or kill children, as needed.  If --min or --max weren't specified, allow the child count
     // to drift up or down as far as needed.
-    if (spareCount < 1 || totalCount < _minAssignmentClientForks) {
+    if (spareCount < wantedSpareCount || totalCount < _minAssignmentClientForks) {
         if (!_maxAssignmentClientForks || totalCount < _maxAssignmentClientForks) {
             spawnChildClient();
         }
     }
 
-    if (spareCount > 1) {
+    if (spareCount > wantedSpareCount) {
         if (!_minAssignmentClientForks || totalCount > _minAssignmentClientForks) {
             // kill aSpareId
             qDebug() << "asking child" << aSpareId << "to exit.";
@@ -248,6 +256,9 @@ void AssignmentClientMonitor::readPendingDatagrams() {
                     AssignmentClientChildData *childData =
                         static_cast<AssignmentClientChildData*>(matchingNode->getLinkedData());
                     childData->setChildType(childType);
+                    childData->setLoad(unpackedStatsJSON[ASSIGNMENT_LOAD_STATS_KEY].toDouble());
+                    childData->setLoadThreshold(
+                        unpackedStatsJSON[ASSIGNMENT_LOAD_THRESHOLD_STATS_KEY].toDouble(NO_LOAD_THRESHOLD));
                     // note when this child talked
                     matchingNode->setLastHeardMicrostamp(usecTimestampNow());
                 }
@@ -12,6 +12,7 @@
 #include <PacketHeaders.h>
 
 #include "Agent.h"
+#include "AgentHost.h"
 #include "AssignmentFactory.h"
 #include "audio/AudioMixer.h"
 #include "avatars/AvatarMixer.h"
@@ -31,8 +32,14 @@ ThreadedAssignment* AssignmentFactory::unpackAssignment(const QByteArray& packet
             return new AudioMixer(packet);
         case Assignment::AvatarMixerType:
             return new AvatarMixer(packet);
-        case Assignment::AgentType:
+        case Assignment::AgentType: {
+            // the domain-server asks for many instances of a script in one assignment through the payload
+            Assignment agentAssignment(packet);
+            if (AgentHost::isAgentHostPayload(agentAssignment.getPayload())) {
+                return new AgentHost(packet);
+            }
             return new Agent(packet);
+        }
         case Assignment::EntityServerType:
             return new EntityServer(packet);
         default:
@@ -570,6 +570,9 @@ void AudioMixer::sendStatsPacket() {
     statsObject["trailing_sleep_percentage"] = _trailingSleepRatio * 100.0f;
     statsObject["performance_throttling_ratio"] = _performanceThrottlingRatio;
 
+    // the less of each frame we get to sleep, the closer we are to falling behind
+    statsObject[ASSIGNMENT_LOAD_STATS_KEY] = glm::clamp(1.0f - _trailingSleepRatio, 0.0f, 1.0f);
+
     statsObject["average_listeners_per_frame"] = (float) _sumListeners / (float) _numStatFrames;
 
     if (_sumListeners > 0) {
@@ -707,6 +710,7 @@ void AudioMixer::run() {
 
     // check the settings object to see if we have anything we can parse out
     parseSettingsObject(settingsObject);
+    parseAutoscalingSettings(settingsObject);
 
     int nextFrame = 0;
     QElapsedTimer timer;
@@ -9,7 +9,9 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <algorithm>
 #include <cfloat>
+#include <climits>
 #include <random>
 
 #include <QtCore/QCoreApplication>
@@ -125,6 +127,20 @@ void AvatarMixer::broadcastAvatarData() {
     auto nodeList = DependencyManager::get<NodeList>();
     int numPacketHeaderBytes = nodeList->populatePacketHeader(mixedAvatarByteArray, PacketTypeBulkAvatarData);
      
+    // hosted avatars go away with their script, if the host stops sending one let everybody know it's gone
+    quint64 nowMsecs = QDateTime::currentMSecsSinceEpoch();
+    nodeList->eachNode([&](const SharedNodePointer& node) {
+        if (node->getType() == NodeType::Agent && node->getLinkedData()) {
+            AvatarMixerClientData* nodeData = reinterpret_cast<AvatarMixerClientData*>(node->getLinkedData());
+            QList<QUuid> expiredIDs;
+            {
+                QMutexLocker nodeDataLocker(&nodeData->getMutex());
+                expiredIDs = nodeData->removeExpiredHostedAvatars(nowMsecs);
+            }
+            broadcastKillAvatars(expiredIDs);
+        }
+    });
+
     // setup for distributed random floating point values 
     std::random_device randomDevice;
     std::mt19937 generator(randomDevice());
@@ -150,6 +166,11 @@ void AvatarMixer::broadcastAvatarData() {
                 return;
             }
             ++_sumListeners;
+
+            // avatar data, identities and billboards all share this budget, the shaper lets billboards wait
+            if (node->getDownstreamBandwidthHint() != _nodeBandwidthHintKbps) {
+                node->setDownstreamBandwidthHint(_nodeBandwidthHintKbps);
+            }
             
             // reset packet pointers for this node
             mixedAvatarByteArray.resize(numPacketHeaderBytes);
@@ -240,6 +261,48 @@ void AvatarMixer::broadcastAvatarData() {
                         return;
                     }
                     
+                    // avatars hosted by the other node go out under their own IDs, each time the host updated them
+                    for (auto& hostedItr : otherNodeData->getHostedAvatars()) {
+                        AvatarMixerClientData::HostedAvatar& hostedAvatar = *hostedItr.second;
+                        if (hostedAvatar.lastUpdatedTimestamp <= _lastFrameTimestamp) {
+                            continue;
+                        }
+
+                        float distanceToHostedAvatar = glm::length(myPosition - hostedAvatar.avatar.getPosition());
+                        maxAvatarDistanceThisFrame = std::max(maxAvatarDistanceThisFrame, distanceToHostedAvatar);
+                        if (distanceToHostedAvatar != 0.0f
+                            && distribution(generator) > (nodeData->getFullRateDistance() / distanceToHostedAvatar)) {
+                            continue;
+                        }
+
+                        nodeData->incrementNumAvatarsSentLastFrame();
+
+                        QByteArray avatarByteArray;
+                        avatarByteArray.append(hostedItr.first.toRfc4122());
+                        avatarByteArray.append(hostedAvatar.avatar.toByteArray());
+
+                        if (avatarByteArray.size() + mixedAvatarByteArray.size() > MAX_PACKET_SIZE) {
+                            nodeList->writeDatagram(mixedAvatarByteArray, node);
+                            numAvatarDataBytes += mixedAvatarByteArray.size();
+                            mixedAvatarByteArray.resize(numPacketHeaderBytes);
+                        }
+                        mixedAvatarByteArray.append(avatarByteArray);
+
+                        if (hostedAvatar.identityChangeTimestamp > 0
+                            && (hostedAvatar.identityChangeTimestamp > _lastFrameTimestamp
+                                || randFloat() < BILLBOARD_AND_IDENTITY_SEND_PROBABILITY)) {
+                            QByteArray identityPacket = nodeList->byteArrayWithPopulatedHeader(PacketTypeAvatarIdentity);
+
+                            QByteArray individualData = hostedAvatar.avatar.identityByteArray();
+                            individualData.replace(0, NUM_BYTES_RFC4122_UUID, hostedItr.first.toRfc4122());
+                            identityPacket.append(individualData);
+
+                            nodeList->writeDatagram(identityPacket, node);
+
+                            ++_sumIdentityPackets;
+                        }
+                    }
+
                     AvatarData& otherAvatar = otherNodeData->getAvatar();
                     //  Decide whether to send this avatar's data based on it's distance from us
                     
@@ -363,6 +426,19 @@ void AvatarMixer::broadcastAvatarData() {
     _lastFrameTimestamp = QDateTime::currentMSecsSinceEpoch();
 }
 
+void AvatarMixer::broadcastKillAvatars(const QList<QUuid>& avatarIDs) {
+    if (avatarIDs.isEmpty()) {
+        return;
+    }
+    auto nodeList = DependencyManager::get<NodeList>();
+    for (const QUuid& avatarID : avatarIDs) {
+        QByteArray killPacket = nodeList->byteArrayWithPopulatedHeader(PacketTypeKillAvatar);
+        killPacket += avatarID.toRfc4122();
+
+        nodeList->broadcastToNodes(killPacket, NodeSet() << NodeType::Agent);
+    }
+}
+
 void AvatarMixer::nodeKilled(SharedNodePointer killedNode) {
     if (killedNode->getType() == NodeType::Agent
         && killedNode->getLinkedData()) {
@@ -375,6 +451,15 @@ void AvatarMixer::nodeKilled(SharedNodePointer killedNode) {
         
         nodeList->broadcastToNodes(killPacket, NodeSet() << NodeType::Agent);
 
+        // along with any avatars it was hosting
+        AvatarMixerClientData* killedNodeData = reinterpret_cast<AvatarMixerClientData*>(killedNode->getLinkedData());
+        QList<QUuid> hostedAvatarIDs;
+        {
+            QMutexLocker nodeDataLocker(&killedNodeData->getMutex());
+            hostedAvatarIDs = killedNodeData->getHostedAvatarIDs();
+        }
+        broadcastKillAvatars(hostedAvatarIDs);
+
         // we also want to remove sequence number data for this avatar on our other avatars
         // so invoke the appropriate method on the AvatarMixerClientData for other avatars
         nodeList->eachMatchingNode(
@@ -429,6 +514,34 @@ void AvatarMixer::readPendingDatagrams() {
                     }
                     break;
                 }
+                case PacketTypeHostedAvatarData:
+                case PacketTypeHostedAvatarIdentity: {
+                    SharedNodePointer hostNode = nodeList->sendingNodeForPacket(receivedPacket);
+
+                    // only agent hosts run by assignment-clients put avatars in, interface clients are agents too
+                    if (hostNode && hostNode->isAssignment() && hostNode->getLinkedData()) {
+                        hostNode->setLastHeardMicrostamp(usecTimestampNow());
+                        AvatarMixerClientData* nodeData = static_cast<AvatarMixerClientData*>(hostNode->getLinkedData());
+
+                        if (packetTypeForPacket(receivedPacket) == PacketTypeHostedAvatarData) {
+                            // hosted avatars are only added on this thread, so a new ID checked here stays free
+                            QUuid hostedAvatarID = AvatarMixerClientData::hostedAvatarIDFromPacket(receivedPacket);
+                            bool isHosting;
+                            {
+                                QMutexLocker nodeDataLocker(&nodeData->getMutex());
+                                isHosting = nodeData->isHostingAvatar(hostedAvatarID);
+                            }
+                            bool canAdd = !isHosting && isHostedAvatarIDAvailable(hostedAvatarID, hostNode);
+
+                            QMutexLocker nodeDataLocker(&nodeData->getMutex());
+                            nodeData->parseHostedAvatarData(receivedPacket, canAdd);
+                        } else {
+                            QMutexLocker nodeDataLocker(&nodeData->getMutex());
+                            nodeData->parseHostedAvatarIdentity(receivedPacket);
+                        }
+                    }
+                    break;
+                }
                 case PacketTypeAvatarBillboard: {
                     
                     // check if we have a matching node in our list
@@ -460,6 +573,23 @@ void AvatarMixer::readPendingDatagrams() {
     }
 }
 
+// a host may not take the ID of a node or of another host's avatar, the expiry kill would take that avatar away
+bool AvatarMixer::isHostedAvatarIDAvailable(const QUuid& hostedAvatarID, const SharedNodePointer& hostNode) {
+    auto nodeList = DependencyManager::get<NodeList>();
+    if (hostedAvatarID.isNull() || nodeList->nodeWithUUID(hostedAvatarID)) {
+        return false;
+    }
+    bool isTaken = false;
+    nodeList->eachNode([&](const SharedNodePointer& node) {
+        if (!isTaken && node != hostNode && node->getLinkedData()) {
+            AvatarMixerClientData* nodeData = static_cast<AvatarMixerClientData*>(node->getLinkedData());
+            QMutexLocker nodeDataLocker(&nodeData->getMutex());
+            isTaken = nodeData->isHostingAvatar(hostedAvatarID);
+        }
+    });
+    return !isTaken;
+}
+
 void AvatarMixer::sendStatsPacket() {
     QJsonObject statsObject;
     statsObject["average_listeners_last_second"] = (float) _sumListeners / (float) _numStatFrames;
@@ -470,6 +600,9 @@ void AvatarMixer::sendStatsPacket() {
     statsObject["trailing_sleep_percentage"] = _trailingSleepRatio * 100;
     statsObject["performance_throttling_ratio"] = _performanceThrottlingRatio;
 
+    // the less of each frame we get to sleep, the closer we are to falling behind
+    statsObject[ASSIGNMENT_LOAD_STATS_KEY] = glm::clamp(1.0f - _trailingSleepRatio, 0.0f, 1.0f);
+
     QJsonObject avatarsObject;
     
     auto nodeList = DependencyManager::get<NodeList>();
@@ -482,6 +615,15 @@ void AvatarMixer::sendStatsPacket() {
         // add the key to ask the domain-server for a username replacement, if it has it
         avatarStats[USERNAME_UUID_REPLACEMENT_STATS_KEY] = uuidStringWithoutCurlyBraces(node->getUUID());
         avatarStats[NODE_OUTBOUND_KBPS_STAT_KEY] = node->getOutboundBandwidth();
+
+        // what the node's bandwidth shaper is holding back to keep it under max_node_send_bandwidth
+        if (node->isBandwidthShaped()) {
+            QMutexLocker shaperLocker(&node->getBandwidthShaperMutex());
+            const NodeBandwidthShaper& shaper = node->getBandwidthShaper();
+            avatarStats["shaper_queued_bytes"] = shaper.getQueuedBytes();
+            avatarStats["shaper_average_queue_delay_msecs"] = shaper.getAverageQueueDelayUsecs() / USECS_PER_MSEC;
+            avatarStats["shaper_dropped_datagrams"] = (double) shaper.getDroppedDatagrams();
+        }
         
         AvatarMixerClientData* clientData = static_cast<AvatarMixerClientData*>(node->getLinkedData());
         if (clientData) {
@@ -546,6 +688,7 @@ void AvatarMixer::run() {
     
     // parse the settings to pull out the values we need
     parseDomainServerSettings(domainHandler.getSettingsObject());
+    parseAutoscalingSettings(domainHandler.getSettingsObject());
 
     // start the broadcastThread
     _broadcastThread.start();
@@ -563,4 +706,6 @@ void AvatarMixer::parseDomainServerSettings(const QJsonObject& domainSettings) {
 
     _maxKbpsPerNode = nodeBandwidthValue.toDouble(DEFAULT_NODE_SEND_BANDWIDTH) * KILO_PER_MEGA;
     qDebug() << "The maximum send bandwidth per node is" << _maxKbpsPerNode << "kbps."; 
+
+    _nodeBandwidthHintKbps = (int)std::min((double)_maxKbpsPerNode, (double)INT_MAX);
 }
@@ -35,6 +35,8 @@ public slots:
     
 private:
     void broadcastAvatarData();
+    void broadcastKillAvatars(const QList<QUuid>& avatarIDs);
+    bool isHostedAvatarIDAvailable(const QUuid& hostedAvatarID, const SharedNodePointer& hostNode);
     void parseDomainServerSettings(const QJsonObject& domainSettings);
     
     QThread _broadcastThread;
@@ -50,6 +52,7 @@ private:
     int _sumIdentityPackets;
 
     float _maxKbpsPerNode = 0.0f;
+    int _nodeBandwidthHintKbps = 0;
 
     QTimer* _broadcastTimer = nullptr;
 };
@@ -9,16 +9,89 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <QtCore/QDateTime>
+
 #include <PacketHeaders.h>
 
 #include "AvatarMixerClientData.h"
 
+const int AvatarMixerClientData::MAX_HOSTED_AVATARS_PER_NODE = 1024;
+const quint64 AvatarMixerClientData::HOSTED_AVATAR_TIMEOUT_MSECS = 2 * 1000;
+
 int AvatarMixerClientData::parseData(const QByteArray& packet) {
     // compute the offset to the data payload
     int offset = numBytesForPacketHeader(packet);
     return _avatar.parseDataAtOffset(packet, offset);
 }
 
+QUuid AvatarMixerClientData::hostedAvatarIDFromPacket(const QByteArray& packet) {
+    int offset = numBytesForPacketHeader(packet);
+    if (packet.size() < offset + NUM_BYTES_RFC4122_UUID) {
+        return QUuid();
+    }
+    return QUuid::fromRfc4122(packet.mid(offset, NUM_BYTES_RFC4122_UUID));
+}
+
+AvatarMixerClientData::HostedAvatar* AvatarMixerClientData::findOrCreateHostedAvatar(const QUuid& hostedAvatarID,
+                                                                                     bool canCreate) {
+    auto hostedMatch = _hostedAvatars.find(hostedAvatarID);
+    if (hostedMatch != _hostedAvatars.end()) {
+        return hostedMatch->second.get();
+    }
+    if (!canCreate || hostedAvatarID.isNull() || (int)_hostedAvatars.size() >= MAX_HOSTED_AVATARS_PER_NODE) {
+        return NULL;
+    }
+    HostedAvatar* hostedAvatar = new HostedAvatar();
+    _hostedAvatars[hostedAvatarID] = std::unique_ptr<HostedAvatar>(hostedAvatar);
+    return hostedAvatar;
+}
+
+void AvatarMixerClientData::parseHostedAvatarData(const QByteArray& packet, bool canAdd) {
+    QUuid hostedAvatarID = hostedAvatarIDFromPacket(packet);
+    if (hostedAvatarID.isNull()) {
+        return;
+    }
+    int offset = numBytesForPacketHeader(packet);
+
+    HostedAvatar* hostedAvatar = findOrCreateHostedAvatar(hostedAvatarID, canAdd);
+    if (hostedAvatar) {
+        hostedAvatar->avatar.parseDataAtOffset(packet, offset + NUM_BYTES_RFC4122_UUID);
+        hostedAvatar->lastUpdatedTimestamp = QDateTime::currentMSecsSinceEpoch();
+    }
+}
+
+void AvatarMixerClientData::parseHostedAvatarIdentity(const QByteArray& packet) {
+    QUuid hostedAvatarID = hostedAvatarIDFromPacket(packet);
+
+    // identities only count for avatars we already have data for, an identity alone would never expire
+    auto hostedMatch = _hostedAvatars.find(hostedAvatarID);
+    if (hostedMatch != _hostedAvatars.end() && hostedMatch->second->avatar.hasIdentityChangedAfterParsing(packet)) {
+        hostedMatch->second->identityChangeTimestamp = QDateTime::currentMSecsSinceEpoch();
+    }
+}
+
+QList<QUuid> AvatarMixerClientData::removeExpiredHostedAvatars(quint64 now) {
+    QList<QUuid> expiredIDs;
+    auto hostedItr = _hostedAvatars.begin();
+    while (hostedItr != _hostedAvatars.end()) {
+        if (now > hostedItr->second->lastUpdatedTimestamp + HOSTED_AVATAR_TIMEOUT_MSECS) {
+            expiredIDs << hostedItr->first;
+            hostedItr = _hostedAvatars.erase(hostedItr);
+        } else {
+            ++hostedItr;
+        }
+    }
+    return expiredIDs;
+}
+
+QList<QUuid> AvatarMixerClientData::getHostedAvatarIDs() const {
+    QList<QUuid> hostedAvatarIDs;
+    for (auto& hostedAvatar : _hostedAvatars) {
+        hostedAvatarIDs << hostedAvatar.first;
+    }
+    return hostedAvatarIDs;
+}
+
 bool AvatarMixerClientData::checkAndSetHasReceivedFirstPackets() {
     bool oldValue = _hasReceivedFirstPackets;
     _hasReceivedFirstPackets = true;
@@ -43,6 +116,7 @@ void AvatarMixerClientData::loadJSONStats(QJsonObject& jsonObject) const {
     jsonObject["avg_other_avatar_starves_per_second"] = getAvgNumOtherAvatarStarvesPerSecond();
     jsonObject["avg_other_avatar_skips_per_second"] = getAvgNumOtherAvatarSkipsPerSecond();
     jsonObject["total_num_out_of_order_sends"] = _numOutOfOrderSends;
+    jsonObject["num_hosted_avatars"] = (int)_hostedAvatars.size();
     
     jsonObject[OUTBOUND_AVATAR_DATA_STATS_KEY] = getOutboundAvatarDataKbps();
 }
@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <cfloat>
+#include <memory>
 #include <unordered_map>
 
 #include <QtCore/QJsonObject>
@@ -31,8 +32,33 @@ const QString OUTBOUND_AVATAR_DATA_STATS_KEY = "outbound_av_data_kbps";
 class AvatarMixerClientData : public NodeData {
     Q_OBJECT
 public:
+    /// An avatar of one of the scripts an agent host runs, it reaches other nodes under its own ID
+    class HostedAvatar {
+    public:
+        AvatarData avatar;
+        quint64 lastUpdatedTimestamp = 0;
+        quint64 identityChangeTimestamp = 0;
+    };
+    typedef std::unordered_map<QUuid, std::unique_ptr<HostedAvatar>, UUIDHasher> HostedAvatars;
+
+    static const int MAX_HOSTED_AVATARS_PER_NODE;
+    static const quint64 HOSTED_AVATAR_TIMEOUT_MSECS;
+
     int parseData(const QByteArray& packet);
     AvatarData& getAvatar() { return _avatar; }
+
+    /// the ID a hosted avatar packet is for, null if the packet is too short to have one
+    static QUuid hostedAvatarIDFromPacket(const QByteArray& packet);
+
+    /// updates the hosted avatar the packet is for, adding it first only if canAdd is set
+    void parseHostedAvatarData(const QByteArray& packet, bool canAdd);
+    void parseHostedAvatarIdentity(const QByteArray& packet);
+    const HostedAvatars& getHostedAvatars() const { return _hostedAvatars; }
+    bool isHostingAvatar(const QUuid& hostedAvatarID) const { return _hostedAvatars.count(hostedAvatarID) > 0; }
+
+    /// removes the hosted avatars we have not heard from in a while, returns their IDs
+    QList<QUuid> removeExpiredHostedAvatars(quint64 now);
+    QList<QUuid> getHostedAvatarIDs() const;
     
     bool checkAndSetHasReceivedFirstPackets();
 
@@ -76,7 +102,10 @@ public:
     
     void loadJSONStats(QJsonObject& jsonObject) const;
 private:
+    HostedAvatar* findOrCreateHostedAvatar(const QUuid& hostedAvatarID, bool canCreate);
+
     AvatarData _avatar;
+    HostedAvatars _hostedAvatars;
 
     std::unordered_map<QUuid, PacketSequenceNumber, UUIDHasher> _lastBroadcastSequenceNumbers;
 
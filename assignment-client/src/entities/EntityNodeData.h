@@ -12,6 +12,7 @@
 #ifndef hifi_EntityNodeData_h
 #define hifi_EntityNodeData_h
 
+#include <EntityPhysicsStateBatch.h>
 #include <PacketHeaders.h>
 
 #include "../octree/OctreeQueryNode.h"
@@ -27,8 +28,11 @@ public:
     quint64 getLastDeletedEntitiesSentAt() const { return _lastDeletedEntitiesSentAt; }
     void setLastDeletedEntitiesSentAt(quint64 sentAt) { _lastDeletedEntitiesSentAt = sentAt; }
 
+    EntityPhysicsStateBatchReader& getPhysicsStateBatchReader() { return _physicsStateBatchReader; }
+
 private:
     quint64 _lastDeletedEntitiesSentAt;
+    EntityPhysicsStateBatchReader _physicsStateBatchReader;
 };
 
 #endif // hifi_EntityNodeData_h
@@ -11,6 +11,8 @@
 
 #include <QTimer>
 #include <EntityTree.h>
+#include <PhysicalEntitySimulation.h>
+#include <PhysicsHelpers.h>
 #include <SimpleEntitySimulation.h>
 
 #include "EntityServer.h"
@@ -31,9 +33,22 @@ EntityServer::~EntityServer() {
         _pruneDeletedEntitiesTimer->stop();
         _pruneDeletedEntitiesTimer->deleteLater();
     }
+    if (_physicsTimer) {
+        _physicsTimer->stop();
+        _physicsTimer->deleteLater();
+    }
 
     EntityTree* tree = (EntityTree*)_tree;
     tree->removeNewlyCreatedHook(this);
+
+    if (_physicsEngine) {
+        // the motion states have to be handed back to the engine before either of them goes away
+        tree->setSimulation(nullptr);
+        delete _entitySimulation;
+        _entitySimulation = nullptr;
+        delete _physicsEngine;
+        _physicsEngine = nullptr;
+    }
 }
 
 OctreeQueryNode* EntityServer::createOctreeQueryNode() {
@@ -110,6 +125,51 @@ int EntityServer::sendSpecialPacket(const SharedNodePointer& node, OctreeQueryNo
     return packetLength;
 }
 
+bool EntityServer::processSpecialPacket(const SharedNodePointer& node, const QByteArray& packet) {
+    if (packetTypeForPacket(packet) != PacketTypeEntityPhysicsStateBatch) {
+        return false;
+    }
+    EntityNodeData* nodeData = static_cast<EntityNodeData*>(node->getLinkedData());
+    if (!nodeData) {
+        return true;
+    }
+
+    std::vector<EntityPhysicsStateBatchReader::Update> updates;
+    QByteArray ackPayload;
+    if (!nodeData->getPhysicsStateBatchReader().processPayload(packet.mid(numBytesForPacketHeader(packet)),
+                                                               updates, ackPayload)) {
+        qDebug() << "Dropping malformed physics state batch from" << node->getUUID();
+        return true;
+    }
+
+    EntityTree* tree = static_cast<EntityTree*>(_tree);
+    tree->lockForWrite();
+    for (const EntityPhysicsStateBatchReader::Update& update : updates) {
+        EntityItemPointer entity = tree->findEntityByEntityItemID(EntityItemID(update.entityID));
+        if (!entity) {
+            continue;
+        }
+        // these are edits like any other, so the same simulation ownership rules apply
+        EntityItemProperties properties;
+        properties.setPosition(update.state.position);
+        properties.setRotation(update.state.rotation);
+        properties.setVelocity(update.state.velocity);
+        properties.setAngularVelocity(update.state.angularVelocity);
+        properties.setAcceleration(update.state.isBallistic ? entity->getGravity() : glm::vec3(0.0f));
+        properties.setSimulatorID(update.state.isReleasingOwnership ? QUuid() : node->getUUID());
+        if (tree->updateEntity(entity, properties, node)) {
+            entity->markAsChangedOnServer();
+        }
+    }
+    tree->unlock();
+
+    auto nodeList = DependencyManager::get<NodeList>();
+    QByteArray ackPacket = nodeList->byteArrayWithPopulatedHeader(PacketTypeEntityPhysicsStateBatchAck);
+    ackPacket.append(ackPayload);
+    nodeList->writeDatagram(ackPacket, node);
+    return true;
+}
+
 void EntityServer::pruneDeletedEntities() {
     EntityTree* tree = static_cast<EntityTree*>(_tree);
     if (tree->hasAnyDeletedEntities()) {
@@ -138,6 +198,67 @@ void EntityServer::readAdditionalConfiguration(const QJsonObject& settingsSectio
 
     EntityTree* tree = static_cast<EntityTree*>(_tree);
     tree->setWantEditLogging(wantEditLogging);
+
+    bool wantPhysicsSimulation = false;
+    readOptionBool(QString("wantPhysicsSimulation"), settingsSectionObject, wantPhysicsSimulation);
+    qDebug("wantPhysicsSimulation=%s", debug::valueOf(wantPhysicsSimulation));
+
+    if (wantPhysicsSimulation && !_physicsEngine) {
+        startPhysicsSimulation();
+    }
+}
+
+// Runs Bullet next to our tree, in place of the SimpleEntitySimulation. We then simulate every dynamic entity that no
+// interface has claimed, and our results go straight into the tree instead of coming back as a stream of edits.
+// This happens before the persist thread loads the tree, so no entities have to move between the simulations.
+void EntityServer::startPhysicsSimulation() {
+    EntityTree* tree = static_cast<EntityTree*>(_tree);
+
+    ObjectMotionState::setShapeManager(&_shapeManager);
+    _physicsEngine = new PhysicsEngine(glm::vec3(0.0f));
+    _physicsEngine->init();
+
+    PhysicalEntitySimulation* physicalSimulation = new PhysicalEntitySimulation();
+    physicalSimulation->setIsAuthoritative(true);
+    physicalSimulation->init(tree, _physicsEngine, nullptr);
+    tree->setSimulation(physicalSimulation);
+    delete _entitySimulation;
+    _entitySimulation = physicalSimulation;
+
+    _physicsTimer = new QTimer(this);
+    connect(_physicsTimer, &QTimer::timeout, this, &EntityServer::stepPhysics);
+    const int PHYSICS_STEP_INTERVAL_MSECS = (int)(PHYSICS_ENGINE_FIXED_SUBSTEP * MSECS_PER_SECOND);
+    _physicsTimer->start(PHYSICS_STEP_INTERVAL_MSECS);
+
+    qDebug() << "Entity server is simulating physics";
+}
+
+void EntityServer::stepPhysics() {
+    EntityTree* tree = static_cast<EntityTree*>(_tree);
+    PhysicalEntitySimulation* physicalSimulation = static_cast<PhysicalEntitySimulation*>(_entitySimulation);
+
+    // we take ownership under our node's ID, it only exists once we are in the domain
+    _physicsEngine->setSessionUUID(DependencyManager::get<NodeList>()->getSessionUUID());
+
+    // the send and persist threads read the entities we write, so the whole step holds the tree lock. The persist
+    // thread's tree update then sorts the entities that moved into their new elements.
+    tree->lockForWrite();
+    physicalSimulation->lock();
+    _physicsEngine->deleteObjects(physicalSimulation->getObjectsToDelete());
+    _physicsEngine->addObjects(physicalSimulation->getObjectsToAdd());
+    _physicsEngine->changeObjects(physicalSimulation->getObjectsToChange());
+    physicalSimulation->applyActionChanges();
+
+    _physicsEngine->stepSimulation();
+
+    if (_physicsEngine->hasOutgoingChanges()) {
+        physicalSimulation->handleOutgoingChanges(_physicsEngine->getOutgoingChanges(), _physicsEngine->getSessionID());
+
+        // no scripts here care about collisions, but this is also what retires finished contacts
+        _physicsEngine->getCollisionEvents();
+    }
+    physicalSimulation->unlock();
+    tree->unlock();
 }
 
 
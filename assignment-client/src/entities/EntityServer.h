@@ -14,6 +14,9 @@
 
 #include "../octree/OctreeServer.h"
 
+#include <PhysicsEngine.h>
+#include <ShapeManager.h>
+
 #include "EntityItem.h"
 #include "EntityServerConsts.h"
 #include "EntityTree.h"
@@ -39,19 +42,28 @@ public:
     virtual void beforeRun();
     virtual bool hasSpecialPacketToSend(const SharedNodePointer& node);
     virtual int sendSpecialPacket(const SharedNodePointer& node, OctreeQueryNode* queryNode, int& packetsSent);
+    virtual bool processSpecialPacket(const SharedNodePointer& node, const QByteArray& packet);
 
     virtual void entityCreated(const EntityItem& newEntity, const SharedNodePointer& senderNode);
     virtual void readAdditionalConfiguration(const QJsonObject& settingsSectionObject);
 
 public slots:
     void pruneDeletedEntities();
+    void stepPhysics();
 
 protected:
     virtual Octree* createTree();
 
 private:
+    void startPhysicsSimulation();
+
     EntitySimulation* _entitySimulation;
     QTimer* _pruneDeletedEntitiesTimer = nullptr;
+
+    // only used when this server simulates physics itself
+    ShapeManager _shapeManager;
+    PhysicsEngine* _physicsEngine = nullptr;
+    QTimer* _physicsTimer = nullptr;
 };
 
 #endif // hifi_EntityServer_h
@@ -265,12 +265,11 @@ int OctreeInboundPacketProcessor::sendNackPackets() {
 
         const SharedNodePointer& destinationNode = DependencyManager::get<NodeList>()->nodeWithUUID(nodeUUID);
 
-        // retrieve sequence number stats of node, prune its missing set
+        // retrieve sequence number stats of node
         SequenceNumberStats& sequenceNumberStats = nodeStats.getIncomingEditSequenceNumberStats();
-        sequenceNumberStats.pruneMissingSet();
         
         // construct nack packet(s) for this node
-        const QSet<unsigned short int>& missingSequenceNumbers = sequenceNumberStats.getMissingSet();
+        const QSet<unsigned short int> missingSequenceNumbers = sequenceNumberStats.getMissingSet();
         int numSequenceNumbersAvailable = missingSequenceNumbers.size();
         QSet<unsigned short int>::const_iterator missingSequenceNumberIterator = missingSequenceNumbers.constBegin();
         while (numSequenceNumbersAvailable > 0) {
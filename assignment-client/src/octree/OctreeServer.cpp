@@ -858,6 +858,8 @@ void OctreeServer::readPendingDatagram(const QByteArray& receivedPacket, const H
                 }
             } else if (packetType == PacketTypeJurisdictionRequest) {
                 _jurisdictionSender->queueReceivedPacket(matchingNode, receivedPacket);
+            } else if (matchingNode && processSpecialPacket(matchingNode, receivedPacket)) {
+                // handled by the subclass
             } else if (_octreeInboundPacketProcessor && getOctree()->handlesEditPacketType(packetType)) {
                 _octreeInboundPacketProcessor->queueReceivedPacket(matchingNode, receivedPacket);
             } else {
@@ -1402,6 +1404,17 @@ void OctreeServer::sendStatsPacket() {
     statsObject2[baseName + QString(".2.outbound.timing.5.avgSendTime")] = getAveragePacketSendingTime();
     statsObject2[baseName + QString(".2.outbound.timing.5.nodeWaitTime")] = getAverageNodeWaitTime();
 
+    // the send threads write octree packets straight to the node list; only jurisdiction packets are queued
+    if (_jurisdictionSender) {
+        MovingMinMaxAvg<quint64> jurisdictionQueueWaitStats = _jurisdictionSender->getQueueWaitStats();
+        statsObject2[baseName + QString(".2.outbound.jurisdiction.1.queueWaitTimeAvg")] =
+            jurisdictionQueueWaitStats.getWindowAverage();
+        statsObject2[baseName + QString(".2.outbound.jurisdiction.2.queueWaitTimeMin")] =
+            (double)jurisdictionQueueWaitStats.getWindowMin();
+        statsObject2[baseName + QString(".2.outbound.jurisdiction.3.queueWaitTimeMax")] =
+            (double)jurisdictionQueueWaitStats.getWindowMax();
+    }
+
     DependencyManager::get<NodeList>()->sendStatsToDomainServer(statsObject2);
 
     static QJsonObject statsObject3;
@@ -1421,6 +1434,11 @@ void OctreeServer::sendStatsPacket() {
     statsObject3[baseName + QString(".3.inbound.timing.5.avgLockWaitTimePerElement")] = 
         (double)_octreeInboundPacketProcessor->getAverageLockWaitTimePerElement();
 
+    MovingMinMaxAvg<quint64> queueWaitStats = _octreeInboundPacketProcessor->getQueueWaitStats();
+    statsObject3[baseName + QString(".3.inbound.timing.6.queueWaitTimeAvg")] = queueWaitStats.getWindowAverage();
+    statsObject3[baseName + QString(".3.inbound.timing.7.queueWaitTimeMin")] = (double)queueWaitStats.getWindowMin();
+    statsObject3[baseName + QString(".3.inbound.timing.8.queueWaitTimeMax")] = (double)queueWaitStats.getWindowMax();
+
     DependencyManager::get<NodeList>()->sendStatsToDomainServer(statsObject3);
 }
 
@@ -74,6 +74,8 @@ public:
     virtual void beforeRun() { }
     virtual bool hasSpecialPacketToSend(const SharedNodePointer& node) { return false; }
     virtual int sendSpecialPacket(const SharedNodePointer& node, OctreeQueryNode* queryNode, int& packetsSent) { return 0; }
+    /// return true if the packet was handled here and should not be passed on to the edit processor or the node list
+    virtual bool processSpecialPacket(const SharedNodePointer& node, const QByteArray& packet) { return false; }
 
     static float SKIP_TIME; // use this for trackXXXTime() calls for non-times
 
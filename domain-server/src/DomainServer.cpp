@@ -9,6 +9,9 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <algorithm>
+#include <iterator>
+
 #include <openssl/err.h>
 #include <openssl/rsa.h>
 #include <openssl/x509.h>
@@ -29,6 +32,7 @@
 #include <JSONBreakableMarshal.h>
 #include <LogUtils.h>
 #include <NetworkingConstants.h>
+#include <NumericalConstants.h>
 #include <PacketHeaders.h>
 #include <SettingHandle.h>
 #include <SharedUtil.h>
@@ -48,6 +52,24 @@ const QString MAXIMUM_USER_CAPACITY = "security.maximum_user_capacity";
 const QString ALLOWED_EDITORS_SETTINGS_KEYPATH = "security.allowed_editors";
 const QString EDITORS_ARE_REZZERS_KEYPATH = "security.editors_are_rezzers";
 
+const QString MIXER_REPLICATION_ENABLED_KEY_PATH = "autoscaling.enable_mixer_replication";
+const QString MIXER_LOAD_THRESHOLD_KEY_PATH = "autoscaling.load_threshold";
+const QString MIXER_SUSTAINED_LOAD_SECONDS_KEY_PATH = "autoscaling.sustained_load_seconds";
+const QString MAX_MIXER_REPLICAS_KEY_PATH = "autoscaling.max_mixer_replicas";
+
+// Mixer types the domain-server can run more than one of. Clients talk to a single mixer of each type and mixers don't
+// exchange streams, so mixers are replicated in shards of one mixer of each type and each node is given one shard in
+// its domain list. Users on the same shard hear and see the same people, users on different shards neither hear nor
+// see each other. Shards are only added when every one is overloaded and retired once nobody has been on them for a
+// while, so the audience is only split while one shard couldn't serve it anyway.
+const NodeType_t REPLICABLE_MIXER_TYPES[] = { NodeType::AudioMixer, NodeType::AvatarMixer };
+const int STATIC_MIXER_SHARD = 0;
+
+static bool isReplicableMixerType(NodeType_t nodeType) {
+    return std::find(std::begin(REPLICABLE_MIXER_TYPES), std::end(REPLICABLE_MIXER_TYPES), nodeType)
+        != std::end(REPLICABLE_MIXER_TYPES);
+}
+
 DomainServer::DomainServer(int argc, char* argv[]) :
     QCoreApplication(argc, argv),
     _httpManager(DOMAIN_SERVER_HTTP_PORT, QString("%1/resources/web/").arg(QCoreApplication::applicationDirPath()), this),
@@ -282,6 +304,12 @@ void DomainServer::setupNodeListAndAssignments(const QUuid& sessionUUID) {
 
     // add whatever static assignments that have been parsed to the queue
     addStaticAssignmentsToQueue();
+
+    // every so often see if a mixer has been struggling for long enough that it needs help
+    const int CHECK_MIXER_LOAD_INTERVAL_MSECS = 5 * 1000;
+    QTimer* mixerLoadTimer = new QTimer(this);
+    connect(mixerLoadTimer, &QTimer::timeout, this, &DomainServer::checkMixerLoad);
+    mixerLoadTimer->start(CHECK_MIXER_LOAD_INTERVAL_MSECS);
 }
 
 bool DomainServer::didSetupAccountManagerWithAccessToken() {
@@ -482,6 +510,7 @@ void DomainServer::populateStaticScriptedAssignmentsFromSettings() {
             const QString PERSISTENT_SCRIPT_URL_KEY = "url";
             const QString PERSISTENT_SCRIPT_NUM_INSTANCES_KEY = "num_instances";
             const QString PERSISTENT_SCRIPT_POOL_KEY = "pool";
+            const QString PERSISTENT_SCRIPT_INSTANCES_PER_PROCESS_KEY = "instances_per_process";
 
             if (persistentScript.contains(PERSISTENT_SCRIPT_URL_KEY)) {
                 // check how many instances of this script to add
@@ -493,12 +522,22 @@ void DomainServer::populateStaticScriptedAssignmentsFromSettings() {
 
                 qDebug() << "Adding" << numInstances << "of persistent script at URL" << scriptURL << "- pool" << scriptPool;
 
-                for (int i = 0; i < numInstances; ++i) {
+                int instancesPerProcess = std::max(persistentScript.value(PERSISTENT_SCRIPT_INSTANCES_PER_PROCESS_KEY).toInt(), 1);
+
+                for (int i = 0; i < numInstances; i += instancesPerProcess) {
                     // add a scripted assignment to the queue for this instance
                     Assignment* scriptAssignment = new Assignment(Assignment::CreateCommand,
                                                                   Assignment::AgentType,
                                                                   scriptPool);
-                    scriptAssignment->setPayload(scriptURL.toUtf8());
+                    if (instancesPerProcess == 1) {
+                        scriptAssignment->setPayload(scriptURL.toUtf8());
+                    } else {
+                        // one agent host runs all the instances for this assignment
+                        QJsonObject hostPayload;
+                        hostPayload[PERSISTENT_SCRIPT_URL_KEY] = scriptURL;
+                        hostPayload[PERSISTENT_SCRIPT_NUM_INSTANCES_KEY] = std::min(instancesPerProcess, numInstances - i);
+                        scriptAssignment->setPayload(QJsonDocument(hostPayload).toJson(QJsonDocument::Compact));
+                    }
 
                     // add it to static hash so we know we have to keep giving it back out
                     addStaticAssignmentToAssignmentHash(scriptAssignment);
@@ -685,6 +724,7 @@ void DomainServer::handleConnectRequest(const QByteArray& packet, const HifiSock
             // always allow assignment clients to create and destroy entities
             newNode->setCanAdjustLocks(true);
             newNode->setCanRez(true);
+            newNode->setIsAssignment(true);
 
             // now that we've pulled the wallet UUID and added the node to our list, delete the pending assignee data
             delete pendingAssigneeData;
@@ -942,12 +982,31 @@ void DomainServer::sendDomainListToNode(const SharedNodePointer& node, const Hif
         int dataMTU = MAX_PACKET_SIZE;
 
         if (nodeData->isAuthenticated()) {
+            // if there is more than one shard of mixers this node only hears about the mixers of the one it was given
+            QHash<NodeType_t, QUuid> assignedMixers;
+            if (isMixerReplicationEnabled()) {
+                int shard = NO_MIXER_SHARD;
+                for (NodeType_t mixerType : REPLICABLE_MIXER_TYPES) {
+                    if (nodeInterestSet.contains(mixerType)) {
+                        if (shard == NO_MIXER_SHARD) {
+                            shard = mixerShardForNode(node);
+                        }
+                        assignedMixers.insert(mixerType, mixerInShard(shard, mixerType));
+                    }
+                }
+            }
+
             // if this authenticated node has any interest types, send back those nodes as well
             limitedNodeList->eachNode([&](const SharedNodePointer& otherNode){
                 // reset our nodeByteArray and nodeDataStream
                 QByteArray nodeByteArray;
                 QDataStream nodeDataStream(&nodeByteArray, QIODevice::Append);
 
+                if (assignedMixers.contains(otherNode->getType())
+                    && assignedMixers[otherNode->getType()] != otherNode->getUUID()) {
+                    return;
+                }
+
                 if (otherNode->getUUID() != node->getUUID() && nodeInterestSet.contains(otherNode->getType())) {
 
                     // don't send avatar nodes to other avatars, that will come from avatar mixer
@@ -999,6 +1058,189 @@ QUuid DomainServer::connectionSecretForNodes(const SharedNodePointer& nodeA, con
     return QUuid();
 }
 
+bool DomainServer::isMixerReplicationEnabled() {
+    return _settingsManager.valueOrDefaultValueForKeyPath(MIXER_REPLICATION_ENABLED_KEY_PATH).toBool();
+}
+
+int DomainServer::mixerShard(const SharedNodePointer& mixer) {
+    // replicas are the mixers we queued an assignment for ourselves, statically configured mixers share shard 0
+    DomainServerNodeData* mixerData = reinterpret_cast<DomainServerNodeData*>(mixer->getLinkedData());
+    if (!mixerData) {
+        return STATIC_MIXER_SHARD;
+    }
+    return _replicaShards.value(mixerData->getAssignmentUUID(), STATIC_MIXER_SHARD);
+}
+
+int DomainServer::mixerShardForNode(const SharedNodePointer& node) {
+    DomainServerNodeData* nodeData = reinterpret_cast<DomainServerNodeData*>(node->getLinkedData());
+
+    // a shard is complete once it has a mixer of every replicable type running in the domain, a shard's load is the
+    // load of its busiest mixer
+    QSet<NodeType_t> runningMixerTypes;
+    QHash<int, QSet<NodeType_t> > shardMixerTypes;
+    QHash<int, float> shardLoads;
+
+    DependencyManager::get<LimitedNodeList>()->eachMatchingNode(
+        [&](const SharedNodePointer& mixer)->bool {
+            return isReplicableMixerType(mixer->getType());
+        },
+        [&](const SharedNodePointer& mixer) {
+            int shard = mixerShard(mixer);
+            float load = reinterpret_cast<DomainServerNodeData*>(mixer->getLinkedData())->getLoad();
+            runningMixerTypes.insert(mixer->getType());
+            shardMixerTypes[shard].insert(mixer->getType());
+            shardLoads[shard] = std::max(shardLoads.value(shard), load);
+        });
+
+    // stick with the shard this node already has, moving it would cut it off from the nodes it is mixed with
+    int currentShard = nodeData->getMixerShard();
+    if (currentShard != NO_MIXER_SHARD && shardMixerTypes.value(currentShard) == runningMixerTypes) {
+        return currentShard;
+    }
+
+    // fill the static mixers first while they can take it, so that replicas empty out when the crowd thins
+    float loadThreshold = _settingsManager.valueOrDefaultValueForKeyPath(MIXER_LOAD_THRESHOLD_KEY_PATH).toFloat();
+    int chosenShard = STATIC_MIXER_SHARD;
+
+    if (shardMixerTypes.value(STATIC_MIXER_SHARD) != runningMixerTypes
+        || shardLoads.value(STATIC_MIXER_SHARD) > loadThreshold) {
+        float leastLoad = 0.0f;
+        bool hasCompleteShard = false;
+        for (auto it = shardLoads.constBegin(); it != shardLoads.constEnd(); ++it) {
+            if (shardMixerTypes[it.key()] == runningMixerTypes && (!hasCompleteShard || it.value() < leastLoad)) {
+                chosenShard = it.key();
+                leastLoad = it.value();
+                hasCompleteShard = true;
+            }
+        }
+    }
+
+    nodeData->setMixerShard(chosenShard);
+    return chosenShard;
+}
+
+QUuid DomainServer::mixerInShard(int shard, NodeType_t mixerType) {
+    // the first by UUID, so that every node on a shard with more than one static mixer of a type is given the same one
+    QUuid mixerUUID;
+
+    DependencyManager::get<LimitedNodeList>()->eachMatchingNode(
+        [&](const SharedNodePointer& mixer)->bool {
+            return mixer->getType() == mixerType && mixerShard(mixer) == shard;
+        },
+        [&](const SharedNodePointer& mixer) {
+            if (mixerUUID.isNull() || mixer->getUUID() < mixerUUID) {
+                mixerUUID = mixer->getUUID();
+            }
+        });
+
+    return mixerUUID;
+}
+
+void DomainServer::checkMixerLoad() {
+    auto nodeList = DependencyManager::get<LimitedNodeList>();
+    bool isReplicationEnabled = isMixerReplicationEnabled();
+    quint64 now = usecTimestampNow();
+    float loadThreshold = _settingsManager.valueOrDefaultValueForKeyPath(MIXER_LOAD_THRESHOLD_KEY_PATH).toFloat();
+    quint64 sustainedUsecs =
+        _settingsManager.valueOrDefaultValueForKeyPath(MIXER_SUSTAINED_LOAD_SECONDS_KEY_PATH).toUInt() * USECS_PER_SECOND;
+
+    // Retire replica shards nobody has been given for a while, as long as the static mixers have room for whoever
+    // comes next. Retire all of them once replication is turned off, since every node then hears about every mixer.
+    QSet<int> shardsInUse;
+    bool hasStaticMixer = false;
+    bool isStaticShardOverloaded = false;
+    nodeList->eachNode([&](const SharedNodePointer& node) {
+        DomainServerNodeData* nodeData = reinterpret_cast<DomainServerNodeData*>(node->getLinkedData());
+        if (nodeData) {
+            shardsInUse.insert(nodeData->getMixerShard());
+            if (isReplicableMixerType(node->getType()) && mixerShard(node) == STATIC_MIXER_SHARD) {
+                hasStaticMixer = true;
+                isStaticShardOverloaded = isStaticShardOverloaded || nodeData->getLoad() > loadThreshold;
+            }
+        }
+    });
+
+    bool staticShardHasRoom = hasStaticMixer && !isStaticShardOverloaded;
+
+    QVector<QUuid> retiredMixers;
+    nodeList->eachMatchingNode(
+        [&](const SharedNodePointer& node)->bool {
+            return isReplicableMixerType(node->getType()) && mixerShard(node) != STATIC_MIXER_SHARD;
+        },
+        [&](const SharedNodePointer& replica) {
+            DomainServerNodeData* replicaData = reinterpret_cast<DomainServerNodeData*>(replica->getLinkedData());
+            bool isIdle = !shardsInUse.contains(mixerShard(replica)) && staticShardHasRoom;
+            if (replicaData->updateIdleState(isIdle, sustainedUsecs, now) || !isReplicationEnabled) {
+                retiredMixers.append(replica->getUUID());
+                _replicaShards.remove(replicaData->getAssignmentUUID());
+            }
+        });
+
+    foreach(const QUuid& mixerUUID, retiredMixers) {
+        // its assignment is not static so it isn't queued again, and the assignment-client stops when its check-ins
+        // go unanswered
+        qDebug() << "Retiring mixer replica" << uuidStringWithoutCurlyBraces(mixerUUID);
+        nodeList->killNodeWithUUID(mixerUUID);
+    }
+
+    if (!isReplicationEnabled) {
+        return;
+    }
+
+    int maxShards = _settingsManager.valueOrDefaultValueForKeyPath(MAX_MIXER_REPLICAS_KEY_PATH).toInt();
+
+    // a shard is overloaded as soon as one of its mixers is
+    QHash<int, bool> shardOverloads;
+    QHash<NodeType_t, QString> assignmentPools;
+
+    nodeList->eachMatchingNode(
+        [&](const SharedNodePointer& mixer)->bool {
+            return isReplicableMixerType(mixer->getType());
+        },
+        [&](const SharedNodePointer& mixer) {
+            DomainServerNodeData* mixerData = reinterpret_cast<DomainServerNodeData*>(mixer->getLinkedData());
+            int shard = mixerShard(mixer);
+
+            bool isOverloaded = mixerData->updateOverloadedState(loadThreshold, sustainedUsecs, now);
+            shardOverloads[shard] = shardOverloads.value(shard) || isOverloaded;
+
+            SharedAssignmentPointer mixerAssignment = _allAssignments.value(mixerData->getAssignmentUUID());
+            if (mixerAssignment) {
+                assignmentPools[mixer->getType()] = mixerAssignment->getPool();
+            } else if (!assignmentPools.contains(mixer->getType())) {
+                assignmentPools.insert(mixer->getType(), QString());
+            }
+        });
+
+    // only add a shard when every one we already have is struggling
+    if (shardOverloads.isEmpty() || shardOverloads.values().contains(false) || shardOverloads.size() >= maxShards) {
+        return;
+    }
+
+    // and only one at a time, wait for the mixers of the last one we asked for to be picked up
+    foreach(const SharedAssignmentPointer& assignment, _unfulfilledAssignments) {
+        if (_replicaShards.contains(assignment->getUUID())) {
+            return;
+        }
+    }
+
+    int newShard = STATIC_MIXER_SHARD + 1;
+    foreach(int shard, _replicaShards) {
+        newShard = std::max(newShard, shard + 1);
+    }
+
+    qDebug() << "All" << shardOverloads.size() << "mixer shards have been above" << loadThreshold << "load for"
+        << sustainedUsecs / USECS_PER_SECOND << "seconds, adding another.";
+
+    for (auto it = assignmentPools.constBegin(); it != assignmentPools.constEnd(); ++it) {
+        SharedAssignmentPointer replicaAssignment(new Assignment(Assignment::CreateCommand,
+                                                                 Assignment::typeForNodeType(it.key()), it.value()));
+        _allAssignments.insert(replicaAssignment->getUUID(), replicaAssignment);
+        _unfulfilledAssignments.enqueue(replicaAssignment);
+        _replicaShards.insert(replicaAssignment->getUUID(), newShard);
+    }
+}
+
 void DomainServer::broadcastNewNode(const SharedNodePointer& addedNode) {
 
     auto limitedNodeList = DependencyManager::get<LimitedNodeList>();
@@ -1011,11 +1253,22 @@ void DomainServer::broadcastNewNode(const SharedNodePointer& addedNode) {
 
     int connectionSecretIndex = addNodePacket.size();
 
+    // a new mixer only goes to the nodes on its shard, and only if it is the one they would be given in a domain list
+    bool isReplicableMixer = isMixerReplicationEnabled() && isReplicableMixerType(addedNode->getType());
+    int addedMixerShard = NO_MIXER_SHARD;
+    if (isReplicableMixer && mixerInShard(mixerShard(addedNode), addedNode->getType()) == addedNode->getUUID()) {
+        addedMixerShard = mixerShard(addedNode);
+    }
+
     limitedNodeList->eachMatchingNode(
         [&](const SharedNodePointer& node)->bool {
             if (node->getLinkedData() && node->getActiveSocket() && node != addedNode) {
                 // is the added Node in this node's interest list?
                 DomainServerNodeData* nodeData = dynamic_cast<DomainServerNodeData*>(node->getLinkedData());
+                if (isReplicableMixer
+                    && (addedMixerShard == NO_MIXER_SHARD || nodeData->getMixerShard() != addedMixerShard)) {
+                    return false;
+                }
                 return nodeData->getNodeInterestSet().contains(addedNode->getType());
             } else {
                 return false;
@@ -68,6 +68,8 @@ private slots:
     void sendHeartbeatToDataServer() { sendHeartbeatToDataServer(QString()); }
     void sendHeartbeatToIceServer();
     void handlePeerPingTimeout();
+
+    void checkMixerLoad();
 private:
     void setupNodeListAndAssignments(const QUuid& sessionUUID = QUuid::createUuid());
     bool optionallySetupOAuth();
@@ -104,6 +106,10 @@ private:
                               const NodeSet& nodeInterestSet);
 
     QUuid connectionSecretForNodes(const SharedNodePointer& nodeA, const SharedNodePointer& nodeB);
+    bool isMixerReplicationEnabled();
+    int mixerShard(const SharedNodePointer& mixer);
+    int mixerShardForNode(const SharedNodePointer& node);
+    QUuid mixerInShard(int shard, NodeType_t mixerType);
     void broadcastNewNode(const SharedNodePointer& node);
 
     void parseAssignmentConfigs(QSet<Assignment::Type>& excludedTypes);
@@ -140,6 +146,7 @@ private:
 
     QHash<QUuid, SharedAssignmentPointer> _allAssignments;
     QQueue<SharedAssignmentPointer> _unfulfilledAssignments;
+    QHash<QUuid, int> _replicaShards; // shard of each mixer replica assignment we queued, static mixers are shard 0
     QHash<QUuid, PendingAssignedNodeData*> _pendingAssignedNodes;
     TransactionHash _pendingAssignmentCredits;
 
@@ -15,6 +15,7 @@
 
 #include <JSONBreakableMarshal.h>
 #include <PacketHeaders.h>
+#include <ThreadedAssignment.h>
 
 #include "DomainServerNodeData.h"
 
@@ -26,7 +27,11 @@ DomainServerNodeData::DomainServerNodeData() :
     _paymentIntervalTimer(),
     _statsJSONObject(),
     _sendingSockAddr(),
-    _isAuthenticated(true)
+    _isAuthenticated(true),
+    _load(0.0f),
+    _overloadedSince(0),
+    _idleSince(0),
+    _mixerShard(NO_MIXER_SHARD)
 {
     _paymentIntervalTimer.start();
 }
@@ -34,6 +39,36 @@ DomainServerNodeData::DomainServerNodeData() :
 void DomainServerNodeData::parseJSONStatsPacket(const QByteArray& statsPacket) {
     QVariantMap packetVariantMap = JSONBreakableMarshal::fromStringBuffer(statsPacket.mid(numBytesForPacketHeader(statsPacket)));
     _statsJSONObject = mergeJSONStatsFromNewObject(QJsonObject::fromVariantMap(packetVariantMap), _statsJSONObject);
+
+    if (_statsJSONObject.contains(ASSIGNMENT_LOAD_STATS_KEY)) {
+        _load = _statsJSONObject[ASSIGNMENT_LOAD_STATS_KEY].toDouble();
+    }
+}
+
+bool DomainServerNodeData::updateOverloadedState(float loadThreshold, quint64 sustainedUsecs, quint64 now) {
+    if (_load <= loadThreshold) {
+        _overloadedSince = 0;
+        return false;
+    }
+
+    if (_overloadedSince == 0) {
+        _overloadedSince = now;
+    }
+
+    return now - _overloadedSince >= sustainedUsecs;
+}
+
+bool DomainServerNodeData::updateIdleState(bool isIdle, quint64 sustainedUsecs, quint64 now) {
+    if (!isIdle) {
+        _idleSince = 0;
+        return false;
+    }
+
+    if (_idleSince == 0) {
+        _idleSince = now;
+    }
+
+    return now - _idleSince >= sustainedUsecs;
 }
 
 QJsonObject DomainServerNodeData::mergeJSONStatsFromNewObject(const QJsonObject& newObject, QJsonObject destinationObject) {
@@ -20,6 +20,8 @@
 #include <NodeData.h>
 #include <NodeType.h>
 
+const int NO_MIXER_SHARD = -1;
+
 class DomainServerNodeData : public NodeData {
 public:
     DomainServerNodeData();
@@ -29,6 +31,19 @@ public:
 
     void parseJSONStatsPacket(const QByteArray& statsPacket);
 
+    /// load the assignment on this node last reported in its stats, 0 if it doesn't report one
+    float getLoad() const { return _load; }
+
+    /// Returns true once the reported load has stayed above the threshold for the given time.
+    bool updateOverloadedState(float loadThreshold, quint64 sustainedUsecs, quint64 now);
+
+    /// Returns true once this node has stayed idle for the given time.
+    bool updateIdleState(bool isIdle, quint64 sustainedUsecs, quint64 now);
+
+    /// which shard of audio and avatar mixers this node has been given in its domain list
+    void setMixerShard(int mixerShard) { _mixerShard = mixerShard; }
+    int getMixerShard() const { return _mixerShard; }
+
     void setAssignmentUUID(const QUuid& assignmentUUID) { _assignmentUUID = assignmentUUID; }
     const QUuid& getAssignmentUUID() const { return _assignmentUUID; }
 
@@ -62,6 +77,10 @@ private:
     HifiSockAddr _sendingSockAddr;
     bool _isAuthenticated;
     NodeSet _nodeInterestSet;
+    float _load;
+    quint64 _overloadedSince;
+    quint64 _idleSince;
+    int _mixerShard;
 };
 
 #endif // hifi_DomainServerNodeData_h
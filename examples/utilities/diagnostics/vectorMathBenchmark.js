@@ -0,0 +1,86 @@
+//
+//  vectorMathBenchmark.js
+//  examples/utilities/diagnostics
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Times a particle style update, position += velocity * dt and velocity rotated a little, done one vector at a time
+//  through Vec3 and Quat and done in batches on Float32Arrays, and checks that both give the same answer.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+var NUM_PARTICLES = 2000;
+var NUM_FRAMES = 60;
+var DT = 1.0 / 60.0;
+var TURN = Quat.fromPitchYawRollDegrees(0, 2, 0);
+var TOLERANCE = 0.001;
+
+function initialPosition(i) {
+    return { x: i % 10, y: Math.floor(i / 10) % 10, z: Math.floor(i / 100) };
+}
+
+function initialVelocity(i) {
+    return { x: Math.sin(i), y: 0.5, z: Math.cos(i) };
+}
+
+function runPerVector() {
+    var positions = [];
+    var velocities = [];
+    for (var i = 0; i < NUM_PARTICLES; i++) {
+        positions.push(initialPosition(i));
+        velocities.push(initialVelocity(i));
+    }
+
+    var start = Date.now();
+    for (var frame = 0; frame < NUM_FRAMES; frame++) {
+        for (var i = 0; i < NUM_PARTICLES; i++) {
+            velocities[i] = Vec3.multiplyQbyV(TURN, velocities[i]);
+            positions[i] = Vec3.sum(positions[i], Vec3.multiply(velocities[i], DT));
+        }
+    }
+    return { msecs: Date.now() - start, positions: positions };
+}
+
+function runBatched() {
+    var positions = new Float32Array(3 * NUM_PARTICLES);
+    var velocities = new Float32Array(3 * NUM_PARTICLES);
+    for (var i = 0; i < NUM_PARTICLES; i++) {
+        var position = initialPosition(i);
+        var velocity = initialVelocity(i);
+        positions[3 * i] = position.x;
+        positions[3 * i + 1] = position.y;
+        positions[3 * i + 2] = position.z;
+        velocities[3 * i] = velocity.x;
+        velocities[3 * i + 1] = velocity.y;
+        velocities[3 * i + 2] = velocity.z;
+    }
+
+    var start = Date.now();
+    for (var frame = 0; frame < NUM_FRAMES; frame++) {
+        Quat.multiplyVec3Array(velocities, TURN, velocities);
+        Vec3.addScaledArrays(positions, positions, velocities, DT);
+    }
+    return { msecs: Date.now() - start, positions: positions };
+}
+
+var perVector = runPerVector();
+var batched = runBatched();
+
+var mismatches = 0;
+for (var i = 0; i < NUM_PARTICLES; i++) {
+    var expected = perVector.positions[i];
+    if (Math.abs(batched.positions[3 * i] - expected.x) > TOLERANCE ||
+        Math.abs(batched.positions[3 * i + 1] - expected.y) > TOLERANCE ||
+        Math.abs(batched.positions[3 * i + 2] - expected.z) > TOLERANCE) {
+        mismatches++;
+    }
+}
+
+print("vectorMathBenchmark: " + NUM_PARTICLES + " particles for " + NUM_FRAMES + " frames");
+print("    per vector: " + perVector.msecs + " msecs");
+print("    batched:    " + batched.msecs + " msecs");
+print("    " + (mismatches == 0 ? "results match" : "FAILED - " + mismatches + " positions differ"));
+
+Script.stop();
@@ -36,7 +36,6 @@
 #include <QMenuBar>
 #include <QMouseEvent>
 #include <QNetworkReply>
-#include <QNetworkDiskCache>
 #include <QObject>
 #include <QWheelEvent>
 #include <QScreen>
@@ -57,6 +56,7 @@
 
 #include <AccountManager.h>
 #include <AddressManager.h>
+#include <AssetCache.h>
 #include <CursorManager.h>
 #include <AmbientOcclusionEffect.h>
 #include <AudioInjector.h>
@@ -517,12 +517,10 @@ Application::Application(int& argc, char** argv, QElapsedTimer &startup_time) :
     connect(billboardPacketTimer, &QTimer::timeout, _myAvatar, &MyAvatar::sendBillboardPacket);
     billboardPacketTimer->start(AVATAR_BILLBOARD_PACKET_SEND_INTERVAL_MSECS);
 
+    // every thread's network access manager shares the one disk cache of assets
     QString cachePath = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
-    QNetworkAccessManager& networkAccessManager = NetworkAccessManager::getInstance();
-    QNetworkDiskCache* cache = new QNetworkDiskCache();
-    cache->setMaximumCacheSize(MAXIMUM_CACHE_SIZE);
-    cache->setCacheDirectory(!cachePath.isEmpty() ? cachePath : "interfaceCache");
-    networkAccessManager.setCache(cache);
+    NetworkAccessManager::setAssetCache(QSharedPointer<AssetCache>(new AssetCache(
+        (!cachePath.isEmpty() ? cachePath : "interfaceCache") + "/assets", MAXIMUM_CACHE_SIZE)));
 
     ResourceCache::setRequestLimit(3);
 
@@ -2589,6 +2587,13 @@ void Application::update(float deltaTime) {
         loadViewFrustum(_myCamera, _viewFrustum);
     }
 
+    // rank downloads by what the new view shows
+    {
+        PerformanceTimer perfTimer("resourceRequests");
+        Model::updateLoadPriorities();
+        ResourceCache::updateRequests();
+    }
+
     quint64 now = usecTimestampNow();
 
     // Update my voxel servers with my current voxel query...
@@ -2663,9 +2668,8 @@ int Application::sendNackPackets() {
                 return;
             }
 
-            // get sequence number stats of node, prune its missing set, and make a copy of the missing set
+            // get sequence number stats of node and make a copy of the missing set
             SequenceNumberStats& sequenceNumberStats = _octreeServerSceneStats[nodeUUID].getIncomingOctreeSequenceNumberStats();
-            sequenceNumberStats.pruneMissingSet();
             const QSet<OCTREE_PACKET_SEQUENCE> missingSequenceNumbers = sequenceNumberStats.getMissingSet();
 
             _octreeSceneStatsLock.unlock();
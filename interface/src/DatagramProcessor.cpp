@@ -159,6 +159,9 @@ void DatagramProcessor::processDatagrams() {
                         application->_entityEditSender.processNackPacket(incomingPacket);
                     }
                     break;
+                case PacketTypeEntityPhysicsStateBatchAck:
+                    application->_entityEditSender.processPhysicsStateBatchAck(incomingPacket);
+                    break;
                 default:
                     nodeList->processNodeData(senderSockAddr, incomingPacket);
                     break;
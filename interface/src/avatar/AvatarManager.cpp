@@ -60,7 +60,10 @@ AvatarManager::AvatarManager(QObject* parent) :
 
 void AvatarManager::init() {
     _myAvatar->init();
-    _avatarHash.insert(MY_AVATAR_KEY, _myAvatar);
+    {
+        QWriteLocker locker(&_hashLock);
+        _avatarHash.insert(MY_AVATAR_KEY, _myAvatar);
+    }
 
     render::ScenePointer scene = Application::getInstance()->getMain3DScene();
     render::PendingChanges pendingChanges;
@@ -95,6 +98,7 @@ void AvatarManager::updateOtherAvatars(float deltaTime) {
     PerformanceTimer perfTimer("otherAvatars");
     
     // simulate avatars
+    QWriteLocker locker(&_hashLock);
     AvatarHash::iterator avatarIterator = _avatarHash.begin();
     while (avatarIterator != _avatarHash.end()) {
         auto avatar = std::dynamic_pointer_cast<Avatar>(avatarIterator.value());
@@ -111,6 +115,7 @@ void AvatarManager::updateOtherAvatars(float deltaTime) {
             ++avatarIterator;
         }
     }
+    locker.unlock();
     
     // simulate avatar fades
     simulateAvatarFades(deltaTime);
@@ -167,6 +172,7 @@ void AvatarManager::removeAvatarMotionState(Avatar* avatar) {
 
 // virtual 
 void AvatarManager::removeAvatar(const QUuid& sessionUUID) {
+    QWriteLocker locker(&_hashLock);
     AvatarHash::iterator avatarIterator = _avatarHash.find(sessionUUID);
     if (avatarIterator != _avatarHash.end()) {
         std::shared_ptr<Avatar> avatar = std::dynamic_pointer_cast<Avatar>(avatarIterator.value());
@@ -180,6 +186,7 @@ void AvatarManager::removeAvatar(const QUuid& sessionUUID) {
 
 void AvatarManager::clearOtherAvatars() {
     // clear any avatars that came from an avatar-mixer
+    QWriteLocker locker(&_hashLock);
     AvatarHash::iterator avatarIterator =  _avatarHash.begin();
     while (avatarIterator != _avatarHash.end()) {
         auto avatar = std::static_pointer_cast<Avatar>(avatarIterator.value());
@@ -16,9 +16,9 @@
 #include <QGridLayout>
 #include <QPushButton>
 #include <QLabel>
-#include <QNetworkDiskCache>
 #include <QMessageBox>
 
+#include <AssetCache.h>
 #include <NetworkAccessManager.h>
 
 #include "DiskCacheEditor.h"
@@ -121,16 +121,18 @@ void DiskCacheEditor::refresh() {
         }
         return QString("%0 %1").arg(number).arg(UNITS[i]);
     };
-    QNetworkDiskCache* cache = qobject_cast<QNetworkDiskCache*>(NetworkAccessManager::getInstance().cache());
-    
+    QSharedPointer<AssetCache> cache = NetworkAccessManager::getAssetCache();
+    if (!cache) {
+        return;
+    }
     if (_path) {
-        _path->setText(cache->cacheDirectory());
+        _path->setText(cache->getDirectory());
     }
     if (_size) {
-        _size->setText(stringify(cache->cacheSize()));
+        _size->setText(stringify(cache->getSize()));
     }
     if (_maxSize) {
-        _maxSize->setText(stringify(cache->maximumCacheSize()));
+        _maxSize->setText(stringify(cache->getMaximumSize()));
     }
 }
 
@@ -140,7 +142,7 @@ void DiskCacheEditor::clear() {
                                               "You are about to erase all the content of the disk cache,"
                                               "are you sure you want to do that?");
     if (buttonClicked == QMessageBox::Yes) {
-        QNetworkDiskCache* cache = qobject_cast<QNetworkDiskCache*>(NetworkAccessManager::getInstance().cache());
+        QSharedPointer<AssetCache> cache = NetworkAccessManager::getAssetCache();
         if (cache) {
             qDebug() << "DiskCacheEditor::clear(): Clearing disk cache.";
             cache->clear();
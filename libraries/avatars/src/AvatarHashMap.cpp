@@ -40,6 +40,7 @@ void AvatarHashMap::processAvatarMixerDatagram(const QByteArray& datagram, const
 }
 
 bool AvatarHashMap::isAvatarInRange(const glm::vec3& position, const float range) {
+    QReadLocker locker(&_hashLock);
     foreach(const AvatarSharedPointer& sharedAvatar, _avatarHash) {
         glm::vec3 avatarPosition = sharedAvatar->getPosition();
         float distance = glm::distance(avatarPosition, position);
@@ -60,6 +61,8 @@ AvatarSharedPointer AvatarHashMap::addAvatar(const QUuid& sessionUUID, const QWe
     AvatarSharedPointer avatar = newSharedAvatar();
     avatar->setSessionUUID(sessionUUID);
     avatar->setOwningAvatarMixer(mixerWeakPointer);
+    
+    QWriteLocker locker(&_hashLock);
     _avatarHash.insert(sessionUUID, avatar);
 
     return avatar;
@@ -75,7 +78,7 @@ void AvatarHashMap::processAvatarDataPacket(const QByteArray &datagram, const QW
         bytesRead += NUM_BYTES_RFC4122_UUID;
         
         if (sessionUUID != _lastOwnerSessionUUID) {
-            AvatarSharedPointer avatar = _avatarHash.value(sessionUUID);
+            AvatarSharedPointer avatar = findAvatar(sessionUUID);
             if (!avatar) {
                 avatar = addAvatar(sessionUUID, mixerWeakPointer);
             }
@@ -105,7 +108,7 @@ void AvatarHashMap::processAvatarIdentityPacket(const QByteArray &packet, const
         identityStream >> sessionUUID >> faceMeshURL >> skeletonURL >> attachmentData >> displayName;
         
         // mesh URL for a UUID, find avatar in our list
-        AvatarSharedPointer avatar = _avatarHash.value(sessionUUID);
+        AvatarSharedPointer avatar = findAvatar(sessionUUID);
         if (!avatar) {
             avatar = addAvatar(sessionUUID, mixerWeakPointer);
         }
@@ -131,7 +134,7 @@ void AvatarHashMap::processAvatarBillboardPacket(const QByteArray& packet, const
     int headerSize = numBytesForPacketHeader(packet);
     QUuid sessionUUID = QUuid::fromRfc4122(QByteArray::fromRawData(packet.constData() + headerSize, NUM_BYTES_RFC4122_UUID));
     
-    AvatarSharedPointer avatar = _avatarHash.value(sessionUUID);
+    AvatarSharedPointer avatar = findAvatar(sessionUUID);
     if (!avatar) {
         avatar = addAvatar(sessionUUID, mixerWeakPointer);
     }
@@ -149,9 +152,15 @@ void AvatarHashMap::processKillAvatar(const QByteArray& datagram) {
 }
 
 void AvatarHashMap::removeAvatar(const QUuid& sessionUUID) {
+    QWriteLocker locker(&_hashLock);
     _avatarHash.remove(sessionUUID);
 }
 
+AvatarSharedPointer AvatarHashMap::findAvatar(const QUuid& sessionUUID) {
+    QReadLocker locker(&_hashLock);
+    return _avatarHash.value(sessionUUID);
+}
+
 void AvatarHashMap::sessionUUIDChanged(const QUuid& sessionUUID, const QUuid& oldUUID) {
     _lastOwnerSessionUUID = oldUUID;
 }
@@ -13,6 +13,7 @@
 #define hifi_AvatarHashMap_h
 
 #include <QtCore/QHash>
+#include <QtCore/QReadWriteLock>
 #include <QtCore/QSharedPointer>
 #include <QtCore/QUuid>
 
@@ -29,8 +30,9 @@ class AvatarHashMap : public QObject, public Dependency {
     SINGLETON_DEPENDENCY
     
 public:
+    /// the hash itself is only safe to read on the thread that processes avatar mixer datagrams
     const AvatarHash& getAvatarHash() { return _avatarHash; }
-    int size() { return _avatarHash.size(); }
+    int size() { QReadLocker locker(&_hashLock); return _avatarHash.size(); }
     
 public slots:
     void processAvatarMixerDatagram(const QByteArray& datagram, const QWeakPointer<Node>& mixerWeakPointer);
@@ -46,7 +48,13 @@ protected:
     virtual AvatarSharedPointer addAvatar(const QUuid& sessionUUID, const QWeakPointer<Node>& mixerWeakPointer);
     virtual void removeAvatar(const QUuid& sessionUUID);
     
+    AvatarSharedPointer findAvatar(const QUuid& sessionUUID);
+    
     AvatarHash _avatarHash;
+    
+    // hosted agents read the hash from their script threads while datagrams modify it, so
+    // modifications hold this for writing and reads away from the datagram thread hold it for reading
+    QReadWriteLock _hashLock;
 
 private:
     void processAvatarDataPacket(const QByteArray& packet, const QWeakPointer<Node>& mixerWeakPointer);
@@ -199,12 +199,8 @@ void Player::loopRecording() {
 }
 
 void Player::loadFromFile(const QString& file) {
-    if (_recording) {
-        _recording->clear();
-    } else {
-        _recording = RecordingPointer(new Recording());
-    }
-    readRecordingFromFile(_recording, file);
+    // other players may be playing the same recording, so we never clear or modify it
+    _recording = getSharedRecording(file);
     
     _pausedFrame = INVALID_FRAME;
 }
@@ -229,8 +225,8 @@ void Player::play() {
     if (_playFromCurrentPosition) {
         context = &_currentContext;
     }
-    const RecordingFrame& currentFrame = _recording->getFrame(_currentFrame);
-    const RecordingFrame& nextFrame = _recording->getFrame(_currentFrame + 1);
+    RecordingFrame currentFrame = _recording->getFrame(_currentFrame);
+    RecordingFrame nextFrame = _recording->getFrame(_currentFrame + 1);
     
     glm::vec3 translation = glm::mix(currentFrame.getTranslation(),
                                      nextFrame.getTranslation(),
@@ -324,35 +320,7 @@ void Player::setCurrentTime(int currentTime) {
         return;
     }
     
-    // Find correct frame
-    int lowestBound = 0;
-    int highestBound = _recording->getFrameNumber() - 1;
-    while (lowestBound + 1 != highestBound) {
-        assert(lowestBound < highestBound);
-        
-        int bestGuess = lowestBound +
-                    (highestBound - lowestBound) *
-                    (float)(currentTime - _recording->getFrameTimestamp(lowestBound)) /
-                    (float)(_recording->getFrameTimestamp(highestBound) - _recording->getFrameTimestamp(lowestBound));
-        
-        if (_recording->getFrameTimestamp(bestGuess) <= currentTime) {
-            if (currentTime < _recording->getFrameTimestamp(bestGuess + 1)) {
-                lowestBound = bestGuess;
-                highestBound = bestGuess + 1;
-            } else {
-                lowestBound = bestGuess + 1;
-            }
-        } else {
-            if (_recording->getFrameTimestamp(bestGuess - 1) <= currentTime) {
-                lowestBound = bestGuess - 1;
-                highestBound = bestGuess;
-            } else {
-                highestBound = bestGuess - 1;
-            }
-        }
-    }
-    
-    setCurrentFrame(lowestBound);
+    setCurrentFrame(_recording->getFrameAtTime(currentTime));
 }
 
 void Player::setVolume(float volume) {
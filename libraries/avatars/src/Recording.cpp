@@ -17,15 +17,22 @@
 #include <StreamUtils.h>
 
 #include <QBitArray>
+#include <QDateTime>
 #include <QElapsedTimer>
 #include <QEventLoop>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
+#include <QMutex>
 #include <QPair>
+#include <QWeakPointer>
+
+#include <algorithm>
 
 #include "AvatarData.h"
 #include "AvatarLogging.h"
 #include "Recording.h"
+#include "RecordingStream.h"
 
 // HFR file format magic number (Inspired by PNG)
 // (decimal)               17  72  70  82  13  10  26  10
@@ -34,7 +41,11 @@
 static const int MAGIC_NUMBER_SIZE = 8;
 static const char MAGIC_NUMBER[MAGIC_NUMBER_SIZE] = {17, 72, 70, 82, 13, 10, 26, 10};
 // Version (Major, Minor)
-static const QPair<quint8, quint8> VERSION(0, 2);
+// 0.3 stores the frames last, as chunks of quantized deltas listed in an index, so they can be read as they are played
+static const QPair<quint8, quint8> VERSION(0, 3);
+static const QPair<quint8, quint8> UNCHUNKED_VERSION(0, 2);
+// magic number, version, data offset, data length and CRC-16
+static const int HEADER_SIZE = MAGIC_NUMBER_SIZE + 2 + 2 + 4 + 2;
 
 int SCALE_RADIX = 10;
 int BLENDSHAPE_RADIX = 15;
@@ -61,8 +72,16 @@ qint32 Recording::getFrameTimestamp(int i) const {
     return _timestamps[i];
 }
 
-const RecordingFrame& Recording::getFrame(int i) const {
+int Recording::getFrameAtTime(qint32 time) const {
+    QVector<qint32>::const_iterator frame = std::upper_bound(_timestamps.constBegin(), _timestamps.constEnd(), time);
+    return std::max((int)(frame - _timestamps.constBegin()) - 1, 0);
+}
+
+RecordingFrame Recording::getFrame(int i) const {
     assert(i < _timestamps.size());
+    if (_streamedFrames) {
+        return _streamedFrames->getFrame(i);
+    }
     return _frames[i];
 }
 
@@ -83,6 +102,7 @@ void Recording::addFrame(int timestamp, RecordingFrame &frame) {
 void Recording::clear() {
     _timestamps.clear();
     _frames.clear();
+    _streamedFrames.clear();
     _audioData.clear();
 }
 
@@ -127,12 +147,38 @@ bool readFloat(QDataStream& stream, float& value, int radix) {
     return true;
 }
 
+// Recordings shared by getSharedRecording, keyed on their absolute path if they are local files or their URL if not.
+// Local files are read again when they changed on disk since, and when we write over them ourselves.
+class SharedRecording {
+public:
+    QDateTime lastModified;
+    qint64 size;
+    QWeakPointer<Recording> recording;
+};
+static QMutex sharedRecordingsMutex;
+static QHash<QString, SharedRecording> sharedRecordings;
+
+static bool isRemoteRecording(const QString& filename) {
+    QString scheme = QUrl(filename).scheme();
+    return scheme == "http" || scheme == "https" || scheme == "ftp";
+}
+
+static QString sharedRecordingKey(const QString& filename) {
+    return isRemoteRecording(filename) ? filename : QFileInfo(filename).absoluteFilePath();
+}
+
 void writeRecordingToFile(RecordingPointer recording, const QString& filename) {
     if (!recording || recording->getFrameNumber() < 1) {
         qCDebug(avatars) << "Can't save empty recording";
         return;
     }
     
+    {
+        // players that start after this read the new file rather than the frame index of the old one
+        QMutexLocker locker(&sharedRecordingsMutex);
+        sharedRecordings.remove(sharedRecordingKey(filename));
+    }
+    
     QElapsedTimer timer;
     QFile file(filename);
     if (!file.open(QIODevice::ReadWrite | QIODevice::Truncate)){
@@ -200,137 +246,55 @@ void writeRecordingToFile(RecordingPointer recording, const QString& filename) {
     }
     
     // RECORDING
-    fileStream << recording->_timestamps;
-    
-    QBitArray mask;
-    quint32 numBlendshapes = 0;
-    quint32 numJoints = 0;
+    // The frames go last, in chunks listed in an index, so that readers can leave them where they are until they play
+    // them. We encode them first because the index needs to know where each chunk ends up.
+    int numFrames = recording->getFrameNumber();
+    RecordingFrame firstFrame = recording->getFrame(0);
+    RecordingFrameCodec codec(firstFrame.getBlendshapeCoefficients().size(), firstFrame.getJointRotations().size());
+    
+    QByteArray frameData;
+    QVector<StreamedRecordingFrames::ChunkInfo> chunks;
+    for (int i = 0; i < numFrames; i += RecordingFrameCodec::FRAMES_PER_CHUNK) {
+        QVector<RecordingFrame> frames;
+        int numFramesInChunk = std::min(RecordingFrameCodec::FRAMES_PER_CHUNK, numFrames - i);
+        for (int j = 0; j < numFramesInChunk; ++j) {
+            frames << recording->getFrame(i + j);
+        }
+        QByteArray encodedChunk = codec.encodeChunk(frames);
+        
+        StreamedRecordingFrames::ChunkInfo chunk;
+        chunk.firstFrame = i;
+        chunk.numFrames = numFramesInChunk;
+        chunk.offset = frameData.size();
+        chunk.length = encodedChunk.size();
+        chunk.crc16 = qChecksum(encodedChunk.constData(), encodedChunk.size());
+        chunks << chunk;
+        frameData.append(encodedChunk);
+    }
     
-    for (int i = 0; i < recording->_timestamps.size(); ++i) {
-        mask.fill(false);
-        int maskIndex = 0;
-        QByteArray buffer;
-        QDataStream stream(&buffer, QIODevice::WriteOnly);
-        RecordingFrame& previousFrame = recording->_frames[(i != 0) ? i - 1 : i];
-        RecordingFrame& frame = recording->_frames[i];
-        
-        // Blendshape Coefficients
-        if (i == 0) {
-            numBlendshapes = frame.getBlendshapeCoefficients().size();
-            stream << numBlendshapes;
-            mask.resize(mask.size() + numBlendshapes);
-        }
-        for (quint32 j = 0; j < numBlendshapes; ++j) {
-            if (i == 0 ||
-                frame._blendshapeCoefficients[j] != previousFrame._blendshapeCoefficients[j]) {
-                stream << frame.getBlendshapeCoefficients()[j];
-                mask.setBit(maskIndex);
-            }
-            ++maskIndex;
-        }
-        
-        // Joint Rotations
-        if (i == 0) {
-            numJoints = frame.getJointRotations().size();
-            stream << numJoints;
-            mask.resize(mask.size() + numJoints);
-        }
-        for (quint32 j = 0; j < numJoints; ++j) {
-            if (i == 0 ||
-                frame._jointRotations[j] != previousFrame._jointRotations[j]) {
-                writeQuat(stream, frame._jointRotations[j]);
-                mask.setBit(maskIndex);
-            }
-            maskIndex++;
-        }
-        
-        // Translation
-        if (i == 0) {
-            mask.resize(mask.size() + 1);
-        }
-        if (i == 0 || frame._translation != previousFrame._translation) {
-            writeVec3(stream, frame._translation);
-            mask.setBit(maskIndex);
-        }
-        maskIndex++;
-        
-        // Rotation
-        if (i == 0) {
-            mask.resize(mask.size() + 1);
-        }
-        if (i == 0 || frame._rotation != previousFrame._rotation) {
-            writeQuat(stream, frame._rotation);
-            mask.setBit(maskIndex);
-        }
-        maskIndex++;
-        
-        // Scale
-        if (i == 0) {
-            mask.resize(mask.size() + 1);
-        }
-        if (i == 0 || frame._scale != previousFrame._scale) {
-            stream << frame._scale;
-            mask.setBit(maskIndex);
-        }
-        maskIndex++;
-        
-        // Head Rotation
-        if (i == 0) {
-            mask.resize(mask.size() + 1);
-        }
-        if (i == 0 || frame._headRotation != previousFrame._headRotation) {
-            writeQuat(stream, frame._headRotation);
-            mask.setBit(maskIndex);
-        }
-        maskIndex++;
-        
-        // Lean Sideways
-        if (i == 0) {
-            mask.resize(mask.size() + 1);
-        }
-        if (i == 0 || frame._leanSideways != previousFrame._leanSideways) {
-            stream << frame._leanSideways;
-            mask.setBit(maskIndex);
-        }
-        maskIndex++;
-        
-        // Lean Forward
-        if (i == 0) {
-            mask.resize(mask.size() + 1);
-        }
-        if (i == 0 || frame._leanForward != previousFrame._leanForward) {
-            stream << frame._leanForward;
-            mask.setBit(maskIndex);
-        }
-        maskIndex++;
-        
-        // LookAt Position
-        if (i == 0) {
-            mask.resize(mask.size() + 1);
-        }
-        if (i == 0 || frame._lookAtPosition != previousFrame._lookAtPosition) {
-            writeVec3(stream, frame._lookAtPosition);
-            mask.setBit(maskIndex);
-        }
-        maskIndex++;
-        
-        fileStream << mask;
-        fileStream << buffer;
+    fileStream << (quint32)codec.getNumBlendshapes();
+    fileStream << (quint32)codec.getNumJoints();
+    fileStream << recording->_timestamps;
+    fileStream << (quint32)chunks.size();
+    foreach (const StreamedRecordingFrames::ChunkInfo& chunk, chunks) {
+        fileStream << (qint32)chunk.firstFrame << (qint32)chunk.numFrames << chunk.offset << chunk.length << chunk.crc16;
     }
     
     fileStream << recording->getAudioData();
     
-    qint64 writingTime = timer.restart();
-    // Write data length and CRC-16
+    // The data length and CRC-16 cover everything up to the frames, the chunks of frames have CRC-16s of their own
     quint32 dataLength = file.pos() - dataOffset;
+    file.write(frameData);
+    
+    qint64 writingTime = timer.restart();
     file.seek(dataOffset); // Go to beginning of data for checksum
-    quint16 crc16 = qChecksum(file.readAll().constData(), dataLength);
+    quint16 crc16 = qChecksum(file.read(dataLength).constData(), dataLength);
     
     file.seek(dataLengthPos);
     fileStream << dataLength;
     file.seek(crc16Pos);
     fileStream << crc16;
-    file.seek(dataOffset + dataLength);
+    file.seek(file.size());
     
     bool wantDebug = true;
     if (wantDebug) {
@@ -361,6 +325,7 @@ void writeRecordingToFile(RecordingPointer recording, const QString& filename) {
         
         qCDebug(avatars) << "Recording:";
         qCDebug(avatars) << "Total frames:" << recording->getFrameNumber();
+        qCDebug(avatars) << "Chunks:" << chunks.size() << "(" << frameData.size() << "bytes)";
         qCDebug(avatars) << "Audio array:" << recording->getAudioData().size();
     }
     
@@ -368,8 +333,24 @@ void writeRecordingToFile(RecordingPointer recording, const QString& filename) {
     qCDebug(avatars) << "Wrote" << file.size() << "bytes in" << writingTime + checksumTime << "ms. (" << checksumTime << "ms for checksum)";
 }
 
+// Where the frames start in a file of the chunked format, or 0 if it is not one
+static qint64 frameDataPosition(const QByteArray& header) {
+    if (header.size() < HEADER_SIZE || !header.startsWith(QByteArray(MAGIC_NUMBER, MAGIC_NUMBER_SIZE))) {
+        return 0;
+    }
+    QDataStream headerStream(header);
+    headerStream.skipRawData(MAGIC_NUMBER_SIZE);
+    QPair<quint8, quint8> version;
+    quint16 dataOffset = 0;
+    quint32 dataLength = 0;
+    headerStream >> version >> dataOffset >> dataLength;
+    return (version == VERSION) ? (qint64)dataOffset + dataLength : 0;
+}
+
 RecordingPointer readRecordingFromFile(RecordingPointer recording, const QString& filename) {
     QByteArray byteArray;
+    bool isLocalFile = false;
+    qint64 sourceSize = 0;
     QUrl url(filename);
     QElapsedTimer timer;
     timer.start(); // timer used for debug informations (download/parsing time)
@@ -392,6 +373,7 @@ RecordingPointer readRecordingFromFile(RecordingPointer recording, const QString
             return recording;
         }
         byteArray = reply->readAll();
+        sourceSize = byteArray.size();
         reply->deleteLater();
         // print debug + restart timer
         qCDebug(avatars) << "Downloaded " << byteArray.size() << " bytes in " << timer.restart() << " ms.";
@@ -403,8 +385,17 @@ RecordingPointer readRecordingFromFile(RecordingPointer recording, const QString
             qCDebug(avatars) << "Could not open local file: " << url;
             return recording;
         }
-        byteArray = file.readAll();
+        // the frames of chunked files stay on disk until they are played
+        sourceSize = file.size();
+        byteArray = file.read(HEADER_SIZE);
+        qint64 framesPosition = frameDataPosition(byteArray);
+        if (framesPosition > 0) {
+            byteArray.append(file.read(framesPosition - HEADER_SIZE));
+        } else {
+            byteArray.append(file.readAll());
+        }
         file.close();
+        isLocalFile = true;
     }
     
     if (filename.endsWith(".rec") || filename.endsWith(".REC")) {
@@ -432,7 +423,7 @@ RecordingPointer readRecordingFromFile(RecordingPointer recording, const QString
     
     QPair<quint8, quint8> version;
     fileStream >> version; // File format version
-    if (version != VERSION && version != QPair<quint8, quint8>(0,1)) {
+    if (version != VERSION && version != UNCHUNKED_VERSION && version != QPair<quint8, quint8>(0,1)) {
         qCDebug(avatars) << "ERROR: This file format version is not supported.";
         return recording;
     }
@@ -446,6 +437,11 @@ RecordingPointer readRecordingFromFile(RecordingPointer recording, const QString
     
     
     // Check checksum
+    if ((qint64)dataOffset + dataLength > byteArray.size()) {
+        qCDebug(avatars) << "File is truncated. Bailling!";
+        recording.clear();
+        return recording;
+    }
     quint16 computedCRC16 = qChecksum(byteArray.constData() + dataOffset, dataLength);
     if (computedCRC16 != crc16) {
         qCDebug(avatars) << "Checksum does not match. Bailling!";
@@ -524,85 +520,134 @@ RecordingPointer readRecordingFromFile(RecordingPointer recording, const QString
     quint32 numBlendshapes = 0;
     quint32 numJoints = 0;
     // RECORDING
-    fileStream >> recording->_timestamps;
-    
-    for (int i = 0; i < recording->_timestamps.size(); ++i) {
-        QBitArray mask;
-        QByteArray buffer;
-        QDataStream stream(&buffer, QIODevice::ReadOnly);
-        RecordingFrame frame;
-        RecordingFrame& previousFrame = (i == 0) ? frame : recording->_frames.last();
-        
-        fileStream >> mask;
-        fileStream >> buffer;
-        int maskIndex = 0;
-        
-        // Blendshape Coefficients
-        if (i == 0) {
-            stream >> numBlendshapes;
+    if (version == VERSION) {
+        fileStream >> numBlendshapes;
+        fileStream >> numJoints;
+        fileStream >> recording->_timestamps;
+        
+        quint32 numChunks = 0;
+        fileStream >> numChunks;
+        QVector<StreamedRecordingFrames::ChunkInfo> chunks;
+        for (quint32 i = 0; i < numChunks && fileStream.status() == QDataStream::Ok; ++i) {
+            StreamedRecordingFrames::ChunkInfo chunk;
+            qint32 firstFrame = 0;
+            qint32 numFrames = 0;
+            fileStream >> firstFrame >> numFrames >> chunk.offset >> chunk.length >> chunk.crc16;
+            chunk.firstFrame = firstFrame;
+            chunk.numFrames = numFrames;
+            chunks << chunk;
+        }
+        
+        // players trust the index from here on, so it has to describe exactly the frames that follow it
+        qint64 framesPosition = (qint64)dataOffset + dataLength;
+        if (fileStream.status() != QDataStream::Ok
+                || numBlendshapes > (quint32)RecordingFrameCodec::MAX_BLENDSHAPES
+                || numJoints > (quint32)RecordingFrameCodec::MAX_JOINTS
+                || !std::is_sorted(recording->_timestamps.constBegin(), recording->_timestamps.constEnd())
+                || !StreamedRecordingFrames::areChunksValid(chunks, recording->_timestamps.size(),
+                                                            sourceSize - framesPosition)) {
+            qCDebug(avatars) << "Couldn't read file correctly. (Invalid frame index)";
+            recording.clear();
+            return recording;
         }
-        frame._blendshapeCoefficients.resize(numBlendshapes);
-        for (quint32 j = 0; j < numBlendshapes; ++j) {
-            if (!mask[maskIndex++]) {
-                frame._blendshapeCoefficients[j] = previousFrame._blendshapeCoefficients[j];
-            } else if (version == QPair<quint8, quint8>(0,1)) {
-                readFloat(stream, frame._blendshapeCoefficients[j], BLENDSHAPE_RADIX);
-            } else {
-                stream >> frame._blendshapeCoefficients[j];
+        
+        // the frames are decoded a chunk at a time as they are played
+        StreamedRecordingFrames* streamedFrames = new StreamedRecordingFrames(RecordingFrameCodec(numBlendshapes,
+                                                                                                  numJoints), chunks);
+        if (isLocalFile) {
+            if (!streamedFrames->setSourceFile(filename, framesPosition)) {
+                qCDebug(avatars) << "Couldn't open" << filename << "for its frames";
             }
+        } else {
+            streamedFrames->setSourceData(byteArray.mid(framesPosition));
         }
-        // Joint Rotations
-        if (i == 0) {
-            stream >> numJoints;
-        }
-        frame._jointRotations.resize(numJoints);
-        for (quint32 j = 0; j < numJoints; ++j) {
-            if (!mask[maskIndex++] || !readQuat(stream, frame._jointRotations[j])) {
-                frame._jointRotations[j] = previousFrame._jointRotations[j];
+        recording->_frames.clear();
+        recording->_streamedFrames = QSharedPointer<StreamedRecordingFrames>(streamedFrames);
+    } else {
+        quint32 numBlendshapes = 0;
+        quint32 numJoints = 0;
+        // RECORDING
+        fileStream >> recording->_timestamps;
+    
+        for (int i = 0; i < recording->_timestamps.size(); ++i) {
+            QBitArray mask;
+            QByteArray buffer;
+            QDataStream stream(&buffer, QIODevice::ReadOnly);
+            RecordingFrame frame;
+            RecordingFrame& previousFrame = (i == 0) ? frame : recording->_frames.last();
+        
+            fileStream >> mask;
+            fileStream >> buffer;
+            int maskIndex = 0;
+        
+            // Blendshape Coefficients
+            if (i == 0) {
+                stream >> numBlendshapes;
+            }
+            frame._blendshapeCoefficients.resize(numBlendshapes);
+            for (quint32 j = 0; j < numBlendshapes; ++j) {
+                if (!mask[maskIndex++]) {
+                    frame._blendshapeCoefficients[j] = previousFrame._blendshapeCoefficients[j];
+                } else if (version == QPair<quint8, quint8>(0,1)) {
+                    readFloat(stream, frame._blendshapeCoefficients[j], BLENDSHAPE_RADIX);
+                } else {
+                    stream >> frame._blendshapeCoefficients[j];
+                }
+            }
+            // Joint Rotations
+            if (i == 0) {
+                stream >> numJoints;
+            }
+            frame._jointRotations.resize(numJoints);
+            for (quint32 j = 0; j < numJoints; ++j) {
+                if (!mask[maskIndex++] || !readQuat(stream, frame._jointRotations[j])) {
+                    frame._jointRotations[j] = previousFrame._jointRotations[j];
+                }
             }
-        }
         
-        if (!mask[maskIndex++] || !readVec3(stream, frame._translation)) {
-            frame._translation = previousFrame._translation;
-        }
+            if (!mask[maskIndex++] || !readVec3(stream, frame._translation)) {
+                frame._translation = previousFrame._translation;
+            }
         
-        if (!mask[maskIndex++] || !readQuat(stream, frame._rotation)) {
-            frame._rotation = previousFrame._rotation;
-        }
+            if (!mask[maskIndex++] || !readQuat(stream, frame._rotation)) {
+                frame._rotation = previousFrame._rotation;
+            }
         
-        if (!mask[maskIndex++]) {
-            frame._scale = previousFrame._scale;
-        } else if (version == QPair<quint8, quint8>(0,1)) {
-            readFloat(stream, frame._scale, SCALE_RADIX);
-        } else {
-            stream >> frame._scale;
-        }
+            if (!mask[maskIndex++]) {
+                frame._scale = previousFrame._scale;
+            } else if (version == QPair<quint8, quint8>(0,1)) {
+                readFloat(stream, frame._scale, SCALE_RADIX);
+            } else {
+                stream >> frame._scale;
+            }
         
-        if (!mask[maskIndex++] || !readQuat(stream, frame._headRotation)) {
-            frame._headRotation = previousFrame._headRotation;
-        }
+            if (!mask[maskIndex++] || !readQuat(stream, frame._headRotation)) {
+                frame._headRotation = previousFrame._headRotation;
+            }
         
-        if (!mask[maskIndex++]) {
-            frame._leanSideways = previousFrame._leanSideways;
-        } else if (version == QPair<quint8, quint8>(0,1)) {
-            readFloat(stream, frame._leanSideways, LEAN_RADIX);
-        } else {
-            stream >> frame._leanSideways;
-        }
+            if (!mask[maskIndex++]) {
+                frame._leanSideways = previousFrame._leanSideways;
+            } else if (version == QPair<quint8, quint8>(0,1)) {
+                readFloat(stream, frame._leanSideways, LEAN_RADIX);
+            } else {
+                stream >> frame._leanSideways;
+            }
         
-        if (!mask[maskIndex++]) {
-            frame._leanForward = previousFrame._leanForward;
-        } else if (version == QPair<quint8, quint8>(0,1)) {
-            readFloat(stream, frame._leanForward, LEAN_RADIX);
-        } else {
-            stream >> frame._leanForward;
-        }
+            if (!mask[maskIndex++]) {
+                frame._leanForward = previousFrame._leanForward;
+            } else if (version == QPair<quint8, quint8>(0,1)) {
+                readFloat(stream, frame._leanForward, LEAN_RADIX);
+            } else {
+                stream >> frame._leanForward;
+            }
         
-        if (!mask[maskIndex++] || !readVec3(stream, frame._lookAtPosition)) {
-            frame._lookAtPosition = previousFrame._lookAtPosition;
-        }
+            if (!mask[maskIndex++] || !readVec3(stream, frame._lookAtPosition)) {
+                frame._lookAtPosition = previousFrame._lookAtPosition;
+            }
         
-        recording->_frames << frame;
+            recording->_frames << frame;
+        }
+    
     }
     
     QByteArray audioArray;
@@ -806,3 +851,46 @@ RecordingPointer readRecordingFromRecFile(RecordingPointer recording, const QStr
     qCDebug(avatars) << "Recording has been successfully converted at" << newFilename;
     return recording;
 }
+
+RecordingPointer getSharedRecording(const QString& filename) {
+    QString key = sharedRecordingKey(filename);
+    SharedRecording shared;
+    shared.size = 0;
+    if (!isRemoteRecording(filename)) {
+        QFileInfo fileInfo(key);
+        shared.lastModified = fileInfo.lastModified();
+        shared.size = fileInfo.size();
+    }
+    auto isCurrent = [&](const SharedRecording& existing) {
+        return existing.lastModified == shared.lastModified && existing.size == shared.size;
+    };
+    
+    QMutexLocker locker(&sharedRecordingsMutex);
+    QHash<QString, SharedRecording>::const_iterator existing = sharedRecordings.constFind(key);
+    if (existing != sharedRecordings.constEnd() && isCurrent(*existing)) {
+        RecordingPointer recording = existing->recording.toStrongRef();
+        if (recording) {
+            return recording;
+        }
+    }
+    
+    // reading from the network waits on an event loop, don't hold everyone else up meanwhile
+    locker.unlock();
+    RecordingPointer recording = readRecordingFromFile(RecordingPointer(new Recording()), filename);
+    if (!recording || recording->isEmpty()) {
+        return RecordingPointer(new Recording());
+    }
+    
+    locker.relock();
+    // someone may have read it too while we did, play the same one as they do
+    existing = sharedRecordings.constFind(key);
+    if (existing != sharedRecordings.constEnd() && isCurrent(*existing)) {
+        RecordingPointer theirs = existing->recording.toStrongRef();
+        if (theirs) {
+            return theirs;
+        }
+    }
+    shared.recording = recording;
+    sharedRecordings.insert(key, shared);
+    return recording;
+}
@@ -12,19 +12,18 @@
 #ifndef hifi_Recording_h
 #define hifi_Recording_h
 
+#include <QSharedPointer>
 #include <QString>
 #include <QVector>
 
 #include <glm/glm.hpp>
 #include <glm/gtx/quaternion.hpp>
 
-template<class C>
-class QSharedPointer;
-
 class AttachmentData;
 class Recording;
 class RecordingFrame;
 class Sound;
+class StreamedRecordingFrames;
 
 typedef QSharedPointer<Recording> RecordingPointer;
 
@@ -52,9 +51,13 @@ public:
     int getLength() const; // in ms
     
     RecordingContext& getContext() { return _context; }
-    int getFrameNumber() const { return _frames.size(); }
+    int getFrameNumber() const { return _timestamps.size(); }
     qint32 getFrameTimestamp(int i) const;
-    const RecordingFrame& getFrame(int i) const;
+    int getFrameAtTime(qint32 time) const; // the last frame at or before time, in ms
+    
+    /// Frames of recordings read from files are decoded a chunk at a time as they are asked for, so this may be called
+    /// by players on any thread, and returns a copy. Copying a frame only copies references to its vectors.
+    RecordingFrame getFrame(int i) const;
     const QByteArray& getAudioData() const { return _audioData; }
     int numberAudioChannel() const;
     
@@ -66,7 +69,8 @@ protected:
 private:
     RecordingContext _context;
     QVector<qint32> _timestamps;
-    QVector<RecordingFrame> _frames;
+    QVector<RecordingFrame> _frames; // empty while the frames are streamed
+    QSharedPointer<StreamedRecordingFrames> _streamedFrames;
     
     QByteArray _audioData;
     
@@ -114,6 +118,7 @@ private:
     glm::vec3 _lookAtPosition;
     
     friend class Recorder;
+    friend class RecordingFrameCodec;
     friend void writeRecordingToFile(RecordingPointer recording, const QString& file);
     friend RecordingPointer readRecordingFromFile(RecordingPointer recording, const QString& file);
     friend RecordingPointer readRecordingFromRecFile(RecordingPointer recording, const QString& filename,
@@ -124,4 +129,8 @@ void writeRecordingToFile(RecordingPointer recording, const QString& filename);
 RecordingPointer readRecordingFromFile(RecordingPointer recording, const QString& filename);
 RecordingPointer readRecordingFromRecFile(RecordingPointer recording, const QString& filename, const QByteArray& byteArray);
 
+/// Reads a recording once for everyone who plays it, for as long as one of them holds on to it. Local files are read
+/// again once they have been written over.
+RecordingPointer getSharedRecording(const QString& filename);
+
 #endif // hifi_Recording_h
\ No newline at end of file
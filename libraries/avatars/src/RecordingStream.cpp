@@ -0,0 +1,353 @@
+//
+//  RecordingStream.cpp
+//  libraries/avatars/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include <QMutexLocker>
+
+#include "AvatarLogging.h"
+#include "RecordingStream.h"
+
+// channel resolutions, in steps per unit
+static const float QUAT_COMPONENT_SCALE = 32767.0f;
+static const float POSITION_SCALE = 1000.0f; // millimeters
+static const float BLENDSHAPE_SCALE = 16384.0f;
+static const float SCALE_SCALE = 16384.0f;
+static const float LEAN_SCALE = 4096.0f;
+
+static qint32 quantize(float value, float scale) {
+    const float MAX_QUANTIZED = 2147483520.0f; // the largest float below 2^31
+    float scaled = std::floor(value * scale + 0.5f);
+    if (!(scaled == scaled)) {
+        return 0; // NaN
+    }
+    return (qint32)glm::clamp(scaled, -MAX_QUANTIZED, MAX_QUANTIZED);
+}
+
+static void writeVarint(QByteArray& output, quint32 value) {
+    while (value >= 0x80) {
+        output.append((char)(value | 0x80));
+        value >>= 7;
+    }
+    output.append((char)value);
+}
+
+static bool readVarint(const uchar*& cursor, const uchar* end, quint32& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (cursor == end) {
+            return false;
+        }
+        uchar byte = *cursor++;
+        value |= (quint32)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// small values of either sign take few bytes as varints
+static quint32 zigZagEncode(qint32 value) {
+    return ((quint32)value << 1) ^ (quint32)(value >> 31);
+}
+
+static qint32 zigZagDecode(quint32 value) {
+    return (qint32)((value >> 1) ^ (0u - (value & 1)));
+}
+
+RecordingFrameCodec::RecordingFrameCodec(int numBlendshapes, int numJoints) :
+    _numBlendshapes(numBlendshapes),
+    _numJoints(numJoints)
+{
+}
+
+// q and -q are the same rotation, we pick whichever is closer to the previous frame's so the deltas stay small
+static void quantizeQuat(const glm::quat& rotation, const qint32* previousChannels, qint32* channels) {
+    channels[0] = quantize(rotation.x, QUAT_COMPONENT_SCALE);
+    channels[1] = quantize(rotation.y, QUAT_COMPONENT_SCALE);
+    channels[2] = quantize(rotation.z, QUAT_COMPONENT_SCALE);
+    channels[3] = quantize(rotation.w, QUAT_COMPONENT_SCALE);
+    if (previousChannels) {
+        qint64 dot = 0;
+        for (int i = 0; i < 4; i++) {
+            dot += (qint64)channels[i] * previousChannels[i];
+        }
+        if (dot < 0) {
+            for (int i = 0; i < 4; i++) {
+                channels[i] = -channels[i];
+            }
+        }
+    }
+}
+
+static glm::quat dequantizeQuat(const qint32* channels) {
+    glm::quat rotation(channels[3] / QUAT_COMPONENT_SCALE, channels[0] / QUAT_COMPONENT_SCALE,
+                       channels[1] / QUAT_COMPONENT_SCALE, channels[2] / QUAT_COMPONENT_SCALE);
+    float length = glm::length(rotation);
+    return (length > 0.0f) ? rotation / length : glm::quat();
+}
+
+static void quantizeVec3(const glm::vec3& value, float scale, qint32* channels) {
+    channels[0] = quantize(value.x, scale);
+    channels[1] = quantize(value.y, scale);
+    channels[2] = quantize(value.z, scale);
+}
+
+static glm::vec3 dequantizeVec3(const qint32* channels, float scale) {
+    return glm::vec3(channels[0] / scale, channels[1] / scale, channels[2] / scale);
+}
+
+void RecordingFrameCodec::quantizeFrame(const RecordingFrame& frame, const qint32* previousChannels,
+                                        qint32* channels) const {
+    int channel = 0;
+
+    const QVector<float>& blendshapes = frame._blendshapeCoefficients;
+    for (int i = 0; i < _numBlendshapes; i++) {
+        channels[channel++] = (i < blendshapes.size()) ? quantize(blendshapes[i], BLENDSHAPE_SCALE) : 0;
+    }
+
+    const QVector<glm::quat>& jointRotations = frame._jointRotations;
+    for (int i = 0; i < _numJoints; i++) {
+        quantizeQuat((i < jointRotations.size()) ? jointRotations[i] : glm::quat(),
+                     previousChannels ? previousChannels + channel : NULL, channels + channel);
+        channel += 4;
+    }
+
+    quantizeVec3(frame._translation, POSITION_SCALE, channels + channel);
+    channel += 3;
+    quantizeQuat(frame._rotation, previousChannels ? previousChannels + channel : NULL, channels + channel);
+    channel += 4;
+    channels[channel++] = quantize(frame._scale, SCALE_SCALE);
+    quantizeQuat(frame._headRotation, previousChannels ? previousChannels + channel : NULL, channels + channel);
+    channel += 4;
+    channels[channel++] = quantize(frame._leanSideways, LEAN_SCALE);
+    channels[channel++] = quantize(frame._leanForward, LEAN_SCALE);
+    quantizeVec3(frame._lookAtPosition, POSITION_SCALE, channels + channel);
+}
+
+RecordingFrame RecordingFrameCodec::dequantizeFrame(const qint32* channels) const {
+    RecordingFrame frame;
+    int channel = 0;
+
+    frame._blendshapeCoefficients.resize(_numBlendshapes);
+    for (int i = 0; i < _numBlendshapes; i++) {
+        frame._blendshapeCoefficients[i] = channels[channel++] / BLENDSHAPE_SCALE;
+    }
+
+    frame._jointRotations.resize(_numJoints);
+    for (int i = 0; i < _numJoints; i++) {
+        frame._jointRotations[i] = dequantizeQuat(channels + channel);
+        channel += 4;
+    }
+
+    frame._translation = dequantizeVec3(channels + channel, POSITION_SCALE);
+    channel += 3;
+    frame._rotation = dequantizeQuat(channels + channel);
+    channel += 4;
+    frame._scale = channels[channel++] / SCALE_SCALE;
+    frame._headRotation = dequantizeQuat(channels + channel);
+    channel += 4;
+    frame._leanSideways = channels[channel++] / LEAN_SCALE;
+    frame._leanForward = channels[channel++] / LEAN_SCALE;
+    frame._lookAtPosition = dequantizeVec3(channels + channel, POSITION_SCALE);
+    return frame;
+}
+
+RecordingFrame RecordingFrameCodec::makeRestFrame() const {
+    RecordingFrame frame;
+    frame._blendshapeCoefficients.fill(0.0f, _numBlendshapes);
+    frame._jointRotations.fill(glm::quat(), _numJoints);
+    frame._translation = glm::vec3(0.0f);
+    frame._rotation = glm::quat();
+    frame._scale = 1.0f;
+    frame._headRotation = glm::quat();
+    frame._leanSideways = 0.0f;
+    frame._leanForward = 0.0f;
+    frame._lookAtPosition = glm::vec3(0.0f);
+    return frame;
+}
+
+QByteArray RecordingFrameCodec::encodeChunk(const QVector<RecordingFrame>& frames) const {
+    int numChannels = getNumChannels();
+    QVector<qint32> previousChannels(numChannels);
+    QVector<qint32> channels(numChannels);
+    QByteArray chunk;
+
+    for (int i = 0; i < frames.size(); i++) {
+        if (i == 0) {
+            quantizeFrame(frames[i], NULL, channels.data());
+            for (int channel = 0; channel < numChannels; channel++) {
+                writeVarint(chunk, zigZagEncode(channels[channel]));
+            }
+        } else {
+            // a run of unchanged channels, then a changed one, and so on. The last run may reach the end of the frame
+            quantizeFrame(frames[i], previousChannels.constData(), channels.data());
+            quint32 unchangedRun = 0;
+            for (int channel = 0; channel < numChannels; channel++) {
+                qint32 delta = (qint32)((quint32)channels[channel] - (quint32)previousChannels[channel]);
+                if (delta == 0) {
+                    unchangedRun++;
+                    continue;
+                }
+                writeVarint(chunk, unchangedRun);
+                writeVarint(chunk, zigZagEncode(delta));
+                unchangedRun = 0;
+            }
+            if (unchangedRun > 0) {
+                writeVarint(chunk, unchangedRun);
+            }
+        }
+        previousChannels.swap(channels);
+    }
+    return chunk;
+}
+
+bool RecordingFrameCodec::decodeChunk(const QByteArray& chunk, int numFrames, QVector<RecordingFrame>& frames) const {
+    int numChannels = getNumChannels();
+    QVector<qint32> channels(numChannels);
+    const uchar* cursor = reinterpret_cast<const uchar*>(chunk.constData());
+    const uchar* end = cursor + chunk.size();
+
+    frames.clear();
+    if (numFrames < 0) {
+        return false;
+    }
+    frames.reserve(numFrames);
+    for (int i = 0; i < numFrames; i++) {
+        quint32 value;
+        if (i == 0) {
+            for (int channel = 0; channel < numChannels; channel++) {
+                if (!readVarint(cursor, end, value)) {
+                    return false;
+                }
+                channels[channel] = zigZagDecode(value);
+            }
+        } else {
+            int channel = 0;
+            while (channel < numChannels) {
+                quint32 unchangedRun;
+                if (!readVarint(cursor, end, unchangedRun) || unchangedRun > (quint32)(numChannels - channel)) {
+                    return false;
+                }
+                channel += unchangedRun;
+                if (channel == numChannels) {
+                    break;
+                }
+                if (!readVarint(cursor, end, value)) {
+                    return false;
+                }
+                channels[channel] = (qint32)((quint32)channels[channel] + (quint32)zigZagDecode(value));
+                channel++;
+            }
+        }
+        frames << dequantizeFrame(channels.constData());
+    }
+    return cursor == end;
+}
+
+StreamedRecordingFrames::StreamedRecordingFrames(const RecordingFrameCodec& codec, const QVector<ChunkInfo>& chunks) :
+    _codec(codec),
+    _chunks(chunks),
+    _frameDataOffset(0)
+{
+}
+
+bool StreamedRecordingFrames::areChunksValid(const QVector<ChunkInfo>& chunks, int numFrames, qint64 frameDataSize) {
+    int nextFrame = 0;
+    foreach (const ChunkInfo& chunk, chunks) {
+        if (chunk.firstFrame != nextFrame || chunk.numFrames < 1
+                || chunk.numFrames > RecordingFrameCodec::FRAMES_PER_CHUNK || chunk.numFrames > numFrames - nextFrame
+                || (qint64)chunk.offset + chunk.length > frameDataSize) {
+            return false;
+        }
+        nextFrame += chunk.numFrames;
+    }
+    return nextFrame == numFrames;
+}
+
+bool StreamedRecordingFrames::setSourceFile(const QString& filename, qint64 frameDataOffset) {
+    _file.reset(new QFile(filename));
+    _frameDataOffset = frameDataOffset;
+    return _file->open(QIODevice::ReadOnly);
+}
+
+RecordingFrame StreamedRecordingFrames::getFrame(int index) {
+    // the last chunk that starts at or before the frame
+    ChunkInfo key;
+    key.firstFrame = index;
+    auto chunk = std::upper_bound(_chunks.constBegin(), _chunks.constEnd(), key,
+                                  [](const ChunkInfo& a, const ChunkInfo& b) { return a.firstFrame < b.firstFrame; });
+    if (chunk == _chunks.constBegin()) {
+        return _codec.makeRestFrame();
+    }
+    --chunk;
+    int chunkIndex = chunk - _chunks.constBegin();
+    int indexInChunk = index - chunk->firstFrame;
+    if (indexInChunk >= chunk->numFrames) {
+        return _codec.makeRestFrame();
+    }
+
+    // copying the frame out only copies references to its vectors, it stays valid after the chunk is dropped
+    DecodedChunk decodedChunk = getChunk(chunkIndex);
+    return decodedChunk->at(indexInChunk);
+}
+
+int StreamedRecordingFrames::getNumDecodedChunks() {
+    QMutexLocker locker(&_mutex);
+    return _decodedChunks.size();
+}
+
+StreamedRecordingFrames::DecodedChunk StreamedRecordingFrames::getChunk(int chunkIndex) {
+    QMutexLocker locker(&_mutex);
+
+    DecodedChunk decodedChunk = _decodedChunks.value(chunkIndex);
+    if (decodedChunk) {
+        _recentChunks.removeOne(chunkIndex);
+        _recentChunks.append(chunkIndex);
+        return decodedChunk;
+    }
+
+    const ChunkInfo& chunk = _chunks.at(chunkIndex);
+    QVector<RecordingFrame>* frames = new QVector<RecordingFrame>();
+    QByteArray encodedChunk;
+    if (!readChunk(chunk, encodedChunk) ||
+            qChecksum(encodedChunk.constData(), encodedChunk.size()) != chunk.crc16 ||
+            !_codec.decodeChunk(encodedChunk, chunk.numFrames, *frames)) {
+        // play something sane rather than nothing
+        qCDebug(avatars) << "Couldn't read recording frames" << chunk.firstFrame << "to"
+            << chunk.firstFrame + chunk.numFrames - 1;
+        frames->fill(_codec.makeRestFrame(), chunk.numFrames);
+    }
+    decodedChunk = DecodedChunk(frames);
+
+    _decodedChunks.insert(chunkIndex, decodedChunk);
+    _recentChunks.append(chunkIndex);
+    while (_recentChunks.size() > MAX_DECODED_CHUNKS) {
+        _decodedChunks.remove(_recentChunks.takeFirst());
+    }
+    return decodedChunk;
+}
+
+bool StreamedRecordingFrames::readChunk(const ChunkInfo& chunk, QByteArray& encodedChunk) {
+    if (_file) {
+        if (!_file->seek(_frameDataOffset + chunk.offset)) {
+            return false;
+        }
+        encodedChunk = _file->read(chunk.length);
+    } else {
+        if ((quint64)chunk.offset + chunk.length > (quint64)_frameData.size()) {
+            return false;
+        }
+        encodedChunk = _frameData.mid(chunk.offset, chunk.length);
+    }
+    return encodedChunk.size() == (int)chunk.length;
+}
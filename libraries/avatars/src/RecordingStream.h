@@ -0,0 +1,115 @@
+//
+//  RecordingStream.h
+//  libraries/avatars/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Recording frames stored as chunks of quantized deltas, decoded a chunk at a time as playback reaches them.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_RecordingStream_h
+#define hifi_RecordingStream_h
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "Recording.h"
+
+/// Turns runs of frames into chunks and back. Every value of a frame is quantized to an integer channel. The first
+/// frame of a chunk is stored whole, every other one as the difference to the frame before it, with unchanged channels
+/// skipped, so a chunk can be decoded without any other.
+class RecordingFrameCodec {
+public:
+    /// a couple of seconds of a recording at 60 fps
+    static const int FRAMES_PER_CHUNK = 128;
+
+    /// files that claim more than these are corrupt, every decoded frame holds a value for each of them
+    static const int MAX_BLENDSHAPES = 1024;
+    static const int MAX_JOINTS = 1024;
+
+    RecordingFrameCodec(int numBlendshapes, int numJoints);
+
+    int getNumBlendshapes() const { return _numBlendshapes; }
+    int getNumJoints() const { return _numJoints; }
+
+    QByteArray encodeChunk(const QVector<RecordingFrame>& frames) const;
+
+    /// false if the chunk is malformed or does not hold numFrames frames
+    bool decodeChunk(const QByteArray& chunk, int numFrames, QVector<RecordingFrame>& frames) const;
+
+    /// what a frame is while none of its values are known
+    RecordingFrame makeRestFrame() const;
+
+private:
+    int getNumChannels() const { return _numBlendshapes + 4 * _numJoints + NUM_FIXED_CHANNELS; }
+    void quantizeFrame(const RecordingFrame& frame, const qint32* previousChannels, qint32* channels) const;
+    RecordingFrame dequantizeFrame(const qint32* channels) const;
+
+    // translation, rotation, scale, head rotation, lean sideways, lean forward and look at position
+    static const int NUM_FIXED_CHANNELS = 3 + 4 + 1 + 4 + 1 + 1 + 3;
+
+    int _numBlendshapes;
+    int _numJoints;
+};
+
+/// The frames of a recording that stay encoded until they are played. Players of the same recording share the decoded
+/// chunks, and only the chunks used last stay decoded.
+class StreamedRecordingFrames {
+public:
+    class ChunkInfo {
+    public:
+        int firstFrame;
+        int numFrames;
+        quint32 offset; // from the start of the frame data
+        quint32 length;
+        quint16 crc16;
+    };
+
+    /// chunks of frames beyond this many are decoded again when they are needed again
+    static const int MAX_DECODED_CHUNKS = 16;
+
+    StreamedRecordingFrames(const RecordingFrameCodec& codec, const QVector<ChunkInfo>& chunks);
+
+    /// true if the chunks follow each other from frame 0 to numFrames - 1 without gaps, hold at most FRAMES_PER_CHUNK
+    /// frames each, and lie within the frame data. Chunk tables read from files have to pass this before they are used.
+    static bool areChunksValid(const QVector<ChunkInfo>& chunks, int numFrames, qint64 frameDataSize);
+
+    /// reads chunks from a file as they are needed
+    bool setSourceFile(const QString& filename, qint64 frameDataOffset);
+
+    /// reads chunks from frame data that is already in memory, e.g. because it was downloaded
+    void setSourceData(const QByteArray& frameData) { _frameData = frameData; }
+
+    /// may be called from any thread
+    RecordingFrame getFrame(int index);
+
+    int getNumDecodedChunks();
+
+private:
+    typedef QSharedPointer<const QVector<RecordingFrame> > DecodedChunk;
+
+    DecodedChunk getChunk(int chunkIndex);
+    bool readChunk(const ChunkInfo& chunk, QByteArray& encodedChunk);
+
+    RecordingFrameCodec _codec;
+    QVector<ChunkInfo> _chunks;
+
+    QMutex _mutex;
+    QScopedPointer<QFile> _file;
+    qint64 _frameDataOffset;
+    QByteArray _frameData;
+
+    QHash<int, DecodedChunk> _decodedChunks;
+    QList<int> _recentChunks; // most recently used last
+};
+
+#endif // hifi_RecordingStream_h
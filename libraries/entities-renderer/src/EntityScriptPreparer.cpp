@@ -0,0 +1,111 @@
+//
+//  EntityScriptPreparer.cpp
+//  libraries/entities-renderer/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QCryptographicHash>
+#include <QPointer>
+#include <QRunnable>
+#include <QScriptEngine>
+#include <QScriptSyntaxCheckResult>
+#include <QThreadPool>
+
+#include "EntityScriptPreparer.h"
+
+class EntityScriptSyntaxChecker : public QRunnable {
+public:
+    EntityScriptSyntaxChecker(EntityScriptPreparer* preparer, const QByteArray& contentHash, const QString& contents,
+                              const QString& fileName);
+
+    virtual void run();
+
+private:
+    QPointer<EntityScriptPreparer> _preparer;
+    QByteArray _contentHash;
+    QString _contents;
+    QString _fileName;
+};
+
+EntityScriptSyntaxChecker::EntityScriptSyntaxChecker(EntityScriptPreparer* preparer, const QByteArray& contentHash,
+                                                     const QString& contents, const QString& fileName) :
+    _preparer(preparer),
+    _contentHash(contentHash),
+    _contents(contents),
+    _fileName(fileName) {
+}
+
+void EntityScriptSyntaxChecker::run() {
+    QScriptSyntaxCheckResult syntaxCheck = QScriptEngine::checkSyntax(_contents);
+    if (_preparer) {
+        QMetaObject::invokeMethod(_preparer.data(), "setSyntaxCheckResult", Q_ARG(const QByteArray&, _contentHash),
+            Q_ARG(const QString&, _contents), Q_ARG(const QString&, _fileName),
+            Q_ARG(bool, syntaxCheck.state() == QScriptSyntaxCheckResult::Valid),
+            Q_ARG(const QString&, syntaxCheck.errorMessage()), Q_ARG(int, syntaxCheck.errorLineNumber()),
+            Q_ARG(int, syntaxCheck.errorColumnNumber()));
+    }
+}
+
+EntityScriptPreparer::EntityScriptPreparer(QObject* parent) :
+    QObject(parent) {
+}
+
+QByteArray EntityScriptPreparer::hashContents(const QString& contents) {
+    return QCryptographicHash::hash(contents.toUtf8(), QCryptographicHash::Sha1);
+}
+
+PreparedEntityScriptPointer EntityScriptPreparer::prepare(const QString& contents, const QString& fileName, bool wait) {
+    QByteArray contentHash = hashContents(contents);
+    PreparedEntityScriptPointer preparedScript = _preparedScripts.value(contentHash);
+    if (preparedScript) {
+        return preparedScript;
+    }
+    if (wait) {
+        // whoever is checking it on the thread pool will find it already prepared
+        QScriptSyntaxCheckResult syntaxCheck = QScriptEngine::checkSyntax(contents);
+        return addPreparedScript(contentHash, contents, fileName, syntaxCheck.state() == QScriptSyntaxCheckResult::Valid,
+            syntaxCheck.errorMessage(), syntaxCheck.errorLineNumber(), syntaxCheck.errorColumnNumber());
+    }
+    if (!_pendingScripts.contains(contentHash)) {
+        _pendingScripts.insert(contentHash);
+        QThreadPool::globalInstance()->start(new EntityScriptSyntaxChecker(this, contentHash, contents, fileName));
+    }
+    return PreparedEntityScriptPointer();
+}
+
+void EntityScriptPreparer::clear() {
+    // checks still running will add their scripts when they finish, which is harmless
+    _preparedScripts.clear();
+    _pendingScripts.clear();
+}
+
+void EntityScriptPreparer::setSyntaxCheckResult(const QByteArray& contentHash, const QString& contents,
+                                                const QString& fileName, bool isSyntaxValid, const QString& errorMessage,
+                                                int errorLineNumber, int errorColumnNumber) {
+    _pendingScripts.remove(contentHash);
+    if (!_preparedScripts.contains(contentHash)) {
+        addPreparedScript(contentHash, contents, fileName, isSyntaxValid, errorMessage, errorLineNumber, errorColumnNumber);
+    }
+    emit scriptPrepared(contentHash);
+}
+
+PreparedEntityScriptPointer EntityScriptPreparer::addPreparedScript(const QByteArray& contentHash, const QString& contents,
+                                                                    const QString& fileName, bool isSyntaxValid,
+                                                                    const QString& errorMessage, int errorLineNumber,
+                                                                    int errorColumnNumber) {
+    PreparedEntityScriptPointer preparedScript(new PreparedEntityScript());
+    preparedScript->contentHash = contentHash;
+    preparedScript->program = QScriptProgram(contents, fileName);
+    preparedScript->isSyntaxValid = isSyntaxValid;
+    preparedScript->errorMessage = errorMessage;
+    preparedScript->errorLineNumber = errorLineNumber;
+    preparedScript->errorColumnNumber = errorColumnNumber;
+    preparedScript->isConstructorChecked = false;
+    preparedScript->isConstructor = false;
+    _preparedScripts.insert(contentHash, preparedScript);
+    return preparedScript;
+}
@@ -0,0 +1,73 @@
+//
+//  EntityScriptPreparer.h
+//  libraries/entities-renderer/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Checks entity scripts off the main thread and keeps one compiled program per distinct script text.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityScriptPreparer_h
+#define hifi_EntityScriptPreparer_h
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QScriptProgram>
+#include <QSet>
+#include <QSharedPointer>
+
+/// The script text shared by every entity whose script has the same contents.
+class PreparedEntityScript {
+public:
+    QByteArray contentHash;
+
+    /// compiled the first time it is evaluated, and reused by every entity after that
+    QScriptProgram program;
+
+    bool isSyntaxValid;
+    QString errorMessage;
+    int errorLineNumber;
+    int errorColumnNumber;
+
+    /// whether the script evaluates to a constructor, found out once in the sandbox engine by EntityTreeRenderer
+    bool isConstructorChecked;
+    bool isConstructor;
+};
+
+typedef QSharedPointer<PreparedEntityScript> PreparedEntityScriptPointer;
+
+class EntityScriptPreparer : public QObject {
+    Q_OBJECT
+public:
+    EntityScriptPreparer(QObject* parent = NULL);
+
+    static QByteArray hashContents(const QString& contents);
+
+    /// Returns the prepared script for contents if it has been checked. Otherwise starts checking it on the thread pool
+    /// and returns a null pointer, and scriptPrepared() is emitted once it is ready. If wait is true, the contents are
+    /// checked right away instead.
+    PreparedEntityScriptPointer prepare(const QString& contents, const QString& fileName, bool wait = false);
+
+    void clear();
+
+signals:
+    void scriptPrepared(const QByteArray& contentHash);
+
+private slots:
+    void setSyntaxCheckResult(const QByteArray& contentHash, const QString& contents, const QString& fileName,
+                              bool isSyntaxValid, const QString& errorMessage, int errorLineNumber, int errorColumnNumber);
+
+private:
+    PreparedEntityScriptPointer addPreparedScript(const QByteArray& contentHash, const QString& contents,
+                                                  const QString& fileName, bool isSyntaxValid,
+                                                  const QString& errorMessage, int errorLineNumber, int errorColumnNumber);
+
+    QHash<QByteArray, PreparedEntityScriptPointer> _preparedScripts;
+    QSet<QByteArray> _pendingScripts;
+};
+
+#endif // hifi_EntityScriptPreparer_h
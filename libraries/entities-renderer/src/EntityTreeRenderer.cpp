@@ -14,8 +14,9 @@
 
 #include <glm/gtx/quaternion.hpp>
 
+#include <algorithm>
+
 #include <QEventLoop>
-#include <QScriptSyntaxCheckResult>
 
 #include <AbstractScriptingServicesInterface.h>
 #include <AbstractViewStateInterface.h>
@@ -63,6 +64,9 @@ EntityTreeRenderer::EntityTreeRenderer(bool wantScripts, AbstractViewStateInterf
     _displayModelElementProxy(false),
     _dontDoPrecisionPicking(false)
 {
+    _scriptPreparer = new EntityScriptPreparer(this);
+    connect(_scriptPreparer, &EntityScriptPreparer::scriptPrepared, this, &EntityTreeRenderer::entityScriptPrepared);
+
     REGISTER_ENTITY_TYPE_WITH_FACTORY(Model, RenderableModelEntityItem::factory)
     REGISTER_ENTITY_TYPE_WITH_FACTORY(Box, RenderableBoxEntityItem::factory)
     REGISTER_ENTITY_TYPE_WITH_FACTORY(Sphere, RenderableSphereEntityItem::factory)
@@ -99,6 +103,8 @@ void EntityTreeRenderer::clear() {
     }
     OctreeRenderer::clear();
     _entityScripts.clear();
+    _scheduledPreloads.clear();
+    _waitingOnPrepare.clear();
 
     auto scene = _viewState->getMain3DScene();
     render::PendingChanges pendingChanges;
@@ -122,9 +128,7 @@ void EntityTreeRenderer::init() {
         _sandboxScriptEngine = new ScriptEngine(NO_SCRIPT, "Entities Sandbox", NULL);
     }
 
-    // make sure our "last avatar position" is something other than our current position, so that on our
-    // first chance, we'll check for enter/leave entity events.    
-    _lastAvatarPosition = _viewState->getAvatarPosition() + glm::vec3((float)TREE_SCALE);
+    _containmentTracker.setTree(entityTree);
     
     connect(entityTree, &EntityTree::deletingEntity, this, &EntityTreeRenderer::deletingEntity);
     connect(entityTree, &EntityTree::addingEntity, this, &EntityTreeRenderer::addingEntity);
@@ -141,7 +145,7 @@ void EntityTreeRenderer::scriptContentsAvailable(const QUrl& url, const QString&
         QList<EntityItemID> entityIDs = _waitingOnPreload.values(url);
         _waitingOnPreload.remove(url);
         foreach(EntityItemID entityID, entityIDs) {
-            checkAndCallPreload(entityID);
+            schedulePreload(entityID);
         } 
     }
 }
@@ -257,11 +261,19 @@ QScriptValue EntityTreeRenderer::loadEntityScript(EntityItemPointer entity, bool
         return QScriptValue(); // no script contents...
     }
     
-    QScriptSyntaxCheckResult syntaxCheck = QScriptEngine::checkSyntax(scriptContents);
-    if (syntaxCheck.state() != QScriptSyntaxCheckResult::Valid) {
+    // Preloads don't wait for the syntax check, which runs on the thread pool. Entities with the same script text
+    // share one check and one compiled program.
+    PreparedEntityScriptPointer preparedScript = _scriptPreparer->prepare(scriptContents, isURL ? url.toString() : QString(),
+                                                                          !isPreload);
+    if (!preparedScript) {
+        _waitingOnPrepare.insert(EntityScriptPreparer::hashContents(scriptContents), entityID);
+        return QScriptValue(); // not checked yet
+    }
+
+    if (!preparedScript->isSyntaxValid) {
         qCDebug(entitiesrenderer) << "EntityTreeRenderer::loadEntityScript() entity:" << entityID;
-        qCDebug(entitiesrenderer) << "   " << syntaxCheck.errorMessage() << ":"
-                          << syntaxCheck.errorLineNumber() << syntaxCheck.errorColumnNumber();
+        qCDebug(entitiesrenderer) << "   " << preparedScript->errorMessage << ":"
+                          << preparedScript->errorLineNumber << preparedScript->errorColumnNumber;
         qCDebug(entitiesrenderer) << "    SCRIPT:" << entityScript;
 
         scriptCache->addScriptToBadScriptList(url);
@@ -272,9 +284,13 @@ QScriptValue EntityTreeRenderer::loadEntityScript(EntityItemPointer entity, bool
     if (isURL) {
         _entitiesScriptEngine->setParentURL(entity->getScript());
     }
-    QScriptValue entityScriptConstructor = _sandboxScriptEngine->evaluate(scriptContents);
+    if (!preparedScript->isConstructorChecked) {
+        preparedScript->isConstructor = _sandboxScriptEngine->evaluate(scriptContents).isFunction();
+        preparedScript->isConstructorChecked = true;
+    }
     
-    if (!entityScriptConstructor.isFunction()) {
+    QScriptValue entityScriptConstructor;
+    if (!preparedScript->isConstructor) {
         qCDebug(entitiesrenderer) << "EntityTreeRenderer::loadEntityScript() entity:" << entityID;
         qCDebug(entitiesrenderer) << "    NOT CONSTRUCTOR";
         qCDebug(entitiesrenderer) << "    SCRIPT:" << entityScript;
@@ -283,7 +299,7 @@ QScriptValue EntityTreeRenderer::loadEntityScript(EntityItemPointer entity, bool
 
         return QScriptValue(); // invalid script
     } else {
-        entityScriptConstructor = _entitiesScriptEngine->evaluate(scriptContents);
+        entityScriptConstructor = _entitiesScriptEngine->evaluate(preparedScript->program);
     }
 
     QScriptValue entityScriptObject = entityScriptConstructor.construct();
@@ -294,6 +310,17 @@ QScriptValue EntityTreeRenderer::loadEntityScript(EntityItemPointer entity, bool
         _entitiesScriptEngine->setParentURL("");
     }
 
+    // whatever needs the script before its scheduled preload gets to it, e.g. the avatar entering the entity, gets it
+    // preloaded first
+    if (!isPreload) {
+        bool isPreloadScheduled = _scheduledPreloads.remove(entityID);
+        isPreloadScheduled = (_waitingOnPrepare.remove(preparedScript->contentHash, entityID) > 0) || isPreloadScheduled;
+        if (isPreloadScheduled && entityScriptObject.property("preload").isValid()) {
+            QScriptValueList entityArgs = createEntityArgs(entityID);
+            entityScriptObject.property("preload").call(entityScriptObject, entityArgs);
+        }
+    }
+
     return entityScriptObject; // newly constructed
 }
 
@@ -315,6 +342,8 @@ void EntityTreeRenderer::update() {
         EntityTree* tree = static_cast<EntityTree*>(_tree);
         tree->update();
         
+        preloadScheduledEntities();
+
         // check to see if the avatar has moved and if we need to handle enter/leave entity logic
         checkEnterLeaveEntities();
 
@@ -337,53 +366,35 @@ void EntityTreeRenderer::checkEnterLeaveEntities() {
     if (_tree && !_shuttingDown) {
         glm::vec3 avatarPosition = _viewState->getAvatarPosition();
         
-        if (avatarPosition != _lastAvatarPosition) {
-            float radius = 1.0f; // for now, assume 1 meter radius
-            QVector<EntityItemPointer> foundEntities;
-            QVector<EntityItemID> entitiesContainingAvatar;
-            
-            // find the entities near us
-            _tree->lockForRead(); // don't let someone else change our tree while we search
-            static_cast<EntityTree*>(_tree)->findEntities(avatarPosition, radius, foundEntities);
-
-            // create a list of entities that actually contain the avatar's position
-            foreach(EntityItemPointer entity, foundEntities) {
-                if (entity->contains(avatarPosition)) {
-                    entitiesContainingAvatar << entity->getEntityItemID();
-                }
-            }
-            _tree->unlock();
+        // the tracker only searches the tree again when the avatar changes cells or entities near it change
+        QVector<EntityItemID> enteredEntities;
+        QVector<EntityItemID> leftEntities;
+        _containmentTracker.setTree(static_cast<EntityTree*>(_tree));
+        if (_containmentTracker.update(avatarPosition, enteredEntities, leftEntities)) {
             
             // Note: at this point we don't need to worry about the tree being locked, because we only deal with
             // EntityItemIDs from here. The loadEntityScript() method is robust against attempting to load scripts
             // for entity IDs that no longer exist. 
 
             // for all of our previous containing entities, if they are no longer containing then send them a leave event
-            foreach(const EntityItemID& entityID, _currentEntitiesInside) {
-                if (!entitiesContainingAvatar.contains(entityID)) {
-                    emit leaveEntity(entityID);
-                    QScriptValueList entityArgs = createEntityArgs(entityID);
-                    QScriptValue entityScript = loadEntityScript(entityID);
-                    if (entityScript.property("leaveEntity").isValid()) {
-                        entityScript.property("leaveEntity").call(entityScript, entityArgs);
-                    }
-
+            foreach(const EntityItemID& entityID, leftEntities) {
+                emit leaveEntity(entityID);
+                QScriptValueList entityArgs = createEntityArgs(entityID);
+                QScriptValue entityScript = loadEntityScript(entityID);
+                if (entityScript.property("leaveEntity").isValid()) {
+                    entityScript.property("leaveEntity").call(entityScript, entityArgs);
                 }
             }
 
             // for all of our new containing entities, if they weren't previously containing then send them an enter event
-            foreach(const EntityItemID& entityID, entitiesContainingAvatar) {
-                if (!_currentEntitiesInside.contains(entityID)) {
-                    emit enterEntity(entityID);
-                    QScriptValueList entityArgs = createEntityArgs(entityID);
-                    QScriptValue entityScript = loadEntityScript(entityID);
-                    if (entityScript.property("enterEntity").isValid()) {
-                        entityScript.property("enterEntity").call(entityScript, entityArgs);
-                    }
+            foreach(const EntityItemID& entityID, enteredEntities) {
+                emit enterEntity(entityID);
+                QScriptValueList entityArgs = createEntityArgs(entityID);
+                QScriptValue entityScript = loadEntityScript(entityID);
+                if (entityScript.property("enterEntity").isValid()) {
+                    entityScript.property("enterEntity").call(entityScript, entityArgs);
                 }
             }
-            _currentEntitiesInside = entitiesContainingAvatar;
-            _lastAvatarPosition = avatarPosition;
         }
     }
 }
@@ -391,8 +402,9 @@ void EntityTreeRenderer::checkEnterLeaveEntities() {
 void EntityTreeRenderer::leaveAllEntities() {
     if (_tree && !_shuttingDown) {
 
-        // for all of our previous containing entities, if they are no longer containing then send them a leave event
-        foreach(const EntityItemID& entityID, _currentEntitiesInside) {
+        // for all of our previous containing entities send them a leave event. Forgetting them also makes sure that
+        // on our first chance, we'll check for enter/leave entity events.
+        foreach(const EntityItemID& entityID, _containmentTracker.clear()) {
             emit leaveEntity(entityID);
             QScriptValueList entityArgs = createEntityArgs(entityID);
             QScriptValue entityScript = loadEntityScript(entityID);
@@ -400,11 +412,6 @@ void EntityTreeRenderer::leaveAllEntities() {
                 entityScript.property("leaveEntity").call(entityScript, entityArgs);
             }
         }
-        _currentEntitiesInside.clear();
-        
-        // make sure our "last avatar position" is something other than our current position, so that on our
-        // first chance, we'll check for enter/leave entity events.    
-        _lastAvatarPosition = _viewState->getAvatarPosition() + glm::vec3((float)TREE_SCALE);
     }
 }
 
@@ -998,6 +1005,7 @@ void EntityTreeRenderer::deletingEntity(const EntityItemID& entityID) {
         checkAndCallUnload(entityID);
     }
     _entityScripts.remove(entityID);
+    _scheduledPreloads.remove(entityID);
     
     // here's where we remove the entity payload from the scene
     if (_entitiesInScene.contains(entityID)) {
@@ -1010,7 +1018,7 @@ void EntityTreeRenderer::deletingEntity(const EntityItemID& entityID) {
 }
 
 void EntityTreeRenderer::addingEntity(const EntityItemID& entityID) {
-    checkAndCallPreload(entityID);
+    schedulePreload(entityID);
     auto entity = static_cast<EntityTree*>(_tree)->findEntityByID(entityID);
     if (entity) {
         addEntityToScene(entity);
@@ -1031,7 +1039,52 @@ void EntityTreeRenderer::addEntityToScene(EntityItemPointer entity) {
 void EntityTreeRenderer::entitySciptChanging(const EntityItemID& entityID) {
     if (_tree && !_shuttingDown) {
         checkAndCallUnload(entityID);
-        checkAndCallPreload(entityID);
+        schedulePreload(entityID);
+    }
+}
+
+void EntityTreeRenderer::entityScriptPrepared(const QByteArray& contentHash) {
+    foreach (const EntityItemID& entityID, _waitingOnPrepare.values(contentHash)) {
+        schedulePreload(entityID);
+    }
+    _waitingOnPrepare.remove(contentHash);
+}
+
+void EntityTreeRenderer::schedulePreload(const EntityItemID& entityID) {
+    if (_tree && !_shuttingDown) {
+        _scheduledPreloads.insert(entityID);
+    }
+}
+
+void EntityTreeRenderer::preloadScheduledEntities() {
+    if (_scheduledPreloads.isEmpty()) {
+        return;
+    }
+    
+    // entities near the avatar get their scripts first, and the rest wait for later frames once we're over budget
+    const quint64 PRELOAD_USECS_PER_FRAME = 2 * USECS_PER_MSEC;
+    glm::vec3 avatarPosition = _viewState->getAvatarPosition();
+    EntityTree* tree = static_cast<EntityTree*>(_tree);
+    QVector<QPair<float, EntityItemID> > preloadsByDistance;
+    foreach (const EntityItemID& entityID, _scheduledPreloads) {
+        EntityItemPointer entity = tree->findEntityByEntityItemID(entityID);
+        if (entity && !entity->getScript().isEmpty()) {
+            preloadsByDistance << qMakePair(glm::distance(avatarPosition, entity->getPosition()), entityID);
+        }
+    }
+    _scheduledPreloads.clear();
+    std::sort(preloadsByDistance.begin(), preloadsByDistance.end(),
+        [](const QPair<float, EntityItemID>& a, const QPair<float, EntityItemID>& b) { return a.first < b.first; });
+    
+    quint64 start = usecTimestampNow();
+    for (int i = 0; i < preloadsByDistance.size(); i++) {
+        if (i > 0 && usecTimestampNow() - start > PRELOAD_USECS_PER_FRAME) {
+            for (int j = i; j < preloadsByDistance.size(); j++) {
+                _scheduledPreloads.insert(preloadsByDistance[j].second);
+            }
+            break;
+        }
+        checkAndCallPreload(preloadsByDistance[i].second);
     }
 }
 
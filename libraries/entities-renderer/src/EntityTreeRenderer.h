@@ -15,6 +15,7 @@
 #include <QSet>
 #include <QStack>
 
+#include <EntityContainmentTracker.h>
 #include <EntityTree.h>
 #include <EntityScriptingInterface.h> // for RayToEntityIntersectionResult
 #include <MouseEvent.h>
@@ -22,6 +23,8 @@
 #include <ScriptCache.h>
 #include <AbstractAudioInterface.h>
 
+#include "EntityScriptPreparer.h"
+
 class AbstractScriptingServicesInterface;
 class AbstractViewStateInterface;
 class Model;
@@ -111,6 +114,7 @@ public slots:
     void addingEntity(const EntityItemID& entityID);
     void deletingEntity(const EntityItemID& entityID);
     void entitySciptChanging(const EntityItemID& entityID);
+    void entityScriptPrepared(const QByteArray& contentHash);
     void entityCollisionWithEntity(const EntityItemID& idA, const EntityItemID& idB, const Collision& collision);
 
     // optional slots that can be wired to menu items
@@ -129,6 +133,8 @@ private:
     void renderElementProxy(EntityTreeElement* entityTreeElement, RenderArgs* args);
     void checkAndCallPreload(const EntityItemID& entityID);
     void checkAndCallUnload(const EntityItemID& entityID);
+    void schedulePreload(const EntityItemID& entityID);
+    void preloadScheduledEntities();
 
     QList<Model*> _releasedModels;
     void renderProxies(EntityItemPointer entity, RenderArgs* args);
@@ -141,8 +147,7 @@ private:
     QScriptValueList createEntityArgs(const EntityItemID& entityID);
     void checkEnterLeaveEntities();
     void leaveAllEntities();
-    glm::vec3 _lastAvatarPosition;
-    QVector<EntityItemID> _currentEntitiesInside;
+    EntityContainmentTracker _containmentTracker;
     
     bool _wantScripts;
     ScriptEngine* _entitiesScriptEngine;
@@ -156,6 +161,9 @@ private:
     QScriptValueList createMouseEventArgs(const EntityItemID& entityID, const MouseEvent& mouseEvent);
     
     QHash<EntityItemID, EntityScriptDetails> _entityScripts;
+    EntityScriptPreparer* _scriptPreparer;
+    QSet<EntityItemID> _scheduledPreloads; // called nearest first, for a few msecs per frame
+    QMultiHash<QByteArray, EntityItemID> _waitingOnPrepare; // by the content hash of their scripts
 
     void playEntityCollisionSound(const QUuid& myNodeID, EntityTree* entityTree, const EntityItemID& id, const Collision& collision);
     AbstractAudioInterface* _localAudioInterface; // So we can render collision sounds
@@ -234,6 +234,11 @@ void RenderableModelEntityItem::render(RenderArgs* args) {
             }
             
             if (_model) {
+                // until the model is loaded, its downloads are prioritized by where the entity says it is
+                if (!_model->isLoadedWithTextures()) {
+                    _model->setLoadBounds(position, 0.5f * glm::length(dimensions));
+                }
+
                 // handle animations..
                 if (hasAnimation()) {
                     if (!jointsMapped()) {
@@ -0,0 +1,112 @@
+//
+//  EntityContainmentTracker.cpp
+//  libraries/entities/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <OctreeConstants.h>
+
+#include "EntityContainmentTracker.h"
+
+static const float CELL_SCALE = (float)TREE_SCALE / (float)(1 << EntityContainmentTracker::CELL_LEVEL);
+
+EntityContainmentTracker::EntityContainmentTracker() :
+    _hasCell(false),
+    _candidatesChanged(true),
+    _numCandidateQueries(0),
+    _hasPosition(false)
+{
+}
+
+EntityContainmentTracker::~EntityContainmentTracker() {
+    setTree(NULL);
+}
+
+void EntityContainmentTracker::setTree(EntityTree* tree) {
+    if (_tree == tree) {
+        return;
+    }
+    if (_tree) {
+        _tree->removeBoundsChangedHook(this);
+    }
+    _tree = tree;
+    if (_tree) {
+        _tree->addBoundsChangedHook(this);
+    }
+    _hasCell = false;
+    _candidatesChanged = true;
+    _candidates.clear();
+}
+
+void EntityContainmentTracker::entityBoundsChanged(const AACube& bounds) {
+    // the tree is locked for writing, so we aren't in update() and _cell holds still
+    if (_hasCell && bounds.touches(_cell)) {
+        _candidatesChanged = true;
+    }
+}
+
+void EntityContainmentTracker::queryCandidates(const AACube& cell) {
+    _cell = cell;
+    _hasCell = true;
+    _candidatesChanged = false;
+    _numCandidateQueries++;
+
+    // every entity that contains a point of the cell touches it
+    QVector<EntityItemPointer> foundEntities;
+    _tree->findEntities(cell, foundEntities);
+    _candidates.clear();
+    _candidates.reserve(foundEntities.size());
+    foreach (const EntityItemPointer& entity, foundEntities) {
+        _candidates << entity;
+    }
+}
+
+bool EntityContainmentTracker::update(const glm::vec3& position, QVector<EntityItemID>& entered,
+                                      QVector<EntityItemID>& left) {
+    entered.clear();
+    left.clear();
+    if (!_tree || (_hasPosition && position == _lastPosition && !_candidatesChanged)) {
+        return false;
+    }
+
+    QVector<EntityItemID> entitiesContaining;
+
+    _tree->lockForRead();
+    AACube cell(glm::floor(position / CELL_SCALE) * CELL_SCALE, CELL_SCALE);
+    if (!_hasCell || cell != _cell || _candidatesChanged) {
+        queryCandidates(cell);
+    }
+    foreach (const EntityItemWeakPointer& candidate, _candidates) {
+        EntityItemPointer entity = candidate.lock();
+        if (entity && entity->contains(position)) {
+            entitiesContaining << entity->getEntityItemID();
+        }
+    }
+    _tree->unlock();
+
+    foreach (const EntityItemID& entityID, _entitiesContaining) {
+        if (!entitiesContaining.contains(entityID)) {
+            left << entityID;
+        }
+    }
+    foreach (const EntityItemID& entityID, entitiesContaining) {
+        if (!_entitiesContaining.contains(entityID)) {
+            entered << entityID;
+        }
+    }
+    _entitiesContaining = entitiesContaining;
+    _lastPosition = position;
+    _hasPosition = true;
+    return true;
+}
+
+QVector<EntityItemID> EntityContainmentTracker::clear() {
+    QVector<EntityItemID> entitiesContaining = _entitiesContaining;
+    _entitiesContaining.clear();
+    _hasPosition = false;
+    return entitiesContaining;
+}
@@ -0,0 +1,69 @@
+//
+//  EntityContainmentTracker.h
+//  libraries/entities/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Keeps track of the entities that contain a point, e.g. the avatar, as the point moves and the entities change.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityContainmentTracker_h
+#define hifi_EntityContainmentTracker_h
+
+#include <atomic>
+
+#include <QPointer>
+#include <QVector>
+
+#include <AACube.h>
+
+#include "EntityItemID.h"
+#include "EntityTree.h"
+
+/// The entities that might contain the point are looked up in the tree once for the octree cell the point is in, and
+/// looked up again only when the point moves to another cell or an entity touching that cell is added, changed, moved
+/// or deleted. In between, only those candidates are tested against the point.
+class EntityContainmentTracker : public EntityBoundsChangedHook {
+public:
+    /// the size of the cells the candidates are kept for, i.e. of the octree elements this many levels below the root
+    static const int CELL_LEVEL = 11;
+
+    EntityContainmentTracker();
+    virtual ~EntityContainmentTracker();
+
+    void setTree(EntityTree* tree);
+
+    /// Brings the entities containing position up to date. Returns false, and leaves entered and left empty, if nothing
+    /// could have changed since the last update. Locks the tree for reading.
+    bool update(const glm::vec3& position, QVector<EntityItemID>& entered, QVector<EntityItemID>& left);
+
+    /// forgets the entities the point is in, which are returned, so that the next update finds them all as entered
+    QVector<EntityItemID> clear();
+
+    const QVector<EntityItemID>& getEntitiesContaining() const { return _entitiesContaining; }
+
+    /// how many times the candidates have been looked up in the tree
+    int getNumCandidateQueries() const { return _numCandidateQueries; }
+
+    virtual void entityBoundsChanged(const AACube& bounds);
+
+private:
+    void queryCandidates(const AACube& cell);
+
+    QPointer<EntityTree> _tree;
+
+    AACube _cell;
+    bool _hasCell;
+    std::atomic<bool> _candidatesChanged;
+    QVector<EntityItemWeakPointer> _candidates;
+    int _numCandidateQueries;
+
+    bool _hasPosition;
+    glm::vec3 _lastPosition;
+    QVector<EntityItemID> _entitiesContaining;
+};
+
+#endif // hifi_EntityContainmentTracker_h
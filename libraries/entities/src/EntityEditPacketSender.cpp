@@ -10,6 +10,7 @@
 //
 
 #include <assert.h>
+#include <NodeList.h>
 #include <PerfStat.h>
 #include <OctalCode.h>
 #include <PacketHeaders.h>
@@ -57,3 +58,62 @@ void EntityEditPacketSender::queueEraseEntityMessage(const EntityItemID& entityI
         queueOctreeEditMessage(PacketTypeEntityErase, bufferOut, sizeOut);
     }
 }
+
+void EntityEditPacketSender::queuePhysicsStateUpdate(const QUuid& entityID, const EntityPhysicsState& state) {
+    if (!_shouldSend) {
+        return; // bail early
+    }
+    QMutexLocker locker(&_physicsStateLock);
+    _queuedPhysicsStates[entityID] = state;
+}
+
+void EntityEditPacketSender::flushPhysicsStateUpdates() {
+    QMutexLocker locker(&_physicsStateLock);
+    if (_queuedPhysicsStates.isEmpty()) {
+        return;
+    }
+
+    auto nodeList = DependencyManager::get<NodeList>();
+    QByteArray header = nodeList->byteArrayWithPopulatedHeader(PacketTypeEntityPhysicsStateBatch);
+
+    QSet<QUuid> activeServers;
+    nodeList->eachNode([&](const SharedNodePointer& node){
+        if (node->getType() != getMyNodeType() || !node->getActiveSocket()) {
+            return;
+        }
+        activeServers.insert(node->getUUID());
+        EntityPhysicsStateBatchWriter& writer = _physicsStateWriters[node->getUUID()];
+
+        QHash<QUuid, EntityPhysicsState>::const_iterator stateItr = _queuedPhysicsStates.constBegin();
+        while (stateItr != _queuedPhysicsStates.constEnd()) {
+            writer.queueState(stateItr.key(), stateItr.value());
+            ++stateItr;
+        }
+
+        std::vector<QByteArray> payloads = writer.takePayloads(_maxPacketSize - header.size());
+        for (const QByteArray& payload : payloads) {
+            queuePacketForSending(node, header + payload);
+        }
+    });
+
+    // writers for servers that went away are dropped, a server that comes back starts from scratch
+    QHash<QUuid, EntityPhysicsStateBatchWriter>::iterator writerItr = _physicsStateWriters.begin();
+    while (writerItr != _physicsStateWriters.end()) {
+        if (activeServers.contains(writerItr.key())) {
+            ++writerItr;
+        } else {
+            writerItr = _physicsStateWriters.erase(writerItr);
+        }
+    }
+    _queuedPhysicsStates.clear();
+}
+
+void EntityEditPacketSender::processPhysicsStateBatchAck(const QByteArray& packet) {
+    QUuid sendingNodeUUID = uuidFromPacketHeader(packet);
+
+    QMutexLocker locker(&_physicsStateLock);
+    QHash<QUuid, EntityPhysicsStateBatchWriter>::iterator writerItr = _physicsStateWriters.find(sendingNodeUUID);
+    if (writerItr != _physicsStateWriters.end()) {
+        writerItr->processAckPayload(packet.mid(numBytesForPacketHeader(packet)));
+    }
+}
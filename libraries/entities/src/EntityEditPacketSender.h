@@ -12,9 +12,12 @@
 #ifndef hifi_EntityEditPacketSender_h
 #define hifi_EntityEditPacketSender_h
 
+#include <QtCore/QMutex>
+
 #include <OctreeEditPacketSender.h>
 
 #include "EntityItem.h"
+#include "EntityPhysicsStateBatch.h"
 
 /// Utility for processing, packing, queueing and sending of outbound edit voxel messages.
 class EntityEditPacketSender :  public OctreeEditPacketSender {
@@ -28,8 +31,19 @@ public:
 
     void queueEraseEntityMessage(const EntityItemID& entityItemID);
 
+    /// Queues a physics update for an entity we simulate. Unlike edit messages these are coalesced per entity until
+    /// flushPhysicsStateUpdates() packs them into batches, and are not resent when lost.
+    void queuePhysicsStateUpdate(const QUuid& entityID, const EntityPhysicsState& state);
+    void flushPhysicsStateUpdates();
+    void processPhysicsStateBatchAck(const QByteArray& packet);
+
     // My server type is the model server
     virtual char getMyNodeType() const { return NodeType::EntityServer; }
     virtual void adjustEditPacketForClockSkew(PacketType type, unsigned char* editBuffer, size_t length, int clockSkew);
+
+private:
+    QMutex _physicsStateLock;
+    QHash<QUuid, EntityPhysicsState> _queuedPhysicsStates;
+    QHash<QUuid, EntityPhysicsStateBatchWriter> _physicsStateWriters; // one per entity server, by node UUID
 };
 #endif // hifi_EntityEditPacketSender_h
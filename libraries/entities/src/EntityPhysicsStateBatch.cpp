@@ -0,0 +1,484 @@
+//
+//  EntityPhysicsStateBatch.cpp
+//  libraries/entities/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <QtCore/QSet>
+
+#include "EntityPhysicsStateBatch.h"
+
+// Each body in a batch is
+//   handle (2), flags (1), [entity ID (16)], [baseline offset (1)],
+//   [position: full 3 x 24 bit (9) or delta vs the baseline 3 x 16 bit (6)], [rotation (4)], [velocities 6 x 16 bit (12)]
+const quint8 BODY_HAS_ENTITY_ID = 0x01;
+const quint8 BODY_HAS_BASELINE = 0x02;
+const quint8 BODY_POSITION_CHANGED = 0x04;
+const quint8 BODY_ROTATION_CHANGED = 0x08;
+const quint8 BODY_IS_MOVING = 0x10;
+const quint8 BODY_IS_BALLISTIC = 0x20;
+const quint8 BODY_RELEASES_OWNERSHIP = 0x40;
+
+const int NUM_BYTES_RFC4122_UUID = 16;
+const int NUM_BYTES_FULL_POSITION_COMPONENT = 3;
+const int MAX_BODY_BYTES = sizeof(PhysicsEntityHandle) + sizeof(quint8) + NUM_BYTES_RFC4122_UUID + sizeof(quint8)
+    + 3 * NUM_BYTES_FULL_POSITION_COMPONENT + sizeof(quint32) + 6 * sizeof(qint16);
+
+// positions are fixed point with 1mm resolution, 24 bits cover the whole domain
+const float POSITION_UNITS_PER_METER = 1024.0f;
+const qint32 MAX_QUANTIZED_POSITION = (1 << 24) - 1;
+
+// good up to 128 m/s and 32 radians/s
+const float LINEAR_VELOCITY_UNITS_PER_METER_PER_SECOND = 256.0f;
+const float ANGULAR_VELOCITY_UNITS_PER_RADIAN_PER_SECOND = 1024.0f;
+
+// the three smallest components of a unit quaternion lie within +/- 1/sqrt(2), we keep 10 bits of each
+const int ROTATION_COMPONENT_BITS = 10;
+const quint32 ROTATION_COMPONENT_MASK = (1 << ROTATION_COMPONENT_BITS) - 1;
+const float MAX_SMALLEST_ROTATION_COMPONENT = 1.0f / sqrtf(2.0f);
+
+static bool isNewerSequence(PhysicsBatchSequenceNumber a, PhysicsBatchSequenceNumber b) {
+    return (qint16)(a - b) > 0;
+}
+
+static qint16 quantizeToShort(float value, float unitsPerValue) {
+    return (qint16)glm::clamp(roundf(value * unitsPerValue), -32767.0f, 32767.0f);
+}
+
+static quint32 packRotation(const glm::quat& rotation) {
+    glm::quat normalized = glm::normalize(rotation);
+    float components[4] = { normalized.x, normalized.y, normalized.z, normalized.w };
+
+    int largestIndex = 0;
+    for (int i = 1; i < 4; i++) {
+        if (fabsf(components[i]) > fabsf(components[largestIndex])) {
+            largestIndex = i;
+        }
+    }
+    // q and -q are the same rotation, flip so the one we leave out is positive
+    float sign = components[largestIndex] < 0.0f ? -1.0f : 1.0f;
+
+    quint32 packed = (quint32)largestIndex;
+    for (int i = 0; i < 4; i++) {
+        if (i != largestIndex) {
+            float normalizedComponent = glm::clamp(sign * components[i] / MAX_SMALLEST_ROTATION_COMPONENT, -1.0f, 1.0f);
+            quint32 quantized = (quint32)roundf((normalizedComponent * 0.5f + 0.5f) * ROTATION_COMPONENT_MASK);
+            packed = (packed << ROTATION_COMPONENT_BITS) | quantized;
+        }
+    }
+    return packed;
+}
+
+static glm::quat unpackRotation(quint32 packed) {
+    float components[4];
+    int largestIndex = (int)(packed >> (3 * ROTATION_COMPONENT_BITS)) & 0x3;
+
+    float sumOfSquares = 0.0f;
+    int shift = 2 * ROTATION_COMPONENT_BITS;
+    for (int i = 0; i < 4; i++) {
+        if (i != largestIndex) {
+            quint32 quantized = (packed >> shift) & ROTATION_COMPONENT_MASK;
+            components[i] = ((float)quantized / ROTATION_COMPONENT_MASK * 2.0f - 1.0f) * MAX_SMALLEST_ROTATION_COMPONENT;
+            sumOfSquares += components[i] * components[i];
+            shift -= ROTATION_COMPONENT_BITS;
+        }
+    }
+    components[largestIndex] = sqrtf(std::max(0.0f, 1.0f - sumOfSquares));
+
+    return glm::normalize(glm::quat(components[3], components[0], components[1], components[2]));
+}
+
+EntityPhysicsState::EntityPhysicsState() :
+    position(0.0f),
+    rotation(),
+    velocity(0.0f),
+    angularVelocity(0.0f),
+    isBallistic(false),
+    isReleasingOwnership(false)
+{
+}
+
+QuantizedEntityPhysicsState::QuantizedEntityPhysicsState() :
+    rotation(0),
+    isBallistic(false),
+    isReleasingOwnership(false)
+{
+    std::fill(position, position + 3, 0);
+    std::fill(velocity, velocity + 3, 0);
+    std::fill(angularVelocity, angularVelocity + 3, 0);
+}
+
+QuantizedEntityPhysicsState QuantizedEntityPhysicsState::fromState(const EntityPhysicsState& state) {
+    QuantizedEntityPhysicsState quantized;
+    for (int i = 0; i < 3; i++) {
+        quantized.position[i] = (qint32)glm::clamp(roundf(state.position[i] * POSITION_UNITS_PER_METER),
+                                                   0.0f, (float)MAX_QUANTIZED_POSITION);
+        quantized.velocity[i] = quantizeToShort(state.velocity[i], LINEAR_VELOCITY_UNITS_PER_METER_PER_SECOND);
+        quantized.angularVelocity[i] = quantizeToShort(state.angularVelocity[i],
+                                                       ANGULAR_VELOCITY_UNITS_PER_RADIAN_PER_SECOND);
+    }
+    quantized.rotation = packRotation(state.rotation);
+    quantized.isBallistic = state.isBallistic;
+    quantized.isReleasingOwnership = state.isReleasingOwnership;
+    return quantized;
+}
+
+EntityPhysicsState QuantizedEntityPhysicsState::toState() const {
+    EntityPhysicsState state;
+    for (int i = 0; i < 3; i++) {
+        state.position[i] = (float)position[i] / POSITION_UNITS_PER_METER;
+        state.velocity[i] = (float)velocity[i] / LINEAR_VELOCITY_UNITS_PER_METER_PER_SECOND;
+        state.angularVelocity[i] = (float)angularVelocity[i] / ANGULAR_VELOCITY_UNITS_PER_RADIAN_PER_SECOND;
+    }
+    state.rotation = unpackRotation(rotation);
+    state.isBallistic = isBallistic;
+    state.isReleasingOwnership = isReleasingOwnership;
+    return state;
+}
+
+bool QuantizedEntityPhysicsState::isMoving() const {
+    for (int i = 0; i < 3; i++) {
+        if (velocity[i] != 0 || angularVelocity[i] != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+EntityPhysicsStateBatchWriter::EntityPhysicsStateBatchWriter() :
+    _nextHandle(0),
+    _nextSequence(0)
+{
+}
+
+void EntityPhysicsStateBatchWriter::queueState(const QUuid& entityID, const EntityPhysicsState& state) {
+    _queuedStates[entityID] = state;
+}
+
+void EntityPhysicsStateBatchWriter::reset() {
+    // the sequence keeps counting so that the reader can tell stale bodies for reused handles apart
+    _handles.clear();
+    _nextHandle = 0;
+    _sentBatches.clear();
+}
+
+EntityPhysicsStateBatchWriter::HandleInfo& EntityPhysicsStateBatchWriter::handleInfoFor(const QUuid& entityID) {
+    QHash<QUuid, HandleInfo>::iterator it = _handles.find(entityID);
+    if (it != _handles.end()) {
+        return *it;
+    }
+    const int MAX_HANDLES = 1 << (8 * sizeof(PhysicsEntityHandle));
+    if (_handles.size() >= MAX_HANDLES) {
+        // out of handles, start over and introduce every entity again
+        reset();
+    }
+    HandleInfo info;
+    info.handle = _nextHandle++;
+    info.isAcknowledged = false;
+    info.hasBaseline = false;
+    info.baselineSequence = 0;
+    return *_handles.insert(entityID, info);
+}
+
+void EntityPhysicsStateBatchWriter::writeBody(QByteArray& payload, const QUuid& entityID, HandleInfo& info,
+                                              const QuantizedEntityPhysicsState& state,
+                                              PhysicsBatchSequenceNumber sequence) {
+    qint16 positionDelta[3];
+    bool useBaseline = info.hasBaseline
+        && (PhysicsBatchSequenceNumber)(sequence - info.baselineSequence) < BASELINE_WINDOW;
+    for (int i = 0; useBaseline && i < 3; i++) {
+        qint32 delta = state.position[i] - info.baseline.position[i];
+        if (delta < -32767 || delta > 32767) {
+            useBaseline = false;
+        }
+        positionDelta[i] = (qint16)delta;
+    }
+
+    quint8 flags = 0;
+    if (!info.isAcknowledged) {
+        flags |= BODY_HAS_ENTITY_ID;
+    }
+    if (useBaseline) {
+        flags |= BODY_HAS_BASELINE;
+        if (positionDelta[0] != 0 || positionDelta[1] != 0 || positionDelta[2] != 0) {
+            flags |= BODY_POSITION_CHANGED;
+        }
+        if (state.rotation != info.baseline.rotation) {
+            flags |= BODY_ROTATION_CHANGED;
+        }
+    } else {
+        flags |= BODY_POSITION_CHANGED | BODY_ROTATION_CHANGED;
+    }
+    if (state.isMoving()) {
+        flags |= BODY_IS_MOVING;
+    }
+    if (state.isBallistic) {
+        flags |= BODY_IS_BALLISTIC;
+    }
+    if (state.isReleasingOwnership) {
+        flags |= BODY_RELEASES_OWNERSHIP;
+    }
+
+    payload.append(reinterpret_cast<const char*>(&info.handle), sizeof(info.handle));
+    payload.append(reinterpret_cast<const char*>(&flags), sizeof(flags));
+    if (flags & BODY_HAS_ENTITY_ID) {
+        payload.append(entityID.toRfc4122());
+    }
+    if (flags & BODY_HAS_BASELINE) {
+        quint8 baselineOffset = (quint8)(sequence - info.baselineSequence);
+        payload.append(reinterpret_cast<const char*>(&baselineOffset), sizeof(baselineOffset));
+    }
+    if (flags & BODY_POSITION_CHANGED) {
+        if (useBaseline) {
+            payload.append(reinterpret_cast<const char*>(positionDelta), sizeof(positionDelta));
+        } else {
+            for (int i = 0; i < 3; i++) {
+                // little endian, low three bytes
+                quint32 component = (quint32)state.position[i];
+                for (int byte = 0; byte < NUM_BYTES_FULL_POSITION_COMPONENT; byte++) {
+                    payload.append((char)((component >> (8 * byte)) & 0xff));
+                }
+            }
+        }
+    }
+    if (flags & BODY_ROTATION_CHANGED) {
+        payload.append(reinterpret_cast<const char*>(&state.rotation), sizeof(state.rotation));
+    }
+    if (flags & BODY_IS_MOVING) {
+        payload.append(reinterpret_cast<const char*>(state.velocity), sizeof(state.velocity));
+        payload.append(reinterpret_cast<const char*>(state.angularVelocity), sizeof(state.angularVelocity));
+    }
+}
+
+std::vector<QByteArray> EntityPhysicsStateBatchWriter::takePayloads(int maxPayloadBytes) {
+    std::vector<QByteArray> payloads;
+    QByteArray payload;
+    PhysicsBatchSequenceNumber sequence = 0;
+
+    QHash<QUuid, EntityPhysicsState>::const_iterator stateItr = _queuedStates.constBegin();
+    while (stateItr != _queuedStates.constEnd()) {
+        // this may reset and forget the batches sent so far, so look the handle up before we start a batch
+        HandleInfo& info = handleInfoFor(stateItr.key());
+        if (payload.isEmpty() || _sentBatches.empty() || payload.size() + MAX_BODY_BYTES > maxPayloadBytes) {
+            if (payload.size() > (int)sizeof(sequence)) {
+                payloads.push_back(payload);
+            }
+            sequence = _nextSequence++;
+            payload.clear();
+            payload.append(reinterpret_cast<const char*>(&sequence), sizeof(sequence));
+
+            SentBatch batch;
+            batch.sequence = sequence;
+            _sentBatches.push_back(batch);
+            while ((int)_sentBatches.size() > BASELINE_WINDOW) {
+                _sentBatches.pop_front();
+            }
+        }
+
+        SentBody body;
+        body.entityID = stateItr.key();
+        body.handle = info.handle;
+        body.state = QuantizedEntityPhysicsState::fromState(stateItr.value());
+        writeBody(payload, body.entityID, info, body.state, sequence);
+        _sentBatches.back().bodies.push_back(body);
+        ++stateItr;
+    }
+    if (payload.size() > (int)sizeof(sequence)) {
+        payloads.push_back(payload);
+    }
+
+    _queuedStates.clear();
+    return payloads;
+}
+
+void EntityPhysicsStateBatchWriter::processAckPayload(const QByteArray& payload) {
+    PhysicsBatchSequenceNumber sequence;
+    if (payload.size() < (int)sizeof(sequence)) {
+        return;
+    }
+    memcpy(&sequence, payload.constData(), sizeof(sequence));
+
+    QSet<PhysicsEntityHandle> undecodedHandles;
+    for (int offset = sizeof(sequence); offset + (int)sizeof(PhysicsEntityHandle) <= payload.size();
+            offset += sizeof(PhysicsEntityHandle)) {
+        PhysicsEntityHandle handle;
+        memcpy(&handle, payload.constData() + offset, sizeof(handle));
+        undecodedHandles.insert(handle);
+    }
+
+    for (std::deque<SentBatch>::iterator batchItr = _sentBatches.begin(); batchItr != _sentBatches.end(); ++batchItr) {
+        if (batchItr->sequence != sequence) {
+            continue;
+        }
+        // what the reader stored from this batch can now be used as a baseline
+        for (const SentBody& body : batchItr->bodies) {
+            QHash<QUuid, HandleInfo>::iterator handleItr = _handles.find(body.entityID);
+            if (handleItr == _handles.end() || handleItr->handle != body.handle) {
+                continue;
+            }
+            if (undecodedHandles.contains(body.handle)) {
+                // the reader has no binding or baseline for it that we can count on, start the body over
+                handleItr->isAcknowledged = false;
+                handleItr->hasBaseline = false;
+                continue;
+            }
+            handleItr->isAcknowledged = true;
+            if (!handleItr->hasBaseline || isNewerSequence(sequence, handleItr->baselineSequence)) {
+                handleItr->hasBaseline = true;
+                handleItr->baselineSequence = sequence;
+                handleItr->baseline = body.state;
+            }
+        }
+        _sentBatches.erase(batchItr);
+        return;
+    }
+}
+
+bool EntityPhysicsStateBatchReader::processPayload(const QByteArray& payload, std::vector<Update>& updates,
+                                                   QByteArray& ackPayload) {
+    const char* dataAt = payload.constData();
+    const char* end = dataAt + payload.size();
+    auto read = [&](void* destination, int bytes) -> bool {
+        if (end - dataAt < bytes) {
+            return false;
+        }
+        memcpy(destination, dataAt, bytes);
+        dataAt += bytes;
+        return true;
+    };
+
+    PhysicsBatchSequenceNumber sequence;
+    if (!read(&sequence, sizeof(sequence))) {
+        return false;
+    }
+    QByteArray undecodedHandles;
+
+    while (dataAt < end) {
+        PhysicsEntityHandle handle;
+        quint8 flags;
+        if (!read(&handle, sizeof(handle)) || !read(&flags, sizeof(flags))) {
+            return false;
+        }
+
+        // a body we can't place is still read through, the ones after it are fine
+        bool isDecodable = true;
+        HandleInfo* info = NULL;
+        if (flags & BODY_HAS_ENTITY_ID) {
+            char rfc4122[NUM_BYTES_RFC4122_UUID];
+            if (!read(rfc4122, NUM_BYTES_RFC4122_UUID)) {
+                return false;
+            }
+            QUuid entityID = QUuid::fromRfc4122(QByteArray::fromRawData(rfc4122, NUM_BYTES_RFC4122_UUID));
+            info = &_handles[handle];
+            if (info->entityID != entityID) {
+                if (!info->entityID.isNull() && isNewerSequence(info->boundSequence, sequence)) {
+                    // a late batch from before the handle was given to the entity that has it now
+                    info = NULL;
+                    isDecodable = false;
+                } else {
+                    *info = HandleInfo();
+                    info->entityID = entityID;
+                    info->boundSequence = sequence;
+                }
+            }
+        } else {
+            QHash<PhysicsEntityHandle, HandleInfo>::iterator handleItr = _handles.find(handle);
+            if (handleItr == _handles.end() || isNewerSequence(handleItr->boundSequence, sequence)) {
+                isDecodable = false;
+            } else {
+                info = &(*handleItr);
+            }
+        }
+
+        const QuantizedEntityPhysicsState* baseline = NULL;
+        if (flags & BODY_HAS_BASELINE) {
+            quint8 baselineOffset;
+            if (!read(&baselineOffset, sizeof(baselineOffset))) {
+                return false;
+            }
+            PhysicsBatchSequenceNumber baselineSequence = sequence - baselineOffset;
+            if (info) {
+                const BaselineSlot& slot = info->baselines[baselineSequence % EntityPhysicsStateBatchWriter::BASELINE_WINDOW];
+                if (slot.isValid && slot.sequence == baselineSequence) {
+                    baseline = &slot.state;
+                }
+            }
+            if (!baseline) {
+                isDecodable = false;
+            }
+        } else if (!(flags & BODY_POSITION_CHANGED) || !(flags & BODY_ROTATION_CHANGED)) {
+            // only a baseline lets a body leave things out
+            return false;
+        }
+
+        QuantizedEntityPhysicsState state;
+        if (baseline) {
+            state = *baseline;
+        }
+        if (flags & BODY_POSITION_CHANGED) {
+            if (flags & BODY_HAS_BASELINE) {
+                qint16 positionDelta[3];
+                if (!read(positionDelta, sizeof(positionDelta))) {
+                    return false;
+                }
+                for (int i = 0; i < 3; i++) {
+                    state.position[i] += positionDelta[i];
+                }
+            } else {
+                for (int i = 0; i < 3; i++) {
+                    quint8 bytes[NUM_BYTES_FULL_POSITION_COMPONENT];
+                    if (!read(bytes, NUM_BYTES_FULL_POSITION_COMPONENT)) {
+                        return false;
+                    }
+                    state.position[i] = (qint32)(bytes[0] | (bytes[1] << 8) | (bytes[2] << 16));
+                }
+            }
+        }
+        if ((flags & BODY_ROTATION_CHANGED) && !read(&state.rotation, sizeof(state.rotation))) {
+            return false;
+        }
+        if (flags & BODY_IS_MOVING) {
+            if (!read(state.velocity, sizeof(state.velocity))
+                    || !read(state.angularVelocity, sizeof(state.angularVelocity))) {
+                return false;
+            }
+        } else {
+            std::fill(state.velocity, state.velocity + 3, 0);
+            std::fill(state.angularVelocity, state.angularVelocity + 3, 0);
+        }
+        state.isBallistic = (flags & BODY_IS_BALLISTIC) != 0;
+        state.isReleasingOwnership = (flags & BODY_RELEASES_OWNERSHIP) != 0;
+
+        if (!isDecodable) {
+            undecodedHandles.append(reinterpret_cast<const char*>(&handle), sizeof(handle));
+            continue;
+        }
+
+        // keep it as a baseline, the writer will use it once our ack gets there
+        BaselineSlot& slot = info->baselines[sequence % EntityPhysicsStateBatchWriter::BASELINE_WINDOW];
+        slot.isValid = true;
+        slot.sequence = sequence;
+        slot.state = state;
+
+        if (!info->hasApplied || isNewerSequence(sequence, info->lastAppliedSequence)) {
+            info->hasApplied = true;
+            info->lastAppliedSequence = sequence;
+
+            Update update;
+            update.entityID = info->entityID;
+            update.state = state.toState();
+            updates.push_back(update);
+        }
+    }
+
+    ackPayload = QByteArray(reinterpret_cast<const char*>(&sequence), sizeof(sequence)) + undecodedHandles;
+    return true;
+}
@@ -0,0 +1,153 @@
+//
+//  EntityPhysicsStateBatch.h
+//  libraries/entities/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Compact, quantized physics updates for many entities per datagram, delta coded against what the server acked.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityPhysicsStateBatch_h
+#define hifi_EntityPhysicsStateBatch_h
+
+#include <deque>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QUuid>
+
+/// What a simulation owner tells the entity server about one body.
+class EntityPhysicsState {
+public:
+    EntityPhysicsState();
+
+    glm::vec3 position; // meters, domain frame
+    glm::quat rotation;
+    glm::vec3 velocity; // meters per second
+    glm::vec3 angularVelocity; // radians per second
+    bool isBallistic; // the body accelerates with its gravity
+    bool isReleasingOwnership; // the body came to rest and the owner lets go of it
+};
+
+/// An EntityPhysicsState as it goes over the wire. Positions have 1mm resolution over the whole domain, rotations are
+/// packed as their smallest three components, and velocities are 16 bit fixed point.
+class QuantizedEntityPhysicsState {
+public:
+    QuantizedEntityPhysicsState();
+
+    static QuantizedEntityPhysicsState fromState(const EntityPhysicsState& state);
+    EntityPhysicsState toState() const;
+
+    bool isMoving() const;
+
+    qint32 position[3];
+    quint32 rotation;
+    qint16 velocity[3];
+    qint16 angularVelocity[3];
+    bool isBallistic;
+    bool isReleasingOwnership;
+};
+
+typedef quint16 PhysicsBatchSequenceNumber;
+typedef quint16 PhysicsEntityHandle;
+
+/// Sending side, one per entity server we send to. States queued for the same entity before the next batch goes out
+/// replace each other, and a lost batch is never resent: the next state of each body supersedes it. The 16 byte
+/// entity ID is only sent until the server has acked a batch carrying it, after that a short handle stands in for it.
+class EntityPhysicsStateBatchWriter {
+public:
+    /// a body is only delta coded against a baseline this many batches old or newer, the reader keeps as many
+    static const int BASELINE_WINDOW = 32;
+
+    EntityPhysicsStateBatchWriter();
+
+    void queueState(const QUuid& entityID, const EntityPhysicsState& state);
+    bool hasQueuedStates() const { return !_queuedStates.empty(); }
+
+    /// Packs everything queued into batch payloads of at most maxPayloadBytes each.
+    std::vector<QByteArray> takePayloads(int maxPayloadBytes);
+
+    /// Bodies the reader decoded become baselines, the ones it couldn't are sent again with their ID and in full.
+    void processAckPayload(const QByteArray& payload);
+
+    /// forget handles and baselines, for when the server we send to changed
+    void reset();
+
+private:
+    class HandleInfo {
+    public:
+        PhysicsEntityHandle handle;
+        bool isAcknowledged;
+        bool hasBaseline;
+        PhysicsBatchSequenceNumber baselineSequence;
+        QuantizedEntityPhysicsState baseline;
+    };
+
+    class SentBody {
+    public:
+        QUuid entityID;
+        PhysicsEntityHandle handle;
+        QuantizedEntityPhysicsState state;
+    };
+
+    class SentBatch {
+    public:
+        PhysicsBatchSequenceNumber sequence;
+        std::vector<SentBody> bodies;
+    };
+
+    HandleInfo& handleInfoFor(const QUuid& entityID);
+    void writeBody(QByteArray& payload, const QUuid& entityID, HandleInfo& info,
+                   const QuantizedEntityPhysicsState& state, PhysicsBatchSequenceNumber sequence);
+
+    QHash<QUuid, EntityPhysicsState> _queuedStates;
+    QHash<QUuid, HandleInfo> _handles;
+    PhysicsEntityHandle _nextHandle;
+    PhysicsBatchSequenceNumber _nextSequence;
+    std::deque<SentBatch> _sentBatches; // the last BASELINE_WINDOW batches, oldest first
+};
+
+/// Receiving side, one per node that sends us batches.
+class EntityPhysicsStateBatchReader {
+public:
+    class Update {
+    public:
+        QUuid entityID;
+        EntityPhysicsState state;
+    };
+
+    /// Decodes a batch payload. Bodies that are older than one already applied for the same entity are left out.
+    /// Returns false if the payload is malformed, otherwise ackPayload is what goes back to the sender: the batch
+    /// sequence followed by the handles of the bodies we couldn't decode, so that only the others become baselines.
+    bool processPayload(const QByteArray& payload, std::vector<Update>& updates, QByteArray& ackPayload);
+
+private:
+    class BaselineSlot {
+    public:
+        BaselineSlot() : isValid(false), sequence(0) { }
+        bool isValid;
+        PhysicsBatchSequenceNumber sequence;
+        QuantizedEntityPhysicsState state;
+    };
+
+    class HandleInfo {
+    public:
+        HandleInfo() : boundSequence(0), hasApplied(false), lastAppliedSequence(0) { }
+        QUuid entityID;
+        PhysicsBatchSequenceNumber boundSequence; // bodies from before the handle was given to this entity are stale
+        bool hasApplied;
+        PhysicsBatchSequenceNumber lastAppliedSequence;
+        BaselineSlot baselines[EntityPhysicsStateBatchWriter::BASELINE_WINDOW];
+    };
+
+    QHash<PhysicsEntityHandle, HandleInfo> _handles;
+};
+
+#endif // hifi_EntityPhysicsStateBatch_h
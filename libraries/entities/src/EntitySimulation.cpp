@@ -9,6 +9,9 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <algorithm>
+#include <functional>
+
 #include <AACube.h>
 
 #include "EntitySimulation.h"
@@ -19,6 +22,7 @@ void EntitySimulation::setEntityTree(EntityTree* tree) {
     if (_entityTree && _entityTree != tree) {
         _mortalEntities.clear();
         _nextExpiry = quint64(-1);
+        _expiryHeap.clear();
         _entitiesToUpdate.clear();
         _entitiesToSort.clear();
         _simpleKinematicEntities.clear();
@@ -62,32 +66,57 @@ void EntitySimulation::changeEntityInternal(EntityItemPointer entity) {
 
 // protected
 void EntitySimulation::expireMortalEntities(const quint64& now) {
-    if (now > _nextExpiry) {
-        // only search for expired entities if we expect to find one
-        _nextExpiry = quint64(-1);
-        SetOfEntities::iterator itemItr = _mortalEntities.begin();
-        while (itemItr != _mortalEntities.end()) {
-            EntityItemPointer entity = *itemItr;
-            quint64 expiry = entity->getExpiry();
-            if (expiry < now) {
-                _entitiesToDelete.insert(entity);
-                itemItr = _mortalEntities.erase(itemItr);
-                _entitiesToUpdate.remove(entity);
-                _entitiesToSort.remove(entity);
-                _simpleKinematicEntities.remove(entity);
-                removeEntityInternal(entity);
-
-                _allEntities.remove(entity);
-                entity->_simulated = false;
-            } else {
-                if (expiry < _nextExpiry) {
-                    // remeber the smallest _nextExpiry so we know when to start the next search
-                    _nextExpiry = expiry;
-                }
-                ++itemItr;
-            }
+    while (!_expiryHeap.empty() && _expiryHeap.front().expiry < now) {
+        std::pop_heap(_expiryHeap.begin(), _expiryHeap.end(), std::greater<ExpiryEntry>());
+        ExpiryEntry entry = _expiryHeap.back();
+        _expiryHeap.pop_back();
+
+        EntityItemPointer entity = entry.entity.lock();
+        if (!entity || !_mortalEntities.contains(entity)) {
+            // this entity is gone or was made immortal since this entry was pushed
+            continue;
         }
+
+        quint64 expiry = entity->getExpiry();
+        if (expiry != entry.expiry) {
+            // the lifetime changed, there may be a newer entry for it but make sure it is scheduled again
+            ExpiryEntry newEntry = { expiry, entity };
+            _expiryHeap.push_back(newEntry);
+            std::push_heap(_expiryHeap.begin(), _expiryHeap.end(), std::greater<ExpiryEntry>());
+            continue;
+        }
+
+        _entitiesToDelete.insert(entity);
+        _mortalEntities.remove(entity);
+        _entitiesToUpdate.remove(entity);
+        _entitiesToSort.remove(entity);
+        _simpleKinematicEntities.remove(entity);
+        removeEntityInternal(entity);
+
+        _allEntities.remove(entity);
+        entity->_simulated = false;
+    }
+    _nextExpiry = _expiryHeap.empty() ? quint64(-1) : _expiryHeap.front().expiry;
+}
+
+void EntitySimulation::addMortalEntity(EntityItemPointer entity) {
+    _mortalEntities.insert(entity);
+
+    // skipped entries pile up when lifetimes change a lot, rebuild the heap once they outnumber the real ones
+    const size_t MIN_HEAP_SIZE_TO_REBUILD = 64;
+    if (_expiryHeap.size() > MIN_HEAP_SIZE_TO_REBUILD && _expiryHeap.size() > 2 * (size_t)_mortalEntities.size()) {
+        _expiryHeap.clear();
+        foreach (const EntityItemPointer& mortalEntity, _mortalEntities) {
+            ExpiryEntry entry = { mortalEntity->getExpiry(), mortalEntity };
+            _expiryHeap.push_back(entry);
+        }
+        std::make_heap(_expiryHeap.begin(), _expiryHeap.end(), std::greater<ExpiryEntry>());
+    } else {
+        ExpiryEntry entry = { entity->getExpiry(), entity };
+        _expiryHeap.push_back(entry);
+        std::push_heap(_expiryHeap.begin(), _expiryHeap.end(), std::greater<ExpiryEntry>());
     }
+    _nextExpiry = _expiryHeap.front().expiry;
 }
 
 // protected
@@ -132,13 +161,14 @@ void EntitySimulation::sortEntitiesThatMoved() {
 
             itemItr = _entitiesToSort.erase(itemItr);
         } else {
+            notifyEntityMoved(entity);
             moveOperator.addEntityToMoveList(entity, newCube);
             ++itemItr;
         }
     }
     if (moveOperator.hasMovingEntities()) {
-        PerformanceTimer perfTimer("recurseTreeWithOperator");
-        _entityTree->recurseTreeWithOperator(&moveOperator);
+        PerformanceTimer perfTimer("moveEntities");
+        moveOperator.moveEntities();
     }
 
     _entitiesToSort.clear();
@@ -147,11 +177,7 @@ void EntitySimulation::sortEntitiesThatMoved() {
 void EntitySimulation::addEntity(EntityItemPointer entity) {
     assert(entity);
     if (entity->isMortal()) {
-        _mortalEntities.insert(entity);
-        quint64 expiry = entity->getExpiry();
-        if (expiry < _nextExpiry) {
-            _nextExpiry = expiry;
-        }
+        addMortalEntity(entity);
     }
     if (entity->needsToCallUpdate()) {
         _entitiesToUpdate.insert(entity);
@@ -211,11 +237,7 @@ void EntitySimulation::changeEntity(EntityItemPointer entity) {
     if (!wasRemoved) {
         if (dirtyFlags & EntityItem::DIRTY_LIFETIME) {
             if (entity->isMortal()) {
-                _mortalEntities.insert(entity);
-                quint64 expiry = entity->getExpiry();
-                if (expiry < _nextExpiry) {
-                    _nextExpiry = expiry;
-                }
+                addMortalEntity(entity);
             } else {
                 _mortalEntities.remove(entity);
             }
@@ -233,6 +255,7 @@ void EntitySimulation::changeEntity(EntityItemPointer entity) {
 void EntitySimulation::clearEntities() {
     _mortalEntities.clear();
     _nextExpiry = quint64(-1);
+    _expiryHeap.clear();
     _entitiesToUpdate.clear();
     _entitiesToSort.clear();
     _simpleKinematicEntities.clear();
@@ -247,16 +270,77 @@ void EntitySimulation::clearEntities() {
 }
 
 void EntitySimulation::moveSimpleKinematics(const quint64& now) {
+    PerformanceTimer perfTimer("moveSimpleKinematics");
+    _kinematicBatch.clear();
+    _kinematicBatchEntities.clear();
+    _kinematicBatch.reserve(_simpleKinematicEntities.size());
+
     SetOfEntities::iterator itemItr = _simpleKinematicEntities.begin();
     while (itemItr != _simpleKinematicEntities.end()) {
         EntityItemPointer entity = *itemItr;
         if (entity->isMoving() && !entity->getPhysicsInfo()) {
-            entity->simulate(now);
-            _entitiesToSort.insert(entity);
+            if (entity->hasAngularVelocity()) {
+                // rotation is integrated in bullet sized substeps, leave these to the entity
+                entity->simulate(now);
+                entityMoved(entity);
+            } else {
+                if (entity->_lastSimulated == 0) {
+                    entity->_lastSimulated = now;
+                }
+                float timeElapsed = (float)(now - entity->_lastSimulated) / (float)(USECS_PER_SECOND);
+                _kinematicBatch.add(entity->getPosition(), entity->getVelocity(), entity->getAcceleration(),
+                                    entity->getDamping(), timeElapsed);
+                _kinematicBatchEntities.push_back(entity);
+            }
             ++itemItr;
         } else {
             // the entity is no longer non-physical-kinematic
             itemItr = _simpleKinematicEntities.erase(itemItr);
         }
     }
+
+    _kinematicBatch.integrate();
+
+    for (int i = 0; i < _kinematicBatch.size(); i++) {
+        EntityItemPointer entity = _kinematicBatchEntities[i];
+        if (_kinematicBatch.hasStopped(i)) {
+            entity->setVelocity(ENTITY_ITEM_ZERO_VEC3);
+            if (_kinematicBatch.getSpeed(i) > 0.0f) {
+                entity->_dirtyFlags |= EntityItem::DIRTY_MOTION_TYPE;
+            }
+        } else {
+            entity->setPosition(_kinematicBatch.getPosition(i));
+            entity->setVelocity(_kinematicBatch.getVelocity(i));
+        }
+        entity->_lastSimulated = now;
+        entityMoved(entity);
+    }
+}
+
+void EntitySimulation::entityMoved(EntityItemPointer entity) {
+    if (needsSortAfterMove(entity)) {
+        // announced when it's sorted
+        _entitiesToSort.insert(entity);
+    } else {
+        notifyEntityMoved(entity);
+    }
+}
+
+void EntitySimulation::notifyEntityMoved(EntityItemPointer entity) {
+    // the entity's element still holds its bounds from before the move, so the hooks hear about it leaving a region
+    // as well as entering one, even when it moved within its element
+    EntityTreeElement* element = entity->getElement();
+    if (element) {
+        _entityTree->notifyEntityBoundsChanged(element->getAACube());
+    }
+    _entityTree->notifyEntityBoundsChanged(entity->getMaximumAACube());
+}
+
+bool EntitySimulation::needsSortAfterMove(EntityItemPointer entity) const {
+    EntityTreeElement* element = entity->getElement();
+    AACube newCube = entity->getMaximumAACube();
+    AACube domainBounds(glm::vec3(0.0f, 0.0f, 0.0f), (float)TREE_SCALE);
+
+    // entities that left the domain go through the sort to be deleted, everything else only if it left its element
+    return !element || !domainBounds.touches(newCube) || !element->bestFitBounds(newCube.clamp(0.0f, (float)TREE_SCALE));
 }
@@ -12,15 +12,19 @@
 #ifndef hifi_EntitySimulation_h
 #define hifi_EntitySimulation_h
 
+#include <vector>
+
 #include <QtCore/QObject>
 #include <QSet>
 #include <QVector>
 
+#include <NumericalConstants.h>
 #include <PerfStat.h>
 
 #include "EntityActionInterface.h"
 #include "EntityItem.h"
 #include "EntityTree.h"
+#include "SimpleKinematicBatch.h"
 
 typedef QSet<EntityItemPointer> SetOfEntities;
 typedef QVector<EntityItemPointer> VectorOfEntities;
@@ -41,6 +45,9 @@ const int DIRTY_SIMULATION_FLAGS =
         EntityItem::DIRTY_MATERIAL |
         EntityItem::DIRTY_SIMULATOR_ID;
 
+// a simulation owner that is gone from the domain loses ownership once we haven't heard from it for this long
+const quint64 AUTO_REMOVE_SIMULATION_OWNER_USEC = 2 * USECS_PER_SECOND;
+
 class EntitySimulation : public QObject {
 Q_OBJECT
 public:
@@ -103,6 +110,19 @@ protected:
     void callUpdateOnEntitiesThatNeedIt(const quint64& now);
     void sortEntitiesThatMoved();
 
+    /// adds the entity to _mortalEntities and schedules its current expiry
+    void addMortalEntity(EntityItemPointer entity);
+
+    /// true if the entity's new bounds no longer best fit the tree element that holds it
+    bool needsSortAfterMove(EntityItemPointer entity) const;
+
+    /// queues an entity this simulation moved for sorting if it left its element, otherwise tells the tree's bounds
+    /// changed hooks about the move right away
+    void entityMoved(EntityItemPointer entity);
+
+    /// tells the tree's bounds changed hooks about an entity this simulation moved, before it's sorted
+    void notifyEntityMoved(EntityItemPointer entity);
+
     QMutex _mutex;
 
     // back pointer to EntityTree structure
@@ -113,11 +133,25 @@ protected:
     SetOfEntities _allEntities; // tracks all entities added the simulation
     SetOfEntities _mortalEntities; // entities that have an expiry
     quint64 _nextExpiry;
+
+    // min-heap of expiries, so expiring entities doesn't mean scanning all of _mortalEntities. Entries aren't removed
+    // when an entity stops being mortal or its lifetime changes, they are skipped when they come up instead.
+    class ExpiryEntry {
+    public:
+        quint64 expiry;
+        EntityItemWeakPointer entity;
+        bool operator>(const ExpiryEntry& other) const { return expiry > other.expiry; }
+    };
+    std::vector<ExpiryEntry> _expiryHeap;
     SetOfEntities _entitiesToUpdate; // entities that need to call EntityItem::update()
     SetOfEntities _entitiesToSort; // entities moved by simulation (and might need resort in EntityTree)
     SetOfEntities _entitiesToDelete; // entities simulation decided needed to be deleted (EntityTree will actually delete)
     SetOfEntities _simpleKinematicEntities; // entities undergoing non-colliding kinematic motion
 
+    // scratch space for moveSimpleKinematics, kept so it isn't reallocated every frame
+    SimpleKinematicBatch _kinematicBatch;
+    VectorOfEntities _kinematicBatchEntities;
+
  private:
     void moveSimpleKinematics();
 
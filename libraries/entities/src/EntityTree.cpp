@@ -48,6 +48,7 @@ EntityTreeElement* EntityTree::createNewElement(unsigned char * octalCode) {
 
 void EntityTree::eraseAllOctreeElements(bool createNewRoot) {
     emit clearingEntities();
+    notifyEntityBoundsChanged(AACube(glm::vec3(0.0f), (float)TREE_SCALE));
 
     // this would be a good place to clean up our entities...
     if (_simulation) {
@@ -84,6 +85,7 @@ void EntityTree::postAddEntity(EntityItemPointer entity) {
         _simulation->unlock();
     }
     _isDirty = true;
+    notifyEntityBoundsChanged(entity->getMaximumAACube());
     maybeNotifyNewCollisionSoundURL("", entity->getCollisionSoundURL());
     emit addingEntity(entity->getEntityItemID());
 }
@@ -190,6 +192,7 @@ bool EntityTree::updateEntityWithElement(EntityItemPointer entity, const EntityI
         UpdateEntityOperator theOperator(this, containingElement, entity, properties);
         recurseTreeWithOperator(&theOperator);
         _isDirty = true;
+        notifyEntityBoundsChanged(entity->getMaximumAACube());
 
         uint32_t newFlags = entity->getDirtyFlags() & ~preFlags;
         if (newFlags) {
@@ -371,6 +374,7 @@ void EntityTree::processRemovedEntities(const DeleteEntityOperator& theOperator)
     }
     foreach(const EntityToDeleteDetails& details, entities) {
         EntityItemPointer theEntity = details.entity;
+        notifyEntityBoundsChanged(details.cube);
 
         if (getIsServer()) {
             // set up the deleted entities ID
@@ -651,6 +655,31 @@ void EntityTree::removeNewlyCreatedHook(NewlyCreatedEntityHook* hook) {
     _newlyCreatedHooksLock.unlock();
 }
 
+void EntityTree::addBoundsChangedHook(EntityBoundsChangedHook* hook) {
+    _boundsChangedHooksLock.lockForWrite();
+    _boundsChangedHooks.push_back(hook);
+    _boundsChangedHooksLock.unlock();
+}
+
+void EntityTree::removeBoundsChangedHook(EntityBoundsChangedHook* hook) {
+    _boundsChangedHooksLock.lockForWrite();
+    for (int i = 0; i < _boundsChangedHooks.size(); i++) {
+        if (_boundsChangedHooks[i] == hook) {
+            _boundsChangedHooks.erase(_boundsChangedHooks.begin() + i);
+            break;
+        }
+    }
+    _boundsChangedHooksLock.unlock();
+}
+
+void EntityTree::notifyEntityBoundsChanged(const AACube& bounds) {
+    _boundsChangedHooksLock.lockForRead();
+    for (int i = 0; i < _boundsChangedHooks.size(); i++) {
+        _boundsChangedHooks[i]->entityBoundsChanged(bounds);
+    }
+    _boundsChangedHooksLock.unlock();
+}
+
 
 void EntityTree::releaseSceneEncodeData(OctreeElementExtraEncodeData* extraEncodeData) const {
     foreach(void* extraData, *extraEncodeData) {
@@ -661,6 +690,7 @@ void EntityTree::releaseSceneEncodeData(OctreeElementExtraEncodeData* extraEncod
 }
 
 void EntityTree::entityChanged(EntityItemPointer entity) {
+    notifyEntityBoundsChanged(entity->getMaximumAACube());
     if (_simulation) {
         _simulation->lock();
         _simulation->changeEntity(entity);
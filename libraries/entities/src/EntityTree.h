@@ -28,6 +28,13 @@ public:
     virtual void entityCreated(const EntityItem& newEntity, const SharedNodePointer& senderNode) = 0;
 };
 
+/// Told about every entity that is added, edited, moved or deleted, with the bounds it has (or had) in the tree.
+/// Called while the tree is locked for writing.
+class EntityBoundsChangedHook {
+public:
+    virtual void entityBoundsChanged(const AACube& bounds) = 0;
+};
+
 class EntityItemFBXService {
 public:
     virtual const FBXGeometry* getGeometryForEntity(EntityItemPointer entityItem) = 0;
@@ -127,6 +134,10 @@ public:
     void addNewlyCreatedHook(NewlyCreatedEntityHook* hook);
     void removeNewlyCreatedHook(NewlyCreatedEntityHook* hook);
 
+    void addBoundsChangedHook(EntityBoundsChangedHook* hook);
+    void removeBoundsChangedHook(EntityBoundsChangedHook* hook);
+    void notifyEntityBoundsChanged(const AACube& bounds);
+
     bool hasAnyDeletedEntities() const { return _recentlyDeletedEntityItemIDs.size() > 0; }
     bool hasEntitiesDeletedSince(quint64 sinceTime);
     bool encodeEntitiesDeletedSince(OCTREE_PACKET_SEQUENCE sequenceNumber, quint64& sinceTime,
@@ -192,6 +203,9 @@ private:
     QReadWriteLock _newlyCreatedHooksLock;
     QVector<NewlyCreatedEntityHook*> _newlyCreatedHooks;
 
+    QReadWriteLock _boundsChangedHooksLock;
+    QVector<EntityBoundsChangedHook*> _boundsChangedHooks;
+
     QReadWriteLock _recentlyDeletedEntitiesLock;
     QMultiMap<quint64, QUuid> _recentlyDeletedEntityItemIDs;
     EntityItemFBXService* _fbxService;
@@ -9,6 +9,8 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <algorithm>
+
 #include "EntityItem.h"
 #include "EntityTree.h"
 #include "EntityTreeElement.h"
@@ -108,6 +110,59 @@ void MovingEntitiesOperator::addEntityToMoveList(EntityItemPointer entity, const
     }
 }
 
+// Walks down from the root to the smallest existing element that contains both the element the entity is in now and
+// its new bounds. That is as high up the tree as this move reaches, nothing outside of it needs to be visited.
+OctreeElement* MovingEntitiesOperator::findSubTreeContainingMove(const EntityToMoveDetails& details,
+                                                                 QSet<OctreeElement*>& path) const {
+    OctreeElement* element = _tree->getRoot();
+    while (element) {
+        int childIndex = element->getMyChildContaining(details.newCubeClamped);
+        OctreeElement* child = (childIndex == OctreeElement::CHILD_UNKNOWN) ? NULL : element->getChildAtIndex(childIndex);
+        if (!child || !child->getAACube().contains(details.oldContainingElementCube)) {
+            break;
+        }
+        path << element;
+        element = child;
+    }
+    return element;
+}
+
+void MovingEntitiesOperator::moveEntities() {
+    if (_entitiesToMove.size() == 0) {
+        return;
+    }
+
+    // the elements above each subtree, they aren't walked but still need to be marked as changed
+    QSet<OctreeElement*> path;
+    QHash<OctreeElement*, QList<EntityToMoveDetails> > movesBySubTree;
+    foreach(const EntityToMoveDetails& details, _entitiesToMove) {
+        movesBySubTree[findSubTreeContainingMove(details, path)] << details;
+    }
+
+    // mark these now, a walk through a bigger subtree may prune some of them once they're empty
+    foreach(OctreeElement* element, path) {
+        element->markWithChangedTime();
+    }
+
+    // Do the smallest subtrees first, so a walk never prunes the root of a subtree that is still waiting for its own.
+    // Walks only prune empty leaves, and the old element of every mover that hasn't moved yet still holds it.
+    QList<OctreeElement*> subTrees = movesBySubTree.keys();
+    std::sort(subTrees.begin(), subTrees.end(), [](OctreeElement* a, OctreeElement* b) {
+        return a->getScale() < b->getScale();
+    });
+
+    foreach(OctreeElement* subTree, subTrees) {
+        MovingEntitiesOperator subTreeOperator(_tree);
+        foreach(const EntityToMoveDetails& details, movesBySubTree[subTree]) {
+            subTreeOperator._entitiesToMove << details;
+            subTreeOperator._lookingCount++;
+        }
+        _tree->recurseElementWithOperator(subTree, &subTreeOperator);
+        _foundOldCount += subTreeOperator._foundOldCount;
+        _foundNewCount += subTreeOperator._foundNewCount;
+    }
+}
+
 // does this entity tree element contain the old entity
 bool MovingEntitiesOperator::shouldRecurseSubTree(OctreeElement* element) {
     bool containsEntity = false;
@@ -38,6 +38,11 @@ public:
     ~MovingEntitiesOperator();
 
     void addEntityToMoveList(EntityItemPointer entity, const AACube& newCube);
+
+    /// Re-homes everything on the move list. Each mover is grouped under the smallest existing element that holds
+    /// both its old element and its new bounds, and only those subtrees are walked, each with just its own movers.
+    void moveEntities();
+
     virtual bool preRecursion(OctreeElement* element);
     virtual bool postRecursion(OctreeElement* element);
     virtual OctreeElement* possiblyCreateChildAt(OctreeElement* element, int childIndex);
@@ -50,6 +55,7 @@ private:
     int _foundNewCount;
     int _lookingCount;
     bool shouldRecurseSubTree(OctreeElement* element);
+    OctreeElement* findSubTreeContainingMove(const EntityToMoveDetails& details, QSet<OctreeElement*>& path) const;
     
     bool _wantDebug;
 };
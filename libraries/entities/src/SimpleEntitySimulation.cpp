@@ -15,8 +15,6 @@
 #include "SimpleEntitySimulation.h"
 #include "EntitiesLogging.h"
 
-const quint64 AUTO_REMOVE_SIMULATION_OWNER_USEC = 2 * USECS_PER_SECOND;
-
 void SimpleEntitySimulation::updateEntitiesInternal(const quint64& now) {
     // If an Entity has a simulation owner and we don't get an update for some amount of time,
     // clear the owner.  This guards against an interface failing to release the Entity when it
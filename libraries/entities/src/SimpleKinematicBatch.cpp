@@ -0,0 +1,69 @@
+//
+//  SimpleKinematicBatch.cpp
+//  libraries/entities/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <math.h>
+
+#include "SimpleKinematicBatch.h"
+
+void SimpleKinematicBatch::clear() {
+    _positions.clear();
+    _velocities.clear();
+    _accelerations.clear();
+    _dampings.clear();
+    _timesElapsed.clear();
+    _speeds.clear();
+}
+
+void SimpleKinematicBatch::reserve(int size) {
+    _positions.reserve(size);
+    _velocities.reserve(size);
+    _accelerations.reserve(size);
+    _dampings.reserve(size);
+    _timesElapsed.reserve(size);
+    _speeds.reserve(size);
+}
+
+int SimpleKinematicBatch::add(const glm::vec3& position, const glm::vec3& velocity, const glm::vec3& acceleration,
+                              float damping, float timeElapsed) {
+    _positions.push_back(position);
+    _velocities.push_back(velocity);
+    _accelerations.push_back(acceleration);
+    _dampings.push_back(damping);
+    _timesElapsed.push_back(timeElapsed);
+    _speeds.push_back(0.0f);
+    return (int)_positions.size() - 1;
+}
+
+void SimpleKinematicBatch::integrate() {
+    int count = size();
+
+    // damping first, the only part that needs a transcendental
+    for (int i = 0; i < count; i++) {
+        if (_dampings[i] > 0.0f) {
+            _velocities[i] *= powf(1.0f - _dampings[i], _timesElapsed[i]);
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        float timeElapsed = _timesElapsed[i];
+        glm::vec3 position = _positions[i] + _velocities[i] * timeElapsed;
+        glm::vec3 velocity = _velocities[i] + _accelerations[i] * timeElapsed;
+
+        float speed = glm::length(velocity);
+        _speeds[i] = speed;
+        if (speed < EPSILON_LINEAR_VELOCITY_LENGTH) {
+            // come to rest where we were
+            _velocities[i] = glm::vec3(0.0f);
+        } else {
+            _positions[i] = position;
+            _velocities[i] = velocity;
+        }
+    }
+}
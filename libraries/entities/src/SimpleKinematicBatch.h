@@ -0,0 +1,52 @@
+//
+//  SimpleKinematicBatch.h
+//  libraries/entities/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SimpleKinematicBatch_h
+#define hifi_SimpleKinematicBatch_h
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// below this speed (meters/second) a simple kinematic entity comes to rest
+const float EPSILON_LINEAR_VELOCITY_LENGTH = 0.001f; // 1mm/sec
+
+/// The linear motion of many simple kinematic entities kept as a structure of arrays, so that it can be integrated
+/// in one tight loop instead of one entity at a time. Integration matches EntityItem::simulateKinematicMotion().
+class SimpleKinematicBatch {
+public:
+    void clear();
+    void reserve(int size);
+
+    /// \return index of the added motion
+    int add(const glm::vec3& position, const glm::vec3& velocity, const glm::vec3& acceleration,
+            float damping, float timeElapsed);
+
+    void integrate();
+
+    int size() const { return (int)_positions.size(); }
+
+    const glm::vec3& getPosition(int index) const { return _positions[index]; }
+    const glm::vec3& getVelocity(int index) const { return _velocities[index]; }
+
+    /// true if the motion came to rest this step, in which case its position was left where it was
+    bool hasStopped(int index) const { return _speeds[index] < EPSILON_LINEAR_VELOCITY_LENGTH; }
+    float getSpeed(int index) const { return _speeds[index]; }
+
+private:
+    std::vector<glm::vec3> _positions;
+    std::vector<glm::vec3> _velocities;
+    std::vector<glm::vec3> _accelerations;
+    std::vector<float> _dampings;
+    std::vector<float> _timesElapsed;
+    std::vector<float> _speeds;
+};
+
+#endif // hifi_SimpleKinematicBatch_h
@@ -0,0 +1,728 @@
+//
+//  BakedGeometry.cpp
+//  libraries/fbx/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringList>
+
+#include "BakedGeometry.h"
+#include "ModelFormatLogging.h"
+
+static const char BAKED_GEOMETRY_MAGIC[] = "HFBAKED";
+
+// baked files are only ever read on machines with the same byte order as the one that wrote them
+static const quint32 BYTE_ORDER_MARK = 0x01020304;
+
+// the vertex and index arrays start on boundaries this far apart
+static const int ARRAY_ALIGNMENT = 16;
+
+class BakedGeometryWriter {
+public:
+
+    template<class T> void write(const T& value) { _data.append(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+    void writeBytes(const QByteArray& bytes);
+    void writeString(const QString& string) { writeBytes(string.toUtf8()); }
+    template<class T> void writeArray(const QVector<T>& values);
+
+    void writeTransform(const Transform& transform);
+    void writeTexture(const FBXTexture& texture);
+    void writeMaterial(const model::MaterialPointer& material);
+    void writePart(const FBXMeshPart& part);
+    void writeMesh(const FBXMesh& mesh);
+    void writeJoint(const FBXJoint& joint);
+    void writeGeometry(const FBXGeometry& geometry);
+
+    QByteArray& getData() { return _data; }
+
+private:
+
+    void align();
+
+    QByteArray _data;
+    QHash<model::Material*, int> _materialIndices;
+};
+
+void BakedGeometryWriter::writeBytes(const QByteArray& bytes) {
+    write<quint32>(bytes.size());
+    _data.append(bytes);
+}
+
+template<class T> void BakedGeometryWriter::writeArray(const QVector<T>& values) {
+    write<quint32>(values.size());
+    align();
+    _data.append(reinterpret_cast<const char*>(values.constData()), values.size() * sizeof(T));
+}
+
+void BakedGeometryWriter::align() {
+    int padding = (ARRAY_ALIGNMENT - _data.size() % ARRAY_ALIGNMENT) % ARRAY_ALIGNMENT;
+    _data.append(QByteArray(padding, 0));
+}
+
+void BakedGeometryWriter::writeTransform(const Transform& transform) {
+    write(transform.getTranslation());
+    write(transform.getRotation());
+    write(transform.getScale());
+}
+
+void BakedGeometryWriter::writeTexture(const FBXTexture& texture) {
+    writeString(texture.name);
+    writeBytes(texture.filename);
+    writeBytes(texture.content);
+    writeTransform(texture.transform);
+    write<qint32>(texture.texcoordSet);
+    writeString(texture.texcoordSetName);
+}
+
+void BakedGeometryWriter::writeMaterial(const model::MaterialPointer& material) {
+    // parts that shared a material before baking share one after
+    if (!material) {
+        write<qint32>(-1);
+        return;
+    }
+    int index = _materialIndices.value(material.get(), -1);
+    if (index != -1) {
+        write<qint32>(index);
+        return;
+    }
+    index = _materialIndices.size();
+    _materialIndices.insert(material.get(), index);
+    write<qint32>(index);
+    write(material->getEmissive());
+    write(material->getDiffuse());
+    write(material->getMetallic());
+    write(material->getGloss());
+    write(material->getOpacity());
+}
+
+void BakedGeometryWriter::writePart(const FBXMeshPart& part) {
+    writeArray(part.quadIndices);
+    writeArray(part.triangleIndices);
+    write<quint32>(part.lodTriangleIndices.size());
+    foreach (const QVector<int>& indices, part.lodTriangleIndices) {
+        writeArray(indices);
+    }
+    write(part.diffuseColor);
+    write(part.specularColor);
+    write(part.emissiveColor);
+    write(part.emissiveParams);
+    write(part.shininess);
+    write(part.opacity);
+    writeTexture(part.diffuseTexture);
+    writeTexture(part.normalTexture);
+    writeTexture(part.specularTexture);
+    writeTexture(part.emissiveTexture);
+    writeString(part.materialID);
+    writeMaterial(part._material);
+}
+
+void BakedGeometryWriter::writeMesh(const FBXMesh& mesh) {
+    write<quint32>(mesh.parts.size());
+    foreach (const FBXMeshPart& part, mesh.parts) {
+        writePart(part);
+    }
+    writeArray(mesh.vertices);
+    writeArray(mesh.normals);
+    writeArray(mesh.tangents);
+    writeArray(mesh.colors);
+    writeArray(mesh.texCoords);
+    writeArray(mesh.texCoords1);
+    writeArray(mesh.clusterIndices);
+    writeArray(mesh.clusterWeights);
+
+    write<quint32>(mesh.clusters.size());
+    foreach (const FBXCluster& cluster, mesh.clusters) {
+        write<qint32>(cluster.jointIndex);
+        write(cluster.inverseBindMatrix);
+    }
+    write(mesh.meshExtents.minimum);
+    write(mesh.meshExtents.maximum);
+    write(mesh.modelTransform);
+    write(mesh.isEye);
+
+    write<quint32>(mesh.blendshapes.size());
+    foreach (const FBXBlendshape& blendshape, mesh.blendshapes) {
+        writeArray(blendshape.indices);
+        writeArray(blendshape.vertices);
+        writeArray(blendshape.normals);
+    }
+    writeArray(mesh.lodErrors);
+    write<quint32>(mesh.meshIndex);
+#if USE_MODEL_MESH
+    write<bool>(mesh._mesh.getNumVertices() > 0);
+#else
+    write<bool>(false);
+#endif
+}
+
+void BakedGeometryWriter::writeJoint(const FBXJoint& joint) {
+    write(joint.isFree);
+    writeArray(joint.freeLineage);
+    write<qint32>(joint.parentIndex);
+    write(joint.distanceToParent);
+    write(joint.boneRadius);
+    write(joint.translation);
+    write(joint.preTransform);
+    write(joint.preRotation);
+    write(joint.rotation);
+    write(joint.postRotation);
+    write(joint.postTransform);
+    write(joint.transform);
+    write(joint.rotationMin);
+    write(joint.rotationMax);
+    write(joint.inverseDefaultRotation);
+    write(joint.inverseBindRotation);
+    write(joint.bindTransform);
+    writeString(joint.name);
+    write(joint.shapePosition);
+    write(joint.shapeRotation);
+    write(joint.shapeType);
+    write(joint.isSkeletonJoint);
+}
+
+void BakedGeometryWriter::writeGeometry(const FBXGeometry& geometry) {
+    writeString(geometry.author);
+    writeString(geometry.applicationName);
+
+    write<quint32>(geometry.joints.size());
+    foreach (const FBXJoint& joint, geometry.joints) {
+        writeJoint(joint);
+    }
+    write<quint32>(geometry.jointIndices.size());
+    for (QHash<QString, int>::const_iterator it = geometry.jointIndices.constBegin();
+            it != geometry.jointIndices.constEnd(); it++) {
+        writeString(it.key());
+        write<qint32>(it.value());
+    }
+    write(geometry.hasSkeletonJoints);
+
+    write<quint32>(geometry.meshes.size());
+    foreach (const FBXMesh& mesh, geometry.meshes) {
+        writeMesh(mesh);
+    }
+    write(geometry.offset);
+
+    write<qint32>(geometry.leftEyeJointIndex);
+    write<qint32>(geometry.rightEyeJointIndex);
+    write<qint32>(geometry.neckJointIndex);
+    write<qint32>(geometry.rootJointIndex);
+    write<qint32>(geometry.leanJointIndex);
+    write<qint32>(geometry.headJointIndex);
+    write<qint32>(geometry.leftHandJointIndex);
+    write<qint32>(geometry.rightHandJointIndex);
+    write<qint32>(geometry.leftToeJointIndex);
+    write<qint32>(geometry.rightToeJointIndex);
+    writeArray(geometry.humanIKJointIndices);
+
+    write(geometry.palmDirection);
+
+    write<quint32>(geometry.sittingPoints.size());
+    foreach (const SittingPoint& sittingPoint, geometry.sittingPoints) {
+        writeString(sittingPoint.name);
+        write(sittingPoint.position);
+        write(sittingPoint.rotation);
+    }
+    write(geometry.neckPivot);
+
+    write(geometry.bindExtents.minimum);
+    write(geometry.bindExtents.maximum);
+    write(geometry.meshExtents.minimum);
+    write(geometry.meshExtents.maximum);
+
+    write<quint32>(geometry.animationFrames.size());
+    foreach (const FBXAnimationFrame& frame, geometry.animationFrames) {
+        writeArray(frame.rotations);
+    }
+
+    write<quint32>(geometry.meshIndicesToModelNames.size());
+    for (QHash<int, QString>::const_iterator it = geometry.meshIndicesToModelNames.constBegin();
+            it != geometry.meshIndicesToModelNames.constEnd(); it++) {
+        write<qint32>(it.key());
+        writeString(it.value());
+    }
+    write<quint32>(geometry.blendshapeChannelNames.size());
+    foreach (const QString& name, geometry.blendshapeChannelNames) {
+        writeString(name);
+    }
+}
+
+QByteArray writeBakedGeometry(const FBXGeometry& geometry) {
+    BakedGeometryWriter writer;
+    writer.getData().append(BAKED_GEOMETRY_MAGIC, sizeof(BAKED_GEOMETRY_MAGIC));
+    writer.write(BAKED_GEOMETRY_VERSION);
+    writer.write(FBX_READER_VERSION);
+    writer.write(BYTE_ORDER_MARK);
+    writer.write<quint64>(0); // total size, filled in below
+    writer.writeGeometry(geometry);
+
+    QByteArray& data = writer.getData();
+    quint64 size = data.size();
+    memcpy(data.data() + sizeof(BAKED_GEOMETRY_MAGIC) + sizeof(quint32) * 3, &size, sizeof(quint64));
+    return data;
+}
+
+class BakedGeometryReader {
+public:
+
+    BakedGeometryReader(const char* data, qint64 size, qint64 position);
+
+    template<class T> T read();
+
+    QByteArray readBytes();
+    QString readString() { return QString::fromUtf8(readBytes()); }
+    template<class T> void readArray(QVector<T>& values);
+
+    Transform readTransform();
+    void readTexture(FBXTexture& texture);
+    model::MaterialPointer readMaterial();
+    void readPart(FBXMeshPart& part);
+    void readMesh(FBXMesh& mesh);
+    void readJoint(FBXJoint& joint);
+    void readGeometry(FBXGeometry& geometry);
+
+private:
+
+    void require(quint64 length) const;
+    void align();
+
+    const char* _data;
+    qint64 _size;
+    qint64 _position;
+    QVector<model::MaterialPointer> _materials;
+};
+
+// a stale or corrupt file has to fail to load here, rather than send whatever uses the geometry out of bounds
+static void checkIndex(int index, int minimum, int end) {
+    if (index < minimum || index >= end) {
+        throw QString("Baked geometry has an index out of range.");
+    }
+}
+
+static void checkIndices(const QVector<int>& indices, int minimum, int end) {
+    foreach (int index, indices) {
+        checkIndex(index, minimum, end);
+    }
+}
+
+static void checkFaces(const QVector<int>& indices, int indicesPerFace, int vertexCount) {
+    if (indices.size() % indicesPerFace != 0) {
+        throw QString("Baked geometry has a partial face.");
+    }
+    checkIndices(indices, 0, vertexCount);
+}
+
+BakedGeometryReader::BakedGeometryReader(const char* data, qint64 size, qint64 position) :
+    _data(data),
+    _size(size),
+    _position(position) {
+}
+
+void BakedGeometryReader::require(quint64 length) const {
+    if (length > (quint64)(_size - _position)) {
+        throw QString("Unexpected end of baked geometry.");
+    }
+}
+
+void BakedGeometryReader::align() {
+    _position += (ARRAY_ALIGNMENT - _position % ARRAY_ALIGNMENT) % ARRAY_ALIGNMENT;
+}
+
+template<class T> T BakedGeometryReader::read() {
+    require(sizeof(T));
+    T value;
+    memcpy(&value, _data + _position, sizeof(T));
+    _position += sizeof(T);
+    return value;
+}
+
+template<> bool BakedGeometryReader::read() {
+    return read<quint8>() != 0;
+}
+
+QByteArray BakedGeometryReader::readBytes() {
+    quint32 length = read<quint32>();
+    require(length);
+    QByteArray bytes(_data + _position, length);
+    _position += length;
+    return bytes;
+}
+
+template<class T> void BakedGeometryReader::readArray(QVector<T>& values) {
+    quint32 count = read<quint32>();
+    align();
+    quint64 length = (quint64)count * sizeof(T);
+    require(length);
+    values.resize(count);
+    memcpy(values.data(), _data + _position, length);
+    _position += length;
+}
+
+Transform BakedGeometryReader::readTransform() {
+    Transform transform;
+    transform.setTranslation(read<glm::vec3>());
+    transform.setRotation(read<glm::quat>());
+    transform.setScale(read<glm::vec3>());
+    return transform;
+}
+
+void BakedGeometryReader::readTexture(FBXTexture& texture) {
+    texture.name = readString();
+    texture.filename = readBytes();
+    texture.content = readBytes();
+    texture.transform = readTransform();
+    texture.texcoordSet = read<qint32>();
+    texture.texcoordSetName = readString();
+}
+
+model::MaterialPointer BakedGeometryReader::readMaterial() {
+    int index = read<qint32>();
+    if (index == -1) {
+        return model::MaterialPointer();
+    }
+    if (index < _materials.size()) {
+        return _materials.at(index);
+    }
+    if (index != _materials.size()) {
+        throw QString("Invalid baked material.");
+    }
+    model::MaterialPointer material(new model::Material());
+    material->setEmissive(read<glm::vec3>());
+    material->setDiffuse(read<glm::vec3>());
+    material->setMetallic(read<float>());
+    material->setGloss(read<float>());
+    material->setOpacity(read<float>());
+    _materials.append(material);
+    return material;
+}
+
+void BakedGeometryReader::readPart(FBXMeshPart& part) {
+    readArray(part.quadIndices);
+    readArray(part.triangleIndices);
+    for (quint32 i = 0, count = read<quint32>(); i < count; i++) {
+        part.lodTriangleIndices.append(QVector<int>());
+        readArray(part.lodTriangleIndices.last());
+    }
+    part.diffuseColor = read<glm::vec3>();
+    part.specularColor = read<glm::vec3>();
+    part.emissiveColor = read<glm::vec3>();
+    part.emissiveParams = read<glm::vec2>();
+    part.shininess = read<float>();
+    part.opacity = read<float>();
+    readTexture(part.diffuseTexture);
+    readTexture(part.normalTexture);
+    readTexture(part.specularTexture);
+    readTexture(part.emissiveTexture);
+    part.materialID = readString();
+    part._material = readMaterial();
+}
+
+void BakedGeometryReader::readMesh(FBXMesh& mesh) {
+    // counts are appended to one at a time rather than trusted with a resize
+    for (quint32 i = 0, count = read<quint32>(); i < count; i++) {
+        mesh.parts.append(FBXMeshPart());
+        readPart(mesh.parts.last());
+    }
+    readArray(mesh.vertices);
+    readArray(mesh.normals);
+    readArray(mesh.tangents);
+    readArray(mesh.colors);
+    readArray(mesh.texCoords);
+    readArray(mesh.texCoords1);
+    readArray(mesh.clusterIndices);
+    readArray(mesh.clusterWeights);
+
+    for (quint32 i = 0, count = read<quint32>(); i < count; i++) {
+        FBXCluster cluster;
+        cluster.jointIndex = read<qint32>();
+        cluster.inverseBindMatrix = read<glm::mat4>();
+        mesh.clusters.append(cluster);
+    }
+    mesh.meshExtents.minimum = read<glm::vec3>();
+    mesh.meshExtents.maximum = read<glm::vec3>();
+    mesh.modelTransform = read<glm::mat4>();
+    mesh.isEye = read<bool>();
+
+    for (quint32 i = 0, count = read<quint32>(); i < count; i++) {
+        mesh.blendshapes.append(FBXBlendshape());
+        FBXBlendshape& blendshape = mesh.blendshapes.last();
+        readArray(blendshape.indices);
+        readArray(blendshape.vertices);
+        readArray(blendshape.normals);
+    }
+    readArray(mesh.lodErrors);
+    mesh.meshIndex = read<quint32>();
+
+    const int INDICES_PER_QUAD = 4;
+    const int INDICES_PER_TRIANGLE = 3;
+    int vertexCount = mesh.vertices.size();
+    foreach (const FBXMeshPart& part, mesh.parts) {
+        checkFaces(part.quadIndices, INDICES_PER_QUAD, vertexCount);
+        checkFaces(part.triangleIndices, INDICES_PER_TRIANGLE, vertexCount);
+        if (part.lodTriangleIndices.size() != mesh.lodErrors.size()) {
+            throw QString("Baked geometry has a part missing levels of detail.");
+        }
+        foreach (const QVector<int>& indices, part.lodTriangleIndices) {
+            checkFaces(indices, INDICES_PER_TRIANGLE, vertexCount);
+        }
+    }
+    foreach (const FBXBlendshape& blendshape, mesh.blendshapes) {
+        if (blendshape.vertices.size() != blendshape.indices.size() ||
+                blendshape.normals.size() != blendshape.indices.size()) {
+            throw QString("Baked geometry has a mismatched blendshape.");
+        }
+        checkIndices(blendshape.indices, 0, vertexCount);
+    }
+
+    bool hasModelMesh = read<bool>();
+#if USE_MODEL_MESH
+    if (hasModelMesh) {
+        buildModelMesh(mesh);
+    }
+#else
+    Q_UNUSED(hasModelMesh);
+#endif
+}
+
+void BakedGeometryReader::readJoint(FBXJoint& joint) {
+    joint.isFree = read<bool>();
+    readArray(joint.freeLineage);
+    joint.parentIndex = read<qint32>();
+    joint.distanceToParent = read<float>();
+    joint.boneRadius = read<float>();
+    joint.translation = read<glm::vec3>();
+    joint.preTransform = read<glm::mat4>();
+    joint.preRotation = read<glm::quat>();
+    joint.rotation = read<glm::quat>();
+    joint.postRotation = read<glm::quat>();
+    joint.postTransform = read<glm::mat4>();
+    joint.transform = read<glm::mat4>();
+    joint.rotationMin = read<glm::vec3>();
+    joint.rotationMax = read<glm::vec3>();
+    joint.inverseDefaultRotation = read<glm::quat>();
+    joint.inverseBindRotation = read<glm::quat>();
+    joint.bindTransform = read<glm::mat4>();
+    joint.name = readString();
+    joint.shapePosition = read<glm::vec3>();
+    joint.shapeRotation = read<glm::quat>();
+    joint.shapeType = read<quint8>();
+    joint.isSkeletonJoint = read<bool>();
+}
+
+void BakedGeometryReader::readGeometry(FBXGeometry& geometry) {
+    geometry.author = readString();
+    geometry.applicationName = readString();
+
+    for (quint32 i = 0, count = read<quint32>(); i < count; i++) {
+        geometry.joints.append(FBXJoint());
+        readJoint(geometry.joints.last());
+    }
+    int jointCount = geometry.joints.size();
+    foreach (const FBXJoint& joint, geometry.joints) {
+        checkIndex(joint.parentIndex, -1, jointCount);
+        checkIndices(joint.freeLineage, 0, jointCount);
+    }
+    for (quint32 i = 0, count = read<quint32>(); i < count; i++) {
+        // these are one more than the joint's index, so that a missing name gives -1
+        QString name = readString();
+        int index = read<qint32>();
+        checkIndex(index, 1, jointCount + 1);
+        geometry.jointIndices.insert(name, index);
+    }
+    geometry.hasSkeletonJoints = read<bool>();
+
+    for (quint32 i = 0, count = read<quint32>(); i < count; i++) {
+        geometry.meshes.append(FBXMesh());
+        FBXMesh& mesh = geometry.meshes.last();
+        readMesh(mesh);
+        foreach (const FBXCluster& cluster, mesh.clusters) {
+            checkIndex(cluster.jointIndex, 0, jointCount);
+        }
+    }
+    geometry.offset = read<glm::mat4>();
+
+    geometry.leftEyeJointIndex = read<qint32>();
+    geometry.rightEyeJointIndex = read<qint32>();
+    geometry.neckJointIndex = read<qint32>();
+    geometry.rootJointIndex = read<qint32>();
+    geometry.leanJointIndex = read<qint32>();
+    geometry.headJointIndex = read<qint32>();
+    geometry.leftHandJointIndex = read<qint32>();
+    geometry.rightHandJointIndex = read<qint32>();
+    geometry.leftToeJointIndex = read<qint32>();
+    geometry.rightToeJointIndex = read<qint32>();
+    const int namedJointIndices[] = { geometry.leftEyeJointIndex, geometry.rightEyeJointIndex,
+        geometry.neckJointIndex, geometry.rootJointIndex, geometry.leanJointIndex, geometry.headJointIndex,
+        geometry.leftHandJointIndex, geometry.rightHandJointIndex, geometry.leftToeJointIndex,
+        geometry.rightToeJointIndex };
+    for (int index : namedJointIndices) {
+        checkIndex(index, -1, jointCount);
+    }
+    readArray(geometry.humanIKJointIndices);
+    checkIndices(geometry.humanIKJointIndices, -1, jointCount);
+
+    geometry.palmDirection = read<glm::vec3>();
+
+    for (quint32 i = 0, count = read<quint32>(); i < count; i++) {
+        SittingPoint sittingPoint;
+        sittingPoint.name = readString();
+        sittingPoint.position = read<glm::vec3>();
+        sittingPoint.rotation = read<glm::quat>();
+        geometry.sittingPoints.append(sittingPoint);
+    }
+    geometry.neckPivot = read<glm::vec3>();
+
+    geometry.bindExtents.minimum = read<glm::vec3>();
+    geometry.bindExtents.maximum = read<glm::vec3>();
+    geometry.meshExtents.minimum = read<glm::vec3>();
+    geometry.meshExtents.maximum = read<glm::vec3>();
+
+    for (quint32 i = 0, count = read<quint32>(); i < count; i++) {
+        geometry.animationFrames.append(FBXAnimationFrame());
+        readArray(geometry.animationFrames.last().rotations);
+    }
+
+    for (quint32 i = 0, count = read<quint32>(); i < count; i++) {
+        int meshIndex = read<qint32>();
+        geometry.meshIndicesToModelNames.insert(meshIndex, readString());
+    }
+    for (quint32 i = 0, count = read<quint32>(); i < count; i++) {
+        geometry.blendshapeChannelNames.append(readString());
+    }
+}
+
+FBXGeometry readBakedGeometry(const char* data, qint64 size) {
+    const qint64 HEADER_SIZE = sizeof(BAKED_GEOMETRY_MAGIC) + sizeof(quint32) * 3 + sizeof(quint64);
+    if (size < HEADER_SIZE || memcmp(data, BAKED_GEOMETRY_MAGIC, sizeof(BAKED_GEOMETRY_MAGIC)) != 0) {
+        throw QString("Not baked geometry.");
+    }
+    BakedGeometryReader reader(data, size, sizeof(BAKED_GEOMETRY_MAGIC));
+    if (reader.read<quint32>() != BAKED_GEOMETRY_VERSION) {
+        throw QString("Baked geometry is from another version.");
+    }
+    if (reader.read<quint32>() != FBX_READER_VERSION) {
+        throw QString("Baked geometry was read by another version of the FBX reader.");
+    }
+    if (reader.read<quint32>() != BYTE_ORDER_MARK) {
+        throw QString("Baked geometry is from a machine with another byte order.");
+    }
+    if (reader.read<quint64>() != (quint64)size) {
+        throw QString("Baked geometry is truncated.");
+    }
+    FBXGeometry geometry;
+    reader.readGeometry(geometry);
+    return geometry;
+}
+
+QString BakedGeometryCache::getDefaultDirectory() {
+    // not under the application's own location, so that the client finds what the baker tool wrote
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "/High Fidelity/baked-geometry";
+}
+
+const QString BAKED_GEOMETRY_SUFFIX = ".baked";
+
+BakedGeometryCache::BakedGeometryCache(const QString& directory, qint64 maximumSize) :
+    _directory(directory),
+    _files(BoundedFileCache::getCache(directory, BAKED_GEOMETRY_SUFFIX, maximumSize)) {
+}
+
+static void addToHash(QCryptographicHash& hash, const QVariant& value) {
+    // hashes are iterated in a different order in each process, so their keys are sorted
+    hash.addData(QByteArray::number(value.userType()));
+    if (value.type() == QVariant::Hash) {
+        QVariantHash values = value.toHash();
+        QStringList keys = values.keys();
+        keys.sort();
+        foreach (const QString& key, keys) {
+            hash.addData(key.toUtf8());
+            addToHash(hash, values.value(key));
+        }
+    } else if (value.type() == QVariant::List) {
+        foreach (const QVariant& element, value.toList()) {
+            addToHash(hash, element);
+        }
+    } else {
+        QByteArray bytes = value.toString().toUtf8();
+        hash.addData(QByteArray::number(bytes.size()));
+        hash.addData(bytes);
+    }
+}
+
+QByteArray BakedGeometryCache::getKey(const QByteArray& model, const QVariantHash& mapping, bool loadLightmaps,
+                                      float lightmapLevel) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(BAKED_GEOMETRY_VERSION));
+    hash.addData(QByteArray::number(FBX_READER_VERSION));
+    hash.addData(model);
+    addToHash(hash, mapping);
+    hash.addData(QByteArray::number(loadLightmaps));
+    hash.addData(QByteArray::number(lightmapLevel));
+    return hash.result();
+}
+
+QString BakedGeometryCache::getFileName(const QByteArray& key) {
+    return key.toHex() + BAKED_GEOMETRY_SUFFIX;
+}
+
+QString BakedGeometryCache::getFilePath(const QByteArray& key) const {
+    return _directory + "/" + getFileName(key);
+}
+
+bool BakedGeometryCache::load(const QByteArray& key, FBXGeometry& geometry) const {
+    QFile file(getFilePath(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QByteArray data;
+    const char* begin = NULL;
+    uchar* mapped = file.map(0, file.size());
+    if (mapped) {
+        begin = reinterpret_cast<const char*>(mapped);
+    } else {
+        data = file.readAll();
+        begin = data.constData();
+    }
+    bool loaded = true;
+    try {
+        geometry = readBakedGeometry(begin, file.size());
+
+    } catch (const QString& error) {
+        qCDebug(modelformat) << "Discarding baked geometry" << file.fileName() << ":" << error;
+        loaded = false;
+    }
+    if (mapped) {
+        file.unmap(mapped);
+    }
+    file.close();
+    if (loaded) {
+        _files->touch(getFileName(key));
+    } else {
+        _files->remove(getFileName(key));
+    }
+    return loaded;
+}
+
+bool BakedGeometryCache::save(const QByteArray& key, const FBXGeometry& geometry) const {
+    if (!QDir().mkpath(_directory)) {
+        qCDebug(modelformat) << "Couldn't create baked geometry directory" << _directory;
+        return false;
+    }
+    // written to the side and renamed into place, so that nothing ever maps half a file
+    QSaveFile file(getFilePath(key));
+    QByteArray baked = writeBakedGeometry(geometry);
+    if (!file.open(QIODevice::WriteOnly) || file.write(baked) == -1 || !file.commit()) {
+        qCDebug(modelformat) << "Couldn't write baked geometry" << file.fileName() << ":" << file.errorString();
+        return false;
+    }
+    _files->insert(getFileName(key), baked.size());
+    return true;
+}
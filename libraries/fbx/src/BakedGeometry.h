@@ -0,0 +1,75 @@
+//
+//  BakedGeometry.h
+//  libraries/fbx/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  A binary form of FBXGeometry that loads without any of the processing done when reading FBX.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BakedGeometry_h
+#define hifi_BakedGeometry_h
+
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QString>
+#include <QVariantHash>
+
+#include <BoundedFileCache.h>
+
+#include "FBXReader.h"
+
+/// Bump this whenever what's written changes, so that existing baked files are ignored and rebaked. Changes to what
+/// readFBX produces are covered by FBX_READER_VERSION, which is written alongside it.
+const quint32 BAKED_GEOMETRY_VERSION = 3;
+
+const qint64 DEFAULT_MAXIMUM_BAKED_GEOMETRY_CACHE_SIZE = 2LL * 1024 * 1024 * 1024;
+
+/// Writes the geometry with its vertex and index arrays stored exactly as they are in memory, each aligned so that the
+/// file can be mapped and the arrays copied straight into their buffers.
+QByteArray writeBakedGeometry(const FBXGeometry& geometry);
+
+/// Reads geometry written by writeBakedGeometry, e.g. out of a mapped file, and builds its model meshes.
+/// \exception QString if the data is truncated, corrupt, indexes out of range or is from another version
+FBXGeometry readBakedGeometry(const char* data, qint64 size);
+
+/// A directory of baked geometry, named by a hash of the FBX it was read from along with everything else that went
+/// into reading it. Shared by the client and the baker tool. Once it grows past its maximum size, the least recently
+/// used geometry is removed.
+class BakedGeometryCache {
+public:
+
+    static QString getDefaultDirectory();
+
+    /// The maximum size only applies if this is the first cache of the directory in the process.
+    BakedGeometryCache(const QString& directory = getDefaultDirectory(),
+                       qint64 maximumSize = DEFAULT_MAXIMUM_BAKED_GEOMETRY_CACHE_SIZE);
+
+    const QString& getDirectory() const { return _directory; }
+
+    /// Returns the key for geometry read with readFBX from the given model and arguments.
+    static QByteArray getKey(const QByteArray& model, const QVariantHash& mapping, bool loadLightmaps = true,
+                             float lightmapLevel = 1.0f);
+
+    /// Loads the geometry baked under key, if there is any. Baked files that can't be read are removed.
+    bool load(const QByteArray& key, FBXGeometry& geometry) const;
+
+    /// Bakes the geometry under key, replacing whatever was there.
+    bool save(const QByteArray& key, const FBXGeometry& geometry) const;
+
+    QString getFilePath(const QByteArray& key) const;
+
+    const QSharedPointer<BoundedFileCache>& getFiles() const { return _files; }
+
+private:
+
+    static QString getFileName(const QByteArray& key);
+
+    QString _directory;
+    QSharedPointer<BoundedFileCache> _files;
+};
+
+#endif // hifi_BakedGeometry_h
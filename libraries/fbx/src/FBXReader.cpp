@@ -9,9 +9,11 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <QBuffer>
-#include <QDataStream>
+#include <QFile>
 #include <QIODevice>
 #include <QStringList>
 #include <QTextStream>
@@ -184,154 +186,215 @@ static int fbxGeometryMetaTypeId = qRegisterMetaType<FBXGeometry>();
 static int fbxAnimationFrameMetaTypeId = qRegisterMetaType<FBXAnimationFrame>();
 static int fbxAnimationFrameVectorMetaTypeId = qRegisterMetaType<QVector<FBXAnimationFrame> >();
 
-template<class T> int streamSize() {
-    return sizeof(T);
+// see http://code.blender.org/index.php/2013/08/fbx-binary-file-format-specification/ for an explanation
+// of the FBX binary format
+
+/// Parses binary FBX straight out of a contiguous buffer, such as a memory mapped file.
+class BinaryFBXParser {
+public:
+
+    BinaryFBXParser(const char* data, qint64 size, qint64 position);
+
+    /// Nodes whose names aren't in wantedNames are skipped over without being decoded, and come back with only their
+    /// names. All nodes are decoded if wantedNames is empty.
+    FBXNode parseNode(const QList<QByteArray>& wantedNames = QList<QByteArray>());
+
+    bool atEnd() const { return _position >= _size; }
+
+    void setWideOffsets(bool wideOffsets) { _wideOffsets = wideOffsets; }
+
+private:
+
+    void require(quint64 length) const;
+    template<class T> T read();
+    template<class T> QVariant readArray();
+    QVariant parseProperty();
+
+    const char* _data;
+    qint64 _size;
+    qint64 _position;
+    bool _wideOffsets; // FBX 7.5 and later use 64 bit offsets and counts in the node records
+
+    QByteArray _compressed; // reused by every compressed array
+};
+
+BinaryFBXParser::BinaryFBXParser(const char* data, qint64 size, qint64 position) :
+    _data(data),
+    _size(size),
+    _position(position),
+    _wideOffsets(false) {
 }
 
-template<bool> int streamSize() {
-    return 1;
+void BinaryFBXParser::require(quint64 length) const {
+    if (length > (quint64)(_size - _position)) {
+        throw QString("Unexpected end of FBX data.");
+    }
 }
 
-template<class T> QVariant readBinaryArray(QDataStream& in, int& position) {
-    quint32 arrayLength;
-    quint32 encoding;
-    quint32 compressedLength;
+template<class T> T fromLittleEndian(T value) {
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    char* bytes = reinterpret_cast<char*>(&value);
+    std::reverse(bytes, bytes + sizeof(T));
+#endif
+    return value;
+}
 
-    in >> arrayLength;
-    in >> encoding;
-    in >> compressedLength;
-    position += sizeof(quint32) * 3;
+template<class T> void copyLittleEndian(const char* source, T* destination, int count) {
+    memcpy(destination, source, count * sizeof(T));
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    for (int i = 0; i < count; i++) {
+        destination[i] = fromLittleEndian(destination[i]);
+    }
+#endif
+}
+
+template<> void copyLittleEndian(const char* source, bool* destination, int count) {
+    for (int i = 0; i < count; i++) {
+        destination[i] = (source[i] != 0);
+    }
+}
+
+template<class T> T BinaryFBXParser::read() {
+    require(sizeof(T));
+    T value;
+    memcpy(&value, _data + _position, sizeof(T));
+    _position += sizeof(T);
+    return fromLittleEndian(value);
+}
+
+template<class T> QVariant BinaryFBXParser::readArray() {
+    quint32 arrayLength = read<quint32>();
+    quint32 encoding = read<quint32>();
+    quint32 compressedLength = read<quint32>();
+    require(compressedLength);
+
+    // bools take a byte each in the file, whatever their size in memory
+    const quint64 ELEMENT_SIZE = sizeof(T);
+    quint64 uncompressedLength = arrayLength * ELEMENT_SIZE;
 
     QVector<T> values;
     const unsigned int DEFLATE_ENCODING = 1;
     if (encoding == DEFLATE_ENCODING) {
-        // preface encoded data with uncompressed length
-        QByteArray compressed(sizeof(quint32) + compressedLength, 0);
-        *((quint32*)compressed.data()) = qToBigEndian<quint32>(arrayLength * sizeof(T));
-        in.readRawData(compressed.data() + sizeof(quint32), compressedLength);
-        position += compressedLength;
-        QByteArray uncompressed = qUncompress(compressed);
-        QDataStream uncompressedIn(uncompressed);
-        uncompressedIn.setByteOrder(QDataStream::LittleEndian);
-        uncompressedIn.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
-        for (quint32 i = 0; i < arrayLength; i++) {
-            T value;
-            uncompressedIn >> value;
-            values.append(value);
+        // deflate can't do better than about 1:1032, so anything claiming more is corrupt rather than a huge allocation
+        const quint64 MAX_DEFLATE_RATIO = 1032;
+        if (uncompressedLength > (compressedLength + 1) * MAX_DEFLATE_RATIO ||
+                uncompressedLength > (quint64)std::numeric_limits<int>::max()) {
+            throw QString("Invalid compressed FBX array.");
         }
+        // preface encoded data with uncompressed length
+        _compressed.resize(sizeof(quint32) + compressedLength);
+        qToBigEndian<quint32>(uncompressedLength, reinterpret_cast<uchar*>(_compressed.data()));
+        memcpy(_compressed.data() + sizeof(quint32), _data + _position, compressedLength);
+        _position += compressedLength;
+        QByteArray uncompressed = qUncompress(_compressed);
+        if ((quint64)uncompressed.size() != uncompressedLength) {
+            throw QString("Invalid compressed FBX array.");
+        }
+        values.resize(arrayLength);
+        copyLittleEndian(uncompressed.constData(), values.data(), arrayLength);
     } else {
-        for (quint32 i = 0; i < arrayLength; i++) {
-            T value;
-            in >> value;
-            position += streamSize<T>();
-            values.append(value);
-        }
+        require(uncompressedLength);
+        values.resize(arrayLength);
+        copyLittleEndian(_data + _position, values.data(), arrayLength);
+        _position += uncompressedLength;
     }
     return QVariant::fromValue(values);
 }
 
-QVariant parseBinaryFBXProperty(QDataStream& in, int& position) {
-    char ch;
-    in.device()->getChar(&ch);
-    position++;
+QVariant BinaryFBXParser::parseProperty() {
+    char ch = read<char>();
     switch (ch) {
-        case 'Y': {
-            qint16 value;
-            in >> value;
-            position += sizeof(qint16);
-            return QVariant::fromValue(value);
-        }
-        case 'C': {
-            bool value;
-            in >> value;
-            position++;
-            return QVariant::fromValue(value);
-        }
-        case 'I': {
-            qint32 value;
-            in >> value;
-            position += sizeof(qint32);
-            return QVariant::fromValue(value);
-        }
-        case 'F': {
-            float value;
-            in >> value;
-            position += sizeof(float);
-            return QVariant::fromValue(value);
-        }
-        case 'D': {
-            double value;
-            in >> value;
-            position += sizeof(double);
-            return QVariant::fromValue(value);
-        }
-        case 'L': {
-            qint64 value;
-            in >> value;
-            position += sizeof(qint64);
-            return QVariant::fromValue(value);
-        }
-        case 'f': {
-            return readBinaryArray<float>(in, position);
-        }
-        case 'd': {
-            return readBinaryArray<double>(in, position);
-        }
-        case 'l': {
-            return readBinaryArray<qint64>(in, position);
-        }
-        case 'i': {
-            return readBinaryArray<qint32>(in, position);
-        }
-        case 'b': {
-            return readBinaryArray<bool>(in, position);
-        }
+        case 'Y':
+            return QVariant::fromValue(read<qint16>());
+
+        case 'C':
+            return QVariant::fromValue(read<quint8>() != 0);
+
+        case 'I':
+            return QVariant::fromValue(read<qint32>());
+
+        case 'F':
+            return QVariant::fromValue(read<float>());
+
+        case 'D':
+            return QVariant::fromValue(read<double>());
+
+        case 'L':
+            return QVariant::fromValue(read<qint64>());
+
+        case 'f':
+            return readArray<float>();
+
+        case 'd':
+            return readArray<double>();
+
+        case 'l':
+            return readArray<qint64>();
+
+        case 'i':
+            return readArray<qint32>();
+
+        case 'b':
+            return readArray<bool>();
+
         case 'S':
         case 'R': {
-            quint32 length;
-            in >> length;
-            position += sizeof(quint32) + length;
-            return QVariant::fromValue(in.device()->read(length));
+            quint32 length = read<quint32>();
+            require(length);
+            QByteArray value(_data + _position, length);
+            _position += length;
+            return QVariant::fromValue(value);
         }
         default:
             throw QString("Unknown property type: ") + ch;
     }
 }
 
-FBXNode parseBinaryFBXNode(QDataStream& in, int& position) {
-    qint32 endOffset;
-    quint32 propertyCount;
-    quint32 propertyListLength;
-    quint8 nameLength;
-
-    in >> endOffset;
-    in >> propertyCount;
-    in >> propertyListLength;
-    in >> nameLength;
-    position += sizeof(quint32) * 3 + sizeof(quint8);
+FBXNode BinaryFBXParser::parseNode(const QList<QByteArray>& wantedNames) {
+    quint64 endOffset;
+    quint64 propertyCount;
+    if (_wideOffsets) {
+        endOffset = read<quint64>();
+        propertyCount = read<quint64>();
+        read<quint64>(); // property list length
+    } else {
+        endOffset = read<quint32>();
+        propertyCount = read<quint32>();
+        read<quint32>(); // property list length
+    }
+    quint8 nameLength = read<quint8>();
 
     FBXNode node;
-    const int MIN_VALID_OFFSET = 40;
-    if (endOffset < MIN_VALID_OFFSET || nameLength == 0) {
+    if (endOffset == 0 || nameLength == 0) {
         // use a null name to indicate a null node
         return node;
     }
-    node.name = in.device()->read(nameLength);
-    position += nameLength;
+    if (endOffset > (quint64)_size || endOffset < (quint64)_position + nameLength) {
+        throw QString("Invalid FBX node.");
+    }
+    require(nameLength);
+    node.name = QByteArray(_data + _position, nameLength);
+    _position += nameLength;
+
+    if (!wantedNames.isEmpty() && !wantedNames.contains(node.name)) {
+        _position = endOffset;
+        return node;
+    }
 
-    for (quint32 i = 0; i < propertyCount; i++) {
-        node.properties.append(parseBinaryFBXProperty(in, position));
+    for (quint64 i = 0; i < propertyCount; i++) {
+        node.properties.append(parseProperty());
     }
 
-    while (endOffset > position) {
-        FBXNode child = parseBinaryFBXNode(in, position);
+    while ((quint64)_position < endOffset) {
+        FBXNode child = parseNode();
         if (child.name.isNull()) {
-            return node;
+            break;
 
         } else {
             node.children.append(child);
         }
     }
+    _position = endOffset;
 
     return node;
 }
@@ -477,62 +540,89 @@ FBXNode parseFBX(QIODevice* device) {
         }
         return top;
     }
-    QDataStream in(device);
-    in.setByteOrder(QDataStream::LittleEndian);
-    in.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
+    // parse the binary data in place: from a mapped file, from a buffer's array, or from everything the device has left
+    QByteArray data;
+    const char* begin = NULL;
+    qint64 size = 0;
+    QFile* file = qobject_cast<QFile*>(device);
+    uchar* mapped = (file && !file->isSequential()) ? file->map(file->pos(), file->size() - file->pos()) : NULL;
+    QBuffer* buffer = qobject_cast<QBuffer*>(device);
+    if (mapped) {
+        begin = reinterpret_cast<const char*>(mapped);
+        size = file->size() - file->pos();
+
+    } else if (buffer) {
+        data = buffer->data();
+        begin = data.constData() + buffer->pos();
+        size = data.size() - buffer->pos();
 
-    // see http://code.blender.org/index.php/2013/08/fbx-binary-file-format-specification/ for an explanation
-    // of the FBX binary format
+    } else {
+        data = device->readAll();
+        begin = data.constData();
+        size = data.size();
+    }
 
-    // skip the rest of the header
+    // the header is the prolog, two bytes we don't use and the version
     const int HEADER_SIZE = 27;
-    in.skipRawData(HEADER_SIZE);
-    int position = HEADER_SIZE;
-
-    // parse the top-level node
+    const int VERSION_OFFSET = 23;
+    const quint32 FIRST_WIDE_OFFSET_VERSION = 7500;
+    if (size < HEADER_SIZE) {
+        throw QString("Truncated FBX header.");
+    }
+    BinaryFBXParser parser(begin, size, HEADER_SIZE);
+    parser.setWideOffsets(qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(begin + VERSION_OFFSET)) >=
+        FIRST_WIDE_OFFSET_VERSION);
+
+    // parse the top-level nodes, skipping over those that extractFBXGeometry doesn't look at
+    static const QList<QByteArray> WANTED_TOP_LEVEL_NODES = QList<QByteArray>() << "FBXHeaderExtension" <<
+        "GlobalSettings" << "Objects" << "Connections";
     FBXNode top;
-    while (device->bytesAvailable()) {
-        FBXNode next = parseBinaryFBXNode(in, position);
-        if (next.name.isNull()) {
-            return top;
+    try {
+        while (!parser.atEnd()) {
+            FBXNode next = parser.parseNode(WANTED_TOP_LEVEL_NODES);
+            if (next.name.isNull()) {
+                break;
 
-        } else {
-            top.children.append(next);
+            } else if (WANTED_TOP_LEVEL_NODES.contains(next.name)) {
+                top.children.append(next);
+            }
+        }
+    } catch (const QString&) {
+        if (mapped) {
+            file->unmap(mapped);
         }
+        throw;
+    }
+    if (mapped) {
+        file->unmap(mapped);
     }
 
     return top;
 }
 
 QVector<glm::vec4> createVec4Vector(const QVector<double>& doubleVector) {
-    QVector<glm::vec4> values;
-    for (const double* it = doubleVector.constData(), *end = it + (doubleVector.size() / 4 * 4); it != end; ) {
-        float x = *it++;
-        float y = *it++;
-        float z = *it++;
-        float w = *it++;
-        values.append(glm::vec4(x, y, z, w));
+    QVector<glm::vec4> values(doubleVector.size() / 4);
+    const double* it = doubleVector.constData();
+    for (glm::vec4* value = values.data(), *end = value + values.size(); value != end; value++, it += 4) {
+        *value = glm::vec4(it[0], it[1], it[2], it[3]);
     }
     return values;
 }
 
 QVector<glm::vec3> createVec3Vector(const QVector<double>& doubleVector) {
-    QVector<glm::vec3> values;
-    for (const double* it = doubleVector.constData(), *end = it + (doubleVector.size() / 3 * 3); it != end; ) {
-        float x = *it++;
-        float y = *it++;
-        float z = *it++;
-        values.append(glm::vec3(x, y, z));
+    QVector<glm::vec3> values(doubleVector.size() / 3);
+    const double* it = doubleVector.constData();
+    for (glm::vec3* value = values.data(), *end = value + values.size(); value != end; value++, it += 3) {
+        *value = glm::vec3(it[0], it[1], it[2]);
     }
     return values;
 }
 
 QVector<glm::vec2> createVec2Vector(const QVector<double>& doubleVector) {
-    QVector<glm::vec2> values;
-    for (const double* it = doubleVector.constData(), *end = it + (doubleVector.size() / 2 * 2); it != end; ) {
-        float s = *it++;
-        float t = *it++;
-        values.append(glm::vec2(s, -t));
+    QVector<glm::vec2> values(doubleVector.size() / 2);
+    const double* it = doubleVector.constData();
+    for (glm::vec2* value = values.data(), *end = value + values.size(); value != end; value++, it += 2) {
+        *value = glm::vec2(it[0], -it[1]);
     }
     return values;
 }
@@ -595,6 +685,14 @@ QVector<double> getDoubleVector(const FBXNode& node) {
     if (!vector.isEmpty()) {
         return vector;
     }
+    QVector<float> floatVector = node.properties.at(0).value<QVector<float> >();
+    if (!floatVector.isEmpty()) {
+        // some exporters write single precision arrays
+        vector.resize(floatVector.size());
+        std::copy(floatVector.constBegin(), floatVector.constEnd(), vector.begin());
+        return vector;
+    }
+    vector.reserve(node.properties.size());
     for (int i = 0; i < node.properties.size(); i++) {
         vector.append(node.properties.at(i).toDouble());
     }
@@ -1280,21 +1378,20 @@ FBXLight extractLight(const FBXNode& object) {
 
 
 #if USE_MODEL_MESH
-void buildModelMesh(ExtractedMesh& extracted) {
+void buildModelMesh(FBXMesh& fbxMesh) {
     static QString repeatedMessage = LogHandler::getInstance().addRepeatedMessageRegex("buildModelMesh failed -- .*");
 
-    if (extracted.mesh.vertices.size() == 0) {
-        extracted.mesh._mesh = model::Mesh();
+    if (fbxMesh.vertices.size() == 0) {
+        fbxMesh._mesh = model::Mesh();
         qCDebug(modelformat) << "buildModelMesh failed -- no vertices";
         return;
     }
-    FBXMesh& fbxMesh = extracted.mesh;
     model::Mesh mesh;
 
     // Grab the vertices in a buffer
     gpu::BufferPointer vb(new gpu::Buffer());
-    vb->setData(extracted.mesh.vertices.size() * sizeof(glm::vec3),
-                (const gpu::Byte*) extracted.mesh.vertices.data());
+    vb->setData(fbxMesh.vertices.size() * sizeof(glm::vec3),
+                (const gpu::Byte*) fbxMesh.vertices.data());
     gpu::BufferView vbv(vb, gpu::Element(gpu::VEC3, gpu::FLOAT, gpu::XYZ));
     mesh.setVertexBuffer(vbv);
 
@@ -1366,12 +1463,12 @@ void buildModelMesh(ExtractedMesh& extracted) {
 
     unsigned int totalIndices = 0;
 
-    foreach(const FBXMeshPart& part, extracted.mesh.parts) {
+    foreach(const FBXMeshPart& part, fbxMesh.parts) {
         totalIndices += (part.quadIndices.size() + part.triangleIndices.size());
     }
 
     if (! totalIndices) {
-        extracted.mesh._mesh = model::Mesh();
+        fbxMesh._mesh = model::Mesh();
         qCDebug(modelformat) << "buildModelMesh failed -- no indices";
         return;
     }
@@ -1384,7 +1481,7 @@ void buildModelMesh(ExtractedMesh& extracted) {
 
     std::vector< model::Mesh::Part > parts;
 
-    foreach(const FBXMeshPart& part, extracted.mesh.parts) {
+    foreach(const FBXMeshPart& part, fbxMesh.parts) {
         model::Mesh::Part quadPart(indexNum, part.quadIndices.size(), 0, model::Mesh::QUADS);
         if (quadPart._numIndices) {
             parts.push_back(quadPart);
@@ -1411,7 +1508,7 @@ void buildModelMesh(ExtractedMesh& extracted) {
         gpu::BufferView pbv(pb, gpu::Element(gpu::VEC4, gpu::UINT32, gpu::XYZW));
         mesh.setPartBuffer(pbv);
     } else {
-        extracted.mesh._mesh = model::Mesh();
+        fbxMesh._mesh = model::Mesh();
         qCDebug(modelformat) << "buildModelMesh failed -- no parts";
         return;
     }
@@ -1419,7 +1516,7 @@ void buildModelMesh(ExtractedMesh& extracted) {
     // model::Box box =
     mesh.evalPartBound(0);
 
-    extracted.mesh._mesh = mesh;
+    fbxMesh._mesh = mesh;
 }
 #endif // USE_MODEL_MESH
 
@@ -2582,7 +2679,7 @@ FBXGeometry extractFBXGeometry(const FBXNode& node, const QVariantHash& mapping,
         extracted.mesh.isEye = (maxJointIndex == geometry.leftEyeJointIndex || maxJointIndex == geometry.rightEyeJointIndex);
 
 #       if USE_MODEL_MESH
-        buildModelMesh(extracted);
+        buildModelMesh(extracted.mesh);
 #       endif
         
         geometry.meshes.append(extracted.mesh);
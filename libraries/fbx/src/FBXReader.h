@@ -111,6 +111,7 @@ public:
     
     QVector<int> quadIndices;
     QVector<int> triangleIndices;
+    QVector<QVector<int> > lodTriangleIndices; // simplified versions over the same vertices, from most to least detailed
     
     glm::vec3 diffuseColor;
     glm::vec3 specularColor;
@@ -155,6 +156,8 @@ public:
     bool hasSpecularTexture() const;
     bool hasEmissiveTexture() const;
 
+    QVector<float> lodErrors; // how far each of the parts' levels of detail strays, relative to the size of the mesh
+
     unsigned int meshIndex; // the order the meshes appeared in the object file
 #   if USE_MODEL_MESH
     model::Mesh _mesh;
@@ -266,6 +269,14 @@ public:
 
 Q_DECLARE_METATYPE(FBXGeometry)
 
+/// Parses the nodes of an FBX document. In binary documents, the top-level nodes that readFBX doesn't use are skipped.
+/// \exception QString if an error occurs in parsing
+FBXNode parseFBX(QIODevice* device);
+
+/// Bump this whenever readFBX or optimizeGeometry changes what it produces, so that geometry baked from their output
+/// by an earlier version is read again rather than loaded.
+const quint32 FBX_READER_VERSION = 1;
+
 /// Reads FBX geometry from the supplied model and mapping data.
 /// \exception QString if an error occurs in parsing
 FBXGeometry readFBX(const QByteArray& model, const QVariantHash& mapping, bool loadLightmaps = true, float lightmapLevel = 1.0f);
@@ -274,4 +285,9 @@ FBXGeometry readFBX(const QByteArray& model, const QVariantHash& mapping, bool l
 /// \exception QString if an error occurs in parsing
 FBXGeometry readFBX(QIODevice* device, const QVariantHash& mapping, bool loadLightmaps = true, float lightmapLevel = 1.0f);
 
+#if USE_MODEL_MESH
+/// Fills in the mesh's model::Mesh buffers from its vertex attributes and parts.
+void buildModelMesh(FBXMesh& fbxMesh);
+#endif
+
 #endif // hifi_FBXReader_h
@@ -0,0 +1,781 @@
+//
+//  MeshOptimizer.cpp
+//  libraries/fbx/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include <QHash>
+
+#include "FBXReader.h"
+#include "MeshOptimizer.h"
+
+static const int INDICES_PER_TRIANGLE = 3;
+static const int INDICES_PER_QUAD = 4;
+
+float calculateACMR(const QVector<int>& indices, int indicesPerFace, int cacheSize) {
+    int faceCount = indices.size() / indicesPerFace;
+    if (faceCount == 0) {
+        return 0.0f;
+    }
+    int indexCount = faceCount * indicesPerFace;
+    int vertexCount = *std::max_element(indices.constBegin(), indices.constBegin() + indexCount) + 1;
+
+    // a vertex is still in the FIFO if fewer than cacheSize others have gone in since it did
+    QVector<int> entered(vertexCount, -cacheSize);
+    int misses = 0;
+    for (int i = 0; i < indexCount; i++) {
+        int index = indices.at(i);
+        if (misses - entered.at(index) >= cacheSize) {
+            entered[index] = misses++;
+        }
+    }
+    return (float)misses / (faceCount * (indicesPerFace - 2));
+}
+
+// the weights from Forsyth's "Linear-Speed Vertex Cache Optimisation"
+static const float CACHE_DECAY_POWER = 1.5f;
+static const float LAST_FACE_SCORE = 0.75f;
+static const float VALENCE_BOOST_SCALE = 2.0f;
+static const float VALENCE_BOOST_POWER = 0.5f;
+
+static float getVertexScore(int cachePosition, int remainingFaces, int indicesPerFace) {
+    if (remainingFaces == 0) {
+        return -1.0f;
+    }
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < indicesPerFace) {
+            // the last face's vertices are scored the same, whatever order they went in
+            score = LAST_FACE_SCORE;
+        } else {
+            float scale = 1.0f / (VERTEX_CACHE_SIZE - indicesPerFace);
+            score = powf(1.0f - (cachePosition - indicesPerFace) * scale, CACHE_DECAY_POWER);
+        }
+    }
+    // favor vertices with few faces left, so that they're finished off rather than left stranded
+    return score + VALENCE_BOOST_SCALE * powf((float)remainingFaces, -VALENCE_BOOST_POWER);
+}
+
+void optimizeVertexCache(QVector<int>& indices, int indicesPerFace, int vertexCount) {
+    int faceCount = indices.size() / indicesPerFace;
+    if (faceCount <= 1) {
+        return;
+    }
+    int indexCount = faceCount * indicesPerFace;
+
+    // the faces using each vertex, packed one vertex after another
+    QVector<int> faceOffsets(vertexCount + 1, 0);
+    for (int i = 0; i < indexCount; i++) {
+        faceOffsets[indices.at(i) + 1]++;
+    }
+    QVector<int> remainingFaces(vertexCount);
+    for (int i = 0; i < vertexCount; i++) {
+        remainingFaces[i] = faceOffsets.at(i + 1);
+        faceOffsets[i + 1] += faceOffsets.at(i);
+    }
+    QVector<int> vertexFaces(indexCount);
+    QVector<int> fill = faceOffsets;
+    for (int i = 0; i < indexCount; i++) {
+        vertexFaces[fill[indices.at(i)]++] = i / indicesPerFace;
+    }
+
+    QVector<float> vertexScores(vertexCount);
+    for (int i = 0; i < vertexCount; i++) {
+        vertexScores[i] = getVertexScore(-1, remainingFaces.at(i), indicesPerFace);
+    }
+    QVector<float> faceScores(faceCount, 0.0f);
+    int bestFace = 0;
+    for (int i = 0; i < faceCount; i++) {
+        for (int j = 0; j < indicesPerFace; j++) {
+            faceScores[i] += vertexScores.at(indices.at(i * indicesPerFace + j));
+        }
+        if (faceScores.at(i) > faceScores.at(bestFace)) {
+            bestFace = i;
+        }
+    }
+
+    QVector<bool> drawn(faceCount, false);
+    QVector<int> ordered;
+    ordered.reserve(indexCount);
+    const int MAX_INDICES_PER_FACE = INDICES_PER_QUAD;
+    int cache[VERTEX_CACHE_SIZE + MAX_INDICES_PER_FACE];
+    int cacheCount = 0;
+    int nextUndrawnFace = 0;
+    for (int drawnCount = 0; drawnCount < faceCount; drawnCount++) {
+        if (bestFace == -1) {
+            // nothing in the cache has any faces left, so start afresh from the first face not yet drawn
+            while (drawn.at(nextUndrawnFace)) {
+                nextUndrawnFace++;
+            }
+            bestFace = nextUndrawnFace;
+        }
+        drawn[bestFace] = true;
+        const int* face = indices.constData() + bestFace * indicesPerFace;
+
+        // the face's vertices go to the front of the cache, pushing back the rest
+        int newCache[VERTEX_CACHE_SIZE + MAX_INDICES_PER_FACE];
+        int newCacheCount = 0;
+        for (int i = 0; i < indicesPerFace; i++) {
+            int vertex = face[i];
+            ordered.append(vertex);
+            if (std::find(newCache, newCache + newCacheCount, vertex) == newCache + newCacheCount) {
+                newCache[newCacheCount++] = vertex;
+            }
+            // take the face out of the vertex's list
+            int* begin = vertexFaces.data() + faceOffsets.at(vertex);
+            int* end = begin + remainingFaces.at(vertex);
+            int* it = std::find(begin, end, bestFace);
+            if (it != end) {
+                *it = *(end - 1);
+                remainingFaces[vertex]--;
+            }
+        }
+        for (int i = 0; i < cacheCount; i++) {
+            if (std::find(newCache, newCache + newCacheCount, cache[i]) == newCache + newCacheCount) {
+                newCache[newCacheCount++] = cache[i];
+            }
+        }
+
+        // rescore everything that was or is in the cache, and the faces that they're still part of
+        for (int i = 0; i < newCacheCount; i++) {
+            int vertex = newCache[i];
+            int cachePosition = (i < VERTEX_CACHE_SIZE) ? i : -1;
+            float score = getVertexScore(cachePosition, remainingFaces.at(vertex), indicesPerFace);
+            float delta = score - vertexScores.at(vertex);
+            vertexScores[vertex] = score;
+            for (int j = faceOffsets.at(vertex), end = j + remainingFaces.at(vertex); j < end; j++) {
+                faceScores[vertexFaces.at(j)] += delta;
+            }
+        }
+        cacheCount = std::min(newCacheCount, VERTEX_CACHE_SIZE);
+        std::copy(newCache, newCache + cacheCount, cache);
+
+        // the next face is the best of those using the cached vertices
+        bestFace = -1;
+        float bestScore = -FLT_MAX;
+        for (int i = 0; i < cacheCount; i++) {
+            int vertex = cache[i];
+            for (int j = faceOffsets.at(vertex), end = j + remainingFaces.at(vertex); j < end; j++) {
+                int candidate = vertexFaces.at(j);
+                if (faceScores.at(candidate) > bestScore) {
+                    bestScore = faceScores.at(candidate);
+                    bestFace = candidate;
+                }
+            }
+        }
+    }
+    std::copy(ordered.constBegin(), ordered.constEnd(), indices.begin());
+}
+
+class OverdrawCluster {
+public:
+    int firstFace;
+    int faceCount;
+    float sortKey;
+};
+
+void optimizeOverdraw(QVector<int>& indices, int indicesPerFace, const QVector<glm::vec3>& vertices, float threshold) {
+    int faceCount = indices.size() / indicesPerFace;
+    if (faceCount <= 1) {
+        return;
+    }
+    // restarting the simulated cache is just a matter of pushing everything in it out of date
+    QVector<int> entered(vertices.size(), -VERTEX_CACHE_SIZE);
+    int misses = 0;
+    auto drawFace = [&](int face) -> int {
+        int faceMisses = 0;
+        for (int i = face * indicesPerFace, end = i + indicesPerFace; i < end; i++) {
+            int index = indices.at(i);
+            if (misses - entered.at(index) >= VERTEX_CACHE_SIZE) {
+                entered[index] = misses++;
+                faceMisses++;
+            }
+        }
+        return faceMisses;
+    };
+
+    // the cache order already starts over wherever a face misses on every vertex, so those can be moved freely
+    QVector<int> hardBoundaries;
+    for (int i = 0; i < faceCount; i++) {
+        if (drawFace(i) == indicesPerFace) {
+            hardBoundaries.append(i);
+        }
+    }
+    hardBoundaries.append(faceCount);
+
+    // split those further wherever the cache has done about as well as it does over the whole run
+    QVector<OverdrawCluster> clusters;
+    for (int i = 0; i < hardBoundaries.size() - 1; i++) {
+        int start = hardBoundaries.at(i);
+        int end = hardBoundaries.at(i + 1);
+        misses += VERTEX_CACHE_SIZE;
+        int startMisses = misses;
+        for (int j = start; j < end; j++) {
+            drawFace(j);
+        }
+        float clusterThreshold = threshold * (misses - startMisses) / (end - start);
+
+        misses += VERTEX_CACHE_SIZE;
+        int clusterStart = start;
+        int clusterMisses = 0;
+        for (int j = start; j < end; j++) {
+            clusterMisses += drawFace(j);
+            if (j + 1 == end || (float)clusterMisses / (j + 1 - clusterStart) <= clusterThreshold) {
+                OverdrawCluster cluster = { clusterStart, j + 1 - clusterStart, 0.0f };
+                clusters.append(cluster);
+                misses += VERTEX_CACHE_SIZE;
+                clusterStart = j + 1;
+                clusterMisses = 0;
+            }
+        }
+    }
+
+    // sort by how far each cluster faces out from the middle of the mesh
+    QVector<glm::vec3> centroids(clusters.size());
+    QVector<glm::vec3> normals(clusters.size());
+    glm::vec3 meshCentroid;
+    float meshArea = 0.0f;
+    for (int i = 0; i < clusters.size(); i++) {
+        const OverdrawCluster& cluster = clusters.at(i);
+        glm::vec3 centroid, normal;
+        float area = 0.0f;
+        for (int j = cluster.firstFace * indicesPerFace, end = j + cluster.faceCount * indicesPerFace;
+                j < end; j += indicesPerFace) {
+            const glm::vec3& v0 = vertices.at(indices.at(j));
+            for (int k = 1; k < indicesPerFace - 1; k++) {
+                const glm::vec3& v1 = vertices.at(indices.at(j + k));
+                const glm::vec3& v2 = vertices.at(indices.at(j + k + 1));
+                glm::vec3 cross = glm::cross(v1 - v0, v2 - v0);
+                float triangleArea = glm::length(cross);
+                centroid += (v0 + v1 + v2) * triangleArea;
+                normal += cross;
+                area += triangleArea;
+            }
+        }
+        meshCentroid += centroid;
+        meshArea += area;
+        centroids[i] = (area > 0.0f) ? centroid / (area * INDICES_PER_TRIANGLE) :
+            vertices.at(indices.at(cluster.firstFace * indicesPerFace));
+        normals[i] = normal;
+    }
+    if (meshArea > 0.0f) {
+        meshCentroid /= meshArea * INDICES_PER_TRIANGLE;
+    }
+    for (int i = 0; i < clusters.size(); i++) {
+        float length = glm::length(normals.at(i));
+        clusters[i].sortKey = (length > 0.0f) ? glm::dot(centroids.at(i) - meshCentroid, normals.at(i) / length) : 0.0f;
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](const OverdrawCluster& first, const OverdrawCluster& second) {
+        return first.sortKey > second.sortKey;
+    });
+
+    QVector<int> ordered;
+    ordered.reserve(faceCount * indicesPerFace);
+    foreach (const OverdrawCluster& cluster, clusters) {
+        for (int i = cluster.firstFace * indicesPerFace, end = i + cluster.faceCount * indicesPerFace; i < end; i++) {
+            ordered.append(indices.at(i));
+        }
+    }
+    std::copy(ordered.constBegin(), ordered.constEnd(), indices.begin());
+}
+
+static void remapIndices(QVector<int>& indices, QVector<int>& remap, int& remappedCount) {
+    for (int i = 0; i < indices.size(); i++) {
+        int& remapped = remap[indices.at(i)];
+        if (remapped == -1) {
+            remapped = remappedCount++;
+        }
+        indices[i] = remapped;
+    }
+}
+
+template<class T> static void remapVertexArray(QVector<T>& values, const QVector<int>& remap, int remappedCount) {
+    if (values.size() != remap.size()) {
+        return;
+    }
+    QVector<T> remapped(remappedCount);
+    for (int i = 0; i < remap.size(); i++) {
+        if (remap.at(i) != -1) {
+            remapped[remap.at(i)] = values.at(i);
+        }
+    }
+    values.swap(remapped);
+}
+
+void optimizeVertexFetch(FBXMesh& mesh) {
+    int vertexCount = mesh.vertices.size();
+    QVector<int> remap(vertexCount, -1);
+    int remappedCount = 0;
+    for (int i = 0; i < mesh.parts.size(); i++) {
+        FBXMeshPart& part = mesh.parts[i];
+        remapIndices(part.quadIndices, remap, remappedCount);
+        remapIndices(part.triangleIndices, remap, remappedCount);
+        for (int j = 0; j < part.lodTriangleIndices.size(); j++) {
+            remapIndices(part.lodTriangleIndices[j], remap, remappedCount);
+        }
+    }
+    remapVertexArray(mesh.vertices, remap, remappedCount);
+    remapVertexArray(mesh.normals, remap, remappedCount);
+    remapVertexArray(mesh.tangents, remap, remappedCount);
+    remapVertexArray(mesh.colors, remap, remappedCount);
+    remapVertexArray(mesh.texCoords, remap, remappedCount);
+    remapVertexArray(mesh.texCoords1, remap, remappedCount);
+    remapVertexArray(mesh.clusterIndices, remap, remappedCount);
+    remapVertexArray(mesh.clusterWeights, remap, remappedCount);
+
+    // blendshapes only keep the offsets of the vertices that are left
+    for (int i = 0; i < mesh.blendshapes.size(); i++) {
+        FBXBlendshape& blendshape = mesh.blendshapes[i];
+        FBXBlendshape remapped;
+        for (int j = 0; j < blendshape.indices.size(); j++) {
+            int index = blendshape.indices.at(j);
+            if (index < 0 || index >= vertexCount || remap.at(index) == -1) {
+                continue;
+            }
+            remapped.indices.append(remap.at(index));
+            if (j < blendshape.vertices.size()) {
+                remapped.vertices.append(blendshape.vertices.at(j));
+            }
+            if (j < blendshape.normals.size()) {
+                remapped.normals.append(blendshape.normals.at(j));
+            }
+        }
+        blendshape = remapped;
+    }
+}
+
+/// The sum of squared distances to a set of planes, each weighted by the area it came from.
+class Quadric {
+public:
+
+    Quadric() : xx(0.0), xy(0.0), xz(0.0), xw(0.0), yy(0.0), yz(0.0), yw(0.0), zz(0.0), zw(0.0), ww(0.0), weight(0.0) { }
+
+    void addPlane(const glm::vec3& normal, const glm::vec3& point, double planeWeight) {
+        double a = normal.x, b = normal.y, c = normal.z, d = -glm::dot(normal, point);
+        xx += planeWeight * a * a; xy += planeWeight * a * b; xz += planeWeight * a * c; xw += planeWeight * a * d;
+        yy += planeWeight * b * b; yz += planeWeight * b * c; yw += planeWeight * b * d;
+        zz += planeWeight * c * c; zw += planeWeight * c * d;
+        ww += planeWeight * d * d;
+        weight += planeWeight;
+    }
+
+    Quadric& operator+=(const Quadric& other) {
+        xx += other.xx; xy += other.xy; xz += other.xz; xw += other.xw;
+        yy += other.yy; yz += other.yz; yw += other.yw;
+        zz += other.zz; zw += other.zw;
+        ww += other.ww;
+        weight += other.weight;
+        return *this;
+    }
+
+    /// Returns the weighted mean of the squared distances from the point to the planes.
+    double evaluate(const glm::vec3& point) const {
+        if (weight <= 0.0) {
+            return 0.0;
+        }
+        double x = point.x, y = point.y, z = point.z;
+        double sum = xx * x * x + 2.0 * (xy * x * y + xz * x * z + xw * x) + yy * y * y + 2.0 * (yz * y * z + yw * y) +
+            zz * z * z + 2.0 * zw * z + ww;
+        return std::max(sum / weight, 0.0);
+    }
+
+private:
+
+    double xx, xy, xz, xw, yy, yz, yw, zz, zw, ww;
+    double weight;
+};
+
+// how much more open and part edges count than faces, so that outlines and material boundaries hold their shape
+static const double BORDER_EDGE_WEIGHT = 10.0;
+
+/// Collapses edges of a mesh's triangles, cheapest first, keeping track of the largest error so far.
+class MeshSimplifier {
+public:
+
+    MeshSimplifier(const FBXMesh& mesh);
+
+    int getTriangleCount() const { return _partIndices.size(); }
+
+    /// Returns the largest distance any collapse so far has moved the surface by, roughly.
+    float getError() const { return (float)std::sqrt(_maximumError); }
+
+    /// Collapses edges until there are no more than the target number of triangles left or the next would move the
+    /// surface by more than the maximum error.
+    void simplify(int targetTriangleCount, float maximumError);
+
+    QVector<int> getTriangleIndices(int partIndex) const;
+
+private:
+
+    class Collapse {
+    public:
+        int from;
+        int to;
+        double error;
+    };
+
+    int getPositionClass(int vertex) const { return _positionClasses.at(vertex); }
+
+    bool collapsePass(int targetTriangleCount, double maximumError);
+
+    const QVector<glm::vec3>& _vertices;
+    QVector<int> _positionClasses;
+    QVector<int> _classOffsets; // the vertices at each position, packed one position after another
+    QVector<int> _classVertices;
+    QVector<Quadric> _quadrics;
+
+    QVector<int> _indices;
+    QVector<int> _partIndices;
+    double _maximumError;
+};
+
+MeshSimplifier::MeshSimplifier(const FBXMesh& mesh) :
+    _vertices(mesh.vertices),
+    _maximumError(0.0) {
+
+    for (int i = 0; i < mesh.parts.size(); i++) {
+        const FBXMeshPart& part = mesh.parts.at(i);
+        for (int j = 0; j + INDICES_PER_QUAD <= part.quadIndices.size(); j += INDICES_PER_QUAD) {
+            const int* quad = part.quadIndices.constData() + j;
+            _indices << quad[0] << quad[1] << quad[2] << quad[0] << quad[2] << quad[3];
+            _partIndices << i << i;
+        }
+        for (int j = 0; j + INDICES_PER_TRIANGLE <= part.triangleIndices.size(); j += INDICES_PER_TRIANGLE) {
+            const int* triangle = part.triangleIndices.constData() + j;
+            _indices << triangle[0] << triangle[1] << triangle[2];
+            _partIndices << i;
+        }
+    }
+
+    // vertices split only by their other attributes collapse together, so they're grouped by position
+    int vertexCount = _vertices.size();
+    QVector<int> sorted(vertexCount);
+    for (int i = 0; i < vertexCount; i++) {
+        sorted[i] = i;
+    }
+    std::sort(sorted.begin(), sorted.end(), [&](int first, int second) {
+        const glm::vec3& v0 = _vertices.at(first);
+        const glm::vec3& v1 = _vertices.at(second);
+        return v0.x < v1.x || (v0.x == v1.x && (v0.y < v1.y || (v0.y == v1.y && v0.z < v1.z)));
+    });
+    _positionClasses.resize(vertexCount);
+    _classVertices = sorted;
+    int classCount = 0;
+    for (int i = 0; i < vertexCount; i++) {
+        if (i == 0 || _vertices.at(sorted.at(i)) != _vertices.at(sorted.at(i - 1))) {
+            _classOffsets.append(i);
+            classCount++;
+        }
+        _positionClasses[sorted.at(i)] = classCount - 1;
+    }
+    _classOffsets.append(vertexCount);
+
+    // each position starts with the planes of the triangles around it
+    _quadrics.resize(classCount);
+    QVector<glm::vec3> normals(getTriangleCount());
+    for (int i = 0; i < getTriangleCount(); i++) {
+        const glm::vec3& v0 = _vertices.at(_indices.at(i * INDICES_PER_TRIANGLE));
+        const glm::vec3& v1 = _vertices.at(_indices.at(i * INDICES_PER_TRIANGLE + 1));
+        const glm::vec3& v2 = _vertices.at(_indices.at(i * INDICES_PER_TRIANGLE + 2));
+        glm::vec3 cross = glm::cross(v1 - v0, v2 - v0);
+        float length = glm::length(cross);
+        if (length == 0.0f) {
+            continue;
+        }
+        normals[i] = cross / length;
+        for (int j = 0; j < INDICES_PER_TRIANGLE; j++) {
+            _quadrics[getPositionClass(_indices.at(i * INDICES_PER_TRIANGLE + j))].addPlane(normals.at(i), v0,
+                length * 0.5f);
+        }
+    }
+
+    // edges with only one triangle, or triangles from different parts, also get a plane at right angles to the face
+    class EdgeUse {
+    public:
+        int triangle;
+        int count;
+        bool betweenParts;
+    };
+    QHash<quint64, EdgeUse> edgeUses;
+    for (int i = 0; i < getTriangleCount(); i++) {
+        for (int j = 0; j < INDICES_PER_TRIANGLE; j++) {
+            int first = getPositionClass(_indices.at(i * INDICES_PER_TRIANGLE + j));
+            int second = getPositionClass(_indices.at(i * INDICES_PER_TRIANGLE + (j + 1) % INDICES_PER_TRIANGLE));
+            if (first == second) {
+                continue;
+            }
+            quint64 key = ((quint64)std::min(first, second) << 32) | (quint64)std::max(first, second);
+            QHash<quint64, EdgeUse>::iterator it = edgeUses.find(key);
+            if (it == edgeUses.end()) {
+                EdgeUse edgeUse = { i, 1, false };
+                edgeUses.insert(key, edgeUse);
+            } else {
+                it.value().count++;
+                it.value().betweenParts |= (_partIndices.at(it.value().triangle) != _partIndices.at(i));
+            }
+        }
+    }
+    for (QHash<quint64, EdgeUse>::const_iterator it = edgeUses.constBegin(); it != edgeUses.constEnd(); it++) {
+        if (it.value().count > 1 && !it.value().betweenParts) {
+            continue;
+        }
+        int first = it.key() >> 32;
+        int second = it.key() & 0xFFFFFFFF;
+        const glm::vec3& v0 = _vertices.at(_classVertices.at(_classOffsets.at(first)));
+        const glm::vec3& v1 = _vertices.at(_classVertices.at(_classOffsets.at(second)));
+        glm::vec3 edge = v1 - v0;
+        glm::vec3 cross = glm::cross(edge, normals.at(it.value().triangle));
+        float length = glm::length(cross);
+        if (length == 0.0f) {
+            continue;
+        }
+        double weight = BORDER_EDGE_WEIGHT * glm::dot(edge, edge);
+        _quadrics[first].addPlane(cross / length, v0, weight);
+        _quadrics[second].addPlane(cross / length, v0, weight);
+    }
+}
+
+void MeshSimplifier::simplify(int targetTriangleCount, float maximumError) {
+    while (getTriangleCount() > targetTriangleCount &&
+        collapsePass(targetTriangleCount, (double)maximumError * maximumError));
+}
+
+QVector<int> MeshSimplifier::getTriangleIndices(int partIndex) const {
+    QVector<int> indices;
+    for (int i = 0; i < getTriangleCount(); i++) {
+        if (_partIndices.at(i) == partIndex) {
+            for (int j = 0; j < INDICES_PER_TRIANGLE; j++) {
+                indices.append(_indices.at(i * INDICES_PER_TRIANGLE + j));
+            }
+        }
+    }
+    return indices;
+}
+
+bool MeshSimplifier::collapsePass(int targetTriangleCount, double maximumError) {
+    // the triangles around each vertex, packed one vertex after another
+    int vertexCount = _vertices.size();
+    int triangleCount = getTriangleCount();
+    QVector<int> triangleOffsets(vertexCount + 1, 0);
+    foreach (int index, _indices) {
+        triangleOffsets[index + 1]++;
+    }
+    for (int i = 0; i < vertexCount; i++) {
+        triangleOffsets[i + 1] += triangleOffsets.at(i);
+    }
+    QVector<int> vertexTriangles(_indices.size());
+    QVector<int> fill = triangleOffsets;
+    for (int i = 0; i < _indices.size(); i++) {
+        vertexTriangles[fill[_indices.at(i)]++] = i / INDICES_PER_TRIANGLE;
+    }
+
+    // cost both directions of every edge, moving one end's position onto the other's
+    QVector<Collapse> collapses;
+    collapses.reserve(_indices.size() * 2);
+    for (int i = 0; i < triangleCount; i++) {
+        for (int j = 0; j < INDICES_PER_TRIANGLE; j++) {
+            int first = _indices.at(i * INDICES_PER_TRIANGLE + j);
+            int second = _indices.at(i * INDICES_PER_TRIANGLE + (j + 1) % INDICES_PER_TRIANGLE);
+            int firstClass = getPositionClass(first);
+            int secondClass = getPositionClass(second);
+            Quadric sum = _quadrics.at(firstClass);
+            sum += _quadrics.at(secondClass);
+            Collapse forward = { firstClass, secondClass, sum.evaluate(_vertices.at(second)) };
+            Collapse backward = { secondClass, firstClass, sum.evaluate(_vertices.at(first)) };
+            collapses << forward << backward;
+        }
+    }
+    std::sort(collapses.begin(), collapses.end(), [](const Collapse& first, const Collapse& second) {
+        return first.error < second.error;
+    });
+
+    // make as many as we can without any two touching the same triangles, so that each can be checked in isolation
+    QVector<bool> locked(_quadrics.size(), false);
+    QVector<int> collapsedVertices(vertexCount, -1);
+    QVector<int> targets;
+    int trianglesToRemove = triangleCount - targetTriangleCount;
+    int trianglesRemoved = 0;
+    foreach (const Collapse& collapse, collapses) {
+        if (collapse.error > maximumError || trianglesRemoved >= trianglesToRemove) {
+            break;
+        }
+        if (locked.at(collapse.from) || locked.at(collapse.to)) {
+            continue;
+        }
+        // every vertex at the position that's going must have a neighbor at the one that's staying to become, or an
+        // attribute seam would tear
+        targets.clear();
+        bool valid = true;
+        int collapseTrianglesRemoved = 0;
+        const glm::vec3& destination = _vertices.at(_classVertices.at(_classOffsets.at(collapse.to)));
+        for (int i = _classOffsets.at(collapse.from), end = _classOffsets.at(collapse.from + 1); valid && i < end; i++) {
+            int vertex = _classVertices.at(i);
+            int target = -1;
+            for (int j = triangleOffsets.at(vertex), triangleEnd = triangleOffsets.at(vertex + 1);
+                    j < triangleEnd; j++) {
+                const int* triangle = _indices.constData() + vertexTriangles.at(j) * INDICES_PER_TRIANGLE;
+                int neighbor = -1;
+                int corner = 0;
+                for (int k = 0; k < INDICES_PER_TRIANGLE; k++) {
+                    if (getPositionClass(triangle[k]) == collapse.to) {
+                        neighbor = triangle[k];
+                    }
+                    if (triangle[k] == vertex) {
+                        corner = k;
+                    }
+                }
+                if (neighbor != -1) {
+                    target = neighbor;
+                    collapseTrianglesRemoved++;
+                    continue;
+                }
+                // the triangles that stay mustn't turn over
+                const glm::vec3& v0 = _vertices.at(triangle[0]);
+                const glm::vec3& v1 = _vertices.at(triangle[1]);
+                const glm::vec3& v2 = _vertices.at(triangle[2]);
+                glm::vec3 moved[] = { v0, v1, v2 };
+                moved[corner] = destination;
+                glm::vec3 before = glm::cross(v1 - v0, v2 - v0);
+                glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+                if (glm::dot(before, after) <= 0.0f && glm::dot(before, before) > 0.0f) {
+                    valid = false;
+                    break;
+                }
+            }
+            if (triangleOffsets.at(vertex) != triangleOffsets.at(vertex + 1)) {
+                if (target == -1) {
+                    valid = false;
+                }
+                targets.append(vertex);
+                targets.append(target);
+            }
+        }
+        if (!valid || targets.isEmpty()) {
+            continue;
+        }
+        for (int i = 0; i < targets.size(); i += 2) {
+            collapsedVertices[targets.at(i)] = targets.at(i + 1);
+            for (int j = triangleOffsets.at(targets.at(i)), end = triangleOffsets.at(targets.at(i) + 1); j < end; j++) {
+                const int* triangle = _indices.constData() + vertexTriangles.at(j) * INDICES_PER_TRIANGLE;
+                for (int k = 0; k < INDICES_PER_TRIANGLE; k++) {
+                    locked[getPositionClass(triangle[k])] = true;
+                }
+            }
+        }
+        _quadrics[collapse.to] += _quadrics.at(collapse.from);
+        _maximumError = std::max(_maximumError, collapse.error);
+        trianglesRemoved += collapseTrianglesRemoved;
+    }
+    if (trianglesRemoved == 0) {
+        return false;
+    }
+
+    // move the collapsed vertices and drop the triangles that no longer have any area
+    QVector<int> indices;
+    QVector<int> partIndices;
+    indices.reserve(_indices.size());
+    partIndices.reserve(triangleCount);
+    for (int i = 0; i < triangleCount; i++) {
+        int triangle[INDICES_PER_TRIANGLE];
+        for (int j = 0; j < INDICES_PER_TRIANGLE; j++) {
+            int index = _indices.at(i * INDICES_PER_TRIANGLE + j);
+            int collapsed = collapsedVertices.at(index);
+            triangle[j] = (collapsed == -1) ? index : collapsed;
+        }
+        int class0 = getPositionClass(triangle[0]);
+        int class1 = getPositionClass(triangle[1]);
+        int class2 = getPositionClass(triangle[2]);
+        if (class0 != class1 && class1 != class2 && class2 != class0) {
+            indices << triangle[0] << triangle[1] << triangle[2];
+            partIndices << _partIndices.at(i);
+        }
+    }
+    _indices.swap(indices);
+    _partIndices.swap(partIndices);
+    return true;
+}
+
+// meshes smaller than this draw quickly enough as they are
+static const int MIN_LOD_TRIANGLES = 256;
+
+// the farthest a level may move the surface, relative to the size of the mesh
+static const float MAX_LOD_ERROR = 0.05f;
+
+// levels that can't lose at least a quarter of the triangles of the last aren't worth drawing
+static const float MAX_LOD_TRIANGLE_PROPORTION = 0.75f;
+
+void generateMeshLODs(FBXMesh& mesh) {
+    mesh.lodErrors.clear();
+    for (int i = 0; i < mesh.parts.size(); i++) {
+        mesh.parts[i].lodTriangleIndices.clear();
+    }
+    if (mesh.vertices.isEmpty()) {
+        return;
+    }
+    MeshSimplifier simplifier(mesh);
+    int triangleCount = simplifier.getTriangleCount();
+    if (triangleCount < MIN_LOD_TRIANGLES) {
+        return;
+    }
+    glm::vec3 minimum = mesh.vertices.at(0), maximum = mesh.vertices.at(0);
+    foreach (const glm::vec3& vertex, mesh.vertices) {
+        minimum = glm::min(minimum, vertex);
+        maximum = glm::max(maximum, vertex);
+    }
+    float size = glm::distance(minimum, maximum);
+    if (size == 0.0f) {
+        return;
+    }
+
+    // each level carries on collapsing from the last
+    int lastTriangleCount = triangleCount;
+    for (int i = 1; i <= MAX_MESH_LODS; i++) {
+        simplifier.simplify(triangleCount >> i, MAX_LOD_ERROR * size);
+        if (simplifier.getTriangleCount() > lastTriangleCount * MAX_LOD_TRIANGLE_PROPORTION) {
+            break;
+        }
+        lastTriangleCount = simplifier.getTriangleCount();
+        for (int j = 0; j < mesh.parts.size(); j++) {
+            mesh.parts[j].lodTriangleIndices.append(simplifier.getTriangleIndices(j));
+        }
+        mesh.lodErrors.append(simplifier.getError() / size);
+    }
+}
+
+void optimizeMesh(FBXMesh& mesh) {
+    generateMeshLODs(mesh);
+
+    int vertexCount = mesh.vertices.size();
+    for (int i = 0; i < mesh.parts.size(); i++) {
+        FBXMeshPart& part = mesh.parts[i];
+        optimizeVertexCache(part.quadIndices, INDICES_PER_QUAD, vertexCount);
+        optimizeOverdraw(part.quadIndices, INDICES_PER_QUAD, mesh.vertices);
+        optimizeVertexCache(part.triangleIndices, INDICES_PER_TRIANGLE, vertexCount);
+        optimizeOverdraw(part.triangleIndices, INDICES_PER_TRIANGLE, mesh.vertices);
+        for (int j = 0; j < part.lodTriangleIndices.size(); j++) {
+            optimizeVertexCache(part.lodTriangleIndices[j], INDICES_PER_TRIANGLE, vertexCount);
+            optimizeOverdraw(part.lodTriangleIndices[j], INDICES_PER_TRIANGLE, mesh.vertices);
+        }
+    }
+    optimizeVertexFetch(mesh);
+}
+
+void optimizeGeometry(FBXGeometry& geometry) {
+    for (int i = 0; i < geometry.meshes.size(); i++) {
+        FBXMesh& mesh = geometry.meshes[i];
+        optimizeMesh(mesh);
+
+#       if USE_MODEL_MESH
+        // the vertices were renumbered, so the model mesh built by the reader no longer matches them
+        buildModelMesh(mesh);
+#       endif
+    }
+}
@@ -0,0 +1,60 @@
+//
+//  MeshOptimizer.h
+//  libraries/fbx/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Reorders and simplifies extracted meshes so that they draw with fewer vertex transforms, less overdraw, and fewer
+//  triangles at a distance.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_MeshOptimizer_h
+#define hifi_MeshOptimizer_h
+
+#include <glm/glm.hpp>
+
+#include <QVector>
+
+class FBXGeometry;
+class FBXMesh;
+
+/// The size of the post-transform vertex cache we optimize for; smaller than most current hardware's, since an order
+/// that suits a small cache also suits a larger one.
+const int VERTEX_CACHE_SIZE = 16;
+
+/// The most levels of detail generated for a mesh, not counting the full detail one.
+const int MAX_MESH_LODS = 3;
+
+/// Returns the average cache miss ratio of drawing the faces through a FIFO post-transform cache: the number of vertices
+/// transformed per triangle, from 3 (no reuse at all) down to around 0.5 for a large regular grid.
+float calculateACMR(const QVector<int>& indices, int indicesPerFace, int cacheSize = VERTEX_CACHE_SIZE);
+
+/// Reorders the faces so that they reuse recently transformed vertices, using Tom Forsyth's linear-speed algorithm.
+void optimizeVertexCache(QVector<int>& indices, int indicesPerFace, int vertexCount);
+
+/// Reorders clusters of cache-ordered faces so that those facing outward from the middle of the mesh draw first and hide
+/// more of what's behind them, without letting the cache miss ratio grow by more than the threshold.
+void optimizeOverdraw(QVector<int>& indices, int indicesPerFace, const QVector<glm::vec3>& vertices,
+                      float threshold = 1.05f);
+
+/// Renumbers the mesh's vertices in the order its faces first use them, dropping any that none do, so that drawing reads
+/// through the vertex buffer in order.
+void optimizeVertexFetch(FBXMesh& mesh);
+
+/// Fills in each part's lodTriangleIndices and the mesh's lodErrors with up to MAX_MESH_LODS successively halved versions
+/// of the mesh, simplified by edge collapses chosen by quadric error. Collapses only ever move vertices onto their
+/// neighbors, so every level draws from the full detail vertices; open edges and the edges between parts are weighted
+/// to stay put, and attribute seams only move when the vertices on both sides can follow.
+void generateMeshLODs(FBXMesh& mesh);
+
+/// Generates the mesh's levels of detail and optimizes the draw order of every level and then the vertex order.
+void optimizeMesh(FBXMesh& mesh);
+
+/// Optimizes every mesh of the geometry. This is too slow to do on every load, so it's only done when baking geometry
+/// for drawing; collision hulls and animations are read as is.
+void optimizeGeometry(FBXGeometry& geometry);
+
+#endif // hifi_MeshOptimizer_h
@@ -0,0 +1,309 @@
+//
+//  BakedTexture.cpp
+//  libraries/gpu/src/gpu
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cstring>
+#include <memory>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringList>
+
+#include "BakedTexture.h"
+#include "GPULogging.h"
+
+using namespace gpu;
+
+static const char BAKED_TEXTURE_MAGIC[] = "HFTEXTURE";
+
+// baked files are only ever read on machines with the same byte order as the one that wrote them
+static const quint32 BYTE_ORDER_MARK = 0x01020304;
+
+// the levels start on boundaries this far apart
+static const int LEVEL_ALIGNMENT = 16;
+
+class BakedTextureWriter {
+public:
+
+    template<class T> void write(const T& value) { _data.append(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+    void writeBytes(const char* bytes, quint32 size);
+    void writeElement(const Element& element);
+
+    QByteArray& getData() { return _data; }
+
+private:
+
+    QByteArray _data;
+};
+
+void BakedTextureWriter::writeBytes(const char* bytes, quint32 size) {
+    write(size);
+    int padding = (LEVEL_ALIGNMENT - _data.size() % LEVEL_ALIGNMENT) % LEVEL_ALIGNMENT;
+    _data.append(QByteArray(padding, 0));
+    _data.append(bytes, size);
+}
+
+void BakedTextureWriter::writeElement(const Element& element) {
+    write<quint8>(element.getDimension());
+    write<quint8>(element.getType());
+    write<quint8>(element.getSemantic());
+}
+
+QByteArray gpu::writeBakedTexture(const Texture& texture, const QVariantHash& metadata) {
+    BakedTextureWriter writer;
+    writer.getData().append(BAKED_TEXTURE_MAGIC, sizeof(BAKED_TEXTURE_MAGIC));
+    writer.write(BAKED_TEXTURE_VERSION);
+    writer.write(BYTE_ORDER_MARK);
+    writer.write<quint64>(0); // total size, filled in below
+
+    QByteArray metadataBytes;
+    QDataStream metadataStream(&metadataBytes, QIODevice::WriteOnly);
+    metadataStream << metadata;
+    writer.writeBytes(metadataBytes.constData(), metadataBytes.size());
+
+    writer.write<quint8>(texture.getType());
+    writer.writeElement(texture.getTexelFormat());
+    writer.write<quint16>(texture.getWidth());
+    writer.write<quint16>(texture.getHeight());
+    writer.write<quint16>(texture.getDepth());
+    writer.write<bool>(texture.isAutogenerateMips());
+
+    // only the levels actually stored; those past the first are missing if they're generated on the GPU
+    quint16 levels = 0;
+    while (levels <= texture.maxMip() && texture.isStoredMipFaceAvailable(levels)) {
+        levels++;
+    }
+    writer.write(levels);
+    for (quint16 level = 0; level < levels; level++) {
+        for (quint8 face = 0; face < texture.getNumFaces(); face++) {
+            Texture::PixelsPointer mipFace = texture.accessStoredMipFace(level, face);
+            if (!mipFace) {
+                writer.writeElement(texture.getTexelFormat());
+                writer.writeBytes(nullptr, 0);
+                continue;
+            }
+            writer.writeElement(mipFace->_format);
+            writer.writeBytes(reinterpret_cast<const char*>(mipFace->_sysmem.readData()), mipFace->_sysmem.getSize());
+        }
+    }
+
+    QByteArray& data = writer.getData();
+    quint64 size = data.size();
+    memcpy(data.data() + sizeof(BAKED_TEXTURE_MAGIC) + sizeof(quint32) * 2, &size, sizeof(quint64));
+    return data;
+}
+
+class BakedTextureReader {
+public:
+
+    BakedTextureReader(const char* data, qint64 size, qint64 position);
+
+    template<class T> T read();
+
+    // Returns a pointer to the bytes where they lie, rather than copying them
+    const char* readBytes(quint32& size);
+    Element readElement();
+
+private:
+
+    void require(quint64 length) const;
+
+    const char* _data;
+    qint64 _size;
+    qint64 _position;
+};
+
+BakedTextureReader::BakedTextureReader(const char* data, qint64 size, qint64 position) :
+    _data(data),
+    _size(size),
+    _position(position) {
+}
+
+void BakedTextureReader::require(quint64 length) const {
+    if (length > (quint64)(_size - _position)) {
+        throw QString("Unexpected end of baked texture.");
+    }
+}
+
+template<class T> T BakedTextureReader::read() {
+    require(sizeof(T));
+    T value;
+    memcpy(&value, _data + _position, sizeof(T));
+    _position += sizeof(T);
+    return value;
+}
+
+const char* BakedTextureReader::readBytes(quint32& size) {
+    size = read<quint32>();
+    _position += (LEVEL_ALIGNMENT - _position % LEVEL_ALIGNMENT) % LEVEL_ALIGNMENT;
+    require(size);
+    const char* bytes = _data + _position;
+    _position += size;
+    return bytes;
+}
+
+Element BakedTextureReader::readElement() {
+    quint8 dimension = read<quint8>();
+    quint8 type = read<quint8>();
+    quint8 semantic = read<quint8>();
+    if (dimension >= NUM_DIMENSIONS || type >= NUM_TYPES || semantic >= NUM_SEMANTICS) {
+        throw QString("Invalid baked texture format.");
+    }
+    return Element((Dimension)dimension, (Type)type, (Semantic)semantic);
+}
+
+Texture* gpu::readBakedTexture(const char* data, qint64 size, const Sampler& sampler, QVariantHash& metadata) {
+    const qint64 HEADER_SIZE = sizeof(BAKED_TEXTURE_MAGIC) + sizeof(quint32) * 2 + sizeof(quint64);
+    if (size < HEADER_SIZE || memcmp(data, BAKED_TEXTURE_MAGIC, sizeof(BAKED_TEXTURE_MAGIC)) != 0) {
+        throw QString("Not a baked texture.");
+    }
+    BakedTextureReader reader(data, size, sizeof(BAKED_TEXTURE_MAGIC));
+    if (reader.read<quint32>() != BAKED_TEXTURE_VERSION) {
+        throw QString("Baked texture is from another version.");
+    }
+    if (reader.read<quint32>() != BYTE_ORDER_MARK) {
+        throw QString("Baked texture is from a machine with another byte order.");
+    }
+    if (reader.read<quint64>() != (quint64)size) {
+        throw QString("Baked texture is truncated.");
+    }
+    quint32 metadataSize;
+    const char* metadataBytes = reader.readBytes(metadataSize);
+    QDataStream metadataStream(QByteArray::fromRawData(metadataBytes, metadataSize));
+    metadataStream >> metadata;
+
+    quint8 type = reader.read<quint8>();
+    Element texelFormat = reader.readElement();
+    quint16 width = reader.read<quint16>();
+    quint16 height = reader.read<quint16>();
+    quint16 depth = reader.read<quint16>();
+    bool autoGenerateMips = reader.read<bool>();
+    Texture* texture;
+    switch (type) {
+        case Texture::TEX_2D:
+            texture = Texture::create2D(texelFormat, width, height, sampler);
+            break;
+
+        case Texture::TEX_3D:
+            texture = Texture::create3D(texelFormat, width, height, depth, sampler);
+            break;
+
+        case Texture::TEX_CUBE:
+            texture = Texture::createCube(texelFormat, width, sampler);
+            break;
+
+        default:
+            throw QString("Unsupported baked texture type.");
+    }
+    std::unique_ptr<Texture> ownedTexture(texture);
+    if (autoGenerateMips) {
+        texture->autoGenerateMips(-1);
+    }
+    quint16 levels = reader.read<quint16>();
+    for (quint16 level = 0; level < levels; level++) {
+        for (quint8 face = 0; face < texture->getNumFaces(); face++) {
+            Element format = reader.readElement();
+            quint32 faceSize;
+            const char* bytes = reader.readBytes(faceSize);
+            if (faceSize != 0 && !texture->assignStoredMipFace(level, format, faceSize,
+                    reinterpret_cast<const Byte*>(bytes), face)) {
+                throw QString("Baked texture level doesn't fit the texture.");
+            }
+        }
+    }
+    return ownedTexture.release();
+}
+
+QString BakedTextureCache::getDefaultDirectory() {
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "/High Fidelity/baked-textures";
+}
+
+const QString BAKED_TEXTURE_SUFFIX = ".texture";
+
+BakedTextureCache::BakedTextureCache(const QString& directory, qint64 maximumSize) :
+    _directory(directory),
+    _files(BoundedFileCache::getCache(directory, BAKED_TEXTURE_SUFFIX, maximumSize)) {
+}
+
+QByteArray BakedTextureCache::getKey(const QByteArray& content, const QVariantHash& options) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(BAKED_TEXTURE_VERSION));
+    hash.addData(content);
+
+    // hashes are iterated in a different order in each process, so their keys are sorted
+    QStringList keys = options.keys();
+    keys.sort();
+    foreach (const QString& key, keys) {
+        hash.addData(key.toUtf8());
+        hash.addData(options.value(key).toString().toUtf8());
+    }
+    return hash.result();
+}
+
+QString BakedTextureCache::getFileName(const QByteArray& key) {
+    return key.toHex() + BAKED_TEXTURE_SUFFIX;
+}
+
+QString BakedTextureCache::getFilePath(const QByteArray& key) const {
+    return _directory + "/" + getFileName(key);
+}
+
+Texture* BakedTextureCache::load(const QByteArray& key, const Sampler& sampler, QVariantHash& metadata) const {
+    QFile file(getFilePath(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+    QByteArray data;
+    const char* begin = NULL;
+    uchar* mapped = file.map(0, file.size());
+    if (mapped) {
+        begin = reinterpret_cast<const char*>(mapped);
+    } else {
+        data = file.readAll();
+        begin = data.constData();
+    }
+    Texture* texture = nullptr;
+    try {
+        texture = readBakedTexture(begin, file.size(), sampler, metadata);
+
+    } catch (const QString& error) {
+        qCDebug(gpulogging) << "Discarding baked texture" << file.fileName() << ":" << error;
+    }
+    if (mapped) {
+        file.unmap(mapped);
+    }
+    file.close();
+    if (texture) {
+        _files->touch(getFileName(key));
+    } else {
+        _files->remove(getFileName(key));
+    }
+    return texture;
+}
+
+bool BakedTextureCache::save(const QByteArray& key, const Texture& texture, const QVariantHash& metadata) const {
+    if (!QDir().mkpath(_directory)) {
+        qCDebug(gpulogging) << "Couldn't create baked texture directory" << _directory;
+        return false;
+    }
+    // written to the side and renamed into place, so that nothing ever maps half a file
+    QSaveFile file(getFilePath(key));
+    QByteArray baked = writeBakedTexture(texture, metadata);
+    if (!file.open(QIODevice::WriteOnly) || file.write(baked) == -1 || !file.commit()) {
+        qCDebug(gpulogging) << "Couldn't write baked texture" << file.fileName() << ":" << file.errorString();
+        return false;
+    }
+    _files->insert(getFileName(key), baked.size());
+    return true;
+}
@@ -0,0 +1,78 @@
+//
+//  BakedTexture.h
+//  libraries/gpu/src/gpu
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  A file holding a texture's whole mip chain, as processed on the CPU, in the form Texture stores it.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_gpu_BakedTexture_h
+#define hifi_gpu_BakedTexture_h
+
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QString>
+#include <QVariantHash>
+
+#include <BoundedFileCache.h>
+
+#include "Texture.h"
+
+namespace gpu {
+
+// Bump this whenever what's written changes, or whenever the processing changes what it produces, so that existing
+// baked files are ignored and rebaked.
+const quint32 BAKED_TEXTURE_VERSION = 1;
+
+const qint64 DEFAULT_MAXIMUM_BAKED_TEXTURE_CACHE_SIZE = 2LL * 1024 * 1024 * 1024;
+
+// Writes every stored level of every face of the texture, each aligned so that the file can be mapped and the levels
+// assigned straight from it, after the metadata; much like a KTX file and its key/value data. The texture must not have
+// been uploaded yet, since that frees its stored levels.
+QByteArray writeBakedTexture(const Texture& texture, const QVariantHash& metadata = QVariantHash());
+
+// Reads a texture written by writeBakedTexture, e.g. out of a mapped file, giving it the sampler.
+// \exception QString if the data is truncated, corrupt or from another version
+Texture* readBakedTexture(const char* data, qint64 size, const Sampler& sampler, QVariantHash& metadata);
+
+// A directory of baked textures, named by a hash of the image they were made from and how they were made from it.
+// Once it grows past its maximum size, the least recently used textures are removed.
+class BakedTextureCache {
+public:
+
+    static QString getDefaultDirectory();
+
+    // The maximum size only applies if this is the first cache of the directory in the process.
+    BakedTextureCache(const QString& directory = getDefaultDirectory(),
+                      qint64 maximumSize = DEFAULT_MAXIMUM_BAKED_TEXTURE_CACHE_SIZE);
+
+    const QString& getDirectory() const { return _directory; }
+
+    // Returns the key for the texture made from the image content with the given processing options.
+    static QByteArray getKey(const QByteArray& content, const QVariantHash& options);
+
+    // Loads the texture baked under key, if there is any. Baked files that can't be read are removed.
+    Texture* load(const QByteArray& key, const Sampler& sampler, QVariantHash& metadata) const;
+
+    // Bakes the texture under key, replacing whatever was there.
+    bool save(const QByteArray& key, const Texture& texture, const QVariantHash& metadata) const;
+
+    QString getFilePath(const QByteArray& key) const;
+
+    const QSharedPointer<BoundedFileCache>& getFiles() const { return _files; }
+
+private:
+
+    static QString getFileName(const QByteArray& key);
+
+    QString _directory;
+    QSharedPointer<BoundedFileCache> _files;
+};
+
+};
+
+#endif
@@ -134,6 +134,12 @@ enum Semantic {
     SRGBA,
     SBGRA,
 
+    // Block compressed, 4x4 texels at a time, for texture storage only
+    COMPRESSED_BC1_RGB,
+    COMPRESSED_BC1_SRGB,
+    COMPRESSED_BC3_RGBA,
+    COMPRESSED_BC3_SRGBA,
+
     UNIFORM,
     UNIFORM_BUFFER,
     SAMPLER,
@@ -170,6 +176,10 @@ public:
 
     uint32 getSize() const { return DIMENSION_COUNT[_dimension] * TYPE_SIZE[_type]; }
 
+    // Compressed elements have no size of their own, only the 4x4 blocks they come in do
+    bool isCompressed() const { return (getSemantic() >= COMPRESSED_BC1_RGB) && (getSemantic() <= COMPRESSED_BC3_SRGBA); }
+    uint32 getBlockSize() const { return (getSemantic() <= COMPRESSED_BC1_SRGB ? 8 : 16); }
+
     uint16 getRaw() const { return *((uint16*) (this)); }
 
     
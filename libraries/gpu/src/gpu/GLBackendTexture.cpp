@@ -33,7 +33,28 @@ public:
     GLenum type;
 
     static GLTexelFormat evalGLTexelFormat(const Element& dstFormat, const Element& srcFormat) {
-        if (dstFormat != srcFormat) {
+        if (dstFormat.isCompressed()) {
+            // compressed pixels are only ever stored as they're kept, so there's no format or type to convert from
+            GLTexelFormat texel = {GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_RGBA, GL_UNSIGNED_BYTE};
+            switch(dstFormat.getSemantic()) {
+            case gpu::COMPRESSED_BC1_RGB:
+                texel.internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+                break;
+            case gpu::COMPRESSED_BC1_SRGB:
+                texel.internalFormat = GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+                break;
+            case gpu::COMPRESSED_BC3_RGBA:
+                texel.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                break;
+            case gpu::COMPRESSED_BC3_SRGBA:
+                texel.internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+                break;
+            default:
+                qCDebug(gpulogging) << "Unknown combination of texel format";
+            }
+            return texel;
+
+        } else if (dstFormat != srcFormat) {
             GLTexelFormat texel = {GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE};
 
             switch(dstFormat.getDimension()) {
@@ -259,6 +280,34 @@ public:
 };
 
 
+// Specifies one level of one face of a texture, whether its pixels are compressed or not
+static void specifyTexImage(GLenum target, GLint level, const GLTexelFormat& texelFormat, const Element& srcFormat,
+                            GLsizei width, GLsizei height, GLsizei size, const GLvoid* bytes) {
+    if (srcFormat.isCompressed()) {
+        glCompressedTexImage2D(target, level, texelFormat.internalFormat, width, height, 0, size, bytes);
+    } else {
+        glTexImage2D(target, level, texelFormat.internalFormat, width, height, 0,
+            texelFormat.format, texelFormat.type, bytes);
+    }
+}
+
+// Specifies the stored levels of a face after the first, as processed on the CPU rather than generated here, and returns
+// the last one specified
+static uint16 specifyStoredMips(const Texture& texture, GLenum target, uint8 face) {
+    uint16 level = 1;
+    for (; level <= texture.maxMip() && texture.isStoredMipFaceAvailable(level, face); level++) {
+        Texture::PixelsPointer mipFace = texture.accessStoredMipFace(level, face);
+        Element srcFormat = mipFace->_format;
+        GLTexelFormat texelFormat = GLTexelFormat::evalGLTexelFormat(texture.getTexelFormat(), srcFormat);
+        specifyTexImage(target, level, texelFormat, srcFormat, texture.evalMipWidth(level), texture.evalMipHeight(level),
+            mipFace->_sysmem.getSize(), mipFace->_sysmem.read<Byte>());
+
+        // At this point the mip pixels have been loaded, we can notify
+        texture.notifyMipFaceGPULoaded(level, face);
+    }
+    return level - 1;
+}
+
 GLBackend::GLTexture* GLBackend::syncGPUObject(const Texture& texture) {
     GLTexture* object = Backend::getGPUObject<GLBackend::GLTexture>(texture);
 
@@ -310,6 +359,8 @@ GLBackend::GLTexture* GLBackend::syncGPUObject(const Texture& texture) {
                     if (texture.isAutogenerateMips()) {
                         glGenerateMipmap(GL_TEXTURE_2D);
                         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+                    } else if (texture.maxMip() > 0) {
+                        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, specifyStoredMips(texture, GL_TEXTURE_2D, 0));
                     }
 
                 object->_target = GL_TEXTURE_2D;
@@ -324,11 +375,13 @@ GLBackend::GLTexture* GLBackend::syncGPUObject(const Texture& texture) {
                 }
             } else {
                 const GLvoid* bytes = 0;
+                GLsizei size = 0;
                 Element srcFormat = texture.getTexelFormat();
                 if (texture.isStoredMipFaceAvailable(0)) {
                     Texture::PixelsPointer mip = texture.accessStoredMipFace(0);
                 
                     bytes = mip->_sysmem.read<Byte>();
+                    size = mip->_sysmem.getSize();
                     srcFormat = mip->_format;
 
                     object->_contentStamp = texture.getDataStamp();
@@ -336,13 +389,15 @@ GLBackend::GLTexture* GLBackend::syncGPUObject(const Texture& texture) {
 
                 GLTexelFormat texelFormat = GLTexelFormat::evalGLTexelFormat(texture.getTexelFormat(), srcFormat);
             
-                glTexImage2D(GL_TEXTURE_2D, 0,
-                    texelFormat.internalFormat, texture.getWidth(), texture.getHeight(), 0,
-                    texelFormat.format, texelFormat.type, bytes);
+                specifyTexImage(GL_TEXTURE_2D, 0, texelFormat, srcFormat, texture.getWidth(), texture.getHeight(), size, bytes);
 
                 if (bytes && texture.isAutogenerateMips()) {
                     glGenerateMipmap(GL_TEXTURE_2D);
                     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+                } else if (bytes && texture.maxMip() > 0) {
+                    // the whole chain came with the texture, so there's nothing to generate
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, specifyStoredMips(texture, GL_TEXTURE_2D, 0));
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
                 } else {
                     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
                     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -389,6 +444,10 @@ GLBackend::GLTexture* GLBackend::syncGPUObject(const Texture& texture) {
 
                         // At this point the mip pixels have been loaded, we can notify
                         texture.notifyMipFaceGPULoaded(0, f);
+
+                        if (!texture.isAutogenerateMips()) {
+                            specifyStoredMips(texture, FACE_LAYOUT[f], f);
+                        }
                     }
                 }
 
@@ -407,23 +466,31 @@ GLBackend::GLTexture* GLBackend::syncGPUObject(const Texture& texture) {
                 glBindTexture(GL_TEXTURE_CUBE_MAP, object->_texture);
 
                 // transfer pixels from each faces
+                uint16 storedMaxMip = texture.maxMip();
                 for (int f = 0; f < NUM_FACES; f++) {
                     if (texture.isStoredMipFaceAvailable(0, f)) {
                         Texture::PixelsPointer mipFace = texture.accessStoredMipFace(0, f);
                         Element srcFormat = mipFace->_format;
                         GLTexelFormat texelFormat = GLTexelFormat::evalGLTexelFormat(texture.getTexelFormat(), srcFormat);
 
-                        glTexImage2D(FACE_LAYOUT[f], 0, texelFormat.internalFormat, texture.getWidth(), texture.getWidth(), 0,
-                                texelFormat.format, texelFormat.type, (GLvoid*) (mipFace->_sysmem.read<Byte>()));
+                        specifyTexImage(FACE_LAYOUT[f], 0, texelFormat, srcFormat, texture.getWidth(), texture.getWidth(),
+                                mipFace->_sysmem.getSize(), mipFace->_sysmem.read<Byte>());
 
                         // At this point the mip pixels have been loaded, we can notify
                         texture.notifyMipFaceGPULoaded(0, f);
+
+                        if (!texture.isAutogenerateMips()) {
+                            storedMaxMip = std::min(storedMaxMip, specifyStoredMips(texture, FACE_LAYOUT[f], f));
+                        }
                     }
                 }
 
                 if (texture.isAutogenerateMips()) {
                     glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
                     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+                } else if (storedMaxMip > 0) {
+                    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, storedMaxMip);
+                    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
                 } else {
                     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
                     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
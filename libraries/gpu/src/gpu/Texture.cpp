@@ -214,7 +214,7 @@ Texture::Size Texture::resize(Type type, const Element& texelFormat, uint16 widt
         }
         
         // Evaluate the new size with the new format
-        uint32_t size = NUM_FACES_PER_TYPE[_type] *_width * _height * _depth * _numSamples * texelFormat.getSize();
+        uint32_t size = NUM_FACES_PER_TYPE[_type] * evalTexelsSize(texelFormat, _width, _height, _depth) * _numSamples;
 
         // If size change then we need to reset 
         if (changed || (size != getSize())) {
@@ -277,6 +277,15 @@ uint16 Texture::evalNumMips() const {
     return 1 + (uint16) val;
 }
 
+uint32 Texture::evalTexelsSize(const Element& format, uint16 width, uint16 height, uint16 depth) {
+    if (format.isCompressed()) {
+        const uint32 BLOCK_DIMENSION = 4;
+        uint32 numBlocks = ((width + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION) * ((height + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION);
+        return numBlocks * depth * format.getBlockSize();
+    }
+    return width * height * depth * format.getSize();
+}
+
 uint16 Texture::maxMip() const {
     return _maxMip;
 }
@@ -296,6 +305,7 @@ bool Texture::assignStoredMip(uint16 level, const Element& format, Size size, co
     Size expectedSize = evalStoredMipSize(level, format);
     if (size == expectedSize) {
         _storage->assignMipData(level, format, size, bytes);
+        updateStoredMaxMip(level);
         _stamp++;
         return true;
     } else if (size > expectedSize) {
@@ -304,6 +314,7 @@ bool Texture::assignStoredMip(uint16 level, const Element& format, Size size, co
         // We should probably consider something a bit more smart to get the correct result but for now (UI elements)
         // it seems to work...
         _storage->assignMipData(level, format, size, bytes);
+        updateStoredMaxMip(level);
         _stamp++;
         return true;
     }
@@ -327,6 +338,7 @@ bool Texture::assignStoredMipFace(uint16 level, const Element& format, Size size
     Size expectedSize = evalStoredMipFaceSize(level, format);
     if (size == expectedSize) {
         _storage->assignMipFaceData(level, format, size, bytes, face);
+        updateStoredMaxMip(level);
         _stamp++;
         return true;
     } else if (size > expectedSize) {
@@ -335,6 +347,7 @@ bool Texture::assignStoredMipFace(uint16 level, const Element& format, Size size
         // We should probably consider something a bit more smart to get the correct result but for now (UI elements)
         // it seems to work...
         _storage->assignMipFaceData(level, format, size, bytes, face);
+        updateStoredMaxMip(level);
         _stamp++;
         return true;
     }
@@ -342,6 +355,12 @@ bool Texture::assignStoredMipFace(uint16 level, const Element& format, Size size
     return false;
 }
 
+void Texture::updateStoredMaxMip(uint16 level) {
+    if (!_autoGenerateMips) {
+        _maxMip = std::max(_maxMip, level);
+    }
+}
+
 uint16 Texture::autoGenerateMips(uint16 maxMip) {
     _autoGenerateMips = true;
     _maxMip = std::min((uint16) (evalNumMips() - 1), maxMip);
@@ -384,7 +403,7 @@ uint32 Texture::getStoredMipNumTexels(uint16 level) const {
 uint32 Texture::getStoredMipSize(uint16 level) const {
     PixelsPointer mipFace = accessStoredMipFace(level);
     if (mipFace && mipFace->_sysmem.getSize()) {
-        return evalMipWidth(level) * evalMipHeight(level) * evalMipDepth(level) * getTexelFormat().getSize();
+        return evalMipFaceSize(level);
     }
     return 0;
 }
@@ -277,16 +277,21 @@ public:
     uint16 evalMipHeight(uint16 level) const { return std::max(_height >> level, 1); }
     uint16 evalMipDepth(uint16 level) const { return std::max(_depth >> level, 1); }
 
+    // Size of a block of texels in a given format, rounded up to whole 4x4 blocks if the format is compressed
+    static uint32 evalTexelsSize(const Element& format, uint16 width, uint16 height, uint16 depth);
+
     // Size for each face of a mip at a particular level
     uint32 evalMipFaceNumTexels(uint16 level) const { return evalMipWidth(level) * evalMipHeight(level) * evalMipDepth(level); }
-    uint32 evalMipFaceSize(uint16 level) const { return evalMipFaceNumTexels(level) * getTexelFormat().getSize(); }
+    uint32 evalMipFaceSize(uint16 level) const { return evalStoredMipFaceSize(level, getTexelFormat()); }
     
     // Total size for the mip
     uint32 evalMipNumTexels(uint16 level) const { return evalMipFaceNumTexels(level) * getNumFaces(); }
-    uint32 evalMipSize(uint16 level) const { return evalMipNumTexels(level) * getTexelFormat().getSize(); }
+    uint32 evalMipSize(uint16 level) const { return evalStoredMipSize(level, getTexelFormat()); }
 
-    uint32 evalStoredMipFaceSize(uint16 level, const Element& format) const { return evalMipFaceNumTexels(level) * format.getSize(); }
-    uint32 evalStoredMipSize(uint16 level, const Element& format) const { return evalMipNumTexels(level) * format.getSize(); }
+    uint32 evalStoredMipFaceSize(uint16 level, const Element& format) const {
+        return evalTexelsSize(format, evalMipWidth(level), evalMipHeight(level), evalMipDepth(level));
+    }
+    uint32 evalStoredMipSize(uint16 level, const Element& format) const { return evalStoredMipFaceSize(level, format) * getNumFaces(); }
 
     uint32 evalTotalSize() const {
         uint32 size = 0;
@@ -386,6 +391,9 @@ protected:
 
     Size resize(Type type, const Element& texelFormat, uint16 width, uint16 height, uint16 depth, uint16 numSamples, uint16 numSlices);
 
+    // Keeps maxMip at the deepest level assigned when the mips aren't generated
+    void updateStoredMaxMip(uint16 level);
+
     // This shouldn't be used by anything else than the Backend class with the proper casting.
     mutable GPUObject* _gpuObject = NULL;
     void setGPUObject(GPUObject* gpuObject) const { _gpuObject = gpuObject; }
@@ -0,0 +1,515 @@
+//
+//  TextureProcessing.cpp
+//  libraries/gpu/src/gpu
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXTURE_PROCESSING_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#include "TextureProcessing.h"
+
+using namespace gpu;
+
+TexelImage::TexelImage(int width, int height, int channels) :
+    _width(width),
+    _height(height),
+    _channels(channels),
+    _bytesPerLine(evalBytesPerLine(width, channels)),
+    _bytes(_bytesPerLine * height) {
+}
+
+TexelImage::TexelImage(int width, int height, int channels, int bytesPerLine, const Byte* bytes) :
+    _width(width),
+    _height(height),
+    _channels(channels),
+    _bytesPerLine(evalBytesPerLine(width, channels)),
+    _bytes(_bytesPerLine * height) {
+
+    for (int y = 0; y < height; y++) {
+        memcpy(editScanLine(y), bytes + y * bytesPerLine, width * channels);
+    }
+}
+
+// only the color channels are ever stored as sRGB; alpha is always linear
+static bool isSRGBChannel(bool sRGB, int channel) {
+    const int ALPHA_CHANNEL = 3;
+    return sRGB && channel != ALPHA_CHANNEL;
+}
+
+static const float* getSRGBToLinearTable() {
+    static std::vector<float> table;
+    static std::once_flag once;
+    std::call_once(once, [] {
+        const int TABLE_SIZE = 256;
+        table.resize(TABLE_SIZE);
+        for (int i = 0; i < TABLE_SIZE; i++) {
+            float value = i / 255.0f;
+            table[i] = (value <= 0.04045f) ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+        }
+    });
+    return table.data();
+}
+
+// a step finer than the darkest sRGB values are apart, so that converting back to sRGB loses nothing
+const int LINEAR_TO_SRGB_STEPS = 4096;
+
+static const Byte* getLinearToSRGBTable() {
+    static std::vector<Byte> table;
+    static std::once_flag once;
+    std::call_once(once, [] {
+        table.resize(LINEAR_TO_SRGB_STEPS + 1);
+        for (int i = 0; i <= LINEAR_TO_SRGB_STEPS; i++) {
+            float value = i / (float)LINEAR_TO_SRGB_STEPS;
+            float encoded = (value <= 0.0031308f) ? value * 12.92f : 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+            table[i] = (Byte)(encoded * 255.0f + 0.5f);
+        }
+    });
+    return table.data();
+}
+
+static float decodeChannel(Byte value, bool sRGB, int channel) {
+    return isSRGBChannel(sRGB, channel) ? getSRGBToLinearTable()[value] : value / 255.0f;
+}
+
+static Byte encodeChannel(float value, bool sRGB, int channel) {
+    value = std::min(std::max(value, 0.0f), 1.0f);
+    if (isSRGBChannel(sRGB, channel)) {
+        return getLinearToSRGBTable()[(int)(value * LINEAR_TO_SRGB_STEPS + 0.5f)];
+    }
+    return (Byte)(value * 255.0f + 0.5f);
+}
+
+TexelImage gpu::resampleImage(const TexelImage& image, int width, int height, bool sRGB) {
+    int channels = image.getChannels();
+    int rowSize = width * channels;
+
+    // first across each row, into linear values...
+    std::vector<float> rows(image.getHeight() * rowSize);
+    float xScale = image.getWidth() / (float)width;
+    for (int y = 0; y < image.getHeight(); y++) {
+        const Byte* source = image.getScanLine(y);
+        float* dest = rows.data() + y * rowSize;
+        for (int x = 0; x < width; x++) {
+            float start = x * xScale;
+            float end = start + xScale;
+            int last = std::min((int)ceilf(end), image.getWidth());
+            for (int i = (int)start; i < last; i++) {
+                float weight = std::min(i + 1.0f, end) - std::max((float)i, start);
+                for (int c = 0; c < channels; c++) {
+                    dest[x * channels + c] += weight * decodeChannel(source[i * channels + c], sRGB, c);
+                }
+            }
+            for (int c = 0; c < channels; c++) {
+                dest[x * channels + c] /= xScale;
+            }
+        }
+    }
+
+    // ...then down each column of the rows
+    TexelImage resampled(width, height, channels);
+    float yScale = image.getHeight() / (float)height;
+    std::vector<float> sums(rowSize);
+    for (int y = 0; y < height; y++) {
+        std::fill(sums.begin(), sums.end(), 0.0f);
+        float start = y * yScale;
+        float end = start + yScale;
+        int last = std::min((int)ceilf(end), image.getHeight());
+        for (int i = (int)start; i < last; i++) {
+            float weight = std::min(i + 1.0f, end) - std::max((float)i, start);
+            const float* row = rows.data() + i * rowSize;
+            for (int j = 0; j < rowSize; j++) {
+                sums[j] += weight * row[j];
+            }
+        }
+        Byte* dest = resampled.editScanLine(y);
+        for (int j = 0; j < rowSize; j++) {
+            dest[j] = encodeChannel(sums[j] / yScale, sRGB, j % channels);
+        }
+    }
+    return resampled;
+}
+
+#ifdef TEXTURE_PROCESSING_SSE2
+
+// Averages 2x2 blocks of four channel texels from two rows, two destination texels at a time, and returns how many
+// destination texels that covered.
+static int downsampleRowSSE2(const Byte* row0, const Byte* row1, Byte* dest, int width) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rounding = _mm_set1_epi16(2);
+    const int TEXELS_PER_STEP = 2;
+    const int BYTES_PER_TEXEL = 4;
+    int x = 0;
+    for (; x + TEXELS_PER_STEP <= width; x += TEXELS_PER_STEP) {
+        __m128i top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 2 * BYTES_PER_TEXEL));
+        __m128i bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 2 * BYTES_PER_TEXEL));
+
+        // widen to 16 bits and add the rows: source texels 0 and 1 in the low half, 2 and 3 in the high
+        __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+        __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+
+        // then add neighboring texels: 0 + 1 and 2 + 3
+        __m128i sums = _mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high));
+        __m128i averages = _mm_srli_epi16(_mm_add_epi16(sums, rounding), 2);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest + x * BYTES_PER_TEXEL), _mm_packus_epi16(averages, averages));
+    }
+    return x;
+}
+
+#endif
+
+TexelImage gpu::downsampleImage(const TexelImage& image, bool sRGB) {
+    int width = std::max(image.getWidth() / 2, 1);
+    int height = std::max(image.getHeight() / 2, 1);
+    int channels = image.getChannels();
+    TexelImage mip(width, height, channels);
+
+    // an odd last row or column is left out, except where it's all there is
+    int lastX = image.getWidth() - 1;
+    int lastY = image.getHeight() - 1;
+    for (int y = 0; y < height; y++) {
+        const Byte* row0 = image.getScanLine(std::min(y * 2, lastY));
+        const Byte* row1 = image.getScanLine(std::min(y * 2 + 1, lastY));
+        Byte* dest = mip.editScanLine(y);
+        int x = 0;
+#ifdef TEXTURE_PROCESSING_SSE2
+        const int SSE2_CHANNELS = 4;
+        if (!sRGB && channels == SSE2_CHANNELS && image.getWidth() > 1) {
+            x = downsampleRowSSE2(row0, row1, dest, width);
+        }
+#endif
+        for (; x < width; x++) {
+            int left = std::min(x * 2, lastX) * channels;
+            int right = std::min(x * 2 + 1, lastX) * channels;
+            for (int c = 0; c < channels; c++) {
+                if (isSRGBChannel(sRGB, c)) {
+                    float sum = decodeChannel(row0[left + c], true, c) + decodeChannel(row0[right + c], true, c) +
+                        decodeChannel(row1[left + c], true, c) + decodeChannel(row1[right + c], true, c);
+                    dest[x * channels + c] = encodeChannel(sum * 0.25f, true, c);
+                } else {
+                    dest[x * channels + c] = (row0[left + c] + row0[right + c] + row1[left + c] + row1[right + c] + 2) >> 2;
+                }
+            }
+        }
+    }
+    return mip;
+}
+
+std::vector<TexelImage> gpu::generateMips(const TexelImage& image, bool sRGB) {
+    std::vector<TexelImage> mips;
+    const TexelImage* previous = &image;
+    while (previous->getWidth() > 1 || previous->getHeight() > 1) {
+        mips.push_back(downsampleImage(*previous, sRGB));
+        previous = &mips.back();
+    }
+    return mips;
+}
+
+const int BLOCK_DIMENSION = 4;
+const int TEXELS_PER_BLOCK = BLOCK_DIMENSION * BLOCK_DIMENSION;
+
+static bool isPowerOfTwo(int value) {
+    return value > 0 && (value & (value - 1)) == 0;
+}
+
+bool gpu::isCompressible(int width, int height) {
+    return width >= BLOCK_DIMENSION && height >= BLOCK_DIMENSION && isPowerOfTwo(width) && isPowerOfTwo(height);
+}
+
+typedef Byte BlockTexels[TEXELS_PER_BLOCK][4];
+
+static uint16 packColor565(const float* color) {
+    int red = (int)(color[0] * 31.0f / 255.0f + 0.5f);
+    int green = (int)(color[1] * 63.0f / 255.0f + 0.5f);
+    int blue = (int)(color[2] * 31.0f / 255.0f + 0.5f);
+    return (uint16)((red << 11) | (green << 5) | blue);
+}
+
+static void unpackColor565(uint16 packed, int* color) {
+    int red = (packed >> 11) & 0x1F;
+    int green = (packed >> 5) & 0x3F;
+    int blue = packed & 0x1F;
+    color[0] = (red << 3) | (red >> 2);
+    color[1] = (green << 2) | (green >> 4);
+    color[2] = (blue << 3) | (blue >> 2);
+}
+
+// Picks the nearest of the four colors between color0 and color1 for each texel, returning the summed squared error.
+static int chooseColorIndices(const BlockTexels& texels, uint16 color0, uint16 color1, uint32& indices) {
+    indices = 0;
+    int palette[4][3];
+    unpackColor565(color0, palette[0]);
+    unpackColor565(color1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+    int totalDistance = 0;
+    for (int i = 0; i < TEXELS_PER_BLOCK; i++) {
+        int bestIndex = 0;
+        int bestDistance = INT_MAX;
+        for (int j = 0; j < 4; j++) {
+            int red = texels[i][0] - palette[j][0];
+            int green = texels[i][1] - palette[j][1];
+            int blue = texels[i][2] - palette[j][2];
+            int distance = red * red + green * green + blue * blue;
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                bestIndex = j;
+            }
+        }
+        indices |= (uint32)bestIndex << (i * 2);
+        totalDistance += bestDistance;
+    }
+    return totalDistance;
+}
+
+// Orders the colors so that the block uses four colors rather than three and transparent black, and picks the indices.
+static int encodeColors(const BlockTexels& texels, const float* start, const float* end, uint16& color0,
+        uint16& color1, uint32& indices) {
+    color0 = packColor565(start);
+    color1 = packColor565(end);
+    if (color0 < color1) {
+        std::swap(color0, color1);
+    }
+    if (color0 == color1) {
+        indices = 0;
+        int palette[3];
+        unpackColor565(color0, palette);
+        int totalDistance = 0;
+        for (int i = 0; i < TEXELS_PER_BLOCK; i++) {
+            for (int c = 0; c < 3; c++) {
+                totalDistance += (texels[i][c] - palette[c]) * (texels[i][c] - palette[c]);
+            }
+        }
+        return totalDistance;
+    }
+    return chooseColorIndices(texels, color0, color1, indices);
+}
+
+// Fits the colors with a line along their principal axis, clipped to the extremes of the texels along it.
+static void compressColorBlock(const BlockTexels& texels, Byte* block) {
+    float mean[3] = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < TEXELS_PER_BLOCK; i++) {
+        for (int c = 0; c < 3; c++) {
+            mean[c] += texels[i][c];
+        }
+    }
+    for (int c = 0; c < 3; c++) {
+        mean[c] /= TEXELS_PER_BLOCK;
+    }
+    float covariance[3][3] = { { 0.0f } };
+    for (int i = 0; i < TEXELS_PER_BLOCK; i++) {
+        float offset[3] = { texels[i][0] - mean[0], texels[i][1] - mean[1], texels[i][2] - mean[2] };
+        for (int j = 0; j < 3; j++) {
+            for (int k = 0; k < 3; k++) {
+                covariance[j][k] += offset[j] * offset[k];
+            }
+        }
+    }
+
+    // a few rounds of power iteration find the principal axis closely enough
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    const int POWER_ITERATIONS = 8;
+    for (int iteration = 0; iteration < POWER_ITERATIONS; iteration++) {
+        float next[3];
+        for (int j = 0; j < 3; j++) {
+            next[j] = covariance[j][0] * axis[0] + covariance[j][1] * axis[1] + covariance[j][2] * axis[2];
+        }
+        float length = std::max(std::max(fabsf(next[0]), fabsf(next[1])), fabsf(next[2]));
+        if (length == 0.0f) {
+            break;
+        }
+        for (int j = 0; j < 3; j++) {
+            axis[j] = next[j] / length;
+        }
+    }
+    float minimum = 0.0f, maximum = 0.0f;
+    for (int i = 0; i < TEXELS_PER_BLOCK; i++) {
+        float projection = (texels[i][0] - mean[0]) * axis[0] + (texels[i][1] - mean[1]) * axis[1] +
+            (texels[i][2] - mean[2]) * axis[2];
+        minimum = std::min(minimum, projection);
+        maximum = std::max(maximum, projection);
+    }
+
+    // pull the ends in a little, since the texels at the extremes are usually closer to the interpolated colors
+    const float INSET_PROPORTION = 1.0f / 16.0f;
+    float inset = (maximum - minimum) * INSET_PROPORTION;
+    float axisLengthSquared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    if (axisLengthSquared > 0.0f) {
+        minimum = (minimum + inset) / axisLengthSquared;
+        maximum = (maximum - inset) / axisLengthSquared;
+    }
+    float start[3], end[3];
+    for (int c = 0; c < 3; c++) {
+        start[c] = std::min(std::max(mean[c] + axis[c] * maximum, 0.0f), 255.0f);
+        end[c] = std::min(std::max(mean[c] + axis[c] * minimum, 0.0f), 255.0f);
+    }
+    uint16 color0, color1;
+    uint32 indices;
+    int distance = encodeColors(texels, start, end, color0, color1, indices);
+
+    // once the texels have picked their colors, the ends that fit those picks best can be solved for directly, which
+    // matters most when the inset has pulled the ends away from a block of only a few distinct colors
+    if (color0 != color1) {
+        const float WEIGHTS[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ax[3] = { 0.0f, 0.0f, 0.0f }, bx[3] = { 0.0f, 0.0f, 0.0f };
+        for (int i = 0; i < TEXELS_PER_BLOCK; i++) {
+            float a = WEIGHTS[(indices >> (i * 2)) & 0x3];
+            float b = 1.0f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int c = 0; c < 3; c++) {
+                ax[c] += a * texels[i][c];
+                bx[c] += b * texels[i][c];
+            }
+        }
+        float determinant = aa * bb - ab * ab;
+        if (determinant > 0.0f) {
+            float refinedStart[3], refinedEnd[3];
+            for (int c = 0; c < 3; c++) {
+                refinedStart[c] = std::min(std::max((bb * ax[c] - ab * bx[c]) / determinant, 0.0f), 255.0f);
+                refinedEnd[c] = std::min(std::max((aa * bx[c] - ab * ax[c]) / determinant, 0.0f), 255.0f);
+            }
+            uint16 refinedColor0, refinedColor1;
+            uint32 refinedIndices;
+            if (encodeColors(texels, refinedStart, refinedEnd, refinedColor0, refinedColor1, refinedIndices) < distance) {
+                color0 = refinedColor0;
+                color1 = refinedColor1;
+                indices = refinedIndices;
+            }
+        }
+    }
+    block[0] = color0 & 0xFF;
+    block[1] = color0 >> 8;
+    block[2] = color1 & 0xFF;
+    block[3] = color1 >> 8;
+    for (int i = 0; i < 4; i++) {
+        block[4 + i] = (indices >> (i * 8)) & 0xFF;
+    }
+}
+
+static void compressAlphaBlock(const BlockTexels& texels, Byte* block) {
+    const int ALPHA_CHANNEL = 3;
+    int alpha0 = 0, alpha1 = 255;
+    for (int i = 0; i < TEXELS_PER_BLOCK; i++) {
+        alpha0 = std::max(alpha0, (int)texels[i][ALPHA_CHANNEL]);
+        alpha1 = std::min(alpha1, (int)texels[i][ALPHA_CHANNEL]);
+    }
+    uint64_t indices = 0;
+    if (alpha0 != alpha1) {
+        // with the first alpha greater, the block interpolates six alphas between the two
+        const int NUM_ALPHAS = 8;
+        int palette[NUM_ALPHAS] = { alpha0, alpha1 };
+        for (int j = 1; j < NUM_ALPHAS - 1; j++) {
+            palette[j + 1] = ((NUM_ALPHAS - 1 - j) * alpha0 + j * alpha1) / (NUM_ALPHAS - 1);
+        }
+        for (int i = 0; i < TEXELS_PER_BLOCK; i++) {
+            int bestIndex = 0;
+            int bestDistance = INT_MAX;
+            for (int j = 0; j < NUM_ALPHAS; j++) {
+                int distance = abs(texels[i][ALPHA_CHANNEL] - palette[j]);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    bestIndex = j;
+                }
+            }
+            indices |= (uint64_t)bestIndex << (i * 3);
+        }
+    }
+    block[0] = alpha0;
+    block[1] = alpha1;
+    for (int i = 0; i < 6; i++) {
+        block[2 + i] = (indices >> (i * 8)) & 0xFF;
+    }
+}
+
+std::vector<Byte> gpu::compressImage(const TexelImage& image, bool bgr) {
+    int channels = image.getChannels();
+    bool hasAlpha = (channels == 4);
+    int blockSize = hasAlpha ? 16 : 8;
+    int blocksWide = (image.getWidth() + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+    int blocksHigh = (image.getHeight() + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+    std::vector<Byte> blocks(blocksWide * blocksHigh * blockSize);
+    Byte* block = blocks.data();
+    int red = bgr ? 2 : 0;
+    int blue = bgr ? 0 : 2;
+    for (int blockY = 0; blockY < blocksHigh; blockY++) {
+        for (int blockX = 0; blockX < blocksWide; blockX++) {
+            BlockTexels texels;
+            for (int y = 0; y < BLOCK_DIMENSION; y++) {
+                const Byte* row = image.getScanLine(std::min(blockY * BLOCK_DIMENSION + y, image.getHeight() - 1));
+                for (int x = 0; x < BLOCK_DIMENSION; x++) {
+                    const Byte* texel = row + std::min(blockX * BLOCK_DIMENSION + x, image.getWidth() - 1) * channels;
+                    Byte* blockTexel = texels[y * BLOCK_DIMENSION + x];
+                    blockTexel[0] = texel[red];
+                    blockTexel[1] = texel[1];
+                    blockTexel[2] = texel[blue];
+                    blockTexel[3] = hasAlpha ? texel[3] : 255;
+                }
+            }
+            if (hasAlpha) {
+                compressAlphaBlock(texels, block);
+                block += 8;
+            }
+            compressColorBlock(texels, block);
+            block += 8;
+        }
+    }
+    return blocks;
+}
+
+static void assignMipFace(Texture* texture, uint16 level, uint8 face, const TexelImage& image, const Element& format,
+                          bool compress, bool bgr) {
+    if (compress) {
+        std::vector<Byte> blocks = compressImage(image, bgr);
+        texture->assignStoredMipFace(level, format, blocks.size(), blocks.data(), face);
+    } else {
+        texture->assignStoredMipFace(level, format, image.getBytes().size(), image.getBytes().data(), face);
+    }
+}
+
+Texture* gpu::createMippedTexture(Texture::Type type, const std::vector<TexelImage>& faces, const Element& texelFormat,
+                                  const Element& mipFormat, bool compress, const Sampler& sampler) {
+    if (faces.empty()) {
+        return nullptr;
+    }
+    const TexelImage& first = faces.front();
+    bool sRGB = (texelFormat.getSemantic() == SRGB || texelFormat.getSemantic() == SRGBA);
+    bool bgr = (mipFormat.getSemantic() == BGRA || mipFormat.getSemantic() == SBGRA);
+
+    Element storedTexelFormat = texelFormat;
+    Element storedMipFormat = mipFormat;
+    compress = compress && isCompressible(first.getWidth(), first.getHeight());
+    if (compress) {
+        Semantic semantic = (first.getChannels() == 4) ? (sRGB ? COMPRESSED_BC3_SRGBA : COMPRESSED_BC3_RGBA) :
+            (sRGB ? COMPRESSED_BC1_SRGB : COMPRESSED_BC1_RGB);
+        storedTexelFormat = storedMipFormat = Element(texelFormat.getDimension(), texelFormat.getType(), semantic);
+    }
+    Texture* texture = (type == Texture::TEX_CUBE) ? Texture::createCube(storedTexelFormat, first.getWidth(), sampler) :
+        Texture::create2D(storedTexelFormat, first.getWidth(), first.getHeight(), sampler);
+
+    for (size_t face = 0; face < faces.size(); face++) {
+        assignMipFace(texture, 0, face, faces.at(face), storedMipFormat, compress, bgr);
+        std::vector<TexelImage> mips = generateMips(faces.at(face), sRGB);
+        for (size_t i = 0; i < mips.size(); i++) {
+            assignMipFace(texture, i + 1, face, mips.at(i), storedMipFormat, compress, bgr);
+        }
+    }
+    return texture;
+}
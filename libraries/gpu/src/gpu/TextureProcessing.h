@@ -0,0 +1,76 @@
+//
+//  TextureProcessing.h
+//  libraries/gpu/src/gpu
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Resizes, mipmaps and block compresses texels on the CPU, so that textures arrive at the GPU with every level ready.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_gpu_TextureProcessing_h
+#define hifi_gpu_TextureProcessing_h
+
+#include <vector>
+
+#include "Texture.h"
+
+namespace gpu {
+
+// Texels with 8 bits per channel and their rows padded out to four bytes, as QImage lays them out and as GL unpacks them
+// by default.
+class TexelImage {
+public:
+    TexelImage(int width = 0, int height = 0, int channels = 4);
+
+    // Copies the texels from rows bytesPerLine apart
+    TexelImage(int width, int height, int channels, int bytesPerLine, const Byte* bytes);
+
+    static int evalBytesPerLine(int width, int channels) { return (width * channels + 3) & ~3; }
+
+    int getWidth() const { return _width; }
+    int getHeight() const { return _height; }
+    int getChannels() const { return _channels; }
+    int getBytesPerLine() const { return _bytesPerLine; }
+
+    Byte* editScanLine(int y) { return _bytes.data() + y * _bytesPerLine; }
+    const Byte* getScanLine(int y) const { return _bytes.data() + y * _bytesPerLine; }
+
+    const std::vector<Byte>& getBytes() const { return _bytes; }
+
+private:
+    int _width;
+    int _height;
+    int _channels;
+    int _bytesPerLine;
+    std::vector<Byte> _bytes;
+};
+
+// Scales the image down to width x height, each texel the average of all those it covers. sRGB texels are averaged as
+// linear colors; the fourth channel, if any, is always treated as linear alpha.
+TexelImage resampleImage(const TexelImage& image, int width, int height, bool sRGB);
+
+// Halves the image in each dimension bigger than one texel, as the next level of its mip chain: a 2x2 box filter, with
+// four channel linear texels averaged using SSE2 where it's available.
+TexelImage downsampleImage(const TexelImage& image, bool sRGB);
+
+// Every level of the image's mip chain after the first, down to 1x1.
+std::vector<TexelImage> generateMips(const TexelImage& image, bool sRGB);
+
+// Whether a level zero of this size compresses into whole blocks all the way down its chain.
+bool isCompressible(int width, int height);
+
+// Compresses three channel images to BC1 and four channel ones to BC3, padding any partial blocks with their edge texels.
+// bgr says that the texels store blue first, as BGRA mips do.
+std::vector<Byte> compressImage(const TexelImage& image, bool bgr);
+
+// Creates a 2D or cube texture (from one face or six) with its whole mip chain assigned, rather than generated by the
+// GPU, and with every level block compressed if asked for and the size allows.
+Texture* createMippedTexture(Texture::Type type, const std::vector<TexelImage>& faces, const Element& texelFormat,
+                             const Element& mipFormat, bool compress, const Sampler& sampler = Sampler());
+
+};
+
+#endif
@@ -0,0 +1,363 @@
+//
+//  AssetCache.cpp
+//  libraries/networking/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QTemporaryFile>
+
+#include "NetworkLogging.h"
+
+#include "AssetCache.h"
+
+// bump this whenever what the records hold changes, so that older ones are discarded
+static const quint32 RECORD_VERSION = 1;
+
+static const QString RECORDS_DIRECTORY = "records";
+static const QString CONTENT_DIRECTORY = "content";
+static const QString INCOMING_DIRECTORY = "incoming";
+
+AssetCache::AssetCache(const QString& directory, qint64 maximumSize) :
+    _directory(directory),
+    _maximumSize(maximumSize) {
+
+    QDir dir;
+    if (!(dir.mkpath(_directory + "/" + RECORDS_DIRECTORY) && dir.mkpath(_directory + "/" + CONTENT_DIRECTORY) &&
+            dir.mkpath(_directory + "/" + INCOMING_DIRECTORY))) {
+        qCWarning(networking) << "Couldn't create asset cache directories in" << _directory;
+    }
+    loadRecords();
+}
+
+void AssetCache::setMaximumSize(qint64 maximumSize) {
+    QMutexLocker locker(&_mutex);
+    _maximumSize = maximumSize;
+    reserve(0);
+}
+
+qint64 AssetCache::getSize() const {
+    QMutexLocker locker(&_mutex);
+    return _size;
+}
+
+int AssetCache::getRecordCount() const {
+    QMutexLocker locker(&_mutex);
+    return _records.size();
+}
+
+int AssetCache::getContentCount() const {
+    QMutexLocker locker(&_mutex);
+    return _contents.size();
+}
+
+QNetworkCacheMetaData AssetCache::getMetaData(const QUrl& url) {
+    QMutexLocker locker(&_mutex);
+    QHash<QUrl, Record>::const_iterator it = _records.constFind(url);
+    return (it == _records.constEnd()) ? QNetworkCacheMetaData() : it->metaData;
+}
+
+void AssetCache::updateMetaData(const QNetworkCacheMetaData& metaData) {
+    QMutexLocker locker(&_mutex);
+    QHash<QUrl, Record>::iterator it = _records.find(metaData.url());
+    if (it == _records.end()) {
+        return;
+    }
+    it->metaData = metaData;
+    touchRecord(*it);
+    writeRecord(metaData.url(), *it);
+}
+
+QIODevice* AssetCache::getData(const QUrl& url) {
+    QString path;
+    {
+        QMutexLocker locker(&_mutex);
+        QHash<QUrl, Record>::iterator it = _records.find(url);
+        if (it == _records.end()) {
+            return nullptr;
+        }
+        touchRecord(*it);
+        path = getContentPath(it->contentHash);
+    }
+    QFile* file = new QFile(path);
+    if (!file->open(QIODevice::ReadOnly)) {
+        qCDebug(networking) << "Discarding cached" << url << "with missing content:" << file->errorString();
+        delete file;
+        remove(url);
+        return nullptr;
+    }
+    QBuffer* buffer = new QBuffer();
+    uchar* mapped = file->map(0, file->size());
+    if (mapped) {
+        // the buffer reads the mapping in place, and the file (with its mapping) lives as long as the buffer
+        file->setParent(buffer);
+        buffer->setData(QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), file->size()));
+
+    } else {
+        buffer->setData(file->readAll());
+        delete file;
+    }
+    buffer->open(QIODevice::ReadOnly);
+    return buffer;
+}
+
+QFile* AssetCache::createIncomingFile() {
+    QTemporaryFile* file = new QTemporaryFile(_directory + "/" + INCOMING_DIRECTORY + "/XXXXXX");
+    if (!file->open()) {
+        qCWarning(networking) << "Couldn't create incoming asset file:" << file->errorString();
+        delete file;
+        return nullptr;
+    }
+    return file;
+}
+
+void AssetCache::insert(const QNetworkCacheMetaData& metaData, QFile* file) {
+    // hash outside the lock; the file is ours alone until it's moved into place
+    file->flush();
+    file->seek(0);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(file);
+    QByteArray contentHash = hash.result();
+    qint64 size = file->size();
+    file->close();
+
+    QMutexLocker locker(&_mutex);
+    if (size > _maximumSize) {
+        file->remove();
+        return;
+    }
+    QHash<QByteArray, Content>::iterator content = _contents.find(contentHash);
+    if (content == _contents.end()) {
+        QString contentPath = getContentPath(contentHash);
+        QFile::remove(contentPath);
+        if (!QFile::rename(file->fileName(), contentPath)) {
+            qCWarning(networking) << "Couldn't move" << file->fileName() << "into the asset cache as" << contentPath;
+            file->remove();
+            return;
+        }
+        Content newContent = { size, 0 };
+        content = _contents.insert(contentHash, newContent);
+        _size += size;
+
+    } else {
+        // identical content is already stored for another URL (or an earlier version of this one)
+        file->remove();
+    }
+
+    // hold on to the content while the URL's previous record, which may share it, is removed
+    content->references++;
+    removeRecord(metaData.url());
+    Record record = { metaData, contentHash, 0 };
+    addRecord(metaData.url(), record);
+    writeRecord(metaData.url(), record);
+    _contents[contentHash].references--;
+
+    reserve(0);
+}
+
+bool AssetCache::remove(const QUrl& url) {
+    QMutexLocker locker(&_mutex);
+    if (!_records.contains(url)) {
+        return false;
+    }
+    removeRecord(url);
+    return true;
+}
+
+void AssetCache::clear() {
+    QMutexLocker locker(&_mutex);
+    foreach (const QUrl& url, _records.keys()) {
+        removeRecord(url);
+    }
+}
+
+void AssetCache::loadRecords() {
+    // oldest first, so that the order of use carries over (approximately) from one run to the next
+    QDir recordsDir(_directory + "/" + RECORDS_DIRECTORY);
+    foreach (const QFileInfo& info, recordsDir.entryInfoList(QDir::Files, QDir::Time | QDir::Reversed)) {
+        QFile file(info.filePath());
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        QDataStream in(&file);
+        quint32 version = 0;
+        QUrl url;
+        Record record = { QNetworkCacheMetaData(), QByteArray(), 0 };
+        in >> version;
+        if (version == RECORD_VERSION) {
+            in >> url >> record.metaData >> record.contentHash;
+        }
+        file.close();
+
+        QFileInfo contentInfo(getContentPath(record.contentHash));
+        if (version != RECORD_VERSION || in.status() != QDataStream::Ok || !url.isValid() ||
+                record.metaData.url() != url || QFileInfo(getRecordPath(url)).fileName() != info.fileName() ||
+                !contentInfo.exists()) {
+            file.remove();
+            continue;
+        }
+        QHash<QByteArray, Content>::iterator content = _contents.find(record.contentHash);
+        if (content == _contents.end()) {
+            Content newContent = { contentInfo.size(), 0 };
+            _contents.insert(record.contentHash, newContent);
+            _size += newContent.size;
+        }
+        addRecord(url, record);
+    }
+
+    // content no record refers to was orphaned by a crash, as were any incoming files
+    QDir contentDir(_directory + "/" + CONTENT_DIRECTORY);
+    foreach (const QString& name, contentDir.entryList(QDir::Files)) {
+        if (!_contents.contains(QByteArray::fromHex(name.toLatin1()))) {
+            contentDir.remove(name);
+        }
+    }
+    QDir incomingDir(_directory + "/" + INCOMING_DIRECTORY);
+    foreach (const QString& name, incomingDir.entryList(QDir::Files)) {
+        incomingDir.remove(name);
+    }
+
+    qCDebug(networking) << "Asset cache in" << _directory << "holds" << _records.size() << "URLs," << _contents.size()
+        << "distinct assets," << _size << "bytes";
+    reserve(0);
+}
+
+bool AssetCache::writeRecord(const QUrl& url, const Record& record) {
+    // written to the side and renamed into place, so that a crash never leaves half a record
+    QSaveFile file(getRecordPath(url));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(networking) << "Couldn't write asset cache record for" << url << ":" << file.errorString();
+        return false;
+    }
+    QDataStream out(&file);
+    out << RECORD_VERSION << url << record.metaData << record.contentHash;
+    return file.commit();
+}
+
+void AssetCache::addRecord(const QUrl& url, const Record& record) {
+    QHash<QUrl, Record>::iterator it = _records.insert(url, record);
+    it->lruKey = ++_lastLRUKey;
+    _lru.insert(it->lruKey, url);
+    _contents[record.contentHash].references++;
+}
+
+void AssetCache::removeRecord(const QUrl& url) {
+    QHash<QUrl, Record>::iterator it = _records.find(url);
+    if (it == _records.end()) {
+        return;
+    }
+    _lru.remove(it->lruKey);
+    QFile::remove(getRecordPath(url));
+
+    QHash<QByteArray, Content>::iterator content = _contents.find(it->contentHash);
+    if (content != _contents.end() && --content->references <= 0) {
+        // on Windows, this fails while the content is still mapped; the leftover is removed on the next run
+        QFile::remove(getContentPath(it->contentHash));
+        _size -= content->size;
+        _contents.erase(content);
+    }
+    _records.erase(it);
+}
+
+void AssetCache::touchRecord(Record& record) {
+    QUrl url = _lru.take(record.lruKey);
+    record.lruKey = ++_lastLRUKey;
+    _lru.insert(record.lruKey, url);
+}
+
+void AssetCache::reserve(qint64 size) {
+    while (!_lru.isEmpty() && _size + size > _maximumSize) {
+        removeRecord(_lru.begin().value());
+    }
+}
+
+QString AssetCache::getRecordPath(const QUrl& url) const {
+    return _directory + "/" + RECORDS_DIRECTORY + "/" +
+        QCryptographicHash::hash(url.toEncoded(), QCryptographicHash::Sha1).toHex();
+}
+
+QString AssetCache::getContentPath(const QByteArray& contentHash) const {
+    return _directory + "/" + CONTENT_DIRECTORY + "/" + contentHash.toHex();
+}
+
+AssetNetworkCache::AssetNetworkCache(const QSharedPointer<AssetCache>& cache, QObject* parent) :
+    QAbstractNetworkCache(parent),
+    _cache(cache) {
+}
+
+AssetNetworkCache::~AssetNetworkCache() {
+    foreach (QIODevice* device, _incoming.keys()) {
+        delete device;
+    }
+}
+
+QNetworkCacheMetaData AssetNetworkCache::metaData(const QUrl& url) {
+    return _cache->getMetaData(url);
+}
+
+void AssetNetworkCache::updateMetaData(const QNetworkCacheMetaData& metaData) {
+    _cache->updateMetaData(metaData);
+}
+
+QIODevice* AssetNetworkCache::data(const QUrl& url) {
+    return _cache->getData(url);
+}
+
+bool AssetNetworkCache::remove(const QUrl& url) {
+    // the access manager also calls this to abandon content it prepared but won't insert
+    bool removedIncoming = false;
+    foreach (QIODevice* device, _incoming.keys()) {
+        if (_incoming.value(device).url() == url) {
+            discardIncoming(device);
+            removedIncoming = true;
+        }
+    }
+    return _cache->remove(url) || removedIncoming;
+}
+
+qint64 AssetNetworkCache::cacheSize() const {
+    return _cache->getSize();
+}
+
+QIODevice* AssetNetworkCache::prepare(const QNetworkCacheMetaData& metaData) {
+    if (!(metaData.isValid() && metaData.url().isValid() && metaData.saveToDisk())) {
+        return nullptr;
+    }
+    QFile* file = _cache->createIncomingFile();
+    if (file) {
+        _incoming.insert(file, metaData);
+    }
+    return file;
+}
+
+void AssetNetworkCache::insert(QIODevice* device) {
+    QHash<QIODevice*, QNetworkCacheMetaData>::iterator it = _incoming.find(device);
+    if (it == _incoming.end()) {
+        return;
+    }
+    QNetworkCacheMetaData metaData = it.value();
+    _incoming.erase(it);
+    _cache->insert(metaData, static_cast<QFile*>(device));
+    delete device;
+}
+
+void AssetNetworkCache::clear() {
+    foreach (QIODevice* device, _incoming.keys()) {
+        discardIncoming(device);
+    }
+    _cache->clear();
+}
+
+void AssetNetworkCache::discardIncoming(QIODevice* device) {
+    _incoming.remove(device);
+    delete device;
+}
@@ -0,0 +1,132 @@
+//
+//  AssetCache.h
+//  libraries/networking/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  A persistent cache of downloaded assets, stored once per distinct content however many URLs serve it.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AssetCache_h
+#define hifi_AssetCache_h
+
+#include <QAbstractNetworkCache>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QUrl>
+
+class QFile;
+
+/// The cache's records and content on disk, shared by the network access managers of every thread. Each URL has a
+/// record holding its metadata and the hash of its content; content files are named by that hash, so identical assets
+/// served from different URLs are stored (and counted against the maximum size) only once. Once the cache grows past
+/// its maximum size, the least recently used records are evicted, along with any content no other record refers to.
+class AssetCache {
+public:
+
+    AssetCache(const QString& directory, qint64 maximumSize);
+
+    const QString& getDirectory() const { return _directory; }
+
+    void setMaximumSize(qint64 maximumSize);
+    qint64 getMaximumSize() const { return _maximumSize; }
+
+    /// Returns the total size of the content files.
+    qint64 getSize() const;
+
+    int getRecordCount() const;
+    int getContentCount() const;
+
+    QNetworkCacheMetaData getMetaData(const QUrl& url);
+    void updateMetaData(const QNetworkCacheMetaData& metaData);
+
+    /// Returns a device reading the URL's content straight out of a mapping of its file, or null if there is none. The
+    /// caller takes ownership.
+    QIODevice* getData(const QUrl& url);
+
+    /// Returns an open temporary file in the cache directory to receive content to insert.
+    QFile* createIncomingFile();
+
+    /// Stores the content written to an incoming file under the metadata's URL, moving the file into place unless
+    /// the same content is already stored. The caller still owns (and should delete) the file.
+    void insert(const QNetworkCacheMetaData& metaData, QFile* file);
+
+    bool remove(const QUrl& url);
+
+    void clear();
+
+private:
+
+    class Record {
+    public:
+        QNetworkCacheMetaData metaData;
+        QByteArray contentHash;
+        qint64 lruKey;
+    };
+
+    class Content {
+    public:
+        qint64 size;
+        int references;
+    };
+
+    void loadRecords();
+    bool writeRecord(const QUrl& url, const Record& record);
+
+    void addRecord(const QUrl& url, const Record& record);
+    void removeRecord(const QUrl& url);
+    void touchRecord(Record& record);
+
+    void reserve(qint64 size);
+
+    QString getRecordPath(const QUrl& url) const;
+    QString getContentPath(const QByteArray& contentHash) const;
+
+    QString _directory;
+    qint64 _maximumSize;
+
+    mutable QMutex _mutex;
+    QHash<QUrl, Record> _records;
+    QHash<QByteArray, Content> _contents;
+    QMap<qint64, QUrl> _lru;
+    qint64 _lastLRUKey = 0;
+    qint64 _size = 0;
+};
+
+/// The face of the shared asset cache given to one network access manager, which owns it and uses it from one thread.
+class AssetNetworkCache : public QAbstractNetworkCache {
+    Q_OBJECT
+
+public:
+
+    AssetNetworkCache(const QSharedPointer<AssetCache>& cache, QObject* parent = nullptr);
+    virtual ~AssetNetworkCache();
+
+    const QSharedPointer<AssetCache>& getCache() const { return _cache; }
+
+    virtual QNetworkCacheMetaData metaData(const QUrl& url);
+    virtual void updateMetaData(const QNetworkCacheMetaData& metaData);
+    virtual QIODevice* data(const QUrl& url);
+    virtual bool remove(const QUrl& url);
+    virtual qint64 cacheSize() const;
+    virtual QIODevice* prepare(const QNetworkCacheMetaData& metaData);
+    virtual void insert(QIODevice* device);
+
+public slots:
+
+    virtual void clear();
+
+private:
+
+    void discardIncoming(QIODevice* device);
+
+    QSharedPointer<AssetCache> _cache;
+    QHash<QIODevice*, QNetworkCacheMetaData> _incoming;
+};
+
+#endif // hifi_AssetCache_h
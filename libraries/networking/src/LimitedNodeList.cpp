@@ -87,6 +87,18 @@ LimitedNodeList::LimitedNodeList(unsigned short socketListenPort, unsigned short
     connect(silentNodeTimer, &QTimer::timeout, this, &LimitedNodeList::removeSilentNodes);
     silentNodeTimer->start(NODE_SILENCE_THRESHOLD_MSECS);
 
+    // send, retransmit and ack for reliable channels
+    const int RELIABLE_CHANNEL_UPDATE_INTERVAL_MSECS = 10;
+    QTimer* reliableChannelTimer = new QTimer(this);
+    connect(reliableChannelTimer, &QTimer::timeout, this, &LimitedNodeList::updateReliableChannels);
+    reliableChannelTimer->start(RELIABLE_CHANNEL_UPDATE_INTERVAL_MSECS);
+
+    // release what the bandwidth shapers are holding back as their buckets refill
+    const int SHAPED_DATAGRAM_FLUSH_INTERVAL_MSECS = 5;
+    QTimer* shapedDatagramTimer = new QTimer(this);
+    connect(shapedDatagramTimer, &QTimer::timeout, this, &LimitedNodeList::flushShapedDatagrams);
+    shapedDatagramTimer->start(SHAPED_DATAGRAM_FLUSH_INTERVAL_MSECS);
+
     // check the local socket right now
     updateLocalSockAddr();
 
@@ -288,17 +300,64 @@ qint64 LimitedNodeList::writeDatagram(const QByteArray& datagram,
             replaceHashInPacket(datagramCopy, destinationNode->getConnectionSecret(), packetType);
         }
 
-        emit dataSent(destinationNode->getType(), datagram.size());
-        auto bytesWritten = writeDatagram(datagramCopy, *destinationSockAddr);
-        // Keep track of per-destination-node bandwidth
-        destinationNode->recordBytesSent(bytesWritten);
-        return bytesWritten;
+        if (destinationNode->isBandwidthShaped()) {
+            return writeShapedDatagram(datagramCopy, destinationNode, *destinationSockAddr,
+                                       shapingPriorityForPacketType(packetType));
+        }
+
+        return writeVerifiedDatagram(datagramCopy, destinationNode, *destinationSockAddr);
     }
 
     // didn't have a destinationNode to send to, return 0
     return 0;
 }
 
+qint64 LimitedNodeList::writeVerifiedDatagram(const QByteArray& datagram, const SharedNodePointer& destinationNode,
+                                              const HifiSockAddr& destinationSockAddr) {
+    emit dataSent(destinationNode->getType(), datagram.size());
+    auto bytesWritten = writeDatagram(datagram, destinationSockAddr);
+    // Keep track of per-destination-node bandwidth
+    destinationNode->recordBytesSent(bytesWritten);
+    return bytesWritten;
+}
+
+qint64 LimitedNodeList::writeShapedDatagram(const QByteArray& datagram, const SharedNodePointer& destinationNode,
+                                            const HifiSockAddr& destinationSockAddr, ShapingPriority priority) {
+    quint64 now = usecTimestampNow();
+
+    // datagrams are written with the shaper locked so that two threads sending to this node can't reorder them
+    QMutexLocker locker(&destinationNode->getBandwidthShaperMutex());
+    NodeBandwidthShaper& shaper = destinationNode->getBandwidthShaper();
+
+    if (priority == UnshapedPriority) {
+        shaper.recordUnshapedBytes(datagram.size(), now);
+        return writeVerifiedDatagram(datagram, destinationNode, destinationSockAddr);
+    }
+
+    bool wasQueued = shaper.queueDatagram(datagram, destinationSockAddr, priority, now);
+    for (const auto& sendableDatagram : shaper.takeSendableDatagrams(now)) {
+        writeVerifiedDatagram(sendableDatagram.datagram, destinationNode, sendableDatagram.destinationSockAddr);
+    }
+
+    // a queued datagram counts as written, the shaper owns it now
+    return wasQueued ? datagram.size() : 0;
+}
+
+void LimitedNodeList::flushShapedDatagrams() {
+    quint64 now = usecTimestampNow();
+
+    eachNode([&](const SharedNodePointer& node) {
+        QMutexLocker locker(&node->getBandwidthShaperMutex());
+        NodeBandwidthShaper& shaper = node->getBandwidthShaper();
+
+        if (shaper.hasQueuedDatagrams()) {
+            for (const auto& sendableDatagram : shaper.takeSendableDatagrams(now)) {
+                writeVerifiedDatagram(sendableDatagram.datagram, node, sendableDatagram.destinationSockAddr);
+            }
+        }
+    });
+}
+
 qint64 LimitedNodeList::writeUnverifiedDatagram(const QByteArray& datagram, const SharedNodePointer& destinationNode,
                                const HifiSockAddr& overridenSockAddr) {
     if (destinationNode) {
@@ -358,12 +417,73 @@ PacketSequenceNumber LimitedNodeList::getNextSequenceNumberForPacket(const QUuid
     return _packetSequenceNumbers[nodeUUID][packetType]++;
 }
 
+void LimitedNodeList::sendReliableMessage(const QByteArray& message, const SharedNodePointer& destinationNode) {
+    if (destinationNode) {
+        QMutexLocker locker(&_reliableChannelsMutex);
+        _reliableChannels[destinationNode->getUUID()].queueMessage(message);
+    }
+}
+
+void LimitedNodeList::updateReliableChannels() {
+    std::vector<std::pair<QUuid, QByteArray>> outgoingPackets;
+
+    _reliableChannelsMutex.lock();
+    quint64 now = usecTimestampNow();
+    for (auto it = _reliableChannels.begin(); it != _reliableChannels.end(); ++it) {
+        ReliableMessageChannel& channel = it->second;
+        channel.update(now);
+
+        for (const QByteArray& payload : channel.takeOutgoingDataPayloads()) {
+            outgoingPackets.push_back(std::make_pair(it->first,
+                                                     byteArrayWithPopulatedHeader(PacketTypeReliableMessage) + payload));
+        }
+        for (const QByteArray& payload : channel.takeOutgoingAckPayloads()) {
+            outgoingPackets.push_back(std::make_pair(it->first,
+                                                     byteArrayWithPopulatedHeader(PacketTypeReliableMessageAck) + payload));
+        }
+    }
+    _reliableChannelsMutex.unlock();
+
+    for (const auto& outgoingPacket : outgoingPackets) {
+        SharedNodePointer destinationNode = nodeWithUUID(outgoingPacket.first);
+        if (destinationNode) {
+            writeDatagram(outgoingPacket.second, destinationNode);
+        }
+    }
+}
+
+void LimitedNodeList::processReliablePacket(const QByteArray& packet, const SharedNodePointer& sendingNode) {
+    PacketType packetType = packetTypeForPacket(packet);
+    QByteArray payload = packet.mid(numBytesForPacketHeader(packet));
+
+    std::vector<QByteArray> receivedMessages;
+
+    _reliableChannelsMutex.lock();
+    ReliableMessageChannel& channel = _reliableChannels[sendingNode->getUUID()];
+    if (packetType == PacketTypeReliableMessage) {
+        channel.processDataPayload(payload, usecTimestampNow());
+        receivedMessages = channel.takeReceivedMessages();
+    } else {
+        channel.processAckPayload(payload, usecTimestampNow());
+    }
+    _reliableChannelsMutex.unlock();
+
+    for (const QByteArray& message : receivedMessages) {
+        emit reliableMessageReceived(message, sendingNode);
+    }
+}
+
 void LimitedNodeList::processNodeData(const HifiSockAddr& senderSockAddr, const QByteArray& packet) {
     // the node decided not to do anything with this packet
     // if it comes from a known source we should keep that node alive
     SharedNodePointer matchingNode = sendingNodeForPacket(packet);
     if (matchingNode) {
         matchingNode->setLastHeardMicrostamp(usecTimestampNow());
+
+        PacketType packetType = packetTypeForPacket(packet);
+        if (packetType == PacketTypeReliableMessage || packetType == PacketTypeReliableMessageAck) {
+            processReliablePacket(packet, matchingNode);
+        }
     }
 }
 
@@ -467,6 +587,11 @@ void LimitedNodeList::processKillNode(const QByteArray& dataByteArray) {
 
 void LimitedNodeList::handleNodeKill(const SharedNodePointer& node) {
     qCDebug(networking) << "Killed" << *node;
+
+    _reliableChannelsMutex.lock();
+    _reliableChannels.erase(node->getUUID());
+    _reliableChannelsMutex.unlock();
+
     emit nodeKilled(node);
 }
 
@@ -22,6 +22,7 @@
 #endif
 
 #include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
 #include <QtCore/QPointer>
 #include <QtCore/QReadWriteLock>
 #include <QtCore/QSet>
@@ -37,6 +38,7 @@
 #include "DomainHandler.h"
 #include "Node.h"
 #include "PacketHeaders.h"
+#include "ReliableMessageChannel.h"
 #include "UUIDHasher.h"
 
 const int MAX_PACKET_SIZE = 1450;
@@ -141,6 +143,11 @@ public:
     qint64 writeUnverifiedDatagram(const char* data, qint64 size, const SharedNodePointer& destinationNode,
                          const HifiSockAddr& overridenSockAddr = HifiSockAddr());
 
+    /// Queue a packet (populated header included, up to DEFAULT_MAX_RELIABLE_MESSAGE_BYTES) for reliable, ordered and
+    /// congestion controlled delivery to destinationNode. The receiving node list emits it whole through
+    /// reliableMessageReceived(). Larger packets are dropped with a warning.
+    void sendReliableMessage(const QByteArray& message, const SharedNodePointer& destinationNode);
+
     void (*linkedDataCreateCallback)(Node *);
 
     int size() const { return _nodeHash.size(); }
@@ -243,6 +250,9 @@ public slots:
     virtual void sendSTUNRequest();
 
     void killNodeWithUUID(const QUuid& nodeUUID);
+
+    void updateReliableChannels();
+    void flushShapedDatagrams();
 signals:
     void uuidChanged(const QUuid& ownerUUID, const QUuid& oldUUID);
     void nodeAdded(SharedNodePointer);
@@ -259,12 +269,18 @@ signals:
 
     void packetVersionMismatch();
 
+    void reliableMessageReceived(const QByteArray& message, SharedNodePointer sendingNode);
+
 protected:
     LimitedNodeList(unsigned short socketListenPort = 0, unsigned short dtlsListenPort = 0);
     LimitedNodeList(LimitedNodeList const&); // Don't implement, needed to avoid copies of singleton
     void operator=(LimitedNodeList const&); // Don't implement, needed to avoid copies of singleton
 
     qint64 writeDatagram(const QByteArray& datagram, const HifiSockAddr& destinationSockAddr);
+    qint64 writeVerifiedDatagram(const QByteArray& datagram, const SharedNodePointer& destinationNode,
+                                 const HifiSockAddr& destinationSockAddr);
+    qint64 writeShapedDatagram(const QByteArray& datagram, const SharedNodePointer& destinationNode,
+                               const HifiSockAddr& destinationSockAddr, ShapingPriority priority);
 
     PacketSequenceNumber getNextSequenceNumberForPacket(const QUuid& nodeUUID, PacketType packetType);
 
@@ -272,6 +288,8 @@ protected:
 
     void handleNodeKill(const SharedNodePointer& node);
 
+    void processReliablePacket(const QByteArray& packet, const SharedNodePointer& sendingNode);
+
     void stopInitialSTUNUpdate(bool success);
 
     void sendPacketToIceServer(PacketType packetType, const HifiSockAddr& iceServerSockAddr, const QUuid& headerID,
@@ -296,6 +314,9 @@ protected:
 
     std::unordered_map<QUuid, PacketTypeSequenceMap, UUIDHasher> _packetSequenceNumbers;
 
+    QMutex _reliableChannelsMutex;
+    std::unordered_map<QUuid, ReliableMessageChannel, UUIDHasher> _reliableChannels;
+
     QPointer<QTimer> _initialSTUNTimer;
     int _numInitialSTUNRequests = 0;
     bool _hasCompletedInitialSTUN = false;
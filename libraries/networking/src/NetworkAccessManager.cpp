@@ -9,16 +9,42 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <QMutex>
 #include <QThreadStorage>
 
+#include "AssetCache.h"
+
 #include "NetworkAccessManager.h"
 
 QThreadStorage<QNetworkAccessManager*> networkAccessManagers;
 
+static QMutex assetCacheMutex;
+static QSharedPointer<AssetCache> assetCache;
+
 QNetworkAccessManager& NetworkAccessManager::getInstance() {
     if (!networkAccessManagers.hasLocalData()) {
-        networkAccessManagers.setLocalData(new QNetworkAccessManager());
+        QNetworkAccessManager* networkAccessManager = new QNetworkAccessManager();
+        QSharedPointer<AssetCache> cache = getAssetCache();
+        if (cache) {
+            networkAccessManager->setCache(new AssetNetworkCache(cache));
+        }
+        networkAccessManagers.setLocalData(networkAccessManager);
     }
     
     return *networkAccessManagers.localData();
 }
+
+void NetworkAccessManager::setAssetCache(const QSharedPointer<AssetCache>& cache) {
+    {
+        QMutexLocker locker(&assetCacheMutex);
+        assetCache = cache;
+    }
+    if (networkAccessManagers.hasLocalData()) {
+        networkAccessManagers.localData()->setCache(cache ? new AssetNetworkCache(cache) : nullptr);
+    }
+}
+
+QSharedPointer<AssetCache> NetworkAccessManager::getAssetCache() {
+    QMutexLocker locker(&assetCacheMutex);
+    return assetCache;
+}
@@ -13,12 +13,20 @@
 #define hifi_NetworkAccessManager_h
 
 #include <QtNetwork/qnetworkaccessmanager.h>
+#include <QSharedPointer>
+
+class AssetCache;
 
 /// Wrapper around QNetworkAccessManager to restrict at one instance by thread
 class NetworkAccessManager : public QObject {
     Q_OBJECT
 public:
     static QNetworkAccessManager& getInstance();
+
+    /// Sets the disk cache shared by the instances of every thread.  Instances created before this is called (other
+    /// than the calling thread's) go without.
+    static void setAssetCache(const QSharedPointer<AssetCache>& cache);
+    static QSharedPointer<AssetCache> getAssetCache();
 };
 
 #endif // hifi_NetworkAccessManager_h
\ No newline at end of file
@@ -18,38 +18,39 @@
 
 #include "NetworkPacket.h"
 
-void NetworkPacket::copyContents(const SharedNodePointer& node, const QByteArray& packet) {
+void NetworkPacket::copyContents(const SharedNodePointer& node, const QByteArray& packet, quint64 queuedMicrostamp) {
     if (packet.size() && packet.size() <= MAX_PACKET_SIZE) {
         _node = node;
         _byteArray = packet;
+        _queuedMicrostamp = queuedMicrostamp;
     } else {
         qCDebug(networking, ">>> NetworkPacket::copyContents() unexpected length = %d", packet.size());
     }
 }
 
 NetworkPacket::NetworkPacket(const NetworkPacket& packet) {
-    copyContents(packet.getNode(), packet.getByteArray());
+    copyContents(packet.getNode(), packet.getByteArray(), packet.getQueuedMicrostamp());
 }
 
 NetworkPacket::NetworkPacket(const SharedNodePointer& node, const QByteArray& packet) {
-    copyContents(node, packet);
+    copyContents(node, packet, usecTimestampNow());
 };
 
 // copy assignment 
 NetworkPacket& NetworkPacket::operator=(NetworkPacket const& other) {
-    copyContents(other.getNode(), other.getByteArray());
+    copyContents(other.getNode(), other.getByteArray(), other.getQueuedMicrostamp());
     return *this;
 }
 
 #ifdef HAS_MOVE_SEMANTICS
 // move, same as copy, but other packet won't be used further
 NetworkPacket::NetworkPacket(NetworkPacket && packet) {
-    copyContents(packet.getNode(), packet.getByteArray());
+    copyContents(packet.getNode(), packet.getByteArray(), packet.getQueuedMicrostamp());
 }
 
 // move assignment
 NetworkPacket& NetworkPacket::operator=(NetworkPacket&& other) {
-    copyContents(other.getNode(), other.getByteArray());
+    copyContents(other.getNode(), other.getByteArray(), other.getQueuedMicrostamp());
     return *this;
 }
 #endif
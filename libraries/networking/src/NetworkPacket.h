@@ -33,11 +33,15 @@ public:
     const SharedNodePointer& getNode() const { return _node; }
     const QByteArray& getByteArray() const { return _byteArray; }
 
+    /// the time this packet was handed to its queue, used to measure how long it waited before being processed or sent
+    quint64 getQueuedMicrostamp() const { return _queuedMicrostamp; }
+
 private:
-    void copyContents(const SharedNodePointer& node, const QByteArray& byteArray);
+    void copyContents(const SharedNodePointer& node, const QByteArray& byteArray, quint64 queuedMicrostamp);
 
     SharedNodePointer _node;
     QByteArray _byteArray;
+    quint64 _queuedMicrostamp = 0;
 };
 
 #endif // hifi_NetworkPacket_h
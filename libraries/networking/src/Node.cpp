@@ -9,9 +9,12 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <algorithm>
+#include <climits>
 #include <cstring>
 #include <stdio.h>
 
+#include <NumericalConstants.h>
 #include <UUID.h>
 
 #include "Node.h"
@@ -53,7 +56,9 @@ Node::Node(const QUuid& uuid, NodeType_t type, const HifiSockAddr& publicSocket,
     _mutex(),
     _clockSkewMovingPercentile(30, 0.8f),   // moving 80th percentile of 30 samples
     _canAdjustLocks(canAdjustLocks),
-    _canRez(canRez)
+    _canRez(canRez),
+    _isAssignment(false),
+    _downstreamBandwidthHint(0)
 {
 
 }
@@ -67,6 +72,13 @@ void Node::updateClockSkewUsec(int clockSkewSample) {
     _clockSkewUsec = (int)_clockSkewMovingPercentile.getValueAtPercentile();
 }
 
+void Node::setDownstreamBandwidthHint(int kbps) {
+    QMutexLocker locker(&_bandwidthShaperMutex);
+    _downstreamBandwidthHint = std::max(kbps, 0);
+    qint64 bytesPerSecond = (qint64)_downstreamBandwidthHint * 1000 / BITS_IN_BYTE;
+    _bandwidthShaper.setBytesPerSecond((int)std::min(bytesPerSecond, (qint64)INT_MAX));
+}
+
 PacketSequenceNumber Node::getLastSequenceNumberForPacketType(PacketType packetType) const {
    auto typeMatch = _lastSequenceNumbers.find(packetType);
    if (typeMatch != _lastSequenceNumbers.end()) {
@@ -83,6 +95,7 @@ QDataStream& operator<<(QDataStream& out, const Node& node) {
     out << node._localSocket;
     out << node._canAdjustLocks;
     out << node._canRez;
+    out << node._isAssignment;
 
     return out;
 }
@@ -94,6 +107,7 @@ QDataStream& operator>>(QDataStream& in, Node& node) {
     in >> node._localSocket;
     in >> node._canAdjustLocks;
     in >> node._canRez;
+    in >> node._isAssignment;
 
     return in;
 }
@@ -22,6 +22,7 @@
 
 #include "HifiSockAddr.h"
 #include "NetworkPeer.h"
+#include "NodeBandwidthShaper.h"
 #include "NodeData.h"
 #include "NodeType.h"
 #include "PacketHeaders.h"
@@ -65,10 +66,22 @@ public:
     void setCanRez(bool canRez) { _canRez = canRez; }
     bool getCanRez() { return _canRez; }
 
+    /// true for nodes running an assignment the domain-server handed out, false for interface clients
+    void setIsAssignment(bool isAssignment) { _isAssignment = isAssignment; }
+    bool isAssignment() const { return _isAssignment; }
+
     void setLastSequenceNumberForPacketType(PacketSequenceNumber sequenceNumber, PacketType packetType)
         { _lastSequenceNumbers[packetType] = sequenceNumber; }
     PacketSequenceNumber getLastSequenceNumberForPacketType(PacketType packetType) const;
 
+    /// downstream budget for everything we send this node, 0 means unlimited
+    void setDownstreamBandwidthHint(int kbps);
+    int getDownstreamBandwidthHint() const { return _downstreamBandwidthHint; }
+    bool isBandwidthShaped() const { return _downstreamBandwidthHint > 0; }
+
+    NodeBandwidthShaper& getBandwidthShaper() { return _bandwidthShaper; }
+    QMutex& getBandwidthShaperMutex() { return _bandwidthShaperMutex; }
+
     friend QDataStream& operator<<(QDataStream& out, const Node& node);
     friend QDataStream& operator>>(QDataStream& in, Node& node);
 
@@ -88,8 +101,13 @@ private:
     MovingPercentile _clockSkewMovingPercentile;
     bool _canAdjustLocks;
     bool _canRez;
+    bool _isAssignment;
 
     PacketTypeSequenceMap _lastSequenceNumbers;
+
+    int _downstreamBandwidthHint;
+    NodeBandwidthShaper _bandwidthShaper;
+    QMutex _bandwidthShaperMutex;
 };
 
 QDebug operator<<(QDebug debug, const Node &message);
@@ -0,0 +1,184 @@
+//
+//  NodeBandwidthShaper.cpp
+//  libraries/networking/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+
+#include <NumericalConstants.h>
+
+#include "NodeBandwidthShaper.h"
+
+const quint64 NodeBandwidthShaper::BURST_USECS = 20 * 1000;
+const quint64 NodeBandwidthShaper::MAX_AUDIO_QUEUE_DELAY_USECS = 100 * 1000;
+const quint64 NodeBandwidthShaper::MAX_AVATAR_QUEUE_DELAY_USECS = 250 * 1000;
+const quint64 NodeBandwidthShaper::MAX_QUEUED_USECS_OF_DATA = 2 * 1000 * 1000;
+const int NodeBandwidthShaper::MIN_MAX_QUEUED_BYTES = 64 * 1024;
+
+// the bucket always holds at least a couple of full datagrams, or a big datagram could never go out
+const int MAX_SHAPED_DATAGRAM_BYTES = 1500;
+
+const float QUEUE_DELAY_AVERAGE_WEIGHT = 1.0f / 16.0f;
+
+ShapingPriority shapingPriorityForPacketType(PacketType packetType) {
+    switch (packetType) {
+        case PacketTypeMixedAudio:
+        case PacketTypeSilentAudioFrame:
+        case PacketTypeInjectAudio:
+        case PacketTypeMicrophoneAudioNoEcho:
+        case PacketTypeMicrophoneAudioWithEcho:
+        case PacketTypeAudioStreamStats:
+        case PacketTypeAudioEnvironment:
+        case PacketTypeMuteEnvironment:
+        case PacketTypeNoisyMute:
+            return AudioShapingPriority;
+        case PacketTypeAvatarData:
+        case PacketTypeBulkAvatarData:
+        case PacketTypeKillAvatar:
+        case PacketTypeAvatarIdentity:
+        case PacketTypeHostedAvatarData:
+        case PacketTypeHostedAvatarIdentity:
+            return AvatarShapingPriority;
+        case PacketTypeEntityData:
+        case PacketTypeEntityAdd:
+        case PacketTypeEntityEdit:
+        case PacketTypeEntityErase:
+        case PacketTypeEntityPhysicsStateBatch:
+        case PacketTypeEntityPhysicsStateBatchAck:
+        case PacketTypeOctreeStats:
+        case PacketTypeEnvironmentData:
+        case PacketTypeJurisdiction:
+            return EntityShapingPriority;
+        case PacketTypeAvatarBillboard:
+        case PacketTypeReliableMessage:
+            return BulkShapingPriority;
+        default:
+            return UnshapedPriority;
+    }
+}
+
+NodeBandwidthShaper::NodeBandwidthShaper() :
+    _bytesPerSecond(0),
+    _tokens(0.0f),
+    _lastRefill(0),
+    _totalQueuedBytes(0),
+    _averageQueueDelayUsecs(0.0f),
+    _droppedDatagrams(0)
+{
+    std::fill(_queuedBytes, _queuedBytes + NUM_SHAPING_PRIORITIES, 0);
+}
+
+void NodeBandwidthShaper::setBytesPerSecond(int bytesPerSecond) {
+    _bytesPerSecond = std::max(bytesPerSecond, 0);
+    _tokens = std::min(_tokens, (float)getBurstBytes());
+}
+
+int NodeBandwidthShaper::getBurstBytes() const {
+    return std::max(2 * MAX_SHAPED_DATAGRAM_BYTES, (int)((quint64)_bytesPerSecond * BURST_USECS / USECS_PER_SECOND));
+}
+
+int NodeBandwidthShaper::getMaxQueuedBytes() const {
+    return std::max(MIN_MAX_QUEUED_BYTES, (int)((quint64)_bytesPerSecond * MAX_QUEUED_USECS_OF_DATA / USECS_PER_SECOND));
+}
+
+void NodeBandwidthShaper::refill(quint64 now) {
+    if (_lastRefill == 0) {
+        _tokens = getBurstBytes();
+    } else if (now > _lastRefill) {
+        _tokens = std::min(_tokens + (float)(now - _lastRefill) * _bytesPerSecond / USECS_PER_SECOND,
+                           (float)getBurstBytes());
+    }
+    _lastRefill = std::max(_lastRefill, now);
+}
+
+void NodeBandwidthShaper::dropStale(ShapingPriority priority, quint64 now) {
+    quint64 maxQueueDelay;
+    if (priority == AudioShapingPriority) {
+        maxQueueDelay = MAX_AUDIO_QUEUE_DELAY_USECS;
+    } else if (priority == AvatarShapingPriority) {
+        maxQueueDelay = MAX_AVATAR_QUEUE_DELAY_USECS;
+    } else {
+        // entity and bulk data is still wanted however late it is
+        return;
+    }
+
+    std::deque<QueuedDatagram>& queue = _queues[priority];
+    while (!queue.empty() && now > queue.front().queuedAt + maxQueueDelay) {
+        _queuedBytes[priority] -= queue.front().datagram.size();
+        _totalQueuedBytes -= queue.front().datagram.size();
+        queue.pop_front();
+        ++_droppedDatagrams;
+    }
+}
+
+bool NodeBandwidthShaper::queueDatagram(const QByteArray& datagram, const HifiSockAddr& destinationSockAddr,
+                                        ShapingPriority priority, quint64 now) {
+    priority = std::min(priority, BulkShapingPriority);
+    std::deque<QueuedDatagram>& queue = _queues[priority];
+
+    dropStale(priority, now);
+
+    int maxQueuedBytes = getMaxQueuedBytes();
+    if (_queuedBytes[priority] + datagram.size() > maxQueuedBytes) {
+        if (priority > AvatarShapingPriority) {
+            // tail drop, the entity server will hear about it through nacks
+            ++_droppedDatagrams;
+            return false;
+        }
+        // for audio and avatars the newest data is the most useful, make room for it
+        while (!queue.empty() && _queuedBytes[priority] + datagram.size() > maxQueuedBytes) {
+            _queuedBytes[priority] -= queue.front().datagram.size();
+            _totalQueuedBytes -= queue.front().datagram.size();
+            queue.pop_front();
+            ++_droppedDatagrams;
+        }
+    }
+
+    QueuedDatagram queuedDatagram = { datagram, destinationSockAddr, now };
+    queue.push_back(queuedDatagram);
+    _queuedBytes[priority] += datagram.size();
+    _totalQueuedBytes += datagram.size();
+    return true;
+}
+
+void NodeBandwidthShaper::recordUnshapedBytes(int bytes, quint64 now) {
+    refill(now);
+    // this can go negative, queued traffic then waits until the debt is paid back
+    _tokens -= bytes;
+}
+
+std::vector<NodeBandwidthShaper::QueuedDatagram> NodeBandwidthShaper::takeSendableDatagrams(quint64 now) {
+    std::vector<QueuedDatagram> sendable;
+    refill(now);
+
+    for (int priority = 0; priority < NUM_SHAPING_PRIORITIES; priority++) {
+        dropStale((ShapingPriority)priority, now);
+
+        std::deque<QueuedDatagram>& queue = _queues[priority];
+        while (!queue.empty()) {
+            int size = queue.front().datagram.size();
+            if (isShaping()) {
+                if (_tokens < size) {
+                    // strict priority - lower classes can't use tokens while a higher class is waiting for them
+                    return sendable;
+                }
+                _tokens -= size;
+            }
+            _queuedBytes[priority] -= size;
+            _totalQueuedBytes -= size;
+
+            float queueDelay = (float)(now - queue.front().queuedAt);
+            _averageQueueDelayUsecs += (queueDelay - _averageQueueDelayUsecs) * QUEUE_DELAY_AVERAGE_WEIGHT;
+
+            sendable.push_back(queue.front());
+            queue.pop_front();
+        }
+    }
+
+    return sendable;
+}
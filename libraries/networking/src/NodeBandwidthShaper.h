@@ -0,0 +1,97 @@
+//
+//  NodeBandwidthShaper.h
+//  libraries/networking/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Token bucket shaping of the datagrams we send to a single node, with strict priority between traffic classes.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_NodeBandwidthShaper_h
+#define hifi_NodeBandwidthShaper_h
+
+#include <deque>
+#include <vector>
+
+#include <QtCore/QByteArray>
+
+#include "HifiSockAddr.h"
+#include "PacketHeaders.h"
+
+/// Traffic classes in the order they are served; lower values always go first.
+enum ShapingPriority {
+    AudioShapingPriority = 0,
+    AvatarShapingPriority,
+    EntityShapingPriority,
+    BulkShapingPriority,
+    NUM_SHAPING_PRIORITIES,
+    UnshapedPriority = NUM_SHAPING_PRIORITIES // control traffic (pings, domain, stats) that is never held back
+};
+
+ShapingPriority shapingPriorityForPacketType(PacketType packetType);
+
+/// Keeps the bytes sent to one node under its downstream budget. Datagrams that fit in the bucket go out right away,
+/// the rest wait in one queue per traffic class and are released from takeSendableDatagrams() as tokens refill.
+/// Audio and avatar data that waited too long to still be useful are dropped from the front of their queues, entity
+/// and bulk data are tail dropped once their queue is full. Not thread safe, Node guards it with a mutex.
+class NodeBandwidthShaper {
+public:
+    static const quint64 BURST_USECS;
+    static const quint64 MAX_AUDIO_QUEUE_DELAY_USECS;
+    static const quint64 MAX_AVATAR_QUEUE_DELAY_USECS;
+    static const quint64 MAX_QUEUED_USECS_OF_DATA;
+    static const int MIN_MAX_QUEUED_BYTES;
+
+    class QueuedDatagram {
+    public:
+        QByteArray datagram;
+        HifiSockAddr destinationSockAddr;
+        quint64 queuedAt;
+    };
+
+    NodeBandwidthShaper();
+
+    /// 0 turns shaping off
+    void setBytesPerSecond(int bytesPerSecond);
+    int getBytesPerSecond() const { return _bytesPerSecond; }
+    bool isShaping() const { return _bytesPerSecond > 0; }
+
+    /// Queues a datagram behind anything of the same or higher priority. Returns false if it was dropped instead.
+    bool queueDatagram(const QByteArray& datagram, const HifiSockAddr& destinationSockAddr,
+                       ShapingPriority priority, quint64 now);
+
+    /// Charges datagrams that bypassed the queues against the bucket so they still count toward the budget.
+    void recordUnshapedBytes(int bytes, quint64 now);
+
+    /// Everything the bucket allows to go out now, highest priority first. Once shaping is turned off this drains
+    /// whatever is still queued.
+    std::vector<QueuedDatagram> takeSendableDatagrams(quint64 now);
+
+    bool hasQueuedDatagrams() const { return _totalQueuedBytes > 0; }
+    int getQueuedBytes() const { return _totalQueuedBytes; }
+    int getQueuedBytes(ShapingPriority priority) const { return _queuedBytes[priority]; }
+    float getAverageQueueDelayUsecs() const { return _averageQueueDelayUsecs; }
+    quint64 getDroppedDatagrams() const { return _droppedDatagrams; }
+
+private:
+    void refill(quint64 now);
+    void dropStale(ShapingPriority priority, quint64 now);
+    int getMaxQueuedBytes() const;
+    int getBurstBytes() const;
+
+    int _bytesPerSecond;
+    float _tokens;
+    quint64 _lastRefill;
+
+    std::deque<QueuedDatagram> _queues[NUM_SHAPING_PRIORITIES];
+    int _queuedBytes[NUM_SHAPING_PRIORITIES];
+    int _totalQueuedBytes;
+
+    float _averageQueueDelayUsecs;
+    quint64 _droppedDatagrams;
+};
+
+#endif // hifi_NodeBandwidthShaper_h
@@ -582,8 +582,10 @@ void NodeList::parseNodeFromPacketStream(QDataStream& packetStream) {
     HifiSockAddr nodePublicSocket, nodeLocalSocket;
     bool canAdjustLocks;
     bool canRez;
+    bool isAssignment;
 
-    packetStream >> nodeType >> nodeUUID >> nodePublicSocket >> nodeLocalSocket >> canAdjustLocks >> canRez;
+    packetStream >> nodeType >> nodeUUID >> nodePublicSocket >> nodeLocalSocket >> canAdjustLocks >> canRez
+        >> isAssignment;
 
     // if the public socket address is 0 then it's reachable at the same IP
     // as the domain server
@@ -596,6 +598,7 @@ void NodeList::parseNodeFromPacketStream(QDataStream& packetStream) {
     SharedNodePointer node = addOrUpdateNode(nodeUUID, nodeType, nodePublicSocket,
                                              nodeLocalSocket, canAdjustLocks, canRez,
                                              connectionUUID);
+    node->setIsAssignment(isAssignment);
 }
 
 void NodeList::sendAssignment(Assignment& assignment) {
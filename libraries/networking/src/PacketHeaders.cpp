@@ -62,7 +62,9 @@ PacketVersion versionForPacketType(PacketType packetType) {
             return 2;
         case PacketTypeDomainList:
         case PacketTypeDomainListRequest:
-            return 5;
+            return 6;
+        case PacketTypeDomainServerAddedNode:
+            return 1;
         case PacketTypeCreateAssignment:
         case PacketTypeRequestAssignment:
             return 2;
@@ -76,6 +78,9 @@ PacketVersion versionForPacketType(PacketType packetType) {
             return VERSION_ENTITIES_LINE_POINTS;
         case PacketTypeEntityErase:
             return 2;
+        case PacketTypeEntityPhysicsStateBatch:
+        case PacketTypeEntityPhysicsStateBatchAck:
+            return 1;
         case PacketTypeAudioStreamStats:
             return 1;
         case PacketTypeIceServerHeartbeat:
@@ -135,6 +140,12 @@ QString nameForPacketType(PacketType packetType) {
             PACKET_TYPE_NAME_LOOKUP(PacketTypeUnverifiedPingReply);
             PACKET_TYPE_NAME_LOOKUP(PacketTypeEntityAdd);
             PACKET_TYPE_NAME_LOOKUP(PacketTypeEntityEdit);
+            PACKET_TYPE_NAME_LOOKUP(PacketTypeReliableMessage);
+            PACKET_TYPE_NAME_LOOKUP(PacketTypeReliableMessageAck);
+            PACKET_TYPE_NAME_LOOKUP(PacketTypeEntityPhysicsStateBatch);
+            PACKET_TYPE_NAME_LOOKUP(PacketTypeEntityPhysicsStateBatchAck);
+            PACKET_TYPE_NAME_LOOKUP(PacketTypeHostedAvatarData);
+            PACKET_TYPE_NAME_LOOKUP(PacketTypeHostedAvatarIdentity);
         default:
             return QString("Type: ") + QString::number((int)packetType);
     }
@@ -56,12 +56,12 @@ enum PacketType {
     PacketTypeOctreeStats,
     PacketTypeJurisdiction,
     PacketTypeJurisdictionRequest,
-    UNUSED_6,
-    UNUSED_7, // 30
-    UNUSED_8,
-    UNUSED_9,
+    PacketTypeReliableMessage,
+    PacketTypeReliableMessageAck, // 30
+    PacketTypeEntityPhysicsStateBatch,
+    PacketTypeEntityPhysicsStateBatchAck,
     PacketTypeNoisyMute,
-    UNUSED_10,
+    PacketTypeHostedAvatarData,
     PacketTypeAvatarIdentity, // 35
     PacketTypeAvatarBillboard,
     PacketTypeDomainConnectRequest,
@@ -79,7 +79,8 @@ enum PacketType {
     PacketTypeSignedTransactionPayment,
     PacketTypeIceServerHeartbeat, // 50
     PacketTypeUnverifiedPing,
-    PacketTypeUnverifiedPingReply
+    PacketTypeUnverifiedPingReply,
+    PacketTypeHostedAvatarIdentity
 };
 
 typedef char PacketVersion;
@@ -28,6 +28,9 @@ const int PacketSender::MINIMAL_SLEEP_INTERVAL = (USECS_PER_SECOND / TARGET_FPS)
 
 const int AVERAGE_CALL_TIME_SAMPLES = 10;
 
+const int QUEUE_WAIT_STATS_INTERVAL_PACKETS = 100;
+const int QUEUE_WAIT_STATS_WINDOW_INTERVALS = 30;
+
 PacketSender::PacketSender(int packetsPerSecond) :
     _packetsPerSecond(packetsPerSecond),
     _usecsPerProcessCallHint(0),
@@ -40,7 +43,8 @@ PacketSender::PacketSender(int packetsPerSecond) :
     _totalPacketsSent(0),
     _totalBytesSent(0),
     _totalPacketsQueued(0),
-    _totalBytesQueued(0)
+    _totalBytesQueued(0),
+    _queueWaitStats(QUEUE_WAIT_STATS_INTERVAL_PACKETS, QUEUE_WAIT_STATS_WINDOW_INTERVALS)
 {
 }
 
@@ -49,15 +53,25 @@ PacketSender::~PacketSender() {
 
 
 void PacketSender::queuePacketForSending(const SharedNodePointer& destinationNode, const QByteArray& packet) {
-    NetworkPacket networkPacket(destinationNode, packet);
     lock();
-    _packets.push_back(networkPacket);
-    unlock();
+    bool wasEmpty = _packets.empty();
+    _packets.push_back(NetworkPacket(destinationNode, packet));
     _totalPacketsQueued++;
     _totalBytesQueued += packet.size();
 
-    // Make sure to  wake our actual processing thread because we  now have packets for it to process.
-    _hasPackets.wakeAll();
+    // Only wake our processing thread when the queue goes from empty to non-empty, otherwise it has already been
+    // woken or is in the middle of draining the queue at its target rate.
+    if (wasEmpty) {
+        _hasPackets.wakeAll();
+    }
+    unlock();
+}
+
+MovingMinMaxAvg<quint64> PacketSender::getQueueWaitStats() {
+    lock();
+    MovingMinMaxAvg<quint64> stats = _queueWaitStats;
+    unlock();
+    return stats;
 }
 
 void PacketSender::setPacketsPerSecond(int packetsPerSecond) {
@@ -73,7 +87,9 @@ bool PacketSender::process() {
 }
 
 void PacketSender::terminating() {
+    lock();
     _hasPackets.wakeAll();
+    unlock();
 }
 
 bool PacketSender::threadedProcess() {
@@ -118,10 +134,12 @@ bool PacketSender::threadedProcess() {
 
     // if threaded and we haven't slept? We want to wait for our consumer to signal us with new packets
     if (!hasSlept) {
-        // wait till we have packets        
-        _waitingOnPacketsMutex.lock();
-        _hasPackets.wait(&_waitingOnPacketsMutex);
-        _waitingOnPacketsMutex.unlock();
+        // wait till we have packets, checking under our own mutex so a packet queued right now can't be missed
+        lock();
+        if (_packets.empty() && isStillRunning()) {
+            _hasPackets.wait(&_mutex);
+        }
+        unlock();
     }
 
     return isStillRunning();
@@ -259,27 +277,36 @@ bool PacketSender::nonThreadedProcess() {
         }
     }
 
-    int packetsLeft = _packets.size();
+    if (packetsToSendThisCall <= 0) {
+        return isStillRunning();
+    }
 
-    // Now that we know how many packets to send this call to process, just send them.
-    while ((packetsSentThisCall < packetsToSendThisCall) && (packetsLeft > 0)) {
-        lock();
-        NetworkPacket& packet = _packets.front();
-        NetworkPacket temporary = packet; // make a copy
-        _packets.erase(_packets.begin());
-        packetsLeft = _packets.size();
-        unlock();
+    // Now that we know how many packets to send this call to process, take them off the queue in one go and send them.
+    lock();
+    quint64 dequeueTime = usecTimestampNow();
+    int packetsToTake = std::min(packetsToSendThisCall, (int)_packets.size());
+    _sendingPackets.assign(_packets.begin(), _packets.begin() + packetsToTake);
+    _packets.erase(_packets.begin(), _packets.begin() + packetsToTake);
+    for (int i = 0; i < packetsToTake; i++) {
+        _queueWaitStats.update(dequeueTime - _sendingPackets[i].getQueuedMicrostamp());
+    }
+    unlock();
+
+    auto nodeList = DependencyManager::get<NodeList>();
+    for (size_t i = 0; i < _sendingPackets.size(); i++) {
+        const NetworkPacket& packet = _sendingPackets[i];
 
         // send the packet through the NodeList...
-        DependencyManager::get<NodeList>()->writeDatagram(temporary.getByteArray(), temporary.getNode());
+        nodeList->writeDatagram(packet.getByteArray(), packet.getNode());
         packetsSentThisCall++;
         _packetsOverCheckInterval++;
         _totalPacketsSent++;
-        _totalBytesSent += temporary.getByteArray().size();
+        _totalBytesSent += packet.getByteArray().size();
         
-        emit packetSent(temporary.getByteArray().size());
+        emit packetSent(packet.getByteArray().size());
         
         _lastSendTime = now;
     }
+    _sendingPackets.clear();
     return isStillRunning();
 }
@@ -14,9 +14,12 @@
 #ifndef hifi_PacketSender_h
 #define hifi_PacketSender_h
 
+#include <vector>
+
 #include <QWaitCondition>
 
 #include "GenericThread.h"
+#include "MovingMinMaxAvg.h"
 #include "NetworkPacket.h"
 #include "NodeList.h"
 #include "SharedUtil.h"
@@ -91,6 +94,9 @@ public:
 
     /// returns the total bytes queued by this object over its lifetime
     quint64 getLifetimeBytesQueued() const { return _totalBytesQueued; }
+
+    /// returns the time in usecs packets spent in the send queue before being written
+    MovingMinMaxAvg<quint64> getQueueWaitStats();
 signals:
     void packetSent(quint64);
 protected:
@@ -101,6 +107,7 @@ protected:
 
 private:
     std::vector<NetworkPacket> _packets;
+    std::vector<NetworkPacket> _sendingPackets; // reused each call so dequeuing a batch does not allocate
     quint64 _lastSendTime;
 
     bool threadedProcess();
@@ -116,8 +123,9 @@ private:
     quint64 _totalPacketsQueued;
     quint64 _totalBytesQueued;
 
+    MovingMinMaxAvg<quint64> _queueWaitStats;
+
     QWaitCondition _hasPackets;
-    QMutex _waitingOnPacketsMutex;
 };
 
 #endif // hifi_PacketSender_h
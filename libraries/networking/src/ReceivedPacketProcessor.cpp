@@ -13,48 +13,85 @@
 #include "ReceivedPacketProcessor.h"
 #include "SharedUtil.h"
 
+const int QUEUE_WAIT_STATS_INTERVAL_PACKETS = 100;
+const int QUEUE_WAIT_STATS_WINDOW_INTERVALS = 30;
+
+ReceivedPacketProcessor::ReceivedPacketProcessor() :
+    _queueWaitStats(QUEUE_WAIT_STATS_INTERVAL_PACKETS, QUEUE_WAIT_STATS_WINDOW_INTERVALS)
+{
+}
+
 void ReceivedPacketProcessor::terminating() {
+    lock();
     _hasPackets.wakeAll();
+    unlock();
 }
 
 void ReceivedPacketProcessor::queueReceivedPacket(const SharedNodePointer& sendingNode, const QByteArray& packet) {
     // Make sure our Node and NodeList knows we've heard from this node.
     sendingNode->setLastHeardMicrostamp(usecTimestampNow());
 
-    NetworkPacket networkPacket(sendingNode, packet);
     lock();
-    _packets.push_back(networkPacket);
+    bool wasEmpty = _packets.empty();
+    _packets.push_back(NetworkPacket(sendingNode, packet));
     _nodePacketCounts[sendingNode->getUUID()]++;
+
+    // Only wake our processing thread when the queue goes from empty to non-empty, if there were already packets
+    // waiting then it has either been woken already or is busy processing and will pick these up on its next pass.
+    if (wasEmpty) {
+        _hasPackets.wakeAll();
+    }
     unlock();
-    
-    // Make sure to wake our actual processing thread because we now have packets for it to process.
-    _hasPackets.wakeAll();
 }
 
 bool ReceivedPacketProcessor::process() {
-
-    if (_packets.size() == 0) {
-        _waitingOnPacketsMutex.lock();
-        _hasPackets.wait(&_waitingOnPacketsMutex, getMaxWait());
-        _waitingOnPacketsMutex.unlock();
+    lock();
+    if (_packets.empty() && isStillRunning()) {
+        // waiting on our own mutex means a packet queued between the check and the wait can't be missed
+        _hasPackets.wait(&_mutex, getMaxWait());
     }
+    _processingPackets.swap(_packets);
+    unlock();
+
     preProcess();
-    while (_packets.size() > 0) {
-        lock(); // lock to make sure nothing changes on us
-        NetworkPacket& packet = _packets.front(); // get the oldest packet
-        NetworkPacket temporary = packet; // make a copy of the packet in case the vector is resized on us
-        _packets.erase(_packets.begin()); // remove the oldest packet
-        if (!temporary.getNode().isNull()) {
-            _nodePacketCounts[temporary.getNode()->getUUID()]--;
-        }
-        unlock(); // let others add to the packets
-        processPacket(temporary.getNode(), temporary.getByteArray()); // process our temporary copy
+    quint64 batchStart = usecTimestampNow();
+    for (size_t i = 0; i < _processingPackets.size(); i++) {
+        const NetworkPacket& packet = _processingPackets[i];
+        processPacket(packet.getNode(), packet.getByteArray());
         midProcess();
     }
+
+    // the packets of this batch count as waiting until they are all processed, so anyone checking
+    // hasPacketsToProcessFrom() (e.g. before sending NACKs) never sees them as lost
+    if (!_processingPackets.empty()) {
+        lock();
+        for (size_t i = 0; i < _processingPackets.size(); i++) {
+            const NetworkPacket& packet = _processingPackets[i];
+            _queueWaitStats.update(batchStart - packet.getQueuedMicrostamp());
+
+            const SharedNodePointer& node = packet.getNode();
+            if (!node.isNull()) {
+                QHash<QUuid, int>::iterator count = _nodePacketCounts.find(node->getUUID());
+                if (count != _nodePacketCounts.end()) {
+                    count.value()--;
+                }
+            }
+        }
+        unlock();
+        // clear() keeps the capacity around for the next batch
+        _processingPackets.clear();
+    }
     postProcess();
     return isStillRunning();  // keep running till they terminate us
 }
 
+MovingMinMaxAvg<quint64> ReceivedPacketProcessor::getQueueWaitStats() {
+    lock();
+    MovingMinMaxAvg<quint64> stats = _queueWaitStats;
+    unlock();
+    return stats;
+}
+
 void ReceivedPacketProcessor::nodeKilled(SharedNodePointer node) {
     lock();
     _nodePacketCounts.remove(node->getUUID());
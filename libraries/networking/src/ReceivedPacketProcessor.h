@@ -12,16 +12,19 @@
 #ifndef hifi_ReceivedPacketProcessor_h
 #define hifi_ReceivedPacketProcessor_h
 
+#include <vector>
+
 #include <QWaitCondition>
 
 #include "GenericThread.h"
+#include "MovingMinMaxAvg.h"
 #include "NetworkPacket.h"
 
 /// Generalized threaded processor for handling received inbound packets. 
 class ReceivedPacketProcessor : public GenericThread {
     Q_OBJECT
 public:
-    ReceivedPacketProcessor() { }
+    ReceivedPacketProcessor();
 
     /// Add packet from network receive thread to the processing queue.
     void queueReceivedPacket(const SharedNodePointer& sendingNode, const QByteArray& packet);
@@ -47,6 +50,9 @@ public:
     /// How many received packets waiting are to be processed
     int packetsToProcessCount() const { return _packets.size(); }
 
+    /// Time in usecs packets spent waiting in the queue before being handed to processPacket()
+    MovingMinMaxAvg<quint64> getQueueWaitStats();
+
     virtual void terminating();
 
 public slots:
@@ -75,11 +81,17 @@ protected:
 
 protected:
 
-    QVector<NetworkPacket> _packets;
+    std::vector<NetworkPacket> _packets;
     QHash<QUuid, int> _nodePacketCounts;
 
     QWaitCondition _hasPackets;
-    QMutex _waitingOnPacketsMutex;
+
+private:
+    // packets are handed over in batches: process() swaps the whole queue into this buffer under a single lock, so both
+    // vectors keep their capacity and the steady state does not touch the allocator
+    std::vector<NetworkPacket> _processingPackets;
+
+    MovingMinMaxAvg<quint64> _queueWaitStats;
 };
 
 #endif // hifi_ReceivedPacketProcessor_h
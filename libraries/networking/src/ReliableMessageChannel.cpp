@@ -0,0 +1,366 @@
+//
+//  ReliableMessageChannel.cpp
+//  libraries/networking/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "NetworkLogging.h"
+#include "ReliableMessageChannel.h"
+
+const quint64 DelayBasedCongestionControl::TARGET_QUEUING_DELAY_USECS = 25 * 1000;
+const quint64 DelayBasedCongestionControl::INITIAL_RETRANSMIT_TIMEOUT_USECS = 500 * 1000;
+const quint64 DelayBasedCongestionControl::MIN_RETRANSMIT_TIMEOUT_USECS = 50 * 1000;
+const quint64 DelayBasedCongestionControl::MAX_RETRANSMIT_TIMEOUT_USECS = 4 * 1000 * 1000;
+const quint64 DelayBasedCongestionControl::BASE_RTT_INTERVAL_USECS = 60 * 1000 * 1000;
+
+const int INITIAL_WINDOW_SEGMENTS = 4;
+const int MIN_WINDOW_SEGMENTS = 2;
+const int MAX_WINDOW_SEGMENTS = 1024;
+
+// how fast the window grows or shrinks, in segments per RTT when the queuing delay is 0 or twice the target
+const float WINDOW_GAIN = 1.0f;
+
+DelayBasedCongestionControl::DelayBasedCongestionControl(int maxSegmentBytes) :
+    _maxSegmentBytes(maxSegmentBytes),
+    _congestionWindow(INITIAL_WINDOW_SEGMENTS * maxSegmentBytes),
+    _isInSlowStart(true),
+    _smoothedRTT(0),
+    _rttVariance(0),
+    _retransmitTimeout(INITIAL_RETRANSMIT_TIMEOUT_USECS),
+    _currentIntervalMinRTT(std::numeric_limits<quint64>::max()),
+    _previousIntervalMinRTT(std::numeric_limits<quint64>::max()),
+    _currentIntervalStart(0)
+{
+}
+
+quint64 DelayBasedCongestionControl::getBaseRTT() const {
+    return std::min(_currentIntervalMinRTT, _previousIntervalMinRTT);
+}
+
+void DelayBasedCongestionControl::onAck(int bytesAcked, quint64 rttUsecs, quint64 now) {
+    // smoothed RTT and retransmit timeout as in RFC 6298
+    if (_smoothedRTT == 0) {
+        _smoothedRTT = rttUsecs;
+        _rttVariance = rttUsecs / 2;
+    } else {
+        quint64 delta = rttUsecs > _smoothedRTT ? rttUsecs - _smoothedRTT : _smoothedRTT - rttUsecs;
+        _rttVariance = (3 * _rttVariance + delta) / 4;
+        _smoothedRTT = (7 * _smoothedRTT + rttUsecs) / 8;
+    }
+    _retransmitTimeout = std::max(MIN_RETRANSMIT_TIMEOUT_USECS,
+                                  std::min(MAX_RETRANSMIT_TIMEOUT_USECS, _smoothedRTT + 4 * _rttVariance));
+
+    if (_currentIntervalStart == 0) {
+        _currentIntervalStart = now;
+    } else if (now - _currentIntervalStart > BASE_RTT_INTERVAL_USECS) {
+        _previousIntervalMinRTT = _currentIntervalMinRTT;
+        _currentIntervalMinRTT = std::numeric_limits<quint64>::max();
+        _currentIntervalStart = now;
+    }
+    _currentIntervalMinRTT = std::min(_currentIntervalMinRTT, rttUsecs);
+
+    // off target is 1 with empty queues, 0 right at the target delay and negative beyond it
+    float queuingDelay = (float)(rttUsecs - getBaseRTT());
+    float offTarget = ((float)TARGET_QUEUING_DELAY_USECS - queuingDelay) / (float)TARGET_QUEUING_DELAY_USECS;
+    offTarget = std::max(-1.0f, offTarget);
+
+    const float SLOW_START_EXIT_OFF_TARGET = 0.5f;
+    if (_isInSlowStart && offTarget < SLOW_START_EXIT_OFF_TARGET) {
+        _isInSlowStart = false;
+    }
+
+    if (_isInSlowStart) {
+        _congestionWindow += bytesAcked;
+    } else {
+        _congestionWindow += WINDOW_GAIN * offTarget * bytesAcked * _maxSegmentBytes / _congestionWindow;
+    }
+    _congestionWindow = std::max((float)(MIN_WINDOW_SEGMENTS * _maxSegmentBytes),
+                                 std::min((float)(MAX_WINDOW_SEGMENTS * _maxSegmentBytes), _congestionWindow));
+}
+
+void DelayBasedCongestionControl::onLoss() {
+    _isInSlowStart = false;
+    _congestionWindow = std::max((float)(MIN_WINDOW_SEGMENTS * _maxSegmentBytes), _congestionWindow / 2.0f);
+}
+
+void DelayBasedCongestionControl::onTimeout() {
+    _isInSlowStart = false;
+    _congestionWindow = MIN_WINDOW_SEGMENTS * _maxSegmentBytes;
+    _retransmitTimeout = std::min(MAX_RETRANSMIT_TIMEOUT_USECS, _retransmitTimeout * 2);
+}
+
+// a fragment is considered lost once this many fragments sent after it have been acked
+const int FRAGMENT_SKIPS_BEFORE_RETRANSMIT = 3;
+
+// the receiver holds on to at most this many fragments past a gap, later ones are dropped and resent
+const ReliableSequenceNumber RECEIVE_WINDOW_FRAGMENTS = 4096;
+
+// number of fragments after the cumulative ack that are selectively acked by the bits of an ack payload
+const int SELECTIVE_ACK_BITS = 32;
+
+ReliableMessageChannel::ReliableMessageChannel(int maxFragmentBytes, int maxMessageBytes) :
+    _maxFragmentBytes(maxFragmentBytes),
+    _maxMessageBytes(maxMessageBytes),
+    _congestionControl(maxFragmentBytes),
+    _nextSequence(0),
+    _bytesInFlight(0),
+    _recoverySequence(0),
+    _fragmentsSent(0),
+    _fragmentsRetransmitted(0),
+    _nextExpectedSequence(0),
+    _nextFragmentIndex(0),
+    _isDiscardingMessage(false),
+    _messagesDiscarded(0),
+    _ackPending(false)
+{
+}
+
+bool ReliableMessageChannel::queueMessage(const QByteArray& message) {
+    if (message.size() > _maxMessageBytes) {
+        qCWarning(networking) << "Not queuing a reliable message of" << message.size() << "bytes, the maximum is"
+            << _maxMessageBytes;
+        return false;
+    }
+    int maxDataBytes = _maxFragmentBytes - RELIABLE_DATA_HEADER_BYTES;
+    quint32 fragmentCount = (quint32)std::max(1, (message.size() + maxDataBytes - 1) / maxDataBytes);
+
+    for (quint32 fragmentIndex = 0; fragmentIndex < fragmentCount; fragmentIndex++) {
+        int offset = (int)fragmentIndex * maxDataBytes;
+        int dataBytes = std::min(maxDataBytes, message.size() - offset);
+
+        // the sequence number is filled in when the fragment is first sent
+        QByteArray payload(RELIABLE_DATA_HEADER_BYTES + dataBytes, 0);
+        char* dataAt = payload.data() + sizeof(ReliableSequenceNumber);
+        memcpy(dataAt, &fragmentIndex, sizeof(fragmentIndex));
+        dataAt += sizeof(fragmentIndex);
+        memcpy(dataAt, &fragmentCount, sizeof(fragmentCount));
+        dataAt += sizeof(fragmentCount);
+        memcpy(dataAt, message.constData() + offset, dataBytes);
+
+        _unsentFragments.push_back(payload);
+    }
+    return true;
+}
+
+void ReliableMessageChannel::sendFragment(ReliableSequenceNumber sequence, SentFragment& fragment, quint64 now) {
+    memcpy(fragment.payload.data(), &sequence, sizeof(sequence));
+    fragment.sentAt = now;
+    fragment.timesSkipped = 0;
+    _outgoingDataPayloads.push_back(fragment.payload);
+    _fragmentsSent++;
+}
+
+void ReliableMessageChannel::update(quint64 now) {
+    // retransmit whatever the acks showed to be lost, or whatever timed out
+    bool hasTimedOut = false;
+    bool hasNewLoss = false;
+    quint64 retransmitTimeout = _congestionControl.getRetransmitTimeout();
+    for (auto it = _inFlightFragments.begin(); it != _inFlightFragments.end(); ++it) {
+        SentFragment& fragment = it->second;
+        bool isLost = fragment.timesSkipped >= FRAGMENT_SKIPS_BEFORE_RETRANSMIT;
+        bool isTimedOut = now - fragment.sentAt > retransmitTimeout;
+        if (isLost || isTimedOut) {
+            if (isTimedOut) {
+                hasTimedOut = true;
+            } else if (it->first >= _recoverySequence) {
+                hasNewLoss = true;
+            }
+            fragment.wasRetransmitted = true;
+            sendFragment(it->first, fragment, now);
+            _fragmentsRetransmitted++;
+        }
+    }
+    if (hasTimedOut) {
+        _congestionControl.onTimeout();
+        _recoverySequence = _nextSequence;
+    } else if (hasNewLoss) {
+        // one window reduction per window of data, like TCP fast recovery
+        _congestionControl.onLoss();
+        _recoverySequence = _nextSequence;
+    }
+
+    // send new fragments as long as they fit in the congestion window
+    while (!_unsentFragments.empty()) {
+        const QByteArray& nextPayload = _unsentFragments.front();
+        if (_bytesInFlight > 0 && _bytesInFlight + nextPayload.size() > _congestionControl.getCongestionWindowBytes()) {
+            break;
+        }
+
+        SentFragment& fragment = _inFlightFragments[_nextSequence];
+        fragment.payload = nextPayload;
+        fragment.wasRetransmitted = false;
+        sendFragment(_nextSequence, fragment, now);
+
+        _bytesInFlight += nextPayload.size();
+        _nextSequence++;
+        _unsentFragments.pop_front();
+    }
+
+    // one ack per update covers everything received since the last one
+    if (_ackPending) {
+        quint32 selectiveAcks = 0;
+        for (int i = 0; i < SELECTIVE_ACK_BITS; i++) {
+            if (_outOfOrderFragments.count(_nextExpectedSequence + 1 + i)) {
+                selectiveAcks |= ((quint32)1 << i);
+            }
+        }
+
+        QByteArray ackPayload(RELIABLE_ACK_BYTES, 0);
+        memcpy(ackPayload.data(), &_nextExpectedSequence, sizeof(_nextExpectedSequence));
+        memcpy(ackPayload.data() + sizeof(_nextExpectedSequence), &selectiveAcks, sizeof(selectiveAcks));
+        _outgoingAckPayloads.push_back(ackPayload);
+        _ackPending = false;
+    }
+}
+
+void ReliableMessageChannel::ackFragment(std::map<ReliableSequenceNumber, SentFragment>::iterator it, quint64 now) {
+    SentFragment& fragment = it->second;
+
+    // like Karn's algorithm, only fragments that were sent once give a trustworthy RTT
+    if (!fragment.wasRetransmitted) {
+        _congestionControl.onAck(fragment.payload.size(), now - fragment.sentAt, now);
+    }
+    _bytesInFlight -= fragment.payload.size();
+    _inFlightFragments.erase(it);
+}
+
+void ReliableMessageChannel::processAckPayload(const QByteArray& payload, quint64 now) {
+    if (payload.size() < RELIABLE_ACK_BYTES) {
+        return;
+    }
+
+    ReliableSequenceNumber cumulativeAck;
+    quint32 selectiveAcks;
+    memcpy(&cumulativeAck, payload.constData(), sizeof(cumulativeAck));
+    memcpy(&selectiveAcks, payload.constData() + sizeof(cumulativeAck), sizeof(selectiveAcks));
+
+    // everything below the cumulative ack has arrived
+    while (!_inFlightFragments.empty() && _inFlightFragments.begin()->first < cumulativeAck) {
+        ackFragment(_inFlightFragments.begin(), now);
+    }
+
+    ReliableSequenceNumber highestSelectiveAck = 0;
+    quint64 latestSelectiveAckSentAt = 0;
+    for (int i = 0; i < SELECTIVE_ACK_BITS; i++) {
+        if (selectiveAcks & ((quint32)1 << i)) {
+            ReliableSequenceNumber sequence = cumulativeAck + 1 + i;
+            auto it = _inFlightFragments.find(sequence);
+            if (it != _inFlightFragments.end()) {
+                highestSelectiveAck = sequence;
+                latestSelectiveAckSentAt = std::max(latestSelectiveAckSentAt, it->second.sentAt);
+                ackFragment(it, now);
+            }
+        }
+    }
+
+    // fragments still missing below a newly acked one were skipped over by the receiver, as long as they were sent
+    // before it (a retransmission still on its way doesn't count as skipped)
+    if (latestSelectiveAckSentAt > 0) {
+        for (auto it = _inFlightFragments.begin();
+             it != _inFlightFragments.end() && it->first < highestSelectiveAck; ++it) {
+            if (it->second.sentAt < latestSelectiveAckSentAt) {
+                it->second.timesSkipped++;
+            }
+        }
+    }
+}
+
+void ReliableMessageChannel::processDataPayload(const QByteArray& payload, quint64 now) {
+    if (payload.size() < RELIABLE_DATA_HEADER_BYTES) {
+        return;
+    }
+
+    ReliableSequenceNumber sequence;
+    memcpy(&sequence, payload.constData(), sizeof(sequence));
+
+    // always ack, even duplicates, since it means our previous ack was lost
+    _ackPending = true;
+
+    if (sequence < _nextExpectedSequence || sequence >= _nextExpectedSequence + RECEIVE_WINDOW_FRAGMENTS) {
+        return;
+    }
+
+    if (sequence != _nextExpectedSequence) {
+        _outOfOrderFragments[sequence] = payload;
+        return;
+    }
+
+    receivedInOrder(payload);
+    _nextExpectedSequence++;
+
+    // the gap may now be filled for fragments that arrived earlier
+    auto it = _outOfOrderFragments.begin();
+    while (it != _outOfOrderFragments.end() && it->first == _nextExpectedSequence) {
+        receivedInOrder(it->second);
+        _nextExpectedSequence++;
+        it = _outOfOrderFragments.erase(it);
+    }
+}
+
+void ReliableMessageChannel::receivedInOrder(const QByteArray& payload) {
+    quint32 fragmentIndex;
+    quint32 fragmentCount;
+    const char* dataAt = payload.constData() + sizeof(ReliableSequenceNumber);
+    memcpy(&fragmentIndex, dataAt, sizeof(fragmentIndex));
+    dataAt += sizeof(fragmentIndex);
+    memcpy(&fragmentCount, dataAt, sizeof(fragmentCount));
+    dataAt += sizeof(fragmentCount);
+    int dataBytes = payload.size() - RELIABLE_DATA_HEADER_BYTES;
+    bool isLastFragment = (fragmentIndex + 1 == fragmentCount);
+
+    if (fragmentIndex == 0) {
+        _partialMessage.clear();
+        _isDiscardingMessage = false;
+
+    } else if (!_isDiscardingMessage && fragmentIndex != _nextFragmentIndex) {
+        qCWarning(networking) << "Discarding a reliable message with fragment" << fragmentIndex << "where"
+            << _nextFragmentIndex << "was expected";
+        _isDiscardingMessage = true;
+        _messagesDiscarded++;
+    }
+    bool isTooLarge = _partialMessage.size() > _maxMessageBytes - dataBytes;
+    if (!_isDiscardingMessage && (fragmentIndex >= fragmentCount || isTooLarge)) {
+        qCWarning(networking) << "Discarding a reliable message of" << fragmentCount << "fragments that is malformed"
+            << "or larger than" << _maxMessageBytes << "bytes";
+        _isDiscardingMessage = true;
+        _messagesDiscarded++;
+    }
+    if (_isDiscardingMessage) {
+        // let go of what was reassembled so far, then skip fragments until the next message starts
+        _partialMessage = QByteArray();
+        return;
+    }
+    _partialMessage.append(dataAt, dataBytes);
+    _nextFragmentIndex = fragmentIndex + 1;
+
+    if (isLastFragment) {
+        _receivedMessages.push_back(_partialMessage);
+        _partialMessage.clear();
+    }
+}
+
+std::vector<QByteArray> ReliableMessageChannel::takeOutgoingDataPayloads() {
+    std::vector<QByteArray> payloads;
+    payloads.swap(_outgoingDataPayloads);
+    return payloads;
+}
+
+std::vector<QByteArray> ReliableMessageChannel::takeOutgoingAckPayloads() {
+    std::vector<QByteArray> payloads;
+    payloads.swap(_outgoingAckPayloads);
+    return payloads;
+}
+
+std::vector<QByteArray> ReliableMessageChannel::takeReceivedMessages() {
+    std::vector<QByteArray> messages;
+    messages.swap(_receivedMessages);
+    return messages;
+}
@@ -0,0 +1,153 @@
+//
+//  ReliableMessageChannel.h
+//  libraries/networking/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Reliable, ordered delivery of messages of up to a configured size over unreliable datagrams, with selective
+//  acks and a delay based congestion controller.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ReliableMessageChannel_h
+#define hifi_ReliableMessageChannel_h
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include <QtCore/QByteArray>
+
+typedef quint32 ReliableSequenceNumber;
+
+const int RELIABLE_DATA_HEADER_BYTES = sizeof(ReliableSequenceNumber) + 2 * sizeof(quint32);
+const int RELIABLE_ACK_BYTES = sizeof(ReliableSequenceNumber) + sizeof(quint32);
+
+// leaves room for the hifi packet header that the node list adds in front of each fragment
+const int DEFAULT_RELIABLE_FRAGMENT_BYTES = 1200;
+
+// the largest message a channel sends or reassembles unless told otherwise
+const int DEFAULT_MAX_RELIABLE_MESSAGE_BYTES = 16 * 1024 * 1024;
+
+/// LEDBAT style congestion control: the window grows while the measured queuing delay (RTT above the lowest RTT
+/// seen recently) is below a target, and shrinks once we start filling queues along the path. Like TCP it starts out
+/// doubling the window every RTT, until the first loss or until queuing delay shows up.
+class DelayBasedCongestionControl {
+public:
+    static const quint64 TARGET_QUEUING_DELAY_USECS;
+    static const quint64 INITIAL_RETRANSMIT_TIMEOUT_USECS;
+    static const quint64 MIN_RETRANSMIT_TIMEOUT_USECS;
+    static const quint64 MAX_RETRANSMIT_TIMEOUT_USECS;
+    static const quint64 BASE_RTT_INTERVAL_USECS;
+
+    DelayBasedCongestionControl(int maxSegmentBytes = DEFAULT_RELIABLE_FRAGMENT_BYTES);
+
+    /// call for each newly acked segment that was only sent once
+    void onAck(int bytesAcked, quint64 rttUsecs, quint64 now);
+
+    /// call once per loss event detected through selective acks
+    void onLoss();
+
+    /// call when the retransmit timer expired
+    void onTimeout();
+
+    int getCongestionWindowBytes() const { return (int)_congestionWindow; }
+    quint64 getSmoothedRTT() const { return _smoothedRTT; }
+    quint64 getBaseRTT() const;
+    quint64 getRetransmitTimeout() const { return _retransmitTimeout; }
+
+private:
+    int _maxSegmentBytes;
+    float _congestionWindow;
+    bool _isInSlowStart;
+
+    quint64 _smoothedRTT;
+    quint64 _rttVariance;
+    quint64 _retransmitTimeout;
+
+    // base RTT is the min over the current and the previous interval, so it can rise again if the route changes
+    quint64 _currentIntervalMinRTT;
+    quint64 _previousIntervalMinRTT;
+    quint64 _currentIntervalStart;
+};
+
+/// One end of a reliable channel with a single peer. The channel does not touch the network: queued messages are cut
+/// into data payloads and acks are produced as ack payloads which the caller sends with whatever packet types and
+/// headers it uses, and payloads coming back from the peer are handed to processDataPayload() and processAckPayload().
+class ReliableMessageChannel {
+public:
+    ReliableMessageChannel(int maxFragmentBytes = DEFAULT_RELIABLE_FRAGMENT_BYTES,
+                           int maxMessageBytes = DEFAULT_MAX_RELIABLE_MESSAGE_BYTES);
+
+    /// Queue a message of up to getMaxMessageBytes() for delivery. Messages are delivered to the peer complete and in
+    /// queue order. Returns false, queuing nothing, if the message is too large.
+    bool queueMessage(const QByteArray& message);
+
+    void processDataPayload(const QByteArray& payload, quint64 now);
+    void processAckPayload(const QByteArray& payload, quint64 now);
+
+    /// Sends what the congestion window allows, retransmits lost fragments and produces a pending ack.
+    /// Call this regularly, every 10ms or so.
+    void update(quint64 now);
+
+    /// The largest message this end will queue, and the largest it will reassemble from the peer's fragments.
+    /// Incoming messages that grow past it are dropped whole, and delivery carries on with the next one.
+    void setMaxMessageBytes(int maxMessageBytes) { _maxMessageBytes = maxMessageBytes; }
+    int getMaxMessageBytes() const { return _maxMessageBytes; }
+
+    std::vector<QByteArray> takeOutgoingDataPayloads();
+    std::vector<QByteArray> takeOutgoingAckPayloads();
+    std::vector<QByteArray> takeReceivedMessages();
+
+    /// true if there is nothing queued or waiting to be acked
+    bool isIdle() const { return _unsentFragments.empty() && _inFlightFragments.empty(); }
+
+    int getBytesInFlight() const { return _bytesInFlight; }
+    const DelayBasedCongestionControl& getCongestionControl() const { return _congestionControl; }
+
+    quint64 getFragmentsSent() const { return _fragmentsSent; }
+    quint64 getFragmentsRetransmitted() const { return _fragmentsRetransmitted; }
+    quint64 getMessagesDiscarded() const { return _messagesDiscarded; }
+
+private:
+    class SentFragment {
+    public:
+        QByteArray payload;
+        quint64 sentAt;
+        bool wasRetransmitted;
+        int timesSkipped; // how many times a later fragment was acked while this one wasn't
+    };
+
+    void sendFragment(ReliableSequenceNumber sequence, SentFragment& fragment, quint64 now);
+    void ackFragment(std::map<ReliableSequenceNumber, SentFragment>::iterator it, quint64 now);
+    void receivedInOrder(const QByteArray& payload);
+
+    int _maxFragmentBytes;
+    int _maxMessageBytes;
+    DelayBasedCongestionControl _congestionControl;
+
+    // sending side
+    ReliableSequenceNumber _nextSequence;
+    std::deque<QByteArray> _unsentFragments;
+    std::map<ReliableSequenceNumber, SentFragment> _inFlightFragments;
+    int _bytesInFlight;
+    ReliableSequenceNumber _recoverySequence; // losses below this were part of a loss event we already reacted to
+    quint64 _fragmentsSent;
+    quint64 _fragmentsRetransmitted;
+    std::vector<QByteArray> _outgoingDataPayloads;
+
+    // receiving side
+    ReliableSequenceNumber _nextExpectedSequence;
+    std::map<ReliableSequenceNumber, QByteArray> _outOfOrderFragments;
+    QByteArray _partialMessage;
+    quint32 _nextFragmentIndex; // of the partial message
+    bool _isDiscardingMessage; // skipping the rest of a message that was too large or malformed
+    quint64 _messagesDiscarded;
+    bool _ackPending;
+    std::vector<QByteArray> _outgoingAckPayloads;
+    std::vector<QByteArray> _receivedMessages;
+};
+
+#endif // hifi_ReliableMessageChannel_h
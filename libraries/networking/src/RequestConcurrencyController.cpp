@@ -0,0 +1,68 @@
+//
+//  RequestConcurrencyController.cpp
+//  libraries/networking/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "RequestConcurrencyController.h"
+
+const int RequestConcurrencyController::MIN_LIMIT;
+const quint64 RequestConcurrencyController::WINDOW_USECS;
+const float RequestConcurrencyController::THROUGHPUT_TOLERANCE = 0.1f;
+
+RequestConcurrencyController::RequestConcurrencyController(int maxLimit) {
+    setMaxLimit(maxLimit);
+}
+
+void RequestConcurrencyController::setMaxLimit(int maxLimit) {
+    _maxLimit = qMax(MIN_LIMIT, maxLimit);
+    _limit = _maxLimit;
+
+    // what was measured under the old limit says nothing about the new one
+    _lastThroughput = 0.0f;
+}
+
+void RequestConcurrencyController::setLimit(int limit) {
+    _limit = qBound(MIN_LIMIT, limit, _maxLimit);
+}
+
+int RequestConcurrencyController::update(qint64 bytesReceived, quint64 now, bool saturated) {
+    if (_windowStart == 0) {
+        _windowStart = now;
+    }
+    _windowBytes += bytesReceived;
+    _windowSaturated = _windowSaturated && saturated;
+    if (now - _windowStart < WINDOW_USECS) {
+        return _limit;
+    }
+
+    // windows in which fewer downloads were wanted than allowed say nothing about the limit
+    if (_windowSaturated) {
+        float throughput = _windowBytes * (float)WINDOW_USECS / (now - _windowStart);
+        if (_lastThroughput > 0.0f) {
+            if (throughput < _lastThroughput * (1.0f - THROUGHPUT_TOLERANCE)) {
+                _direction = -_direction;
+                setLimit(_limit + _direction);
+
+            } else if (throughput > _lastThroughput * (1.0f + THROUGHPUT_TOLERANCE)) {
+                setLimit(_limit + _direction);
+            }
+        } else {
+            setLimit(_limit + _direction);
+        }
+
+        // at either end, the only way left to explore is back
+        if (_limit == _maxLimit || _limit == MIN_LIMIT) {
+            _direction = (_limit == _maxLimit) ? -1 : 1;
+        }
+        _lastThroughput = throughput;
+    }
+    _windowStart = now;
+    _windowBytes = 0;
+    _windowSaturated = true;
+    return _limit;
+}
@@ -0,0 +1,57 @@
+//
+//  RequestConcurrencyController.h
+//  libraries/networking/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_RequestConcurrencyController_h
+#define hifi_RequestConcurrencyController_h
+
+#include <QtGlobal>
+
+/// Tunes how many downloads run at once by hill climbing on measured throughput: while there are more downloads wanted
+/// than allowed, it keeps stepping the limit the same way as long as throughput rises, and turns around when it falls.
+/// The limit never goes above the configured maximum.
+class RequestConcurrencyController {
+public:
+
+    static const int MIN_LIMIT = 1;
+
+    /// Throughput is measured over windows of this length.
+    static const quint64 WINDOW_USECS = 1000 * 1000;
+
+    /// Changes in throughput smaller than this proportion are taken as noise.
+    static const float THROUGHPUT_TOLERANCE;
+
+    RequestConcurrencyController(int maxLimit = MIN_LIMIT);
+
+    /// Sets the most downloads allowed at once, starting the limit from there and working down.
+    void setMaxLimit(int maxLimit);
+    int getMaxLimit() const { return _maxLimit; }
+
+    void setLimit(int limit);
+    int getLimit() const { return _limit; }
+
+    /// Returns the throughput over the last complete window in which the limit was what held downloads back.
+    float getThroughput() const { return _lastThroughput; }
+
+    /// Records the bytes received since the last update and whether downloads were waiting for the limit, returning
+    /// the (possibly new) limit.
+    int update(qint64 bytesReceived, quint64 now, bool saturated);
+
+private:
+
+    int _maxLimit;
+    int _limit;
+    int _direction = 1;
+    quint64 _windowStart = 0;
+    qint64 _windowBytes = 0;
+    bool _windowSaturated = true;
+    float _lastThroughput = 0.0f;
+};
+
+#endif // hifi_RequestConcurrencyController_h
@@ -12,8 +12,8 @@
 #include <cfloat>
 #include <cmath>
 
+#include <QAbstractNetworkCache>
 #include <QDebug>
-#include <QNetworkDiskCache>
 #include <QThread>
 #include <QTimer>
 
@@ -134,14 +134,70 @@ void ResourceCache::reserveUnusedResource(qint64 resourceSize) {
     }
 }
 
+void ResourceCache::setRequestLimit(int limit) {
+    _concurrencyController.setMaxLimit(limit);
+    _requestLimit = _concurrencyController.getLimit();
+}
+
+void ResourceCache::updateRequests() {
+    auto sharedItems = DependencyManager::get<ResourceCacheSharedItems>();
+    
+    float highestPendingPriority = -FLT_MAX;
+    int wantedPendingCount = 0;
+    for (int i = 0; i < sharedItems->_pendingRequests.size(); ) {
+        Resource* resource = sharedItems->_pendingRequests.at(i).data();
+        if (!resource) {
+            sharedItems->_pendingRequests.removeAt(i);
+            continue;
+        }
+        highestPendingPriority = qMax(highestPendingPriority, resource->getLoadPriority());
+        if (!resource->isUnwanted()) {
+            wantedPendingCount++;
+        }
+        i++;
+    }
+    
+    // loads whose owners have all since gone (or lost interest) give up their places to any that are wanted
+    foreach (Resource* resource, sharedItems->_loadingRequests) {
+        if (wantedPendingCount > 0 && resource->isUnwanted()) {
+            requeueRequest(resource);
+            wantedPendingCount--;
+        }
+    }
+    _requestLimit = _concurrencyController.update(_bytesReceivedSinceUpdate, usecTimestampNow(),
+        !sharedItems->_pendingRequests.isEmpty());
+    _bytesReceivedSinceUpdate = 0;
+    
+    // when full, let the most important pending request take the place of the least important loading one if the
+    // difference is large and the loading one isn't far along; just one a frame, so that a moving view doesn't thrash
+    if (!sharedItems->_pendingRequests.isEmpty() && sharedItems->_loadingRequests.size() >= _requestLimit) {
+        Resource* lowestResource = nullptr;
+        float lowestPriority = FLT_MAX;
+        foreach (Resource* resource, sharedItems->_loadingRequests) {
+            float priority = resource->getLoadPriority();
+            if (resource->_prioritized && priority < lowestPriority) {
+                lowestPriority = priority;
+                lowestResource = resource;
+            }
+        }
+        const float PREEMPTION_PRIORITY_RATIO = 2.0f;
+        const float MAX_PREEMPTION_PROGRESS = 0.5f;
+        if (lowestResource && lowestResource->getProgress() < MAX_PREEMPTION_PROGRESS &&
+                (lowestPriority <= 0.0f ? highestPendingPriority > 0.0f :
+                    highestPendingPriority > lowestPriority * PREEMPTION_PRIORITY_RATIO)) {
+            requeueRequest(lowestResource);
+        }
+    }
+    startPendingRequests();
+}
+
 void ResourceCache::attemptRequest(Resource* resource) {
     auto sharedItems = DependencyManager::get<ResourceCacheSharedItems>();
-    if (_requestLimit <= 0) {
+    if (sharedItems->_loadingRequests.size() >= _requestLimit) {
         // wait until a slot becomes available
         sharedItems->_pendingRequests.append(resource);
         return;
     }
-    _requestLimit--;
     sharedItems->_loadingRequests.append(resource);
     resource->makeRequest();
 }
@@ -150,31 +206,52 @@ void ResourceCache::requestCompleted(Resource* resource) {
     
     auto sharedItems = DependencyManager::get<ResourceCacheSharedItems>();
     sharedItems->_loadingRequests.removeOne(resource);
-    _requestLimit++;
     
-    // look for the highest priority pending request
-    int highestIndex = -1;
-    float highestPriority = -FLT_MAX;
-    for (int i = 0; i < sharedItems->_pendingRequests.size(); ) {
-        Resource* resource = sharedItems->_pendingRequests.at(i).data();
-        if (!resource) {
-            sharedItems->_pendingRequests.removeAt(i);
-            continue;
+    startPendingRequests();
+}
+
+void ResourceCache::requeueRequest(Resource* resource) {
+    auto sharedItems = DependencyManager::get<ResourceCacheSharedItems>();
+    sharedItems->_loadingRequests.removeOne(resource);
+    resource->abortRequest();
+    sharedItems->_pendingRequests.append(resource);
+}
+
+void ResourceCache::startPendingRequests() {
+    auto sharedItems = DependencyManager::get<ResourceCacheSharedItems>();
+    while (sharedItems->_loadingRequests.size() < _requestLimit) {
+        // look for the highest priority pending request, those no longer wanted last of all
+        int highestIndex = -1;
+        bool highestWanted = false;
+        float highestPriority = -FLT_MAX;
+        for (int i = 0; i < sharedItems->_pendingRequests.size(); ) {
+            Resource* resource = sharedItems->_pendingRequests.at(i).data();
+            if (!resource) {
+                sharedItems->_pendingRequests.removeAt(i);
+                continue;
+            }
+            bool wanted = !resource->isUnwanted();
+            float priority = resource->getLoadPriority();
+            if ((wanted && !highestWanted) || (wanted == highestWanted && priority >= highestPriority)) {
+                highestWanted = wanted;
+                highestPriority = priority;
+                highestIndex = i;
+            }
+            i++;
         }
-        float priority = resource->getLoadPriority();
-        if (priority >= highestPriority) {
-            highestPriority = priority;
-            highestIndex = i;
+        if (highestIndex < 0) {
+            return;
         }
-        i++;
-    }
-    if (highestIndex >= 0) {
-        attemptRequest(sharedItems->_pendingRequests.takeAt(highestIndex));
+        Resource* resource = sharedItems->_pendingRequests.takeAt(highestIndex).data();
+        sharedItems->_loadingRequests.append(resource);
+        resource->makeRequest();
     }
 }
 
 const int DEFAULT_REQUEST_LIMIT = 10;
 int ResourceCache::_requestLimit = DEFAULT_REQUEST_LIMIT;
+RequestConcurrencyController ResourceCache::_concurrencyController(DEFAULT_REQUEST_LIMIT);
+qint64 ResourceCache::_bytesReceivedSinceUpdate = 0;
 
 Resource::Resource(const QUrl& url, bool delayLoad) :
     _url(url),
@@ -208,6 +285,7 @@ void Resource::ensureLoading() {
 void Resource::setLoadPriority(const QPointer<QObject>& owner, float priority) {
     if (!(_failedToLoad || _loaded)) {
         _loadPriorities.insert(owner, priority);
+        _prioritized = true;
     }
 }
 
@@ -218,6 +296,7 @@ void Resource::setLoadPriorities(const QHash<QPointer<QObject>, float>& prioriti
     for (QHash<QPointer<QObject>, float>::const_iterator it = priorities.constBegin();
             it != priorities.constEnd(); it++) {
         _loadPriorities.insert(it.key(), it.value());
+        _prioritized = true;
     }
 }
 
@@ -227,6 +306,10 @@ void Resource::clearLoadPriority(const QPointer<QObject>& owner) {
     }
 }
 
+bool Resource::isUnwanted() {
+    return _prioritized && getLoadPriority() == -FLT_MAX;
+}
+
 float Resource::getLoadPriority() {
     float highestPriority = -FLT_MAX;
     for (QHash<QPointer<QObject>, float>::iterator it = _loadPriorities.begin(); it != _loadPriorities.end(); ) {
@@ -315,6 +398,9 @@ void Resource::reinsert() {
 const int REPLY_TIMEOUT_MS = 5000;
 
 void Resource::handleDownloadProgress(qint64 bytesReceived, qint64 bytesTotal) {
+    if (bytesReceived > _bytesReceived) {
+        ResourceCache::_bytesReceivedSinceUpdate += bytesReceived - _bytesReceived;
+    }
     if (!_reply->isFinished()) {
         _bytesReceived = bytesReceived;
         _bytesTotal = bytesTotal;
@@ -342,10 +428,29 @@ void Resource::handleReplyTimeout() {
 }
 
 void Resource::maybeRefresh() {
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    reply->deleteLater();
     if (Q_LIKELY(NetworkAccessManager::getInstance().cache())) {
-        QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
-        QVariant variant = reply->header(QNetworkRequest::LastModifiedHeader);
         QNetworkCacheMetaData metaData = NetworkAccessManager::getInstance().cache()->metaData(_url);
+
+        // an entity tag identifies the content exactly, where there is one
+        static const QByteArray ETAG_HEADER = "ETag";
+        QByteArray entityTag = reply->rawHeader(ETAG_HEADER);
+        if (!entityTag.isEmpty() && metaData.isValid()) {
+            foreach (const QNetworkCacheMetaData::RawHeader& header, metaData.rawHeaders()) {
+                if (header.first.compare(ETAG_HEADER, Qt::CaseInsensitive) == 0 && !header.second.isEmpty()) {
+                    if (header.second == entityTag) {
+                        qCDebug(networking) << "Using cached version of" << _url.fileName();
+                        return;
+                    }
+                    qCDebug(networking) << "Loaded" << _url.fileName() <<
+                        "from the disk cache but the network version has changed, refreshing.";
+                    refresh();
+                    return;
+                }
+            }
+        }
+        QVariant variant = reply->header(QNetworkRequest::LastModifiedHeader);
         if (variant.isValid() && variant.canConvert<QDateTime>() && metaData.isValid()) {
             QDateTime lastModified = variant.value<QDateTime>();
             QDateTime lastModifiedOld = metaData.lastModified();
@@ -407,6 +512,17 @@ void Resource::makeRequest() {
     _bytesReceived = _bytesTotal = 0;
 }
 
+void Resource::abortRequest() {
+    _reply->disconnect(this);
+    _replyTimer->disconnect(this);
+    _reply->abort();
+    _reply->deleteLater();
+    _reply = nullptr;
+    _replyTimer->deleteLater();
+    _replyTimer = nullptr;
+    _bytesReceived = _bytesTotal = 0;
+}
+
 void Resource::handleReplyError(QNetworkReply::NetworkError error, QDebug debug) {
     _reply->disconnect(this);
     _replyTimer->disconnect(this);
@@ -26,6 +26,8 @@
 
 #include <DependencyManager.h>
 
+#include "RequestConcurrencyController.h"
+
 class QNetworkReply;
 class QTimer;
 
@@ -64,8 +66,12 @@ class ResourceCache : public QObject {
     Q_OBJECT
     
 public:
-    static void setRequestLimit(int limit) { _requestLimit = limit; }
-    static int getRequestLimit() { return _requestLimit; }
+    /// Sets the most requests to run at once. The number actually run adapts to the throughput they get, up to this.
+    static void setRequestLimit(int limit);
+    static int getRequestLimit() { return _concurrencyController.getMaxLimit(); }
+
+    /// Returns the number of requests currently allowed to run at once.
+    static int getCurrentRequestLimit() { return _requestLimit; }
     
     void setUnusedResourceCacheSize(qint64 unusedResourcesMaxSize);
     qint64 getUnusedResourceCacheSize() const { return _unusedResourcesMaxSize; }
@@ -81,6 +87,11 @@ public:
 
     void refresh(const QUrl& url);
 
+    /// Re-ranks the pending and loading requests by their owners' current priorities, to be called once a frame after
+    /// those are updated: loads that no owner wants anymore give up their places, a pending request much more important
+    /// than a barely started one takes its place, and the request limit adapts to the throughput measured.
+    static void updateRequests();
+
 public slots:
     void checkAsynchronousGets();
 
@@ -106,6 +117,8 @@ protected:
     
     static void attemptRequest(Resource* resource);
     static void requestCompleted(Resource* resource);
+    static void requeueRequest(Resource* resource);
+    static void startPendingRequests();
 
 private:
     friend class Resource;
@@ -114,6 +127,8 @@ private:
     int _lastLRUKey = 0;
     
     static int _requestLimit;
+    static RequestConcurrencyController _concurrencyController;
+    static qint64 _bytesReceivedSinceUpdate;
 
     void getResourceAsynchronously(const QUrl& url);
     QReadWriteLock _resourcesToBeGottenLock;
@@ -148,6 +163,9 @@ public:
     /// Returns the highest load priority across all owners.
     float getLoadPriority();
 
+    /// Checks whether the resource had owners setting its load priority, none of which remain.
+    bool isUnwanted();
+
     /// Checks whether the resource has loaded.
     bool isLoaded() const { return _loaded; }
 
@@ -180,8 +198,8 @@ protected slots:
 
     void attemptRequest();
     
-    /// Refreshes the resource if the last modified date on the network
-    /// is greater than the last modified date in the cache.
+    /// Refreshes the resource if the entity tag on the network differs from the one in the cache or, failing
+    /// those, if the last modified date on the network is greater than the last modified date in the cache.
     void maybeRefresh();
 
 protected:
@@ -218,12 +236,14 @@ private:
     void setLRUKey(int lruKey) { _lruKey = lruKey; }
     
     void makeRequest();
+    void abortRequest();
     
     void handleReplyError(QNetworkReply::NetworkError error, QDebug debug);
     
     friend class ResourceCache;
     
     int _lruKey = 0;
+    bool _prioritized = false;
     QNetworkReply* _reply = nullptr;
     QTimer* _replyTimer = nullptr;
     qint64 _bytesReceived = 0;
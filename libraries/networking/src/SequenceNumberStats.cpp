@@ -16,7 +16,7 @@
 
 SequenceNumberStats::SequenceNumberStats(int statsHistoryLength, bool canDetectOutOfSync)
     : _lastReceivedSequence(0),
-    _missingSet(),
+    _missingBits(),
     _stats(),
     _lastSenderUUID(),
     _statsHistory(statsHistoryLength),
@@ -26,7 +26,7 @@ SequenceNumberStats::SequenceNumberStats(int statsHistoryLength, bool canDetectO
 }
 
 void SequenceNumberStats::reset() {
-    _missingSet.clear();
+    _missingBits.reset();
     _stats = PacketStreamStats();
     _lastSenderUUID = QUuid();
     _statsHistory.clear();
@@ -57,7 +57,12 @@ SequenceNumberStats::ArrivalInfo SequenceNumberStats::sequenceNumberReceived(qui
 
     if (incoming == expected) { // on time
         arrivalInfo._status = OnTime;
-        _lastReceivedSequence = incoming;
+        if (_stats._received == 1) {
+            // first packet from this sender, there's nothing before it that could be missing
+            _lastReceivedSequence = incoming;
+        } else {
+            advanceLastReceived(incoming);
+        }
         _stats._expectedReceived++;
     } else { // out of order
 
@@ -106,18 +111,9 @@ SequenceNumberStats::ArrivalInfo SequenceNumberStats::sequenceNumberReceived(qui
             _stats._early++;
             _stats._lost += skipped;
             _stats._expectedReceived += (skipped + 1);
-            _lastReceivedSequence = incoming;
 
-            // add all sequence numbers that were skipped to the missing sequence numbers list
-            for (int missingInt = expectedInt; missingInt < incomingInt; missingInt++) {
-                _missingSet.insert((quint16)(missingInt < 0 ? missingInt + UINT16_RANGE : missingInt));
-            }
-
-            // prune missing sequence list if it gets too big; sequence numbers that are older than MAX_REASONABLE_SEQUENCE_GAP
-            // will be removed.
-            if (_missingSet.size() > MAX_REASONABLE_SEQUENCE_GAP) {
-                pruneMissingSet(wantExtraDebugging);
-            }
+            // this marks all sequence numbers that were skipped as missing
+            advanceLastReceived(incoming);
         } else { // late
             if (wantExtraDebugging) {
                 qCDebug(networking) << "this packet is later than expected...";
@@ -128,11 +124,12 @@ SequenceNumberStats::ArrivalInfo SequenceNumberStats::sequenceNumberReceived(qui
             // do not update _lastReceived; it shouldn't become smaller
 
             // remove this from missing sequence number if it's in there
-            if (_missingSet.remove(incoming)) {
+            if (isMissing(incoming)) {
+                _missingBits.reset(missingBitFor(incoming));
                 arrivalInfo._status = Recovered;
 
                 if (wantExtraDebugging) {
-                    qCDebug(networking) << "found it in _missingSet";
+                    qCDebug(networking) << "found it in missing sequence numbers";
                 }
                 _stats._lost--;
                 _stats._recovered++;
@@ -173,7 +170,7 @@ void SequenceNumberStats::receivedUnreasonable(quint16 incoming) {
             // the seq num sender.  update our state to get back in sync with the sender.
 
             _lastReceivedSequence = incoming;
-            _missingSet.clear();
+            _missingBits.reset();
 
             _stats._received = CONSECUTIVE_UNREASONABLE_ON_TIME_THRESHOLD;
             _stats._unreasonable = 0;
@@ -193,54 +190,43 @@ void SequenceNumberStats::receivedUnreasonable(quint16 incoming) {
     }
 }
 
-void SequenceNumberStats::pruneMissingSet(const bool wantExtraDebugging) {
-    if (wantExtraDebugging) {
-        qCDebug(networking) << "pruning _missingSet! size:" << _missingSet.size();
+void SequenceNumberStats::advanceLastReceived(quint16 incoming) {
+    // incoming is at most MAX_REASONABLE_SEQUENCE_GAP + 1 ahead of _lastReceivedSequence.
+    // sequence numbers falling out of the recoverable window are forgotten, this is what pruning the missing set used
+    // to do. Their bits are then reused for the sequence numbers we skipped over, which are now missing.
+    quint16 advance = incoming - _lastReceivedSequence;
+    quint16 oldestRecoverable = _lastReceivedSequence - (quint16)MAX_REASONABLE_SEQUENCE_GAP;
+    for (quint16 i = 0; i < advance; i++) {
+        _missingBits.reset(missingBitFor(oldestRecoverable + i));
     }
+    for (quint16 skipped = _lastReceivedSequence + (quint16)1; skipped != incoming; skipped++) {
+        _missingBits.set(missingBitFor(skipped));
+    }
+    _lastReceivedSequence = incoming;
+}
 
-    // some older sequence numbers may be from before a rollover point; this must be handled.
-    // some sequence numbers in this list may be larger than _incomingLastSequence, indicating that they were received
-    // before the most recent rollover.
-    int cutoff = (int)_lastReceivedSequence - MAX_REASONABLE_SEQUENCE_GAP;
-    if (cutoff >= 0) {
-        quint16 nonRolloverCutoff = (quint16)cutoff;
-        QSet<quint16>::iterator i = _missingSet.begin();
-        while (i != _missingSet.end()) {
-            quint16 missing = *i;
-            if (wantExtraDebugging) {
-                qCDebug(networking) << "checking item:" << missing << "is it in need of pruning?";
-                qCDebug(networking) << "old age cutoff:" << nonRolloverCutoff;
-            }
-
-            if (missing > _lastReceivedSequence || missing < nonRolloverCutoff) {
-                i = _missingSet.erase(i);
-                if (wantExtraDebugging) {
-                    qCDebug(networking) << "pruning really old missing sequence:" << missing;
-                }
-            } else {
-                i++;
-            }
-        }
-    } else {
-        quint16 rolloverCutoff = (quint16)(cutoff + UINT16_RANGE);
-        QSet<quint16>::iterator i = _missingSet.begin();
-        while (i != _missingSet.end()) {
-            quint16 missing = *i;
-            if (wantExtraDebugging) {
-                qCDebug(networking) << "checking item:" << missing << "is it in need of pruning?";
-                qCDebug(networking) << "old age cutoff:" << rolloverCutoff;
-            }
+bool SequenceNumberStats::isMissing(quint16 sequence) const {
+    // only sequence numbers within the recoverable window have meaningful bits
+    quint16 age = _lastReceivedSequence - sequence;
+    if (age == 0 || age > MAX_REASONABLE_SEQUENCE_GAP) {
+        return false;
+    }
+    return _missingBits.test(missingBitFor(sequence));
+}
 
-            if (missing > _lastReceivedSequence && missing < rolloverCutoff) {
-                i = _missingSet.erase(i);
-                if (wantExtraDebugging) {
-                    qCDebug(networking) << "pruning really old missing sequence:" << missing;
-                }
-            } else {
-                i++;
+QSet<quint16> SequenceNumberStats::getMissingSet() const {
+    QSet<quint16> missingSet;
+    int missingCount = getMissingCount();
+    if (missingCount > 0) {
+        missingSet.reserve(missingCount);
+        quint16 sequence = _lastReceivedSequence - (quint16)MAX_REASONABLE_SEQUENCE_GAP;
+        for (; sequence != _lastReceivedSequence; sequence++) {
+            if (_missingBits.test(missingBitFor(sequence))) {
+                missingSet.insert(sequence);
             }
         }
     }
+    return missingSet;
 }
 
 PacketStreamStats SequenceNumberStats::getStatsForHistoryWindow() const {
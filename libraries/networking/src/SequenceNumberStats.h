@@ -12,12 +12,19 @@
 #ifndef hifi_SequenceNumberStats_h
 #define hifi_SequenceNumberStats_h
 
+#include <bitset>
+
 #include "SharedUtil.h"
 #include "RingBufferHistory.h"
 #include <quuid.h>
 
 const int MAX_REASONABLE_SEQUENCE_GAP = 1000;
 
+// the missing sequence numbers are tracked in a bitmap over the sequence numbers that can still be recovered,
+// [_lastReceivedSequence - MAX_REASONABLE_SEQUENCE_GAP, _lastReceivedSequence). It must be a power of two
+// that divides the 16 bit sequence space so that rollover maps onto the same bits.
+const int MISSING_SEQUENCE_WINDOW = 1024;
+
 
 class PacketStreamStats {
 public:
@@ -74,7 +81,6 @@ public:
 
     void reset();
     ArrivalInfo sequenceNumberReceived(quint16 incoming, QUuid senderUUID = QUuid(), const bool wantExtraDebugging = false);
-    void pruneMissingSet(const bool wantExtraDebugging = false);
     void pushStatsToHistory() { _statsHistory.insert(_stats); }
 
     quint32 getReceived() const { return _stats._received; }
@@ -89,14 +95,21 @@ public:
     const PacketStreamStats& getStats() const { return _stats; }
     PacketStreamStats getStatsForHistoryWindow() const;
     PacketStreamStats getStatsForLastHistoryInterval() const;
-    const QSet<quint16>& getMissingSet() const { return _missingSet; }
+
+    /// the sequence numbers that have not been received yet and are still recent enough to be recovered
+    QSet<quint16> getMissingSet() const;
+    int getMissingCount() const { return (int)_missingBits.count(); }
+    bool isMissing(quint16 sequence) const;
 
 private:
     void receivedUnreasonable(quint16 incoming);
+    void advanceLastReceived(quint16 incoming);
+
+    static int missingBitFor(quint16 sequence) { return sequence & (MISSING_SEQUENCE_WINDOW - 1); }
 
 private:
     quint16 _lastReceivedSequence;
-    QSet<quint16> _missingSet;
+    std::bitset<MISSING_SEQUENCE_WINDOW> _missingBits;
 
     PacketStreamStats _stats;
 
@@ -94,6 +94,24 @@ void ThreadedAssignment::commonInit(const QString& targetName, NodeType_t nodeTy
     }
 }
 
+void ThreadedAssignment::parseAutoscalingSettings(const QJsonObject& domainSettings) {
+    const QString AUTOSCALING_SETTINGS_KEY = "autoscaling";
+    const QString REPLICATION_ENABLED_KEY = "enable_mixer_replication";
+    const QString LOAD_THRESHOLD_KEY = "load_threshold";
+
+    QJsonObject autoscalingObject = domainSettings[AUTOSCALING_SETTINGS_KEY].toObject();
+    _loadThreshold = NO_LOAD_THRESHOLD;
+
+    if (autoscalingObject[REPLICATION_ENABLED_KEY].toBool()) {
+        // values saved from the settings page come back as strings
+        bool ok = false;
+        float loadThreshold = autoscalingObject[LOAD_THRESHOLD_KEY].toVariant().toFloat(&ok);
+        if (ok) {
+            _loadThreshold = loadThreshold;
+        }
+    }
+}
+
 void ThreadedAssignment::addPacketStatsAndSendStatsPacket(QJsonObject &statsObject) {
     auto nodeList = DependencyManager::get<NodeList>();
 
@@ -105,6 +123,10 @@ void ThreadedAssignment::addPacketStatsAndSendStatsPacket(QJsonObject &statsObje
     statsObject["packets_per_second"] = packetsPerSecond;
     statsObject["bytes_per_second"] = bytesPerSecond;
 
+    if (statsObject.contains(ASSIGNMENT_LOAD_STATS_KEY)) {
+        _lastReportedLoad = statsObject[ASSIGNMENT_LOAD_STATS_KEY].toDouble();
+    }
+
     nodeList->sendStatsToDomainServer(statsObject);
 }
 
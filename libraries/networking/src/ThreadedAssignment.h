@@ -16,6 +16,15 @@
 
 #include "Assignment.h"
 
+// normalized 0 to 1 load an assignment reports in its stats, used by the domain-server and the assignment-client monitor
+// to decide when another instance is needed
+const QString ASSIGNMENT_LOAD_STATS_KEY = "load";
+
+// the domain-server's autoscaling load threshold an assignment passes on to the assignment-client monitor, loads never
+// go above NO_LOAD_THRESHOLD so it is used while the assignment isn't being replicated
+const QString ASSIGNMENT_LOAD_THRESHOLD_STATS_KEY = "load_threshold";
+const float NO_LOAD_THRESHOLD = 1.0f;
+
 class ThreadedAssignment : public Assignment {
     Q_OBJECT
 public:
@@ -26,6 +35,12 @@ public:
     virtual void aboutToFinish() { };
     void addPacketStatsAndSendStatsPacket(QJsonObject& statsObject);
 
+    /// the load from the last stats packet this assignment sent, if it reports one
+    float getLastReportedLoad() const { return _lastReportedLoad; }
+
+    /// the load above which the domain-server adds another instance of this assignment
+    float getLoadThreshold() const { return _loadThreshold; }
+
 public slots:
     /// threaded run of assignment
     virtual void run() = 0;
@@ -39,10 +54,13 @@ signals:
 protected:
     bool readAvailableDatagram(QByteArray& destinationByteArray, HifiSockAddr& senderSockAddr);
     void commonInit(const QString& targetName, NodeType_t nodeType, bool shouldSendStats = true);
+    void parseAutoscalingSettings(const QJsonObject& domainSettings);
     bool _isFinished;
     QThread* _datagramProcessingThread;
     QTimer* _domainServerTimer = nullptr;
     QTimer* _statsTimer = nullptr;
+    float _lastReportedLoad = 0.0f;
+    float _loadThreshold = NO_LOAD_THRESHOLD;
 
 private slots:
     void checkInWithDomainServerOrExit();
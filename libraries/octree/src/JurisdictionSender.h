@@ -37,6 +37,9 @@ public:
     NodeType_t getNodeType() const { return _nodeType; }
     void setNodeType(NodeType_t type) { _nodeType = type; }
 
+    /// how long the outgoing jurisdiction packets wait in the packet sender's queue
+    MovingMinMaxAvg<quint64> getQueueWaitStats() { return _packetSender.getQueueWaitStats(); }
+
 protected:
     virtual void processPacket(const SharedNodePointer& sendingNode, const QByteArray& packet);
 
@@ -92,6 +92,9 @@ void OctreeEditPacketSender::queuePacketToNode(const QUuid& nodeUUID, unsigned c
             && ((node->getUUID() == nodeUUID) || (nodeUUID.isNull()))
             && node->getActiveSocket()) {
             
+            // the sequence number, the send queue and the history have to agree
+            QMutexLocker historiesLocker(&_sentPacketHistoriesLock);
+
             // pack sequence number
             int numBytesPacketHeader = numBytesForPacketHeader(reinterpret_cast<char*>(buffer));
             unsigned char* sequenceAt = buffer + numBytesPacketHeader;
@@ -103,15 +106,16 @@ void OctreeEditPacketSender::queuePacketToNode(const QUuid& nodeUUID, unsigned c
             
             queuePacketForSending(node, packet);
             
+            // add packet to history
+            _sentPacketHistories[nodeUUID].packetSent(sequence, packet);
+            historiesLocker.unlock();
+            
             if (hasDestinationWalletUUID() && satoshiCost > 0) {
                 // if we have a destination wallet UUID and a cost associated with this packet, signal that it
                 // needs to be sent
                 emit octreePaymentRequired(satoshiCost, nodeUUID, _destinationWalletUUID);
             }
             
-            // add packet to history
-            _sentPacketHistories[nodeUUID].packetSent(sequence, packet);
-            
             // debugging output...
             if (wantDebug) {
                 int numBytesPacketHeader = numBytesForPacketHeader(reinterpret_cast<const char*>(buffer));
@@ -360,6 +364,7 @@ bool OctreeEditPacketSender::process() {
 void OctreeEditPacketSender::processNackPacket(const QByteArray& packet) {
     // parse sending node from packet, retrieve packet history for that node
     QUuid sendingNodeUUID = uuidFromPacketHeader(packet);
+    QMutexLocker historiesLocker(&_sentPacketHistoriesLock);
     
     // if packet history doesn't exist for the sender node (somehow), bail
     if (!_sentPacketHistories.contains(sendingNodeUUID)) {
@@ -389,9 +394,12 @@ void OctreeEditPacketSender::processNackPacket(const QByteArray& packet) {
 }
 
 void OctreeEditPacketSender::nodeKilled(SharedNodePointer node) {
-    // TODO: add locks
     QUuid nodeUUID = node->getUUID();
+    _packetsQueueLock.lock();
     _pendingEditPackets.remove(nodeUUID);
+    _packetsQueueLock.unlock();
+
+    QMutexLocker historiesLocker(&_sentPacketHistoriesLock);
     _outgoingSequenceNumbers.remove(nodeUUID);
     _sentPacketHistories.remove(nodeUUID);
 }
@@ -123,7 +123,8 @@ protected:
 
     QMutex _releaseQueuedPacketMutex;
 
-    // TODO: add locks for this and _pendingEditPackets
+    // edits may be queued from several threads, e.g. the script threads of an agent host
+    QMutex _sentPacketHistoriesLock;
     QHash<QUuid, SentPacketHistory> _sentPacketHistories;
     QHash<QUuid, quint16> _outgoingSequenceNumbers;
     
@@ -324,9 +324,7 @@ bool EntityMotionState::shouldSendUpdate(uint32_t simulationStep, const QUuid& s
     return false;
 }
 
-void EntityMotionState::sendUpdate(OctreeEditPacketSender* packetSender, const QUuid& sessionID, uint32_t step) {
-    assert(_entity);
-
+bool EntityMotionState::prepareUpdate() {
     bool active = _body->isActive();
     if (!active) {
         // make sure all derivatives are zero
@@ -381,6 +379,14 @@ void EntityMotionState::sendUpdate(OctreeEditPacketSender* packetSender, const Q
     _serverAcceleration = _entity->getAcceleration();
     _serverAngularVelocity = _entity->getAngularVelocity();
 
+    return active;
+}
+
+void EntityMotionState::sendUpdate(OctreeEditPacketSender* packetSender, const QUuid& sessionID, uint32_t step) {
+    assert(_entity);
+
+    bool active = prepareUpdate();
+
     EntityItemProperties properties = _entity->getProperties();
 
     // explicitly set the properties that changed so that they will be packed
@@ -420,11 +426,22 @@ void EntityMotionState::sendUpdate(OctreeEditPacketSender* packetSender, const Q
     if (EntityItem::getSendPhysicsUpdates()) {
         EntityItemID id(_entity->getID());
         EntityEditPacketSender* entityPacketSender = static_cast<EntityEditPacketSender*>(packetSender);
-        #ifdef WANT_DEBUG
-            qCDebug(physics) << "EntityMotionState::sendUpdate()... calling queueEditEntityMessage()...";
-        #endif
-
-        entityPacketSender->queueEditEntityMessage(PacketTypeEntityEdit, id, properties);
+        if (sessionID == _entity->getSimulatorID()) {
+            // the server already knows we own this one, only the physics state changed and it goes out batched
+            EntityPhysicsState state;
+            state.position = _serverPosition;
+            state.rotation = _serverRotation;
+            state.velocity = _serverVelocity;
+            state.angularVelocity = _serverAngularVelocity;
+            state.isBallistic = _serverAcceleration != glm::vec3(0.0f);
+            state.isReleasingOwnership = !active;
+            entityPacketSender->queuePhysicsStateUpdate(_entity->getID(), state);
+        } else {
+            #ifdef WANT_DEBUG
+                qCDebug(physics) << "EntityMotionState::sendUpdate()... calling queueEditEntityMessage()...";
+            #endif
+            entityPacketSender->queueEditEntityMessage(PacketTypeEntityEdit, id, properties);
+        }
         _entity->setLastBroadcast(usecTimestampNow());
     } else {
         #ifdef WANT_DEBUG
@@ -435,6 +452,28 @@ void EntityMotionState::sendUpdate(OctreeEditPacketSender* packetSender, const Q
     _lastStep = step;
 }
 
+void EntityMotionState::applyUpdateLocally(const QUuid& sessionID, uint32_t step) {
+    assert(_entity);
+
+    bool active = prepareUpdate();
+
+    // there is no server to ask for ownership, we are the server: take it while the body moves, let go once it rests
+    if (active) {
+        if (_entity->getSimulatorID() != sessionID) {
+            _entity->setSimulatorID(sessionID);
+        }
+    } else if (_entity->getSimulatorID() == sessionID) {
+        _entity->setSimulatorID(QUuid());
+    }
+
+    // this also marks the entity as changed on the server, so the send threads will pass it on
+    quint64 now = usecTimestampNow();
+    _entity->setLastEdited(now);
+    _entity->setLastBroadcast(now);
+
+    _lastStep = step;
+}
+
 uint32_t EntityMotionState::getAndClearIncomingDirtyFlags() { 
     uint32_t dirtyFlags = 0;
     if (_body && _entity) {
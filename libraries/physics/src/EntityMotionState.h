@@ -48,6 +48,10 @@ public:
     bool shouldSendUpdate(uint32_t simulationStep, const QUuid& sessionID);
     void sendUpdate(OctreeEditPacketSender* packetSender, const QUuid& sessionID, uint32_t step);
 
+    /// Used when the entity server runs physics itself: the update goes straight into its entity instead of out as
+    /// an edit packet, and is sent on to clients like any other change on the server.
+    void applyUpdateLocally(const QUuid& sessionID, uint32_t step);
+
     virtual uint32_t getAndClearIncomingDirtyFlags();
 
     void incrementAccelerationNearlyGravityCount() { _accelerationNearlyGravityCount++; }
@@ -87,6 +91,9 @@ protected:
     virtual void clearObjectBackPointer();
     virtual void setMotionType(MotionType motionType);
 
+    /// settles the velocities and acceleration others should extrapolate from, returns true if the body is active
+    bool prepareUpdate();
+
     EntityItemPointer _entity;
 
     bool _sentActive;   // true if body was active when we sent last update
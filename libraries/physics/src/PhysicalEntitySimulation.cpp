@@ -11,6 +11,8 @@
 
 
 
+#include <LimitedNodeList.h>
+
 #include "PhysicsHelpers.h"
 #include "PhysicsLogging.h"
 #include "ShapeManager.h"
@@ -33,17 +35,51 @@ void PhysicalEntitySimulation::init(
     assert(physicsEngine);
     _physicsEngine = physicsEngine;
 
-    assert(packetSender);
+    assert(packetSender || _isAuthoritative);
     _entityPacketSender = packetSender;
 }
 
 // begin EntitySimulation overrides
 void PhysicalEntitySimulation::updateEntitiesInternal(const quint64& now) {
-    // Do nothing here because the "internal" update the PhysicsEngine::stepSimualtion() which is done elsewhere.
+    // The "internal" update is PhysicsEngine::stepSimulation() which is done elsewhere. All that is left to do here
+    // is what SimpleEntitySimulation does for the entity server: clear the owner of entities whose simulator is gone.
+    if (!isAuthoritative()) {
+        return;
+    }
+    auto nodeList = DependencyManager::get<LimitedNodeList>();
+    const QUuid& sessionID = _physicsEngine->getSessionID();
+
+    SetOfEntities::iterator itemItr = _hasSimulationOwnerEntities.begin();
+    while (itemItr != _hasSimulationOwnerEntities.end()) {
+        EntityItemPointer entity = *itemItr;
+        if (!isOwnedByOtherSimulator(entity, sessionID)) {
+            itemItr = _hasSimulationOwnerEntities.erase(itemItr);
+        } else if (now - entity->getLastChangedOnServer() >= AUTO_REMOVE_SIMULATION_OWNER_USEC) {
+            SharedNodePointer ownerNode = nodeList->nodeWithUUID(entity->getSimulatorID());
+            if (ownerNode.isNull() || !ownerNode->isAlive()) {
+                qCDebug(physics) << "auto-removing simulation owner" << entity->getSimulatorID();
+                // our own copy kept simulating, it will take the entity over if it is still moving
+                entity->setSimulatorID(QUuid());
+                itemItr = _hasSimulationOwnerEntities.erase(itemItr);
+            } else {
+                ++itemItr;
+            }
+        } else {
+            ++itemItr;
+        }
+    }
+}
+
+bool PhysicalEntitySimulation::isOwnedByOtherSimulator(EntityItemPointer entity, const QUuid& sessionID) const {
+    const QUuid& simulatorID = entity->getSimulatorID();
+    return !simulatorID.isNull() && simulatorID != sessionID;
 }
 
 void PhysicalEntitySimulation::addEntityInternal(EntityItemPointer entity) {
     assert(entity);
+    if (isAuthoritative() && !entity->getSimulatorID().isNull()) {
+        _hasSimulationOwnerEntities.insert(entity);
+    }
     if (entity->shouldBePhysical()) { 
         EntityMotionState* motionState = static_cast<EntityMotionState*>(entity->getPhysicsInfo());
         if (!motionState) {
@@ -63,11 +99,15 @@ void PhysicalEntitySimulation::removeEntityInternal(EntityItemPointer entity) {
         _outgoingChanges.remove(motionState);
     }
     _pendingAdds.remove(entity);
+    _hasSimulationOwnerEntities.remove(entity);
 }
 
 void PhysicalEntitySimulation::changeEntityInternal(EntityItemPointer entity) {
     // queue incoming changes: from external sources (script, EntityServer, etc) to physics engine
     assert(entity);
+    if (isAuthoritative() && !entity->getSimulatorID().isNull()) {
+        _hasSimulationOwnerEntities.insert(entity);
+    }
     EntityMotionState* motionState = static_cast<EntityMotionState*>(entity->getPhysicsInfo());
     if (motionState) {
         if (!entity->shouldBePhysical()) {
@@ -117,6 +157,7 @@ void PhysicalEntitySimulation::clearEntitiesInternal() {
     _pendingRemoves.clear();
     _pendingAdds.clear();
     _pendingChanges.clear();
+    _hasSimulationOwnerEntities.clear();
 }
 // end EntitySimulation overrides
 
@@ -191,7 +232,9 @@ void PhysicalEntitySimulation::handleOutgoingChanges(VectorOfMotionStates& motio
             EntityMotionState* entityState = static_cast<EntityMotionState*>(state);
             EntityItemPointer entity = entityState->getEntity();
             if (entity) {
-                if (entityState->isCandidateForOwnership(sessionID)) {
+                // the entity server never bids against a client, clients can still take objects from it
+                if (entityState->isCandidateForOwnership(sessionID)
+                        && !(isAuthoritative() && isOwnedByOtherSimulator(entity, sessionID))) {
                     _outgoingChanges.insert(entityState);
                 }
                 _entitiesToSort.insert(entityState->getEntity());
@@ -213,15 +256,24 @@ void PhysicalEntitySimulation::handleOutgoingChanges(VectorOfMotionStates& motio
         QSet<EntityMotionState*>::iterator stateItr = _outgoingChanges.begin();
         while (stateItr != _outgoingChanges.end()) {
             EntityMotionState* state = *stateItr;
-            if (!state->isCandidateForOwnership(sessionID)) {
+            if (!state->isCandidateForOwnership(sessionID)
+                    || (isAuthoritative() && isOwnedByOtherSimulator(state->getEntity(), sessionID))) {
                 stateItr = _outgoingChanges.erase(stateItr);
             } else if (state->shouldSendUpdate(numSubsteps, sessionID)) {
-                state->sendUpdate(_entityPacketSender, sessionID, numSubsteps);
+                if (isAuthoritative()) {
+                    state->applyUpdateLocally(sessionID, numSubsteps);
+                } else {
+                    state->sendUpdate(_entityPacketSender, sessionID, numSubsteps);
+                }
                 ++stateItr;
             } else {
                 ++stateItr;
             }
         }
+        if (!isAuthoritative()) {
+            // everything from this step goes out in as few datagrams as it fits in
+            _entityPacketSender->flushPhysicsStateUpdates();
+        }
     }
 }
 
@@ -30,6 +30,12 @@ public:
     PhysicalEntitySimulation();
     ~PhysicalEntitySimulation();
 
+    /// The entity server's own simulation is authoritative: it takes over unowned objects, writes their state straight
+    /// into the tree and releases objects whose owner left the domain. It is set before init(), and only an
+    /// authoritative simulation may go without a packet sender.
+    void setIsAuthoritative(bool isAuthoritative) { _isAuthoritative = isAuthoritative; }
+    bool isAuthoritative() const { return _isAuthoritative; }
+
     void init(EntityTree* tree, PhysicsEngine* engine, EntityEditPacketSender* packetSender);
 
     virtual void applyActionChanges();
@@ -51,6 +57,7 @@ public:
     void handleCollisionEvents(CollisionEvents& collisionEvents);
 
 private:
+    bool isOwnedByOtherSimulator(EntityItemPointer entity, const QUuid& sessionID) const;
     // incoming changes
     SetOfEntityMotionStates _pendingRemoves; // EntityMotionStates to be removed from PhysicsEngine (and deleted)
     SetOfEntities _pendingAdds; // entities to be be added to PhysicsEngine (and a their EntityMotionState created)
@@ -60,10 +67,12 @@ private:
     SetOfEntityMotionStates _outgoingChanges; // EntityMotionStates for which we need to send updates to entity-server
 
     SetOfMotionStates _physicalObjects; // MotionStates of entities in PhysicsEngine
+    SetOfEntities _hasSimulationOwnerEntities; // only tracked when authoritative
     VectorOfMotionStates _tempVector; // temporary array reference, valid immediately after getObjectsToRemove() (and friends)
 
     PhysicsEngine* _physicsEngine = nullptr;
     EntityEditPacketSender* _entityPacketSender = nullptr;
+    bool _isAuthoritative = false;
 
     uint32_t _lastStepSendPackets = 0;
 };
@@ -21,7 +21,9 @@
 #include <gpu/Batch.h>
 #include <gpu/GLBackend.h>
 
+#include <BakedGeometry.h>
 #include <FSTReader.h>
+#include <MeshOptimizer.h>
 #include <NumericalConstants.h>
 
 #include "TextureCache.h"
@@ -1790,13 +1792,27 @@ void GeometryCache::renderLine(gpu::Batch& batch, const glm::vec2& p1, const glm
 }
 
 
+/// Extra data for creating geometry.
+class GeometryExtra {
+public:
+    bool isCollisionHull;
+};
+
 QSharedPointer<NetworkGeometry> GeometryCache::getGeometry(const QUrl& url, const QUrl& fallback, bool delayLoad) {
     return getResource(url, fallback, delayLoad, NULL).staticCast<NetworkGeometry>();
 }
 
+QSharedPointer<NetworkGeometry> GeometryCache::getCollisionGeometry(const QUrl& url, bool delayLoad) {
+    GeometryExtra extra = { true };
+    return getResource(url, QUrl(), delayLoad, &extra).staticCast<NetworkGeometry>();
+}
+
 QSharedPointer<Resource> GeometryCache::createResource(const QUrl& url, const QSharedPointer<Resource>& fallback,
                                                        bool delayLoad, const void* extra) {
-    QSharedPointer<NetworkGeometry> geometry(new NetworkGeometry(url, fallback.staticCast<NetworkGeometry>(), delayLoad),
+    const GeometryExtra* geometryExtra = static_cast<const GeometryExtra*>(extra);
+    bool isCollisionHull = geometryExtra && geometryExtra->isCollisionHull;
+    QSharedPointer<NetworkGeometry> geometry(new NetworkGeometry(url, fallback.staticCast<NetworkGeometry>(), delayLoad,
+                                                                 QVariantHash(), QUrl(), isCollisionHull),
                                              &Resource::allReferencesCleared);
     geometry->setLODParent(geometry);
     return geometry.staticCast<Resource>();
@@ -1805,10 +1821,11 @@ QSharedPointer<Resource> GeometryCache::createResource(const QUrl& url, const QS
 const float NetworkGeometry::NO_HYSTERESIS = -1.0f;
 
 NetworkGeometry::NetworkGeometry(const QUrl& url, const QSharedPointer<NetworkGeometry>& fallback, bool delayLoad,
-        const QVariantHash& mapping, const QUrl& textureBase) :
+        const QVariantHash& mapping, const QUrl& textureBase, bool isCollisionHull) :
     Resource(url, delayLoad),
     _mapping(mapping),
     _textureBase(textureBase.isValid() ? textureBase : url),
+    _isCollisionHull(isCollisionHull),
     _fallback(fallback)
 {
     
@@ -1904,10 +1921,60 @@ QSharedPointer<NetworkGeometry> NetworkGeometry::getLODOrFallback(float distance
     return lod;
 }
 
+QSharedPointer<const TriangleBVH> NetworkGeometry::getTriangleBVH() {
+    QMutexLocker locker(&_triangleBVHMutex);
+    if (_triangleBVH || !isLoaded()) {
+        return _triangleBVH;
+    }
+    QVector<Triangle> triangles;
+    QVector<int> meshIndices;
+    for (int i = 0; i < _geometry.meshes.size(); i++) {
+        const FBXMesh& mesh = _geometry.meshes.at(i);
+        QVector<glm::vec3> vertices(mesh.vertices.size());
+        for (int j = 0; j < mesh.vertices.size(); j++) {
+            vertices[j] = glm::vec3(mesh.modelTransform * glm::vec4(mesh.vertices.at(j), 1.0f));
+        }
+        foreach (const FBXMeshPart& part, mesh.parts) {
+            const int INDICES_PER_QUAD = 4;
+            for (const int* it = part.quadIndices.constData(), *end = it + part.quadIndices.size() /
+                    INDICES_PER_QUAD * INDICES_PER_QUAD; it != end; it += INDICES_PER_QUAD) {
+                // split the same way Model::recalculateMeshBoxes does
+                Triangle first = { vertices.at(it[0]), vertices.at(it[1]), vertices.at(it[3]) };
+                Triangle second = { vertices.at(it[1]), vertices.at(it[2]), vertices.at(it[3]) };
+                triangles << first << second;
+                meshIndices << i << i;
+            }
+            const int INDICES_PER_TRIANGLE = 3;
+            for (const int* it = part.triangleIndices.constData(), *end = it + part.triangleIndices.size() /
+                    INDICES_PER_TRIANGLE * INDICES_PER_TRIANGLE; it != end; it += INDICES_PER_TRIANGLE) {
+                Triangle triangle = { vertices.at(it[0]), vertices.at(it[1]), vertices.at(it[2]) };
+                triangles << triangle;
+                meshIndices << i;
+            }
+        }
+    }
+    QSharedPointer<TriangleBVH> triangleBVH(new TriangleBVH());
+    triangleBVH->build(triangles, meshIndices);
+    _triangleBVH = triangleBVH;
+    return _triangleBVH;
+}
+
 uint qHash(const QWeakPointer<Animation>& animation, uint seed = 0) {
     return qHash(animation.data(), seed);
 }
 
+const QVector<JointState>& NetworkGeometry::getJointStates() {
+    if (_jointStates.isEmpty() && !_geometry.joints.isEmpty()) {
+        _jointStates.resize(_geometry.joints.size());
+        for (int i = 0; i < _jointStates.size(); i++) {
+            JointState& state = _jointStates[i];
+            state.setFBXJoint(&_geometry.joints.at(i));
+            state.buildConstraint();
+        }
+    }
+    return _jointStates;
+}
+
 QVector<int> NetworkGeometry::getJointMappings(const AnimationPointer& animation) {
     QVector<int> mappings = _jointMappings.value(animation);
     if (mappings.isEmpty() && isLoaded() && animation && animation->isLoaded()) {
@@ -2071,7 +2138,7 @@ class GeometryReader : public QRunnable {
 public:
 
     GeometryReader(const QWeakPointer<Resource>& geometry, const QUrl& url,
-        QNetworkReply* reply, const QVariantHash& mapping);
+        QNetworkReply* reply, const QVariantHash& mapping, bool bake);
 
     virtual void run();
 
@@ -2081,14 +2148,16 @@ private:
     QUrl _url;
     QNetworkReply* _reply;
     QVariantHash _mapping;
+    bool _bake;
 };
 
 GeometryReader::GeometryReader(const QWeakPointer<Resource>& geometry, const QUrl& url,
-        QNetworkReply* reply, const QVariantHash& mapping) :
+        QNetworkReply* reply, const QVariantHash& mapping, bool bake) :
     _geometry(geometry),
     _url(url),
     _reply(reply),
-    _mapping(mapping) {
+    _mapping(mapping),
+    _bake(bake) {
 }
 
 void GeometryReader::run() {
@@ -2123,7 +2192,19 @@ void GeometryReader::run() {
                 } else if (_url.path().toLower().endsWith("palaceoforinthilian4.fbx")) {
                     lightmapLevel = 3.5f;
                 }
-                fbxgeo = readFBX(_reply, _mapping, grabLightmaps, lightmapLevel);
+                QByteArray model = _reply->readAll();
+                if (_bake) {
+                    // reuse what was baked the last time this exact model was read, or bake it for next time
+                    BakedGeometryCache bakedGeometryCache;
+                    QByteArray bakedKey = BakedGeometryCache::getKey(model, _mapping, grabLightmaps, lightmapLevel);
+                    if (!bakedGeometryCache.load(bakedKey, fbxgeo)) {
+                        fbxgeo = readFBX(model, _mapping, grabLightmaps, lightmapLevel);
+                        optimizeGeometry(fbxgeo);
+                        bakedGeometryCache.save(bakedKey, fbxgeo);
+                    }
+                } else {
+                    fbxgeo = readFBX(model, _mapping, grabLightmaps, lightmapLevel);
+                }
             } else if (_url.path().toLower().endsWith(".obj")) {
                 fbxgeo = OBJReader().readOBJ(_reply, _mapping, &_url);
             }
@@ -2142,6 +2223,11 @@ void GeometryReader::run() {
 void NetworkGeometry::init() {
     _mapping = QVariantHash();
     _geometry = FBXGeometry();
+    _triangleBVHMutex.lock();
+    _triangleBVH.clear();
+    _triangleBVHMutex.unlock();
+    _jointStates.clear();
+    _jointMappings.clear();
     _meshes.clear();
     _lods.clear();
     _pendingTextureChanges.clear();
@@ -2171,7 +2257,7 @@ void NetworkGeometry::downloadFinished(QNetworkReply* reply) {
             QVariantHash lods = _mapping.value("lod").toHash();
             for (QVariantHash::const_iterator it = lods.begin(); it != lods.end(); it++) {
                 QSharedPointer<NetworkGeometry> geometry(new NetworkGeometry(url.resolved(it.key()),
-                    QSharedPointer<NetworkGeometry>(), true, _mapping, _textureBase));    
+                    QSharedPointer<NetworkGeometry>(), true, _mapping, _textureBase, _isCollisionHull));
                 geometry->setSelf(geometry.staticCast<Resource>());
                 geometry->setLODParent(_lodParent);
                 _lods.insert(it.value().toFloat(), geometry);
@@ -2188,7 +2274,8 @@ void NetworkGeometry::downloadFinished(QNetworkReply* reply) {
     }
     
     // send the reader off to the thread pool
-    QThreadPool::globalInstance()->start(new GeometryReader(_self, url, reply, _mapping));
+    // collision hulls are only read for their shapes, so they aren't worth optimizing or baking for drawing
+    QThreadPool::globalInstance()->start(new GeometryReader(_self, url, reply, _mapping, !_isCollisionHull));
 }
 
 void NetworkGeometry::reinsert() {
@@ -2244,6 +2331,9 @@ void NetworkGeometry::setGeometry(const FBXGeometry& geometry) {
             networkMesh.parts.append(networkPart);
                         
             totalIndices += (part.quadIndices.size() + part.triangleIndices.size());
+            foreach (const QVector<int>& indices, part.lodTriangleIndices) {
+                totalIndices += indices.size();
+            }
         }
 
         {
@@ -2258,6 +2348,17 @@ void NetworkGeometry::setGeometry(const FBXGeometry& geometry) {
                     (gpu::Byte*) part.triangleIndices.constData());
                 offset += part.triangleIndices.size() * sizeof(int);
             }
+            // the levels of detail follow, a level of every part at a time
+            for (int i = 0; i < mesh.lodErrors.size(); i++) {
+                foreach (const FBXMeshPart& part, mesh.parts) {
+                    if (i < part.lodTriangleIndices.size()) {
+                        const QVector<int>& indices = part.lodTriangleIndices.at(i);
+                        networkMesh._indexBuffer->setSubData(offset, indices.size() * sizeof(int),
+                            (gpu::Byte*) indices.constData());
+                        offset += indices.size() * sizeof(int);
+                    }
+                }
+            }
         }
 
         {
@@ -16,12 +16,15 @@
 #include <gpu/GPUConfig.h>
 
 #include <QMap>
+#include <QMutex>
 #include <QOpenGLBuffer>
 
 #include <DependencyManager.h>
 #include <ResourceCache.h>
+#include <TriangleBVH.h>
 
 #include "FBXReader.h"
+#include "JointState.h"
 #include "OBJReader.h"
 
 #include <AnimationCache.h>
@@ -249,6 +252,10 @@ public:
     /// \param delayLoad if true, don't load the geometry immediately; wait until load is first requested
     QSharedPointer<NetworkGeometry> getGeometry(const QUrl& url, const QUrl& fallback = QUrl(), bool delayLoad = false);
 
+    /// Loads geometry for use as a collision hull, which is read as is rather than optimized and baked for drawing.
+    /// \param delayLoad if true, don't load the geometry immediately; wait until load is first requested
+    QSharedPointer<NetworkGeometry> getCollisionGeometry(const QUrl& url, bool delayLoad = false);
+
 protected:
 
     virtual QSharedPointer<Resource> createResource(const QUrl& url,
@@ -357,7 +364,7 @@ public:
     static const float NO_HYSTERESIS;
     
     NetworkGeometry(const QUrl& url, const QSharedPointer<NetworkGeometry>& fallback, bool delayLoad,
-        const QVariantHash& mapping = QVariantHash(), const QUrl& textureBase = QUrl());
+        const QVariantHash& mapping = QVariantHash(), const QUrl& textureBase = QUrl(), bool isCollisionHull = false);
 
     /// Checks whether the geometry and its textures are loaded.
     bool isLoadedWithTextures() const;
@@ -369,6 +376,16 @@ public:
     const FBXGeometry& getFBXGeometry() const { return _geometry; }
     const QVector<NetworkMesh>& getMeshes() const { return _meshes; }
 
+    /// Returns a hierarchy of the meshes' triangles in model space, i.e. with each mesh's model transform applied, tagged
+    /// with their mesh indices. It's built the first time it's asked for and shared by every model using the geometry.
+    QSharedPointer<const TriangleBVH> getTriangleBVH();
+
+    /// Returns the joints' states in the bind pose, each with its constraint built. It's built the first time it's asked
+    /// for, and models using the geometry start from copies, which share the constraints rather than building their own.
+    const QVector<JointState>& getJointStates();
+
+    /// Returns the index of the geometry's joint matching each of the animation's joints by name (or -1 if none does). It's
+    /// computed once per animation and shared by every model using the geometry.
     QVector<int> getJointMappings(const AnimationPointer& animation);
 
     virtual void setLoadPriority(const QPointer<QObject>& owner, float priority);
@@ -396,6 +413,7 @@ private:
     
     QVariantHash _mapping;
     QUrl _textureBase;
+    bool _isCollisionHull;
     QSharedPointer<NetworkGeometry> _fallback;
     
     QMap<float, QSharedPointer<NetworkGeometry> > _lods;
@@ -404,10 +422,15 @@ private:
     
     QWeakPointer<NetworkGeometry> _lodParent;
     
+    QVector<JointState> _jointStates;
     QHash<QWeakPointer<Animation>, QVector<int> > _jointMappings;
     
     QHash<QString, QUrl> _pendingTextureChanges;
 
+    // picking may happen off the main thread
+    QMutex _triangleBVHMutex;
+    QSharedPointer<const TriangleBVH> _triangleBVH;
+
     mutable bool _isLoadedWithTextures = false;
 };
 
@@ -24,11 +24,10 @@ JointState::JointState() :
     _rotationIsValid(false),
     _positionInParentFrame(0.0f),
     _distanceToParent(0.0f),
-    _fbxJoint(NULL),
-    _constraint(NULL) {
+    _fbxJoint(NULL) {
 }
 
-JointState::JointState(const JointState& other) : _constraint(NULL) {
+JointState::JointState(const JointState& other) {
     _transformChanged = other._transformChanged;
     _transform = other._transform;
     _rotationIsValid = other._rotationIsValid;
@@ -38,16 +37,7 @@ JointState::JointState(const JointState& other) : _constraint(NULL) {
     _distanceToParent = other._distanceToParent;
     _animationPriority = other._animationPriority;
     _fbxJoint = other._fbxJoint;
-    // DO NOT copy _constraint
-}
-
-JointState::~JointState() {
-    delete _constraint;
-    _constraint = NULL;
-    if (_constraint) {
-        delete _constraint;
-        _constraint = NULL;
-    }
+    _constraint = other._constraint;
 }
 
 glm::quat JointState::getRotation() const {
@@ -67,21 +57,16 @@ void JointState::setFBXJoint(const FBXJoint* joint) {
     
     // NOTE: JointState does not own the FBXJoint to which it points.
     _fbxJoint = joint;
-    if (_constraint) {
-        delete _constraint;
-        _constraint = NULL;
-    }
+    _constraint.clear();
 }
 
 void JointState::buildConstraint() {
-    if (_constraint) {
-        delete _constraint;
-        _constraint = NULL;
-    }
+    _constraint.clear();
     if (glm::distance2(glm::vec3(-PI), _fbxJoint->rotationMin) > EPSILON || 
             glm::distance2(glm::vec3(PI), _fbxJoint->rotationMax) > EPSILON ) {
         // this joint has rotation constraints
-        _constraint = AngularConstraint::newAngularConstraint(_fbxJoint->rotationMin, _fbxJoint->rotationMax);
+        _constraint = QSharedPointer<const AngularConstraint>(
+            AngularConstraint::newAngularConstraint(_fbxJoint->rotationMin, _fbxJoint->rotationMax));
     }
 }
 
@@ -112,9 +97,8 @@ void JointState::computeTransform(const glm::mat4& parentTransform, bool parentT
         return;
     }
     
-    glm::quat rotationInParentFrame = _fbxJoint->preRotation * _rotationInConstrainedFrame * _fbxJoint->postRotation;
-    glm::mat4 transformInParentFrame = _fbxJoint->preTransform * glm::mat4_cast(rotationInParentFrame) * _fbxJoint->postTransform;
-    glm::mat4 newTransform = parentTransform * glm::translate(_fbxJoint->translation) * transformInParentFrame;
+    glm::mat4 newTransform;
+    multiplyMatrices(parentTransform, computeTransformInParentFrame(_rotationInConstrainedFrame), newTransform);
     
     if (newTransform != _transform) {
         _transform = newTransform;
@@ -124,12 +108,21 @@ void JointState::computeTransform(const glm::mat4& parentTransform, bool parentT
 }
 
 void JointState::computeVisibleTransform(const glm::mat4& parentTransform) {
-    glm::quat rotationInParentFrame = _fbxJoint->preRotation * _visibleRotationInConstrainedFrame * _fbxJoint->postRotation;
-    glm::mat4 transformInParentFrame = _fbxJoint->preTransform * glm::mat4_cast(rotationInParentFrame) * _fbxJoint->postTransform;
-    _visibleTransform = parentTransform * glm::translate(_fbxJoint->translation) * transformInParentFrame;
+    multiplyMatrices(parentTransform, computeTransformInParentFrame(_visibleRotationInConstrainedFrame), _visibleTransform);
     _visibleRotation = extractRotation(_visibleTransform);
 }
 
+glm::mat4 JointState::computeTransformInParentFrame(const glm::quat& rotationInConstrainedFrame) const {
+    glm::quat rotationInParentFrame = _fbxJoint->preRotation * rotationInConstrainedFrame * _fbxJoint->postRotation;
+    glm::mat4 transformInParentFrame;
+    multiplyMatrices(_fbxJoint->preTransform, glm::mat4_cast(rotationInParentFrame), transformInParentFrame);
+    multiplyMatrices(transformInParentFrame, _fbxJoint->postTransform, transformInParentFrame);
+
+    // the transform is affine, so translating it first only adds to its translation column
+    transformInParentFrame[3] += glm::vec4(_fbxJoint->translation, 0.0f);
+    return transformInParentFrame;
+}
+
 glm::quat JointState::getRotationInBindFrame() const {
     return getRotation() * _fbxJoint->inverseBindRotation;
 }
@@ -16,6 +16,8 @@
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/transform.hpp>
 
+#include <QSharedPointer>
+
 #include <FBXReader.h>
 #include <GLMHelpers.h>
 #include <NumericalConstants.h>
@@ -28,11 +30,11 @@ class JointState {
 public:
     JointState();
     JointState(const JointState& other);
-    ~JointState();
 
     void setFBXJoint(const FBXJoint* joint); 
     const FBXJoint& getFBXJoint() const { return *_fbxJoint; }
 
+    /// Builds the constraint on the joint's rotation, if it has one. States copied from this one share it.
     void buildConstraint();
     void copyState(const JointState& state);
 
@@ -108,6 +110,7 @@ public:
 
 private:
     void setRotationInConstrainedFrameInternal(const glm::quat& targetRotation);
+    glm::mat4 computeTransformInParentFrame(const glm::quat& rotationInConstrainedFrame) const;
     /// debug helper function
     void loadBindRotation();
 
@@ -124,7 +127,7 @@ private:
     glm::quat _visibleRotationInConstrainedFrame;
 
     const FBXJoint* _fbxJoint; // JointState does NOT own its FBXJoint
-    AngularConstraint* _constraint; // JointState owns its AngularConstraint
+    QSharedPointer<const AngularConstraint> _constraint; // immutable, and shared by all copies of the state
 };
 
 #endif // hifi_JointState_h
@@ -11,6 +11,8 @@
 
 #include <gpu/GPUConfig.h>
 
+#include <cstring>
+
 #include <QMetaType>
 #include <QRunnable>
 #include <QThreadPool>
@@ -20,6 +22,7 @@
 
 #include <CapsuleShape.h>
 #include <GeometryUtil.h>
+#include <GLMHelpers.h>
 #include <gpu/Batch.h>
 #include <gpu/GLBackend.h>
 #include <PathUtils.h>
@@ -65,6 +68,7 @@ using namespace std;
 static int modelPointerTypeId = qRegisterMetaType<QPointer<Model> >();
 static int weakNetworkGeometryPointerTypeId = qRegisterMetaType<QWeakPointer<NetworkGeometry> >();
 static int vec3VectorTypeId = qRegisterMetaType<QVector<glm::vec3> >();
+static int blendedVerticesVectorTypeId = qRegisterMetaType<QVector<BlendedVertices> >();
 float Model::FAKE_DIMENSION_PLACEHOLDER = -1.0f;
 
 Model::Model(QObject* parent) :
@@ -99,6 +103,7 @@ Model::Model(QObject* parent) :
 }
 
 Model::~Model() {
+    _loadingModels.remove(this);
     deleteGeometry();
 }
 
@@ -214,6 +219,8 @@ void Model::RenderPipelineLib::initLocations(gpu::ShaderPointer& program, Model:
 
 AbstractViewStateInterface* Model::_viewState = NULL;
 
+QSet<Model*> Model::_loadingModels;
+
 
 void Model::setScale(const glm::vec3& scale) {
     setScaleInternal(scale);
@@ -245,19 +252,6 @@ void Model::setOffset(const glm::vec3& offset) {
     _snappedToRegistrationPoint = false; 
 }
 
-QVector<JointState> Model::createJointStates(const FBXGeometry& geometry) {
-    QVector<JointState> jointStates;
-    for (int i = 0; i < geometry.joints.size(); ++i) {
-        const FBXJoint& joint = geometry.joints[i];
-        // store a pointer to the FBXJoint in the JointState
-        JointState state;
-        state.setFBXJoint(&joint);
-
-        jointStates.append(state);
-    }
-    return jointStates;
-};
-
 void Model::initJointTransforms() {
     // compute model transforms
     int numStates = _jointStates.size();
@@ -422,7 +416,7 @@ bool Model::updateGeometry() {
     bool needToRebuild = false;
     if (_nextGeometry) {
         _nextGeometry = _nextGeometry->getLODOrFallback(_lodDistance, _nextLODHysteresis);
-        _nextGeometry->setLoadPriority(this, -_lodDistance);
+        _nextGeometry->setLoadPriority(this, _loadPriority);
         _nextGeometry->ensureLoading();
         if (_nextGeometry->isLoaded()) {
             applyNextGeometry();
@@ -441,7 +435,8 @@ bool Model::updateGeometry() {
         // Which means we don't need to worry about calling deleteGeometry() below immediately after creating new geometry.
 
         const FBXGeometry& newGeometry = geometry->getFBXGeometry();
-        QVector<JointState> newJointStates = createJointStates(newGeometry);
+        // start from the geometry's shared bind pose, copying out only the per-instance pose data
+        QVector<JointState> newJointStates = geometry->getJointStates();
         if (! _jointStates.isEmpty()) {
             // copy the existing joint states
             const FBXGeometry& oldGeometry = _geometry->getFBXGeometry();
@@ -465,14 +460,14 @@ bool Model::updateGeometry() {
     } else if (_jointStates.isEmpty()) {
         const FBXGeometry& fbxGeometry = geometry->getFBXGeometry();
         if (fbxGeometry.joints.size() > 0) {
-            initJointStates(createJointStates(fbxGeometry));
+            initJointStates(geometry->getJointStates());
             needToRebuild = true;
         }
     } else if (!geometry->isLoaded()) {
         deleteGeometry();
         _dilatedTextures.clear();
     }
-    _geometry->setLoadPriority(this, -_lodDistance);
+    _geometry->setLoadPriority(this, _loadPriority);
     _geometry->ensureLoading();
    
     if (needToRebuild) {
@@ -508,7 +503,6 @@ void Model::initJointStates(QVector<JointState> states) {
         if (distance > radius) {
             radius = distance;
         }
-        _jointStates[i].buildConstraint();
     }
     for (int i = 0; i < _jointStates.size(); i++) {
         _jointStates[i].slaveVisibleTransform();
@@ -546,8 +540,42 @@ bool Model::findRayIntersectionAgainstSubMeshes(const glm::vec3& origin, const g
     // and testing intersection there.
     if (modelFrameBox.findRayIntersection(modelFrameOrigin, modelFrameDirection, distance, face)) {
     
-        if (!_calculatedMeshBoxesValid) {
-            recalculateMeshBoxes(pickAgainstTriangles);
+        const FBXGeometry& geometry = _geometry->getFBXGeometry();
+
+        if (pickAgainstTriangles) {
+            // the triangles stay in model space, shared with every other model of this geometry, and the ray is brought
+            // to them instead; the mapping is affine, so distances along the ray are the same in both
+            QSharedPointer<const TriangleBVH> triangleBVH = _geometry->getTriangleBVH();
+            if (!triangleBVH) {
+                return false;
+            }
+            glm::mat4 worldToMeshMatrix = glm::inverse(geometry.offset) * glm::translate(-_offset) *
+                glm::scale(1.0f / _scale) * glm::mat4_cast(glm::inverse(_rotation)) * glm::translate(-_translation);
+            glm::vec3 meshFrameOrigin = glm::vec3(worldToMeshMatrix * glm::vec4(origin, 1.0f));
+            glm::vec3 meshFrameDirection = glm::vec3(worldToMeshMatrix * glm::vec4(direction, 0.0f));
+
+            float triangleDistance;
+            int meshIndex;
+            if (!triangleBVH->findRayIntersection(meshFrameOrigin, meshFrameDirection, triangleDistance, meshIndex)) {
+                return false;
+            }
+            distance = triangleDistance;
+            extraInfo = geometry.getModelNameOfMesh(meshIndex);
+
+            // report the face of the box of the mesh that was hit, as when each mesh's triangles were tested in turn
+            _mutex.lock();
+            if (!_calculatedMeshBoxesValid) {
+                recalculateMeshBoxes();
+            }
+            float distanceToSubMesh;
+            BoxFace subMeshFace;
+            if (meshIndex < _calculatedMeshBoxes.size() &&
+                    _calculatedMeshBoxes.at(meshIndex).findRayIntersection(origin, direction, distanceToSubMesh,
+                        subMeshFace)) {
+                face = subMeshFace;
+            }
+            _mutex.unlock();
+            return true;
         }
 
         float bestDistance = std::numeric_limits<float>::max();
@@ -556,41 +584,19 @@ bool Model::findRayIntersectionAgainstSubMeshes(const glm::vec3& origin, const g
         BoxFace subMeshFace;
         int subMeshIndex = 0;
 
-        const FBXGeometry& geometry = _geometry->getFBXGeometry();
-
         // If we hit the models box, then consider the submeshes...
         _mutex.lock();
+        if (!_calculatedMeshBoxesValid) {
+            recalculateMeshBoxes();
+        }
         foreach(const AABox& subMeshBox, _calculatedMeshBoxes) {
 
             if (subMeshBox.findRayIntersection(origin, direction, distanceToSubMesh, subMeshFace)) {
                 if (distanceToSubMesh < bestDistance) {
-                    if (pickAgainstTriangles) {
-                        if (!_calculatedMeshTrianglesValid) {
-                            recalculateMeshBoxes(pickAgainstTriangles);
-                        }
-                        // check our triangles here....
-                        const QVector<Triangle>& meshTriangles = _calculatedMeshTriangles[subMeshIndex];
-                        int t = 0;
-                        foreach (const Triangle& triangle, meshTriangles) {
-                            t++;
-                        
-                            float thisTriangleDistance;
-                            if (findRayTriangleIntersection(origin, direction, triangle, thisTriangleDistance)) {
-                                if (thisTriangleDistance < bestDistance) {
-                                    bestDistance = thisTriangleDistance;
-                                    intersectedSomething = true;
-                                    face = subMeshFace;
-                                    extraInfo = geometry.getModelNameOfMesh(subMeshIndex);
-                                }
-                            }
-                        }
-                    } else {
-                        // this is the non-triangle picking case...
-                        bestDistance = distanceToSubMesh;
-                        intersectedSomething = true;
-                        face = subMeshFace;
-                        extraInfo = geometry.getModelNameOfMesh(subMeshIndex);
-                    }
+                    bestDistance = distanceToSubMesh;
+                    intersectedSomething = true;
+                    face = subMeshFace;
+                    extraInfo = geometry.getModelNameOfMesh(subMeshIndex);
                 }
             } 
             subMeshIndex++;
@@ -670,6 +676,7 @@ void Model::recalculateMeshPartOffsets() {
         const FBXGeometry& geometry = _geometry->getFBXGeometry();
         int numberOfMeshes = geometry.meshes.size();
         _calculatedMeshPartOffset.clear();
+        _calculatedMeshPartLODOffsets.clear();
         for (int i = 0; i < numberOfMeshes; i++) {
             const FBXMesh& mesh = geometry.meshes.at(i);
             qint64 partOffset = 0;
@@ -680,6 +687,16 @@ void Model::recalculateMeshPartOffsets() {
                 partOffset += part.triangleIndices.size() * sizeof(int);
 
             }
+            // the levels of detail follow all the parts, as NetworkGeometry lays them out
+            for (int level = 0; level < mesh.lodErrors.size(); level++) {
+                for (int j = 0; j < mesh.parts.size(); j++) {
+                    const FBXMeshPart& part = mesh.parts.at(j);
+                    if (level < part.lodTriangleIndices.size()) {
+                        _calculatedMeshPartLODOffsets[QPair<int,int>(i, j)].append(partOffset);
+                        partOffset += part.lodTriangleIndices.at(level).size() * sizeof(int);
+                    }
+                }
+            }
         }
         _calculatedMeshPartOffsetValid = true;
     }
@@ -709,7 +726,6 @@ void Model::recalculateMeshBoxes(bool pickAgainstTriangles) {
 
             if (pickAgainstTriangles) {
                 QVector<Triangle> thisMeshTriangles;
-                qint64 partOffset = 0;
                 for (int j = 0; j < mesh.parts.size(); j++) {
                     const FBXMeshPart& part = mesh.parts.at(j);
 
@@ -795,15 +811,9 @@ void Model::recalculateMeshBoxes(bool pickAgainstTriangles) {
                         }
                     }
                     _calculatedMeshPartBoxes[QPair<int,int>(i, j)] = thisPartBounds;
-                    _calculatedMeshPartOffset[QPair<int,int>(i, j)] = partOffset;
-
-                    partOffset += part.quadIndices.size() * sizeof(int);
-                    partOffset += part.triangleIndices.size() * sizeof(int);
-
                 }
                 _calculatedMeshTriangles[i] = thisMeshTriangles;
                 _calculatedMeshPartBoxesValid = true;
-                _calculatedMeshPartOffsetValid = true;
             }
         }
         _calculatedMeshBoxesValid = true;
@@ -1108,16 +1118,59 @@ void Model::setURL(const QUrl& url, const QUrl& fallback, bool retainCurrent, bo
     // if so instructed, keep the current geometry until the new one is loaded 
     _nextBaseGeometry = _nextGeometry = DependencyManager::get<GeometryCache>()->getGeometry(url, fallback, delayLoad);
     _nextLODHysteresis = NetworkGeometry::NO_HYSTERESIS;
+    _loadingModels.insert(this);
     if (!retainCurrent || !isActive() || (_nextGeometry && _nextGeometry->isLoaded())) {
         applyNextGeometry();
     }
 }
 
 
+void Model::setLoadBounds(const glm::vec3& center, float radius) {
+    _hasLoadBounds = true;
+    _loadBoundsCenter = center;
+    _loadBoundsRadius = radius;
+}
+
+void Model::updateLoadPriorities() {
+    ViewFrustum* viewFrustum = _viewState ? _viewState->getCurrentViewFrustum() : NULL;
+    if (!viewFrustum) {
+        return;
+    }
+    foreach (Model* model, _loadingModels) {
+        if (!model->_nextGeometry && model->isLoadedWithTextures()) {
+            _loadingModels.remove(model);
+            continue;
+        }
+        model->_loadPriority = model->evalLoadPriority(*viewFrustum);
+        if (model->_nextGeometry) {
+            model->_nextGeometry->setLoadPriority(model, model->_loadPriority);
+        }
+        if (model->_geometry) {
+            model->_geometry->setLoadPriority(model, model->_loadPriority);
+        }
+    }
+}
+
+float Model::evalLoadPriority(const ViewFrustum& viewFrustum) const {
+    // until an owner says otherwise, models are taken to be about the size of an avatar, wherever they've been put
+    const float DEFAULT_LOAD_RADIUS = 1.0f;
+    const float MIN_LOAD_RADIUS = 0.01f;
+    glm::vec3 center = _hasLoadBounds ? _loadBoundsCenter : _translation;
+    float radius = glm::max(_hasLoadBounds ? _loadBoundsRadius : DEFAULT_LOAD_RADIUS, MIN_LOAD_RADIUS);
+
+    // the (tangent of the half) angle the model subtends, which is proportional to its size on screen
+    float distance = glm::distance(center, viewFrustum.getPosition());
+    float size = (distance > radius) ? radius / distance : 1.0f;
+
+    // models out of view still load, but after anything comparable in view
+    const float OUT_OF_VIEW_WEIGHT = 0.1f;
+    return (viewFrustum.sphereInFrustum(center, radius) == ViewFrustum::OUTSIDE) ? size * OUT_OF_VIEW_WEIGHT : size;
+}
+
 const QSharedPointer<NetworkGeometry> Model::getCollisionGeometry(bool delayLoad)
 {
     if (_collisionGeometry.isNull() && !_collisionUrl.isEmpty()) {
-        _collisionGeometry = DependencyManager::get<GeometryCache>()->getGeometry(_collisionUrl, QUrl(), delayLoad);
+        _collisionGeometry = DependencyManager::get<GeometryCache>()->getCollisionGeometry(_collisionUrl, delayLoad);
     }
 
     return _collisionGeometry;
@@ -1128,7 +1181,7 @@ void Model::setCollisionModelURL(const QUrl& url) {
         return;
     }
     _collisionUrl = url;
-    _collisionGeometry = DependencyManager::get<GeometryCache>()->getGeometry(url, QUrl(), true);
+    _collisionGeometry = DependencyManager::get<GeometryCache>()->getCollisionGeometry(url, true);
 }
 
 bool Model::getJointPositionInWorldFrame(int jointIndex, glm::vec3& position) const {
@@ -1220,66 +1273,107 @@ void Model::updateShapePositions() {
     // TODO: implement this when we know how to build shapes for regular Models
 }
 
+/// Blends the vertices of one or more models on a worker thread, and posts them back to the model blender together.
 class Blender : public QRunnable {
 public:
 
-    Blender(Model* model, int blendNumber, const QWeakPointer<NetworkGeometry>& geometry,
+    void addModel(Model* model, int blendNumber, const QWeakPointer<NetworkGeometry>& geometry,
         const QVector<FBXMesh>& meshes, const QVector<float>& blendshapeCoefficients);
-    
+
+    int getModelCount() const { return _results.size(); }
+
+    /// Takes vectors left over from earlier blends to write the results into, rather than allocating new ones.
+    void reuseVectors(QVector<BlendedVertices>& freeVectors);
+
     virtual void run();
 
 private:
-    
-    QPointer<Model> _model;
-    int _blendNumber;
-    QWeakPointer<NetworkGeometry> _geometry;
-    QVector<FBXMesh> _meshes;
-    QVector<float> _blendshapeCoefficients;
+
+    class Input {
+    public:
+        QVector<FBXMesh> meshes;
+        QVector<float> blendshapeCoefficients;
+    };
+
+    static void blend(const Input& input, QVector<glm::vec3>& vertices, QVector<glm::vec3>& normals);
+
+    QVector<Input> _inputs;
+    QVector<BlendedVertices> _results;
 };
 
-Blender::Blender(Model* model, int blendNumber, const QWeakPointer<NetworkGeometry>& geometry,
-        const QVector<FBXMesh>& meshes, const QVector<float>& blendshapeCoefficients) :
-    _model(model),
-    _blendNumber(blendNumber),
-    _geometry(geometry),
-    _meshes(meshes),
-    _blendshapeCoefficients(blendshapeCoefficients) {
+void Blender::addModel(Model* model, int blendNumber, const QWeakPointer<NetworkGeometry>& geometry,
+        const QVector<FBXMesh>& meshes, const QVector<float>& blendshapeCoefficients) {
+    Input input;
+    input.meshes = meshes;
+    input.blendshapeCoefficients = blendshapeCoefficients;
+    _inputs.append(input);
+
+    BlendedVertices result;
+    result.model = model;
+    result.blendNumber = blendNumber;
+    result.geometry = geometry;
+    _results.append(result);
+}
+
+void Blender::reuseVectors(QVector<BlendedVertices>& freeVectors) {
+    for (int i = 0; i < _results.size() && !freeVectors.isEmpty(); i++) {
+        BlendedVertices freeBlend = freeVectors.takeLast();
+        _results[i].vertices.swap(freeBlend.vertices);
+        _results[i].normals.swap(freeBlend.normals);
+    }
 }
 
 void Blender::run() {
-    QVector<glm::vec3> vertices, normals;
-    if (!_model.isNull()) {
-        int offset = 0;
-        foreach (const FBXMesh& mesh, _meshes) {
-            if (mesh.blendshapes.isEmpty()) {
+    for (int i = 0; i < _inputs.size(); i++) {
+        BlendedVertices& result = _results[i];
+        if (!result.model.isNull()) {
+            blend(_inputs.at(i), result.vertices, result.normals);
+        }
+    }
+    // post the results to the model blender, which will dispatch to the models still alive
+    QMetaObject::invokeMethod(DependencyManager::get<ModelBlender>().data(), "setBlendedVertices",
+        Q_ARG(const QVector<BlendedVertices>&, _results));
+}
+
+void Blender::blend(const Input& input, QVector<glm::vec3>& vertices, QVector<glm::vec3>& normals) {
+    // size the results once; vectors being reused keep their capacity, so this only allocates if they're too small
+    int vertexCount = 0;
+    foreach (const FBXMesh& mesh, input.meshes) {
+        if (!mesh.blendshapes.isEmpty()) {
+            vertexCount += mesh.vertices.size();
+        }
+    }
+    vertices.resize(vertexCount);
+    normals.resize(vertexCount);
+
+    int offset = 0;
+    foreach (const FBXMesh& mesh, input.meshes) {
+        if (mesh.blendshapes.isEmpty()) {
+            continue;
+        }
+        glm::vec3* meshVertices = vertices.data() + offset;
+        glm::vec3* meshNormals = normals.data() + offset;
+        memcpy(meshVertices, mesh.vertices.constData(), mesh.vertices.size() * sizeof(glm::vec3));
+
+        // the pooled vectors hold an earlier blend's results, so vertices without a normal get a zero one
+        int normalCount = qMin(mesh.normals.size(), mesh.vertices.size());
+        memcpy(meshNormals, mesh.normals.constData(), normalCount * sizeof(glm::vec3));
+        memset(meshNormals + normalCount, 0, (mesh.vertices.size() - normalCount) * sizeof(glm::vec3));
+        offset += mesh.vertices.size();
+        const float NORMAL_COEFFICIENT_SCALE = 0.01f;
+        for (int i = 0, n = qMin(input.blendshapeCoefficients.size(), mesh.blendshapes.size()); i < n; i++) {
+            float vertexCoefficient = input.blendshapeCoefficients.at(i);
+            if (vertexCoefficient < EPSILON) {
                 continue;
             }
-            vertices += mesh.vertices;
-            normals += mesh.normals;
-            glm::vec3* meshVertices = vertices.data() + offset;
-            glm::vec3* meshNormals = normals.data() + offset;
-            offset += mesh.vertices.size();
-            const float NORMAL_COEFFICIENT_SCALE = 0.01f;
-            for (int i = 0, n = qMin(_blendshapeCoefficients.size(), mesh.blendshapes.size()); i < n; i++) {
-                float vertexCoefficient = _blendshapeCoefficients.at(i);
-                if (vertexCoefficient < EPSILON) {
-                    continue;
-                }
-                float normalCoefficient = vertexCoefficient * NORMAL_COEFFICIENT_SCALE;
-                const FBXBlendshape& blendshape = mesh.blendshapes.at(i);
-                for (int j = 0; j < blendshape.indices.size(); j++) {
-                    int index = blendshape.indices.at(j);
-                    meshVertices[index] += blendshape.vertices.at(j) * vertexCoefficient;
-                    meshNormals[index] += blendshape.normals.at(j) * normalCoefficient;
-                }
-            }
+            float normalCoefficient = vertexCoefficient * NORMAL_COEFFICIENT_SCALE;
+            const FBXBlendshape& blendshape = mesh.blendshapes.at(i);
+            addScaledOffsets(meshVertices, mesh.vertices.size(), blendshape.indices.constData(),
+                blendshape.vertices.constData(), blendshape.indices.size(), vertexCoefficient);
+            addScaledOffsets(meshNormals, mesh.vertices.size(), blendshape.indices.constData(),
+                blendshape.normals.constData(), blendshape.indices.size(), normalCoefficient);
         }
     }
-    // post the result to the geometry cache, which will dispatch to the model if still alive
-    QMetaObject::invokeMethod(DependencyManager::get<ModelBlender>().data(), "setBlendedVertices",
-        Q_ARG(const QPointer<Model>&, _model), Q_ARG(int, _blendNumber),
-        Q_ARG(const QWeakPointer<NetworkGeometry>&, _geometry), Q_ARG(const QVector<glm::vec3>&, vertices),
-        Q_ARG(const QVector<glm::vec3>&, normals));
 }
 
 void Model::setScaleToFit(bool scaleToFit, const glm::vec3& dimensions) {
@@ -1399,19 +1493,21 @@ void Model::simulateInternal(float deltaTime) {
     
     const FBXGeometry& geometry = _geometry->getFBXGeometry();
     glm::mat4 modelToWorld = glm::mat4_cast(_rotation);
+    
+    // rotate each joint once, rather than once for every cluster bound to it
+    _rotatedJointTransforms.resize(_jointStates.size());
+    for (int i = 0; i < _jointStates.size(); i++) {
+        const JointState& state = _jointStates.at(i);
+        multiplyMatrices(modelToWorld, _showTrueJointTransforms ? state.getTransform() : state.getVisibleTransform(),
+            _rotatedJointTransforms[i]);
+    }
     for (int i = 0; i < _meshStates.size(); i++) {
         MeshState& state = _meshStates[i];
         const FBXMesh& mesh = geometry.meshes.at(i);
-        if (_showTrueJointTransforms) {
-            for (int j = 0; j < mesh.clusters.size(); j++) {
-                const FBXCluster& cluster = mesh.clusters.at(j);
-                state.clusterMatrices[j] = modelToWorld * _jointStates[cluster.jointIndex].getTransform() * cluster.inverseBindMatrix;
-            }
-        } else {
-            for (int j = 0; j < mesh.clusters.size(); j++) {
-                const FBXCluster& cluster = mesh.clusters.at(j);
-                state.clusterMatrices[j] = modelToWorld * _jointStates[cluster.jointIndex].getVisibleTransform() * cluster.inverseBindMatrix;
-            }
+        for (int j = 0; j < mesh.clusters.size(); j++) {
+            const FBXCluster& cluster = mesh.clusters.at(j);
+            multiplyMatrices(_rotatedJointTransforms.at(cluster.jointIndex), cluster.inverseBindMatrix,
+                state.clusterMatrices[j]);
         }
     }
     
@@ -1684,11 +1780,10 @@ void Model::renderJointCollisionShapes(float alpha) {
     // implement this when we have shapes for regular models
 }
 
-bool Model::maybeStartBlender() {
+bool Model::maybeAddToBlender(Blender* blender) {
     const FBXGeometry& fbxGeometry = _geometry->getFBXGeometry();
     if (fbxGeometry.hasBlendedMeshes()) {
-        QThreadPool::globalInstance()->start(new Blender(this, ++_blendNumber, _geometry,
-            fbxGeometry.meshes, _blendshapeCoefficients));
+        blender->addModel(this, ++_blendNumber, _geometry, fbxGeometry.meshes, _blendshapeCoefficients);
         return true;
     }
     return false;
@@ -1803,6 +1898,30 @@ AABox Model::getPartBounds(int meshIndex, int partIndex) {
     return AABox();
 }
 
+// how much of the screen's height a level of detail may stray by before a finer one is drawn: about a pixel
+const float MAX_LOD_SCREEN_ERROR = 0.001f;
+
+int Model::calculateMeshLODLevel(RenderArgs* args, int meshIndex) const {
+    const FBXMesh& mesh = _geometry->getFBXGeometry().meshes.at(meshIndex);
+    if (mesh.lodErrors.isEmpty() || !args || !args->_viewFrustum) {
+        return 0;
+    }
+    // the errors are relative to the size of the mesh, so scale them by how much of the screen it covers
+    Extents extents = calculateScaledOffsetExtents(mesh.meshExtents);
+    float size = glm::distance(extents.minimum, extents.maximum);
+    float distance = glm::distance((extents.minimum + extents.maximum) * 0.5f, args->_viewFrustum->getPosition());
+    float screenHeight = 2.0f * distance * tanf(glm::radians(args->_viewFrustum->getFieldOfView()) * 0.5f);
+    if (distance <= size * 0.5f || screenHeight <= 0.0f) {
+        return 0;
+    }
+    float screenSize = size / screenHeight;
+    int level = 0;
+    while (level < mesh.lodErrors.size() && mesh.lodErrors.at(level) * screenSize < MAX_LOD_SCREEN_ERROR) {
+        level++;
+    }
+    return level;
+}
+
 void Model::renderPart(RenderArgs* args, int meshIndex, int partIndex, bool translucent) {
     if (!_readyWhenAdded) {
         return; // bail asap
@@ -2018,6 +2137,21 @@ void Model::renderPart(RenderArgs* args, int meshIndex, int partIndex, bool tran
         }
     }
     
+    const int INDICES_PER_TRIANGLE = 3;
+    const int INDICES_PER_QUAD = 4;
+    int lodLevel = calculateMeshLODLevel(args, meshIndex);
+    const QVector<qint64>& lodOffsets = _calculatedMeshPartLODOffsets[QPair<int,int>(meshIndex, partIndex)];
+    if (lodLevel > 0 && lodLevel <= lodOffsets.size()) {
+        const QVector<int>& lodIndices = part.lodTriangleIndices.at(lodLevel - 1);
+        if (lodIndices.size() > 0) {
+            batch.drawIndexed(gpu::TRIANGLES, lodIndices.size(), lodOffsets.at(lodLevel - 1));
+        }
+        if (args) {
+            args->_details._trianglesRendered += lodIndices.size() / INDICES_PER_TRIANGLE;
+        }
+        return;
+    }
+
     qint64 offset = _calculatedMeshPartOffset[QPair<int,int>(meshIndex, partIndex)];
 
     if (part.quadIndices.size() > 0) {
@@ -2031,8 +2165,6 @@ void Model::renderPart(RenderArgs* args, int meshIndex, int partIndex, bool tran
     }
 
     if (args) {
-        const int INDICES_PER_TRIANGLE = 3;
-        const int INDICES_PER_QUAD = 4;
         args->_details._trianglesRendered += part.triangleIndices.size() / INDICES_PER_TRIANGLE;
         args->_details._quadsRendered += part.quadIndices.size() / INDICES_PER_QUAD;
     }
@@ -2125,8 +2257,11 @@ ModelBlender::~ModelBlender() {
 
 void ModelBlender::noteRequiresBlend(Model* model) {
     if (_pendingBlenders < QThread::idealThreadCount()) {
-        if (model->maybeStartBlender()) {
-            _pendingBlenders++;
+        Blender* blender = new Blender();
+        if (model->maybeAddToBlender(blender)) {
+            startBlender(blender);
+        } else {
+            delete blender;
         }
         return;
     }
@@ -2135,18 +2270,42 @@ void ModelBlender::noteRequiresBlend(Model* model) {
     }
 }
 
-void ModelBlender::setBlendedVertices(const QPointer<Model>& model, int blendNumber,
-        const QWeakPointer<NetworkGeometry>& geometry, const QVector<glm::vec3>& vertices, const QVector<glm::vec3>& normals) {
-    if (!model.isNull()) {
-        model->setBlendedVertices(blendNumber, geometry, vertices, normals);
-    }
+void ModelBlender::setBlendedVertices(const QVector<BlendedVertices>& blends) {
     _pendingBlenders--;
-    while (!_modelsRequiringBlends.isEmpty()) {
+
+    // the models that had to wait share a job, which is started before these results join the free vectors: until the
+    // event delivering them is done with, they're still shared, and writing to them would mean copying them
+    const int MAX_MODELS_PER_BLENDER = 8;
+    Blender* blender = new Blender();
+    while (!_modelsRequiringBlends.isEmpty() && blender->getModelCount() < MAX_MODELS_PER_BLENDER) {
         Model* nextModel = _modelsRequiringBlends.takeFirst();
-        if (nextModel && nextModel->maybeStartBlender()) {
-            _pendingBlenders++;
-            return;
+        if (nextModel) {
+            nextModel->maybeAddToBlender(blender);
+        }
+    }
+    if (blender->getModelCount() > 0) {
+        startBlender(blender);
+    } else {
+        delete blender;
+    }
+
+    const int MAX_FREE_VECTORS = 32;
+    foreach (const BlendedVertices& blend, blends) {
+        if (!blend.model.isNull()) {
+            blend.model->setBlendedVertices(blend.blendNumber, blend.geometry, blend.vertices, blend.normals);
+        }
+        if (!blend.vertices.isEmpty() && _freeVectors.size() < MAX_FREE_VECTORS) {
+            BlendedVertices freeBlend;
+            freeBlend.vertices = blend.vertices;
+            freeBlend.normals = blend.normals;
+            _freeVectors.append(freeBlend);
         }
     }
 }
 
+void ModelBlender::startBlender(Blender* blender) {
+    blender->reuseVectors(_freeVectors);
+    QThreadPool::globalInstance()->start(blender);
+    _pendingBlenders++;
+}
+
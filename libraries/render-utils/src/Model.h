@@ -40,6 +40,7 @@
 #include "TextureCache.h"
 
 class AbstractViewStateInterface;
+class Blender;
 class QScriptEngine;
 
 class Shape;
@@ -138,6 +139,13 @@ public:
     /// Sets the distance parameter used for LOD computations.
     void setLODDistance(float distance) { _lodDistance = distance; }
     
+    /// Sets the world space bounds by which the model's downloads are prioritized before it's loaded and positioned.
+    void setLoadBounds(const glm::vec3& center, float radius);
+    
+    /// Updates the load priorities of all models still loading from how large and whether they appear in the current
+    /// view.  Called once a frame, before ResourceCache::updateRequests.
+    static void updateLoadPriorities();
+    
     /// Returns the extents of the model in its bind pose.
     Extents getBindExtents() const;
 
@@ -217,7 +225,8 @@ public:
 
     virtual void renderJointCollisionShapes(float alpha);
     
-    bool maybeStartBlender();
+    /// Adds the model to a blend job if it has blended meshes.
+    bool maybeAddToBlender(Blender* blender);
     
     /// Sets blended vertices computed in a separate thread.
     void setBlendedVertices(int blendNumber, const QWeakPointer<NetworkGeometry>& geometry,
@@ -266,6 +275,7 @@ protected:
     };
     
     QVector<MeshState> _meshStates;
+    QVector<glm::mat4> _rotatedJointTransforms; // the joints' transforms rotated into the world frame
     
     // returns 'true' if needs fullUpdate after geometry change
     bool updateGeometry();
@@ -318,7 +328,6 @@ private:
     
     void applyNextGeometry();
     void deleteGeometry();
-    QVector<JointState> createJointStates(const FBXGeometry& geometry);
     void initJointTransforms();
     
     QSharedPointer<NetworkGeometry> _baseGeometry; ///< reference required to prevent collection of base
@@ -328,6 +337,15 @@ private:
     float _lodHysteresis;
     float _nextLODHysteresis;
 
+    float evalLoadPriority(const ViewFrustum& viewFrustum) const;
+
+    bool _hasLoadBounds = false;
+    glm::vec3 _loadBoundsCenter;
+    float _loadBoundsRadius = 0.0f;
+    float _loadPriority = 0.0f;
+
+    static QSet<Model*> _loadingModels;
+
     QSharedPointer<NetworkGeometry> _collisionGeometry;
     QSharedPointer<NetworkGeometry> _saveNonCollisionGeometry;
     
@@ -370,6 +388,7 @@ private:
 
     QHash<QPair<int,int>, AABox> _calculatedMeshPartBoxes; // world coordinate AABoxes for all sub mesh part boxes
     QHash<QPair<int,int>, qint64> _calculatedMeshPartOffset;
+    QHash<QPair<int,int>, QVector<qint64> > _calculatedMeshPartLODOffsets; // index buffer offsets of each part's levels
     bool _calculatedMeshPartOffsetValid;
    
     
@@ -377,13 +396,17 @@ private:
     QVector<AABox> _calculatedMeshBoxes; // world coordinate AABoxes for all sub mesh boxes
     bool _calculatedMeshBoxesValid;
     
-    QVector< QVector<Triangle> > _calculatedMeshTriangles; // world coordinate triangles for all sub meshes
+    QVector< QVector<Triangle> > _calculatedMeshTriangles; // world coordinate triangles for all sub meshes, for convexHullContains
     bool _calculatedMeshTrianglesValid;
     QMutex _mutex;
 
     void recalculateMeshBoxes(bool pickAgainstTriangles = false);
     void recalculateMeshPartOffsets();
 
+    /// Returns the coarsest of the mesh's levels of detail whose error wouldn't show at its size on screen, or zero for
+    /// full detail.
+    int calculateMeshLODLevel(RenderArgs* args, int meshIndex) const;
+
     void segregateMeshGroups(); // used to calculate our list of translucent vs opaque meshes
 
     bool _meshGroupsKnown;
@@ -518,8 +541,19 @@ private:
     
 };
 
+/// The vertices and normals blended for a model on a worker thread.
+class BlendedVertices {
+public:
+    QPointer<Model> model;
+    int blendNumber = 0;
+    QWeakPointer<NetworkGeometry> geometry;
+    QVector<glm::vec3> vertices;
+    QVector<glm::vec3> normals;
+};
+
 Q_DECLARE_METATYPE(QPointer<Model>)
 Q_DECLARE_METATYPE(QWeakPointer<NetworkGeometry>)
+Q_DECLARE_METATYPE(QVector<BlendedVertices>)
 
 /// Handle management of pending models that need blending
 class ModelBlender : public QObject, public Dependency {
@@ -532,15 +566,17 @@ public:
     void noteRequiresBlend(Model* model);
 
 public slots:
-    void setBlendedVertices(const QPointer<Model>& model, int blendNumber, const QWeakPointer<NetworkGeometry>& geometry,
-        const QVector<glm::vec3>& vertices, const QVector<glm::vec3>& normals);
+    void setBlendedVertices(const QVector<BlendedVertices>& blends);
 
 private:
     ModelBlender();
     virtual ~ModelBlender();
 
+    void startBlender(Blender* blender);
+
     QList<QPointer<Model> > _modelsRequiringBlends;
     int _pendingBlenders;
+    QVector<BlendedVertices> _freeVectors; // vectors from applied blends, for new ones to write into
 };
 
 
@@ -9,9 +9,11 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <gpu/BakedTexture.h>
 #include <gpu/Batch.h>
 #include <gpu/GLBackend.h>
 #include <gpu/GPUConfig.h>
+#include <gpu/TextureProcessing.h>
 
 #include <QNetworkReply>
 #include <QPainter>
@@ -430,6 +432,22 @@ public:
             _faceZNeg(fZN) {}
 };
 
+// Copies an RGB888 or ARGB32 image, the only two formats the reader leaves images in
+static gpu::TexelImage toTexelImage(const QImage& image) {
+    const int RGB_CHANNELS = 3;
+    const int ARGB_CHANNELS = 4;
+    return gpu::TexelImage(image.width(), image.height(), image.hasAlphaChannel() ? ARGB_CHANNELS : RGB_CHANNELS,
+        image.bytesPerLine(), image.constBits());
+}
+
+static QImage toImage(const gpu::TexelImage& texels, QImage::Format format) {
+    QImage image(texels.getWidth(), texels.getHeight(), format);
+    for (int y = 0; y < image.height(); y++) {
+        memcpy(image.scanLine(y), texels.getScanLine(y), texels.getWidth() * texels.getChannels());
+    }
+    return image;
+}
+
 void ImageReader::run() {
     QSharedPointer<Resource> texture = _texture.toStrongRef();
     if (texture.isNull()) {
@@ -444,6 +462,35 @@ void ImageReader::run() {
         _reply->deleteLater();
     }
 
+    // reuse the texture processed the last time this exact image was read, unless it's needed as an image
+    const int MAXIMUM_AREA_SIZE = 2097152;
+    QVariantHash bakedOptions;
+    bakedOptions.insert("type", _type);
+    bakedOptions.insert("maximumArea", MAXIMUM_AREA_SIZE);
+    QByteArray bakedKey = gpu::BakedTextureCache::getKey(_content, bakedOptions);
+    gpu::BakedTextureCache bakedTextureCache;
+    bool isBakeable = !dynamic_cast<DilatableNetworkTexture*>(&*texture);
+    gpu::Sampler sampler = (_type == CUBE_TEXTURE) ?
+        gpu::Sampler(gpu::Sampler::FILTER_MIN_MAG_MIP_LINEAR, gpu::Sampler::WRAP_CLAMP) :
+        gpu::Sampler(gpu::Sampler::FILTER_MIN_MAG_MIP_LINEAR);
+    if (isBakeable) {
+        QVariantHash metadata;
+        gpu::Texture* bakedTexture = bakedTextureCache.load(bakedKey, sampler, metadata);
+        if (bakedTexture) {
+            if (_type == CUBE_TEXTURE) {
+                bakedTexture->generateIrradiance();
+            }
+            QMetaObject::invokeMethod(texture.data(), "setImage",
+                Q_ARG(const QImage&, QImage()),
+                Q_ARG(void*, bakedTexture),
+                Q_ARG(bool, metadata.value("isTransparent").toBool()),
+                Q_ARG(const QColor&, QColor::fromRgba(metadata.value("averageColor").toUInt())),
+                Q_ARG(int, metadata.value("originalWidth").toInt()),
+                Q_ARG(int, metadata.value("originalHeight").toInt()));
+            return;
+        }
+    }
+
     listSupportedImageFormats();
 
     // try to help the QImage loader by extracting the image file format from the url filename ext
@@ -473,14 +520,17 @@ void ImageReader::run() {
     } else {
 
         // enforce a fixed maximum area (1024 * 2048)
-        const int MAXIMUM_AREA_SIZE = 2097152;
         if (imageArea > MAXIMUM_AREA_SIZE) {
             float scaleRatio = sqrtf((float)MAXIMUM_AREA_SIZE) / sqrtf((float)imageArea);
             int resizeWidth = static_cast<int>(std::floor(scaleRatio * static_cast<float>(image.width())));
             int resizeHeight = static_cast<int>(std::floor(scaleRatio * static_cast<float>(image.height())));
             qCDebug(renderutils) << "Image greater than maximum size:" << _url << image.width() << image.height() <<
                 " scaled to:" << resizeWidth << resizeHeight;
-            image = image.scaled(resizeWidth, resizeHeight, Qt::IgnoreAspectRatio);
+
+            // averaged over each texel's footprint, where QImage would just pick the nearest
+            QImage::Format format = image.hasAlphaChannel() ? QImage::Format_ARGB32 : QImage::Format_RGB888;
+            image = toImage(gpu::resampleImage(toTexelImage(image.convertToFormat(format)), resizeWidth, resizeHeight,
+                false), format);
             imageArea = image.width() * image.height();
         }
     }
@@ -687,25 +737,34 @@ void ImageReader::run() {
 
             // If the 6 faces have been created go on and define the true Texture
             if (faces.size() == gpu::Texture::NUM_FACES_PER_TYPE[gpu::Texture::TEX_CUBE]) {
-                theTexture = gpu::Texture::createCube(formatGPU, faces[0].width(), gpu::Sampler(gpu::Sampler::FILTER_MIN_MAG_MIP_LINEAR, gpu::Sampler::WRAP_CLAMP));
-                theTexture->autoGenerateMips(-1);
-                int f = 0;
+                std::vector<gpu::TexelImage> faceTexels;
                 for (auto& face : faces) {
-                    theTexture->assignStoredMipFace(0, formatMip, face.byteCount(), face.constBits(), f);
-                    f++;
+                    faceTexels.push_back(toTexelImage(face));
                 }
+                theTexture = gpu::createMippedTexture(gpu::Texture::TEX_CUBE, faceTexels, formatGPU, formatMip, false, sampler);
                 
                 // GEnerate irradiance while we are at it
                 theTexture->generateIrradiance();
             }
 
         } else {
-            theTexture = (gpu::Texture::create2D(formatGPU, image.width(), image.height(), gpu::Sampler(gpu::Sampler::FILTER_MIN_MAG_MIP_LINEAR)));
-            theTexture->assignStoredMip(0, formatMip, image.byteCount(), image.constBits());
-            theTexture->autoGenerateMips(-1);
+            // lightmaps are large and smooth, and so compress well; diffuse maps share their type with UI images and with
+            // retextured normal maps, so they're left alone
+            bool compress = (_type == EMISSIVE_TEXTURE);
+            theTexture = gpu::createMippedTexture(gpu::Texture::TEX_2D, std::vector<gpu::TexelImage>(1, toTexelImage(image)),
+                formatGPU, formatMip, compress, sampler);
         }
     }
 
+    if (theTexture && isBakeable) {
+        QVariantHash metadata;
+        metadata.insert("isTransparent", isTransparent);
+        metadata.insert("averageColor", averageColor.rgba());
+        metadata.insert("originalWidth", originalWidth);
+        metadata.insert("originalHeight", originalHeight);
+        bakedTextureCache.save(bakedKey, *theTexture, metadata);
+    }
+
     QMetaObject::invokeMethod(texture.data(), "setImage", 
         Q_ARG(const QImage&, image),
         Q_ARG(void*, theTexture),
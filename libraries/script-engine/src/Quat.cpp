@@ -9,6 +9,8 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <algorithm>
+
 #include <glm/gtx/vector_angle.hpp>
 
 #include <QDebug>
@@ -16,6 +18,7 @@
 #include <OctreeConstants.h>
 #include <GLMHelpers.h>
 #include "ScriptEngineLogging.h"
+#include "TypedArrays.h"
 #include "Quat.h"
 
 
@@ -97,3 +100,43 @@ bool Quat::equal(const glm::vec3& q1, const glm::vec3& q2) {
     return q1 == q2;
 }
 
+int Quat::multiplyArrays(QScriptValue result, QScriptValue q1s, QScriptValue q2s) {
+    Float32ArrayAccess resultAccess(result), q1Access(q1s), q2Access(q2s);
+    if (!resultAccess.isValid() || !q1Access.isValid() || !q2Access.isValid()) {
+        qCDebug(scriptengine) << "Quat.multiplyArrays expects Float32Array arguments";
+        return 0;
+    }
+    quint32 numQuats = std::min(std::min(resultAccess.length(), q1Access.length()), q2Access.length()) / 4;
+    for (quint32 i = 0; i < numQuats; i++) {
+        resultAccess.setQuat(i, q1Access.quatAt(i) * q2Access.quatAt(i));
+    }
+    return numQuats;
+}
+
+int Quat::multiplyVec3Array(QScriptValue result, const glm::quat& q, QScriptValue vs) {
+    Float32ArrayAccess resultAccess(result), vAccess(vs);
+    if (!resultAccess.isValid() || !vAccess.isValid()) {
+        qCDebug(scriptengine) << "Quat.multiplyVec3Array expects Float32Array arguments";
+        return 0;
+    }
+    // rotating by a matrix is cheaper than by the quaternion once there are a few vectors
+    glm::mat3 rotation = glm::mat3_cast(q);
+    quint32 numVectors = std::min(resultAccess.length(), vAccess.length()) / 3;
+    for (quint32 i = 0; i < numVectors; i++) {
+        resultAccess.setVec3(i, rotation * vAccess.vec3At(i));
+    }
+    return numVectors;
+}
+
+int Quat::slerpArrays(QScriptValue result, QScriptValue q1s, QScriptValue q2s, float alpha) {
+    Float32ArrayAccess resultAccess(result), q1Access(q1s), q2Access(q2s);
+    if (!resultAccess.isValid() || !q1Access.isValid() || !q2Access.isValid()) {
+        qCDebug(scriptengine) << "Quat.slerpArrays expects Float32Array arguments";
+        return 0;
+    }
+    quint32 numQuats = std::min(std::min(resultAccess.length(), q1Access.length()), q2Access.length()) / 4;
+    for (quint32 i = 0; i < numQuats; i++) {
+        resultAccess.setQuat(i, glm::slerp(q1Access.quatAt(i), q2Access.quatAt(i), alpha));
+    }
+    return numQuats;
+}
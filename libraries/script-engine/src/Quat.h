@@ -18,6 +18,7 @@
 
 #include <QObject>
 #include <QString>
+#include <QtScript/QScriptValue>
 
 /// Scriptable interface a Quaternion helper class object. Used exclusively in the JavaScript API
 class Quat : public QObject {
@@ -43,6 +44,12 @@ public slots:
     float dot(const glm::quat& q1, const glm::quat& q2);
     void print(const QString& lable, const glm::quat& q);
     bool equal(const glm::vec3& q1, const glm::vec3& q2);
+
+    // Batched versions for Float32Arrays, of x, y, z, w quadruples for quaternions and x, y, z triples for vectors.
+    // Like the Vec3 ones they return how many elements of the shortest array they worked on, and may work in place.
+    int multiplyArrays(QScriptValue result, QScriptValue q1s, QScriptValue q2s);
+    int multiplyVec3Array(QScriptValue result, const glm::quat& q, QScriptValue vs); // rotates every vector by q
+    int slerpArrays(QScriptValue result, QScriptValue q1s, QScriptValue q2s, float alpha);
 };
 
 #endif // hifi_Quat_h
@@ -94,8 +94,16 @@ ScriptEngine::ScriptEngine(const QString& scriptContents, const QString& fileNam
     _vec3Library(),
     _uuidLibrary(),
     _isUserLoaded(false),
+    _timerQueueTimer(new QTimer(this)),
     _arrayBufferClass(new ArrayBufferClass(this))
 {
+    _timerQueueTimer->setSingleShot(true);
+    connect(_timerQueueTimer, &QTimer::timeout, this, &ScriptEngine::timerFired);
+
+    // make sure the timers stop when the script does
+    connect(this, &ScriptEngine::scriptEnding, _timerQueueTimer, &QTimer::stop);
+    _timerQueueClock.start();
+
     _allScriptsMutex.lock();
     _allKnownScriptEngines.insert(this);
     _allScriptsMutex.unlock();
@@ -518,12 +526,29 @@ QScriptValue ScriptEngine::evaluate(const QString& program, const QString& fileN
 
 void ScriptEngine::sendAvatarIdentityPacket() {
     if (_isAvatar && _avatarData) {
-        _avatarData->sendIdentityPacket();
+        if (_hostedAvatarID.isNull()) {
+            _avatarData->sendIdentityPacket();
+        } else {
+            auto nodeList = DependencyManager::get<NodeList>();
+            QByteArray identityPacket = nodeList->byteArrayWithPopulatedHeader(PacketTypeHostedAvatarIdentity);
+            QByteArray identityData = _avatarData->identityByteArray();
+            identityData.replace(0, NUM_BYTES_RFC4122_UUID, _hostedAvatarID.toRfc4122());
+            identityPacket.append(identityData);
+
+            _hostedAvatarPackets << identityPacket;
+        }
     }
 }
 
+QList<QByteArray> ScriptEngine::takeHostedAvatarPackets() {
+    QList<QByteArray> packets;
+    packets.swap(_hostedAvatarPackets);
+    return packets;
+}
+
 void ScriptEngine::sendAvatarBillboardPacket() {
-    if (_isAvatar && _avatarData) {
+    // the avatar mixer keeps one billboard per node, hosted avatars go without
+    if (_isAvatar && _avatarData && _hostedAvatarID.isNull()) {
         _avatarData->sendBillboardPacket();
     }
 }
@@ -532,25 +557,13 @@ void ScriptEngine::run() {
     // TODO: can we add a short circuit for _stoppingAllScripts here? What does it mean to not start running if
     // we're in the process of stopping?
 
-    if (!_isInitialized) {
-        init();
-    }
-    _isRunning = true;
-    _isFinished = false;
-    emit runningStateChanged();
-
-    QScriptValue result = evaluate(_scriptContents);
+    beginRunning();
 
     QElapsedTimer startTime;
     startTime.start();
 
     int thisFrame = 0;
 
-    auto nodeList = DependencyManager::get<NodeList>();
-    auto entityScriptingInterface = DependencyManager::get<EntityScriptingInterface>();
-
-    qint64 lastUpdate = usecTimestampNow();
-
     while (!_isFinished) {
         int usecToSleep = (thisFrame++ * SCRIPT_DATA_CALLBACK_USECS) - startTime.nsecsElapsed() / 1000; // nsec to usec
         if (usecToSleep > 0) {
@@ -563,144 +576,188 @@ void ScriptEngine::run() {
 
         QCoreApplication::processEvents();
 
-        if (_isFinished) {
-            break;
-        }
+        runFrame();
+    }
 
-        if (!_isFinished && entityScriptingInterface->getEntityPacketSender()->serversExist()) {
-            // release the queue of edit entity messages.
-            entityScriptingInterface->getEntityPacketSender()->releaseQueuedMessages();
+    finishRunning();
 
-            // since we're in non-threaded mode, call process so that the packets are sent
-            if (!entityScriptingInterface->getEntityPacketSender()->isThreaded()) {
-                entityScriptingInterface->getEntityPacketSender()->process();
-            }
-        }
+    // If we were on a thread, then wait till it's done
+    if (thread()) {
+        thread()->quit();
+    }
+}
+
+void ScriptEngine::beginRunning() {
+    if (!_isInitialized) {
+        init();
+    }
+    _isRunning = true;
+    _isFinished = false;
+    emit runningStateChanged();
+
+    QScriptValue result = evaluate(_scriptContents);
+
+    _lastFrameUpdate = usecTimestampNow();
+}
+
+void ScriptEngine::runFrame() {
+    if (_isFinished) {
+        return;
+    }
 
-        if (!_isFinished && _isAvatar && _avatarData) {
+    auto nodeList = DependencyManager::get<NodeList>();
+    auto entityScriptingInterface = DependencyManager::get<EntityScriptingInterface>();
+
+    if (_hostedAvatarID.isNull() && entityScriptingInterface->getEntityPacketSender()->serversExist()) {
+        // release the queue of edit entity messages.
+        entityScriptingInterface->getEntityPacketSender()->releaseQueuedMessages();
 
-            const int SCRIPT_AUDIO_BUFFER_SAMPLES = floor(((SCRIPT_DATA_CALLBACK_USECS * AudioConstants::SAMPLE_RATE)
-                                                           / (1000 * 1000)) + 0.5);
-            const int SCRIPT_AUDIO_BUFFER_BYTES = SCRIPT_AUDIO_BUFFER_SAMPLES * sizeof(int16_t);
+        // since we're in non-threaded mode, call process so that the packets are sent
+        if (!entityScriptingInterface->getEntityPacketSender()->isThreaded()) {
+            entityScriptingInterface->getEntityPacketSender()->process();
+        }
+    }
 
+    if (_isAvatar && _avatarData) {
+        if (_hostedAvatarID.isNull()) {
             QByteArray avatarPacket = nodeList->byteArrayWithPopulatedHeader(PacketTypeAvatarData);
             avatarPacket.append(_avatarData->toByteArray());
 
             nodeList->broadcastToNodes(avatarPacket, NodeSet() << NodeType::AvatarMixer);
 
-            if (_isListeningToAudioStream || _avatarSound) {
-                // if we have an avatar audio stream then send it out to our audio-mixer
-                bool silentFrame = true;
-
-                int16_t numAvailableSamples = SCRIPT_AUDIO_BUFFER_SAMPLES;
-                const int16_t* nextSoundOutput = NULL;
-
-                if (_avatarSound) {
+            sendAvatarAudio();
+        } else {
+            // one of many avatars sharing our node, the avatar mixer tells them apart by the ID we prefix
+            QByteArray avatarPacket = nodeList->byteArrayWithPopulatedHeader(PacketTypeHostedAvatarData);
+            avatarPacket.append(_hostedAvatarID.toRfc4122());
+            avatarPacket.append(_avatarData->toByteArray());
 
-                    const QByteArray& soundByteArray = _avatarSound->getByteArray();
-                    nextSoundOutput = reinterpret_cast<const int16_t*>(soundByteArray.data()
-                                                                       + _numAvatarSoundSentBytes);
+            _hostedAvatarPackets << avatarPacket;
+        }
+    }
 
-                    int numAvailableBytes = (soundByteArray.size() - _numAvatarSoundSentBytes) > SCRIPT_AUDIO_BUFFER_BYTES
-                        ? SCRIPT_AUDIO_BUFFER_BYTES
-                        : soundByteArray.size() - _numAvatarSoundSentBytes;
-                    numAvailableSamples = numAvailableBytes / sizeof(int16_t);
+    qint64 now = usecTimestampNow();
+    float deltaTime = (float) (now - _lastFrameUpdate) / (float) USECS_PER_SECOND;
 
+    if (hasUncaughtException()) {
+        int line = uncaughtExceptionLineNumber();
+        qCDebug(scriptengine) << "Uncaught exception at (" << _fileNameString << ") line" << line << ":" << uncaughtException().toString();
+        emit errorMessage("Uncaught exception at (" + _fileNameString + ") line" + QString::number(line) + ":" + uncaughtException().toString());
+        clearExceptions();
+    }
 
-                    // check if the all of the _numAvatarAudioBufferSamples to be sent are silence
-                    for (int i = 0; i < numAvailableSamples; ++i) {
-                        if (nextSoundOutput[i] != 0) {
-                            silentFrame = false;
-                            break;
-                        }
-                    }
+    if (!_isFinished) {
+        emit update(deltaTime);
+    }
+    _lastFrameUpdate = now;
+}
 
-                    _numAvatarSoundSentBytes += numAvailableBytes;
-                    if (_numAvatarSoundSentBytes == soundByteArray.size()) {
-                        // we're done with this sound object - so set our pointer back to NULL
-                        // and our sent bytes back to zero
-                        _avatarSound = NULL;
-                        _numAvatarSoundSentBytes = 0;
-                    }
-                }
-                
-                QByteArray audioPacket = nodeList->byteArrayWithPopulatedHeader(silentFrame
-                                                                                ? PacketTypeSilentAudioFrame
-                                                                                : PacketTypeMicrophoneAudioNoEcho);
+void ScriptEngine::sendAvatarAudio() {
+    if (!_isListeningToAudioStream && !_avatarSound) {
+        return;
+    }
 
-                QDataStream packetStream(&audioPacket, QIODevice::Append);
+    const int SCRIPT_AUDIO_BUFFER_SAMPLES = floor(((SCRIPT_DATA_CALLBACK_USECS * AudioConstants::SAMPLE_RATE)
+                                                   / (1000 * 1000)) + 0.5);
+    const int SCRIPT_AUDIO_BUFFER_BYTES = SCRIPT_AUDIO_BUFFER_SAMPLES * sizeof(int16_t);
 
-                // pack a placeholder value for sequence number for now, will be packed when destination node is known
-                int numPreSequenceNumberBytes = audioPacket.size();
-                packetStream << (quint16) 0;
+    // if we have an avatar audio stream then send it out to our audio-mixer
+    bool silentFrame = true;
 
-                if (silentFrame) {
-                    if (!_isListeningToAudioStream) {
-                        // if we have a silent frame and we're not listening then just send nothing and break out of here
-                        break;
-                    }
+    int16_t numAvailableSamples = SCRIPT_AUDIO_BUFFER_SAMPLES;
+    const int16_t* nextSoundOutput = NULL;
 
-                    // write the number of silent samples so the audio-mixer can uphold timing
-                    packetStream.writeRawData(reinterpret_cast<const char*>(&SCRIPT_AUDIO_BUFFER_SAMPLES), sizeof(int16_t));
+    if (_avatarSound) {
 
-                    // use the orientation and position of this avatar for the source of this audio
-                    packetStream.writeRawData(reinterpret_cast<const char*>(&_avatarData->getPosition()), sizeof(glm::vec3));
-                    glm::quat headOrientation = _avatarData->getHeadOrientation();
-                    packetStream.writeRawData(reinterpret_cast<const char*>(&headOrientation), sizeof(glm::quat));
+        const QByteArray& soundByteArray = _avatarSound->getByteArray();
+        nextSoundOutput = reinterpret_cast<const int16_t*>(soundByteArray.data()
+                                                           + _numAvatarSoundSentBytes);
 
-                } else if (nextSoundOutput) {
-                    // assume scripted avatar audio is mono and set channel flag to zero
-                    packetStream << (quint8)0;
+        int numAvailableBytes = (soundByteArray.size() - _numAvatarSoundSentBytes) > SCRIPT_AUDIO_BUFFER_BYTES
+            ? SCRIPT_AUDIO_BUFFER_BYTES
+            : soundByteArray.size() - _numAvatarSoundSentBytes;
+        numAvailableSamples = numAvailableBytes / sizeof(int16_t);
 
-                    // use the orientation and position of this avatar for the source of this audio
-                    packetStream.writeRawData(reinterpret_cast<const char*>(&_avatarData->getPosition()), sizeof(glm::vec3));
-                    glm::quat headOrientation = _avatarData->getHeadOrientation();
-                    packetStream.writeRawData(reinterpret_cast<const char*>(&headOrientation), sizeof(glm::quat));
 
-                    // write the raw audio data
-                    packetStream.writeRawData(reinterpret_cast<const char*>(nextSoundOutput), numAvailableSamples * sizeof(int16_t));
-                }
-                
-                // write audio packet to AudioMixer nodes
-                auto nodeList = DependencyManager::get<NodeList>();
-                nodeList->eachNode([this, &nodeList, &audioPacket, &numPreSequenceNumberBytes](const SharedNodePointer& node){
-                    // only send to nodes of type AudioMixer
-                    if (node->getType() == NodeType::AudioMixer) {
-                        // pack sequence number
-                        quint16 sequence = _outgoingScriptAudioSequenceNumbers[node->getUUID()]++;
-                        memcpy(audioPacket.data() + numPreSequenceNumberBytes, &sequence, sizeof(quint16));
-                        
-                        // send audio packet
-                        nodeList->writeDatagram(audioPacket, node);
-                    }
-                });
+        // check if the all of the _numAvatarAudioBufferSamples to be sent are silence
+        for (int i = 0; i < numAvailableSamples; ++i) {
+            if (nextSoundOutput[i] != 0) {
+                silentFrame = false;
+                break;
             }
         }
 
-        qint64 now = usecTimestampNow();
-        float deltaTime = (float) (now - lastUpdate) / (float) USECS_PER_SECOND;
-
-        if (hasUncaughtException()) {
-            int line = uncaughtExceptionLineNumber();
-            qCDebug(scriptengine) << "Uncaught exception at (" << _fileNameString << ") line" << line << ":" << uncaughtException().toString();
-            emit errorMessage("Uncaught exception at (" + _fileNameString + ") line" + QString::number(line) + ":" + uncaughtException().toString());
-            clearExceptions();
+        _numAvatarSoundSentBytes += numAvailableBytes;
+        if (_numAvatarSoundSentBytes == soundByteArray.size()) {
+            // we're done with this sound object - so set our pointer back to NULL
+            // and our sent bytes back to zero
+            _avatarSound = NULL;
+            _numAvatarSoundSentBytes = 0;
         }
+    }
+
+    auto nodeList = DependencyManager::get<NodeList>();
+    QByteArray audioPacket = nodeList->byteArrayWithPopulatedHeader(silentFrame
+                                                                    ? PacketTypeSilentAudioFrame
+                                                                    : PacketTypeMicrophoneAudioNoEcho);
+
+    QDataStream packetStream(&audioPacket, QIODevice::Append);
 
-        if (!_isFinished) {
-            emit update(deltaTime);
+    // pack a placeholder value for sequence number for now, will be packed when destination node is known
+    int numPreSequenceNumberBytes = audioPacket.size();
+    packetStream << (quint16) 0;
+
+    if (silentFrame) {
+        if (!_isListeningToAudioStream) {
+            // if we have a silent frame and we're not listening then just send nothing
+            return;
         }
-        lastUpdate = now;
-        
+
+        // write the number of silent samples so the audio-mixer can uphold timing
+        packetStream.writeRawData(reinterpret_cast<const char*>(&SCRIPT_AUDIO_BUFFER_SAMPLES), sizeof(int16_t));
+
+        // use the orientation and position of this avatar for the source of this audio
+        packetStream.writeRawData(reinterpret_cast<const char*>(&_avatarData->getPosition()), sizeof(glm::vec3));
+        glm::quat headOrientation = _avatarData->getHeadOrientation();
+        packetStream.writeRawData(reinterpret_cast<const char*>(&headOrientation), sizeof(glm::quat));
+
+    } else if (nextSoundOutput) {
+        // assume scripted avatar audio is mono and set channel flag to zero
+        packetStream << (quint8)0;
+
+        // use the orientation and position of this avatar for the source of this audio
+        packetStream.writeRawData(reinterpret_cast<const char*>(&_avatarData->getPosition()), sizeof(glm::vec3));
+        glm::quat headOrientation = _avatarData->getHeadOrientation();
+        packetStream.writeRawData(reinterpret_cast<const char*>(&headOrientation), sizeof(glm::quat));
+
+        // write the raw audio data
+        packetStream.writeRawData(reinterpret_cast<const char*>(nextSoundOutput), numAvailableSamples * sizeof(int16_t));
     }
 
+    // write audio packet to AudioMixer nodes
+    nodeList->eachNode([this, &nodeList, &audioPacket, &numPreSequenceNumberBytes](const SharedNodePointer& node){
+        // only send to nodes of type AudioMixer
+        if (node->getType() == NodeType::AudioMixer) {
+            // pack sequence number
+            quint16 sequence = _outgoingScriptAudioSequenceNumbers[node->getUUID()]++;
+            memcpy(audioPacket.data() + numPreSequenceNumberBytes, &sequence, sizeof(quint16));
+
+            // send audio packet
+            nodeList->writeDatagram(audioPacket, node);
+        }
+    });
+}
+
+void ScriptEngine::finishRunning() {
     stopAllTimers(); // make sure all our timers are stopped if the script is ending
     emit scriptEnding();
 
     // kill the avatar identity timer
     delete _avatarIdentityTimer;
+    _avatarIdentityTimer = NULL;
 
-    if (entityScriptingInterface->getEntityPacketSender()->serversExist()) {
+    auto entityScriptingInterface = DependencyManager::get<EntityScriptingInterface>();
+    if (_hostedAvatarID.isNull() && entityScriptingInterface->getEntityPacketSender()->serversExist()) {
         // release the queue of edit entity messages.
         entityScriptingInterface->getEntityPacketSender()->releaseQueuedMessages();
 
@@ -710,11 +767,6 @@ void ScriptEngine::run() {
         }
     }
 
-    // If we were on a thread, then wait till it's done
-    if (thread()) {
-        thread()->quit();
-    }
-
     emit finished(_fileNameString);
 
     _isRunning = false;
@@ -728,12 +780,9 @@ void ScriptEngine::run() {
 // NOTE: This is private because it must be called on the same thread that created the timers, which is why
 // we want to only call it in our own run "shutdown" processing.
 void ScriptEngine::stopAllTimers() {
-    QMutableHashIterator<QTimer*, QScriptValue> i(_timerFunctionMap);
-    while (i.hasNext()) {
-        i.next();
-        QTimer* timer = i.key();
-        stopTimer(timer);
-    }
+    _timerQueueTimer->stop();
+    _timerQueue.clear();
+    _timerFunctionMap.clear();
 }
 
 void ScriptEngine::stop() {
@@ -744,60 +793,72 @@ void ScriptEngine::stop() {
 }
 
 void ScriptEngine::timerFired() {
-    QTimer* callingTimer = reinterpret_cast<QTimer*>(sender());
-    QScriptValue timerFunction = _timerFunctionMap.value(callingTimer);
-    
-    if (!callingTimer->isActive()) {
-        // this timer is done, we can kill it
-        _timerFunctionMap.remove(callingTimer);
-        delete callingTimer;
-    }
-    
-    // call the associated JS function, if it exists
-    if (timerFunction.isValid()) {
-        timerFunction.call();
-    }
-}
+    // everything due by now fires in this one pass, in the order it came due
+    std::vector<TimerQueue::TimerID> dueTimers;
+    _timerQueue.takeDueTimers(_timerQueueClock.elapsed(), dueTimers);
+
+    for (TimerQueue::TimerID timerID : dueTimers) {
+        // an earlier callback may have cleared this timer
+        if (!_timerFunctionMap.contains(timerID)) {
+            continue;
+        }
+        QScriptValue timerFunction = _timerFunctionMap.value(timerID);
+
+        if (!_timerQueue.hasTimer(timerID)) {
+            // this timer is done, we can forget it
+            _timerFunctionMap.remove(timerID);
+        }
 
-QObject* ScriptEngine::setupTimerWithInterval(const QScriptValue& function, int intervalMS, bool isSingleShot) {
-    // create the timer, add it to the map, and start it
-    QTimer* newTimer = new QTimer(this);
-    newTimer->setSingleShot(isSingleShot);
+        // call the associated JS function, if it exists
+        if (timerFunction.isValid()) {
+            timerFunction.call();
+        }
+    }
 
-    connect(newTimer, &QTimer::timeout, this, &ScriptEngine::timerFired);
+    scheduleTimerQueue();
+}
 
-    // make sure the timer stops when the script does
-    connect(this, &ScriptEngine::scriptEnding, newTimer, &QTimer::stop);
+void ScriptEngine::scheduleTimerQueue() {
+    if (_timerQueue.isEmpty() || _isFinished) {
+        _timerQueueTimer->stop();
+        return;
+    }
+    qint64 msecsUntilDue = std::max(_timerQueue.getNextDueTime() - _timerQueueClock.elapsed(), (qint64)0);
+    _timerQueueTimer->start((int)msecsUntilDue);
+}
 
-    _timerFunctionMap.insert(newTimer, function);
+int ScriptEngine::setupTimerWithInterval(const QScriptValue& function, int intervalMS, bool isSingleShot) {
+    TimerQueue::TimerID timerID = _timerQueue.addTimer(_timerQueueClock.elapsed(), intervalMS, isSingleShot);
+    _timerFunctionMap.insert(timerID, function);
 
-    newTimer->start(intervalMS);
-    return newTimer;
+    // the new timer may be due before the one the QTimer is armed for
+    scheduleTimerQueue();
+    return timerID;
 }
 
-QObject* ScriptEngine::setInterval(const QScriptValue& function, int intervalMS) {
+int ScriptEngine::setInterval(const QScriptValue& function, int intervalMS) {
     if (_stoppingAllScripts) {
         qCDebug(scriptengine) << "Script.setInterval() while shutting down is ignored... parent script:" << getFilename();
-        return NULL; // bail early
+        return 0; // bail early
     }
 
     return setupTimerWithInterval(function, intervalMS, false);
 }
 
-QObject* ScriptEngine::setTimeout(const QScriptValue& function, int timeoutMS) {
+int ScriptEngine::setTimeout(const QScriptValue& function, int timeoutMS) {
     if (_stoppingAllScripts) {
         qCDebug(scriptengine) << "Script.setTimeout() while shutting down is ignored... parent script:" << getFilename();
-        return NULL; // bail early
+        return 0; // bail early
     }
 
     return setupTimerWithInterval(function, timeoutMS, true);
 }
 
-void ScriptEngine::stopTimer(QTimer *timer) {
-    if (_timerFunctionMap.contains(timer)) {
-        timer->stop();
-        _timerFunctionMap.remove(timer);
-        delete timer;
+void ScriptEngine::stopTimer(int timerID) {
+    // a single shot timer that came due in the current pass is already out of the queue but still has its function
+    _timerFunctionMap.remove(timerID);
+    if (_timerQueue.removeTimer(timerID) && _timerQueue.isEmpty()) {
+        _timerQueueTimer->stop();
     }
 }
 
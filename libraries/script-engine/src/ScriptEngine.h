@@ -14,6 +14,7 @@
 
 #include <vector>
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QObject>
 #include <QtCore/QUrl>
 #include <QtCore/QWaitCondition>
@@ -24,6 +25,7 @@
 #include <AvatarHashMap.h>
 #include <LimitedNodeList.h>
 #include <EntityItemID.h>
+#include <TimerQueue.h>
 
 #include "AbstractControllerScriptingInterface.h"
 #include "ArrayBufferClass.h"
@@ -76,6 +78,21 @@ public:
 
     void init();
     void run(); /// runs continuously until Agent.stop() is called
+
+    /// For hosts that drive many engines from their own loop: beginRunning() evaluates the script, runFrame() then
+    /// does what one iteration of run() does short of sleeping and processing events, and finishRunning() cleans up.
+    void beginRunning();
+    void runFrame();
+    void finishRunning();
+
+    /// Avatars of engines sharing one node are sent with this ID so the avatar mixer can tell them apart. Audio and
+    /// billboards are per node, so they are not sent for hosted avatars.
+    void setHostedAvatarID(const QUuid& hostedAvatarID) { _hostedAvatarID = hostedAvatarID; }
+    const QUuid& getHostedAvatarID() const { return _hostedAvatarID; }
+
+    /// Hosted engines run on threads of their own, so they don't send: their avatar packets wait here for the host to
+    /// send from its thread, and the host releases the entity edits they queue.
+    QList<QByteArray> takeHostedAvatarPackets();
     void evaluate(); /// initializes the engine, and evaluates the script, but then returns control to caller
 
     void timerFired();
@@ -108,10 +125,10 @@ public slots:
     void stop();
 
     QScriptValue evaluate(const QString& program, const QString& fileName = QString(), int lineNumber = 1);
-    QObject* setInterval(const QScriptValue& function, int intervalMS);
-    QObject* setTimeout(const QScriptValue& function, int timeoutMS);
-    void clearInterval(QObject* timer) { stopTimer(reinterpret_cast<QTimer*>(timer)); }
-    void clearTimeout(QObject* timer) { stopTimer(reinterpret_cast<QTimer*>(timer)); }
+    int setInterval(const QScriptValue& function, int intervalMS);
+    int setTimeout(const QScriptValue& function, int timeoutMS);
+    void clearInterval(int timerID) { stopTimer(timerID); }
+    void clearTimeout(int timerID) { stopTimer(timerID); }
     void include(const QStringList& includeFiles, QScriptValue callback = QScriptValue());
     void include(const QString& includeFile, QScriptValue callback = QScriptValue());
     void load(const QString& loadfile);
@@ -144,7 +161,7 @@ protected:
     bool _isAvatar;
     QTimer* _avatarIdentityTimer;
     QTimer* _avatarBillboardTimer;
-    QHash<QTimer*, QScriptValue> _timerFunctionMap;
+    QHash<TimerQueue::TimerID, QScriptValue> _timerFunctionMap;
     bool _isListeningToAudioStream;
     Sound* _avatarSound;
     int _numAvatarSoundSentBytes;
@@ -153,9 +170,11 @@ private:
     void stopAllTimers();
     void sendAvatarIdentityPacket();
     void sendAvatarBillboardPacket();
+    void sendAvatarAudio();
 
-    QObject* setupTimerWithInterval(const QScriptValue& function, int intervalMS, bool isSingleShot);
-    void stopTimer(QTimer* timer);
+    int setupTimerWithInterval(const QScriptValue& function, int intervalMS, bool isSingleShot);
+    void stopTimer(int timerID);
+    void scheduleTimerQueue();
 
     AbstractControllerScriptingInterface* _controllerScriptingInterface;
     AvatarData* _avatarData;
@@ -165,6 +184,14 @@ private:
     Vec3 _vec3Library;
     ScriptUUID _uuidLibrary;
     bool _isUserLoaded;
+    QUuid _hostedAvatarID;
+    QList<QByteArray> _hostedAvatarPackets;
+    qint64 _lastFrameUpdate = 0;
+
+    // all of the script's timeouts and intervals are served by one QTimer, armed for whichever is due first
+    TimerQueue _timerQueue;
+    QTimer* _timerQueueTimer;
+    QElapsedTimer _timerQueueClock;
 
     ArrayBufferClass* _arrayBufferClass;
 
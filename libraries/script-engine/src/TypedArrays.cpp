@@ -11,6 +11,8 @@
 
 #include <glm/glm.hpp>
 
+#include <QtCore/QtEndian>
+
 #include "ScriptEngine.h"
 #include "TypedArrayPrototype.h"
 
@@ -416,3 +418,53 @@ void Float64ArrayClass::setProperty(QScriptValue& object, const QScriptString& n
     }
 }
 
+Float32ArrayAccess::Float32ArrayAccess(const QScriptValue& array) :
+    _data(NULL),
+    _length(0)
+{
+    if (!dynamic_cast<Float32ArrayClass*>(array.scriptClass())) {
+        return;
+    }
+    QScriptValue data = array.data();
+    QByteArray* arrayBuffer = qscriptvalue_cast<QByteArray*>(data.property(BUFFER_PROPERTY_NAME).data());
+    quint32 byteOffset = data.property(BYTE_OFFSET_PROPERTY_NAME).toUInt32();
+    quint32 length = data.property(LENGTH_PROPERTY_NAME).toUInt32();
+    if (arrayBuffer && byteOffset + (quint64)length * sizeof(float) <= (quint64)arrayBuffer->size()) {
+        _data = reinterpret_cast<uchar*>(arrayBuffer->data()) + byteOffset;
+        _length = length;
+    }
+}
+
+float Float32ArrayAccess::at(quint32 index) const {
+    quint32 bits = qFromBigEndian<quint32>(_data + index * sizeof(float));
+    float value;
+    memcpy(&value, &bits, sizeof(float));
+    return value;
+}
+
+void Float32ArrayAccess::set(quint32 index, float value) {
+    quint32 bits;
+    memcpy(&bits, &value, sizeof(float));
+    qToBigEndian<quint32>(bits, _data + index * sizeof(float));
+}
+
+glm::vec3 Float32ArrayAccess::vec3At(quint32 index) const {
+    return glm::vec3(at(3 * index), at(3 * index + 1), at(3 * index + 2));
+}
+
+void Float32ArrayAccess::setVec3(quint32 index, const glm::vec3& value) {
+    set(3 * index, value.x);
+    set(3 * index + 1, value.y);
+    set(3 * index + 2, value.z);
+}
+
+glm::quat Float32ArrayAccess::quatAt(quint32 index) const {
+    return glm::quat(at(4 * index + 3), at(4 * index), at(4 * index + 1), at(4 * index + 2));
+}
+
+void Float32ArrayAccess::setQuat(quint32 index, const glm::quat& value) {
+    set(4 * index, value.x);
+    set(4 * index + 1, value.y);
+    set(4 * index + 2, value.z);
+    set(4 * index + 3, value.w);
+}
@@ -12,6 +12,9 @@
 #ifndef hifi_TypedArrays_h
 #define hifi_TypedArrays_h
 
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
 #include "ArrayBufferViewClass.h"
 
 static const QString BYTES_PER_ELEMENT_PROPERTY_NAME = "BYTES_PER_ELEMENT";
@@ -145,4 +148,30 @@ public:
     void setProperty(QScriptValue& object, const QScriptString& name, uint id, const QScriptValue& value);
 };
 
+/// Lets native code work on the floats of a Float32Array directly instead of through a property lookup per element.
+/// Like the property accessors, this keeps the elements big endian, the way QDataStream writes them.
+class Float32ArrayAccess {
+public:
+    /// not valid unless array is a Float32Array whose elements all lie within its buffer
+    Float32ArrayAccess(const QScriptValue& array);
+
+    bool isValid() const { return _data != NULL; }
+    quint32 length() const { return _length; }
+
+    float at(quint32 index) const;
+    void set(quint32 index, float value);
+
+    /// the index counts vectors, i.e. elements 3 * index to 3 * index + 2
+    glm::vec3 vec3At(quint32 index) const;
+    void setVec3(quint32 index, const glm::vec3& value);
+
+    /// the index counts quaternions stored as x, y, z, w
+    glm::quat quatAt(quint32 index) const;
+    void setQuat(quint32 index, const glm::quat& value);
+
+private:
+    uchar* _data;
+    quint32 _length;
+};
+
 #endif // hifi_TypedArrays_h
\ No newline at end of file
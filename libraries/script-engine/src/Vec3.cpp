@@ -9,11 +9,14 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <algorithm>
+
 #include <glm/gtx/vector_angle.hpp>
 
 #include <QDebug>
 
 #include "ScriptEngineLogging.h"
+#include "TypedArrays.h"
 #include "Vec3.h"
 
 glm::vec3 Vec3::reflect(const glm::vec3& v1, const glm::vec3& v2) {
@@ -73,3 +76,80 @@ void Vec3::print(const QString& lable, const glm::vec3& v) {
 bool Vec3::equal(const glm::vec3& v1, const glm::vec3& v2) {
     return v1 == v2;
 }
+
+// how many vectors of the given arrays can be worked on, after complaining about any argument that is no Float32Array
+static quint32 vectorsInArrays(const char* function, const Float32ArrayAccess& result, quint32 resultStride,
+                               const Float32ArrayAccess& vs, const Float32ArrayAccess* v2s = NULL) {
+    if (!result.isValid() || !vs.isValid() || (v2s && !v2s->isValid())) {
+        qCDebug(scriptengine) << "Vec3." << function << "expects Float32Array arguments";
+        return 0;
+    }
+    quint32 numVectors = std::min(result.length() / resultStride, vs.length() / 3);
+    if (v2s) {
+        numVectors = std::min(numVectors, v2s->length() / 3);
+    }
+    return numVectors;
+}
+
+int Vec3::sumArrays(QScriptValue result, QScriptValue v1s, QScriptValue v2s) {
+    Float32ArrayAccess resultAccess(result), v1Access(v1s), v2Access(v2s);
+    quint32 numVectors = vectorsInArrays("sumArrays", resultAccess, 3, v1Access, &v2Access);
+    for (quint32 i = 0; i < numVectors; i++) {
+        resultAccess.setVec3(i, v1Access.vec3At(i) + v2Access.vec3At(i));
+    }
+    return numVectors;
+}
+
+int Vec3::subtractArrays(QScriptValue result, QScriptValue v1s, QScriptValue v2s) {
+    Float32ArrayAccess resultAccess(result), v1Access(v1s), v2Access(v2s);
+    quint32 numVectors = vectorsInArrays("subtractArrays", resultAccess, 3, v1Access, &v2Access);
+    for (quint32 i = 0; i < numVectors; i++) {
+        resultAccess.setVec3(i, v1Access.vec3At(i) - v2Access.vec3At(i));
+    }
+    return numVectors;
+}
+
+int Vec3::multiplyArray(QScriptValue result, QScriptValue vs, float f) {
+    Float32ArrayAccess resultAccess(result), vAccess(vs);
+    quint32 numVectors = vectorsInArrays("multiplyArray", resultAccess, 3, vAccess);
+    for (quint32 i = 0; i < numVectors; i++) {
+        resultAccess.setVec3(i, vAccess.vec3At(i) * f);
+    }
+    return numVectors;
+}
+
+int Vec3::addScaledArrays(QScriptValue result, QScriptValue v1s, QScriptValue v2s, float f) {
+    Float32ArrayAccess resultAccess(result), v1Access(v1s), v2Access(v2s);
+    quint32 numVectors = vectorsInArrays("addScaledArrays", resultAccess, 3, v1Access, &v2Access);
+    for (quint32 i = 0; i < numVectors; i++) {
+        resultAccess.setVec3(i, v1Access.vec3At(i) + v2Access.vec3At(i) * f);
+    }
+    return numVectors;
+}
+
+int Vec3::mixArrays(QScriptValue result, QScriptValue v1s, QScriptValue v2s, float m) {
+    Float32ArrayAccess resultAccess(result), v1Access(v1s), v2Access(v2s);
+    quint32 numVectors = vectorsInArrays("mixArrays", resultAccess, 3, v1Access, &v2Access);
+    for (quint32 i = 0; i < numVectors; i++) {
+        resultAccess.setVec3(i, glm::mix(v1Access.vec3At(i), v2Access.vec3At(i), m));
+    }
+    return numVectors;
+}
+
+int Vec3::normalizeArray(QScriptValue result, QScriptValue vs) {
+    Float32ArrayAccess resultAccess(result), vAccess(vs);
+    quint32 numVectors = vectorsInArrays("normalizeArray", resultAccess, 3, vAccess);
+    for (quint32 i = 0; i < numVectors; i++) {
+        resultAccess.setVec3(i, glm::normalize(vAccess.vec3At(i)));
+    }
+    return numVectors;
+}
+
+int Vec3::lengthArray(QScriptValue result, QScriptValue vs) {
+    Float32ArrayAccess resultAccess(result), vAccess(vs);
+    quint32 numVectors = vectorsInArrays("lengthArray", resultAccess, 1, vAccess);
+    for (quint32 i = 0; i < numVectors; i++) {
+        resultAccess.set(i, glm::length(vAccess.vec3At(i)));
+    }
+    return numVectors;
+}
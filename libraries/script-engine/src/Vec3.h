@@ -19,6 +19,7 @@
 
 #include <QObject>
 #include <QString>
+#include <QtScript/QScriptValue>
 
 /// Scriptable interface a Vec3ernion helper class object. Used exclusively in the JavaScript API
 class Vec3 : public QObject {
@@ -40,6 +41,17 @@ public slots:
     glm::vec3 mix(const glm::vec3& v1, const glm::vec3& v2, float m);
     void print(const QString& lable, const glm::vec3& v);
     bool equal(const glm::vec3& v1, const glm::vec3& v2);
+
+    // Batched versions of the above for Float32Arrays of x, y, z triples. They work through as many vectors as the
+    // shortest array holds and return that count, or 0 if an argument is not a Float32Array. The result may be one of
+    // the arguments, so things can be updated in place without creating any script objects.
+    int sumArrays(QScriptValue result, QScriptValue v1s, QScriptValue v2s);
+    int subtractArrays(QScriptValue result, QScriptValue v1s, QScriptValue v2s);
+    int multiplyArray(QScriptValue result, QScriptValue vs, float f);
+    int addScaledArrays(QScriptValue result, QScriptValue v1s, QScriptValue v2s, float f); // v1 + v2 * f
+    int mixArrays(QScriptValue result, QScriptValue v1s, QScriptValue v2s, float m);
+    int normalizeArray(QScriptValue result, QScriptValue vs);
+    int lengthArray(QScriptValue result, QScriptValue vs); // one length per vector
 };
 
 
@@ -75,7 +75,7 @@ AngularConstraint* AngularConstraint::newAngularConstraint(const glm::vec3& minA
     return NULL;
 }
 
-bool AngularConstraint::softClamp(glm::quat& targetRotation, const glm::quat& oldRotation, float mixFraction) {
+bool AngularConstraint::softClamp(glm::quat& targetRotation, const glm::quat& oldRotation, float mixFraction) const {
     glm::quat clampedTarget = targetRotation;
     bool clamped = clamp(clampedTarget);
     if (clamped) {
@@ -129,7 +129,7 @@ bool HingeConstraint::clamp(glm::quat& rotation) const {
     return false;
 }
 
-bool HingeConstraint::softClamp(glm::quat& targetRotation, const glm::quat& oldRotation, float mixFraction) {
+bool HingeConstraint::softClamp(glm::quat& targetRotation, const glm::quat& oldRotation, float mixFraction) const {
     // the hinge works best without a soft clamp
     return clamp(targetRotation);
 }
@@ -24,7 +24,7 @@ public:
     AngularConstraint() {}
     virtual ~AngularConstraint() {}
     virtual bool clamp(glm::quat& rotation) const = 0;
-    virtual bool softClamp(glm::quat& targetRotation, const glm::quat& oldRotation, float mixFraction);
+    virtual bool softClamp(glm::quat& targetRotation, const glm::quat& oldRotation, float mixFraction) const;
 protected:
 };
 
@@ -32,7 +32,7 @@ class HingeConstraint : public AngularConstraint {
 public:
     HingeConstraint(const glm::vec3& forwardAxis, const glm::vec3& rotationAxis, float minAngle, float maxAngle);
     virtual bool clamp(glm::quat& rotation) const;
-    virtual bool softClamp(glm::quat& targetRotation, const glm::quat& oldRotation, float mixFraction);
+    virtual bool softClamp(glm::quat& targetRotation, const glm::quat& oldRotation, float mixFraction) const;
 protected:
     glm::vec3 _forwardAxis;
     glm::vec3 _rotationAxis;
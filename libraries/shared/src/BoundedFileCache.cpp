@@ -0,0 +1,126 @@
+//
+//  BoundedFileCache.cpp
+//  libraries/shared/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include "SharedLogging.h"
+
+#include "BoundedFileCache.h"
+
+QSharedPointer<BoundedFileCache> BoundedFileCache::getCache(const QString& directory, const QString& suffix,
+                                                            qint64 maximumSize) {
+    static QMutex cachesMutex;
+    static QHash<QString, QSharedPointer<BoundedFileCache> > caches;
+
+    QString key = QFileInfo(directory).absoluteFilePath() + "/*" + suffix;
+    QMutexLocker locker(&cachesMutex);
+    QSharedPointer<BoundedFileCache>& cache = caches[key];
+    if (!cache) {
+        cache = QSharedPointer<BoundedFileCache>(new BoundedFileCache(directory, suffix, maximumSize));
+    }
+    return cache;
+}
+
+BoundedFileCache::BoundedFileCache(const QString& directory, const QString& suffix, qint64 maximumSize) :
+    _directory(directory),
+    _maximumSize(maximumSize) {
+
+    // oldest first, so that they are evicted first
+    QDir dir(_directory);
+    foreach (const QFileInfo& info, dir.entryInfoList(QStringList("*" + suffix), QDir::Files,
+                                                       QDir::Time | QDir::Reversed)) {
+        addEntry(info.fileName(), info.size());
+    }
+    if (!_entries.isEmpty()) {
+        qCDebug(shared) << "Cache in" << _directory << "holds" << _entries.size() << "files," << _size << "bytes";
+    }
+    reserve(0);
+}
+
+void BoundedFileCache::setMaximumSize(qint64 maximumSize) {
+    QMutexLocker locker(&_mutex);
+    _maximumSize = maximumSize;
+    reserve(0);
+}
+
+qint64 BoundedFileCache::getMaximumSize() const {
+    QMutexLocker locker(&_mutex);
+    return _maximumSize;
+}
+
+qint64 BoundedFileCache::getSize() const {
+    QMutexLocker locker(&_mutex);
+    return _size;
+}
+
+int BoundedFileCache::getFileCount() const {
+    QMutexLocker locker(&_mutex);
+    return _entries.size();
+}
+
+void BoundedFileCache::touch(const QString& fileName) {
+    QMutexLocker locker(&_mutex);
+    QHash<QString, Entry>::iterator it = _entries.find(fileName);
+    if (it == _entries.end()) {
+        // written by another process since we looked
+        QFileInfo info(_directory + "/" + fileName);
+        if (info.exists()) {
+            addEntry(fileName, info.size());
+            reserve(0);
+        }
+        return;
+    }
+    _lru.remove(it->lruKey);
+    it->lruKey = ++_lastLRUKey;
+    _lru.insert(it->lruKey, fileName);
+}
+
+void BoundedFileCache::insert(const QString& fileName, qint64 size) {
+    QMutexLocker locker(&_mutex);
+    // replacing what was there
+    removeEntry(fileName);
+    addEntry(fileName, size);
+    reserve(0);
+}
+
+void BoundedFileCache::remove(const QString& fileName) {
+    QMutexLocker locker(&_mutex);
+    QFile::remove(_directory + "/" + fileName);
+    removeEntry(fileName);
+}
+
+void BoundedFileCache::addEntry(const QString& fileName, qint64 size) {
+    Entry entry = { size, ++_lastLRUKey };
+    _entries.insert(fileName, entry);
+    _lru.insert(entry.lruKey, fileName);
+    _size += size;
+}
+
+void BoundedFileCache::removeEntry(const QString& fileName) {
+    QHash<QString, Entry>::iterator it = _entries.find(fileName);
+    if (it == _entries.end()) {
+        return;
+    }
+    _lru.remove(it->lruKey);
+    _size -= it->size;
+    _entries.erase(it);
+}
+
+void BoundedFileCache::reserve(qint64 size) {
+    // the most recently used file stays even if it is too big on its own, whoever just wrote it is about to use it
+    while (_lru.size() > 1 && _size + size > _maximumSize) {
+        QString fileName = _lru.begin().value();
+        // on Windows, this fails while the file is still mapped; it is found again on the next run
+        QFile::remove(_directory + "/" + fileName);
+        removeEntry(fileName);
+    }
+}
@@ -0,0 +1,76 @@
+//
+//  BoundedFileCache.h
+//  libraries/shared/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Keeps a directory of cached files under a maximum total size by evicting the least recently used ones.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BoundedFileCache_h
+#define hifi_BoundedFileCache_h
+
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+
+/// The files with one suffix in a directory, in the order they were last used, for caches that keep one file per
+/// entry. Every user of a directory in the process shares one, so that they all count against the same maximum size.
+/// The files found on disk when it is created are ordered by when they were last written, so the order of use carries
+/// over (approximately) from one run to the next; files that other processes write meanwhile are picked up next run.
+class BoundedFileCache {
+public:
+
+    /// Returns the cache of the directory's files with the suffix, creating it with the maximum size if there is none.
+    static QSharedPointer<BoundedFileCache> getCache(const QString& directory, const QString& suffix,
+                                                     qint64 maximumSize);
+
+    BoundedFileCache(const QString& directory, const QString& suffix, qint64 maximumSize);
+
+    const QString& getDirectory() const { return _directory; }
+
+    void setMaximumSize(qint64 maximumSize);
+    qint64 getMaximumSize() const;
+
+    /// Returns the total size of the files.
+    qint64 getSize() const;
+
+    int getFileCount() const;
+
+    /// Notes that the file was just used, so that it is evicted last.
+    void touch(const QString& fileName);
+
+    /// Notes that the file was just written with the given size, evicting others as need be to stay within the maximum.
+    void insert(const QString& fileName, qint64 size);
+
+    /// Removes the file.
+    void remove(const QString& fileName);
+
+private:
+
+    class Entry {
+    public:
+        qint64 size;
+        qint64 lruKey;
+    };
+
+    void addEntry(const QString& fileName, qint64 size);
+    void removeEntry(const QString& fileName);
+    void reserve(qint64 size);
+
+    QString _directory;
+    qint64 _maximumSize;
+
+    mutable QMutex _mutex;
+    QHash<QString, Entry> _entries;
+    QMap<qint64, QString> _lru;
+    qint64 _lastLRUKey = 0;
+    qint64 _size = 0;
+};
+
+#endif // hifi_BoundedFileCache_h
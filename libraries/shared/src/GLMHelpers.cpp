@@ -9,6 +9,11 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define GLM_HELPERS_SSE 1
+#include <xmmintrin.h>
+#endif
+
 #include "GLMHelpers.h"
 
 #include "NumericalConstants.h"
@@ -222,6 +227,56 @@ void setTranslation(glm::mat4& matrix, const glm::vec3& translation) {
     matrix[3][2] = translation.z;
 }
 
+void multiplyMatrices(const glm::mat4& left, const glm::mat4& right, glm::mat4& result) {
+#ifdef GLM_HELPERS_SSE
+    const float* leftValues = &left[0][0];
+    const float* rightValues = &right[0][0];
+    float* resultValues = &result[0][0];
+    __m128 left0 = _mm_loadu_ps(leftValues);
+    __m128 left1 = _mm_loadu_ps(leftValues + 4);
+    __m128 left2 = _mm_loadu_ps(leftValues + 8);
+    __m128 left3 = _mm_loadu_ps(leftValues + 12);
+    for (int i = 0; i < 4; i++) {
+        // each column of the result is the left columns weighted by the elements of the right column
+        const float* column = rightValues + i * 4;
+        __m128 sum = _mm_mul_ps(left0, _mm_set1_ps(column[0]));
+        sum = _mm_add_ps(sum, _mm_mul_ps(left1, _mm_set1_ps(column[1])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(left2, _mm_set1_ps(column[2])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(left3, _mm_set1_ps(column[3])));
+        _mm_storeu_ps(resultValues + i * 4, sum);
+    }
+#else
+    result = left * right;
+#endif
+}
+
+void addScaledOffsets(glm::vec3* destination, int destinationSize, const int* indices, const glm::vec3* offsets,
+        int count, float scale) {
+    int i = 0;
+#ifdef GLM_HELPERS_SSE
+    // the 16 byte loads and stores take in the x of the vector after each one, which is zeroed in the offset and
+    // written back unchanged to the destination; the last offset and the last destination vector are done below
+    const float* offsetValues = &offsets[0].x;
+    float* destinationValues = &destination[0].x;
+    __m128 zero = _mm_setzero_ps();
+    __m128 scales = _mm_set1_ps(scale);
+    for (; i < count - 1; i++) {
+        int index = indices[i];
+        if (index == destinationSize - 1) {
+            destination[index] += offsets[i] * scale;
+            continue;
+        }
+        __m128 offset = _mm_loadu_ps(offsetValues + i * 3);
+        offset = _mm_movelh_ps(offset, _mm_unpackhi_ps(offset, zero)); // x, y, z, 0
+        float* values = destinationValues + index * 3;
+        _mm_storeu_ps(values, _mm_add_ps(_mm_loadu_ps(values), _mm_mul_ps(offset, scales)));
+    }
+#endif
+    for (; i < count; i++) {
+        destination[indices[i]] += offsets[i] * scale;
+    }
+}
+
 glm::quat extractRotation(const glm::mat4& matrix, bool assumeOrthogonal) {
     // uses the iterative polar decomposition algorithm described by Ken Shoemake at
     // http://www.cs.wisc.edu/graphics/Courses/838-s2002/Papers/polar-decomp.pdf
@@ -88,6 +88,15 @@ glm::vec3 extractTranslation(const glm::mat4& matrix);
 
 void setTranslation(glm::mat4& matrix, const glm::vec3& translation);
 
+/// Sets result to left * right (either of which it may be), a column at a time with SSE where it's available. The sums
+/// are taken in the same order as glm's.
+void multiplyMatrices(const glm::mat4& left, const glm::mat4& right, glm::mat4& result);
+
+/// Adds offsets[i] * scale to destination[indices[i]] for each of the count offsets, with SSE where it's available.
+/// The indices must be less than destinationSize and may repeat.
+void addScaledOffsets(glm::vec3* destination, int destinationSize, const int* indices, const glm::vec3* offsets,
+    int count, float scale);
+
 glm::quat extractRotation(const glm::mat4& matrix, bool assumeOrthogonal = false);
 
 glm::vec3 extractScale(const glm::mat4& matrix);
@@ -59,18 +59,29 @@ void vec4FromScriptValue(const QScriptValue& object, glm::vec4& vec4) {
     vec4.w = object.property("w").toVariant().toFloat();
 }
 
+// vectors and quaternions cross into and out of scripts all the time, so their conversions keep the property names
+// around instead of building them from literals, and only go through a QVariant for components that are not numbers
+static const QString X_PROPERTY_NAME = "x";
+static const QString Y_PROPERTY_NAME = "y";
+static const QString Z_PROPERTY_NAME = "z";
+static const QString W_PROPERTY_NAME = "w";
+
+static float componentFromScriptValue(const QScriptValue& component) {
+    return component.isNumber() ? (float)component.toNumber() : component.toVariant().toFloat();
+}
+
 QScriptValue vec3toScriptValue(QScriptEngine* engine, const glm::vec3 &vec3) {
     QScriptValue obj = engine->newObject();
-    obj.setProperty("x", vec3.x);
-    obj.setProperty("y", vec3.y);
-    obj.setProperty("z", vec3.z);
+    obj.setProperty(X_PROPERTY_NAME, vec3.x);
+    obj.setProperty(Y_PROPERTY_NAME, vec3.y);
+    obj.setProperty(Z_PROPERTY_NAME, vec3.z);
     return obj;
 }
 
 void vec3FromScriptValue(const QScriptValue &object, glm::vec3 &vec3) {
-    vec3.x = object.property("x").toVariant().toFloat();
-    vec3.y = object.property("y").toVariant().toFloat();
-    vec3.z = object.property("z").toVariant().toFloat();
+    vec3.x = componentFromScriptValue(object.property(X_PROPERTY_NAME));
+    vec3.y = componentFromScriptValue(object.property(Y_PROPERTY_NAME));
+    vec3.z = componentFromScriptValue(object.property(Z_PROPERTY_NAME));
 }
 
 QScriptValue qVectorVec3ToScriptValue(QScriptEngine* engine, const QVector<glm::vec3>& vector){
@@ -107,18 +118,18 @@ void vec2FromScriptValue(const QScriptValue &object, glm::vec2 &vec2) {
 
 QScriptValue quatToScriptValue(QScriptEngine* engine, const glm::quat& quat) {
     QScriptValue obj = engine->newObject();
-    obj.setProperty("x", quat.x);
-    obj.setProperty("y", quat.y);
-    obj.setProperty("z", quat.z);
-    obj.setProperty("w", quat.w);
+    obj.setProperty(X_PROPERTY_NAME, quat.x);
+    obj.setProperty(Y_PROPERTY_NAME, quat.y);
+    obj.setProperty(Z_PROPERTY_NAME, quat.z);
+    obj.setProperty(W_PROPERTY_NAME, quat.w);
     return obj;
 }
 
 void quatFromScriptValue(const QScriptValue &object, glm::quat& quat) {
-    quat.x = object.property("x").toVariant().toFloat();
-    quat.y = object.property("y").toVariant().toFloat();
-    quat.z = object.property("z").toVariant().toFloat();
-    quat.w = object.property("w").toVariant().toFloat();
+    quat.x = componentFromScriptValue(object.property(X_PROPERTY_NAME));
+    quat.y = componentFromScriptValue(object.property(Y_PROPERTY_NAME));
+    quat.z = componentFromScriptValue(object.property(Z_PROPERTY_NAME));
+    quat.w = componentFromScriptValue(object.property(W_PROPERTY_NAME));
 }
 
 QScriptValue qRectToScriptValue(QScriptEngine* engine, const QRect& rect) {
@@ -0,0 +1,105 @@
+//
+//  TimerQueue.cpp
+//  libraries/shared/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+#include "TimerQueue.h"
+
+TimerQueue::TimerQueue() :
+    _numStaleEntries(0),
+    _nextTimerID(1),
+    _nextSequence(0)
+{
+}
+
+TimerQueue::TimerID TimerQueue::addTimer(qint64 now, int intervalMSecs, bool isSingleShot) {
+    TimerID timerID = _nextTimerID;
+    // skip 0 and any ID still in use once we wrap around
+    do {
+        _nextTimerID = (_nextTimerID == std::numeric_limits<TimerID>::max()) ? 1 : _nextTimerID + 1;
+    } while (_timers.contains(_nextTimerID));
+
+    Timer& timer = _timers[timerID];
+    timer.intervalMSecs = std::max(intervalMSecs, 0);
+    timer.isSingleShot = isSingleShot;
+
+    pushEntry(now + timer.intervalMSecs, timerID);
+    return timerID;
+}
+
+bool TimerQueue::removeTimer(TimerID timerID) {
+    if (!_timers.remove(timerID)) {
+        return false;
+    }
+    // its heap entry goes stale, once most of the heap is stale we rebuild it rather than let it grow
+    ++_numStaleEntries;
+    if (_numStaleEntries > (int)_heap.size() / 2) {
+        _heap.erase(std::remove_if(_heap.begin(), _heap.end(), [this](const HeapEntry& entry) {
+            return !_timers.contains(entry.timerID);
+        }), _heap.end());
+        std::make_heap(_heap.begin(), _heap.end(), std::greater<HeapEntry>());
+        _numStaleEntries = 0;
+    }
+    return true;
+}
+
+void TimerQueue::takeDueTimers(qint64 now, std::vector<TimerID>& dueTimers) {
+    size_t firstDue = dueTimers.size();
+
+    popStaleEntries();
+    while (!_heap.empty() && _heap.front().dueTime <= now) {
+        std::pop_heap(_heap.begin(), _heap.end(), std::greater<HeapEntry>());
+        dueTimers.push_back(_heap.back().timerID);
+        _heap.pop_back();
+        popStaleEntries();
+    }
+
+    // reschedule after taking everything due, so a zero interval cannot come due twice in one call
+    for (size_t i = firstDue; i < dueTimers.size(); i++) {
+        TimerID timerID = dueTimers[i];
+        const Timer& timer = _timers[timerID];
+        if (timer.isSingleShot) {
+            _timers.remove(timerID);
+        } else {
+            // an interval that fell behind does not try to catch up
+            pushEntry(now + timer.intervalMSecs, timerID);
+        }
+    }
+}
+
+qint64 TimerQueue::getNextDueTime() {
+    popStaleEntries();
+    return _heap.front().dueTime;
+}
+
+void TimerQueue::clear() {
+    _timers.clear();
+    _heap.clear();
+    _numStaleEntries = 0;
+}
+
+void TimerQueue::pushEntry(qint64 dueTime, TimerID timerID) {
+    HeapEntry entry;
+    entry.dueTime = dueTime;
+    entry.sequence = _nextSequence++;
+    entry.timerID = timerID;
+    _heap.push_back(entry);
+    std::push_heap(_heap.begin(), _heap.end(), std::greater<HeapEntry>());
+}
+
+void TimerQueue::popStaleEntries() {
+    while (!_heap.empty() && !_timers.contains(_heap.front().timerID)) {
+        std::pop_heap(_heap.begin(), _heap.end(), std::greater<HeapEntry>());
+        _heap.pop_back();
+        --_numStaleEntries;
+    }
+}
@@ -0,0 +1,74 @@
+//
+//  TimerQueue.h
+//  libraries/shared/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Many timeouts and intervals kept in one heap, so they can all be served by a single real timer.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_TimerQueue_h
+#define hifi_TimerQueue_h
+
+#include <vector>
+
+#include <QtCore/QHash>
+
+/// Times are in msecs on whatever clock the owner uses, they only have to go forward. Timers due at the same time come
+/// out in the order they were added.
+class TimerQueue {
+public:
+    typedef int TimerID; // never 0, so 0 can stand for no timer
+
+    TimerQueue();
+
+    /// a single shot timer is removed once it comes due, any other one is rescheduled intervalMSecs later
+    TimerID addTimer(qint64 now, int intervalMSecs, bool isSingleShot);
+
+    /// returns false if the timer is not in the queue, e.g. because it was a single shot timer that already came due
+    bool removeTimer(TimerID timerID);
+    bool hasTimer(TimerID timerID) const { return _timers.contains(timerID); }
+
+    /// Appends the timers due at now to dueTimers, earliest first. An interval that came due is due again no earlier
+    /// than the next call, however short it is.
+    void takeDueTimers(qint64 now, std::vector<TimerID>& dueTimers);
+
+    bool isEmpty() const { return _timers.isEmpty(); }
+    int size() const { return _timers.size(); }
+
+    /// when the earliest timer is due, only valid if the queue is not empty
+    qint64 getNextDueTime();
+
+    void clear();
+
+private:
+    class Timer {
+    public:
+        int intervalMSecs;
+        bool isSingleShot;
+    };
+
+    class HeapEntry {
+    public:
+        qint64 dueTime;
+        quint64 sequence; // keeps timers due at the same time in the order they were scheduled
+        TimerID timerID;
+        bool operator>(const HeapEntry& other) const {
+            return dueTime > other.dueTime || (dueTime == other.dueTime && sequence > other.sequence);
+        }
+    };
+
+    void pushEntry(qint64 dueTime, TimerID timerID);
+    void popStaleEntries();
+
+    QHash<TimerID, Timer> _timers;
+    std::vector<HeapEntry> _heap; // entries of removed timers stay until they reach the top, or until a rebuild
+    int _numStaleEntries;
+    TimerID _nextTimerID;
+    quint64 _nextSequence;
+};
+
+#endif // hifi_TimerQueue_h
@@ -0,0 +1,256 @@
+//
+//  TriangleBVH.cpp
+//  libraries/shared/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <cfloat>
+
+#include <QVarLengthArray>
+
+#include "TriangleBVH.h"
+
+// leaves smaller than this aren't split, and larger ones always are
+static const int MIN_SPLIT_TRIANGLES = 4;
+static const int MAX_LEAF_TRIANGLES = 16;
+
+// candidate splitting planes per axis
+static const int SPLIT_BINS = 16;
+
+// the cost of visiting a node relative to that of testing a triangle
+static const float TRAVERSAL_COST = 1.0f;
+
+static float getSurfaceArea(const glm::vec3& minimum, const glm::vec3& maximum) {
+    glm::vec3 size = maximum - minimum;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+TriangleBVH::TriangleBVH() {
+}
+
+void TriangleBVH::build(const QVector<Triangle>& triangles, const QVector<int>& tags) {
+    _nodes.clear();
+    _triangles.clear();
+    _tags.clear();
+    if (triangles.isEmpty()) {
+        return;
+    }
+    QVector<BuildTriangle> buildTriangles(triangles.size());
+    for (int i = 0; i < triangles.size(); i++) {
+        const Triangle& triangle = triangles.at(i);
+        BuildTriangle& buildTriangle = buildTriangles[i];
+        buildTriangle.minimum = glm::min(glm::min(triangle.v0, triangle.v1), triangle.v2);
+        buildTriangle.maximum = glm::max(glm::max(triangle.v0, triangle.v1), triangle.v2);
+        buildTriangle.centroid = (buildTriangle.minimum + buildTriangle.maximum) * 0.5f;
+        buildTriangle.index = i;
+    }
+    _nodes.reserve(2 * triangles.size() / MIN_SPLIT_TRIANGLES + 1);
+    buildNode(buildTriangles, 0, buildTriangles.size());
+
+    // the leaves refer to ranges of the triangles in the order they were partitioned into
+    _triangles.resize(triangles.size());
+    _tags.resize(triangles.size());
+    for (int i = 0; i < buildTriangles.size(); i++) {
+        int index = buildTriangles.at(i).index;
+        _triangles[i] = triangles.at(index);
+        _tags[i] = (index < tags.size()) ? tags.at(index) : 0;
+    }
+}
+
+int TriangleBVH::buildNode(QVector<BuildTriangle>& buildTriangles, int begin, int end) {
+    int nodeIndex = _nodes.size();
+    _nodes.append(Node());
+
+    glm::vec3 minimum(FLT_MAX), maximum(-FLT_MAX);
+    glm::vec3 centroidMinimum(FLT_MAX), centroidMaximum(-FLT_MAX);
+    for (int i = begin; i < end; i++) {
+        const BuildTriangle& buildTriangle = buildTriangles.at(i);
+        minimum = glm::min(minimum, buildTriangle.minimum);
+        maximum = glm::max(maximum, buildTriangle.maximum);
+        centroidMinimum = glm::min(centroidMinimum, buildTriangle.centroid);
+        centroidMaximum = glm::max(centroidMaximum, buildTriangle.centroid);
+    }
+    _nodes[nodeIndex].minimum = minimum;
+    _nodes[nodeIndex].maximum = maximum;
+
+    int count = end - begin;
+    if (count < MIN_SPLIT_TRIANGLES) {
+        _nodes[nodeIndex].index = begin;
+        _nodes[nodeIndex].triangleCount = count;
+        return nodeIndex;
+    }
+
+    // find the cheapest of the binned splitting planes along each axis
+    int bestAxis = -1;
+    int bestBin = 0;
+    float bestCost = FLT_MAX;
+    glm::vec3 centroidExtent = centroidMaximum - centroidMinimum;
+    for (int axis = 0; axis < 3; axis++) {
+        if (centroidExtent[axis] <= 0.0f) {
+            continue;
+        }
+        int binCounts[SPLIT_BINS] = { 0 };
+        glm::vec3 binMinimums[SPLIT_BINS];
+        glm::vec3 binMaximums[SPLIT_BINS];
+        for (int bin = 0; bin < SPLIT_BINS; bin++) {
+            binMinimums[bin] = glm::vec3(FLT_MAX);
+            binMaximums[bin] = glm::vec3(-FLT_MAX);
+        }
+        float binScale = SPLIT_BINS / centroidExtent[axis];
+        for (int i = begin; i < end; i++) {
+            const BuildTriangle& buildTriangle = buildTriangles.at(i);
+            int bin = std::min((int)((buildTriangle.centroid[axis] - centroidMinimum[axis]) * binScale), SPLIT_BINS - 1);
+            binCounts[bin]++;
+            binMinimums[bin] = glm::min(binMinimums[bin], buildTriangle.minimum);
+            binMaximums[bin] = glm::max(binMaximums[bin], buildTriangle.maximum);
+        }
+
+        // sweep from the right to get the area and count above each plane, then from the left to cost them
+        float rightAreas[SPLIT_BINS];
+        int rightCounts[SPLIT_BINS];
+        glm::vec3 rightMinimum(FLT_MAX), rightMaximum(-FLT_MAX);
+        int rightCount = 0;
+        for (int bin = SPLIT_BINS - 1; bin > 0; bin--) {
+            rightMinimum = glm::min(rightMinimum, binMinimums[bin]);
+            rightMaximum = glm::max(rightMaximum, binMaximums[bin]);
+            rightCount += binCounts[bin];
+            rightAreas[bin] = (rightCount > 0) ? getSurfaceArea(rightMinimum, rightMaximum) : 0.0f;
+            rightCounts[bin] = rightCount;
+        }
+        glm::vec3 leftMinimum(FLT_MAX), leftMaximum(-FLT_MAX);
+        int leftCount = 0;
+        for (int bin = 0; bin < SPLIT_BINS - 1; bin++) {
+            leftMinimum = glm::min(leftMinimum, binMinimums[bin]);
+            leftMaximum = glm::max(leftMaximum, binMaximums[bin]);
+            leftCount += binCounts[bin];
+            if (leftCount == 0 || rightCounts[bin + 1] == 0) {
+                continue;
+            }
+            float cost = leftCount * getSurfaceArea(leftMinimum, leftMaximum) +
+                rightCounts[bin + 1] * rightAreas[bin + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = bin;
+            }
+        }
+    }
+
+    // costs are relative to the node's own area, so compare against testing every triangle in it
+    float area = getSurfaceArea(minimum, maximum);
+    float splitCost = (area > 0.0f) ? TRAVERSAL_COST + bestCost / area : TRAVERSAL_COST;
+    if (bestAxis == -1 || (splitCost >= count && count <= MAX_LEAF_TRIANGLES)) {
+        if (bestAxis == -1 && count > MAX_LEAF_TRIANGLES) {
+            // all the centroids coincide, so just halve them
+            int middle = begin + count / 2;
+            buildNode(buildTriangles, begin, middle);
+            int secondChild = buildNode(buildTriangles, middle, end);
+            _nodes[nodeIndex].index = secondChild;
+            _nodes[nodeIndex].triangleCount = 0;
+            return nodeIndex;
+        }
+        _nodes[nodeIndex].index = begin;
+        _nodes[nodeIndex].triangleCount = count;
+        return nodeIndex;
+    }
+
+    float binScale = SPLIT_BINS / centroidExtent[bestAxis];
+    float axisMinimum = centroidMinimum[bestAxis];
+    BuildTriangle* middle = std::partition(buildTriangles.data() + begin, buildTriangles.data() + end,
+        [=](const BuildTriangle& buildTriangle) {
+            return std::min((int)((buildTriangle.centroid[bestAxis] - axisMinimum) * binScale), SPLIT_BINS - 1) <= bestBin;
+        });
+    int middleIndex = middle - buildTriangles.data();
+
+    // the children may grow _nodes, so no reference into it is held across building them
+    buildNode(buildTriangles, begin, middleIndex);
+    int secondChild = buildNode(buildTriangles, middleIndex, end);
+    _nodes[nodeIndex].index = secondChild;
+    _nodes[nodeIndex].triangleCount = 0;
+    return nodeIndex;
+}
+
+static bool findRayBoxEntry(const glm::vec3& minimum, const glm::vec3& maximum, const glm::vec3& origin,
+                            const glm::vec3& inverseDirection, float maximumDistance, float& entry) {
+    glm::vec3 nearPlanes = (minimum - origin) * inverseDirection;
+    glm::vec3 farPlanes = (maximum - origin) * inverseDirection;
+    glm::vec3 entries = glm::min(nearPlanes, farPlanes);
+    glm::vec3 exits = glm::max(nearPlanes, farPlanes);
+    entry = glm::max(glm::max(entries.x, entries.y), glm::max(entries.z, 0.0f));
+    float exit = glm::min(glm::min(exits.x, exits.y), glm::min(exits.z, maximumDistance));
+    return entry <= exit;
+}
+
+bool TriangleBVH::findRayIntersection(const glm::vec3& origin, const glm::vec3& direction, float& distance,
+                                      int& tag) const {
+    if (_nodes.isEmpty()) {
+        return false;
+    }
+    // a huge inverse rather than an infinite one, so that a ray lying in a box's plane doesn't make a NaN
+    glm::vec3 inverseDirection;
+    for (int i = 0; i < 3; i++) {
+        inverseDirection[i] = (direction[i] == 0.0f) ? FLT_MAX : 1.0f / direction[i];
+    }
+
+    float bestDistance = FLT_MAX;
+    int bestTriangle = -1;
+    float entry;
+    if (!findRayBoxEntry(_nodes.at(0).minimum, _nodes.at(0).maximum, origin, inverseDirection, bestDistance, entry)) {
+        return false;
+    }
+    const Node* nodes = _nodes.constData();
+    const Triangle* triangles = _triangles.constData();
+    const int DEFAULT_STACK_SIZE = 64;
+    QVarLengthArray<int, DEFAULT_STACK_SIZE> stack;
+    stack.append(0);
+    while (!stack.isEmpty()) {
+        const Node& node = nodes[stack.last()];
+        int nodeIndex = stack.last();
+        stack.removeLast();
+
+        if (node.triangleCount > 0) {
+            for (int i = node.index, end = node.index + node.triangleCount; i < end; i++) {
+                float triangleDistance;
+                if (findRayTriangleIntersection(origin, direction, triangles[i], triangleDistance) &&
+                        triangleDistance < bestDistance) {
+                    bestDistance = triangleDistance;
+                    bestTriangle = i;
+                }
+            }
+            continue;
+        }
+        // visit the nearer child first, and skip any that start beyond what we've already hit
+        int firstChild = nodeIndex + 1;
+        int secondChild = node.index;
+        float firstEntry, secondEntry;
+        bool hitFirst = findRayBoxEntry(nodes[firstChild].minimum, nodes[firstChild].maximum, origin,
+            inverseDirection, bestDistance, firstEntry);
+        bool hitSecond = findRayBoxEntry(nodes[secondChild].minimum, nodes[secondChild].maximum, origin,
+            inverseDirection, bestDistance, secondEntry);
+        if (hitFirst && hitSecond) {
+            if (firstEntry < secondEntry) {
+                stack.append(secondChild);
+                stack.append(firstChild);
+            } else {
+                stack.append(firstChild);
+                stack.append(secondChild);
+            }
+        } else if (hitFirst) {
+            stack.append(firstChild);
+
+        } else if (hitSecond) {
+            stack.append(secondChild);
+        }
+    }
+    if (bestTriangle == -1) {
+        return false;
+    }
+    distance = bestDistance;
+    tag = _tags.at(bestTriangle);
+    return true;
+}
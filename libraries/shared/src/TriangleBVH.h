@@ -0,0 +1,63 @@
+//
+//  TriangleBVH.h
+//  libraries/shared/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  A bounding volume hierarchy over a fixed set of triangles, for ray picking.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_TriangleBVH_h
+#define hifi_TriangleBVH_h
+
+#include <glm/glm.hpp>
+
+#include <QVector>
+
+#include "GeometryUtil.h"
+
+/// Built top down using the surface area heuristic and stored depth first in one array, so that a node's first child
+/// always follows it. Immutable once built, so one can be searched from any number of threads.
+class TriangleBVH {
+public:
+
+    TriangleBVH();
+
+    /// Builds the hierarchy over the triangles, each of which may be tagged, e.g. with the index of its mesh.
+    void build(const QVector<Triangle>& triangles, const QVector<int>& tags = QVector<int>());
+
+    /// Finds the nearest triangle the ray hits, with findRayTriangleIntersection's rules, and the tag it was built with.
+    bool findRayIntersection(const glm::vec3& origin, const glm::vec3& direction, float& distance, int& tag) const;
+
+    int getTriangleCount() const { return _triangles.size(); }
+    int getNodeCount() const { return _nodes.size(); }
+
+private:
+
+    class Node {
+    public:
+        glm::vec3 minimum;
+        int index; // a leaf's first triangle, or an interior node's second child
+        glm::vec3 maximum;
+        int triangleCount; // zero for interior nodes
+    };
+
+    class BuildTriangle {
+    public:
+        glm::vec3 minimum;
+        glm::vec3 maximum;
+        glm::vec3 centroid;
+        int index;
+    };
+
+    int buildNode(QVector<BuildTriangle>& buildTriangles, int begin, int end);
+
+    QVector<Node> _nodes;
+    QVector<Triangle> _triangles;
+    QVector<int> _tags;
+};
+
+#endif // hifi_TriangleBVH_h
@@ -0,0 +1,328 @@
+//
+//  RecordingTests.cpp
+//  tests/avatars/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include <QDebug>
+#include <QTemporaryDir>
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <Recording.h>
+#include <RecordingStream.h>
+
+#include "RecordingTests.h"
+
+// recorders are the only ones allowed to fill in frames and recordings
+class TestRecordingFrame : public RecordingFrame {
+public:
+    using RecordingFrame::setBlendshapeCoefficients;
+    using RecordingFrame::setJointRotations;
+    using RecordingFrame::setTranslation;
+    using RecordingFrame::setRotation;
+    using RecordingFrame::setScale;
+    using RecordingFrame::setHeadRotation;
+    using RecordingFrame::setLeanSideways;
+    using RecordingFrame::setLeanForward;
+    using RecordingFrame::setLookAtPosition;
+};
+
+class TestRecording : public Recording {
+public:
+    using Recording::addFrame;
+    using Recording::addAudioPacket;
+};
+
+void RecordingTests::runAllTests() {
+    codecRoundTripTests();
+    chunkTableTests();
+    fileFormatTests();
+}
+
+static void reportTest(int& testsTaken, int& testsPassed, bool passed, const char* testName) {
+    testsTaken++;
+    if (passed) {
+        testsPassed++;
+    } else {
+        qDebug() << "FAILED - Test" << testsTaken << ":" << testName;
+    }
+}
+
+const int NUM_BLENDSHAPES = 5;
+const int NUM_JOINTS = 7;
+
+// values move a little every frame like a real recording, the scale and lean forward never change
+static RecordingFrame makeFrame(int index) {
+    TestRecordingFrame frame;
+    QVector<float> blendshapes;
+    for (int i = 0; i < NUM_BLENDSHAPES; i++) {
+        blendshapes << 0.5f + 0.5f * sinf(index * 0.05f + i);
+    }
+    frame.setBlendshapeCoefficients(blendshapes);
+    QVector<glm::quat> jointRotations;
+    for (int i = 0; i < NUM_JOINTS; i++) {
+        jointRotations << glm::angleAxis(index * 0.01f + i, glm::normalize(glm::vec3(1.0f, (float)i, 2.0f)));
+    }
+    frame.setJointRotations(jointRotations);
+    frame.setTranslation(glm::vec3(index * 0.01f, 1.0f, index * -0.02f));
+    frame.setRotation(glm::angleAxis(index * 0.02f, glm::vec3(0.0f, 1.0f, 0.0f)));
+    frame.setScale(1.0f);
+    frame.setHeadRotation(glm::angleAxis(sinf(index * 0.1f), glm::vec3(1.0f, 0.0f, 0.0f)));
+    frame.setLeanSideways(0.2f * sinf(index * 0.1f));
+    frame.setLeanForward(0.0f);
+    frame.setLookAtPosition(glm::vec3(0.0f, 1.5f, 2.0f + index * 0.001f));
+    return frame;
+}
+
+static bool rotationsMatch(const glm::quat& first, const glm::quat& second) {
+    const float MIN_DOT = 0.9999f;
+    return fabsf(glm::dot(first, second)) > MIN_DOT;
+}
+
+static bool vectorsMatch(const glm::vec3& first, const glm::vec3& second) {
+    const float POSITION_TOLERANCE = 0.001f; // the codec keeps millimeters
+    return glm::length(first - second) < POSITION_TOLERANCE;
+}
+
+// equal up to what the codec quantizes away
+static bool framesMatch(const RecordingFrame& first, const RecordingFrame& second) {
+    const float TOLERANCE = 0.001f;
+    QVector<float> firstBlendshapes = first.getBlendshapeCoefficients();
+    QVector<float> secondBlendshapes = second.getBlendshapeCoefficients();
+    QVector<glm::quat> firstJoints = first.getJointRotations();
+    QVector<glm::quat> secondJoints = second.getJointRotations();
+    if (firstBlendshapes.size() != secondBlendshapes.size() || firstJoints.size() != secondJoints.size()) {
+        return false;
+    }
+    for (int i = 0; i < firstBlendshapes.size(); i++) {
+        if (fabsf(firstBlendshapes[i] - secondBlendshapes[i]) > TOLERANCE) {
+            return false;
+        }
+    }
+    for (int i = 0; i < firstJoints.size(); i++) {
+        if (!rotationsMatch(firstJoints[i], secondJoints[i])) {
+            return false;
+        }
+    }
+    return vectorsMatch(first.getTranslation(), second.getTranslation())
+        && rotationsMatch(first.getRotation(), second.getRotation())
+        && fabsf(first.getScale() - second.getScale()) < TOLERANCE
+        && rotationsMatch(first.getHeadRotation(), second.getHeadRotation())
+        && fabsf(first.getLeanSideways() - second.getLeanSideways()) < TOLERANCE
+        && fabsf(first.getLeanForward() - second.getLeanForward()) < TOLERANCE
+        && vectorsMatch(first.getLookAtPosition(), second.getLookAtPosition());
+}
+
+void RecordingTests::codecRoundTripTests() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "RecordingTests::codecRoundTripTests()";
+
+    int testsTaken = 0;
+    int testsPassed = 0;
+
+    RecordingFrameCodec codec(NUM_BLENDSHAPES, NUM_JOINTS);
+    QVector<RecordingFrame> frames;
+    for (int i = 0; i < RecordingFrameCodec::FRAMES_PER_CHUNK; i++) {
+        frames << makeFrame(i);
+    }
+    QByteArray chunk = codec.encodeChunk(frames);
+
+    {
+        QVector<RecordingFrame> decodedFrames;
+        bool passed = codec.decodeChunk(chunk, frames.size(), decodedFrames) && decodedFrames.size() == frames.size();
+        for (int i = 0; passed && i < frames.size(); i++) {
+            passed = framesMatch(frames[i], decodedFrames[i]);
+        }
+        reportTest(testsTaken, testsPassed, passed, "a chunk decodes to the frames it was encoded from");
+    }
+
+    {
+        QVector<RecordingFrame> decodedFrames;
+        bool passed = codec.decodeChunk(codec.encodeChunk(frames.mid(0, 1)), 1, decodedFrames)
+            && decodedFrames.size() == 1 && framesMatch(frames[0], decodedFrames[0]);
+        reportTest(testsTaken, testsPassed, passed, "a chunk of a single frame decodes");
+    }
+
+    {
+        QVector<RecordingFrame> decodedFrames;
+        bool passed = !codec.decodeChunk(chunk, frames.size() - 1, decodedFrames)
+            && !codec.decodeChunk(chunk, frames.size() + 1, decodedFrames)
+            && !codec.decodeChunk(chunk, -1, decodedFrames);
+        reportTest(testsTaken, testsPassed, passed, "a chunk doesn't decode to any other number of frames");
+    }
+
+    {
+        QVector<RecordingFrame> decodedFrames;
+        bool passed = !codec.decodeChunk(chunk.left(chunk.size() - 1), frames.size(), decodedFrames)
+            && !codec.decodeChunk(chunk.left(chunk.size() / 2), frames.size(), decodedFrames);
+        reportTest(testsTaken, testsPassed, passed, "a truncated chunk doesn't decode");
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
+
+static StreamedRecordingFrames::ChunkInfo makeChunk(int firstFrame, int numFrames, quint32 offset, quint32 length) {
+    StreamedRecordingFrames::ChunkInfo chunk;
+    chunk.firstFrame = firstFrame;
+    chunk.numFrames = numFrames;
+    chunk.offset = offset;
+    chunk.length = length;
+    chunk.crc16 = 0;
+    return chunk;
+}
+
+void RecordingTests::chunkTableTests() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "RecordingTests::chunkTableTests()";
+
+    int testsTaken = 0;
+    int testsPassed = 0;
+
+    const int CHUNK = RecordingFrameCodec::FRAMES_PER_CHUNK;
+    const int NUM_FRAMES = 2 * CHUNK + 10;
+    const qint64 FRAME_DATA_SIZE = 300;
+
+    QVector<StreamedRecordingFrames::ChunkInfo> chunks;
+    chunks << makeChunk(0, CHUNK, 0, 100) << makeChunk(CHUNK, CHUNK, 100, 100) << makeChunk(2 * CHUNK, 10, 200, 100);
+
+    reportTest(testsTaken, testsPassed, StreamedRecordingFrames::areChunksValid(chunks, NUM_FRAMES, FRAME_DATA_SIZE),
+               "chunks covering every frame within the frame data are valid");
+    reportTest(testsTaken, testsPassed,
+               StreamedRecordingFrames::areChunksValid(QVector<StreamedRecordingFrames::ChunkInfo>(), 0, 0),
+               "no chunks for no frames are valid");
+
+    {
+        QVector<StreamedRecordingFrames::ChunkInfo> unsorted = chunks;
+        std::swap(unsorted[0], unsorted[1]);
+        reportTest(testsTaken, testsPassed,
+                   !StreamedRecordingFrames::areChunksValid(unsorted, NUM_FRAMES, FRAME_DATA_SIZE),
+                   "chunks out of order are rejected");
+    }
+
+    {
+        QVector<StreamedRecordingFrames::ChunkInfo> gap = chunks;
+        gap[1].firstFrame++;
+        gap[1].numFrames--;
+        reportTest(testsTaken, testsPassed, !StreamedRecordingFrames::areChunksValid(gap, NUM_FRAMES, FRAME_DATA_SIZE),
+                   "chunks with a gap between them are rejected");
+    }
+
+    {
+        QVector<StreamedRecordingFrames::ChunkInfo> overlap = chunks;
+        overlap[1].firstFrame--;
+        overlap[1].numFrames++;
+        reportTest(testsTaken, testsPassed,
+                   !StreamedRecordingFrames::areChunksValid(overlap, NUM_FRAMES, FRAME_DATA_SIZE),
+                   "overlapping chunks are rejected");
+    }
+
+    reportTest(testsTaken, testsPassed,
+               !StreamedRecordingFrames::areChunksValid(chunks, NUM_FRAMES + 1, FRAME_DATA_SIZE),
+               "chunks that miss the last frames are rejected");
+    reportTest(testsTaken, testsPassed,
+               !StreamedRecordingFrames::areChunksValid(chunks, NUM_FRAMES - 1, FRAME_DATA_SIZE),
+               "chunks past the last frame are rejected");
+
+    {
+        QVector<StreamedRecordingFrames::ChunkInfo> negative = chunks;
+        negative[2].numFrames = -10;
+        QVector<StreamedRecordingFrames::ChunkInfo> huge = chunks;
+        huge[2].numFrames = 0x7fffffff;
+        bool passed = !StreamedRecordingFrames::areChunksValid(negative, NUM_FRAMES, FRAME_DATA_SIZE)
+            && !StreamedRecordingFrames::areChunksValid(huge, 0x7fffffff, FRAME_DATA_SIZE);
+        reportTest(testsTaken, testsPassed, passed, "negative and huge frame counts are rejected");
+    }
+
+    {
+        QVector<StreamedRecordingFrames::ChunkInfo> outside = chunks;
+        outside[2].length = 101;
+        QVector<StreamedRecordingFrames::ChunkInfo> wrapping = chunks;
+        wrapping[2].offset = 0xffffffff;
+        bool passed = !StreamedRecordingFrames::areChunksValid(outside, NUM_FRAMES, FRAME_DATA_SIZE)
+            && !StreamedRecordingFrames::areChunksValid(wrapping, NUM_FRAMES, FRAME_DATA_SIZE);
+        reportTest(testsTaken, testsPassed, passed, "chunks reaching past the frame data are rejected");
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
+
+void RecordingTests::fileFormatTests() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "RecordingTests::fileFormatTests()";
+
+    int testsTaken = 0;
+    int testsPassed = 0;
+
+    // a couple of full chunks and a partial one
+    const int NUM_FRAMES = 2 * RecordingFrameCodec::FRAMES_PER_CHUNK + 44;
+    const int FRAME_MSECS = 16;
+    TestRecording* testRecording = new TestRecording();
+    RecordingPointer recording(testRecording);
+    RecordingContext& context = recording->getContext();
+    context.globalTimestamp = 1234567;
+    context.domain = "sandbox";
+    context.position = glm::vec3(1.0f, 2.0f, 3.0f);
+    context.orientation = glm::angleAxis(0.5f, glm::vec3(0.0f, 1.0f, 0.0f));
+    context.scale = 1.5f;
+    context.headModel = "http://example.com/head.fst";
+    context.skeletonModel = "http://example.com/skeleton.fst";
+    context.displayName = "Tester";
+    for (int i = 0; i < NUM_FRAMES; i++) {
+        RecordingFrame frame = makeFrame(i);
+        testRecording->addFrame(i * FRAME_MSECS, frame);
+    }
+    QByteArray audio(4096, 'a');
+    testRecording->addAudioPacket(audio);
+
+    QTemporaryDir directory;
+    QString filename = directory.path() + "/recording.hfr";
+    writeRecordingToFile(recording, filename);
+    RecordingPointer readRecording = readRecordingFromFile(RecordingPointer(), filename);
+
+    bool wasRead = readRecording && readRecording->getFrameNumber() == NUM_FRAMES;
+    reportTest(testsTaken, testsPassed, wasRead, "a written recording reads back with all of its frames");
+    if (!wasRead) {
+        qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+        return;
+    }
+
+    {
+        const RecordingContext& readContext = readRecording->getContext();
+        bool passed = readContext.globalTimestamp == context.globalTimestamp && readContext.domain == context.domain
+            && vectorsMatch(readContext.position, context.position)
+            && rotationsMatch(readContext.orientation, context.orientation)
+            && readContext.scale == context.scale && readContext.headModel == context.headModel
+            && readContext.skeletonModel == context.skeletonModel && readContext.displayName == context.displayName;
+        reportTest(testsTaken, testsPassed, passed, "the context reads back");
+    }
+
+    {
+        bool passed = readRecording->getLength() == (NUM_FRAMES - 1) * FRAME_MSECS
+            && readRecording->getFrameAtTime(10 * FRAME_MSECS + 1) == 10;
+        for (int i = 0; passed && i < NUM_FRAMES; i++) {
+            passed = readRecording->getFrameTimestamp(i) == i * FRAME_MSECS;
+        }
+        reportTest(testsTaken, testsPassed, passed, "the timestamps read back");
+    }
+
+    {
+        // last to first, so that the chunks are decoded out of order
+        bool passed = true;
+        for (int i = NUM_FRAMES - 1; passed && i >= 0; i--) {
+            passed = framesMatch(readRecording->getFrame(i), recording->getFrame(i));
+        }
+        reportTest(testsTaken, testsPassed, passed, "the frames read back");
+    }
+
+    reportTest(testsTaken, testsPassed, readRecording->getAudioData() == audio, "the audio reads back");
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
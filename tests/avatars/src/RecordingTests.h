@@ -0,0 +1,21 @@
+//
+//  RecordingTests.h
+//  tests/avatars/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_RecordingTests_h
+#define hifi_RecordingTests_h
+
+namespace RecordingTests {
+    void codecRoundTripTests();
+    void chunkTableTests();
+    void fileFormatTests();
+    void runAllTests();
+}
+
+#endif // hifi_RecordingTests_h
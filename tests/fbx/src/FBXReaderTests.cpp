@@ -0,0 +1,674 @@
+//
+//  FBXReaderTests.cpp
+//  tests/fbx/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QtEndian>
+
+#ifndef Q_OS_WIN
+#include <sys/resource.h>
+#endif
+
+#include <BakedGeometry.h>
+#include <FBXReader.h>
+#include <SharedUtil.h>
+
+#include "FBXReaderTests.h"
+
+// what FBXReader used before it parsed out of a buffer, to compare against
+namespace LegacyFBXParser {
+
+    template<class T> int streamSize() {
+        return sizeof(T);
+    }
+
+    template<bool> int streamSize() {
+        return 1;
+    }
+
+    template<class T> QVariant readBinaryArray(QDataStream& in, int& position) {
+        quint32 arrayLength;
+        quint32 encoding;
+        quint32 compressedLength;
+
+        in >> arrayLength;
+        in >> encoding;
+        in >> compressedLength;
+        position += sizeof(quint32) * 3;
+
+        QVector<T> values;
+        const unsigned int DEFLATE_ENCODING = 1;
+        if (encoding == DEFLATE_ENCODING) {
+            // preface encoded data with uncompressed length
+            QByteArray compressed(sizeof(quint32) + compressedLength, 0);
+            *((quint32*)compressed.data()) = qToBigEndian<quint32>(arrayLength * sizeof(T));
+            in.readRawData(compressed.data() + sizeof(quint32), compressedLength);
+            position += compressedLength;
+            QByteArray uncompressed = qUncompress(compressed);
+            QDataStream uncompressedIn(uncompressed);
+            uncompressedIn.setByteOrder(QDataStream::LittleEndian);
+            uncompressedIn.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
+            for (quint32 i = 0; i < arrayLength; i++) {
+                T value;
+                uncompressedIn >> value;
+                values.append(value);
+            }
+        } else {
+            for (quint32 i = 0; i < arrayLength; i++) {
+                T value;
+                in >> value;
+                position += streamSize<T>();
+                values.append(value);
+            }
+        }
+        return QVariant::fromValue(values);
+    }
+
+    QVariant parseBinaryFBXProperty(QDataStream& in, int& position) {
+        char ch;
+        in.device()->getChar(&ch);
+        position++;
+        switch (ch) {
+            case 'Y': {
+                qint16 value;
+                in >> value;
+                position += sizeof(qint16);
+                return QVariant::fromValue(value);
+            }
+            case 'C': {
+                bool value;
+                in >> value;
+                position++;
+                return QVariant::fromValue(value);
+            }
+            case 'I': {
+                qint32 value;
+                in >> value;
+                position += sizeof(qint32);
+                return QVariant::fromValue(value);
+            }
+            case 'F': {
+                float value;
+                in >> value;
+                position += sizeof(float);
+                return QVariant::fromValue(value);
+            }
+            case 'D': {
+                double value;
+                in >> value;
+                position += sizeof(double);
+                return QVariant::fromValue(value);
+            }
+            case 'L': {
+                qint64 value;
+                in >> value;
+                position += sizeof(qint64);
+                return QVariant::fromValue(value);
+            }
+            case 'f':
+                return readBinaryArray<float>(in, position);
+
+            case 'd':
+                return readBinaryArray<double>(in, position);
+
+            case 'l':
+                return readBinaryArray<qint64>(in, position);
+
+            case 'i':
+                return readBinaryArray<qint32>(in, position);
+
+            case 'b':
+                return readBinaryArray<bool>(in, position);
+
+            case 'S':
+            case 'R': {
+                quint32 length;
+                in >> length;
+                position += sizeof(quint32) + length;
+                return QVariant::fromValue(in.device()->read(length));
+            }
+            default:
+                throw QString("Unknown property type: ") + ch;
+        }
+    }
+
+    FBXNode parseBinaryFBXNode(QDataStream& in, int& position) {
+        qint32 endOffset;
+        quint32 propertyCount;
+        quint32 propertyListLength;
+        quint8 nameLength;
+
+        in >> endOffset;
+        in >> propertyCount;
+        in >> propertyListLength;
+        in >> nameLength;
+        position += sizeof(quint32) * 3 + sizeof(quint8);
+
+        FBXNode node;
+        const int MIN_VALID_OFFSET = 40;
+        if (endOffset < MIN_VALID_OFFSET || nameLength == 0) {
+            // use a null name to indicate a null node
+            return node;
+        }
+        node.name = in.device()->read(nameLength);
+        position += nameLength;
+
+        for (quint32 i = 0; i < propertyCount; i++) {
+            node.properties.append(parseBinaryFBXProperty(in, position));
+        }
+
+        while (endOffset > position) {
+            FBXNode child = parseBinaryFBXNode(in, position);
+            if (child.name.isNull()) {
+                return node;
+
+            } else {
+                node.children.append(child);
+            }
+        }
+
+        return node;
+    }
+
+    FBXNode parseFBX(QIODevice* device) {
+        QDataStream in(device);
+        in.setByteOrder(QDataStream::LittleEndian);
+        in.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
+
+        const int HEADER_SIZE = 27;
+        in.skipRawData(HEADER_SIZE);
+        int position = HEADER_SIZE;
+
+        FBXNode top;
+        while (device->bytesAvailable()) {
+            FBXNode next = parseBinaryFBXNode(in, position);
+            if (next.name.isNull()) {
+                return top;
+
+            } else {
+                top.children.append(next);
+            }
+        }
+        return top;
+    }
+}
+
+// builds binary FBX documents the way the FBX SDK writes them
+class TestNode {
+public:
+    TestNode(const QByteArray& name) : name(name), propertyCount(0) { }
+
+    template<class T> static void append(QByteArray& data, T value) {
+        T littleEndian = qToLittleEndian(value);
+        data.append(reinterpret_cast<const char*>(&littleEndian), sizeof(T));
+    }
+
+    TestNode& addInt(qint32 value) {
+        properties.append('I');
+        append(properties, value);
+        propertyCount++;
+        return *this;
+    }
+
+    TestNode& addLong(qint64 value) {
+        properties.append('L');
+        append(properties, value);
+        propertyCount++;
+        return *this;
+    }
+
+    TestNode& addString(const QByteArray& value) {
+        properties.append('S');
+        append<quint32>(properties, value.size());
+        properties.append(value);
+        propertyCount++;
+        return *this;
+    }
+
+    template<class T> TestNode& addArray(char type, const QVector<T>& values, bool compress) {
+        QByteArray raw;
+        foreach (T value, values) {
+            append(raw, value);
+        }
+        properties.append(type);
+        append<quint32>(properties, values.size());
+        if (compress) {
+            // the FBX SDK writes zlib streams, which is what qCompress writes after the length it puts in front
+            QByteArray compressed = qCompress(raw).mid(sizeof(quint32));
+            append<quint32>(properties, 1);
+            append<quint32>(properties, compressed.size());
+            properties.append(compressed);
+        } else {
+            append<quint32>(properties, 0);
+            append<quint32>(properties, raw.size());
+            properties.append(raw);
+        }
+        propertyCount++;
+        return *this;
+    }
+
+    TestNode& addChild(const TestNode& child) {
+        children.append(child);
+        return *this;
+    }
+
+    void write(QByteArray& data) const {
+        int start = data.size();
+        append<quint32>(data, 0); // end offset, filled in below
+        append<quint32>(data, propertyCount);
+        append<quint32>(data, properties.size());
+        data.append((char)name.size());
+        data.append(name);
+        data.append(properties);
+        if (!children.isEmpty()) {
+            foreach (const TestNode& child, children) {
+                child.write(data);
+            }
+            writeNullRecord(data);
+        }
+        quint32 endOffset = qToLittleEndian<quint32>(data.size());
+        memcpy(data.data() + start, &endOffset, sizeof(quint32));
+    }
+
+    static void writeNullRecord(QByteArray& data) {
+        const int NULL_RECORD_SIZE = 13;
+        data.append(QByteArray(NULL_RECORD_SIZE, 0));
+    }
+
+    QByteArray name;
+    QByteArray properties;
+    int propertyCount;
+    QList<TestNode> children;
+};
+
+static QByteArray createTestDocument(int numVertices, bool compress) {
+    QVector<double> vertices;
+    QVector<double> normals;
+    QVector<qint32> indices;
+    for (int i = 0; i < numVertices; i++) {
+        vertices << i * 0.25 << -i * 0.5 << 1.0 / (i + 1);
+        normals << 0.0 << 1.0 << 0.0;
+        indices << i;
+    }
+    for (int i = 2; i < indices.size(); i += 3) {
+        indices[i] = -indices[i] - 1; // the last index of each polygon is stored negated
+    }
+    QVector<float> curve;
+    for (int i = 0; i < numVertices; i++) {
+        curve << i * 0.1f;
+    }
+
+    const qint64 GEOMETRY_ID = 1000;
+    const qint64 MODEL_ID = 2000;
+    QList<TestNode> topLevelNodes;
+    topLevelNodes << TestNode("FBXHeaderExtension").addChild(TestNode("FBXHeaderVersion").addInt(1003));
+    topLevelNodes << TestNode("Objects")
+        .addChild(TestNode("Geometry").addLong(GEOMETRY_ID).addString("Geometry::test").addString("Mesh")
+            .addChild(TestNode("Vertices").addArray('d', vertices, compress))
+            .addChild(TestNode("PolygonVertexIndex").addArray('i', indices, compress))
+            .addChild(TestNode("LayerElementNormal").addInt(0)
+                .addChild(TestNode("Normals").addArray('d', normals, compress))))
+        .addChild(TestNode("Model").addLong(MODEL_ID).addString("Model::test").addString("Mesh"));
+    topLevelNodes << TestNode("Connections")
+        .addChild(TestNode("C").addString("OO").addLong(GEOMETRY_ID).addLong(MODEL_ID));
+
+    // readFBX doesn't look at takes, so they should be skipped over
+    topLevelNodes << TestNode("Takes").addChild(TestNode("Take").addString("Take 001")
+        .addChild(TestNode("Curve").addArray('f', curve, compress)));
+
+    QByteArray document("Kaydara FBX Binary  ");
+    document.append('\0');
+    document.append('\x1a');
+    document.append('\0');
+    const quint32 VERSION = 7400;
+    TestNode::append(document, VERSION);
+    foreach (const TestNode& node, topLevelNodes) {
+        node.write(document);
+    }
+    TestNode::writeNullRecord(document);
+    return document;
+}
+
+static const FBXNode* findChild(const FBXNode& node, const QByteArray& name) {
+    foreach (const FBXNode& child, node.children) {
+        if (child.name == name) {
+            return &child;
+        }
+    }
+    return NULL;
+}
+
+static bool sameProperty(const QVariant& a, const QVariant& b) {
+    if (a.userType() != b.userType()) {
+        return false;
+    }
+    if (a.userType() == qMetaTypeId<QVector<double> >()) {
+        return a.value<QVector<double> >() == b.value<QVector<double> >();
+    }
+    if (a.userType() == qMetaTypeId<QVector<float> >()) {
+        return a.value<QVector<float> >() == b.value<QVector<float> >();
+    }
+    if (a.userType() == qMetaTypeId<QVector<qint32> >()) {
+        return a.value<QVector<qint32> >() == b.value<QVector<qint32> >();
+    }
+    if (a.userType() == qMetaTypeId<QVector<qint64> >()) {
+        return a.value<QVector<qint64> >() == b.value<QVector<qint64> >();
+    }
+    if (a.userType() == qMetaTypeId<QVector<bool> >()) {
+        return a.value<QVector<bool> >() == b.value<QVector<bool> >();
+    }
+    return a == b;
+}
+
+static bool sameNodes(const FBXNode& a, const FBXNode& b) {
+    if (a.name != b.name || a.properties.size() != b.properties.size() || a.children.size() != b.children.size()) {
+        return false;
+    }
+    for (int i = 0; i < a.properties.size(); i++) {
+        if (!sameProperty(a.properties.at(i), b.properties.at(i))) {
+            return false;
+        }
+    }
+    for (int i = 0; i < a.children.size(); i++) {
+        if (!sameNodes(a.children.at(i), b.children.at(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static FBXNode parse(const QByteArray& document, bool legacy) {
+    QBuffer buffer(const_cast<QByteArray*>(&document));
+    buffer.open(QIODevice::ReadOnly);
+    return legacy ? LegacyFBXParser::parseFBX(&buffer) : parseFBX(&buffer);
+}
+
+void FBXReaderTests::binaryParserTests() {
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    qDebug() << "FBXReaderTests::binaryParserTests()";
+
+    const int NUM_VERTICES = 999;
+    for (int compress = 0; compress < 2; compress++) {
+        QByteArray document = createTestDocument(NUM_VERTICES, compress);
+        FBXNode top = parse(document, false);
+        FBXNode legacyTop = parse(document, true);
+
+        // the same nodes as before, less the takes
+        testsTaken++;
+        if (!findChild(top, "Takes")) {
+            for (int i = legacyTop.children.size() - 1; i >= 0; i--) {
+                if (legacyTop.children.at(i).name == "Takes") {
+                    legacyTop.children.removeAt(i);
+                }
+            }
+        }
+        if (sameNodes(top, legacyTop) && top.children.size() == 3) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": compressed=" << compress
+                << "parsed nodes differ from the old parser's";
+        }
+
+        testsTaken++;
+        const FBXNode* objects = findChild(top, "Objects");
+        const FBXNode* geometry = objects ? findChild(*objects, "Geometry") : NULL;
+        const FBXNode* vertices = geometry ? findChild(*geometry, "Vertices") : NULL;
+        QVector<double> values = vertices ? vertices->properties.at(0).value<QVector<double> >() : QVector<double>();
+        if (values.size() == NUM_VERTICES * 3 && values.at(3) == 0.25 && values.at(4) == -0.5 &&
+                values.last() == 1.0 / NUM_VERTICES) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": compressed=" << compress << "vertices=" << values.size();
+        }
+
+        testsTaken++;
+        bool threw = false;
+        try {
+            parse(document.left(document.size() / 2), false);
+        } catch (const QString&) {
+            threw = true;
+        }
+        if (threw) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": compressed=" << compress << "truncated document didn't throw";
+        }
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
+
+void FBXReaderTests::bakedGeometryTests() {
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    qDebug() << "FBXReaderTests::bakedGeometryTests()";
+
+    FBXGeometry geometry;
+    geometry.author = "author";
+    geometry.headJointIndex = 0;
+    FBXJoint joint;
+    joint.isFree = false;
+    joint.parentIndex = -1;
+    joint.distanceToParent = 0.0f;
+    joint.boneRadius = 0.25f;
+    joint.name = "Head";
+    joint.rotation = glm::quat(glm::vec3(0.5f, 0.0f, 0.0f));
+    joint.shapeType = 0;
+    joint.isSkeletonJoint = true;
+    geometry.joints << joint;
+    geometry.jointIndices.insert(joint.name, 1);
+
+    model::MaterialPointer material(new model::Material());
+    material->setDiffuse(glm::vec3(0.25f, 0.5f, 1.0f));
+    material->setOpacity(0.5f);
+    FBXMesh mesh;
+    mesh.isEye = false;
+    mesh.meshIndex = 0;
+    for (int i = 0; i < 4; i++) {
+        mesh.vertices << glm::vec3(i, i * 2.0f, -i);
+        mesh.normals << glm::vec3(0.0f, 1.0f, 0.0f);
+        mesh.texCoords << glm::vec2(i * 0.25f, 0.5f);
+    }
+    for (int i = 0; i < 2; i++) {
+        FBXMeshPart part;
+        part.triangleIndices << 0 << 1 << 2 << 0 << 2 << 3;
+        part.lodTriangleIndices << (QVector<int>() << 0 << 1 << 3);
+        part.shininess = 8.0f;
+        part.opacity = 0.5f;
+        part.diffuseTexture.filename = "diffuse.png";
+        part.diffuseTexture.texcoordSet = 0;
+        part._material = material;
+        mesh.parts << part;
+    }
+    mesh.lodErrors << 0.125f;
+    buildModelMesh(mesh);
+    geometry.meshes << mesh;
+    geometry.meshIndicesToModelNames.insert(0, "mesh");
+
+    QByteArray baked = writeBakedGeometry(geometry);
+    FBXGeometry unbaked = readBakedGeometry(baked.constData(), baked.size());
+
+    testsTaken++;
+    bool sameGeometry = unbaked.author == geometry.author && unbaked.headJointIndex == geometry.headJointIndex &&
+        unbaked.joints.size() == 1 && unbaked.joints.at(0).name == joint.name &&
+        unbaked.joints.at(0).rotation == joint.rotation && unbaked.getJointIndex("Head") == 0 &&
+        unbaked.getModelNameOfMesh(0) == "mesh" && unbaked.meshes.size() == 1;
+    if (sameGeometry) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": geometry differs after baking";
+    }
+
+    testsTaken++;
+    const FBXMesh& unbakedMesh = unbaked.meshes.at(0);
+    bool sameMesh = unbakedMesh.vertices == mesh.vertices && unbakedMesh.normals == mesh.normals &&
+        unbakedMesh.texCoords == mesh.texCoords && unbakedMesh.parts.size() == 2 &&
+        unbakedMesh.parts.at(1).triangleIndices == mesh.parts.at(1).triangleIndices &&
+        unbakedMesh.parts.at(1).lodTriangleIndices == mesh.parts.at(1).lodTriangleIndices &&
+        unbakedMesh.lodErrors == mesh.lodErrors &&
+        unbakedMesh.parts.at(1).diffuseTexture.filename == "diffuse.png" &&
+        unbakedMesh._mesh.getNumVertices() == mesh._mesh.getNumVertices() &&
+        unbakedMesh._mesh.getNumIndices() == mesh._mesh.getNumIndices();
+    if (sameMesh) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": mesh differs after baking";
+    }
+
+    // parts that shared a material still do
+    testsTaken++;
+    const model::MaterialPointer& unbakedMaterial = unbakedMesh.parts.at(0)._material;
+    if (unbakedMaterial && unbakedMaterial == unbakedMesh.parts.at(1)._material &&
+            unbakedMaterial->getDiffuse() == material->getDiffuse() &&
+            unbakedMaterial->getOpacity() == material->getOpacity() &&
+            unbakedMaterial->getKey().isTransparent()) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": materials differ after baking";
+    }
+
+    testsTaken++;
+    bool threw = false;
+    try {
+        readBakedGeometry(baked.constData(), baked.size() - 1);
+    } catch (const QString&) {
+        threw = true;
+    }
+    if (threw) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": truncated baked geometry didn't throw";
+    }
+
+    // a file whose indices run past what they index is rejected rather than loaded
+    testsTaken++;
+    FBXGeometry badFaces = geometry;
+    badFaces.meshes[0].parts[1].triangleIndices.last() = mesh.vertices.size();
+    FBXGeometry badCluster = geometry;
+    FBXCluster cluster;
+    cluster.jointIndex = 1;
+    badCluster.meshes[0].clusters << cluster;
+    FBXGeometry badJointName = geometry;
+    badJointName.jointIndices.insert("Neck", 2);
+    int rejected = 0;
+    foreach (const FBXGeometry& badGeometry, QList<FBXGeometry>() << badFaces << badCluster << badJointName) {
+        QByteArray badBaked = writeBakedGeometry(badGeometry);
+        try {
+            readBakedGeometry(badBaked.constData(), badBaked.size());
+        } catch (const QString&) {
+            rejected++;
+        }
+    }
+    if (rejected == 3) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": only" << rejected << "of 3 out of range indices were rejected";
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
+
+// in kilobytes, 0 where we can't tell
+static long getPeakMemoryUsage() {
+#ifndef Q_OS_WIN
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef Q_OS_MAC
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+static void benchmarkDocument(const QString& name, const QByteArray& document) {
+    const int ITERATIONS = 5;
+    const float USECS_PER_MSECS = 1000.0f;
+
+    // the peak only ever grows, so the new parser goes first
+    long peakBefore = getPeakMemoryUsage();
+    quint64 start = usecTimestampNow();
+    for (int i = 0; i < ITERATIONS; i++) {
+        parse(document, false);
+    }
+    quint64 elapsedParsing = usecTimestampNow() - start;
+    long peakParsing = getPeakMemoryUsage();
+
+    start = usecTimestampNow();
+    for (int i = 0; i < ITERATIONS; i++) {
+        parse(document, true);
+    }
+    quint64 elapsedLegacy = usecTimestampNow() - start;
+    long peakLegacy = getPeakMemoryUsage();
+
+    qDebug() << "TIME - parsing" << name << document.size() / 1024 << "KB"
+        << "buffer=" << (float)elapsedParsing / USECS_PER_MSECS / ITERATIONS << "msecs"
+        << "stream=" << (float)elapsedLegacy / USECS_PER_MSECS / ITERATIONS << "msecs";
+    qDebug() << "MEMORY - peak growth parsing" << name
+        << "buffer=" << (peakParsing - peakBefore) << "KB"
+        << "stream=at least" << (peakLegacy - peakParsing) << "KB more";
+}
+
+void FBXReaderTests::parseBenchmark(const QStringList& modelFiles) {
+    qDebug() << "FBXReaderTests::parseBenchmark()";
+
+    const int NUM_VERTICES = 500000;
+    benchmarkDocument("generated", createTestDocument(NUM_VERTICES, true));
+
+    foreach (const QString& modelFile, modelFiles) {
+        QFile file(modelFile);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qDebug() << "Couldn't open" << modelFile;
+            continue;
+        }
+        QByteArray document = file.readAll();
+        try {
+            benchmarkDocument(modelFile, document);
+
+            const float USECS_PER_MSECS = 1000.0f;
+            quint64 start = usecTimestampNow();
+            FBXGeometry geometry = readFBX(document, QVariantHash());
+            qDebug() << "TIME - reading" << modelFile << "meshes=" << geometry.meshes.size()
+                << (float)(usecTimestampNow() - start) / USECS_PER_MSECS << "msecs";
+
+            QByteArray baked = writeBakedGeometry(geometry);
+            start = usecTimestampNow();
+            readBakedGeometry(baked.constData(), baked.size());
+            qDebug() << "TIME - reading baked" << modelFile << baked.size() / 1024 << "KB"
+                << (float)(usecTimestampNow() - start) / USECS_PER_MSECS << "msecs";
+
+        } catch (const QString& error) {
+            qDebug() << "Couldn't parse" << modelFile << error;
+        }
+    }
+}
+
+void FBXReaderTests::runAllTests(const QStringList& modelFiles) {
+    binaryParserTests();
+    bakedGeometryTests();
+    parseBenchmark(modelFiles);
+}
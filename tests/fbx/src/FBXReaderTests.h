@@ -0,0 +1,23 @@
+//
+//  FBXReaderTests.h
+//  tests/fbx/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_FBXReaderTests_h
+#define hifi_FBXReaderTests_h
+
+#include <QStringList>
+
+namespace FBXReaderTests {
+    void binaryParserTests();
+    void bakedGeometryTests();
+    void parseBenchmark(const QStringList& modelFiles);
+    void runAllTests(const QStringList& modelFiles);
+}
+
+#endif // hifi_FBXReaderTests_h
@@ -0,0 +1,23 @@
+//
+//  main.cpp
+//  tests/fbx/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QStringList>
+
+#include "FBXReaderTests.h"
+
+int main(int argc, char** argv) {
+    // any arguments are FBX files to benchmark besides the generated one
+    QStringList modelFiles;
+    for (int i = 1; i < argc; i++) {
+        modelFiles << argv[i];
+    }
+    FBXReaderTests::runAllTests(modelFiles);
+    return 0;
+}
@@ -0,0 +1,536 @@
+//
+//  TextureProcessingTests.cpp
+//  tests/gpu/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <gpu/BakedTexture.h>
+#include <gpu/TextureProcessing.h>
+
+#include "TextureProcessingTests.h"
+
+using namespace gpu;
+
+void TextureProcessingTests::runAllTests() {
+    downsampleTests();
+    resampleTests();
+    compressionTests();
+    bakedTextureTests();
+    processingBenchmark();
+}
+
+static const int RGB_CHANNELS = 3;
+static const int RGBA_CHANNELS = 4;
+
+static TexelImage createNoise(int width, int height, int channels) {
+    TexelImage image(width, height, channels);
+    for (int y = 0; y < height; y++) {
+        Byte* line = image.editScanLine(y);
+        for (int x = 0; x < width * channels; x++) {
+            line[x] = rand() % 256;
+        }
+    }
+    return image;
+}
+
+// smooth enough that block compression should lose little of it
+static TexelImage createGradient(int width, int height, int channels) {
+    TexelImage image(width, height, channels);
+    for (int y = 0; y < height; y++) {
+        Byte* line = image.editScanLine(y);
+        for (int x = 0; x < width; x++) {
+            for (int c = 0; c < channels; c++) {
+                line[x * channels + c] = (Byte)((c % 2 == 0 ? x * 255 / width : y * 255 / height) / (c + 1));
+            }
+        }
+    }
+    return image;
+}
+
+// the simplest possible 2x2 box filter, to check the optimized one against
+static TexelImage downsampleReference(const TexelImage& image) {
+    int width = std::max(image.getWidth() / 2, 1);
+    int height = std::max(image.getHeight() / 2, 1);
+    int channels = image.getChannels();
+    TexelImage mip(width, height, channels);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            for (int c = 0; c < channels; c++) {
+                int sum = 0;
+                for (int i = 0; i < 2; i++) {
+                    const Byte* line = image.getScanLine(std::min(y * 2 + i, image.getHeight() - 1));
+                    for (int j = 0; j < 2; j++) {
+                        sum += line[std::min(x * 2 + j, image.getWidth() - 1) * channels + c];
+                    }
+                }
+                mip.editScanLine(y)[x * channels + c] = (sum + 2) / 4;
+            }
+        }
+    }
+    return mip;
+}
+
+static bool imagesEqual(const TexelImage& first, const TexelImage& second) {
+    return first.getWidth() == second.getWidth() && first.getHeight() == second.getHeight() &&
+        first.getChannels() == second.getChannels() && first.getBytes() == second.getBytes();
+}
+
+void TextureProcessingTests::downsampleTests() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "TextureProcessingTests::downsampleTests()";
+
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    srand(1234);
+
+    // the SSE2 path and the scalar one must agree with each other and with the plain filter, for every size and channel
+    // count, including the odd sizes that leave a row or column out and the ones that leave texels over for the scalar
+    // loop to finish
+    const int SIZES[][2] = { { 64, 64 }, { 37, 18 }, { 6, 1 }, { 1, 9 }, { 2, 2 }, { 1, 1 } };
+    for (auto size : SIZES) {
+        for (int channels = 1; channels <= RGBA_CHANNELS; channels++) {
+            TexelImage image = createNoise(size[0], size[1], channels);
+            TexelImage mip = downsampleImage(image, false);
+
+            testsTaken++;
+            if (imagesEqual(mip, downsampleReference(image))) {
+                testsPassed++;
+            } else {
+                testsFailed++;
+                qDebug() << "FAILED - Test" << testsTaken << ": downsampled" << size[0] << "x" << size[1] << "with"
+                    << channels << "channels";
+            }
+        }
+    }
+
+    // a chain goes down to 1x1, one level per halving of the larger dimension
+    testsTaken++;
+    std::vector<TexelImage> mips = generateMips(createNoise(256, 32, RGBA_CHANNELS), false);
+    if (mips.size() == 8 && mips.back().getWidth() == 1 && mips.back().getHeight() == 1 && mips.at(4).getWidth() == 8 &&
+            mips.at(4).getHeight() == 1) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": mip chain had" << (int)mips.size() << "levels";
+    }
+
+    // black and white average to a mid gray in linear light, which is much lighter than the mean of the sRGB values;
+    // alpha stays linear either way
+    TexelImage checker(2, 2, RGBA_CHANNELS);
+    for (int y = 0; y < 2; y++) {
+        for (int x = 0; x < 2; x++) {
+            Byte value = ((x + y) % 2 == 0) ? 0 : 255;
+            Byte* texel = checker.editScanLine(y) + x * RGBA_CHANNELS;
+            texel[0] = texel[1] = texel[2] = texel[3] = value;
+        }
+    }
+    TexelImage linearMip = downsampleImage(checker, false);
+    TexelImage sRGBMip = downsampleImage(checker, true);
+    const Byte* linear = linearMip.getScanLine(0);
+    const Byte* sRGB = sRGBMip.getScanLine(0);
+
+    testsTaken++;
+    const int LINEAR_GRAY_IN_SRGB = 188;
+    if (linear[0] == 128 && abs(sRGB[0] - LINEAR_GRAY_IN_SRGB) <= 1 && sRGB[3] == 128) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": averaged checker to linear=" << (int)linear[0] << "sRGB="
+            << (int)sRGB[0] << "alpha=" << (int)sRGB[3];
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
+
+void TextureProcessingTests::resampleTests() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "TextureProcessingTests::resampleTests()";
+
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    srand(1234);
+
+    // a whole number ratio of two is the same as the box filter, give or take rounding
+    testsTaken++;
+    TexelImage noise = createNoise(40, 24, RGB_CHANNELS);
+    TexelImage resampled = resampleImage(noise, 20, 12, false);
+    TexelImage downsampled = downsampleImage(noise, false);
+    int maxDifference = 0;
+    for (int y = 0; y < 12; y++) {
+        for (int x = 0; x < 20 * RGB_CHANNELS; x++) {
+            maxDifference = std::max(maxDifference, abs(resampled.getScanLine(y)[x] - downsampled.getScanLine(y)[x]));
+        }
+    }
+    if (maxDifference <= 1) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": halved image differed by" << maxDifference;
+    }
+
+    // any other ratio keeps a flat color flat, and keeps the average of the whole
+    testsTaken++;
+    TexelImage flat(30, 17, RGBA_CHANNELS);
+    for (int y = 0; y < flat.getHeight(); y++) {
+        std::fill(flat.editScanLine(y), flat.editScanLine(y) + flat.getWidth() * RGBA_CHANNELS, 77);
+    }
+    TexelImage flatResampled = resampleImage(flat, 11, 7, true);
+    bool allFlat = true;
+    for (int y = 0; y < flatResampled.getHeight(); y++) {
+        for (int x = 0; x < flatResampled.getWidth() * RGBA_CHANNELS; x++) {
+            allFlat = allFlat && flatResampled.getScanLine(y)[x] == 77;
+        }
+    }
+    if (allFlat && flatResampled.getWidth() == 11 && flatResampled.getHeight() == 7) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": flat image didn't stay flat";
+    }
+
+    testsTaken++;
+    TexelImage gradient = createGradient(300, 200, RGB_CHANNELS);
+    TexelImage gradientResampled = resampleImage(gradient, 123, 77, false);
+    double sum = 0.0, resampledSum = 0.0;
+    for (int y = 0; y < gradient.getHeight(); y++) {
+        for (int x = 0; x < gradient.getWidth(); x++) {
+            sum += gradient.getScanLine(y)[x * RGB_CHANNELS];
+        }
+    }
+    for (int y = 0; y < gradientResampled.getHeight(); y++) {
+        for (int x = 0; x < gradientResampled.getWidth(); x++) {
+            resampledSum += gradientResampled.getScanLine(y)[x * RGB_CHANNELS];
+        }
+    }
+    double mean = sum / (gradient.getWidth() * gradient.getHeight());
+    double resampledMean = resampledSum / (gradientResampled.getWidth() * gradientResampled.getHeight());
+    if (fabs(mean - resampledMean) < 0.5) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": mean changed from" << mean << "to" << resampledMean;
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
+
+static void decodeColor565(int packed, int* color) {
+    int red = (packed >> 11) & 0x1F;
+    int green = (packed >> 5) & 0x3F;
+    int blue = packed & 0x1F;
+    color[0] = (red << 3) | (red >> 2);
+    color[1] = (green << 2) | (green >> 4);
+    color[2] = (blue << 3) | (blue >> 2);
+}
+
+// decodes BC1 or BC3 blocks as the GPU would, back into texels in the image's own channel order
+static TexelImage decompressImage(const std::vector<Byte>& blocks, int width, int height, int channels, bool bgr) {
+    TexelImage image(width, height, channels);
+    const Byte* block = blocks.data();
+    for (int blockY = 0; blockY < height; blockY += 4) {
+        for (int blockX = 0; blockX < width; blockX += 4) {
+            int alphas[8];
+            unsigned long long alphaIndices = 0;
+            if (channels == RGBA_CHANNELS) {
+                alphas[0] = block[0];
+                alphas[1] = block[1];
+                for (int i = 1; i < 7; i++) {
+                    alphas[i + 1] = alphas[0] > alphas[1] ? ((7 - i) * alphas[0] + i * alphas[1]) / 7 :
+                        (i < 5 ? ((5 - i) * alphas[0] + i * alphas[1]) / 5 : (i == 5 ? 0 : 255));
+                }
+                for (int i = 0; i < 6; i++) {
+                    alphaIndices |= (unsigned long long)block[2 + i] << (i * 8);
+                }
+                block += 8;
+            }
+            int color0 = block[0] | (block[1] << 8);
+            int color1 = block[2] | (block[3] << 8);
+            int palette[4][3];
+            decodeColor565(color0, palette[0]);
+            decodeColor565(color1, palette[1]);
+            for (int c = 0; c < 3; c++) {
+                if (color0 > color1 || channels == RGBA_CHANNELS) {
+                    palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                    palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+                } else {
+                    palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                    palette[3][c] = 0;
+                }
+            }
+            unsigned int indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((unsigned int)block[7] << 24);
+            block += 8;
+            for (int i = 0; i < 16; i++) {
+                int x = blockX + i % 4;
+                int y = blockY + i / 4;
+                if (x >= width || y >= height) {
+                    continue;
+                }
+                Byte* texel = image.editScanLine(y) + x * channels;
+                const int* color = palette[(indices >> (i * 2)) & 0x3];
+                texel[bgr ? 2 : 0] = color[0];
+                texel[1] = color[1];
+                texel[bgr ? 0 : 2] = color[2];
+                if (channels == RGBA_CHANNELS) {
+                    texel[3] = alphas[(alphaIndices >> (i * 3)) & 0x7];
+                }
+            }
+        }
+    }
+    return image;
+}
+
+static float getRMSError(const TexelImage& first, const TexelImage& second) {
+    double sum = 0.0;
+    int count = 0;
+    for (int y = 0; y < first.getHeight(); y++) {
+        for (int x = 0; x < first.getWidth() * first.getChannels(); x++) {
+            int difference = first.getScanLine(y)[x] - second.getScanLine(y)[x];
+            sum += difference * difference;
+            count++;
+        }
+    }
+    return (float)sqrt(sum / count);
+}
+
+void TextureProcessingTests::compressionTests() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "TextureProcessingTests::compressionTests()";
+
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    srand(1234);
+
+    // smooth images come back close to what went in, in either channel order
+    const float MAX_GRADIENT_ERROR = 4.0f;
+    for (int channels = RGB_CHANNELS; channels <= RGBA_CHANNELS; channels++) {
+        for (int bgr = 0; bgr < 2; bgr++) {
+            TexelImage gradient = createGradient(64, 32, channels);
+            std::vector<Byte> blocks = compressImage(gradient, bgr);
+            int blockSize = (channels == RGBA_CHANNELS) ? 16 : 8;
+            float error = getRMSError(gradient, decompressImage(blocks, 64, 32, channels, bgr));
+
+            testsTaken++;
+            if ((int)blocks.size() == 16 * 8 * blockSize && error < MAX_GRADIENT_ERROR) {
+                testsPassed++;
+            } else {
+                testsFailed++;
+                qDebug() << "FAILED - Test" << testsTaken << ": channels=" << channels << "bgr=" << bgr << "size="
+                    << (int)blocks.size() << "error=" << error;
+            }
+        }
+    }
+
+    // noise loses a lot, but should still be much closer than a flat gray would be
+    testsTaken++;
+    TexelImage noise = createNoise(32, 32, RGBA_CHANNELS);
+    float noiseError = getRMSError(noise, decompressImage(compressImage(noise, false), 32, 32, RGBA_CHANNELS, false));
+    const float MAX_NOISE_ERROR = 60.0f;
+    if (noiseError < MAX_NOISE_ERROR) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": noise error=" << noiseError;
+    }
+
+    // partial blocks at the bottom of the chain are padded out
+    testsTaken++;
+    TexelImage tiny = createGradient(2, 1, RGBA_CHANNELS);
+    std::vector<Byte> tinyBlocks = compressImage(tiny, false);
+    if (tinyBlocks.size() == 16 && getRMSError(tiny, decompressImage(tinyBlocks, 2, 1, RGBA_CHANNELS, false)) <
+            MAX_GRADIENT_ERROR) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": 2x1 image compressed to" << (int)tinyBlocks.size() << "bytes";
+    }
+
+    // compressed textures get every level, each sized in blocks
+    testsTaken++;
+    std::vector<TexelImage> faces(1, createGradient(64, 16, RGB_CHANNELS));
+    std::unique_ptr<Texture> texture(createMippedTexture(Texture::TEX_2D, faces, Element(VEC3, UINT8, RGB),
+        Element(VEC3, UINT8, RGB), true));
+    if (texture->getTexelFormat().getSemantic() == COMPRESSED_BC1_RGB && texture->maxMip() == 6 &&
+            texture->accessStoredMipFace(0)->_sysmem.getSize() == 16 * 4 * 8 &&
+            texture->accessStoredMipFace(6)->_sysmem.getSize() == 8 && !texture->isAutogenerateMips()) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": compressed texture has" << texture->maxMip() << "mips";
+    }
+
+    // sizes that don't halve into whole blocks aren't compressed
+    testsTaken++;
+    faces[0] = createGradient(60, 16, RGBA_CHANNELS);
+    texture.reset(createMippedTexture(Texture::TEX_2D, faces, Element(VEC4, UINT8, SRGBA), Element(VEC4, UINT8, SBGRA),
+        true));
+    if (texture->getTexelFormat().getSemantic() == SRGBA && texture->maxMip() == 5 && !isCompressible(60, 16) &&
+            isCompressible(64, 4) && !isCompressible(2, 2)) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": uncompressible texture has format"
+            << texture->getTexelFormat().getSemantic();
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
+
+void TextureProcessingTests::bakedTextureTests() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "TextureProcessingTests::bakedTextureTests()";
+
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    srand(1234);
+
+    // every level of every face comes back as it went in, along with the metadata
+    std::vector<TexelImage> faces;
+    for (int i = 0; i < Texture::NUM_CUBE_FACES; i++) {
+        faces.push_back(createNoise(16, 16, RGB_CHANNELS));
+    }
+    std::unique_ptr<Texture> cube(createMippedTexture(Texture::TEX_CUBE, faces, Element(VEC3, UINT8, SRGB),
+        Element(VEC3, UINT8, SRGB), false));
+    QVariantHash metadata;
+    metadata.insert("averageColor", 0x80402010u);
+    metadata.insert("isTransparent", true);
+    QByteArray baked = writeBakedTexture(*cube, metadata);
+
+    testsTaken++;
+    QVariantHash readMetadata;
+    std::unique_ptr<Texture> readCube;
+    try {
+        readCube.reset(readBakedTexture(baked.constData(), baked.size(), Sampler(Sampler::FILTER_MIN_MAG_MIP_LINEAR),
+            readMetadata));
+    } catch (const QString& error) {
+        qDebug() << "Error reading baked texture:" << error;
+    }
+    bool matches = readCube && readCube->getType() == Texture::TEX_CUBE && readCube->getWidth() == 16 &&
+        readCube->getTexelFormat() == cube->getTexelFormat() && readCube->maxMip() == cube->maxMip() &&
+        readCube->getSampler().getFilter() == Sampler::FILTER_MIN_MAG_MIP_LINEAR && readMetadata == metadata;
+    for (int level = 0; matches && level <= cube->maxMip(); level++) {
+        for (int face = 0; matches && face < Texture::NUM_CUBE_FACES; face++) {
+            const Resource::Sysmem& original = cube->accessStoredMipFace(level, face)->_sysmem;
+            const Resource::Sysmem& read = readCube->accessStoredMipFace(level, face)->_sysmem;
+            matches = original.getSize() == read.getSize() &&
+                memcmp(original.readData(), read.readData(), original.getSize()) == 0;
+        }
+    }
+    if (matches) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": baked cube map didn't round trip";
+    }
+
+    // anything short or from another version is refused
+    testsTaken++;
+    int refusals = 0;
+    QByteArray truncated = baked.left(baked.size() / 2);
+    QByteArray otherVersion = baked;
+    const int VERSION_OFFSET = sizeof("HFTEXTURE");
+    otherVersion[VERSION_OFFSET] = otherVersion.at(VERSION_OFFSET) + 1;
+    foreach (const QByteArray& bad, QList<QByteArray>() << truncated << otherVersion << QByteArray("junk")) {
+        try {
+            delete readBakedTexture(bad.constData(), bad.size(), Sampler(), readMetadata);
+        } catch (const QString&) {
+            refusals++;
+        }
+    }
+    if (refusals == 3) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": refused" << refusals << "of 3 bad baked textures";
+    }
+
+    // the key depends on both the content and the options
+    testsTaken++;
+    QVariantHash options;
+    options.insert("type", 1);
+    QVariantHash otherOptions;
+    otherOptions.insert("type", 2);
+    QByteArray key = BakedTextureCache::getKey(baked, options);
+    if (key == BakedTextureCache::getKey(baked, options) && key != BakedTextureCache::getKey(baked, otherOptions) &&
+            key != BakedTextureCache::getKey(truncated, options)) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": keys didn't distinguish content and options";
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
+
+void TextureProcessingTests::processingBenchmark() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "TextureProcessingTests::processingBenchmark()";
+
+    srand(1234);
+
+    // a photo sized image capped to the reader's maximum area, as each texture used to be on the GPU
+    const float NSECS_PER_MSEC = 1000000.0f;
+    TexelImage image = createNoise(2896, 1448, RGBA_CHANNELS);
+    QElapsedTimer timer;
+    timer.start();
+    TexelImage capped = resampleImage(image, 2048, 1024, false);
+    float resampleMSecs = timer.nsecsElapsed() / NSECS_PER_MSEC;
+
+    timer.restart();
+    std::vector<TexelImage> linearMips = generateMips(capped, false);
+    float linearMSecs = timer.nsecsElapsed() / NSECS_PER_MSEC;
+
+    timer.restart();
+    std::vector<TexelImage> sRGBMips = generateMips(capped, true);
+    float sRGBMSecs = timer.nsecsElapsed() / NSECS_PER_MSEC;
+
+    TexelImage rgb = createGradient(2048, 1024, RGB_CHANNELS);
+    timer.restart();
+    std::vector<TexelImage> rgbMips = generateMips(rgb, false);
+    float rgbMSecs = timer.nsecsElapsed() / NSECS_PER_MSEC;
+
+    timer.restart();
+    std::vector<Byte> bc1 = compressImage(rgb, false);
+    float bc1MSecs = timer.nsecsElapsed() / NSECS_PER_MSEC;
+
+    timer.restart();
+    std::vector<Byte> bc3 = compressImage(capped, true);
+    float bc3MSecs = timer.nsecsElapsed() / NSECS_PER_MSEC;
+
+    std::vector<TexelImage> faces(1, capped);
+    timer.restart();
+    std::unique_ptr<Texture> texture(createMippedTexture(Texture::TEX_2D, faces, Element(VEC4, UINT8, RGBA),
+        Element(VEC4, UINT8, BGRA), true));
+    QByteArray baked = writeBakedTexture(*texture);
+    float bakeMSecs = timer.nsecsElapsed() / NSECS_PER_MSEC;
+
+    timer.restart();
+    QVariantHash metadata;
+    texture.reset(readBakedTexture(baked.constData(), baked.size(), Sampler(), metadata));
+    float loadMSecs = timer.nsecsElapsed() / NSECS_PER_MSEC;
+
+    qDebug() << "levels=" << (int)linearMips.size() + 1 << "RGBA bytes=" << (int)capped.getBytes().size()
+        << "BC3 bytes=" << (int)bc3.size() << "BC1 bytes=" << (int)bc1.size() << "baked bytes=" << baked.size();
+    qDebug() << "TIME - resample=" << resampleMSecs << "msecs mips: linear RGBA=" << linearMSecs << "msecs sRGB RGBA="
+        << sRGBMSecs << "msecs RGB=" << rgbMSecs << "msecs";
+    qDebug() << "TIME - BC1=" << bc1MSecs << "msecs BC3=" << bc3MSecs << "msecs bake=" << bakeMSecs << "msecs load="
+        << loadMSecs << "msecs";
+}
@@ -0,0 +1,23 @@
+//
+//  TextureProcessingTests.h
+//  tests/gpu/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_TextureProcessingTests_h
+#define hifi_TextureProcessingTests_h
+
+namespace TextureProcessingTests {
+    void downsampleTests();
+    void resampleTests();
+    void compressionTests();
+    void bakedTextureTests();
+    void processingBenchmark();
+    void runAllTests();
+}
+
+#endif // hifi_TextureProcessingTests_h
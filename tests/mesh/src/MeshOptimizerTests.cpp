@@ -0,0 +1,500 @@
+//
+//  MeshOptimizerTests.cpp
+//  tests/mesh/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <cfloat>
+#include <map>
+#include <vector>
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <FBXReader.h>
+#include <MeshOptimizer.h>
+#include <NumericalConstants.h>
+
+#include "MeshOptimizerTests.h"
+
+void MeshOptimizerTests::runAllTests() {
+    vertexCacheTests();
+    overdrawTests();
+    vertexFetchTests();
+    lodTests();
+    optimizeBenchmark();
+}
+
+static const int INDICES_PER_TRIANGLE = 3;
+static const int INDICES_PER_QUAD = 4;
+
+// a flat square of size * size cells, each one quad or two triangles
+static void createGrid(int size, bool quads, FBXMesh& mesh) {
+    mesh.parts.append(FBXMeshPart());
+    FBXMeshPart& part = mesh.parts.last();
+    for (int i = 0; i <= size; i++) {
+        for (int j = 0; j <= size; j++) {
+            mesh.vertices.append(glm::vec3((float)j, (float)i, 0.0f));
+            mesh.texCoords.append(glm::vec2((float)j / size, (float)i / size));
+        }
+    }
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            int v00 = i * (size + 1) + j;
+            int v01 = v00 + 1;
+            int v10 = v00 + size + 1;
+            int v11 = v10 + 1;
+            if (quads) {
+                part.quadIndices << v00 << v01 << v11 << v10;
+            } else {
+                part.triangleIndices << v00 << v01 << v11 << v00 << v11 << v10;
+            }
+        }
+    }
+}
+
+// a closed sphere whose texture coordinates split the vertices along one seam, appended to the mesh as a new part
+static void createSphere(int slices, int stacks, float radius, FBXMesh& mesh) {
+    mesh.parts.append(FBXMeshPart());
+    FBXMeshPart& part = mesh.parts.last();
+    int firstVertex = mesh.vertices.size();
+    for (int i = 0; i <= stacks; i++) {
+        float pitch = PI * i / stacks - PI_OVER_TWO;
+        for (int j = 0; j <= slices; j++) {
+            // the last column duplicates the first, with its own texture coordinates
+            float yaw = (j == slices) ? 0.0f : TWO_PI * j / slices;
+            glm::vec3 normal(cosf(pitch) * cosf(yaw), sinf(pitch), -cosf(pitch) * sinf(yaw));
+            if (i == 0 || i == stacks) {
+                normal = glm::vec3(0.0f, (i == 0) ? -1.0f : 1.0f, 0.0f);
+            }
+            mesh.vertices.append(normal * radius);
+            mesh.normals.append(normal);
+            mesh.texCoords.append(glm::vec2((float)j / slices, (float)i / stacks));
+        }
+    }
+    for (int i = 0; i < stacks; i++) {
+        for (int j = 0; j < slices; j++) {
+            int v00 = firstVertex + i * (slices + 1) + j;
+            int v01 = v00 + 1;
+            int v10 = v00 + slices + 1;
+            int v11 = v10 + 1;
+            if (i != 0) {
+                part.triangleIndices << v00 << v01 << v10;
+            }
+            if (i != stacks - 1) {
+                part.triangleIndices << v01 << v11 << v10;
+            }
+        }
+    }
+}
+
+static void shuffleFaces(QVector<int>& indices, int indicesPerFace) {
+    int faceCount = indices.size() / indicesPerFace;
+    for (int i = faceCount - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        for (int k = 0; k < indicesPerFace; k++) {
+            std::swap(indices[i * indicesPerFace + k], indices[j * indicesPerFace + k]);
+        }
+    }
+}
+
+// the faces' positions in a canonical order, each starting from its least vertex but keeping its winding
+static std::vector<std::vector<float> > getFaces(const QVector<int>& indices, int indicesPerFace,
+                                                 const QVector<glm::vec3>& vertices) {
+    std::vector<std::vector<float> > faces;
+    for (int i = 0; i + indicesPerFace <= indices.size(); i += indicesPerFace) {
+        std::vector<float> face;
+        for (int j = 0; j < indicesPerFace; j++) {
+            const glm::vec3& vertex = vertices.at(indices.at(i + j));
+            face.push_back(vertex.x);
+            face.push_back(vertex.y);
+            face.push_back(vertex.z);
+        }
+        std::vector<float> least = face;
+        for (int j = 1; j < indicesPerFace; j++) {
+            std::rotate(face.begin(), face.begin() + 3, face.end());
+            least = std::min(least, face);
+        }
+        faces.push_back(least);
+    }
+    std::sort(faces.begin(), faces.end());
+    return faces;
+}
+
+void MeshOptimizerTests::vertexCacheTests() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "MeshOptimizerTests::vertexCacheTests()";
+
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    srand(1234);
+
+    // shuffled triangles miss on nearly every vertex; reordered, a grid should reuse most of them
+    FBXMesh triangleGrid;
+    createGrid(100, false, triangleGrid);
+    QVector<int>& triangles = triangleGrid.parts[0].triangleIndices;
+    shuffleFaces(triangles, INDICES_PER_TRIANGLE);
+    std::vector<std::vector<float> > faces = getFaces(triangles, INDICES_PER_TRIANGLE, triangleGrid.vertices);
+    float shuffledACMR = calculateACMR(triangles, INDICES_PER_TRIANGLE);
+    optimizeVertexCache(triangles, INDICES_PER_TRIANGLE, triangleGrid.vertices.size());
+    float optimizedACMR = calculateACMR(triangles, INDICES_PER_TRIANGLE);
+
+    testsTaken++;
+    const float MAX_GRID_ACMR = 0.8f;
+    if (shuffledACMR > 2.0f && optimizedACMR < MAX_GRID_ACMR) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": shuffled ACMR=" << shuffledACMR << "optimized ACMR="
+            << optimizedACMR;
+    }
+
+    testsTaken++;
+    if (getFaces(triangles, INDICES_PER_TRIANGLE, triangleGrid.vertices) == faces) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": the triangles changed";
+    }
+
+    // quads are reordered whole
+    FBXMesh quadGrid;
+    createGrid(100, true, quadGrid);
+    QVector<int>& quads = quadGrid.parts[0].quadIndices;
+    shuffleFaces(quads, INDICES_PER_QUAD);
+    faces = getFaces(quads, INDICES_PER_QUAD, quadGrid.vertices);
+    shuffledACMR = calculateACMR(quads, INDICES_PER_QUAD);
+    optimizeVertexCache(quads, INDICES_PER_QUAD, quadGrid.vertices.size());
+    optimizedACMR = calculateACMR(quads, INDICES_PER_QUAD);
+
+    testsTaken++;
+    if (optimizedACMR < MAX_GRID_ACMR && optimizedACMR < shuffledACMR / 2.0f &&
+            getFaces(quads, INDICES_PER_QUAD, quadGrid.vertices) == faces) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": shuffled ACMR=" << shuffledACMR << "optimized ACMR="
+            << optimizedACMR;
+    }
+
+    // nothing to reorder
+    testsTaken++;
+    QVector<int> empty;
+    QVector<int> single;
+    single << 0 << 1 << 2;
+    optimizeVertexCache(empty, INDICES_PER_TRIANGLE, 0);
+    optimizeVertexCache(single, INDICES_PER_TRIANGLE, 3);
+    if (empty.isEmpty() && single == QVector<int>() << 0 << 1 << 2 && calculateACMR(empty, INDICES_PER_TRIANGLE) == 0.0f) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": empty and single triangle lists changed";
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
+
+void MeshOptimizerTests::overdrawTests() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "MeshOptimizerTests::overdrawTests()";
+
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    srand(1234);
+
+    // one sphere inside another, in one list: the outer one hides the inner, so should all draw first
+    FBXMesh mesh;
+    const int SLICES = 32;
+    const int STACKS = 16;
+    createSphere(SLICES, STACKS, 1.0f, mesh);
+    int innerVertexCount = mesh.vertices.size();
+    createSphere(SLICES, STACKS, 2.0f, mesh);
+    QVector<int> triangles = mesh.parts.at(0).triangleIndices + mesh.parts.at(1).triangleIndices;
+    shuffleFaces(triangles, INDICES_PER_TRIANGLE);
+    optimizeVertexCache(triangles, INDICES_PER_TRIANGLE, mesh.vertices.size());
+    float cacheACMR = calculateACMR(triangles, INDICES_PER_TRIANGLE);
+    std::vector<std::vector<float> > faces = getFaces(triangles, INDICES_PER_TRIANGLE, mesh.vertices);
+
+    const float THRESHOLD = 1.05f;
+    optimizeOverdraw(triangles, INDICES_PER_TRIANGLE, mesh.vertices, THRESHOLD);
+    float overdrawACMR = calculateACMR(triangles, INDICES_PER_TRIANGLE);
+
+    testsTaken++;
+    int lastOuterTriangle = -1;
+    int firstInnerTriangle = triangles.size();
+    for (int i = 0; i < triangles.size(); i += INDICES_PER_TRIANGLE) {
+        if (triangles.at(i) < innerVertexCount) {
+            firstInnerTriangle = std::min(firstInnerTriangle, i);
+        } else {
+            lastOuterTriangle = i;
+        }
+    }
+    if (lastOuterTriangle < firstInnerTriangle) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": inner sphere starts at" << firstInnerTriangle / INDICES_PER_TRIANGLE
+            << "outer sphere ends at" << lastOuterTriangle / INDICES_PER_TRIANGLE;
+    }
+
+    // the clusters only start over where the cache would have anyway, or where it's nearly as good
+    testsTaken++;
+    const float ACMR_TOLERANCE = 1.1f;
+    if (overdrawACMR <= cacheACMR * ACMR_TOLERANCE) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": cache ACMR=" << cacheACMR << "overdraw ACMR=" << overdrawACMR;
+    }
+
+    testsTaken++;
+    if (getFaces(triangles, INDICES_PER_TRIANGLE, mesh.vertices) == faces) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": the triangles changed";
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
+
+void MeshOptimizerTests::vertexFetchTests() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "MeshOptimizerTests::vertexFetchTests()";
+
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    srand(1234);
+
+    // a grid drawn back to front, with vertices that nothing uses and a blendshape that moves every vertex
+    FBXMesh mesh;
+    const int GRID_SIZE = 16;
+    createGrid(GRID_SIZE, false, mesh);
+    int usedVertexCount = mesh.vertices.size();
+    const int UNUSED_VERTEX_COUNT = 10;
+    for (int i = 0; i < UNUSED_VERTEX_COUNT; i++) {
+        mesh.vertices.prepend(glm::vec3(-1.0f, (float)i, 0.0f));
+        mesh.texCoords.prepend(glm::vec2(0.0f));
+    }
+    QVector<int>& triangles = mesh.parts[0].triangleIndices;
+    std::reverse(triangles.begin(), triangles.end());
+    for (int i = 0; i < triangles.size(); i++) {
+        triangles[i] += UNUSED_VERTEX_COUNT;
+    }
+    std::vector<std::vector<float> > faces = getFaces(triangles, INDICES_PER_TRIANGLE, mesh.vertices);
+    FBXBlendshape blendshape;
+    for (int i = 0; i < mesh.vertices.size(); i++) {
+        blendshape.indices.append(i);
+        blendshape.vertices.append(mesh.vertices.at(i) * 2.0f);
+        blendshape.normals.append(glm::vec3(0.0f, 0.0f, 1.0f));
+    }
+    mesh.blendshapes.append(blendshape);
+
+    optimizeVertexFetch(mesh);
+
+    testsTaken++;
+    if (mesh.vertices.size() == usedVertexCount && mesh.texCoords.size() == usedVertexCount &&
+            getFaces(triangles, INDICES_PER_TRIANGLE, mesh.vertices) == faces) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": vertices=" << mesh.vertices.size() << "expected" << usedVertexCount;
+    }
+
+    // each index is either one already used or the next one along
+    testsTaken++;
+    int nextVertex = 0;
+    bool inOrder = true;
+    foreach (int index, triangles) {
+        if (index > nextVertex) {
+            inOrder = false;
+        } else if (index == nextVertex) {
+            nextVertex++;
+        }
+    }
+    if (inOrder) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": vertices aren't in the order they're first used";
+    }
+
+    testsTaken++;
+    const FBXBlendshape& remapped = mesh.blendshapes.at(0);
+    bool blendshapeMatches = remapped.indices.size() == usedVertexCount && remapped.vertices.size() == usedVertexCount &&
+        remapped.normals.size() == usedVertexCount;
+    for (int i = 0; blendshapeMatches && i < remapped.indices.size(); i++) {
+        blendshapeMatches = (remapped.vertices.at(i) == mesh.vertices.at(remapped.indices.at(i)) * 2.0f);
+    }
+    if (blendshapeMatches) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": the blendshape no longer matches its vertices";
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
+
+void MeshOptimizerTests::lodTests() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "MeshOptimizerTests::lodTests()";
+
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    // each level of a sphere should roughly halve the last, without straying far from the surface
+    FBXMesh sphere;
+    createSphere(64, 32, 1.0f, sphere);
+    generateMeshLODs(sphere);
+    const FBXMeshPart& part = sphere.parts.at(0);
+
+    testsTaken++;
+    const int MIN_SPHERE_LODS = 2;
+    const float MAX_TRIANGLE_PROPORTION = 0.75f;
+    bool levelsValid = sphere.lodErrors.size() >= MIN_SPHERE_LODS && sphere.lodErrors.size() <= MAX_MESH_LODS &&
+        part.lodTriangleIndices.size() == sphere.lodErrors.size();
+    int lastTriangleCount = part.triangleIndices.size() / INDICES_PER_TRIANGLE;
+    float lastError = 0.0f;
+    for (int i = 0; levelsValid && i < part.lodTriangleIndices.size(); i++) {
+        const QVector<int>& indices = part.lodTriangleIndices.at(i);
+        int triangleCount = indices.size() / INDICES_PER_TRIANGLE;
+        levelsValid = triangleCount > 0 && triangleCount <= lastTriangleCount * MAX_TRIANGLE_PROPORTION &&
+            sphere.lodErrors.at(i) >= lastError && sphere.lodErrors.at(i) <= 0.05f;
+        foreach (int index, indices) {
+            levelsValid &= (index >= 0 && index < sphere.vertices.size());
+        }
+        qDebug() << "level" << i + 1 << ": triangles=" << triangleCount << "error=" << sphere.lodErrors.at(i);
+        lastTriangleCount = triangleCount;
+        lastError = sphere.lodErrors.at(i);
+    }
+    if (levelsValid) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": levels=" << sphere.lodErrors.size();
+    }
+
+    // collapses along the seam move the vertices on both sides, so the sphere stays closed: each edge is used once in
+    // each direction
+    testsTaken++;
+    bool closed = !part.lodTriangleIndices.isEmpty();
+    for (int i = 0; closed && i < part.lodTriangleIndices.size(); i++) {
+        const QVector<int>& indices = part.lodTriangleIndices.at(i);
+        std::map<std::vector<float>, int> edgeCounts;
+        for (int j = 0; j < indices.size(); j++) {
+            const glm::vec3& start = sphere.vertices.at(indices.at(j));
+            const glm::vec3& end = sphere.vertices.at(indices.at(j - j % INDICES_PER_TRIANGLE +
+                (j + 1) % INDICES_PER_TRIANGLE));
+            std::vector<float> forward = { start.x, start.y, start.z, end.x, end.y, end.z };
+            std::vector<float> backward = { end.x, end.y, end.z, start.x, start.y, start.z };
+            edgeCounts[forward]++;
+            edgeCounts[backward]--;
+        }
+        for (std::map<std::vector<float>, int>::const_iterator it = edgeCounts.begin(); it != edgeCounts.end(); it++) {
+            closed &= (it->second == 0);
+        }
+    }
+    if (closed) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": a level of the sphere has holes";
+    }
+
+    // a flat grid simplifies without error, and keeps its outline
+    FBXMesh grid;
+    const int GRID_SIZE = 32;
+    createGrid(GRID_SIZE, false, grid);
+    generateMeshLODs(grid);
+
+    testsTaken++;
+    bool gridValid = !grid.lodErrors.isEmpty();
+    const float MAX_FLAT_ERROR = 0.001f;
+    for (int i = 0; gridValid && i < grid.lodErrors.size(); i++) {
+        glm::vec3 minimum(FLT_MAX), maximum(-FLT_MAX);
+        foreach (int index, grid.parts.at(0).lodTriangleIndices.at(i)) {
+            minimum = glm::min(minimum, grid.vertices.at(index));
+            maximum = glm::max(maximum, grid.vertices.at(index));
+        }
+        gridValid = grid.lodErrors.at(i) < MAX_FLAT_ERROR && minimum == glm::vec3(0.0f) &&
+            maximum == glm::vec3((float)GRID_SIZE, (float)GRID_SIZE, 0.0f);
+    }
+    if (gridValid) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": grid levels=" << grid.lodErrors.size();
+    }
+
+    // small meshes are left alone
+    FBXMesh smallGrid;
+    createGrid(8, false, smallGrid);
+    generateMeshLODs(smallGrid);
+
+    testsTaken++;
+    if (smallGrid.lodErrors.isEmpty() && smallGrid.parts.at(0).lodTriangleIndices.isEmpty()) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": small grid levels=" << smallGrid.lodErrors.size();
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
+
+void MeshOptimizerTests::optimizeBenchmark() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "MeshOptimizerTests::optimizeBenchmark()";
+
+    srand(1234);
+
+    // a high poly sphere in the order a careless exporter might write it
+    FBXMesh mesh;
+    createSphere(512, 256, 1.0f, mesh);
+    QVector<int>& triangles = mesh.parts[0].triangleIndices;
+    shuffleFaces(triangles, INDICES_PER_TRIANGLE);
+    int vertexCount = mesh.vertices.size();
+    float shuffledACMR = calculateACMR(triangles, INDICES_PER_TRIANGLE);
+
+    const float NSECS_PER_MSEC = 1000000.0f;
+    QElapsedTimer timer;
+    timer.start();
+    generateMeshLODs(mesh);
+    float lodMSecs = timer.nsecsElapsed() / NSECS_PER_MSEC;
+
+    timer.restart();
+    optimizeVertexCache(triangles, INDICES_PER_TRIANGLE, vertexCount);
+    float cacheMSecs = timer.nsecsElapsed() / NSECS_PER_MSEC;
+    float cacheACMR = calculateACMR(triangles, INDICES_PER_TRIANGLE);
+
+    timer.restart();
+    optimizeOverdraw(triangles, INDICES_PER_TRIANGLE, mesh.vertices);
+    float overdrawMSecs = timer.nsecsElapsed() / NSECS_PER_MSEC;
+    float overdrawACMR = calculateACMR(triangles, INDICES_PER_TRIANGLE);
+
+    timer.restart();
+    optimizeVertexFetch(mesh);
+    float fetchMSecs = timer.nsecsElapsed() / NSECS_PER_MSEC;
+
+    qDebug() << "triangles=" << triangles.size() / INDICES_PER_TRIANGLE << "vertices=" << vertexCount;
+    qDebug() << "ACMR: shuffled=" << shuffledACMR << "cache=" << cacheACMR << "overdraw=" << overdrawACMR;
+    for (int i = 0; i < mesh.lodErrors.size(); i++) {
+        qDebug() << "level" << i + 1 << ": triangles=" << mesh.parts.at(0).lodTriangleIndices.at(i).size() /
+            INDICES_PER_TRIANGLE << "error=" << mesh.lodErrors.at(i);
+    }
+    qDebug() << "TIME - lods=" << lodMSecs << "msecs cache=" << cacheMSecs << "msecs overdraw=" << overdrawMSecs
+        << "msecs fetch=" << fetchMSecs << "msecs";
+}
@@ -0,0 +1,23 @@
+//
+//  MeshOptimizerTests.h
+//  tests/mesh/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_MeshOptimizerTests_h
+#define hifi_MeshOptimizerTests_h
+
+namespace MeshOptimizerTests {
+    void vertexCacheTests();
+    void overdrawTests();
+    void vertexFetchTests();
+    void lodTests();
+    void optimizeBenchmark();
+    void runAllTests();
+}
+
+#endif // hifi_MeshOptimizerTests_h
@@ -0,0 +1,16 @@
+//
+//  main.cpp
+//  tests/mesh/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "MeshOptimizerTests.h"
+
+int main(int argc, char** argv) {
+    MeshOptimizerTests::runAllTests();
+    return 0;
+}
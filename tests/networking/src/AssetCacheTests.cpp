@@ -0,0 +1,163 @@
+//
+//  AssetCacheTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cassert>
+
+#include <QDir>
+#include <QFile>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+
+#include "AssetCacheTests.h"
+
+void AssetCacheTests::runAllTests() {
+    storeTest();
+    dedupTest();
+    evictionTest();
+    persistenceTest();
+}
+
+const qint64 MAXIMUM_SIZE = 1024 * 1024;
+
+static QNetworkCacheMetaData createMetaData(const QString& url, const QByteArray& entityTag = QByteArray()) {
+    QNetworkCacheMetaData metaData;
+    metaData.setUrl(QUrl(url));
+    metaData.setSaveToDisk(true);
+    if (!entityTag.isEmpty()) {
+        metaData.setRawHeaders(QNetworkCacheMetaData::RawHeaderList() <<
+            QNetworkCacheMetaData::RawHeader("ETag", entityTag));
+    }
+    return metaData;
+}
+
+static void insertContent(AssetCache& cache, const QNetworkCacheMetaData& metaData, const QByteArray& content) {
+    QScopedPointer<QFile> file(cache.createIncomingFile());
+    assert(file);
+    file->write(content);
+    cache.insert(metaData, file.data());
+}
+
+static QByteArray readContent(AssetCache& cache, const QString& url) {
+    QScopedPointer<QIODevice> device(cache.getData(QUrl(url)));
+    return device ? device->readAll() : QByteArray();
+}
+
+static QByteArray createContent(int size, char seed) {
+    QByteArray content(size, 0);
+    for (int i = 0; i < size; i++) {
+        content[i] = (char)(seed + i * 7);
+    }
+    return content;
+}
+
+void AssetCacheTests::storeTest() {
+    QTemporaryDir directory;
+    AssetCache cache(directory.path(), MAXIMUM_SIZE);
+
+    QByteArray content = createContent(1000, 1);
+    insertContent(cache, createMetaData("http://example.com/model.fbx", "\"1\""), content);
+    assert(readContent(cache, "http://example.com/model.fbx") == content);
+    assert(cache.getMetaData(QUrl("http://example.com/model.fbx")).rawHeaders().at(0).second == "\"1\"");
+    assert(cache.getSize() == content.size());
+    assert(readContent(cache, "http://example.com/other.fbx").isEmpty());
+
+    // a new version of the same URL replaces the old content
+    QByteArray newContent = createContent(500, 2);
+    insertContent(cache, createMetaData("http://example.com/model.fbx", "\"2\""), newContent);
+    assert(readContent(cache, "http://example.com/model.fbx") == newContent);
+    assert(cache.getSize() == newContent.size());
+    assert(cache.getContentCount() == 1);
+
+    assert(cache.remove(QUrl("http://example.com/model.fbx")));
+    assert(!cache.remove(QUrl("http://example.com/model.fbx")));
+    assert(cache.getSize() == 0);
+    assert(QDir(directory.path() + "/content").entryList(QDir::Files).isEmpty());
+}
+
+void AssetCacheTests::dedupTest() {
+    QTemporaryDir directory;
+    AssetCache cache(directory.path(), MAXIMUM_SIZE);
+
+    // the same texture from two hosts is stored once
+    QByteArray content = createContent(4000, 3);
+    insertContent(cache, createMetaData("http://one.example.com/texture.png"), content);
+    insertContent(cache, createMetaData("http://two.example.com/texture.png"), content);
+    assert(cache.getRecordCount() == 2);
+    assert(cache.getContentCount() == 1);
+    assert(cache.getSize() == content.size());
+
+    // and stays as long as either URL refers to it
+    cache.remove(QUrl("http://one.example.com/texture.png"));
+    assert(readContent(cache, "http://two.example.com/texture.png") == content);
+    cache.remove(QUrl("http://two.example.com/texture.png"));
+    assert(cache.getContentCount() == 0);
+    assert(cache.getSize() == 0);
+}
+
+void AssetCacheTests::evictionTest() {
+    QTemporaryDir directory;
+    const int CONTENT_SIZE = MAXIMUM_SIZE / 4;
+    AssetCache cache(directory.path(), MAXIMUM_SIZE);
+    for (int i = 0; i < 4; i++) {
+        insertContent(cache, createMetaData(QString("http://example.com/%1").arg(i)), createContent(CONTENT_SIZE, i));
+    }
+    assert(cache.getSize() == MAXIMUM_SIZE);
+
+    // reading the first makes the second the least recently used
+    assert(!readContent(cache, "http://example.com/0").isEmpty());
+    insertContent(cache, createMetaData("http://example.com/4"), createContent(CONTENT_SIZE, 4));
+    assert(cache.getSize() == MAXIMUM_SIZE);
+    assert(cache.getMetaData(QUrl("http://example.com/0")).isValid());
+    assert(!cache.getMetaData(QUrl("http://example.com/1")).isValid());
+
+    // content bigger than the whole cache isn't stored at all
+    insertContent(cache, createMetaData("http://example.com/huge"), createContent(MAXIMUM_SIZE + 1, 5));
+    assert(!cache.getMetaData(QUrl("http://example.com/huge")).isValid());
+    assert(cache.getRecordCount() == 4);
+
+    // shrinking the cache evicts down to the new size
+    cache.setMaximumSize(CONTENT_SIZE);
+    assert(cache.getRecordCount() == 1);
+    assert(cache.getMetaData(QUrl("http://example.com/4")).isValid());
+    assert(QDir(directory.path() + "/content").entryList(QDir::Files).size() == 1);
+}
+
+void AssetCacheTests::persistenceTest() {
+    QTemporaryDir directory;
+    QByteArray content = createContent(2000, 6);
+    {
+        AssetCache cache(directory.path(), MAXIMUM_SIZE);
+        insertContent(cache, createMetaData("http://example.com/sound.wav", "\"a\""), content);
+        insertContent(cache, createMetaData("http://example.com/copy.wav"), content);
+        cache.updateMetaData(createMetaData("http://example.com/sound.wav", "\"b\""));
+
+        // as though a crash left a half-written download and an unreferenced file behind
+        QFile incoming(directory.path() + "/incoming/abcdef");
+        incoming.open(QIODevice::WriteOnly);
+        incoming.write(content);
+        QFile orphan(directory.path() + "/content/0123456789abcdef0123456789abcdef01234567");
+        orphan.open(QIODevice::WriteOnly);
+        orphan.write(content);
+    }
+    AssetCache cache(directory.path(), MAXIMUM_SIZE);
+    assert(cache.getRecordCount() == 2);
+    assert(cache.getContentCount() == 1);
+    assert(cache.getSize() == content.size());
+    assert(readContent(cache, "http://example.com/sound.wav") == content);
+    assert(cache.getMetaData(QUrl("http://example.com/sound.wav")).rawHeaders().at(0).second == "\"b\"");
+    assert(QDir(directory.path() + "/content").entryList(QDir::Files).size() == 1);
+    assert(QDir(directory.path() + "/incoming").entryList(QDir::Files).isEmpty());
+
+    // records that no longer have their content are dropped
+    QFile::remove(directory.path() + "/content/" + QDir(directory.path() + "/content").entryList(QDir::Files).at(0));
+    AssetCache reloaded(directory.path(), MAXIMUM_SIZE);
+    assert(reloaded.getRecordCount() == 0);
+    assert(QDir(directory.path() + "/records").entryList(QDir::Files).isEmpty());
+}
@@ -0,0 +1,26 @@
+//
+//  AssetCacheTests.h
+//  tests/networking/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AssetCacheTests_h
+#define hifi_AssetCacheTests_h
+
+#include "AssetCache.h"
+
+namespace AssetCacheTests {
+
+    void runAllTests();
+
+    void storeTest();
+    void dedupTest();
+    void evictionTest();
+    void persistenceTest();
+};
+
+#endif // hifi_AssetCacheTests_h
@@ -0,0 +1,69 @@
+//
+//  LossyLinkSimulator.cpp
+//  tests/networking/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+
+#include "LossyLinkSimulator.h"
+
+const quint64 USECS_PER_SECOND = 1000 * 1000;
+
+LossyLinkSimulator::LossyLinkSimulator(float lossRate, quint64 latencyUsecs, quint64 jitterUsecs, int bytesPerSecond,
+                                       quint64 maxQueuingDelayUsecs, unsigned int seed) :
+    _lossRate(lossRate),
+    _latencyUsecs(latencyUsecs),
+    _jitterUsecs(jitterUsecs),
+    _bytesPerSecond(bytesPerSecond),
+    _maxQueuingDelayUsecs(maxQueuingDelayUsecs),
+    _random(seed),
+    _linkFreeAt(0),
+    _datagramsSent(0),
+    _datagramsDropped(0),
+    _maxQueuingDelay(0)
+{
+}
+
+void LossyLinkSimulator::send(const QByteArray& datagram, quint64 now) {
+    _datagramsSent++;
+
+    // drop tail when the router queue in front of the link is full
+    quint64 queuingDelay = _linkFreeAt > now ? _linkFreeAt - now : 0;
+    if (queuingDelay > _maxQueuingDelayUsecs) {
+        _datagramsDropped++;
+        return;
+    }
+    _maxQueuingDelay = std::max(_maxQueuingDelay, queuingDelay);
+
+    quint64 serializationDelay = (quint64)datagram.size() * USECS_PER_SECOND / _bytesPerSecond;
+    _linkFreeAt = std::max(_linkFreeAt, now) + serializationDelay;
+
+    // random loss happens on the wire, after the datagram took its share of the link
+    std::uniform_real_distribution<float> lossDistribution(0.0f, 1.0f);
+    if (lossDistribution(_random) < _lossRate) {
+        _datagramsDropped++;
+        return;
+    }
+
+    quint64 jitter = 0;
+    if (_jitterUsecs > 0) {
+        std::uniform_int_distribution<quint64> jitterDistribution(0, _jitterUsecs);
+        jitter = jitterDistribution(_random);
+    }
+    _inTransit.insert(std::make_pair(_linkFreeAt + _latencyUsecs + jitter, datagram));
+}
+
+std::vector<QByteArray> LossyLinkSimulator::receive(quint64 now) {
+    std::vector<QByteArray> arrived;
+    auto it = _inTransit.begin();
+    while (it != _inTransit.end() && it->first <= now) {
+        arrived.push_back(it->second);
+        it = _inTransit.erase(it);
+    }
+    return arrived;
+}
@@ -0,0 +1,53 @@
+//
+//  LossyLinkSimulator.h
+//  tests/networking/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Simulates a one way link with limited bandwidth, a bounded router queue, latency, jitter and random loss.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_LossyLinkSimulator_h
+#define hifi_LossyLinkSimulator_h
+
+#include <map>
+#include <random>
+#include <vector>
+
+#include <QByteArray>
+
+class LossyLinkSimulator {
+public:
+    LossyLinkSimulator(float lossRate, quint64 latencyUsecs, quint64 jitterUsecs, int bytesPerSecond,
+                       quint64 maxQueuingDelayUsecs, unsigned int seed);
+
+    /// hand a datagram to the link at time now, it is either dropped or scheduled for delivery
+    void send(const QByteArray& datagram, quint64 now);
+
+    /// datagrams that have arrived by time now, in arrival order
+    std::vector<QByteArray> receive(quint64 now);
+
+    quint64 getDatagramsSent() const { return _datagramsSent; }
+    quint64 getDatagramsDropped() const { return _datagramsDropped; }
+    quint64 getMaxQueuingDelay() const { return _maxQueuingDelay; }
+
+private:
+    float _lossRate;
+    quint64 _latencyUsecs;
+    quint64 _jitterUsecs;
+    int _bytesPerSecond;
+    quint64 _maxQueuingDelayUsecs;
+
+    std::minstd_rand _random;
+    std::multimap<quint64, QByteArray> _inTransit;
+    quint64 _linkFreeAt;
+
+    quint64 _datagramsSent;
+    quint64 _datagramsDropped;
+    quint64 _maxQueuingDelay;
+};
+
+#endif // hifi_LossyLinkSimulator_h
@@ -0,0 +1,102 @@
+//
+//  NodeBandwidthShaperTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cassert>
+
+#include <QDebug>
+
+#include "NodeBandwidthShaperTests.h"
+
+void NodeBandwidthShaperTests::runAllTests() {
+    rateTest();
+    priorityTest();
+    staleAudioTest();
+}
+
+const int DATAGRAM_BYTES = 1000;
+const int BYTES_PER_SECOND = 100 * 1000;
+const quint64 FLUSH_INTERVAL_USECS = 5 * 1000;
+
+static QByteArray datagramWithTag(int tag) {
+    QByteArray datagram(DATAGRAM_BYTES, 0);
+    datagram[0] = (char)tag;
+    return datagram;
+}
+
+void NodeBandwidthShaperTests::rateTest() {
+    NodeBandwidthShaper shaper;
+    shaper.setBytesPerSecond(BYTES_PER_SECOND);
+
+    // offer twice the budget for ten seconds, the shaper should let the budget through and tail drop the rest
+    const quint64 TEST_USECS = 10 * 1000 * 1000;
+    int bytesSent = 0;
+    for (quint64 now = 1; now < TEST_USECS; now += FLUSH_INTERVAL_USECS) {
+        for (int i = 0; i < 2 * BYTES_PER_SECOND * (int)FLUSH_INTERVAL_USECS / (1000 * 1000 * DATAGRAM_BYTES); i++) {
+            shaper.queueDatagram(datagramWithTag(i), HifiSockAddr(), EntityShapingPriority, now);
+        }
+        for (const auto& sendable : shaper.takeSendableDatagrams(now)) {
+            bytesSent += sendable.datagram.size();
+        }
+    }
+
+    int expectedBytes = BYTES_PER_SECOND * (int)(TEST_USECS / (1000 * 1000));
+    qDebug() << "rateTest sent" << bytesSent << "bytes, budget was" << expectedBytes;
+    assert(bytesSent <= expectedBytes + 2 * 1500);
+    assert(bytesSent >= expectedBytes * 0.95);
+    assert(shaper.getDroppedDatagrams() > 0);
+    assert(shaper.getQueuedBytes() <= NodeBandwidthShaper::MIN_MAX_QUEUED_BYTES * 4);
+}
+
+void NodeBandwidthShaperTests::priorityTest() {
+    NodeBandwidthShaper shaper;
+    shaper.setBytesPerSecond(BYTES_PER_SECOND);
+
+    // use up the initial burst so that everything after this has to wait in the queues
+    quint64 now = 1;
+    shaper.recordUnshapedBytes(2 * 1500, now);
+
+    shaper.queueDatagram(datagramWithTag(BulkShapingPriority), HifiSockAddr(), BulkShapingPriority, now);
+    shaper.queueDatagram(datagramWithTag(EntityShapingPriority), HifiSockAddr(), EntityShapingPriority, now);
+    shaper.queueDatagram(datagramWithTag(AvatarShapingPriority), HifiSockAddr(), AvatarShapingPriority, now);
+    shaper.queueDatagram(datagramWithTag(AudioShapingPriority), HifiSockAddr(), AudioShapingPriority, now);
+    assert(shaper.takeSendableDatagrams(now).empty());
+
+    std::vector<int> sendOrder;
+    while (shaper.hasQueuedDatagrams()) {
+        now += FLUSH_INTERVAL_USECS;
+        for (const auto& sendable : shaper.takeSendableDatagrams(now)) {
+            sendOrder.push_back(sendable.datagram[0]);
+        }
+    }
+
+    assert(sendOrder.size() == NUM_SHAPING_PRIORITIES);
+    for (int i = 0; i < NUM_SHAPING_PRIORITIES; i++) {
+        assert(sendOrder[i] == i);
+    }
+}
+
+void NodeBandwidthShaperTests::staleAudioTest() {
+    NodeBandwidthShaper shaper;
+    shaper.setBytesPerSecond(BYTES_PER_SECOND);
+
+    // a big debt holds the queues back for a second, long enough for queued audio to be of no use anymore
+    quint64 now = 1;
+    shaper.recordUnshapedBytes(BYTES_PER_SECOND, now);
+    shaper.queueDatagram(datagramWithTag(0), HifiSockAddr(), AudioShapingPriority, now);
+    shaper.queueDatagram(datagramWithTag(1), HifiSockAddr(), EntityShapingPriority, now);
+
+    now += 1000 * 1000 + FLUSH_INTERVAL_USECS;
+    std::vector<NodeBandwidthShaper::QueuedDatagram> sendable = shaper.takeSendableDatagrams(now);
+
+    assert(sendable.size() == 1);
+    assert(sendable[0].datagram[0] == 1);
+    assert(shaper.getDroppedDatagrams() == 1);
+    assert(!shaper.hasQueuedDatagrams());
+}
@@ -0,0 +1,25 @@
+//
+//  NodeBandwidthShaperTests.h
+//  tests/networking/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_NodeBandwidthShaperTests_h
+#define hifi_NodeBandwidthShaperTests_h
+
+#include "NodeBandwidthShaper.h"
+
+namespace NodeBandwidthShaperTests {
+
+    void runAllTests();
+
+    void rateTest();
+    void priorityTest();
+    void staleAudioTest();
+};
+
+#endif // hifi_NodeBandwidthShaperTests_h
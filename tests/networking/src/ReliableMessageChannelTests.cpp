@@ -0,0 +1,188 @@
+//
+//  ReliableMessageChannelTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cassert>
+#include <random>
+
+#include <QDebug>
+
+#include "LossyLinkSimulator.h"
+#include "ReliableMessageChannelTests.h"
+
+void ReliableMessageChannelTests::runAllTests() {
+    perfectLinkTest();
+    lossyLinkTest();
+    veryLossyLinkTest();
+    congestedLinkTest();
+    maxMessageSizeTest();
+}
+
+const quint64 UPDATE_INTERVAL_USECS = 10 * 1000;
+const quint64 MAX_SIMULATED_USECS = 600 * 1000 * 1000;
+
+// sends a batch of messages of various sizes from one channel to another over a pair of simulated links and checks
+// that they all come out complete and in order
+static void runTransfer(const char* name, LossyLinkSimulator& dataLink, LossyLinkSimulator& ackLink,
+                        int numMessages, int maxMessageBytes) {
+    ReliableMessageChannel sender;
+    ReliableMessageChannel receiver;
+
+    std::minstd_rand random(numMessages);
+    std::uniform_int_distribution<int> sizeDistribution(1, maxMessageBytes);
+
+    std::vector<QByteArray> sentMessages;
+    int totalBytes = 0;
+    for (int i = 0; i < numMessages; i++) {
+        QByteArray message(sizeDistribution(random), 0);
+        for (int j = 0; j < message.size(); j++) {
+            message.data()[j] = (char)(i + j);
+        }
+        totalBytes += message.size();
+        sentMessages.push_back(message);
+        sender.queueMessage(message);
+    }
+
+    std::vector<QByteArray> receivedMessages;
+    quint64 now = 0;
+    int maxCongestionWindow = 0;
+    while ((int)receivedMessages.size() < numMessages && now < MAX_SIMULATED_USECS) {
+        now += UPDATE_INTERVAL_USECS;
+
+        for (const QByteArray& payload : dataLink.receive(now)) {
+            receiver.processDataPayload(payload, now);
+        }
+        for (const QByteArray& payload : ackLink.receive(now)) {
+            sender.processAckPayload(payload, now);
+        }
+
+        sender.update(now);
+        receiver.update(now);
+
+        for (const QByteArray& payload : sender.takeOutgoingDataPayloads()) {
+            dataLink.send(payload, now);
+        }
+        for (const QByteArray& payload : receiver.takeOutgoingAckPayloads()) {
+            ackLink.send(payload, now);
+        }
+        for (const QByteArray& message : receiver.takeReceivedMessages()) {
+            receivedMessages.push_back(message);
+        }
+
+        maxCongestionWindow = std::max(maxCongestionWindow, sender.getCongestionControl().getCongestionWindowBytes());
+    }
+
+    assert((int)receivedMessages.size() == numMessages);
+    for (int i = 0; i < numMessages; i++) {
+        assert(receivedMessages[i] == sentMessages[i]);
+    }
+    assert(receiver.takeReceivedMessages().empty());
+
+    qDebug() << name << ":" << numMessages << "messages," << totalBytes << "bytes in" << (now / 1000) << "msecs,"
+        << sender.getFragmentsSent() << "fragments sent," << sender.getFragmentsRetransmitted() << "retransmitted,"
+        << dataLink.getDatagramsDropped() << "dropped, max queuing delay" << (dataLink.getMaxQueuingDelay() / 1000)
+        << "msecs, max window" << maxCongestionWindow << "bytes, smoothed RTT"
+        << (sender.getCongestionControl().getSmoothedRTT() / 1000) << "msecs";
+}
+
+void ReliableMessageChannelTests::perfectLinkTest() {
+    const int BYTES_PER_SECOND = 10 * 1000 * 1000;
+    LossyLinkSimulator dataLink(0.0f, 20 * 1000, 0, BYTES_PER_SECOND, 1000 * 1000, 1);
+    LossyLinkSimulator ackLink(0.0f, 20 * 1000, 0, BYTES_PER_SECOND, 1000 * 1000, 2);
+
+    runTransfer("perfect link", dataLink, ackLink, 500, 10000);
+
+    assert(dataLink.getDatagramsDropped() == 0);
+}
+
+void ReliableMessageChannelTests::lossyLinkTest() {
+    // 5% loss both ways, with enough jitter to reorder datagrams
+    const int BYTES_PER_SECOND = 1000 * 1000;
+    LossyLinkSimulator dataLink(0.05f, 40 * 1000, 15 * 1000, BYTES_PER_SECOND, 1000 * 1000, 3);
+    LossyLinkSimulator ackLink(0.05f, 40 * 1000, 15 * 1000, BYTES_PER_SECOND, 1000 * 1000, 4);
+
+    runTransfer("lossy link", dataLink, ackLink, 500, 10000);
+}
+
+void ReliableMessageChannelTests::veryLossyLinkTest() {
+    const int BYTES_PER_SECOND = 1000 * 1000;
+    LossyLinkSimulator dataLink(0.3f, 80 * 1000, 20 * 1000, BYTES_PER_SECOND, 1000 * 1000, 5);
+    LossyLinkSimulator ackLink(0.3f, 80 * 1000, 20 * 1000, BYTES_PER_SECOND, 1000 * 1000, 6);
+
+    runTransfer("very lossy link", dataLink, ackLink, 50, 10000);
+}
+
+void ReliableMessageChannelTests::congestedLinkTest() {
+    // a slow link behind a deep router buffer, the delay based controller should keep the queue near its target
+    // instead of filling the buffer until it drops
+    const int BYTES_PER_SECOND = 200 * 1000;
+    const quint64 ROUTER_BUFFER_USECS = 1000 * 1000;
+    LossyLinkSimulator dataLink(0.0f, 30 * 1000, 0, BYTES_PER_SECOND, ROUTER_BUFFER_USECS, 7);
+    LossyLinkSimulator ackLink(0.0f, 30 * 1000, 0, BYTES_PER_SECOND, ROUTER_BUFFER_USECS, 8);
+
+    runTransfer("congested link", dataLink, ackLink, 200, 10000);
+
+    assert(dataLink.getDatagramsDropped() == 0);
+    assert(dataLink.getMaxQueuingDelay() < ROUTER_BUFFER_USECS / 2);
+}
+
+void ReliableMessageChannelTests::maxMessageSizeTest() {
+    const int MAX_MESSAGE_BYTES = 10000;
+
+    // the sender refuses to queue a message over its maximum
+    ReliableMessageChannel limitedSender(DEFAULT_RELIABLE_FRAGMENT_BYTES, MAX_MESSAGE_BYTES);
+    assert(!limitedSender.queueMessage(QByteArray(MAX_MESSAGE_BYTES + 1, 'x')));
+    assert(limitedSender.isIdle());
+    assert(limitedSender.queueMessage(QByteArray(MAX_MESSAGE_BYTES, 'x')));
+
+    // a receiver with a smaller maximum than its peer drops the large message whole and still delivers the next one
+    ReliableMessageChannel sender;
+    ReliableMessageChannel receiver(DEFAULT_RELIABLE_FRAGMENT_BYTES, MAX_MESSAGE_BYTES);
+    QByteArray smallMessage(MAX_MESSAGE_BYTES / 2, 's');
+    assert(sender.queueMessage(QByteArray(MAX_MESSAGE_BYTES * 3, 'l')));
+    assert(sender.queueMessage(smallMessage));
+
+    const int BYTES_PER_SECOND = 10 * 1000 * 1000;
+    LossyLinkSimulator dataLink(0.0f, 20 * 1000, 0, BYTES_PER_SECOND, 1000 * 1000, 9);
+    LossyLinkSimulator ackLink(0.0f, 20 * 1000, 0, BYTES_PER_SECOND, 1000 * 1000, 10);
+
+    std::vector<QByteArray> receivedMessages;
+    quint64 now = 0;
+    while (!sender.isIdle() && now < MAX_SIMULATED_USECS) {
+        now += UPDATE_INTERVAL_USECS;
+
+        for (const QByteArray& payload : dataLink.receive(now)) {
+            receiver.processDataPayload(payload, now);
+        }
+        for (const QByteArray& payload : ackLink.receive(now)) {
+            sender.processAckPayload(payload, now);
+        }
+
+        sender.update(now);
+        receiver.update(now);
+
+        for (const QByteArray& payload : sender.takeOutgoingDataPayloads()) {
+            dataLink.send(payload, now);
+        }
+        for (const QByteArray& payload : receiver.takeOutgoingAckPayloads()) {
+            ackLink.send(payload, now);
+        }
+        for (const QByteArray& message : receiver.takeReceivedMessages()) {
+            receivedMessages.push_back(message);
+        }
+    }
+
+    assert(sender.isIdle());
+    assert(receivedMessages.size() == 1);
+    assert(receivedMessages[0] == smallMessage);
+    assert(receiver.getMessagesDiscarded() == 1);
+
+    qDebug() << "max message size :" << receiver.getMessagesDiscarded() << "discarded," << receivedMessages.size()
+        << "delivered in" << (now / 1000) << "msecs";
+}
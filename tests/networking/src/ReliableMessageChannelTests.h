@@ -0,0 +1,27 @@
+//
+//  ReliableMessageChannelTests.h
+//  tests/networking/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ReliableMessageChannelTests_h
+#define hifi_ReliableMessageChannelTests_h
+
+#include "ReliableMessageChannel.h"
+
+namespace ReliableMessageChannelTests {
+
+    void runAllTests();
+
+    void perfectLinkTest();
+    void lossyLinkTest();
+    void veryLossyLinkTest();
+    void congestedLinkTest();
+    void maxMessageSizeTest();
+};
+
+#endif // hifi_ReliableMessageChannelTests_h
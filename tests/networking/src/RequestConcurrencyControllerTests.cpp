@@ -0,0 +1,104 @@
+//
+//  RequestConcurrencyControllerTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cassert>
+
+#include <QDebug>
+
+#include "RequestConcurrencyControllerTests.h"
+
+void RequestConcurrencyControllerTests::runAllTests() {
+    convergenceTest();
+    unsaturatedTest();
+    boundsTest();
+    maxLimitTest();
+}
+
+const quint64 FRAME_USECS = 16 * 1000;
+const int BYTES_PER_REQUEST_PER_SECOND = 100 * 1000;
+
+// a link on which each request adds throughput up to six at once, past which they get in each other's way
+const int BEST_LIMIT = 6;
+static qint64 getBytesPerSecond(int limit) {
+    return (limit <= BEST_LIMIT) ? limit * BYTES_PER_REQUEST_PER_SECOND :
+        BEST_LIMIT * BYTES_PER_REQUEST_PER_SECOND - (limit - BEST_LIMIT) * BYTES_PER_REQUEST_PER_SECOND / 2;
+}
+
+static int runFrames(RequestConcurrencyController& controller, int seconds, bool saturated, quint64& now) {
+    int limit = controller.getLimit();
+    for (quint64 end = now + seconds * RequestConcurrencyController::WINDOW_USECS; now < end; now += FRAME_USECS) {
+        limit = controller.update(getBytesPerSecond(limit) * (qint64)FRAME_USECS / (1000 * 1000), now, saturated);
+    }
+    return limit;
+}
+
+void RequestConcurrencyControllerTests::convergenceTest() {
+    // from either side, the limit should climb or fall to the best one and then stay within a step of it
+    const int MAX_LIMIT = 16;
+    const int STARTING_LIMITS[] = { 1, 3, 12 };
+    for (int startingLimit : STARTING_LIMITS) {
+        RequestConcurrencyController controller(MAX_LIMIT);
+        controller.setLimit(startingLimit);
+        quint64 now = 1;
+        runFrames(controller, 30, true, now);
+        int lowest = MAX_LIMIT, highest = RequestConcurrencyController::MIN_LIMIT;
+        for (int i = 0; i < 20; i++) {
+            int limit = runFrames(controller, 1, true, now);
+            lowest = qMin(lowest, limit);
+            highest = qMax(highest, limit);
+        }
+        qDebug() << "convergenceTest from" << startingLimit << "settled between" << lowest << "and" << highest;
+        assert(lowest >= BEST_LIMIT - 1);
+        assert(highest <= BEST_LIMIT + 1);
+    }
+}
+
+void RequestConcurrencyControllerTests::unsaturatedTest() {
+    // with fewer downloads wanted than allowed, there's nothing to learn about the limit
+    RequestConcurrencyController controller(4);
+    quint64 now = 1;
+    assert(runFrames(controller, 10, false, now) == 4);
+    assert(controller.getThroughput() == 0.0f);
+}
+
+void RequestConcurrencyControllerTests::boundsTest() {
+    // the configured maximum is taken as is, however high, and the limit starts there
+    RequestConcurrencyController controller(1000);
+    assert(controller.getMaxLimit() == 1000);
+    assert(controller.getLimit() == 1000);
+    controller.setLimit(2000);
+    assert(controller.getLimit() == 1000);
+    controller.setLimit(-1);
+    assert(controller.getLimit() == RequestConcurrencyController::MIN_LIMIT);
+    controller.setMaxLimit(0);
+    assert(controller.getMaxLimit() == RequestConcurrencyController::MIN_LIMIT);
+}
+
+void RequestConcurrencyControllerTests::maxLimitTest() {
+    // below the best limit, the controller should settle at the maximum and never climb past it
+    const int MAX_LIMIT = 3;
+    RequestConcurrencyController controller(MAX_LIMIT);
+    quint64 now = 1;
+    runFrames(controller, 30, true, now);
+    int lowest = MAX_LIMIT, highest = RequestConcurrencyController::MIN_LIMIT;
+    for (int i = 0; i < 20; i++) {
+        int limit = runFrames(controller, 1, true, now);
+        lowest = qMin(lowest, limit);
+        highest = qMax(highest, limit);
+    }
+    qDebug() << "maxLimitTest settled between" << lowest << "and" << highest;
+    assert(highest == MAX_LIMIT);
+    assert(lowest >= MAX_LIMIT - 1);
+
+    // lowering the maximum takes effect at once
+    controller.setMaxLimit(MAX_LIMIT - 1);
+    assert(controller.getLimit() == MAX_LIMIT - 1);
+    assert(runFrames(controller, 10, true, now) <= MAX_LIMIT - 1);
+}
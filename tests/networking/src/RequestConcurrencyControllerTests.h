@@ -0,0 +1,26 @@
+//
+//  RequestConcurrencyControllerTests.h
+//  tests/networking/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_RequestConcurrencyControllerTests_h
+#define hifi_RequestConcurrencyControllerTests_h
+
+#include "RequestConcurrencyController.h"
+
+namespace RequestConcurrencyControllerTests {
+
+    void runAllTests();
+
+    void convergenceTest();
+    void unsaturatedTest();
+    void boundsTest();
+    void maxLimitTest();
+};
+
+#endif // hifi_RequestConcurrencyControllerTests_h
@@ -22,6 +22,7 @@ void SequenceNumberStatsTests::runAllTests() {
     duplicateTest();
     pruneTest();
     resyncTest();
+    throughputTest();
 }
 
 const quint32 UINT16_RANGE = std::numeric_limits<quint16>::max() + 1;
@@ -252,8 +253,9 @@ void SequenceNumberStatsTests::pruneTest() {
             numEarly++;
             numLost += 10;
 
-            const QSet<quint16>& missingSet = stats.getMissingSet();
+            const QSet<quint16> missingSet = stats.getMissingSet();
             assert(missingSet.size() <= 1000);
+            assert(missingSet.size() == stats.getMissingCount());
             if (missingSet.size() > 1000) {
                 qDebug() << "FAIL: missingSet larger than 1000.";
             }
@@ -322,3 +324,42 @@ void SequenceNumberStatsTests::resyncTest() {
     }
     assert(stats.getUnreasonable() == 0);
 }
+
+void SequenceNumberStatsTests::throughputTest() {
+
+    SequenceNumberStats stats;
+    quint16 seq = 0;
+    quint32 numSent = 0;
+
+    const int NUM_ITERATIONS = 100000;
+    const int RUN_LENGTH = 50;
+    const int SKIP_LENGTH = 5;
+
+    quint64 start = usecTimestampNow();
+    for (int T = 0; T < NUM_ITERATIONS; T++) {
+        // a run of on time packets, then a gap that is filled in late
+        for (int i = 0; i < RUN_LENGTH; i++) {
+            stats.sequenceNumberReceived(seq);
+            seq = seq + (quint16)1;
+            numSent++;
+        }
+        quint16 skipped = seq;
+        seq = seq + (quint16)SKIP_LENGTH;
+        stats.sequenceNumberReceived(seq);
+        seq = seq + (quint16)1;
+        numSent++;
+        for (int i = 0; i < SKIP_LENGTH; i++) {
+            stats.sequenceNumberReceived(skipped);
+            skipped = skipped + (quint16)1;
+            numSent++;
+        }
+    }
+    quint64 elapsed = usecTimestampNow() - start;
+
+    assert(stats.getReceived() == numSent);
+    assert(stats.getLost() == 0);
+    assert(stats.getMissingCount() == 0);
+
+    qDebug() << "SequenceNumberStats throughput:" << numSent << "packets in" << elapsed << "usecs ("
+        << ((double)elapsed * 1000.0 / numSent) << "nsecs per packet)";
+}
@@ -24,6 +24,7 @@ namespace SequenceNumberStatsTests {
     void duplicateTest();
     void pruneTest();
     void resyncTest();
+    void throughputTest();
 };
 
 #endif // hifi_SequenceNumberStatsTests_h
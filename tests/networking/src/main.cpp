@@ -8,11 +8,19 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include "AssetCacheTests.h"
+#include "NodeBandwidthShaperTests.h"
+#include "ReliableMessageChannelTests.h"
+#include "RequestConcurrencyControllerTests.h"
 #include "SequenceNumberStatsTests.h"
 #include <stdio.h>
 
 int main(int argc, char** argv) {
     SequenceNumberStatsTests::runAllTests();
+    ReliableMessageChannelTests::runAllTests();
+    NodeBandwidthShaperTests::runAllTests();
+    AssetCacheTests::runAllTests();
+    RequestConcurrencyControllerTests::runAllTests();
     printf("tests passed! press enter to exit");
     getchar();
     return 0;
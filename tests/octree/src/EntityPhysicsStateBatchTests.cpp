@@ -0,0 +1,367 @@
+//
+//  EntityPhysicsStateBatchTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QDebug>
+
+#include <EntityItemProperties.h>
+#include <EntityPhysicsStateBatch.h>
+#include <PacketHeaders.h>
+#include <SharedUtil.h>
+
+#include "EntityPhysicsStateBatchTests.h"
+
+const int TEST_MAX_PAYLOAD_BYTES = MAX_PACKET_SIZE - MAX_PACKET_HEADER_BYTES;
+
+static EntityPhysicsState makeTestState(int index, int tick) {
+    EntityPhysicsState state;
+    state.position = glm::vec3(100.0f + index * 0.37f, 10.0f + 0.02f * tick, 2000.0f - index * 0.11f);
+    float angle = 0.05f * tick + index;
+    state.rotation = glm::normalize(glm::quat(cosf(angle), 0.6f * sinf(angle), 0.8f * sinf(angle), 0.0f));
+    state.velocity = glm::vec3(0.5f, -3.25f + 0.01f * index, 1.0f);
+    state.angularVelocity = glm::vec3(0.0f, 2.0f, -0.5f);
+    state.isBallistic = true;
+    return state;
+}
+
+static bool statesMatch(const EntityPhysicsState& a, const EntityPhysicsState& b) {
+    const float MAX_POSITION_ERROR = 0.001f; // meters
+    const float MAX_VELOCITY_ERROR = 0.005f; // meters per second
+    const float MIN_ROTATION_DOT = 0.9999f;
+    return glm::length(a.position - b.position) < MAX_POSITION_ERROR
+        && glm::length(a.velocity - b.velocity) < MAX_VELOCITY_ERROR
+        && glm::length(a.angularVelocity - b.angularVelocity) < MAX_VELOCITY_ERROR
+        && fabsf(glm::dot(a.rotation, b.rotation)) > MIN_ROTATION_DOT
+        && a.isBallistic == b.isBallistic
+        && a.isReleasingOwnership == b.isReleasingOwnership;
+}
+
+static int totalSize(const std::vector<QByteArray>& payloads) {
+    int size = 0;
+    for (const QByteArray& payload : payloads) {
+        size += payload.size();
+    }
+    return size;
+}
+
+void EntityPhysicsStateBatchTests::batchTests(bool verbose) {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "EntityPhysicsStateBatchTests::batchTests()";
+
+    const int NUMBER_OF_ENTITIES = 200;
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    QVector<QUuid> entityIDs;
+    for (int i = 0; i < NUMBER_OF_ENTITIES; i++) {
+        entityIDs << QUuid::createUuid();
+    }
+
+    EntityPhysicsStateBatchWriter writer;
+    EntityPhysicsStateBatchReader reader;
+    int introductionBytes = 0;
+
+    {
+        testsTaken++;
+        QString testName = "first batches introduce every entity and round trip within quantization error";
+
+        for (int i = 0; i < NUMBER_OF_ENTITIES; i++) {
+            writer.queueState(entityIDs[i], makeTestState(i, 0));
+        }
+        std::vector<QByteArray> payloads = writer.takePayloads(TEST_MAX_PAYLOAD_BYTES);
+        introductionBytes = totalSize(payloads);
+
+        bool passed = !writer.hasQueuedStates();
+        int updateCount = 0;
+        for (const QByteArray& payload : payloads) {
+            passed = passed && payload.size() <= TEST_MAX_PAYLOAD_BYTES;
+            std::vector<EntityPhysicsStateBatchReader::Update> updates;
+            QByteArray ack;
+            passed = passed && reader.processPayload(payload, updates, ack);
+            for (const EntityPhysicsStateBatchReader::Update& update : updates) {
+                int index = entityIDs.indexOf(update.entityID);
+                passed = passed && index >= 0 && statesMatch(update.state, makeTestState(index, 0));
+            }
+            updateCount += updates.size();
+            writer.processAckPayload(ack);
+        }
+        passed = passed && updateCount == NUMBER_OF_ENTITIES;
+
+        if (verbose) {
+            qDebug() << "payloads=" << payloads.size() << "bytes=" << introductionBytes << "updates=" << updateCount;
+        }
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "once acked, bodies drop their IDs and are delta coded";
+
+        for (int i = 0; i < NUMBER_OF_ENTITIES; i++) {
+            writer.queueState(entityIDs[i], makeTestState(i, 1));
+        }
+        std::vector<QByteArray> payloads = writer.takePayloads(TEST_MAX_PAYLOAD_BYTES);
+        int deltaBytes = totalSize(payloads);
+
+        bool passed = deltaBytes * 4 < introductionBytes * 3;
+        int updateCount = 0;
+        for (const QByteArray& payload : payloads) {
+            std::vector<EntityPhysicsStateBatchReader::Update> updates;
+            QByteArray ack;
+            passed = passed && reader.processPayload(payload, updates, ack);
+            for (const EntityPhysicsStateBatchReader::Update& update : updates) {
+                int index = entityIDs.indexOf(update.entityID);
+                passed = passed && index >= 0 && statesMatch(update.state, makeTestState(index, 1));
+            }
+            updateCount += updates.size();
+            writer.processAckPayload(ack);
+        }
+        passed = passed && updateCount == NUMBER_OF_ENTITIES;
+
+        if (verbose) {
+            qDebug() << "introduction bytes=" << introductionBytes << "delta bytes=" << deltaBytes;
+        }
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "a lost batch is superseded and a late one is not applied over newer state";
+
+        const int ENTITY_INDEX = 7;
+        writer.queueState(entityIDs[ENTITY_INDEX], makeTestState(ENTITY_INDEX, 2));
+        std::vector<QByteArray> lostPayloads = writer.takePayloads(TEST_MAX_PAYLOAD_BYTES);
+
+        writer.queueState(entityIDs[ENTITY_INDEX], makeTestState(ENTITY_INDEX, 3));
+        std::vector<QByteArray> payloads = writer.takePayloads(TEST_MAX_PAYLOAD_BYTES);
+
+        std::vector<EntityPhysicsStateBatchReader::Update> updates;
+        QByteArray ack;
+        bool passed = lostPayloads.size() == 1 && payloads.size() == 1
+            && reader.processPayload(payloads[0], updates, ack)
+            && updates.size() == 1 && statesMatch(updates[0].state, makeTestState(ENTITY_INDEX, 3));
+        writer.processAckPayload(ack);
+
+        // the lost batch shows up after all
+        std::vector<EntityPhysicsStateBatchReader::Update> lateUpdates;
+        passed = passed && lostPayloads.size() == 1
+            && reader.processPayload(lostPayloads[0], lateUpdates, ack) && lateUpdates.empty();
+
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "states queued twice before a flush are sent once";
+
+        writer.queueState(entityIDs[0], makeTestState(0, 4));
+        writer.queueState(entityIDs[0], makeTestState(0, 5));
+        std::vector<QByteArray> payloads = writer.takePayloads(TEST_MAX_PAYLOAD_BYTES);
+
+        std::vector<EntityPhysicsStateBatchReader::Update> updates;
+        QByteArray ack;
+        bool passed = payloads.size() == 1 && reader.processPayload(payloads[0], updates, ack)
+            && updates.size() == 1 && statesMatch(updates[0].state, makeTestState(0, 5));
+
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "malformed payloads are rejected";
+
+        writer.queueState(entityIDs[1], makeTestState(1, 6));
+        std::vector<QByteArray> payloads = writer.takePayloads(TEST_MAX_PAYLOAD_BYTES);
+
+        std::vector<EntityPhysicsStateBatchReader::Update> updates;
+        QByteArray ack;
+        bool passed = payloads.size() == 1
+            && !reader.processPayload(payloads[0].left(payloads[0].size() - 1), updates, ack)
+            && !reader.processPayload(QByteArray(1, 0), updates, ack);
+
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "bodies a reader can't decode are not acked and go out in full again";
+
+        // a reader that never saw the batches introducing the entities, as if they were lost on the way
+        EntityPhysicsStateBatchReader freshReader;
+        const int ENTITY_INDEX = 3;
+        writer.queueState(entityIDs[ENTITY_INDEX], makeTestState(ENTITY_INDEX, 7));
+        std::vector<QByteArray> payloads = writer.takePayloads(TEST_MAX_PAYLOAD_BYTES);
+
+        std::vector<EntityPhysicsStateBatchReader::Update> updates;
+        QByteArray ack;
+        bool passed = payloads.size() == 1 && freshReader.processPayload(payloads[0], updates, ack)
+            && updates.empty();
+        writer.processAckPayload(ack);
+
+        writer.queueState(entityIDs[ENTITY_INDEX], makeTestState(ENTITY_INDEX, 8));
+        payloads = writer.takePayloads(TEST_MAX_PAYLOAD_BYTES);
+        passed = passed && payloads.size() == 1 && freshReader.processPayload(payloads[0], updates, ack)
+            && updates.size() == 1 && updates[0].entityID == entityIDs[ENTITY_INDEX]
+            && statesMatch(updates[0].state, makeTestState(ENTITY_INDEX, 8));
+        writer.processAckPayload(ack);
+
+        // and once that is acked the entity is delta coded against it
+        updates.clear();
+        writer.queueState(entityIDs[ENTITY_INDEX], makeTestState(ENTITY_INDEX, 9));
+        payloads = writer.takePayloads(TEST_MAX_PAYLOAD_BYTES);
+        passed = passed && payloads.size() == 1 && freshReader.processPayload(payloads[0], updates, ack)
+            && updates.size() == 1 && statesMatch(updates[0].state, makeTestState(ENTITY_INDEX, 9));
+
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "a late introduction doesn't take a handle back from the entity that has it now";
+
+        // the writer starts over, as it does when it runs out of handles, and gives handle 0 to a new entity
+        EntityPhysicsStateBatchWriter lateWriter;
+        EntityPhysicsStateBatchReader lateReader;
+        QUuid firstID = QUuid::createUuid();
+        QUuid secondID = QUuid::createUuid();
+        lateWriter.queueState(firstID, makeTestState(0, 0));
+        std::vector<QByteArray> latePayloads = lateWriter.takePayloads(TEST_MAX_PAYLOAD_BYTES);
+        lateWriter.reset();
+        lateWriter.queueState(secondID, makeTestState(1, 0));
+        std::vector<QByteArray> payloads = lateWriter.takePayloads(TEST_MAX_PAYLOAD_BYTES);
+
+        std::vector<EntityPhysicsStateBatchReader::Update> updates;
+        QByteArray ack;
+        bool passed = payloads.size() == 1 && lateReader.processPayload(payloads[0], updates, ack);
+        lateWriter.processAckPayload(ack);
+
+        // the batch from before the reset arrives after the one that followed it
+        std::vector<EntityPhysicsStateBatchReader::Update> lateUpdates;
+        passed = passed && latePayloads.size() == 1
+            && lateReader.processPayload(latePayloads[0], lateUpdates, ack) && lateUpdates.empty();
+
+        // bodies for the handle still belong to the second entity
+        updates.clear();
+        lateWriter.queueState(secondID, makeTestState(1, 1));
+        payloads = lateWriter.takePayloads(TEST_MAX_PAYLOAD_BYTES);
+        passed = passed && payloads.size() == 1 && lateReader.processPayload(payloads[0], updates, ack)
+            && updates.size() == 1 && updates[0].entityID == secondID
+            && statesMatch(updates[0].state, makeTestState(1, 1));
+
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+    if (testsFailed > 0) {
+        qDebug() << "   tests failed:" << testsFailed << "out of" << testsTaken;
+    }
+}
+
+void EntityPhysicsStateBatchTests::bandwidthComparison(bool verbose) {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "EntityPhysicsStateBatchTests::bandwidthComparison()";
+
+    // a pile of thrown blocks, all simulated by us, for a couple of seconds of updates
+    const int NUMBER_OF_ENTITIES = 100;
+    const int TICKS = 120;
+
+    QVector<QUuid> entityIDs;
+    for (int i = 0; i < NUMBER_OF_ENTITIES; i++) {
+        entityIDs << QUuid::createUuid();
+    }
+    QUuid simulatorID = QUuid::createUuid();
+
+    EntityPhysicsStateBatchWriter writer;
+    EntityPhysicsStateBatchReader reader;
+    int batchBytes = 0;
+    int batchDatagrams = 0;
+    int editBytes = 0;
+    unsigned char editBuffer[MAX_PACKET_SIZE];
+
+    for (int tick = 0; tick < TICKS; tick++) {
+        for (int i = 0; i < NUMBER_OF_ENTITIES; i++) {
+            EntityPhysicsState state = makeTestState(i, tick);
+            writer.queueState(entityIDs[i], state);
+
+            // only the physics properties, what sendUpdate packs today is a superset of this
+            EntityItemProperties properties;
+            properties.setPosition(state.position);
+            properties.setRotation(state.rotation);
+            properties.setVelocity(state.velocity);
+            properties.setAcceleration(glm::vec3(0.0f, -9.8f, 0.0f));
+            properties.setAngularVelocity(state.angularVelocity);
+            properties.setSimulatorID(simulatorID);
+            properties.setLastEdited(usecTimestampNow());
+            int editSize = 0;
+            EntityItemProperties::encodeEntityEditPacket(PacketTypeEntityEdit, EntityItemID(entityIDs[i]), properties,
+                                                         editBuffer, MAX_PACKET_SIZE, editSize);
+            editBytes += editSize;
+        }
+
+        std::vector<QByteArray> payloads = writer.takePayloads(TEST_MAX_PAYLOAD_BYTES);
+        for (const QByteArray& payload : payloads) {
+            batchBytes += payload.size();
+            batchDatagrams++;
+            std::vector<EntityPhysicsStateBatchReader::Update> updates;
+            QByteArray ack;
+            reader.processPayload(payload, updates, ack);
+            writer.processAckPayload(ack);
+        }
+    }
+
+    float ratio = (float)batchBytes / (float)editBytes;
+    qDebug() << "   edit message bytes:" << editBytes << "batch bytes:" << batchBytes
+        << "in" << batchDatagrams << "datagrams, ratio:" << ratio;
+
+    const float MAX_EXPECTED_RATIO = 0.5f;
+    if (ratio > MAX_EXPECTED_RATIO) {
+        qDebug() << "FAILED - batches are larger than expected compared to edit messages";
+    }
+}
+
+void EntityPhysicsStateBatchTests::runAllTests(bool verbose) {
+    batchTests(verbose);
+    bandwidthComparison(verbose);
+}
@@ -0,0 +1,20 @@
+//
+//  EntityPhysicsStateBatchTests.h
+//  tests/octree/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityPhysicsStateBatchTests_h
+#define hifi_EntityPhysicsStateBatchTests_h
+
+namespace EntityPhysicsStateBatchTests {
+    void batchTests(bool verbose);
+    void bandwidthComparison(bool verbose);
+    void runAllTests(bool verbose);
+}
+
+#endif // hifi_EntityPhysicsStateBatchTests_h
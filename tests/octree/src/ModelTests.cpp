@@ -14,13 +14,16 @@
 
 #include <QDebug>
 
+#include <EntityContainmentTracker.h>
 #include <EntityItem.h>
 #include <EntityTree.h>
 #include <EntityTreeElement.h>
+#include <MovingEntitiesOperator.h>
 #include <Octree.h>
 #include <OctreeConstants.h>
 #include <PropertyFlags.h>
 #include <SharedUtil.h>
+#include <SimpleEntitySimulation.h>
 
 //#include "EntityTests.h"
 #include "ModelTests.h" // needs to be EntityTests.h soon
@@ -505,7 +508,322 @@ void EntityTests::entityTreeTests(bool verbose) {
 }
 
 
+void EntityTests::moveEntitiesBenchmark(bool verbose) {
+    qDebug() << "EntityTests::moveEntitiesBenchmark()";
+
+    // seed the random number generator so that our tests are reproducible
+    srand(0xFEEDBEEF);
+
+    const int NUMBER_OF_ENTITIES = 50000;
+    const int TEST_ITERATIONS = 10;
+    const float MAX_STEP_PER_TICK = 0.5f; // meters, a bit faster than walking speed at 60Hz
+
+    EntityTree tree;
+    EntityItemProperties properties;
+    QVector<EntityItemPointer> entities;
+    for (int i = 0; i < NUMBER_OF_ENTITIES; i++) {
+        glm::vec3 randomPosition(randFloatInRange(1.0f, (float)TREE_SCALE - 1.0f),
+                                 randFloatInRange(1.0f, (float)TREE_SCALE - 1.0f),
+                                 randFloatInRange(1.0f, (float)TREE_SCALE - 1.0f));
+        properties.setPosition(randomPosition);
+        entities << tree.addEntity(EntityItemID(QUuid::createUuid()), properties);
+    }
+
+    // every entity moves every tick, the same moves are then sorted with a walk from the root and by subtree
+    quint64 totalElapsedFullWalk = 0;
+    quint64 totalElapsedSubTrees = 0;
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        bool useSubTrees = (i % 2) == 1;
+        foreach (EntityItemPointer entity, entities) {
+            glm::vec3 step(randFloatInRange(-MAX_STEP_PER_TICK, MAX_STEP_PER_TICK),
+                           randFloatInRange(-MAX_STEP_PER_TICK, MAX_STEP_PER_TICK),
+                           randFloatInRange(-MAX_STEP_PER_TICK, MAX_STEP_PER_TICK));
+            entity->setPosition(glm::clamp(entity->getPosition() + step, 1.0f, (float)TREE_SCALE - 1.0f));
+        }
+
+        quint64 start = usecTimestampNow();
+        MovingEntitiesOperator moveOperator(&tree);
+        foreach (EntityItemPointer entity, entities) {
+            moveOperator.addEntityToMoveList(entity, entity->getMaximumAACube());
+        }
+        if (useSubTrees) {
+            moveOperator.moveEntities();
+        } else if (moveOperator.hasMovingEntities()) {
+            tree.recurseTreeWithOperator(&moveOperator);
+        }
+        quint64 end = usecTimestampNow();
+
+        if (useSubTrees) {
+            totalElapsedSubTrees += (end - start);
+        } else {
+            totalElapsedFullWalk += (end - start);
+        }
+    }
+
+    int entitiesInBestFit = 0;
+    foreach (EntityItemPointer entity, entities) {
+        EntityTreeElement* containingElement = tree.getContainingElement(entity->getEntityItemID());
+        if (containingElement && containingElement == entity->getElement()
+                && containingElement->bestFitEntityBounds(entity)) {
+            entitiesInBestFit++;
+        }
+    }
+
+    if (verbose) {
+        qDebug() << "entitiesInBestFit=" << entitiesInBestFit << "getOctreeElementsCount()=" << tree.getOctreeElementsCount();
+    }
+    if (entitiesInBestFit != NUMBER_OF_ENTITIES) {
+        qDebug() << "FAILED - moveEntitiesBenchmark:" << (NUMBER_OF_ENTITIES - entitiesInBestFit)
+            << "entities are not in their best fit element";
+    }
+
+    float USECS_PER_MSECS = 1000.0f;
+    int ticksPerApproach = TEST_ITERATIONS / 2;
+    qDebug() << "TIME - moving" << NUMBER_OF_ENTITIES << "entities"
+        << "full walk=" << (float)totalElapsedFullWalk / USECS_PER_MSECS / ticksPerApproach << "msecs per tick"
+        << "subtrees=" << (float)totalElapsedSubTrees / USECS_PER_MSECS / ticksPerApproach << "msecs per tick";
+}
+
+// the way EntityTreeRenderer found the entities containing the avatar before it had an EntityContainmentTracker
+static QVector<EntityItemID> findEntitiesContaining(EntityTree& tree, const glm::vec3& position) {
+    QVector<EntityItemPointer> foundEntities;
+    QVector<EntityItemID> entitiesContaining;
+    tree.findEntities(position, 1.0f, foundEntities);
+    foreach (EntityItemPointer entity, foundEntities) {
+        if (entity->contains(position)) {
+            entitiesContaining << entity->getEntityItemID();
+        }
+    }
+    return entitiesContaining;
+}
+
+static bool sameEntities(const QVector<EntityItemID>& a, const QVector<EntityItemID>& b) {
+    return a.size() == b.size() && a.toList().toSet() == b.toList().toSet();
+}
+
+void EntityTests::containmentTrackerTests(bool verbose) {
+    int testsTaken = 0;
+    int testsPassed = 0;
+
+    qDebug() << "EntityTests::containmentTrackerTests()";
+
+    EntityTree tree;
+    EntityContainmentTracker tracker;
+    tracker.setTree(&tree);
+
+    glm::vec3 center((float)TREE_SCALE * 0.5f);
+    EntityItemProperties properties;
+    properties.setType(EntityTypes::Box);
+    properties.setDimensions(glm::vec3(4.0f));
+    properties.setPosition(center);
+    EntityItemPointer box = tree.addEntity(EntityItemID(QUuid::createUuid()), properties);
+
+    QVector<EntityItemID> entered;
+    QVector<EntityItemID> left;
+
+    testsTaken++;
+    tracker.update(center, entered, left);
+    if (entered.size() == 1 && entered[0] == box->getEntityItemID() && left.isEmpty()) {
+        testsPassed++;
+    } else {
+        qDebug() << "FAILED - Test" << testsTaken << ": entering a box, entered=" << entered.size() << "left=" << left.size();
+    }
+
+    testsTaken++;
+    int queriesBefore = tracker.getNumCandidateQueries();
+    bool changed = tracker.update(center, entered, left);
+    tracker.update(center + glm::vec3(0.5f), entered, left);
+    if (!changed && entered.isEmpty() && left.isEmpty() && tracker.getNumCandidateQueries() == queriesBefore) {
+        testsPassed++;
+    } else {
+        qDebug() << "FAILED - Test" << testsTaken << ": moving within a cell searched the tree"
+            << tracker.getNumCandidateQueries() - queriesBefore << "times";
+    }
+
+    // the box moves away from a standing avatar, the way it does when the entity server tells us it moved
+    testsTaken++;
+    box->setPosition(center + glm::vec3(100.0f));
+    tree.entityChanged(box);
+    tracker.update(center + glm::vec3(0.5f), entered, left);
+    if (entered.isEmpty() && left.size() == 1 && left[0] == box->getEntityItemID()) {
+        testsPassed++;
+    } else {
+        qDebug() << "FAILED - Test" << testsTaken << ": box moving away, entered=" << entered.size() << "left=" << left.size();
+    }
+
+    // and back, from outside the cell
+    testsTaken++;
+    box->setPosition(center);
+    tree.entityChanged(box);
+    tracker.update(center + glm::vec3(0.5f), entered, left);
+    if (entered.size() == 1 && left.isEmpty()) {
+        testsPassed++;
+    } else {
+        qDebug() << "FAILED - Test" << testsTaken << ": box moving back, entered=" << entered.size() << "left=" << left.size();
+    }
+
+    testsTaken++;
+    QVector<EntityItemID> wasInside = tracker.clear();
+    tracker.update(center + glm::vec3(0.5f), entered, left);
+    if (wasInside.size() == 1 && entered.size() == 1 && left.isEmpty()) {
+        testsPassed++;
+    } else {
+        qDebug() << "FAILED - Test" << testsTaken << ": entering again after clear(), entered=" << entered.size();
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
+
+void EntityTests::movingZoneTests(bool verbose) {
+    int testsTaken = 0;
+    int testsPassed = 0;
+
+    qDebug() << "EntityTests::movingZoneTests()";
+
+    // the simulation moves a kinematic zone within its element, so it's never re-sorted
+    EntityTree tree;
+    SimpleEntitySimulation simulation;
+    simulation.setEntityTree(&tree);
+    tree.setSimulation(&simulation);
+    EntityContainmentTracker tracker;
+    tracker.setTree(&tree);
+
+    glm::vec3 avatarPosition((float)TREE_SCALE * 0.5f);
+    EntityItemProperties properties;
+    properties.setType(EntityTypes::Box);
+    properties.setDimensions(glm::vec3(4.0f));
+    properties.setPosition(avatarPosition - glm::vec3(3.0f, 0.0f, 0.0f));
+    properties.setVelocity(glm::vec3(10.0f, 0.0f, 0.0f));
+    properties.setDamping(0.0f);
+    EntityItemPointer zone = tree.addEntity(EntityItemID(QUuid::createUuid()), properties);
+    EntityTreeElement* element = zone->getElement();
+
+    QVector<EntityItemID> entered;
+    QVector<EntityItemID> left;
+    tracker.update(avatarPosition, entered, left);
+
+    // the avatar stands still while the zone slides over it and on past
+    const quint64 TIMEOUT_USECS = USECS_PER_SECOND;
+    const int FRAME_USECS = 10000;
+    bool sawEnter = false;
+    bool sawLeave = false;
+    quint64 start = usecTimestampNow();
+    while (!sawLeave && usecTimestampNow() - start < TIMEOUT_USECS) {
+        usleep(FRAME_USECS);
+        tree.update();
+        tracker.update(avatarPosition, entered, left);
+        if (entered.contains(zone->getEntityItemID())) {
+            sawEnter = true;
+        }
+        if (sawEnter && left.contains(zone->getEntityItemID())) {
+            sawLeave = true;
+        }
+    }
+
+    testsTaken++;
+    if (sawEnter) {
+        testsPassed++;
+    } else {
+        qDebug() << "FAILED - Test" << testsTaken << ": the zone moved onto a standing avatar without an enter";
+    }
+
+    testsTaken++;
+    if (sawLeave) {
+        testsPassed++;
+    } else {
+        qDebug() << "FAILED - Test" << testsTaken << ": the zone moved off a standing avatar without a leave";
+    }
+
+    testsTaken++;
+    if (zone->getElement() == element) {
+        testsPassed++;
+    } else {
+        qDebug() << "FAILED - Test" << testsTaken << ": the zone left its element, so the test didn't cover moves within one";
+    }
+
+    tree.setSimulation(NULL);
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
+
+void EntityTests::enterLeaveBenchmark(bool verbose) {
+    qDebug() << "EntityTests::enterLeaveBenchmark()";
+
+    // seed the random number generator so that our tests are reproducible
+    srand(0xFEEDBEEF);
+
+    const int NUMBER_OF_SCATTERED_ENTITIES = 20000;
+    const int NUMBER_OF_NEARBY_ENTITIES = 2000; // zones, triggers and props around the avatar's path
+    const float NEARBY_RANGE = 64.0f;
+    const int NUMBER_OF_FRAMES = 3600;
+    const float STEP_PER_FRAME = 0.05f; // meters, walking speed at 60Hz
+
+    EntityTree tree;
+    EntityItemProperties properties;
+    properties.setType(EntityTypes::Box);
+    glm::vec3 center((float)TREE_SCALE * 0.5f);
+    for (int i = 0; i < NUMBER_OF_SCATTERED_ENTITIES + NUMBER_OF_NEARBY_ENTITIES; i++) {
+        float range = (i < NUMBER_OF_SCATTERED_ENTITIES) ? (float)TREE_SCALE * 0.5f - 16.0f : NEARBY_RANGE;
+        properties.setPosition(center + glm::vec3(randFloatInRange(-range, range), randFloatInRange(-1.0f, 1.0f),
+                                                  randFloatInRange(-range, range)));
+        properties.setDimensions(glm::vec3(randFloatInRange(1.0f, 12.0f)));
+        tree.addEntity(EntityItemID(QUuid::createUuid()), properties);
+    }
+
+    // the avatar wanders around the nearby entities, both approaches see the same positions
+    QVector<glm::vec3> path;
+    glm::vec3 avatarPosition = center;
+    glm::vec3 direction(1.0f, 0.0f, 0.0f);
+    for (int i = 0; i < NUMBER_OF_FRAMES; i++) {
+        if (i % 120 == 0) {
+            direction = glm::normalize(glm::vec3(randFloatInRange(-1.0f, 1.0f), 0.0f, randFloatInRange(-1.0f, 1.0f)));
+        }
+        avatarPosition = glm::clamp(avatarPosition + direction * STEP_PER_FRAME,
+                                    center - NEARBY_RANGE, center + NEARBY_RANGE);
+        path << avatarPosition;
+    }
+
+    QVector<QVector<EntityItemID> > expected;
+    quint64 start = usecTimestampNow();
+    foreach (const glm::vec3& position, path) {
+        expected << findEntitiesContaining(tree, position);
+    }
+    quint64 elapsedSearching = usecTimestampNow() - start;
+
+    EntityContainmentTracker tracker;
+    tracker.setTree(&tree);
+    QVector<EntityItemID> entered;
+    QVector<EntityItemID> left;
+    int framesMatching = 0;
+    quint64 elapsedTracking = 0;
+    for (int i = 0; i < path.size(); i++) {
+        start = usecTimestampNow();
+        tracker.update(path[i], entered, left);
+        elapsedTracking += usecTimestampNow() - start;
+        if (sameEntities(tracker.getEntitiesContaining(), expected[i])) {
+            framesMatching++;
+        }
+    }
+
+    if (verbose) {
+        qDebug() << "candidate queries=" << tracker.getNumCandidateQueries() << "for" << NUMBER_OF_FRAMES << "frames";
+    }
+    if (framesMatching != NUMBER_OF_FRAMES) {
+        qDebug() << "FAILED - enterLeaveBenchmark:" << (NUMBER_OF_FRAMES - framesMatching)
+            << "frames where the tracker disagrees with searching the tree";
+    }
+
+    float USECS_PER_MSECS = 1000.0f;
+    qDebug() << "TIME - finding the entities containing a walking avatar among"
+        << NUMBER_OF_SCATTERED_ENTITIES + NUMBER_OF_NEARBY_ENTITIES << "entities"
+        << "searching=" << (float)elapsedSearching / USECS_PER_MSECS / NUMBER_OF_FRAMES << "msecs per frame"
+        << "tracking=" << (float)elapsedTracking / USECS_PER_MSECS / NUMBER_OF_FRAMES << "msecs per frame";
+}
+
 void EntityTests::runAllTests(bool verbose) {
     entityTreeTests(verbose);
+    moveEntitiesBenchmark(verbose);
+    containmentTrackerTests(verbose);
+    movingZoneTests(verbose);
+    enterLeaveBenchmark(verbose);
 }
 
@@ -14,6 +14,10 @@
 
 namespace EntityTests {
     void entityTreeTests(bool verbose = false);
+    void moveEntitiesBenchmark(bool verbose = false);
+    void containmentTrackerTests(bool verbose = false);
+    void movingZoneTests(bool verbose = false);
+    void enterLeaveBenchmark(bool verbose = false);
     void runAllTests(bool verbose = false);
 }
 
@@ -0,0 +1,100 @@
+//
+//  ScriptEngineTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QDebug>
+#include <QThread>
+
+#include <ScriptEngine.h>
+
+#include "ScriptEngineTests.h"
+
+// runs program in an engine that has its own timer functions as the global "engine", then fires whatever came due
+static QString runTimerProgram(const QString& program, unsigned long msecsToWait) {
+    ScriptEngine engine;
+    engine.globalObject().setProperty("engine", engine.newQObject(&engine));
+    engine.evaluate("var fired = [];");
+    engine.evaluate(program);
+    QThread::msleep(msecsToWait);
+    engine.timerFired();
+    return engine.evaluate("fired.join(',')").toString();
+}
+
+void ScriptEngineTests::timerTests(bool verbose) {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "ScriptEngineTests::timerTests()";
+
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    const unsigned long MSECS_TO_WAIT = 20;
+
+    {
+        testsTaken++;
+        QString testName = "a timeout cleared by one that fires before it in the same pass doesn't fire";
+
+        QString fired = runTimerProgram(
+            "var second;"
+            "engine.setTimeout(function() { fired.push('first'); engine.clearTimeout(second); }, 0);"
+            "second = engine.setTimeout(function() { fired.push('second'); }, 1);", MSECS_TO_WAIT);
+
+        if (verbose) {
+            qDebug() << "fired:" << fired;
+        }
+        if (fired == "first") {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName) << "fired:" << fired;
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "an interval cleared by a timeout that fires before it in the same pass doesn't fire";
+
+        QString fired = runTimerProgram(
+            "var interval;"
+            "engine.setTimeout(function() { fired.push('timeout'); engine.clearInterval(interval); }, 0);"
+            "interval = engine.setInterval(function() { fired.push('interval'); }, 1);", MSECS_TO_WAIT);
+
+        if (fired == "timeout") {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName) << "fired:" << fired;
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "timeouts that aren't cleared all fire, in the order they came due";
+
+        QString fired = runTimerProgram(
+            "engine.setTimeout(function() { fired.push('second'); }, 2);"
+            "engine.setTimeout(function() { fired.push('first'); }, 0);", MSECS_TO_WAIT);
+
+        if (fired == "first,second") {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName) << "fired:" << fired;
+        }
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+    if (testsFailed > 0) {
+        qDebug() << "   tests failed:" << testsFailed << "out of" << testsTaken;
+    }
+}
+
+void ScriptEngineTests::runAllTests(bool verbose) {
+    timerTests(verbose);
+}
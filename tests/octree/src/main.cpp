@@ -9,8 +9,10 @@
 //
 
 #include "AABoxCubeTests.h"
+#include "EntityPhysicsStateBatchTests.h"
 #include "ModelTests.h" // needs to be EntityTests.h soon
 #include "OctreeTests.h"
+#include "ScriptEngineTests.h"
 #include "SharedUtil.h"
 
 int main(int argc, const char* argv[]) {
@@ -20,5 +22,7 @@ int main(int argc, const char* argv[]) {
     //OctreeTests::runAllTests(verbose);
     //AABoxCubeTests::runAllTests(verbose);
     EntityTests::runAllTests(verbose);
+    EntityPhysicsStateBatchTests::runAllTests(verbose);
+    ScriptEngineTests::runAllTests(verbose);
     return 0;
 }
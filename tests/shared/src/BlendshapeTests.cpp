@@ -0,0 +1,125 @@
+//
+//  BlendshapeTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cmath>
+
+#include <QDebug>
+#include <QVector>
+
+#include <GLMHelpers.h>
+
+#include "BlendshapeTests.h"
+
+void BlendshapeTests::runAllTests() {
+    addScaledOffsetsTests();
+}
+
+static float randomFloat() {
+    return (float)rand() / RAND_MAX;
+}
+
+static glm::vec3 randomVector() {
+    return glm::vec3(randomFloat(), randomFloat(), randomFloat()) * 2.0f - glm::vec3(1.0f);
+}
+
+// what Blender::blend did before, one offset at a time
+static void addScaledOffsetsInOrder(QVector<glm::vec3>& destination, const QVector<int>& indices,
+        const QVector<glm::vec3>& offsets, float scale) {
+    for (int i = 0; i < indices.size(); i++) {
+        destination[indices.at(i)] += offsets.at(i) * scale;
+    }
+}
+
+static float maxDifference(const QVector<glm::vec3>& first, const QVector<glm::vec3>& second) {
+    float difference = 0.0f;
+    for (int i = 0; i < first.size(); i++) {
+        for (int j = 0; j < 3; j++) {
+            difference = glm::max(difference, fabsf(first.at(i)[j] - second.at(i)[j]));
+        }
+    }
+    return difference;
+}
+
+void BlendshapeTests::addScaledOffsetsTests() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "BlendshapeTests::addScaledOffsetsTests()";
+
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    srand(1234);
+    const float TOLERANCE = 1.0e-6f;
+    const int NUMBER_OF_VERTICES = 100;
+    const int NUMBER_OF_OFFSETS = 250;
+    QVector<glm::vec3> base;
+    for (int i = 0; i < NUMBER_OF_VERTICES; i++) {
+        base.append(randomVector());
+    }
+
+    // offsets land on random vertices, repeats included, and on the first and last vertices
+    QVector<int> indices;
+    QVector<glm::vec3> offsets;
+    for (int i = 0; i < NUMBER_OF_OFFSETS; i++) {
+        indices.append(rand() % NUMBER_OF_VERTICES);
+        offsets.append(randomVector());
+    }
+    indices[0] = NUMBER_OF_VERTICES - 1;
+    indices[NUMBER_OF_OFFSETS / 2] = NUMBER_OF_VERTICES - 1;
+    indices[NUMBER_OF_OFFSETS - 1] = 0;
+
+    const float SCALE = 0.75f;
+    QVector<glm::vec3> expected = base;
+    addScaledOffsetsInOrder(expected, indices, offsets, SCALE);
+    QVector<glm::vec3> result = base;
+    addScaledOffsets(result.data(), result.size(), indices.constData(), offsets.constData(), indices.size(), SCALE);
+    testsTaken++;
+    float difference = maxDifference(result, expected);
+    if (difference < TOLERANCE) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": sums differ from one at a time by" << difference;
+    }
+
+    // vertices that no offset points at are left exactly as they were, neighbors of offset ones included
+    QVector<bool> isOffset(NUMBER_OF_VERTICES, false);
+    foreach (int index, indices) {
+        isOffset[index] = true;
+    }
+    bool untouchedMatch = true;
+    for (int i = 0; i < NUMBER_OF_VERTICES; i++) {
+        if (!isOffset.at(i) && result.at(i) != base.at(i)) {
+            untouchedMatch = false;
+        }
+    }
+    testsTaken++;
+    if (untouchedMatch) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": a vertex without offsets changed";
+    }
+
+    // a single offset, which is also the last one
+    result = base;
+    int lastIndex = NUMBER_OF_VERTICES / 2;
+    glm::vec3 lastOffset = randomVector();
+    addScaledOffsets(result.data(), result.size(), &lastIndex, &lastOffset, 1, SCALE);
+    testsTaken++;
+    if (glm::distance(result.at(lastIndex), base.at(lastIndex) + lastOffset * SCALE) < TOLERANCE) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": a single offset wasn't added";
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
@@ -0,0 +1,19 @@
+//
+//  BlendshapeTests.h
+//  tests/shared/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BlendshapeTests_h
+#define hifi_BlendshapeTests_h
+
+namespace BlendshapeTests {
+    void addScaledOffsetsTests();
+    void runAllTests();
+}
+
+#endif // hifi_BlendshapeTests_h
@@ -0,0 +1,104 @@
+//
+//  BoundedFileCacheTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QDebug>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <BoundedFileCache.h>
+
+#include "BoundedFileCacheTests.h"
+
+void BoundedFileCacheTests::runAllTests() {
+    evictionTests();
+}
+
+static void reportTest(int& testsTaken, int& testsPassed, bool passed, const char* testName) {
+    testsTaken++;
+    if (passed) {
+        testsPassed++;
+    } else {
+        qDebug() << "FAILED - Test" << testsTaken << ":" << testName;
+    }
+}
+
+static void writeFile(BoundedFileCache& cache, const QString& fileName, int size) {
+    QFile file(cache.getDirectory() + "/" + fileName);
+    file.open(QIODevice::WriteOnly);
+    file.write(QByteArray(size, 'x'));
+    file.close();
+    cache.insert(fileName, size);
+}
+
+static bool fileExists(const BoundedFileCache& cache, const QString& fileName) {
+    return QFile::exists(cache.getDirectory() + "/" + fileName);
+}
+
+void BoundedFileCacheTests::evictionTests() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "BoundedFileCacheTests::evictionTests()";
+
+    int testsTaken = 0;
+    int testsPassed = 0;
+
+    QTemporaryDir directory;
+    const int FILE_SIZE = 100;
+    const QString SUFFIX = ".baked";
+
+    {
+        BoundedFileCache cache(directory.path(), SUFFIX, 3 * FILE_SIZE);
+        writeFile(cache, "a.baked", FILE_SIZE);
+        writeFile(cache, "b.baked", FILE_SIZE);
+        writeFile(cache, "c.baked", FILE_SIZE);
+        bool passed = cache.getSize() == 3 * FILE_SIZE && cache.getFileCount() == 3;
+        reportTest(testsTaken, testsPassed, passed, "files up to the maximum size are all kept");
+
+        cache.touch("a.baked");
+        writeFile(cache, "d.baked", FILE_SIZE);
+        passed = cache.getSize() == 3 * FILE_SIZE && fileExists(cache, "a.baked") && !fileExists(cache, "b.baked")
+            && fileExists(cache, "c.baked") && fileExists(cache, "d.baked");
+        reportTest(testsTaken, testsPassed, passed, "the least recently used file is removed to make room");
+
+        writeFile(cache, "c.baked", 2 * FILE_SIZE);
+        passed = cache.getSize() == 3 * FILE_SIZE && !fileExists(cache, "a.baked") && fileExists(cache, "c.baked")
+            && fileExists(cache, "d.baked");
+        reportTest(testsTaken, testsPassed, passed, "rewriting a file counts its new size once");
+
+        cache.remove("d.baked");
+        passed = cache.getSize() == 2 * FILE_SIZE && cache.getFileCount() == 1 && !fileExists(cache, "d.baked");
+        reportTest(testsTaken, testsPassed, passed, "removed files stop counting");
+
+        writeFile(cache, "huge.baked", 10 * FILE_SIZE);
+        passed = cache.getFileCount() == 1 && fileExists(cache, "huge.baked");
+        reportTest(testsTaken, testsPassed, passed, "a file bigger than the maximum is kept until the next one");
+    }
+
+    {
+        // other files in the directory aren't ours to count or remove
+        QFile other(directory.path() + "/other.texture");
+        other.open(QIODevice::WriteOnly);
+        other.write(QByteArray(FILE_SIZE, 'x'));
+        other.close();
+
+        BoundedFileCache cache(directory.path(), SUFFIX, 5 * FILE_SIZE);
+        bool passed = cache.getFileCount() == 1 && cache.getSize() == 10 * FILE_SIZE;
+        reportTest(testsTaken, testsPassed, passed, "files already on disk are found, only those with the suffix");
+
+        writeFile(cache, "e.baked", FILE_SIZE);
+        passed = !fileExists(cache, "huge.baked") && fileExists(cache, "e.baked") && other.exists();
+        reportTest(testsTaken, testsPassed, passed, "files found on disk are evicted like the others");
+
+        cache.setMaximumSize(0);
+        passed = cache.getFileCount() == 1;
+        reportTest(testsTaken, testsPassed, passed, "lowering the maximum evicts all but the last file used");
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
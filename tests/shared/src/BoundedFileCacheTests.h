@@ -0,0 +1,19 @@
+//
+//  BoundedFileCacheTests.h
+//  tests/shared/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BoundedFileCacheTests_h
+#define hifi_BoundedFileCacheTests_h
+
+namespace BoundedFileCacheTests {
+    void evictionTests();
+    void runAllTests();
+}
+
+#endif // hifi_BoundedFileCacheTests_h
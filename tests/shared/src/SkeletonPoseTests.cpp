@@ -0,0 +1,271 @@
+//
+//  SkeletonPoseTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cmath>
+
+#include <glm/gtx/transform.hpp>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <GLMHelpers.h>
+
+#include "SkeletonPoseTests.h"
+
+void SkeletonPoseTests::runAllTests() {
+    multiplyTests();
+    poseBenchmark();
+}
+
+static float randomFloat() {
+    return (float)rand() / RAND_MAX;
+}
+
+static glm::vec3 randomVector() {
+    return glm::vec3(randomFloat(), randomFloat(), randomFloat()) * 2.0f - glm::vec3(1.0f);
+}
+
+static glm::quat randomRotation() {
+    return glm::normalize(glm::quat(randomFloat() * 2.0f - 1.0f, randomVector()));
+}
+
+static glm::mat4 randomAffineTransform() {
+    return glm::translate(randomVector()) * glm::mat4_cast(randomRotation());
+}
+
+// the largest difference between corresponding elements, relative to their size where that's over one
+static float maxDifference(const glm::mat4& first, const glm::mat4& second) {
+    float difference = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            float scale = glm::max(1.0f, glm::max(fabsf(first[i][j]), fabsf(second[i][j])));
+            difference = glm::max(difference, fabsf(first[i][j] - second[i][j]) / scale);
+        }
+    }
+    return difference;
+}
+
+void SkeletonPoseTests::multiplyTests() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "SkeletonPoseTests::multiplyTests()";
+
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    srand(1234);
+    const float TOLERANCE = 1.0e-6f;
+    const int NUMBER_OF_PRODUCTS = 100;
+    float worstDifference = 0.0f;
+    for (int i = 0; i < NUMBER_OF_PRODUCTS; i++) {
+        glm::mat4 left = randomAffineTransform();
+        glm::mat4 right = randomAffineTransform();
+        glm::mat4 result;
+        multiplyMatrices(left, right, result);
+        worstDifference = glm::max(worstDifference, maxDifference(result, left * right));
+    }
+    testsTaken++;
+    if (worstDifference < TOLERANCE) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": products differ from glm's by" << worstDifference;
+    }
+
+    // the result may be either operand
+    glm::mat4 left = randomAffineTransform();
+    glm::mat4 right = randomAffineTransform();
+    glm::mat4 expected = left * right;
+    glm::mat4 result = left;
+    multiplyMatrices(result, right, result);
+    testsTaken++;
+    if (maxDifference(result, expected) < TOLERANCE) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": writing the product over the left operand changed it";
+    }
+
+    result = right;
+    multiplyMatrices(left, result, result);
+    testsTaken++;
+    if (maxDifference(result, expected) < TOLERANCE) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": writing the product over the right operand changed it";
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
+
+namespace {
+
+// the parts of FBXJoint and FBXCluster that go into posing a skinned model
+class Joint {
+public:
+    int parentIndex;
+    glm::vec3 translation;
+    glm::mat4 preTransform;
+    glm::quat preRotation;
+    glm::quat rotation;
+    glm::quat postRotation;
+    glm::mat4 postTransform;
+};
+
+class Cluster {
+public:
+    int jointIndex;
+    glm::mat4 inverseBindMatrix;
+};
+
+class Skeleton {
+public:
+    QVector<Joint> joints;
+    QVector<Cluster> clusters;
+    QVector<glm::mat4> transforms;
+    QVector<glm::mat4> rotatedTransforms;
+    QVector<glm::mat4> clusterMatrices;
+};
+
+}
+
+static Skeleton createSkeleton(int numberOfJoints, int numberOfClusters) {
+    Skeleton skeleton;
+    for (int i = 0; i < numberOfJoints; i++) {
+        // parents come before their children, as in FBXGeometry
+        Joint joint;
+        joint.parentIndex = (i == 0) ? -1 : rand() % i;
+        joint.translation = randomVector();
+        joint.preTransform = randomAffineTransform();
+        joint.preRotation = randomRotation();
+        joint.rotation = randomRotation();
+        joint.postRotation = randomRotation();
+        joint.postTransform = randomAffineTransform();
+        skeleton.joints.append(joint);
+    }
+    for (int i = 0; i < numberOfClusters; i++) {
+        Cluster cluster;
+        cluster.jointIndex = rand() % numberOfJoints;
+        cluster.inverseBindMatrix = randomAffineTransform();
+        skeleton.clusters.append(cluster);
+    }
+    skeleton.transforms.resize(numberOfJoints);
+    skeleton.rotatedTransforms.resize(numberOfJoints);
+    skeleton.clusterMatrices.resize(numberOfClusters);
+    return skeleton;
+}
+
+// what JointState::computeTransform and Model::simulateInternal did before, all with glm's operators
+static void poseWithOperators(Skeleton& skeleton, const glm::mat4& rootTransform, const glm::mat4& modelToWorld) {
+    for (int i = 0; i < skeleton.joints.size(); i++) {
+        const Joint& joint = skeleton.joints.at(i);
+        const glm::mat4& parentTransform = (joint.parentIndex == -1) ? rootTransform :
+            skeleton.transforms.at(joint.parentIndex);
+        glm::quat rotationInParentFrame = joint.preRotation * joint.rotation * joint.postRotation;
+        glm::mat4 transformInParentFrame = joint.preTransform * glm::mat4_cast(rotationInParentFrame) *
+            joint.postTransform;
+        skeleton.transforms[i] = parentTransform * glm::translate(joint.translation) * transformInParentFrame;
+    }
+    for (int i = 0; i < skeleton.clusters.size(); i++) {
+        const Cluster& cluster = skeleton.clusters.at(i);
+        skeleton.clusterMatrices[i] = modelToWorld * skeleton.transforms.at(cluster.jointIndex) *
+            cluster.inverseBindMatrix;
+    }
+}
+
+// what they do now
+static void poseWithHelpers(Skeleton& skeleton, const glm::mat4& rootTransform, const glm::mat4& modelToWorld) {
+    for (int i = 0; i < skeleton.joints.size(); i++) {
+        const Joint& joint = skeleton.joints.at(i);
+        const glm::mat4& parentTransform = (joint.parentIndex == -1) ? rootTransform :
+            skeleton.transforms.at(joint.parentIndex);
+        glm::quat rotationInParentFrame = joint.preRotation * joint.rotation * joint.postRotation;
+        glm::mat4 transformInParentFrame;
+        multiplyMatrices(joint.preTransform, glm::mat4_cast(rotationInParentFrame), transformInParentFrame);
+        multiplyMatrices(transformInParentFrame, joint.postTransform, transformInParentFrame);
+        transformInParentFrame[3] += glm::vec4(joint.translation, 0.0f);
+        multiplyMatrices(parentTransform, transformInParentFrame, skeleton.transforms[i]);
+    }
+    for (int i = 0; i < skeleton.joints.size(); i++) {
+        multiplyMatrices(modelToWorld, skeleton.transforms.at(i), skeleton.rotatedTransforms[i]);
+    }
+    for (int i = 0; i < skeleton.clusters.size(); i++) {
+        const Cluster& cluster = skeleton.clusters.at(i);
+        multiplyMatrices(skeleton.rotatedTransforms.at(cluster.jointIndex), cluster.inverseBindMatrix,
+            skeleton.clusterMatrices[i]);
+    }
+}
+
+void SkeletonPoseTests::poseBenchmark() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "SkeletonPoseTests::poseBenchmark()";
+
+    // a crowd of avatars about the size of the default ones, each with a single skinned mesh
+    srand(1234);
+    const int NUMBER_OF_SKELETONS = 100;
+    const int JOINTS_PER_SKELETON = 60;
+    const int CLUSTERS_PER_SKELETON = 50;
+    QVector<Skeleton> skeletons;
+    for (int i = 0; i < NUMBER_OF_SKELETONS; i++) {
+        skeletons.append(createSkeleton(JOINTS_PER_SKELETON, CLUSTERS_PER_SKELETON));
+    }
+    glm::mat4 rootTransform = glm::scale(glm::vec3(0.01f)) * randomAffineTransform();
+    glm::mat4 modelToWorld = glm::mat4_cast(randomRotation());
+
+    // the two should pose the crowd the same way, give or take rounding
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+    const float TOLERANCE = 1.0e-4f;
+    float worstDifference = 0.0f;
+    for (int i = 0; i < NUMBER_OF_SKELETONS; i++) {
+        Skeleton& skeleton = skeletons[i];
+        poseWithOperators(skeleton, rootTransform, modelToWorld);
+        QVector<glm::mat4> expected = skeleton.clusterMatrices;
+        poseWithHelpers(skeleton, rootTransform, modelToWorld);
+        for (int j = 0; j < expected.size(); j++) {
+            worstDifference = glm::max(worstDifference, maxDifference(skeleton.clusterMatrices.at(j), expected.at(j)));
+        }
+    }
+    testsTaken++;
+    if (worstDifference < TOLERANCE) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": cluster matrices differ by" << worstDifference;
+    }
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+
+    const int NUMBER_OF_FRAMES = 100;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < NUMBER_OF_FRAMES; i++) {
+        for (int j = 0; j < NUMBER_OF_SKELETONS; j++) {
+            poseWithOperators(skeletons[j], rootTransform, modelToWorld);
+        }
+    }
+    qint64 operatorsNSecs = timer.nsecsElapsed();
+
+    timer.restart();
+    for (int i = 0; i < NUMBER_OF_FRAMES; i++) {
+        for (int j = 0; j < NUMBER_OF_SKELETONS; j++) {
+            poseWithHelpers(skeletons[j], rootTransform, modelToWorld);
+        }
+    }
+    qint64 helpersNSecs = timer.nsecsElapsed();
+
+    const float NSECS_PER_MSEC = 1000000.0f;
+    qDebug() << "skeletons=" << NUMBER_OF_SKELETONS << "joints=" << JOINTS_PER_SKELETON
+        << "clusters=" << CLUSTERS_PER_SKELETON;
+    qDebug() << "TIME - per frame: operators=" << operatorsNSecs / NSECS_PER_MSEC / NUMBER_OF_FRAMES << "msecs"
+        << "helpers=" << helpersNSecs / NSECS_PER_MSEC / NUMBER_OF_FRAMES << "msecs";
+}
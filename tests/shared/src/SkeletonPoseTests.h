@@ -0,0 +1,20 @@
+//
+//  SkeletonPoseTests.h
+//  tests/shared/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SkeletonPoseTests_h
+#define hifi_SkeletonPoseTests_h
+
+namespace SkeletonPoseTests {
+    void multiplyTests();
+    void poseBenchmark();
+    void runAllTests();
+}
+
+#endif // hifi_SkeletonPoseTests_h
@@ -0,0 +1,211 @@
+//
+//  TimerQueueTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <TimerQueue.h>
+
+#include "TimerQueueTests.h"
+
+void TimerQueueTests::runAllTests() {
+    queueTests();
+    stressTest();
+}
+
+static void reportTest(int& testsTaken, int& testsPassed, bool passed, const char* testName) {
+    testsTaken++;
+    if (passed) {
+        testsPassed++;
+    } else {
+        qDebug() << "FAILED - Test" << testsTaken << ":" << testName;
+    }
+}
+
+void TimerQueueTests::queueTests() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "TimerQueueTests::queueTests()";
+
+    int testsTaken = 0;
+    int testsPassed = 0;
+
+    {
+        TimerQueue queue;
+        TimerQueue::TimerID late = queue.addTimer(0, 30, true);
+        TimerQueue::TimerID first = queue.addTimer(0, 10, true);
+        TimerQueue::TimerID second = queue.addTimer(0, 10, true);
+        TimerQueue::TimerID early = queue.addTimer(5, 0, true);
+
+        std::vector<TimerQueue::TimerID> due;
+        queue.takeDueTimers(10, due);
+        bool passed = due.size() == 3 && due[0] == early && due[1] == first && due[2] == second
+            && queue.size() == 1 && queue.getNextDueTime() == 30 && queue.hasTimer(late) && !queue.hasTimer(first);
+        reportTest(testsTaken, testsPassed, passed, "timers come due earliest first, ties in the order they were added");
+    }
+
+    {
+        TimerQueue queue;
+        TimerQueue::TimerID cleared = queue.addTimer(0, 10, true);
+        TimerQueue::TimerID kept = queue.addTimer(0, 20, true);
+        bool passed = queue.removeTimer(cleared) && !queue.removeTimer(cleared) && queue.getNextDueTime() == 20;
+
+        std::vector<TimerQueue::TimerID> due;
+        queue.takeDueTimers(100, due);
+        passed = passed && due.size() == 1 && due[0] == kept && queue.isEmpty() && !queue.removeTimer(kept);
+        reportTest(testsTaken, testsPassed, passed, "cleared timers never come due, spent ones cannot be cleared");
+    }
+
+    {
+        TimerQueue queue;
+        TimerQueue::TimerID interval = queue.addTimer(0, 10, false);
+        TimerQueue::TimerID spinning = queue.addTimer(0, 0, false);
+
+        std::vector<TimerQueue::TimerID> due;
+        queue.takeDueTimers(0, due);
+        bool passed = due.size() == 1 && due[0] == spinning;
+
+        due.clear();
+        queue.takeDueTimers(35, due);
+        // the interval fell behind, it fires once now and is next due one interval later
+        passed = passed && due.size() == 2 && due[0] == spinning && due[1] == interval;
+        passed = passed && queue.getNextDueTime() == 35;
+        queue.removeTimer(spinning);
+        passed = passed && queue.getNextDueTime() == 45 && queue.size() == 1;
+        reportTest(testsTaken, testsPassed, passed, "intervals are rescheduled and a zero interval comes due once per call");
+    }
+
+    {
+        TimerQueue queue;
+        std::vector<TimerQueue::TimerID> timers;
+        for (int i = 0; i < 1000; i++) {
+            timers.push_back(queue.addTimer(0, 1000 + i, true));
+        }
+        for (int i = 0; i < 999; i++) {
+            queue.removeTimer(timers[i]);
+        }
+        std::vector<TimerQueue::TimerID> due;
+        queue.takeDueTimers(10000, due);
+        bool passed = due.size() == 1 && due[0] == timers[999] && queue.isEmpty();
+        reportTest(testsTaken, testsPassed, passed, "clearing most timers leaves the last one due");
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
+
+void TimerQueueTests::stressTest() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "TimerQueueTests::stressTest()";
+
+    const int NUMBER_OF_TIMERS = 10000;
+    const int MAX_INTERVAL_MSECS = 1000;
+    const qint64 TICK_MSECS = 16;
+    const qint64 TEST_MSECS = 5000;
+
+    int testsTaken = 0;
+    int testsPassed = 0;
+
+    // what each timer should do, as a script would see it
+    class ExpectedTimer {
+    public:
+        TimerQueue::TimerID timerID;
+        int intervalMSecs;
+        bool isSingleShot;
+        bool isCleared;
+        qint64 nextDueTime;
+        int numFired;
+        int expectedNumFired;
+    };
+
+    srand(1234);
+    TimerQueue queue;
+    std::vector<ExpectedTimer> expected(NUMBER_OF_TIMERS);
+    QHash<TimerQueue::TimerID, int> indexForTimer;
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    for (int i = 0; i < NUMBER_OF_TIMERS; i++) {
+        ExpectedTimer& timer = expected[i];
+        timer.intervalMSecs = rand() % MAX_INTERVAL_MSECS;
+        timer.isSingleShot = (rand() % 4) != 0;
+        timer.isCleared = false;
+        timer.numFired = 0;
+        timer.expectedNumFired = 0;
+        timer.nextDueTime = timer.intervalMSecs;
+        timer.timerID = queue.addTimer(0, timer.intervalMSecs, timer.isSingleShot);
+        indexForTimer[timer.timerID] = i;
+    }
+    qint64 addMSecs = elapsed.elapsed();
+
+    bool firedOnTime = true;
+    bool firedInOrder = true;
+    int maxBatchSize = 0;
+    qint64 takeMSecs = 0;
+    std::vector<TimerQueue::TimerID> due;
+
+    for (qint64 now = TICK_MSECS; now <= TEST_MSECS; now += TICK_MSECS) {
+        due.clear();
+        elapsed.restart();
+        queue.takeDueTimers(now, due);
+        takeMSecs += elapsed.elapsed();
+        maxBatchSize = std::max(maxBatchSize, (int)due.size());
+
+        // every live timer whose time has come fires in this tick, and only those
+        for (ExpectedTimer& timer : expected) {
+            if (!timer.isCleared && timer.nextDueTime <= now && (timer.isSingleShot ? timer.expectedNumFired == 0 : true)) {
+                timer.expectedNumFired++;
+                timer.nextDueTime = timer.isSingleShot ? TEST_MSECS * 2 : now + timer.intervalMSecs;
+            }
+        }
+
+        qint64 lastDueTime = 0;
+        for (TimerQueue::TimerID timerID : due) {
+            ExpectedTimer& timer = expected[indexForTimer.value(timerID)];
+            timer.numFired++;
+            firedOnTime = firedOnTime && timer.numFired == timer.expectedNumFired;
+
+            // this tick's timers come out earliest first
+            qint64 dueTime = timer.isSingleShot ? timer.intervalMSecs : 0;
+            firedInOrder = firedInOrder && (!timer.isSingleShot || dueTime >= lastDueTime);
+            if (timer.isSingleShot) {
+                lastDueTime = dueTime;
+            }
+        }
+
+        // a script clearing a few of its timers every frame
+        for (int i = 0; i < 8; i++) {
+            ExpectedTimer& timer = expected[rand() % NUMBER_OF_TIMERS];
+            if (!timer.isCleared) {
+                timer.isCleared = true;
+                queue.removeTimer(timer.timerID);
+            }
+        }
+    }
+
+    bool allFired = true;
+    int numSingleShotsLeft = 0;
+    for (const ExpectedTimer& timer : expected) {
+        allFired = allFired && timer.numFired == timer.expectedNumFired;
+        if (timer.isSingleShot && !timer.isCleared && timer.numFired == 0) {
+            numSingleShotsLeft++;
+        }
+    }
+
+    qDebug() << "timers=" << NUMBER_OF_TIMERS << "add msecs=" << addMSecs << "take msecs=" << takeMSecs
+        << "ticks=" << TEST_MSECS / TICK_MSECS << "largest batch=" << maxBatchSize;
+
+    reportTest(testsTaken, testsPassed, firedOnTime && allFired,
+               "every timer fires in the first tick it is due, as often as it should");
+    reportTest(testsTaken, testsPassed, firedInOrder, "single shot timers due in one tick fire earliest first");
+    reportTest(testsTaken, testsPassed, numSingleShotsLeft == 0 && queue.size() <= NUMBER_OF_TIMERS,
+               "no single shot timer is left behind");
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
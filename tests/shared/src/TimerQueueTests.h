@@ -0,0 +1,20 @@
+//
+//  TimerQueueTests.h
+//  tests/shared/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_TimerQueueTests_h
+#define hifi_TimerQueueTests_h
+
+namespace TimerQueueTests {
+    void queueTests();
+    void stressTest();
+    void runAllTests();
+}
+
+#endif // hifi_TimerQueueTests_h
@@ -0,0 +1,219 @@
+//
+//  TriangleBVHTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cfloat>
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <NumericalConstants.h>
+#include <TriangleBVH.h>
+
+#include "TriangleBVHTests.h"
+
+void TriangleBVHTests::runAllTests() {
+    pickTests();
+    pickBenchmark();
+}
+
+static float randomFloat() {
+    return (float)rand() / RAND_MAX;
+}
+
+static glm::vec3 randomVector() {
+    return glm::vec3(randomFloat(), randomFloat(), randomFloat());
+}
+
+// what Model did before, every triangle in turn
+static bool findRayIntersectionByTesting(const QVector<Triangle>& triangles, const QVector<int>& tags,
+                                         const glm::vec3& origin, const glm::vec3& direction, float& distance, int& tag) {
+    float bestDistance = FLT_MAX;
+    int bestTriangle = -1;
+    for (int i = 0; i < triangles.size(); i++) {
+        float triangleDistance;
+        if (findRayTriangleIntersection(origin, direction, triangles.at(i), triangleDistance) &&
+                triangleDistance < bestDistance) {
+            bestDistance = triangleDistance;
+            bestTriangle = i;
+        }
+    }
+    if (bestTriangle == -1) {
+        return false;
+    }
+    distance = bestDistance;
+    tag = tags.at(bestTriangle);
+    return true;
+}
+
+// a high poly model: a sphere of slices * stacks quads, each split in two
+static void createSphere(int slices, int stacks, float radius, QVector<Triangle>& triangles, QVector<int>& tags) {
+    for (int i = 0; i < stacks; i++) {
+        float pitch0 = PI * i / stacks - PI_OVER_TWO;
+        float pitch1 = PI * (i + 1) / stacks - PI_OVER_TWO;
+        for (int j = 0; j < slices; j++) {
+            float yaw0 = TWO_PI * j / slices;
+            float yaw1 = TWO_PI * (j + 1) / slices;
+            glm::vec3 v00 = radius * glm::vec3(cosf(pitch0) * cosf(yaw0), sinf(pitch0), cosf(pitch0) * sinf(yaw0));
+            glm::vec3 v01 = radius * glm::vec3(cosf(pitch0) * cosf(yaw1), sinf(pitch0), cosf(pitch0) * sinf(yaw1));
+            glm::vec3 v10 = radius * glm::vec3(cosf(pitch1) * cosf(yaw0), sinf(pitch1), cosf(pitch1) * sinf(yaw0));
+            glm::vec3 v11 = radius * glm::vec3(cosf(pitch1) * cosf(yaw1), sinf(pitch1), cosf(pitch1) * sinf(yaw1));
+            Triangle first = { v00, v10, v11 };
+            Triangle second = { v00, v11, v01 };
+            triangles << first << second;
+            tags << i << i;
+        }
+    }
+}
+
+void TriangleBVHTests::pickTests() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "TriangleBVHTests::pickTests()";
+
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    srand(1234);
+
+    testsTaken++;
+    {
+        TriangleBVH triangleBVH;
+        triangleBVH.build(QVector<Triangle>());
+        float distance;
+        int tag;
+        if (!triangleBVH.findRayIntersection(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f), distance, tag)) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": an empty hierarchy was hit";
+        }
+    }
+
+    // a soup of random triangles, with a pile of identical ones that can't be split apart
+    QVector<Triangle> triangles;
+    QVector<int> tags;
+    const int NUMBER_OF_TRIANGLES = 20000;
+    const float SOUP_SIZE = 100.0f;
+    for (int i = 0; i < NUMBER_OF_TRIANGLES; i++) {
+        glm::vec3 corner = randomVector() * SOUP_SIZE;
+        Triangle triangle = { corner, corner + randomVector(), corner + randomVector() };
+        triangles << triangle;
+        tags << i;
+    }
+    const int NUMBER_OF_COINCIDENT_TRIANGLES = 100;
+    for (int i = 0; i < NUMBER_OF_COINCIDENT_TRIANGLES; i++) {
+        glm::vec3 corner(SOUP_SIZE * 0.5f);
+        Triangle triangle = { corner, corner + glm::vec3(1.0f, 0.0f, 0.0f), corner + glm::vec3(0.0f, 1.0f, 0.0f) };
+        triangles << triangle;
+        tags << NUMBER_OF_TRIANGLES;
+    }
+    TriangleBVH triangleBVH;
+    triangleBVH.build(triangles, tags);
+
+    testsTaken++;
+    if (triangleBVH.getTriangleCount() == triangles.size() && triangleBVH.getNodeCount() > 1) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": triangles=" << triangleBVH.getTriangleCount()
+            << "nodes=" << triangleBVH.getNodeCount();
+    }
+
+    // rays from either side, some along the axes, which cross the boxes' planes head on, must find what testing every
+    // triangle finds; triangles facing away from the ray are missed either way
+    testsTaken++;
+    const int NUMBER_OF_RAYS = 1000;
+    int numberOfHits = 0;
+    int numberOfMismatches = 0;
+    for (int i = 0; i < NUMBER_OF_RAYS; i++) {
+        bool fromBelow = (i % 2) == 0;
+        glm::vec3 origin(randomFloat() * SOUP_SIZE, randomFloat() * SOUP_SIZE, fromBelow ? -1.0f : SOUP_SIZE + 1.0f);
+        glm::vec3 direction(randomFloat() - 0.5f, randomFloat() - 0.5f, fromBelow ? 1.0f : -1.0f);
+        if (i % 10 == 0) {
+            direction = glm::vec3(0.0f, 0.0f, fromBelow ? 1.0f : -1.0f);
+        }
+        if (i % 100 == 0) {
+            origin = glm::vec3(SOUP_SIZE * 0.5f + 0.25f, SOUP_SIZE * 0.5f + 0.25f, -1.0f);
+        }
+        float expectedDistance = 0.0f, distance = 0.0f;
+        int expectedTag = -1, tag = -1;
+        bool expectedHit = findRayIntersectionByTesting(triangles, tags, origin, direction, expectedDistance, expectedTag);
+        bool hit = triangleBVH.findRayIntersection(origin, direction, distance, tag);
+        if (hit != expectedHit || (hit && (distance != expectedDistance || tag != expectedTag))) {
+            numberOfMismatches++;
+        }
+        if (hit) {
+            numberOfHits++;
+        }
+    }
+    if (numberOfMismatches == 0 && numberOfHits > 0) {
+        testsPassed++;
+    } else {
+        testsFailed++;
+        qDebug() << "FAILED - Test" << testsTaken << ": mismatches=" << numberOfMismatches << "hits=" << numberOfHits;
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
+
+void TriangleBVHTests::pickBenchmark() {
+    qDebug() << "******************************************************************************************";
+    qDebug() << "TriangleBVHTests::pickBenchmark()";
+
+    const int SLICES = 512;
+    const int STACKS = 256;
+    const float RADIUS = 1.0f;
+    QVector<Triangle> triangles;
+    QVector<int> tags;
+    createSphere(SLICES, STACKS, RADIUS, triangles, tags);
+
+    QElapsedTimer timer;
+    timer.start();
+    TriangleBVH triangleBVH;
+    triangleBVH.build(triangles, tags);
+    qint64 buildNSecs = timer.nsecsElapsed();
+
+    // picks from all around, at points on or near the sphere, as the edit tools would make
+    srand(1234);
+    const int NUMBER_OF_PICKS = 200;
+    const float EYE_DISTANCE = 5.0f;
+    QVector<glm::vec3> origins, directions;
+    for (int i = 0; i < NUMBER_OF_PICKS; i++) {
+        glm::vec3 target = (randomVector() - glm::vec3(0.5f)) * RADIUS * 2.0f;
+        glm::vec3 origin = glm::normalize(randomVector() - glm::vec3(0.5f)) * EYE_DISTANCE;
+        origins << origin;
+        directions << glm::normalize(target - origin);
+    }
+
+    int numberOfHits = 0;
+    timer.restart();
+    for (int i = 0; i < NUMBER_OF_PICKS; i++) {
+        float distance;
+        int tag;
+        if (findRayIntersectionByTesting(triangles, tags, origins.at(i), directions.at(i), distance, tag)) {
+            numberOfHits++;
+        }
+    }
+    qint64 testingNSecs = timer.nsecsElapsed();
+
+    timer.restart();
+    for (int i = 0; i < NUMBER_OF_PICKS; i++) {
+        float distance;
+        int tag;
+        triangleBVH.findRayIntersection(origins.at(i), directions.at(i), distance, tag);
+    }
+    qint64 hierarchyNSecs = timer.nsecsElapsed();
+
+    const float NSECS_PER_MSEC = 1000000.0f;
+    qDebug() << "triangles=" << triangles.size() << "nodes=" << triangleBVH.getNodeCount()
+        << "build=" << buildNSecs / NSECS_PER_MSEC << "msecs hits=" << numberOfHits << "of" << NUMBER_OF_PICKS;
+    qDebug() << "TIME - per pick: every triangle=" << testingNSecs / NSECS_PER_MSEC / NUMBER_OF_PICKS << "msecs"
+        << "hierarchy=" << hierarchyNSecs / NSECS_PER_MSEC / NUMBER_OF_PICKS << "msecs";
+}
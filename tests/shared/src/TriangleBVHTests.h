@@ -0,0 +1,20 @@
+//
+//  TriangleBVHTests.h
+//  tests/shared/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_TriangleBVHTests_h
+#define hifi_TriangleBVHTests_h
+
+namespace TriangleBVHTests {
+    void pickTests();
+    void pickBenchmark();
+    void runAllTests();
+}
+
+#endif // hifi_TriangleBVHTests_h
@@ -9,13 +9,23 @@
 //
 
 #include "AngularConstraintTests.h"
+#include "BlendshapeTests.h"
+#include "BoundedFileCacheTests.h"
 #include "MovingPercentileTests.h"
 #include "MovingMinMaxAvgTests.h"
+#include "SkeletonPoseTests.h"
+#include "TimerQueueTests.h"
+#include "TriangleBVHTests.h"
 
 int main(int argc, char** argv) {
     MovingMinMaxAvgTests::runAllTests();
     MovingPercentileTests::runAllTests();
     AngularConstraintTests::runAllTests();
+    TimerQueueTests::runAllTests();
+    TriangleBVHTests::runAllTests();
+    SkeletonPoseTests::runAllTests();
+    BoundedFileCacheTests::runAllTests();
+    BlendshapeTests::runAllTests();
     printf("tests complete, press enter to exit\n");
     getchar();
     return 0;
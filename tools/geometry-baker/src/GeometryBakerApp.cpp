@@ -0,0 +1,165 @@
+//
+//  GeometryBakerApp.cpp
+//  tools/geometry-baker/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QUrl>
+
+#include <FBXReader.h>
+#include <FSTReader.h>
+#include <MeshOptimizer.h>
+#include <SharedUtil.h>
+
+#include "GeometryBakerApp.h"
+
+GeometryBakerApp::GeometryBakerApp(int argc, char* argv[]) :
+    QCoreApplication(argc, argv),
+    _force(false),
+    _loadLightmaps(true),
+    _lightmapLevel(1.0f),
+    _numBaked(0),
+    _numSkipped(0),
+    _numFailed(0),
+    _exitCode(0)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("High Fidelity Geometry Baker\n\n"
+        "Bakes .fbx files, and the models that .fst files refer to, so that the interface loads them without parsing.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("paths", "Files to bake, or directories to look through for .fbx and .fst files.",
+        "[paths...]");
+
+    const QCommandLineOption outputOption("o", "cache directory to write to", "directory",
+        BakedGeometryCache::getDefaultDirectory());
+    parser.addOption(outputOption);
+
+    const QCommandLineOption forceOption("f", "rebake models that are already baked");
+    parser.addOption(forceOption);
+
+    const QCommandLineOption noLightmapsOption("no-lightmaps", "bake without lightmaps");
+    parser.addOption(noLightmapsOption);
+
+    const QCommandLineOption lightmapLevelOption("lightmap-level", "lightmap level to bake with", "level", "1.0");
+    parser.addOption(lightmapLevelOption);
+
+    if (!parser.parse(arguments())) {
+        qCritical() << parser.errorText();
+        parser.showHelp();
+        _exitCode = 1;
+        return;
+    }
+    if (parser.isSet("help") || parser.positionalArguments().isEmpty()) {
+        parser.showHelp();
+        return;
+    }
+
+    _cache = BakedGeometryCache(parser.value(outputOption));
+    _force = parser.isSet(forceOption);
+    _loadLightmaps = !parser.isSet(noLightmapsOption);
+    _lightmapLevel = parser.value(lightmapLevelOption).toFloat();
+
+    quint64 start = usecTimestampNow();
+    foreach (const QString& path, parser.positionalArguments()) {
+        bakePath(path);
+    }
+    const float USECS_PER_SECOND = 1000000.0f;
+    qDebug() << "Baked" << _numBaked << "skipped" << _numSkipped << "failed" << _numFailed << "into"
+        << _cache.getDirectory() << "in" << (usecTimestampNow() - start) / USECS_PER_SECOND << "seconds";
+
+    if (_numFailed > 0) {
+        _exitCode = 1;
+    }
+}
+
+void GeometryBakerApp::bakePath(const QString& path) {
+    QFileInfo info(path);
+    if (info.isDir()) {
+        QDirIterator it(path, QStringList() << "*.fbx" << "*.fst", QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            bakePath(it.next());
+        }
+        return;
+    }
+    QString suffix = info.suffix().toLower();
+    if (suffix == "fst") {
+        bakeMapping(path);
+
+    } else if (suffix == "fbx") {
+        bakeModel(path, QVariantHash());
+
+    } else {
+        qDebug() << "Skipping" << path << ": only .fbx and .fst files are baked.";
+        _numSkipped++;
+    }
+}
+
+void GeometryBakerApp::bakeMapping(const QString& fstPath) {
+    QFile file(fstPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Couldn't open" << fstPath;
+        _numFailed++;
+        return;
+    }
+    QVariantHash mapping = FSTReader::readMapping(file.readAll());
+
+    // the model and its LODs are all read with the mapping, as NetworkGeometry does
+    QStringList filenames;
+    filenames << mapping.value(FILENAME_FIELD).toString();
+    filenames << mapping.value(LOD_FIELD).toHash().keys();
+
+    QDir directory = QFileInfo(fstPath).dir();
+    foreach (const QString& filename, filenames) {
+        if (filename.isEmpty()) {
+            qDebug() << "Mapping file" << fstPath << "has no filename.";
+            _numFailed++;
+            continue;
+        }
+        QUrl url(filename);
+        if (!url.isRelative() && !url.isLocalFile()) {
+            qDebug() << "Skipping" << filename << "in" << fstPath << ": only local models are baked.";
+            _numSkipped++;
+            continue;
+        }
+        bakeModel(url.isLocalFile() ? url.toLocalFile() : directory.filePath(filename), mapping);
+    }
+}
+
+void GeometryBakerApp::bakeModel(const QString& modelPath, const QVariantHash& mapping) {
+    QFile file(modelPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Couldn't open" << modelPath;
+        _numFailed++;
+        return;
+    }
+    QByteArray model = file.readAll();
+    QByteArray key = BakedGeometryCache::getKey(model, mapping, _loadLightmaps, _lightmapLevel);
+    if (!_force && QFile::exists(_cache.getFilePath(key))) {
+        _numSkipped++;
+        return;
+    }
+    try {
+        FBXGeometry geometry = readFBX(model, mapping, _loadLightmaps, _lightmapLevel);
+        optimizeGeometry(geometry);
+        if (!_cache.save(key, geometry)) {
+            _numFailed++;
+            return;
+        }
+        qDebug() << "Baked" << modelPath << "as" << QFileInfo(_cache.getFilePath(key)).fileName();
+        _numBaked++;
+
+    } catch (const QString& error) {
+        qDebug() << "Error reading" << modelPath << ":" << error;
+        _numFailed++;
+    }
+}
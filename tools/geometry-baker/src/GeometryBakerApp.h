@@ -0,0 +1,44 @@
+//
+//  GeometryBakerApp.h
+//  tools/geometry-baker/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Bakes FBX models, and the models FST files refer to, into the baked geometry cache ahead of time.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_GeometryBakerApp_h
+#define hifi_GeometryBakerApp_h
+
+#include <QCoreApplication>
+#include <QVariantHash>
+
+#include <BakedGeometry.h>
+
+class GeometryBakerApp : public QCoreApplication {
+    Q_OBJECT
+public:
+    GeometryBakerApp(int argc, char* argv[]);
+
+    int getExitCode() const { return _exitCode; }
+
+private:
+    void bakePath(const QString& path);
+    void bakeMapping(const QString& fstPath);
+    void bakeModel(const QString& modelPath, const QVariantHash& mapping);
+
+    BakedGeometryCache _cache;
+    bool _force;
+    bool _loadLightmaps;
+    float _lightmapLevel;
+
+    int _numBaked;
+    int _numSkipped;
+    int _numFailed;
+    int _exitCode;
+};
+
+#endif // hifi_GeometryBakerApp_h
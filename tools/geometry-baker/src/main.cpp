@@ -0,0 +1,16 @@
+//
+//  main.cpp
+//  tools/geometry-baker/src
+//
+//  Copyright 2015 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "GeometryBakerApp.h"
+
+int main(int argc, char* argv[]) {
+    GeometryBakerApp app(argc, argv);
+    return app.getExitCode();
+}